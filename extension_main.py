@@ -14,6 +14,7 @@ from bpy.app.handlers import persistent
 
 import bmesh
 import builtins
+import hashlib
 import math
 import numpy as np
 import socket
@@ -57,6 +58,8 @@ from .compiled_schemas.python.Blender.LiveLink import Material
 from .compiled_schemas.python.Blender.LiveLink import Matrix
 from .compiled_schemas.python.Blender.LiveLink import Mesh
 from .compiled_schemas.python.Blender.LiveLink import Object
+from .compiled_schemas.python.Blender.LiveLink import ObjectTransform
+from .compiled_schemas.python.Blender.LiveLink import PayloadChunk
 from .compiled_schemas.python.Blender.LiveLink import PointLight
 from .compiled_schemas.python.Blender.LiveLink import PartType
 from .compiled_schemas.python.Blender.LiveLink import Quat
@@ -108,6 +111,12 @@ class ExportStats(dict):
             material_count=0,
             image_count=0,
             image_byte_count=0,
+            mesh_reference_count=0,
+            image_reference_count=0,
+            quantized_mesh_count=0,
+            compact_animation_count=0,
+            animation_matrix_bytes=0,
+            animation_compact_bytes=0,
             byte_count=0,
             generation_seconds=0.0,
             timings={key: 0.0 for key in EXPORT_TIMING_KEYS},
@@ -143,6 +152,348 @@ def build_int32_vector(builder, decoded_values, start_vector):
         builder.PrependInt32(value)
     return builder.EndVector()
 
+def content_hash_64(*arrays):
+    """64-bit key for Mesh/Image.content_hash; never 0, which means none."""
+    hasher = hashlib.blake2b(digest_size=8)
+    for array in arrays:
+        data = memoryview(np.ascontiguousarray(array)).cast('B')
+        hasher.update(struct.pack('<Q', data.nbytes))
+        hasher.update(data)
+    return int.from_bytes(hasher.digest(), 'little') or 1
+
+
+# Largest position step the 16-bit quantized encoding may introduce (metres);
+# meshes whose AABB is too large for it keep float positions
+QUANTIZED_POSITION_MAX_STEP = 0.001
+QUANTIZED_INDEX_MAX_VERTEX_COUNT = 65536
+
+def quantize_mesh_streams(positions, normals, uvs, indices):
+    """Mesh.quantized_* streams for (N, 3) positions/normals and (N, 2) uvs,
+    matching game/src/render/vertex_quantization.h. Returns None when the
+    mesh is too large for QUANTIZED_POSITION_MAX_STEP. indices16 is None when
+    the vertex count needs 32-bit indices."""
+    if len(positions) == 0:
+        return None
+    position_min = positions.min(axis=0).astype(np.float32)
+    position_extent = (positions.max(axis=0) - position_min).astype(np.float32)
+    if float(position_extent.max()) / 65535.0 > QUANTIZED_POSITION_MAX_STEP:
+        return None
+
+    safe_extent = np.where(position_extent > 0.0, position_extent, 1.0)
+    quantized_positions = np.rint(np.clip((positions - position_min) / safe_extent, 0.0, 1.0) * 65535.0)
+    quantized_positions[:, position_extent <= 0.0] = 0
+    quantized_positions = quantized_positions.astype(np.uint16)
+
+    # Octahedral normals; zero-length normals encode as +Z
+    l1_norm = np.abs(normals).sum(axis=1, keepdims=True)
+    octahedral = np.divide(normals[:, :2], l1_norm, out=np.zeros_like(normals[:, :2]), where=l1_norm > 0.0)
+    lower_hemisphere = normals[:, 2] < 0.0
+    folded = (1.0 - np.abs(octahedral[:, ::-1])) * np.where(octahedral >= 0.0, 1.0, -1.0)
+    octahedral[lower_hemisphere] = folded[lower_hemisphere]
+    oct_normals = np.rint(np.clip(octahedral, -1.0, 1.0) * 32767.0).astype(np.int16)
+
+    half_texcoords = uvs.astype(np.float16).view(np.uint16)
+    indices16 = indices.astype(np.uint16) if len(positions) <= QUANTIZED_INDEX_MAX_VERTEX_COUNT else None
+    return dict(
+        positions=quantized_positions,
+        position_min=position_min,
+        position_extent=position_extent,
+        oct_normals=oct_normals,
+        half_texcoords=half_texcoords,
+        indices16=indices16,
+    )
+
+
+# Compact animation encoding (Animation.compact_tracks and key arrays),
+# matching game/src/animation/animation_compression.h
+ANIMATION_TRANSLATION_TOLERANCE = 0.0001
+ANIMATION_ROTATION_TOLERANCE = 0.0005
+ANIMATION_SCALE_TOLERANCE = 0.0001
+ANIMATION_DECOMPOSE_TOLERANCE = 0.0001
+ANIMATION_COMPRESS_MAX_FRAMES = 65536
+PACKED_QUATERNION_RANGE = math.sqrt(0.5)
+
+def pack_quaternions(quaternions):
+    """(N, 4) xyzw unit quaternions -> (N, 3) uint16 smallest-three keys."""
+    rows = np.arange(len(quaternions))
+    largest = np.argmax(np.abs(quaternions), axis=1)
+    sign = np.where(quaternions[rows, largest] < 0.0, -1.0, 1.0)
+    kept = np.ones(quaternions.shape, dtype=bool)
+    kept[rows, largest] = False
+    others = quaternions[kept].reshape(-1, 3) * sign[:, None]
+    packed = np.rint(np.clip(others / PACKED_QUATERNION_RANGE * 0.5 + 0.5, 0.0, 1.0) * 32767.0).astype(np.uint16)
+    packed[:, 0] |= ((largest & 1) << 15).astype(np.uint16)
+    packed[:, 1] |= ((largest >> 1) << 15).astype(np.uint16)
+    return packed
+
+def unpack_quaternions(packed):
+    rows = np.arange(len(packed))
+    largest = (packed[:, 0] >> 15) | ((packed[:, 1] >> 15) << 1)
+    others = ((packed & 0x7fff) / 32767.0 * 2.0 - 1.0) * PACKED_QUATERNION_RANGE
+    quaternions = np.zeros((len(packed), 4))
+    kept = np.ones(quaternions.shape, dtype=bool)
+    kept[rows, largest] = False
+    quaternions[kept] = others.reshape(-1)
+    quaternions[rows, largest] = np.sqrt(np.maximum(1.0 - (others * others).sum(axis=1), 0.0))
+    return quaternions
+
+def rotation_errors(a, b):
+    """Angles in radians between rows of (N, 4) xyzw unit quaternions."""
+    w = (a * b).sum(axis=1)
+    vector = a[:, 3:4] * b[:, :3] - b[:, 3:4] * a[:, :3] - np.cross(a[:, :3], b[:, :3])
+    return 2.0 * np.arctan2(np.linalg.norm(vector, axis=1), np.abs(w))
+
+def nlerp_quaternions(a, t, b):
+    """Normalized lerp from a (4,) toward b (4,) at each t, the short way."""
+    if np.dot(a, b) < 0.0:
+        b = -b
+    mixed = a[None, :] * (1.0 - t[:, None]) + b[None, :] * t[:, None]
+    return mixed / np.linalg.norm(mixed, axis=1, keepdims=True)
+
+def quaternions_from_rotations(m):
+    """(N, 3, 3) rotation matrices, m[n, row, col] -> (N, 4) xyzw."""
+    trace = m[:, 0, 0] + m[:, 1, 1] + m[:, 2, 2]
+    diagonal = np.stack([m[:, 0, 0], m[:, 1, 1], m[:, 2, 2]], axis=1)
+    # Solve for the largest component first so the divisions stay well conditioned
+    largest = np.where(trace > 0.0, 3, np.argmax(diagonal, axis=1))
+    quaternions = np.zeros((len(m), 4))
+    for component in range(4):
+        rows = largest == component
+        if not rows.any():
+            continue
+        r = m[rows]
+        if component == 3:
+            s = np.sqrt(np.maximum(1.0 + trace[rows], 1e-12)) * 2.0
+            values = ((r[:, 2, 1] - r[:, 1, 2]) / s, (r[:, 0, 2] - r[:, 2, 0]) / s, (r[:, 1, 0] - r[:, 0, 1]) / s, 0.25 * s)
+        elif component == 0:
+            s = np.sqrt(np.maximum(1.0 + r[:, 0, 0] - r[:, 1, 1] - r[:, 2, 2], 1e-12)) * 2.0
+            values = (0.25 * s, (r[:, 0, 1] + r[:, 1, 0]) / s, (r[:, 0, 2] + r[:, 2, 0]) / s, (r[:, 2, 1] - r[:, 1, 2]) / s)
+        elif component == 1:
+            s = np.sqrt(np.maximum(1.0 + r[:, 1, 1] - r[:, 0, 0] - r[:, 2, 2], 1e-12)) * 2.0
+            values = ((r[:, 0, 1] + r[:, 1, 0]) / s, 0.25 * s, (r[:, 1, 2] + r[:, 2, 1]) / s, (r[:, 0, 2] - r[:, 2, 0]) / s)
+        else:
+            s = np.sqrt(np.maximum(1.0 + r[:, 2, 2] - r[:, 0, 0] - r[:, 1, 1], 1e-12)) * 2.0
+            values = ((r[:, 0, 2] + r[:, 2, 0]) / s, (r[:, 1, 2] + r[:, 2, 1]) / s, 0.25 * s, (r[:, 1, 0] - r[:, 0, 1]) / s)
+        quaternions[rows] = np.stack(values, axis=1)
+    return quaternions / np.linalg.norm(quaternions, axis=1, keepdims=True)
+
+def rotations_from_quaternions(q):
+    x, y, z, w = q[:, 0], q[:, 1], q[:, 2], q[:, 3]
+    return np.stack([
+        np.stack([1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - w * z), 2.0 * (x * z + w * y)], axis=1),
+        np.stack([2.0 * (x * y + w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - w * x)], axis=1),
+        np.stack([2.0 * (x * z - w * y), 2.0 * (y * z + w * x), 1.0 - 2.0 * (x * x + y * y)], axis=1),
+    ], axis=1)
+
+def decompose_skin_matrices(matrices):
+    """(N, 16) column-major affine matrices -> (translations, quaternions,
+    scales), or None when any is not translation * rotation * scale within
+    ANIMATION_DECOMPOSE_TOLERANCE (as animation_decompose_trs)."""
+    columns = matrices.reshape(-1, 4, 4).astype(np.float64)  # [n, column, row]
+    if np.abs(columns[:, :3, 3]).max(initial=0.0) > 1e-6 or np.abs(columns[:, 3, 3] - 1.0).max(initial=0.0) > 1e-6:
+        return None
+    basis = columns[:, :3, :3]
+    scales = np.linalg.norm(basis, axis=2)
+    if scales.min(initial=1.0) <= 1e-6:
+        return None
+    mirrored = np.einsum('ij,ij->i', np.cross(basis[:, 0], basis[:, 1]), basis[:, 2]) < 0.0
+    scales[mirrored, 0] = -scales[mirrored, 0]
+    rotations = np.transpose(basis / scales[:, :, None], (0, 2, 1))
+    quaternions = quaternions_from_rotations(rotations)
+    rebuilt = np.transpose(rotations_from_quaternions(quaternions), (0, 2, 1)) * scales[:, :, None]
+    column_errors = np.linalg.norm(rebuilt - basis, axis=2).max(axis=1)
+    if (column_errors > ANIMATION_DECOMPOSE_TOLERANCE * np.abs(scales).max(axis=1)).any():
+        return None
+    return columns[:, 3, :3], quaternions, scales
+
+def reduce_track(frame_count, holds, fits):
+    """Key frames for one track, placed as animation_reduce_track does."""
+    key_frames = [0]
+    if frame_count == 1 or holds(0):
+        return key_frames
+    key = 0
+    while key < frame_count - 1:
+        good = key + 1
+        bad = -1
+        step = 2
+        while True:
+            candidate = min(key + step, frame_count - 1)
+            if candidate == good:
+                break
+            if not fits(key, candidate):
+                bad = candidate
+                break
+            good = candidate
+            step *= 2
+        while bad > 0 and bad - good > 1:
+            middle = (good + bad) // 2
+            if fits(key, middle):
+                good = middle
+            else:
+                bad = middle
+        key_frames.append(good)
+        key = good
+    return key_frames
+
+def vector_track_keys(values, tolerance, per_axis):
+    def errors(a, b):
+        delta = np.abs(a - b)
+        return delta.max(axis=-1) if per_axis else np.linalg.norm(delta, axis=-1)
+
+    def fits(key_from, key_to):
+        t = (np.arange(key_from, key_to + 1) - key_from) / max(key_to - key_from, 1)
+        samples = values[key_from] + (values[key_to] - values[key_from]) * t[:, None]
+        return errors(samples, values[key_from:key_to + 1]).max() <= tolerance
+
+    return reduce_track(len(values), lambda key: errors(values, values[key]).max() <= tolerance, fits)
+
+def rotation_track_keys(quaternions):
+    # Keys are checked after quantization, as animation_rotation_segment_fits
+    quantized = unpack_quaternions(pack_quaternions(quaternions))
+
+    def fits(key_from, key_to):
+        t = (np.arange(key_from, key_to + 1) - key_from) / max(key_to - key_from, 1)
+        samples = nlerp_quaternions(quantized[key_from], t, quantized[key_to])
+        return rotation_errors(samples, quaternions[key_from:key_to + 1]).max() <= ANIMATION_ROTATION_TOLERANCE
+
+    def holds(key):
+        key_rows = np.repeat(quantized[key][None, :], len(quaternions), axis=0)
+        return rotation_errors(key_rows, quaternions).max() <= ANIMATION_ROTATION_TOLERANCE
+
+    return reduce_track(len(quaternions), holds, fits)
+
+def compress_animation_tracks(skin_matrices, frame_count, bone_count):
+    """Animation.compact_tracks and key arrays for frame-major skin matrices
+    ((frame_count * bone_count * 16) floats), or None when some matrix is
+    not TRS and the clip has to travel as matrices."""
+    if frame_count <= 0 or frame_count > ANIMATION_COMPRESS_MAX_FRAMES or bone_count <= 0:
+        return None
+    matrices = skin_matrices.reshape(frame_count, bone_count, 16)
+    tracks = []
+    vector_key_frames, vector_keys = [], []
+    rotation_key_frames, rotation_keys = [], []
+
+    def add_vector_track(values, key_frames):
+        tracks.extend((sum(len(frames) for frames in vector_key_frames), len(key_frames)))
+        vector_key_frames.append(np.asarray(key_frames, dtype=np.uint16))
+        vector_keys.append(values[key_frames].astype(np.float32))
+
+    for bone_idx in range(bone_count):
+        decomposed = decompose_skin_matrices(matrices[:, bone_idx])
+        if decomposed is None:
+            return None
+        translations, quaternions, scales = decomposed
+
+        add_vector_track(translations, vector_track_keys(translations, ANIMATION_TRANSLATION_TOLERANCE, False))
+
+        # Each rotation joins the previous frame's hemisphere
+        flips = np.concatenate([[False], (quaternions[1:] * quaternions[:-1]).sum(axis=1) < 0.0])
+        quaternions = quaternions * np.where(np.logical_xor.accumulate(flips), -1.0, 1.0)[:, None]
+        key_frames = rotation_track_keys(quaternions)
+        tracks.extend((sum(len(frames) for frames in rotation_key_frames), len(key_frames)))
+        rotation_key_frames.append(np.asarray(key_frames, dtype=np.uint16))
+        rotation_keys.append(pack_quaternions(quaternions[key_frames]))
+
+        add_vector_track(scales, vector_track_keys(scales, ANIMATION_SCALE_TOLERANCE, True))
+
+    return dict(
+        tracks=np.asarray(tracks, dtype=np.uint32),
+        vector_key_frames=np.concatenate(vector_key_frames),
+        vector_keys=np.concatenate(vector_keys).reshape(-1),
+        rotation_key_frames=np.concatenate(rotation_key_frames),
+        rotation_keys=np.concatenate(rotation_keys).reshape(-1),
+    )
+
+
+# With "Stream Large Exports" on, Updates larger than this travel as numbered
+# PayloadChunk frames, so the runtime's receive buffer stays chunk sized and
+# each Update is assembled straight into its final buffer
+LIVE_LINK_CHUNK_BYTES = 1 << 20
+# ...and object exports are split into separately published Updates of about
+# this many estimated payload bytes
+LIVE_LINK_STREAM_PART_BYTES = 16 << 20
+# Float position, normal and uv plus a 32-bit index, per mesh loop
+LIVE_LINK_ESTIMATED_BYTES_PER_LOOP = 36
+
+def make_chunk_frames(payload, transfer_id, chunk_bytes=LIVE_LINK_CHUNK_BYTES):
+    """Yields size-prefixed chunk-only Updates whose data slices rebuild the
+    size-prefixed Update payload (see game/src/live_link/live_link_chunk_assembly.h)."""
+    payload_view = memoryview(payload)
+    total_size = len(payload_view)
+    chunk_count = max(1, (total_size + chunk_bytes - 1) // chunk_bytes)
+    for chunk_index in range(chunk_count):
+        offset = chunk_index * chunk_bytes
+        builder = flatbuffers.Builder(min(chunk_bytes, total_size - offset) + 128)
+        chunk_data = builder.CreateByteVector(bytes(payload_view[offset:offset + chunk_bytes]))
+        PayloadChunk.Start(builder)
+        PayloadChunk.AddTransferId(builder, transfer_id)
+        PayloadChunk.AddChunkIndex(builder, chunk_index)
+        PayloadChunk.AddChunkCount(builder, chunk_count)
+        PayloadChunk.AddOffset(builder, offset)
+        PayloadChunk.AddTotalSize(builder, total_size)
+        PayloadChunk.AddData(builder, chunk_data)
+        chunk = PayloadChunk.End(builder)
+        Update.Start(builder)
+        Update.AddChunk(builder, chunk)
+        builder.FinishSizePrefixed(Update.End(builder))
+        yield builder.Output()
+
+def estimate_export_bytes(blender_object):
+    if blender_object.type == 'MESH' and blender_object.data is not None:
+        return 64 + len(blender_object.data.loops) * LIVE_LINK_ESTIMATED_BYTES_PER_LOOP
+    return 64
+
+def partition_export_objects(objects_to_export, part_bytes=LIVE_LINK_STREAM_PART_BYTES):
+    """Splits an export closure into parts of about part_bytes. An armature
+    stays in the part of the mesh queued just before it."""
+    parts = []
+    part = []
+    part_estimate = 0
+    for blender_object in objects_to_export:
+        object_estimate = estimate_export_bytes(blender_object)
+        if part and blender_object.type != 'ARMATURE' and part_estimate + object_estimate > part_bytes:
+            parts.append(part)
+            part = []
+            part_estimate = 0
+        part.append(blender_object)
+        part_estimate += object_estimate
+    if part:
+        parts.append(part)
+    return parts
+
+
+class LiveLinkContentReferences():
+    """Content the connected runtime holds, so unchanged geometry and pixels
+    can be sent as Mesh/Image.content_hash references instead of payloads.
+
+    A mesh hash is only referenced while some object the runtime has still
+    uses it (the runtime may evict unreferenced meshes between updates);
+    images live until a reset. Valid for one connection only: cleared on
+    connect, send failure, reset and native exports, whose payloads this
+    tracking cannot see.
+    """
+
+    def __init__(self):
+        self.mesh_hash_by_uid = {}
+        self.image_hashes = set()
+        self.referenceable_mesh_hashes = set()
+
+    def clear(self):
+        self.mesh_hash_by_uid.clear()
+        self.image_hashes.clear()
+        self.referenceable_mesh_hashes.clear()
+
+    def begin_update(self):
+        # Hashes held when the update starts stay valid for all of it: the
+        # runtime only evicts between updates
+        self.referenceable_mesh_hashes = set(self.mesh_hash_by_uid.values())
+
+    def end_update(self, deleted_object_uids):
+        for unique_id in deleted_object_uids:
+            self.mesh_hash_by_uid.pop(unique_id, None)
+        self.referenceable_mesh_hashes.clear()
+
+
 # Overridden print that prints to blender console windows
 def print(*args, **kwargs):
     # Standard print to stdout
@@ -178,6 +529,21 @@ def scene_uses_python_export_fallback(scene=None):
         scene = bpy.context.scene
     return bool(getattr(scene, "live_link_use_python_export_fallback", False))
 
+def scene_uses_quantized_mesh_export(scene=None):
+    if scene is None:
+        scene = bpy.context.scene
+    return bool(getattr(scene, "live_link_quantize_meshes", False))
+
+def scene_uses_compressed_animation_export(scene=None):
+    if scene is None:
+        scene = bpy.context.scene
+    return bool(getattr(scene, "live_link_compress_animations", False))
+
+def scene_uses_streamed_export(scene=None):
+    if scene is None:
+        scene = bpy.context.scene
+    return bool(getattr(scene, "live_link_stream_large_exports", False))
+
 def get_editor_camera_snapshot(context=None):
     """Return location/forward/up from the current Blender 3D viewport."""
     context = context or bpy.context
@@ -248,6 +614,8 @@ def object_visible_in_game(obj):
 class LiveLinkConnection():
     def __init__(self):
         self.update_sequence = 0
+        self.next_transfer_id = 0
+        self.content_references = LiveLinkContentReferences()
         self.create_socket()
         
     def __del__(self):
@@ -294,6 +662,9 @@ class LiveLinkConnection():
 
             # Create a new socket if attempting to reconnect
             self.create_socket()
+
+            # The other end may be a fresh runtime with an empty content cache
+            self.content_references.clear()
             
             # FCS TODO: Store magic IP and Port numbers in some shared file
             HOST = '127.0.0.1'
@@ -315,11 +686,17 @@ class LiveLinkConnection():
             return False
 
         try:
-            self.my_socket.sendall(data)
+            if scene_uses_streamed_export() and len(data) > LIVE_LINK_CHUNK_BYTES:
+                self.next_transfer_id = (self.next_transfer_id + 1) & 0xFFFFFFFF
+                for chunk_frame in make_chunk_frames(data, self.next_transfer_id):
+                    self.my_socket.sendall(chunk_frame)
+            else:
+                self.my_socket.sendall(data)
             return True
         except Exception as e:
             print(traceback.format_exc())
             print("Error: LiveLinkConnection::send")
+            self.content_references.clear()
             self.close_socket()
             self.create_socket()
             return False
@@ -593,8 +970,22 @@ class LiveLinkConnection():
             bpy.context.view_layer.update()
             self.add_export_timing(export_stats, "animation_sampling", time.perf_counter() - animation_sampling_start)
 
+        # --- Optional compact encoding (reduced TRS keys, sent instead of
+        # the matrices; clips that are not TRS keep the matrices)
+        compact = None
+        if scene_uses_compressed_animation_export():
+            compact = compress_animation_tracks(skin_matrices, frame_count, bone_count)
+        if export_stats is not None:
+            export_stats["animation_matrix_bytes"] += skin_matrices.nbytes
+            if compact is not None:
+                export_stats["compact_animation_count"] += 1
+                export_stats["animation_compact_bytes"] += sum(array.nbytes for array in compact.values())
+
         animation_name_fb = builder.CreateString(action.name)
-        skin_matrices_fb = builder.CreateNumpyVector(skin_matrices)
+        if compact is not None:
+            compact_fb = {key: builder.CreateNumpyVector(array) for key, array in compact.items()}
+        else:
+            skin_matrices_fb = builder.CreateNumpyVector(skin_matrices)
         duration_seconds = frame_count / frame_rate if frame_rate > 0.0 else 0.0
 
         Animation.Start(builder)
@@ -603,15 +994,25 @@ class LiveLinkConnection():
         Animation.AddDurationSeconds(builder, duration_seconds)
         Animation.AddFrameCount(builder, frame_count)
         Animation.AddBoneCount(builder, bone_count)
-        Animation.AddSkinMatrices(builder, skin_matrices_fb)
+        if compact is not None:
+            Animation.AddCompactTracks(builder, compact_fb["tracks"])
+            Animation.AddVectorKeyFrames(builder, compact_fb["vector_key_frames"])
+            Animation.AddVectorKeys(builder, compact_fb["vector_keys"])
+            Animation.AddRotationKeyFrames(builder, compact_fb["rotation_key_frames"])
+            Animation.AddRotationKeys(builder, compact_fb["rotation_keys"])
+        else:
+            Animation.AddSkinMatrices(builder, skin_matrices_fb)
         return Animation.End(builder)
  
-    def make_flatbuffer_object(self, builder, obj, dependency_graph, referenced_materials, export_stats=None):
+    def make_flatbuffer_object(self, builder, obj, dependency_graph, referenced_materials, export_stats=None, content_references=None):
         # Allocate string for object name
         object_name = builder.CreateString(obj.name)
 
         # Mesh Data
         mesh_fb = None
+        if content_references is not None:
+            # Re-recorded below if the object still exports a mesh
+            content_references.mesh_hash_by_uid.pop(obj.session_uid, None)
         if is_mesh_export_object(obj):
             mesh_armature = self.get_mesh_armature(obj)
             mesh = self.get_mesh(obj, dependency_graph, mesh_armature is not None, export_stats)
@@ -672,13 +1073,9 @@ class LiveLinkConnection():
             # --- Build triangle index buffer ---
             indices = new_indices[loop_triangle_indices].astype(np.int32)
 
-            # --- Flatten arrays for FlatBuffers ---
-            mesh_positions_fb = builder.CreateNumpyVector(mesh_positions.flatten())
-            mesh_normals_fb   = builder.CreateNumpyVector(mesh_normals.flatten())
-            mesh_uvs_fb       = builder.CreateNumpyVector(mesh_uvs.flatten())
-            mesh_indices_fb   = builder.CreateNumpyVector(indices)
-
             # --- Optional skinning data prep ---
+            mesh_joint_indices = None
+            mesh_joint_weights = None
             mesh_joint_indices_fb = None
             mesh_joint_weights_fb = None
             mesh_to_armature_fb = None
@@ -720,8 +1117,6 @@ class LiveLinkConnection():
                 # --- Remap into deduplicated vertex buffer ---
                 mesh_joint_indices  = joints_per_vert[unique_keys['v']]
                 mesh_joint_weights  = weights_per_vert[unique_keys['v']]
-                mesh_joint_indices_fb = builder.CreateNumpyVector(mesh_joint_indices.flatten())
-                mesh_joint_weights_fb = builder.CreateNumpyVector(mesh_joint_weights.flatten())
 
                 mesh_to_armature_fb = self.make_flatbuffer_matrix(
                     builder,
@@ -756,12 +1151,78 @@ class LiveLinkConnection():
             if export_stats is not None:
                 export_stats["material_slot_count"] += int(len(material_ids))
 
+            # --- Optional quantized encoding (16-bit positions relative to
+            # the AABB, octahedral normals, half uvs, 16-bit indices) ---
+            quantized = None
+            if scene_uses_quantized_mesh_export():
+                quantized = quantize_mesh_streams(mesh_positions, mesh_normals, mesh_uvs, indices)
+                if quantized is not None and export_stats is not None:
+                    export_stats["quantized_mesh_count"] += 1
+
+            # --- Content hash: geometry the runtime already holds is sent
+            # as a reference and the streams below are skipped ---
+            mesh_content_hash = 0
+            send_mesh_streams = True
+            if content_references is not None:
+                if quantized is not None:
+                    hashed_streams = [
+                        quantized["positions"],
+                        np.concatenate([quantized["position_min"], quantized["position_extent"]]),
+                        quantized["oct_normals"],
+                        quantized["half_texcoords"],
+                        quantized["indices16"] if quantized["indices16"] is not None else indices,
+                    ]
+                else:
+                    hashed_streams = [mesh_positions, mesh_normals, mesh_uvs, indices]
+                if mesh_joint_indices is not None:
+                    hashed_streams += [mesh_joint_indices, mesh_joint_weights]
+                mesh_content_hash = content_hash_64(*hashed_streams)
+                send_mesh_streams = mesh_content_hash not in content_references.referenceable_mesh_hashes
+                content_references.mesh_hash_by_uid[obj.session_uid] = mesh_content_hash
+                if not send_mesh_streams and export_stats is not None:
+                    export_stats["mesh_reference_count"] += 1
+
+            # --- Flatten arrays for FlatBuffers ---
+            mesh_positions_fb = None
+            mesh_normals_fb = None
+            mesh_uvs_fb = None
+            mesh_indices_fb = None
+            mesh_indices16_fb = None
+            if send_mesh_streams:
+                if quantized is not None:
+                    mesh_positions_fb = builder.CreateNumpyVector(quantized["positions"].flatten())
+                    mesh_normals_fb   = builder.CreateNumpyVector(quantized["oct_normals"].flatten())
+                    mesh_uvs_fb       = builder.CreateNumpyVector(quantized["half_texcoords"].flatten())
+                else:
+                    mesh_positions_fb = builder.CreateNumpyVector(mesh_positions.flatten())
+                    mesh_normals_fb   = builder.CreateNumpyVector(mesh_normals.flatten())
+                    mesh_uvs_fb       = builder.CreateNumpyVector(mesh_uvs.flatten())
+                if quantized is not None and quantized["indices16"] is not None:
+                    mesh_indices16_fb = builder.CreateNumpyVector(quantized["indices16"])
+                else:
+                    mesh_indices_fb = builder.CreateNumpyVector(indices)
+                if mesh_joint_indices is not None:
+                    mesh_joint_indices_fb = builder.CreateNumpyVector(mesh_joint_indices.flatten())
+                    mesh_joint_weights_fb = builder.CreateNumpyVector(mesh_joint_weights.flatten())
+
             # --- Build FlatBuffer Mesh ---
             Mesh.Start(builder)
-            Mesh.AddPositions(builder, mesh_positions_fb)
-            Mesh.AddNormals(builder, mesh_normals_fb)
-            Mesh.AddTexcoords(builder, mesh_uvs_fb)
-            Mesh.AddIndices(builder, mesh_indices_fb)
+            if send_mesh_streams and quantized is not None:
+                Mesh.AddQuantizedPositions(builder, mesh_positions_fb)
+                Mesh.AddPositionMin(builder, Vec3.CreateVec3(builder, *quantized["position_min"].tolist()))
+                Mesh.AddPositionExtent(builder, Vec3.CreateVec3(builder, *quantized["position_extent"].tolist()))
+                Mesh.AddOctNormals(builder, mesh_normals_fb)
+                Mesh.AddHalfTexcoords(builder, mesh_uvs_fb)
+            elif send_mesh_streams:
+                Mesh.AddPositions(builder, mesh_positions_fb)
+                Mesh.AddNormals(builder, mesh_normals_fb)
+                Mesh.AddTexcoords(builder, mesh_uvs_fb)
+            if mesh_indices16_fb is not None:
+                Mesh.AddIndices16(builder, mesh_indices16_fb)
+            elif send_mesh_streams:
+                Mesh.AddIndices(builder, mesh_indices_fb)
+            if mesh_content_hash != 0:
+                Mesh.AddContentHash(builder, mesh_content_hash)
             Mesh.AddMaterialIds(builder, material_ids_fb)
             
             # Optional Skinning Data
@@ -971,9 +1432,15 @@ class LiveLinkConnection():
 
         return live_link_object
 
-    def make_update(self, in_object_list, in_deleted_object_uids, reset=False, update_reason="unknown"):
+    # content_references is only passed for updates sent on the live
+    # connection; files and compare exports always carry full payloads.
+    def make_update(self, in_object_list, in_deleted_object_uids, reset=False, update_reason="unknown", content_references=None):
         editor_camera = get_editor_camera_snapshot()
+        if content_references is not None and reset:
+            content_references.clear()
         if native_live_link_available() and not scene_uses_python_export_fallback():
+            if content_references is not None:
+                content_references.clear()
             self.update_sequence += 1
             output = self.make_update_native(
                 in_object_list,
@@ -997,6 +1464,7 @@ class LiveLinkConnection():
             reset=reset,
             update_reason=update_reason,
             editor_camera=editor_camera,
+            content_references=content_references,
         )
 
     def make_update_native(
@@ -1088,6 +1556,7 @@ class LiveLinkConnection():
         update_reason="unknown",
         increment_sequence=True,
         editor_camera=None,
+        content_references=None,
     ):
         export_generation_start = time.perf_counter()
         if increment_sequence:
@@ -1119,6 +1588,9 @@ class LiveLinkConnection():
             bpy.context.scene.objects,
         )
 
+        if content_references is not None:
+            content_references.begin_update()
+
         live_link_objects = []
         export_stats["exported_object_count"] = len(objects_to_export)
         for blender_object in objects_to_export:
@@ -1128,7 +1600,8 @@ class LiveLinkConnection():
                     blender_object,
                     dependency_graph,
                     referenced_materials,
-                    export_stats
+                    export_stats,
+                    content_references,
                 )
             )
 
@@ -1290,18 +1763,33 @@ class LiveLinkConnection():
             self.add_export_timing(export_stats, "image_rgba8_convert", time.perf_counter() - rgba8_convert_start)
 
             export_stats["image_count"] += 1
-            export_stats["image_byte_count"] += int(pixels_rgba8.nbytes)
+
+            # Pixels the runtime already has go out as a hash reference
+            image_content_hash = 0
+            send_image_data = True
+            if content_references is not None:
+                image_content_hash = content_hash_64(np.array([image_width, image_height], dtype=np.int32), pixels_rgba8)
+                send_image_data = image_content_hash not in content_references.image_hashes
+                content_references.image_hashes.add(image_content_hash)
+                if not send_image_data:
+                    export_stats["image_reference_count"] += 1
 
             # Now pass to FlatBuffers
-            with export_stats.measure("image_flatbuffer_pack"):
-                flatbuffer_image_data = builder.CreateNumpyVector(pixels_rgba8)
+            flatbuffer_image_data = None
+            if send_image_data:
+                export_stats["image_byte_count"] += int(pixels_rgba8.nbytes)
+                with export_stats.measure("image_flatbuffer_pack"):
+                    flatbuffer_image_data = builder.CreateNumpyVector(pixels_rgba8)
 
             # Build up flatbuffers image and add it to our list of images
             Image.Start(builder)
             Image.AddUniqueId(builder, image_id)
             Image.AddWidth(builder, image_width)
             Image.AddHeight(builder, image_height)
-            Image.AddData(builder, flatbuffer_image_data) 
+            if flatbuffer_image_data is not None:
+                Image.AddData(builder, flatbuffer_image_data)
+            if image_content_hash != 0:
+                Image.AddContentHash(builder, image_content_hash)
             flatbuffer_image = Image.End(builder)
             flatbuffer_images.append(flatbuffer_image)
 
@@ -1345,6 +1833,9 @@ class LiveLinkConnection():
         # finish and provide size information
         builder.FinishSizePrefixed(live_link_scene)
         
+        if content_references is not None:
+            content_references.end_update(in_deleted_object_uids)
+
         # return flatbuffers binary output
         output = builder.Output()
         export_stats["byte_count"] = len(output)
@@ -1371,6 +1862,11 @@ class LiveLinkConnection():
             f"materials={export_stats['material_count']} "
             f"images={export_stats['image_count']} "
             f"image_bytes={export_stats['image_byte_count']} "
+            f"mesh_references={export_stats['mesh_reference_count']} "
+            f"image_references={export_stats['image_reference_count']} "
+            f"quantized_meshes={export_stats['quantized_mesh_count']} "
+            f"compact_animations={export_stats['compact_animation_count']} "
+            f"animation_bytes={export_stats['animation_compact_bytes']}/{export_stats['animation_matrix_bytes']} "
             f"generation_seconds={export_stats['generation_seconds']:.6f} "
             f"reset={export_stats['reset']}"
         )
@@ -1391,8 +1887,85 @@ class LiveLinkConnection():
         )
         return output
 
+    # Creates a transform-only update: one ObjectTransform per object, no
+    # meshes, materials or images. Always built in Python since it is tiny.
+    def make_transform_update(self, in_object_list, update_reason="unknown"):
+        self.update_sequence += 1
+        sequence = self.update_sequence
+        export_generation_start = time.perf_counter()
+
+        objects_to_export = self.collect_export_objects(
+            in_object_list,
+            bpy.context.scene.objects,
+        )
+
+        builder = flatbuffers.Builder(64 + 48 * len(objects_to_export))
+        Update.UpdateStartTransformsVector(builder, len(objects_to_export))
+        for blender_object in reversed(objects_to_export):
+            obj_location, obj_rotation, obj_scale = blender_object.matrix_world.decompose()
+            ObjectTransform.CreateObjectTransform(
+                builder,
+                blender_object.session_uid,
+                obj_location.x, obj_location.y, obj_location.z,
+                obj_rotation.x, obj_rotation.y, obj_rotation.z, obj_rotation.w,
+                obj_scale.x, obj_scale.y, obj_scale.z,
+            )
+        update_transforms = builder.EndVector()
+
+        generation_seconds = time.perf_counter() - export_generation_start
+        Update.Start(builder)
+        Update.AddTransforms(builder, update_transforms)
+        Update.AddGenerationSeconds(builder, generation_seconds)
+        builder.FinishSizePrefixed(Update.End(builder))
+
+        output = builder.Output()
+        print(
+            "\nLive Link Transform Export Stats: "
+            f"seq={sequence} "
+            f"reason={update_reason} "
+            f"bytes={len(output)} "
+            f"input_objects={len(in_object_list)} "
+            f"transforms={len(objects_to_export)} "
+            f"generation_seconds={generation_seconds:.6f}"
+        )
+        return output
+
     def send_object_list(self, updated_objects, deleted_object_uids, update_reason="object_list"):
-        return self.send(self.make_update(updated_objects, deleted_object_uids, update_reason=update_reason))
+        # Reconnect before exporting so content references are never built
+        # against the previous connection's runtime
+        if not self.is_connected():
+            print("Attempt to reconnect")
+            self.connect()
+
+        # Large exports go out as several Updates so the runtime shows each
+        # part as soon as it arrives. A part may repeat an armature that a
+        # skinned mesh in an earlier part already brought along.
+        if scene_uses_streamed_export():
+            parts = partition_export_objects(
+                self.collect_export_objects(updated_objects, bpy.context.scene.objects)
+            )
+            if len(parts) > 1:
+                print(f"Live Link Streamed Export: reason={update_reason} parts={len(parts)}")
+                for part_index, part in enumerate(parts):
+                    sent = self.send(self.make_update(
+                        part,
+                        deleted_object_uids if part_index == 0 else [],
+                        update_reason=f"{update_reason}[part {part_index + 1}/{len(parts)}]",
+                        content_references=self.content_references,
+                    ))
+                    if not sent:
+                        return False
+                return True
+
+        return self.send(self.make_update(
+            updated_objects,
+            deleted_object_uids,
+            update_reason=update_reason,
+            content_references=self.content_references,
+        ))
+
+    def send_transform_list(self, transformed_objects, update_reason="transform_list"):
+        return self.send(self.make_transform_update(transformed_objects, update_reason=update_reason))
 
     def save_to_file(self, in_objects, in_filename, update_reason="save_to_file"):
         update = self.make_update(in_objects, [], update_reason=update_reason)
@@ -1400,12 +1973,15 @@ class LiveLinkConnection():
             f.write(update)
 
     def send_reset(self, update_reason="manual_reset"):
-        return self.send(self.make_update([], [], True, update_reason=update_reason))
+        return self.send(self.make_update([], [], True, update_reason=update_reason, content_references=self.content_references))
 
 live_link_connection = []
 
 batched_updates = set()
 batched_deleted = set()
+# Objects that only moved; sent as ObjectTransform deltas unless they also
+# land in batched_updates before the timer fires
+batched_transforms = set()
 
 @contextmanager
 def suspend_depsgraph_updates():
@@ -1423,19 +1999,25 @@ def queue_object_updates(objects, update_reason):
 def queue_object_update(obj, update_reason):
     queue_object_updates((obj,), update_reason)
 
+def queue_object_transforms(objects, update_reason):
+    batched_transforms.update(objects)
+    schedule_send(update_reason=update_reason)
+
 def clear_batched_depsgraph_updates(update_reason="unknown"):
     if bpy.app.timers.is_registered(send_updates_timer):
         bpy.app.timers.unregister(send_updates_timer)
 
-    if batched_updates or batched_deleted:
+    if batched_updates or batched_deleted or batched_transforms:
         print(
             "\nLive Link Clear Queued Depsgraph Updates: "
             f"reason={update_reason} "
             f"queued_updates={len(batched_updates)} "
-            f"queued_deleted={len(batched_deleted)}"
+            f"queued_deleted={len(batched_deleted)} "
+            f"queued_transforms={len(batched_transforms)}"
         )
         batched_updates.clear()
         batched_deleted.clear()
+        batched_transforms.clear()
 
 def send_full_scene_update(update_reason="full_update"):
     clear_batched_depsgraph_updates(update_reason=f"{update_reason}_before_send")
@@ -1513,7 +2095,10 @@ def automatic_initial_full_update_load_post(_):
 
 # Actually sends batched updates
 def send_updates_timer(): 
-    global batched_updates, batched_deleted 
+    global batched_updates, batched_deleted, batched_transforms
+
+    # A full object update already carries the latest transform
+    batched_transforms.difference_update(batched_updates)
 
     # No new updates in SEND_DELAY seconds → send batched data
     if batched_updates or batched_deleted:
@@ -1527,9 +2112,28 @@ def send_updates_timer():
                 update_reason=update_reason,
             )
 
-        # Clear batch
-        batched_updates.clear()
-        batched_deleted.clear()
+    if batched_transforms:
+        transformed_objects = []
+        for obj in batched_transforms:
+            try:
+                obj.session_uid
+            except ReferenceError:
+                continue
+            transformed_objects.append(obj)
+
+        update_reason = f"depsgraph_timer(transforms={len(transformed_objects)})"
+        print(f"\nLive Link Timer Send: reason={update_reason}")
+        if transformed_objects:
+            with suspend_depsgraph_updates():
+                live_link_connection.send_transform_list(
+                    transformed_objects,
+                    update_reason=update_reason,
+                )
+
+    # Clear batch
+    batched_updates.clear()
+    batched_deleted.clear()
+    batched_transforms.clear()
 
     return None
 
@@ -1541,12 +2145,13 @@ def schedule_send(update_reason="depsgraph_update"):
     # Schedule new timer
     SEND_DELAY = 0.25
     bpy.app.timers.register(send_updates_timer, first_interval=SEND_DELAY)
-    if batched_updates or batched_deleted:
+    if batched_updates or batched_deleted or batched_transforms:
         print(
             "\nLive Link Schedule Send: "
             f"reason={update_reason} "
             f"queued_updates={len(batched_updates)} "
-            f"queued_deleted={len(batched_deleted)}"
+            f"queued_deleted={len(batched_deleted)} "
+            f"queued_transforms={len(batched_transforms)}"
         )
 
 # Callback when depsgraph has finished updating
@@ -1564,26 +2169,39 @@ def depsgraph_update_post_callback(scene, depsgraph):
         return
 
     # Determine if any objects were deleted
-    # Track the objects at the last update
+    # Track the objects at the last update. Until a first snapshot exists the
+    # game may not have any of them, so every object counts as added and is
+    # sent in full rather than as a transform delta.
+    added_object_uids = current_objects
     if hasattr(depsgraph_update_post_callback, "previous_objects"):
         previous_objects = depsgraph_update_post_callback.previous_objects
         # Find the difference (deleted objects)
         deleted_object_uids = []
         deleted_object_uids = list(previous_objects - current_objects)
         batched_deleted.update(deleted_object_uids)
+        added_object_uids = current_objects - previous_objects
     
     # Store the current object names for the next update
     depsgraph_update_post_callback.previous_objects = current_objects
 
-    # Accumulate updated objects
+    # Accumulate updated objects. Objects that only moved (and that the game
+    # already has) are sent as transform deltas instead of full objects.
     updated_objects = []
+    transformed_objects = []
     for update in depsgraph.updates:
         update_id = update.id
         if isinstance(update_id, bpy.types.Object):
-            if update.is_updated_transform or update.is_updated_geometry:
-                updated_objects.append(scene.objects[update_id.name])
+            if not (update.is_updated_transform or update.is_updated_geometry):
+                continue
+            scene_object = scene.objects[update_id.name]
+            if update.is_updated_geometry or scene_object.session_uid in added_object_uids:
+                updated_objects.append(scene_object)
+            else:
+                transformed_objects.append(scene_object)
 
     queue_object_updates(updated_objects, update_reason="depsgraph_update_post")
+    if transformed_objects:
+        queue_object_transforms(transformed_objects, update_reason="depsgraph_update_post_transform")
 
 # Enable depsgraph_update_post_callback. Will be disabled to prevent recursion within depsgraph_update_post_callback
 depsgraph_update_post_callback.enabled = True
@@ -1697,6 +2315,9 @@ class LiveLinkView3DPanel(bpy.types.Panel):
         if native_live_link_available():
             layout.operator("live_link.compare_native_python_export", text="Compare Native/Python Export")
             layout.prop(scene, "live_link_use_python_export_fallback")
+        layout.prop(scene, "live_link_quantize_meshes")
+        layout.prop(scene, "live_link_compress_animations")
+        layout.prop(scene, "live_link_stream_large_exports")
 # End LiveLinkView3DPanel
 
 def menu_func(self, context):
@@ -2518,6 +3139,21 @@ def register():
         default=False,
         update=live_link_python_export_fallback_update,
     )
+    bpy.types.Scene.live_link_quantize_meshes = bpy.props.BoolProperty(
+        name="Quantize Meshes",
+        description="Send mesh vertices as 16-bit positions, octahedral normals and half-float UVs (Python exporter; at most 1 mm position error)",
+        default=False,
+    )
+    bpy.types.Scene.live_link_compress_animations = bpy.props.BoolProperty(
+        name="Compress Animations",
+        description="Send animations as reduced translation/rotation/scale keys instead of per-frame matrices (Python exporter; the game compresses matrix clips on import either way)",
+        default=False,
+    )
+    bpy.types.Scene.live_link_stream_large_exports = bpy.props.BoolProperty(
+        name="Stream Large Exports",
+        description="Split large exports into separately shown parts and send big updates as 1 MB chunks, so the game shows objects while the rest still transfers",
+        default=False,
+    )
 
     # Enabled add-ons normally register before the startup file is loaded and
     # are scheduled by load_post. This also covers enabling the add-on after a
@@ -2552,6 +3188,12 @@ def unregister():
     del bpy.types.Object.live_link_settings
     if hasattr(bpy.types.Scene, "live_link_use_python_export_fallback"):
         del bpy.types.Scene.live_link_use_python_export_fallback
+    if hasattr(bpy.types.Scene, "live_link_quantize_meshes"):
+        del bpy.types.Scene.live_link_quantize_meshes
+    if hasattr(bpy.types.Scene, "live_link_compress_animations"):
+        del bpy.types.Scene.live_link_compress_animations
+    if hasattr(bpy.types.Scene, "live_link_stream_large_exports"):
+        del bpy.types.Scene.live_link_stream_large_exports
 
 # This allows you to run the script directly from Blender's Text editor
 if __name__ == "__main__":
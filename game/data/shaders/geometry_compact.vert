@@ -0,0 +1,44 @@
+#version 450
+
+#include "shader_common.h"
+#include "octahedral_helpers.h"
+
+// CompactVertex input (see vertex_quantization.h): the fixed-function fetch
+// already turns unorm16/snorm16/half into floats
+layout(location = 0) in vec4 in_position;	// unorm, relative to the mesh AABB
+layout(location = 1) in vec2 in_normal;	// snorm octahedral
+layout(location = 2) in vec2 in_texcoord;
+
+layout(push_constant) uniform PushConstants
+{
+	int object_index;
+	int skin_matrix_offset;	// unused in the compact path
+	int skinning_debug_view;
+	int _pad0;
+	vec4 position_min;
+	vec4 position_extent;
+} pc;
+
+layout(location = 0) out vec4 out_world_position;
+layout(location = 1) out vec4 out_world_normal;
+layout(location = 2) out vec2 out_texcoord;
+layout(location = 3) flat out int out_material_index;
+layout(location = 4) out vec4 out_skin_debug_color;
+layout(location = 5) flat out int out_is_skinned_mesh;
+
+void main()
+{
+	ObjectData obj = object_data_array[pc.object_index];
+
+	vec4 local_position = vec4(pc.position_min.xyz + in_position.xyz * pc.position_extent.xyz, 1.0);
+	vec4 local_normal = vec4(octahedral_decode(in_normal), 0.0);
+
+	out_world_position = obj.model_matrix * local_position;
+	out_world_normal = obj.rotation_matrix * local_normal;
+	out_texcoord = in_texcoord;
+	out_material_index = obj.material_index;
+	out_skin_debug_color = vec4(0.0);
+	out_is_skinned_mesh = 0;
+
+	gl_Position = per_frame.view_projection * out_world_position;
+}
@@ -0,0 +1,163 @@
+#ifndef GEOMETRY_FS_H
+#define GEOMETRY_FS_H
+
+// Shared G-buffer fragment shader of the geometry pass. Include from a .frag
+// after `#version 450`; `#define GEOMETRY_TEXTURE_FEEDBACK` first to write
+// texture streaming feedback, which needs fragmentStoresAndAtomics
+// (geometry.frag with it, geometry_no_feedback.frag without).
+
+#include "shader_common.h"
+
+layout(location = 0) in vec4 in_world_position;
+layout(location = 1) in vec4 in_world_normal;
+layout(location = 2) in vec2 in_texcoord;
+layout(location = 3) flat in int in_material_index;
+layout(location = 4) in vec4 in_skin_debug_color;
+layout(location = 5) flat in int in_is_skinned_mesh;
+
+layout(push_constant) uniform PushConstants
+{
+	int object_index;
+	int skin_matrix_offset;
+	int skinning_debug_view;
+	int texture_feedback;	// 0 = off, else 1 + which pixel of each 4x4 block reports
+} pc;
+
+#ifdef GEOMETRY_TEXTURE_FEEDBACK
+// Texture streaming feedback (render/texture_streaming.h), layout A binding 8
+// (declared here only: other set 0 layouts use binding 8 for their own
+// data). Per bindless slot, the smallest floor(lod) + TEXTURE_FEEDBACK_LOD_BIAS
+// any pixel asked for, lod measured against the bound image; 0xFFFFFFFF = not
+// sampled this frame.
+#define TEXTURE_FEEDBACK_LOD_BIAS 16
+layout(set = 0, binding = 8, std430) buffer TextureFeedbackBlock
+{
+	uint texture_feedback_array[];
+};
+#endif
+
+// G-buffer attachment layout:
+//  0: base color, or emission color when emission_strength > 0
+//  1: world position (w = 1 marks valid geometry)
+//  2: world normal   (vec4(0) = sky/no-geometry sentinel for lighting)
+//  3: r = roughness, g = metallic, b = emission_strength
+layout(location = 0) out vec4 out_color;
+layout(location = 1) out vec4 out_position;
+layout(location = 2) out vec4 out_normal;
+layout(location = 3) out vec4 out_roughness_metallic_emissive;
+
+// Reports the mip this pixel needs from a scene texture. The lod is taken
+// from the uv footprint (the sampler's minLod would clamp textureQueryLod at
+// the bound image's first level, hiding demand for finer ones). One pixel of
+// each 4x4 block reports, rotating over 16 frames, and the atomic is skipped
+// when it would not lower the value.
+void record_texture_feedback(int in_image_index)
+{
+#ifdef GEOMETRY_TEXTURE_FEEDBACK
+	if (pc.texture_feedback == 0)
+	{
+		return;
+	}
+	vec2 size = vec2(textureSize(sampler2D(SCENE_TEXTURE(in_image_index), scene_sampler), 0));
+	vec2 dx = dFdx(in_texcoord) * size;
+	vec2 dy = dFdy(in_texcoord) * size;
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-12));
+
+	uvec2 block_pixel = uvec2(gl_FragCoord.xy) & 3u;
+	if (block_pixel.x + block_pixel.y * 4u != uint(pc.texture_feedback - 1))
+	{
+		return;
+	}
+	uint value = uint(clamp(floor(lod) + float(TEXTURE_FEEDBACK_LOD_BIAS), 0.0, 31.0));
+	if (texture_feedback_array[in_image_index] > value)
+	{
+		atomicMin(texture_feedback_array[in_image_index], value);
+	}
+#endif
+}
+
+void main()
+{
+	if (pc.skinning_debug_view != 0 && in_is_skinned_mesh != 0)
+	{
+		out_color = in_skin_debug_color;
+		out_position = in_world_position;
+		out_normal = normalize(in_world_normal);
+		out_roughness_metallic_emissive = vec4(1.0, 0.0, 1.0, 0.0);
+		return;
+	}
+	if (in_material_index >= 0)
+	{
+		Material material = material_data_array[in_material_index];
+
+		// Base Color
+		if (material.base_color_image_index >= 0)
+		{
+			out_color = texture(sampler2D(SCENE_TEXTURE(material.base_color_image_index), scene_sampler), in_texcoord);
+			record_texture_feedback(material.base_color_image_index);
+		}
+		else
+		{
+			out_color = material.base_color;
+		}
+
+		// Metallic
+		if (material.metallic_image_index >= 0)
+		{
+			out_roughness_metallic_emissive.g = texture(sampler2D(SCENE_TEXTURE(material.metallic_image_index), scene_sampler), in_texcoord).r;
+			record_texture_feedback(material.metallic_image_index);
+		}
+		else
+		{
+			out_roughness_metallic_emissive.g = material.metallic;
+		}
+
+		// Roughness
+		if (material.roughness_image_index >= 0)
+		{
+			out_roughness_metallic_emissive.r = texture(sampler2D(SCENE_TEXTURE(material.roughness_image_index), scene_sampler), in_texcoord).r;
+			record_texture_feedback(material.roughness_image_index);
+		}
+		else
+		{
+			out_roughness_metallic_emissive.r = material.roughness;
+		}
+
+		// Emission Color and Strength
+		if (material.emission_strength > 0.0)
+		{
+			out_roughness_metallic_emissive.b = material.emission_strength;
+			if (material.emission_color_image_index >= 0)
+			{
+				out_color.rgb = texture(sampler2D(SCENE_TEXTURE(material.emission_color_image_index), scene_sampler), in_texcoord).rgb;
+				record_texture_feedback(material.emission_color_image_index);
+				out_color.a = 1.0;
+			}
+			else
+			{
+				out_color.rgb = material.emission_color.rgb;
+				out_color.a = 1.0;
+			}
+		}
+		else
+		{
+			out_roughness_metallic_emissive.b = 0.0;
+		}
+
+		out_roughness_metallic_emissive.a = 0.0;
+		out_position = in_world_position;
+		out_normal = normalize(in_world_normal);
+	}
+	else
+	{
+		// Material-less objects use a lit grey fallback and retain valid
+		// geometry data so scenes remain legible before materials are
+		// assigned.
+		out_color = vec4(0.6, 0.6, 0.6, 1.0);
+		out_roughness_metallic_emissive = vec4(0.5, 0.0, 0.0, 0.0);
+		out_position = in_world_position;
+		out_normal = normalize(in_world_normal);
+	}
+}
+
+#endif // GEOMETRY_FS_H
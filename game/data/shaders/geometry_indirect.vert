@@ -0,0 +1,31 @@
+#version 450
+
+#include "shader_common.h"
+
+// geometry.vert for indirect draws from the mesh pool: each instance finds
+// its DrawRecord through draw_instance_array[gl_InstanceIndex]
+layout(location = 0) in vec4 in_position;
+layout(location = 1) in vec4 in_normal;
+layout(location = 2) in vec2 in_texcoord;
+
+layout(location = 0) out vec4 out_world_position;
+layout(location = 1) out vec4 out_world_normal;
+layout(location = 2) out vec2 out_texcoord;
+layout(location = 3) flat out int out_material_index;
+layout(location = 4) out vec4 out_skin_debug_color;
+layout(location = 5) flat out int out_is_skinned_mesh;
+
+void main()
+{
+	DrawRecord record = draw_record_array[draw_instance_array[gl_InstanceIndex]];
+	ObjectData obj = object_data_array[record.object_index];
+
+	out_world_position = obj.model_matrix * in_position;
+	out_world_normal = obj.rotation_matrix * in_normal;
+	out_texcoord = in_texcoord;
+	out_material_index = obj.material_index;
+	out_skin_debug_color = vec4(0.0);
+	out_is_skinned_mesh = 0;
+
+	gl_Position = per_frame.view_projection * out_world_position;
+}
@@ -36,7 +36,7 @@ void main()
 	GI_Probe probe = probes[probe_index];
 	bool visible = probe_level_filter_enable != 0
 		? (probe_level_filter_selection == 0
-			? probe.octree_level < 0
+			? probe.octree_level == GI_PROBE_LEVEL_FALLBACK
 			: probe.octree_level == probe_level_filter_selection - 1)
 		: probe.octree_level >= 0;
 	if (!visible)
@@ -9,6 +9,11 @@
 
 #define GI_MAX_OCTREE_SEARCH_DEPTH 32
 #define GI_RADIAL_DEPTH_CELL_SCALE 4.0
+// GI_Probe.octree_level values below the octree levels: the scene-wide
+// fallback probe, and a slot freed by an incremental layout patch (never
+// referenced by a cell)
+#define GI_PROBE_LEVEL_FALLBACK -1
+#define GI_PROBE_LEVEL_UNUSED -2
 
 struct GI_Coords
 {
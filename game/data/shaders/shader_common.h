@@ -60,6 +60,20 @@ struct ObjectData
 	int _pad2;
 };
 
+// Indirect draws (src/render/indirect_draw.h): one record per pooled mesh
+// object. Instance i of a command reads draw_instance_array[firstInstance + i]
+// for its record index, so linked duplicates draw as one instanced command.
+// The quantization box is only read by the compact variants. 48 bytes.
+struct DrawRecord
+{
+	int object_index;		// into object_data_array
+	int _pad0;
+	int _pad1;
+	int _pad2;
+	vec4 position_min;		// w unused
+	vec4 position_extent;	// w unused
+};
+
 // Light data for the lighting-pass SSBOs uses byte-identical C++ and GLSL
 // layouts. Three-component values use vec4 storage because std430 gives
 // vec3 the same alignment; .xyz contains data and .w is padding.
@@ -145,6 +159,17 @@ layout(set = 0, binding = 4) uniform texture2D scene_textures[MAX_BINDLESS_IMAGE
 layout(set = 0, binding = 5) uniform sampler scene_sampler;
 #define SCENE_TEXTURE(image_index) scene_textures[nonuniformEXT(image_index)]
 
+layout(set = 0, binding = 6, std430) readonly buffer DrawRecordBlock
+{
+	DrawRecord draw_record_array[];
+};
+
+// Per view, the DrawRecord index of every instance in command order
+layout(set = 0, binding = 7, std430) readonly buffer DrawInstanceBlock
+{
+	uint draw_instance_array[];
+};
+
 // Weighted 4-bone skin matrix; identity when total weight is ~zero.
 // in_base_offset selects the mesh's slice of the per-frame matrix arena.
 mat4 get_skin_matrix(int in_base_offset, vec4 in_joint_indices, vec4 in_joint_weights)
@@ -0,0 +1,25 @@
+#version 450
+
+#include "shader_common.h"
+
+// CompactVertex input; only the position is needed for depth
+layout(location = 0) in vec4 in_position;	// unorm, relative to the mesh AABB
+layout(location = 1) in vec2 in_normal;
+layout(location = 2) in vec2 in_texcoord;
+
+layout(push_constant) uniform PushConstants
+{
+	mat4 light_view_projection;
+	int object_index;
+	int skin_matrix_offset;
+	int _pad0[2];
+	vec4 position_min;
+	vec4 position_extent;
+} pc;
+
+void main()
+{
+	ObjectData obj = object_data_array[pc.object_index];
+	vec4 local_position = vec4(pc.position_min.xyz + in_position.xyz * pc.position_extent.xyz, 1.0);
+	gl_Position = pc.light_view_projection * obj.model_matrix * local_position;
+}
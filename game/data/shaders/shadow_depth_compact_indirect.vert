@@ -0,0 +1,21 @@
+#version 450
+
+#include "shader_common.h"
+
+// CompactVertex input; only the position is needed for depth
+layout(location = 0) in vec4 in_position;	// unorm, relative to the mesh AABB
+layout(location = 1) in vec2 in_normal;
+layout(location = 2) in vec2 in_texcoord;
+
+layout(push_constant) uniform PushConstants
+{
+	mat4 light_view_projection;
+} pc;
+
+void main()
+{
+	DrawRecord record = draw_record_array[draw_instance_array[gl_InstanceIndex]];
+	ObjectData obj = object_data_array[record.object_index];
+	vec4 local_position = vec4(record.position_min.xyz + in_position.xyz * record.position_extent.xyz, 1.0);
+	gl_Position = pc.light_view_projection * obj.model_matrix * local_position;
+}
@@ -0,0 +1,21 @@
+#version 450
+
+#include "shader_common.h"
+
+layout(location = 0) in vec4 in_position;
+layout(location = 1) in vec4 in_normal;
+layout(location = 2) in vec2 in_texcoord;
+
+// Indirect cascade draws: the light view-projection is still pushed per
+// cascade; each instance's object comes from its DrawRecord
+layout(push_constant) uniform PushConstants
+{
+	mat4 light_view_projection;
+} pc;
+
+void main()
+{
+	DrawRecord record = draw_record_array[draw_instance_array[gl_InstanceIndex]];
+	ObjectData obj = object_data_array[record.object_index];
+	gl_Position = pc.light_view_projection * obj.model_matrix * in_position;
+}
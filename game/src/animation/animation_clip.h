@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cassert>
+#include <cstdlib>
+
+#include "animation/animation_compression.h"
+#include "core/types.h"
+
+// ---- Animation clips ----
+// A clip holds per-frame skin matrices, either as frame-major matrices or
+// as a compact clip (animation/animation_compression.h). Import compresses
+// matrices when they decompose; clips that don't keep the matrices. Both
+// forms are sampled at fractional frames: compact clips interpolate between
+// their keys, matrix clips blend the two neighbouring frames.
+
+struct AnimationClip
+{
+	char* name = nullptr;
+	f32 frame_rate = 0.0f;
+	f32 duration_seconds = 0.0f;
+	i32 frame_count = 0;
+	i32 bone_count = 0;
+	HMM_Mat4* skin_matrices = nullptr;	// frame-major [frame_count * bone_count]; null when compressed
+	CompressedAnimation compressed;	// used when compressed.tracks is set
+};
+
+inline bool animation_clip_is_compressed(const AnimationClip& in_clip)
+{
+	return in_clip.compressed.tracks != nullptr;
+}
+
+inline bool animation_clip_has_frames(const AnimationClip& in_clip)
+{
+	return (in_clip.skin_matrices || animation_clip_is_compressed(in_clip)) && in_clip.frame_count > 0 && in_clip.bone_count > 0;
+}
+
+// Frame position (0 .. frame_count - 1) for a playback time
+inline f32 animation_clip_frame_at(const AnimationClip& in_clip, f32 in_playback_time)
+{
+	if (in_clip.frame_rate <= 0.0f || in_clip.frame_count <= 0)
+	{
+		return 0.0f;
+	}
+	return CLAMP(in_playback_time * in_clip.frame_rate, 0.0f, (f32) (in_clip.frame_count - 1));
+}
+
+// Skin matrices of the first in_bone_count (<= bone_count) bones at a
+// fractional frame; frames outside the clip hold its first or last frame
+inline void animation_clip_sample_pose(const AnimationClip& in_clip, f32 in_frame, HMM_Mat4* out_matrices, i32 in_bone_count)
+{
+	assert(animation_clip_has_frames(in_clip) && in_bone_count <= in_clip.bone_count);
+	const f32 frame = CLAMP(in_frame, 0.0f, (f32) (in_clip.frame_count - 1));
+	if (animation_clip_is_compressed(in_clip))
+	{
+		animation_sample_pose(in_clip.compressed, frame, out_matrices, in_bone_count);
+		return;
+	}
+
+	const i32 frame_idx = MIN((i32) frame, in_clip.frame_count - 1);
+	const i32 next_frame_idx = MIN(frame_idx + 1, in_clip.frame_count - 1);
+	const f32 t = frame - (f32) frame_idx;
+	const HMM_Mat4* from = in_clip.skin_matrices + (size_t) frame_idx * in_clip.bone_count;
+	const HMM_Mat4* to = in_clip.skin_matrices + (size_t) next_frame_idx * in_clip.bone_count;
+	for (i32 bone_idx = 0; bone_idx < in_bone_count; ++bone_idx)
+	{
+		out_matrices[bone_idx] = t > 0.0f ? from[bone_idx] * (1.0f - t) + to[bone_idx] * t : from[bone_idx];
+	}
+}
+
+inline u64 animation_clip_byte_count(const AnimationClip& in_clip)
+{
+	if (animation_clip_is_compressed(in_clip))
+	{
+		return compressed_animation_byte_count(in_clip.compressed);
+	}
+	return in_clip.skin_matrices ? sizeof(HMM_Mat4) * (u64) MAX(in_clip.frame_count * in_clip.bone_count, 0) : 0;
+}
+
+// Replaces the clip's matrices with a compact clip when every matrix
+// decomposes; otherwise leaves the matrices. Returns true when compressed.
+inline bool animation_clip_compress(AnimationClip& in_out_clip, AnimationReductionScratch& in_out_scratch)
+{
+	if (animation_clip_is_compressed(in_out_clip) || !in_out_clip.skin_matrices)
+	{
+		return animation_clip_is_compressed(in_out_clip);
+	}
+	if (!animation_compress(in_out_clip.skin_matrices, in_out_clip.frame_count, in_out_clip.bone_count, in_out_clip.compressed, in_out_scratch))
+	{
+		return false;
+	}
+	free(in_out_clip.skin_matrices);
+	in_out_clip.skin_matrices = nullptr;
+	return true;
+}
+
+inline void animation_clip_free(AnimationClip& in_out_clip)
+{
+	free(in_out_clip.name);
+	free(in_out_clip.skin_matrices);
+	compressed_animation_free(in_out_clip.compressed);
+	in_out_clip = {};
+}
@@ -0,0 +1,609 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+
+// ---- Animation compression ----
+// Compact clips. Every skin matrix is decomposed into translation, rotation
+// and scale, and each bone gets one track per channel. A track keeps only the
+// keys its channel tolerance needs under interpolation between keys (lerp for
+// translation/scale, normalized lerp for rotation); a channel that never
+// moves is a single key. Rotation keys are 48-bit smallest-three quaternions.
+//
+// Keys are chosen against the source frames after quantization, so at any
+// source frame a point p moved by a reconstructed skin matrix is off by at most
+//   ANIMATION_TRANSLATION_TOLERANCE
+//   + |p| * (ANIMATION_ROTATION_TOLERANCE * max |scale| + ANIMATION_SCALE_TOLERANCE)
+//   + sqrt(3) * |p| * ANIMATION_DECOMPOSE_TOLERANCE * max |scale|
+// Matrices that are not translation * rotation * scale (shear from
+// non-uniform parent scale, collapsed axes, projective rows) make
+// animation_compress fail, and the clip keeps its matrices.
+
+static constexpr f32 ANIMATION_TRANSLATION_TOLERANCE = 0.0001f;	// metres
+static constexpr f32 ANIMATION_ROTATION_TOLERANCE = 0.0005f;	// radians
+static constexpr f32 ANIMATION_SCALE_TOLERANCE = 0.0001f;	// per axis
+static constexpr f32 ANIMATION_DECOMPOSE_TOLERANCE = 0.0001f;	// basis error per unit of scale
+
+// Key frames are u16
+static constexpr i32 ANIMATION_COMPRESS_MAX_FRAMES = 65536;
+
+enum class EAnimationChannel : u8
+{
+	Translation,
+	Rotation,
+	Scale,
+	Count,
+};
+static constexpr i32 ANIMATION_CHANNEL_COUNT = (i32) EAnimationChannel::Count;
+
+// Smallest three: the largest component is dropped (and made positive), the
+// other three are 15-bit fractions of [-1/sqrt(2), 1/sqrt(2)] in order. The
+// dropped component's index is bit 15 of components[0] (low) and [1] (high).
+struct PackedQuaternion
+{
+	u16 components[3];
+};
+static_assert(sizeof(PackedQuaternion) == 6, "PackedQuaternion is three u16s on the wire");
+
+// Keys [first_key, first_key + key_count) of the track's channel arrays
+struct AnimationTrack
+{
+	u32 first_key;
+	u32 key_count;
+};
+
+struct CompressedAnimation
+{
+	i32 frame_count = 0;
+	i32 bone_count = 0;
+
+	// [bone_count * ANIMATION_CHANNEL_COUNT], bone-major:
+	// tracks[bone * ANIMATION_CHANNEL_COUNT + (i32) EAnimationChannel::X]
+	AnimationTrack* tracks = nullptr;
+
+	// Translation and scale keys share these arrays; each key's source frame
+	// is in the matching *_key_frames entry, ascending within a track
+	u32 vector_key_count = 0;
+	u16* vector_key_frames = nullptr;
+	HMM_Vec3* vector_keys = nullptr;
+
+	u32 rotation_key_count = 0;
+	u16* rotation_key_frames = nullptr;
+	PackedQuaternion* rotation_keys = nullptr;
+};
+
+static constexpr f32 PACKED_QUATERNION_RANGE = 0.70710678f;
+static constexpr f32 PACKED_QUATERNION_SCALE = 32767.0f;
+
+inline PackedQuaternion packed_quaternion_encode(HMM_Quat in_quat)
+{
+	in_quat = HMM_NormQ(in_quat);
+	i32 largest_idx = 0;
+	for (i32 component_idx = 1; component_idx < 4; ++component_idx)
+	{
+		if (fabsf(in_quat.Elements[component_idx]) > fabsf(in_quat.Elements[largest_idx]))
+		{
+			largest_idx = component_idx;
+		}
+	}
+	const f32 sign = in_quat.Elements[largest_idx] < 0.0f ? -1.0f : 1.0f;
+
+	PackedQuaternion out_packed = {};
+	for (i32 component_idx = 0, packed_idx = 0; component_idx < 4; ++component_idx)
+	{
+		if (component_idx == largest_idx)
+		{
+			continue;
+		}
+		const f32 unit = CLAMP(sign * in_quat.Elements[component_idx] / PACKED_QUATERNION_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+		out_packed.components[packed_idx++] = (u16) lrintf(unit * PACKED_QUATERNION_SCALE);
+	}
+	out_packed.components[0] |= (u16) ((largest_idx & 1) << 15);
+	out_packed.components[1] |= (u16) ((largest_idx >> 1) << 15);
+	return out_packed;
+}
+
+inline HMM_Quat packed_quaternion_decode(const PackedQuaternion& in_packed)
+{
+	const i32 largest_idx = (in_packed.components[0] >> 15) | ((in_packed.components[1] >> 15) << 1);
+	HMM_Quat out_quat;
+	f32 sum_squares = 0.0f;
+	for (i32 component_idx = 0, packed_idx = 0; component_idx < 4; ++component_idx)
+	{
+		if (component_idx == largest_idx)
+		{
+			continue;
+		}
+		const f32 unit = (f32) (in_packed.components[packed_idx++] & 0x7fff) / PACKED_QUATERNION_SCALE;
+		const f32 value = (unit * 2.0f - 1.0f) * PACKED_QUATERNION_RANGE;
+		out_quat.Elements[component_idx] = value;
+		sum_squares += value * value;
+	}
+	out_quat.Elements[largest_idx] = sqrtf(MAX(1.0f - sum_squares, 0.0f));
+	return out_quat;
+}
+
+// translation * rotation * scale, built column by column. in_rotation must be
+// unit length (HMM_QToM4 would normalize it again).
+inline HMM_Mat4 animation_compose_trs(const HMM_Vec3 in_translation, const HMM_Quat in_rotation, const HMM_Vec3 in_scale)
+{
+	const f32 x = in_rotation.X, y = in_rotation.Y, z = in_rotation.Z, w = in_rotation.W;
+	const f32 xx = x * x, yy = y * y, zz = z * z;
+	const f32 xy = x * y, xz = x * z, yz = y * z;
+	const f32 wx = w * x, wy = w * y, wz = w * z;
+
+	HMM_Mat4 out_matrix;
+	out_matrix.Columns[0] = HMM_V4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * in_scale.X;
+	out_matrix.Columns[1] = HMM_V4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * in_scale.Y;
+	out_matrix.Columns[2] = HMM_V4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * in_scale.Z;
+	out_matrix.Columns[3] = HMM_V4V(in_translation, 1.0f);
+	return out_matrix;
+}
+
+// Splits an affine matrix into translation * rotation * scale (a mirrored
+// basis gets a negative X scale). Fails when the result would rebuild any
+// basis column off by more than ANIMATION_DECOMPOSE_TOLERANCE per unit of
+// scale, or the matrix has a collapsed axis or a projective row.
+inline bool animation_decompose_trs(const HMM_Mat4& in_matrix, HMM_Vec3& out_translation, HMM_Quat& out_rotation, HMM_Vec3& out_scale)
+{
+	const HMM_Vec4 row_3 = HMM_V4(in_matrix.Columns[0].W, in_matrix.Columns[1].W, in_matrix.Columns[2].W, in_matrix.Columns[3].W);
+	if (fabsf(row_3.X) > 1e-6f || fabsf(row_3.Y) > 1e-6f || fabsf(row_3.Z) > 1e-6f || fabsf(row_3.W - 1.0f) > 1e-6f)
+	{
+		return false;
+	}
+
+	HMM_Vec3 columns[3] = { in_matrix.Columns[0].XYZ, in_matrix.Columns[1].XYZ, in_matrix.Columns[2].XYZ };
+	f32 scales[3];
+	for (i32 axis_idx = 0; axis_idx < 3; ++axis_idx)
+	{
+		scales[axis_idx] = HMM_LenV3(columns[axis_idx]);
+		if (!(scales[axis_idx] > 1e-6f))
+		{
+			return false;
+		}
+	}
+	if (HMM_DotV3(HMM_Cross(columns[0], columns[1]), columns[2]) < 0.0f)
+	{
+		scales[0] = -scales[0];
+	}
+
+	HMM_Mat4 rotation = HMM_M4D(1.0f);
+	for (i32 axis_idx = 0; axis_idx < 3; ++axis_idx)
+	{
+		rotation.Columns[axis_idx] = HMM_V4V(columns[axis_idx] / scales[axis_idx], 0.0f);
+	}
+
+	out_translation = in_matrix.Columns[3].XYZ;
+	out_rotation = HMM_NormQ(HMM_M4ToQ_RH(rotation));
+	out_scale = HMM_V3(scales[0], scales[1], scales[2]);
+
+	const HMM_Mat4 rebuilt = animation_compose_trs(out_translation, out_rotation, out_scale);
+	const f32 largest_scale = MAX(MAX(fabsf(scales[0]), fabsf(scales[1])), fabsf(scales[2]));
+	for (i32 axis_idx = 0; axis_idx < 3; ++axis_idx)
+	{
+		if (HMM_LenV3(rebuilt.Columns[axis_idx].XYZ - columns[axis_idx]) > ANIMATION_DECOMPOSE_TOLERANCE * largest_scale)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Rotation between two unit quaternions, in radians. Taken from the
+// relative rotation conj(a) * b with atan2, since acos of their dot product
+// cannot resolve angles below ~1e-3 in f32.
+inline f64 animation_rotation_error(const HMM_Quat in_a, const HMM_Quat in_b)
+{
+	const f64 ax = in_a.X, ay = in_a.Y, az = in_a.Z, aw = in_a.W;
+	const f64 bx = in_b.X, by = in_b.Y, bz = in_b.Z, bw = in_b.W;
+	const f64 w = aw * bw + ax * bx + ay * by + az * bz;
+	const f64 x = aw * bx - ax * bw - ay * bz + az * by;
+	const f64 y = aw * by - ay * bw - az * bx + ax * bz;
+	const f64 z = aw * bz - az * bw - ax * by + ay * bx;
+	return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+inline HMM_Quat animation_rotation_interpolate(const HMM_Quat in_a, f32 in_t, HMM_Quat in_b)
+{
+	if (HMM_DotQ(in_a, in_b) < 0.0f)
+	{
+		in_b = HMM_Q(-in_b.X, -in_b.Y, -in_b.Z, -in_b.W);
+	}
+	return HMM_NLerp(in_a, in_t, in_b);
+}
+
+// Key index and blend for in_frame within ascending key frames: the sample
+// is key out_key lerped toward out_key + 1 by out_t. Frames before the first
+// key or after the last hold that key.
+inline void animation_track_locate(const u16* in_key_frames, u32 in_key_count, f32 in_frame, u32& out_key, f32& out_t)
+{
+	out_t = 0.0f;
+	if (in_key_count <= 1 || in_frame <= (f32) in_key_frames[0])
+	{
+		out_key = 0;
+		return;
+	}
+	if (in_frame >= (f32) in_key_frames[in_key_count - 1])
+	{
+		out_key = in_key_count - 1;
+		return;
+	}
+
+	// Largest key with frame <= in_frame. Keys are usually spread evenly, so
+	// the search starts from where an even spread would put the frame; that
+	// guess and its neighbour settle most lookups without the bisection.
+	u32 low = 0;
+	u32 high = in_key_count - 1;
+	const f32 first_frame = (f32) in_key_frames[0];
+	const f32 last_frame = (f32) in_key_frames[in_key_count - 1];
+	const u32 guess = MIN((u32) ((in_frame - first_frame) / (last_frame - first_frame) * (f32) high), high - 1);
+	if ((f32) in_key_frames[guess] <= in_frame)
+	{
+		low = guess;
+		if ((f32) in_key_frames[guess + 1] > in_frame)
+		{
+			high = guess + 1;
+		}
+		else
+		{
+			low = guess + 1;
+		}
+	}
+	else
+	{
+		high = guess;
+	}
+	while (high - low > 1)
+	{
+		const u32 middle = (low + high) / 2;
+		if ((f32) in_key_frames[middle] <= in_frame)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	out_key = low;
+	out_t = (in_frame - (f32) in_key_frames[low]) / (f32) (in_key_frames[low + 1] - in_key_frames[low]);
+}
+
+inline HMM_Vec3 animation_sample_vector_track(const CompressedAnimation& in_animation, const AnimationTrack& in_track, f32 in_frame)
+{
+	const u16* key_frames = in_animation.vector_key_frames + in_track.first_key;
+	const HMM_Vec3* keys = in_animation.vector_keys + in_track.first_key;
+	u32 key_idx;
+	f32 t;
+	animation_track_locate(key_frames, in_track.key_count, in_frame, key_idx, t);
+	return t > 0.0f ? HMM_LerpV3(keys[key_idx], t, keys[key_idx + 1]) : keys[key_idx];
+}
+
+inline HMM_Quat animation_sample_rotation_track(const CompressedAnimation& in_animation, const AnimationTrack& in_track, f32 in_frame)
+{
+	const u16* key_frames = in_animation.rotation_key_frames + in_track.first_key;
+	const PackedQuaternion* keys = in_animation.rotation_keys + in_track.first_key;
+	u32 key_idx;
+	f32 t;
+	animation_track_locate(key_frames, in_track.key_count, in_frame, key_idx, t);
+	const HMM_Quat from = packed_quaternion_decode(keys[key_idx]);
+	return t > 0.0f ? animation_rotation_interpolate(from, t, packed_quaternion_decode(keys[key_idx + 1])) : from;
+}
+
+// Skin matrix of one bone at a fractional frame
+inline HMM_Mat4 animation_sample_bone(const CompressedAnimation& in_animation, i32 in_bone_idx, f32 in_frame)
+{
+	const AnimationTrack* tracks = in_animation.tracks + in_bone_idx * ANIMATION_CHANNEL_COUNT;
+	return animation_compose_trs(
+		animation_sample_vector_track(in_animation, tracks[(i32) EAnimationChannel::Translation], in_frame),
+		animation_sample_rotation_track(in_animation, tracks[(i32) EAnimationChannel::Rotation], in_frame),
+		animation_sample_vector_track(in_animation, tracks[(i32) EAnimationChannel::Scale], in_frame)
+	);
+}
+
+// Skin matrices of the first in_bone_count bones at a fractional frame
+inline void animation_sample_pose(const CompressedAnimation& in_animation, f32 in_frame, HMM_Mat4* out_matrices, i32 in_bone_count)
+{
+	for (i32 bone_idx = 0; bone_idx < in_bone_count; ++bone_idx)
+	{
+		out_matrices[bone_idx] = animation_sample_bone(in_animation, bone_idx, in_frame);
+	}
+}
+
+// Checks every track and key frame so sampling cannot read out of bounds.
+// Compact clips from the wire go through this before use.
+inline bool compressed_animation_is_valid(const CompressedAnimation& in_animation)
+{
+	if (in_animation.frame_count <= 0 || in_animation.frame_count > ANIMATION_COMPRESS_MAX_FRAMES
+		|| in_animation.bone_count <= 0 || !in_animation.tracks)
+	{
+		return false;
+	}
+
+	for (i32 track_idx = 0; track_idx < in_animation.bone_count * ANIMATION_CHANNEL_COUNT; ++track_idx)
+	{
+		const AnimationTrack& track = in_animation.tracks[track_idx];
+		const bool is_rotation = track_idx % ANIMATION_CHANNEL_COUNT == (i32) EAnimationChannel::Rotation;
+		const u32 channel_key_count = is_rotation ? in_animation.rotation_key_count : in_animation.vector_key_count;
+		const u16* key_frames = is_rotation ? in_animation.rotation_key_frames : in_animation.vector_key_frames;
+		if (track.key_count == 0 || track.first_key > channel_key_count || track.key_count > channel_key_count - track.first_key)
+		{
+			return false;
+		}
+		for (u32 key_idx = 0; key_idx < track.key_count; ++key_idx)
+		{
+			const u16 frame = key_frames[track.first_key + key_idx];
+			if ((i32) frame >= in_animation.frame_count || (key_idx > 0 && frame <= key_frames[track.first_key + key_idx - 1]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+inline u64 compressed_animation_byte_count(const CompressedAnimation& in_animation)
+{
+	return sizeof(AnimationTrack) * (u64) in_animation.bone_count * ANIMATION_CHANNEL_COUNT
+		+ (sizeof(u16) + sizeof(HMM_Vec3)) * (u64) in_animation.vector_key_count
+		+ (sizeof(u16) + sizeof(PackedQuaternion)) * (u64) in_animation.rotation_key_count;
+}
+
+inline void compressed_animation_free(CompressedAnimation& in_animation)
+{
+	free(in_animation.tracks);
+	free(in_animation.vector_key_frames);
+	free(in_animation.vector_keys);
+	free(in_animation.rotation_key_frames);
+	free(in_animation.rotation_keys);
+	in_animation = {};
+}
+
+// Allocates the arrays for the given sizes (contents uninitialized)
+inline void compressed_animation_allocate(CompressedAnimation& out_animation, i32 in_frame_count, i32 in_bone_count, u32 in_vector_key_count, u32 in_rotation_key_count)
+{
+	out_animation.frame_count = in_frame_count;
+	out_animation.bone_count = in_bone_count;
+	out_animation.tracks = (AnimationTrack*) malloc(sizeof(AnimationTrack) * (size_t) in_bone_count * ANIMATION_CHANNEL_COUNT);
+	out_animation.vector_key_count = in_vector_key_count;
+	out_animation.vector_key_frames = (u16*) malloc(sizeof(u16) * MAX(in_vector_key_count, 1u));
+	out_animation.vector_keys = (HMM_Vec3*) malloc(sizeof(HMM_Vec3) * MAX(in_vector_key_count, 1u));
+	out_animation.rotation_key_count = in_rotation_key_count;
+	out_animation.rotation_key_frames = (u16*) malloc(sizeof(u16) * MAX(in_rotation_key_count, 1u));
+	out_animation.rotation_keys = (PackedQuaternion*) malloc(sizeof(PackedQuaternion) * MAX(in_rotation_key_count, 1u));
+}
+
+// ---- Keyframe reduction ----
+
+struct AnimationReductionScratch
+{
+	DynamicArray<HMM_Vec3> translations;	// [frame_count], one bone at a time
+	DynamicArray<HMM_Quat> rotations;
+	DynamicArray<HMM_Vec3> scales;
+	DynamicArray<u16> key_frames;
+
+	DynamicArray<AnimationTrack> tracks;
+	DynamicArray<u16> vector_key_frames;
+	DynamicArray<HMM_Vec3> vector_keys;
+	DynamicArray<u16> rotation_key_frames;
+	DynamicArray<PackedQuaternion> rotation_keys;
+};
+
+inline f64 animation_vector_error(const HMM_Vec3 in_a, const HMM_Vec3 in_b, bool in_per_axis)
+{
+	const HMM_Vec3 delta = in_a - in_b;
+	if (in_per_axis)
+	{
+		return MAX(MAX(fabsf(delta.X), fabsf(delta.Y)), fabsf(delta.Z));
+	}
+	return sqrt((f64) delta.X * delta.X + (f64) delta.Y * delta.Y + (f64) delta.Z * delta.Z);
+}
+
+// True when every source frame in [in_from, in_to] is within tolerance of
+// the interpolation between the keys stored for in_from and in_to
+inline bool animation_vector_segment_fits(const HMM_Vec3* in_values, i32 in_from, i32 in_to, f64 in_tolerance, bool in_per_axis)
+{
+	const f32 span = (f32) MAX(in_to - in_from, 1);
+	for (i32 frame_idx = in_from + 1; frame_idx < in_to; ++frame_idx)
+	{
+		const HMM_Vec3 sample = HMM_LerpV3(in_values[in_from], (f32) (frame_idx - in_from) / span, in_values[in_to]);
+		if (animation_vector_error(sample, in_values[frame_idx], in_per_axis) > in_tolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Rotation keys are quantized, so the keys' own frames are checked too
+inline bool animation_rotation_segment_fits(const HMM_Quat* in_values, i32 in_from, i32 in_to)
+{
+	const HMM_Quat from_key = packed_quaternion_decode(packed_quaternion_encode(in_values[in_from]));
+	const HMM_Quat to_key = packed_quaternion_decode(packed_quaternion_encode(in_values[in_to]));
+	const f32 span = (f32) MAX(in_to - in_from, 1);
+	for (i32 frame_idx = in_from; frame_idx <= in_to; ++frame_idx)
+	{
+		const HMM_Quat sample = animation_rotation_interpolate(from_key, (f32) (frame_idx - in_from) / span, to_key);
+		if (animation_rotation_error(sample, in_values[frame_idx]) > ANIMATION_ROTATION_TOLERANCE)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Greedy key placement for one track. in_holds(key) says whether that key
+// alone covers every frame; in_fits(from, to) whether interpolating the two
+// keys covers every frame between them. From each key the next one is
+// pushed as far as the segment still fits: doubling the reach until it
+// fails, then bisecting the last step. A segment is only accepted after
+// every frame in it was checked, so the tolerance holds even where the
+// error does not grow monotonically with length.
+template <typename HoldsFn, typename FitsFn>
+inline void animation_reduce_track(i32 in_frame_count, HoldsFn in_holds, FitsFn in_fits, DynamicArray<u16>& out_key_frames)
+{
+	out_key_frames.clear();
+	out_key_frames.add(0);
+	if (in_frame_count == 1 || in_holds(0))
+	{
+		return;
+	}
+
+	i32 key = 0;
+	while (key < in_frame_count - 1)
+	{
+		i32 good = key + 1;
+		i32 bad = -1;
+		for (i32 step = 2; ; step *= 2)
+		{
+			const i32 candidate = MIN(key + step, in_frame_count - 1);
+			if (candidate == good)
+			{
+				break;
+			}
+			if (!in_fits(key, candidate))
+			{
+				bad = candidate;
+				break;
+			}
+			good = candidate;
+		}
+		while (bad > 0 && bad - good > 1)
+		{
+			const i32 middle = (good + bad) / 2;
+			if (in_fits(key, middle))
+			{
+				good = middle;
+			}
+			else
+			{
+				bad = middle;
+			}
+		}
+		out_key_frames.add((u16) good);
+		key = good;
+	}
+}
+
+inline bool animation_vector_segment_fits_constant(const HMM_Vec3* in_values, i32 in_frame_count, i32 in_key, f64 in_tolerance, bool in_per_axis)
+{
+	for (i32 frame_idx = 0; frame_idx < in_frame_count; ++frame_idx)
+	{
+		if (animation_vector_error(in_values[in_key], in_values[frame_idx], in_per_axis) > in_tolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+inline void animation_append_vector_track(AnimationReductionScratch& in_out_scratch, const HMM_Vec3* in_values)
+{
+	in_out_scratch.tracks.add({ .first_key = (u32) in_out_scratch.vector_key_frames.length(), .key_count = (u32) in_out_scratch.key_frames.length() });
+	for (u16 key_frame : in_out_scratch.key_frames)
+	{
+		in_out_scratch.vector_key_frames.add(key_frame);
+		in_out_scratch.vector_keys.add(in_values[key_frame]);
+	}
+}
+
+// Builds out_animation from frame-major skin matrices
+// ([in_frame_count * in_bone_count]). Returns false, leaving it empty, when
+// some matrix is not TRS or the clip has too many frames.
+inline bool animation_compress(
+	const HMM_Mat4* in_skin_matrices,
+	i32 in_frame_count,
+	i32 in_bone_count,
+	CompressedAnimation& out_animation,
+	AnimationReductionScratch& in_out_scratch)
+{
+	out_animation = {};
+	if (!in_skin_matrices || in_frame_count <= 0 || in_frame_count > ANIMATION_COMPRESS_MAX_FRAMES || in_bone_count <= 0)
+	{
+		return false;
+	}
+
+	AnimationReductionScratch& scratch = in_out_scratch;
+	scratch.tracks.clear();
+	scratch.vector_key_frames.clear();
+	scratch.vector_keys.clear();
+	scratch.rotation_key_frames.clear();
+	scratch.rotation_keys.clear();
+	scratch.translations.resize(in_frame_count);
+	scratch.rotations.resize(in_frame_count);
+	scratch.scales.resize(in_frame_count);
+
+	for (i32 bone_idx = 0; bone_idx < in_bone_count; ++bone_idx)
+	{
+		for (i32 frame_idx = 0; frame_idx < in_frame_count; ++frame_idx)
+		{
+			if (!animation_decompose_trs(
+				in_skin_matrices[(size_t) frame_idx * in_bone_count + bone_idx],
+				scratch.translations[frame_idx],
+				scratch.rotations[frame_idx],
+				scratch.scales[frame_idx]))
+			{
+				return false;
+			}
+		}
+
+		// Translation and scale keys are stored exactly
+		const HMM_Vec3* translations = scratch.translations.data();
+		animation_reduce_track(in_frame_count,
+			[&](i32 in_key) { return animation_vector_segment_fits_constant(translations, in_frame_count, in_key, ANIMATION_TRANSLATION_TOLERANCE, false); },
+			[&](i32 in_from, i32 in_to) { return animation_vector_segment_fits(translations, in_from, in_to, ANIMATION_TRANSLATION_TOLERANCE, false); },
+			scratch.key_frames);
+		animation_append_vector_track(scratch, translations);
+
+		// Each rotation is flipped into the previous frame's hemisphere so
+		// neighbouring keys interpolate the short way
+		HMM_Quat* rotations = scratch.rotations.data();
+		for (i32 frame_idx = 1; frame_idx < in_frame_count; ++frame_idx)
+		{
+			if (HMM_DotQ(rotations[frame_idx - 1], rotations[frame_idx]) < 0.0f)
+			{
+				rotations[frame_idx] = HMM_Q(-rotations[frame_idx].X, -rotations[frame_idx].Y, -rotations[frame_idx].Z, -rotations[frame_idx].W);
+			}
+		}
+		animation_reduce_track(in_frame_count,
+			[&](i32 in_key)
+			{
+				const HMM_Quat key = packed_quaternion_decode(packed_quaternion_encode(rotations[in_key]));
+				for (i32 frame_idx = 0; frame_idx < in_frame_count; ++frame_idx)
+				{
+					if (animation_rotation_error(key, rotations[frame_idx]) > ANIMATION_ROTATION_TOLERANCE)
+					{
+						return false;
+					}
+				}
+				return true;
+			},
+			[&](i32 in_from, i32 in_to) { return animation_rotation_segment_fits(rotations, in_from, in_to); },
+			scratch.key_frames);
+		scratch.tracks.add({ .first_key = (u32) scratch.rotation_key_frames.length(), .key_count = (u32) scratch.key_frames.length() });
+		for (u16 key_frame : scratch.key_frames)
+		{
+			scratch.rotation_key_frames.add(key_frame);
+			scratch.rotation_keys.add(packed_quaternion_encode(rotations[key_frame]));
+		}
+
+		const HMM_Vec3* scales = scratch.scales.data();
+		animation_reduce_track(in_frame_count,
+			[&](i32 in_key) { return animation_vector_segment_fits_constant(scales, in_frame_count, in_key, ANIMATION_SCALE_TOLERANCE, true); },
+			[&](i32 in_from, i32 in_to) { return animation_vector_segment_fits(scales, in_from, in_to, ANIMATION_SCALE_TOLERANCE, true); },
+			scratch.key_frames);
+		animation_append_vector_track(scratch, scales);
+	}
+
+	compressed_animation_allocate(out_animation, in_frame_count, in_bone_count, (u32) scratch.vector_keys.length(), (u32) scratch.rotation_keys.length());
+	memcpy(out_animation.tracks, scratch.tracks.data(), sizeof(AnimationTrack) * scratch.tracks.length());
+	memcpy(out_animation.vector_key_frames, scratch.vector_key_frames.data(), sizeof(u16) * scratch.vector_key_frames.length());
+	memcpy(out_animation.vector_keys, scratch.vector_keys.data(), sizeof(HMM_Vec3) * scratch.vector_keys.length());
+	memcpy(out_animation.rotation_key_frames, scratch.rotation_key_frames.data(), sizeof(u16) * scratch.rotation_key_frames.length());
+	memcpy(out_animation.rotation_keys, scratch.rotation_keys.data(), sizeof(PackedQuaternion) * scratch.rotation_keys.length());
+	return true;
+}
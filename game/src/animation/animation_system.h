@@ -21,7 +21,7 @@ namespace AnimationSystem
 	
 			Armature& armature = found->second.armature;
 			armature.playback_time = 0.0f;
-			armature.current_frame = 0;
+			armature.current_frame = 0.0f;
 		}
 	}
 	
@@ -63,22 +63,143 @@ namespace AnimationSystem
 				}
 			}
 	
-			if (animation->frame_rate > 0.0f)
+			armature.current_frame = animation_clip_frame_at(*animation, armature.playback_time);
+			in_state.data_oriented.frame.animation_armatures_updated += 1;
+		}
+	}
+	
+	// Samples the pose of every skinned mesh's armature, then refreshes each
+	// mesh's pose bounds (skinned_bounds_evaluate) when that pose changed and
+	// marks its render-object slot so the next flush moves its cull bounds.
+	// Runs after advance, before build_render_object_snapshot. This is the
+	// frame's only sampling of skinned armatures: pack_skin_matrices runs
+	// after it and reads the same poses without resampling.
+	void update_skinned_bounds(State& in_state)
+	{
+		scene_ensure_indexes(in_state);
+		for (i32 skinned_object_id : in_state.scene.indexes.skinned_mesh_object_ids)
+		{
+			auto found = in_state.scene.objects.find(skinned_object_id);
+			if (found == in_state.scene.objects.end())
 			{
-				armature.current_frame = CLAMP((i32)(armature.playback_time * animation->frame_rate), 0, animation->frame_count - 1);
+				continue;
 			}
-			in_state.data_oriented.frame.animation_armatures_updated += 1;
+
+			Object& object = found->second;
+			Mesh& mesh = object.mesh;
+			if (!mesh.has_skinned_vertices)
+			{
+				continue;
+			}
+
+			const HMM_Mat4* pose = nullptr;
+			i32 pose_bone_count = 0;
+			u64 pose_serial = 0;
+			auto armature_found = in_state.scene.objects.find(mesh.armature_id);
+			if (armature_found != in_state.scene.objects.end() && armature_found->second.has_armature)
+			{
+				Armature& armature = armature_found->second.armature;
+				pose = armature_sample_pose(armature);
+				if (pose)
+				{
+					pose_bone_count = armature.pose_clip->bone_count;
+					pose_serial = armature.pose_serial;
+				}
+			}
+
+			if (!mesh.skin_bone_bounds)
+			{
+				continue;
+			}
+
+			if (mesh.animated_bounds_valid && mesh.animated_bounds_pose_serial == pose_serial)
+			{
+				continue;
+			}
+
+			mesh.animated_bounding_box = skinned_bounds_evaluate(
+				mesh.skin_bone_bounds,
+				mesh.skin_matrix_count,
+				pose,
+				pose_bone_count,
+				mesh.mesh_to_armature,
+				mesh.armature_to_mesh
+			);
+			mesh.animated_bounds_pose_serial = pose_serial;
+			mesh.animated_bounds_valid = true;
+			scene_mark_render_object_dirty(in_state, object);
+			in_state.data_oriented.frame.animation_skinned_bounds_updates += 1;
+		}
+	}
+
+	// Serial reference for pack_skin_matrices (GAME2_SKIN_PACK_REFERENCE):
+	// one mesh at a time, staged in mesh.skin_matrices and appended to the
+	// arena, with no shared rows.
+	void pack_skin_matrices_reference(State& in_state)
+	{
+		for (i32 skinned_object_id : in_state.scene.indexes.skinned_mesh_object_ids)
+		{
+			auto found = in_state.scene.objects.find(skinned_object_id);
+			if (found == in_state.scene.objects.end())
+			{
+				continue;
+			}
+	
+			Mesh& mesh = found->second.mesh;
+			mesh.skin_matrix_arena_offset = -1;
+			if (!mesh.has_skinned_vertices || mesh.skin_matrix_count == 0 || !mesh.skin_matrices)
+			{
+				continue;
+			}
+	
+			// The armature is a separate scene object referenced by id
+			const HMM_Mat4* pose = nullptr;
+			u32 pose_bone_count = 0;
+			auto armature_found = in_state.scene.objects.find(mesh.armature_id);
+			if (armature_found != in_state.scene.objects.end() && armature_found->second.has_armature)
+			{
+				Armature& armature = armature_found->second.armature;
+				pose = armature_sampled_pose(armature);
+				if (pose)
+				{
+					pose_bone_count = MIN((u32) armature.pose_clip->bone_count, mesh.skin_matrix_count);
+				}
+			}
+	
+			mesh.skin_matrix_arena_offset = (i32) skin_pack_reference_mesh(
+				pose,
+				pose_bone_count,
+				mesh.mesh_to_armature,
+				mesh.armature_to_mesh,
+				mesh.skin_matrices,
+				mesh.skin_matrix_count,
+				in_state.skin_matrices.items
+			);
+			in_state.data_oriented.frame.animation_skin_matrix_uploads += 1;
 		}
 	}
 	
 	// Computes each skinned mesh's final matrices (armature_to_mesh * clip *
-	// mesh_to_armature) and packs the shared per-frame arena.
+	// mesh_to_armature) and packs the shared per-frame arena. Meshes are
+	// resolved to arena offsets here; the rows are written by
+	// skin_pack_run, on the skin-pack workers once there are enough of them.
+	// Poses were sampled by update_skinned_bounds and are only read here.
+	// A frame task beside build_render_object_snapshot; the main thread
+	// uploads the arena afterwards (skin_matrix_arena_upload).
 	void pack_skin_matrices(State& in_state)
 	{
-		scene_ensure_indexes(in_state);
 		in_state.skin_matrices.items.clear();
 	
 		in_state.data_oriented.frame.animation_skinned_mesh_candidates += (i32) in_state.scene.indexes.skinned_mesh_object_ids.length();
+	
+		if (RuntimeConfig::get().skin_pack_reference)
+		{
+			pack_skin_matrices_reference(in_state);
+			return;
+		}
+	
+		SkinPackBatch& batch = in_state.skin_pack.batch;
+		skin_pack_clear(batch);
 		for (i32 skinned_object_id : in_state.scene.indexes.skinned_mesh_object_ids)
 		{
 			auto found = in_state.scene.objects.find(skinned_object_id);
@@ -94,38 +215,37 @@ namespace AnimationSystem
 				continue;
 			}
 	
-			mesh_reset_skin_matrices(mesh);
-	
-			// The armature is a separate scene object referenced by id
+			SkinPackKey key = {
+				.mesh_to_armature = mesh.mesh_to_armature,
+				.armature_to_mesh = mesh.armature_to_mesh,
+				.matrix_count = mesh.skin_matrix_count,
+			};
+			const HMM_Mat4* pose = nullptr;
 			auto armature_found = in_state.scene.objects.find(mesh.armature_id);
 			if (armature_found != in_state.scene.objects.end() && armature_found->second.has_armature)
 			{
 				Armature& armature = armature_found->second.armature;
-				AnimationClip* animation = armature_get_active_animation(armature);
-				if (animation && animation->skin_matrices && animation->frame_count > 0 && animation->bone_count > 0)
+				pose = armature_sampled_pose(armature);
+				if (pose)
 				{
-					const i32 frame_idx = CLAMP(armature.current_frame, 0, animation->frame_count - 1);
-					const i32 bone_count = MIN(animation->bone_count, (i32) mesh.skin_matrix_count);
-					for (i32 bone_idx = 0; bone_idx < bone_count; ++bone_idx)
-					{
-						const HMM_Mat4& clip_matrix = animation->skin_matrices[frame_idx * animation->bone_count + bone_idx];
-						mesh.skin_matrices[bone_idx] = HMM_MulM4(
-							mesh.armature_to_mesh,
-							HMM_MulM4(clip_matrix, mesh.mesh_to_armature)
-						);
-					}
+					key.pose_source = armature.pose_clip;
+					key.pose_frame = armature.pose_frame;
+					key.pose_bone_count = MIN((u32) armature.pose_clip->bone_count, mesh.skin_matrix_count);
 				}
 			}
 	
-			mesh.skin_matrix_arena_offset = (i32) in_state.skin_matrices.items.length();
-			for (u32 matrix_idx = 0; matrix_idx < mesh.skin_matrix_count; ++matrix_idx)
-			{
-				in_state.skin_matrices.items.add(mesh.skin_matrices[matrix_idx]);
-			}
+			mesh.skin_matrix_arena_offset = (i32) skin_pack_add(batch, key, pose);
 			in_state.data_oriented.frame.animation_skin_matrix_uploads += 1;
 		}
 	
-		skin_matrix_arena_upload(in_state);
+		State::SkinPackState& skin_pack = in_state.skin_pack;
+		if (!skin_pack.workers.is_started() && batch.matrix_count >= SKIN_PACK_PARALLEL_MIN_MATRICES)
+		{
+			skin_pack.workers.start_shared();
+		}
+		in_state.skin_matrices.items.add_uninitialized(batch.matrix_count);
+		skin_pack_run(batch, in_state.skin_matrices.items.data(), &skin_pack.workers);
+		in_state.data_oriented.frame.animation_skin_rows_shared += (i32) batch.shared_mesh_count;
 	}
 }
 
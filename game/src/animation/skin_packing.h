@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstring>
+
+#include "ankerl/unordered_dense.h"
+#include "core/content_hash.h"
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "core/worker_pool.h"
+
+// ---- Skin matrix packing ----
+// Each skinned mesh's rows in the per-frame skin-matrix arena are
+// armature_to_mesh * pose[b] * mesh_to_armature for the bones its armature's
+// pose covers, and identity for the rest.
+//
+// Packing runs in two phases. The main thread resolves every mesh to a
+// SkinPackKey (which pose, which bind matrices) and calls skin_pack_add,
+// which hands out arena offsets. Meshes with equal keys produce equal rows,
+// so they share one job and one offset: parts bound to the same armature
+// with the same bind matrices, or crowd members playing the same clip in
+// step. skin_pack_run then writes each job's rows straight into the arena,
+// split across a WorkerPool by matrix count.
+//
+// skin_pack_reference_mesh is the serial per-mesh path the batch must match
+// row for row; it stages the rows in the mesh's own array first.
+
+static constexpr u32 SKIN_PACK_PARALLEL_MIN_MATRICES = 8192;	// below this one thread is faster
+static constexpr u32 SKIN_PACK_TASK_MATRICES = 2048;	// matrices per worker task
+
+// Everything a mesh's rows depend on. Poses are sampled deterministically
+// from (clip, frame), so armatures on the same clip and frame share rows.
+// Compared and hashed as raw bytes; the layout has no implicit padding.
+struct SkinPackKey
+{
+	HMM_Mat4 mesh_to_armature;
+	HMM_Mat4 armature_to_mesh;
+	const void* pose_source = nullptr;	// clip the pose was sampled from; null for the bind pose
+	f32 pose_frame = 0.0f;
+	u32 pose_bone_count = 0;	// pose matrices used, <= matrix_count
+	u32 matrix_count = 0;
+	u32 reserved[3] = {};
+};
+static_assert(sizeof(SkinPackKey) == sizeof(HMM_Mat4) * 2 + 32, "SkinPackKey is hashed as raw bytes");
+
+struct SkinPackJob
+{
+	const HMM_Mat4* pose = nullptr;
+	u32 pose_bone_count = 0;
+	u32 matrix_count = 0;
+	u32 arena_offset = 0;
+	HMM_Mat4 mesh_to_armature;
+	HMM_Mat4 armature_to_mesh;
+};
+
+struct SkinPackBatch
+{
+	DynamicArray<SkinPackJob> jobs;
+	DynamicArray<SkinPackKey> job_keys;	// parallel to jobs
+	ankerl::unordered_dense::map<u64, u32> job_by_hash;
+	DynamicArray<u32> task_first_jobs;	// scratch for skin_pack_run
+	u32 matrix_count = 0;	// arena rows the batch writes
+	u32 mesh_count = 0;
+	u32 shared_mesh_count = 0;	// meshes that reused another mesh's rows
+};
+
+inline void skin_pack_clear(SkinPackBatch& in_batch)
+{
+	in_batch.jobs.clear();
+	in_batch.job_keys.clear();
+	in_batch.job_by_hash.clear();
+	in_batch.matrix_count = 0;
+	in_batch.mesh_count = 0;
+	in_batch.shared_mesh_count = 0;
+}
+
+// Arena offset of the rows for a mesh with this key. in_pose holds at least
+// in_key.pose_bone_count matrices and must stay valid until skin_pack_run.
+inline u32 skin_pack_add(SkinPackBatch& in_batch, const SkinPackKey& in_key, const HMM_Mat4* in_pose)
+{
+	in_batch.mesh_count += 1;
+	const u64 hash = content_hash_64(&in_key, sizeof(SkinPackKey));
+	auto found = in_batch.job_by_hash.find(hash);
+	if (found != in_batch.job_by_hash.end() && memcmp(&in_batch.job_keys[found->second], &in_key, sizeof(SkinPackKey)) == 0)
+	{
+		in_batch.shared_mesh_count += 1;
+		return in_batch.jobs[found->second].arena_offset;
+	}
+
+	// A hash collision with a different key just gets its own rows
+	const u32 job_index = (u32) in_batch.jobs.length();
+	if (found == in_batch.job_by_hash.end())
+	{
+		in_batch.job_by_hash.emplace(hash, job_index);
+	}
+	in_batch.jobs.add({
+		.pose = in_key.pose_bone_count > 0 ? in_pose : nullptr,
+		.pose_bone_count = in_key.pose_bone_count,
+		.matrix_count = in_key.matrix_count,
+		.arena_offset = in_batch.matrix_count,
+		.mesh_to_armature = in_key.mesh_to_armature,
+		.armature_to_mesh = in_key.armature_to_mesh,
+	});
+	in_batch.job_keys.add(in_key);
+	in_batch.matrix_count += in_key.matrix_count;
+	return in_batch.jobs.last().arena_offset;
+}
+
+// Rows of one mesh. HMM_MulM4 is already 4-wide (SSE/NEON); both paths go
+// through here so they agree bit for bit.
+inline void skin_pack_write_matrices(
+	const HMM_Mat4* in_pose,
+	u32 in_pose_bone_count,
+	const HMM_Mat4& in_mesh_to_armature,
+	const HMM_Mat4& in_armature_to_mesh,
+	HMM_Mat4* out_matrices,
+	u32 in_matrix_count)
+{
+	for (u32 bone_idx = 0; bone_idx < in_pose_bone_count; ++bone_idx)
+	{
+		out_matrices[bone_idx] = HMM_MulM4(
+			in_armature_to_mesh,
+			HMM_MulM4(in_pose[bone_idx], in_mesh_to_armature)
+		);
+	}
+	for (u32 bone_idx = in_pose_bone_count; bone_idx < in_matrix_count; ++bone_idx)
+	{
+		out_matrices[bone_idx] = HMM_M4D(1.0f);
+	}
+}
+
+// Writes every job into out_arena (at least in_batch.matrix_count rows).
+// Jobs are grouped into tasks of about SKIN_PACK_TASK_MATRICES rows; each
+// task owns its jobs' rows, so workers never write the same row.
+inline void skin_pack_run(SkinPackBatch& in_batch, HMM_Mat4* out_arena, WorkerPool* in_workers)
+{
+	const u32 job_count = (u32) in_batch.jobs.length();
+	auto write_jobs = [&](u32 in_first_job, u32 in_end_job)
+	{
+		for (u32 job_idx = in_first_job; job_idx < in_end_job; ++job_idx)
+		{
+			const SkinPackJob& job = in_batch.jobs[job_idx];
+			skin_pack_write_matrices(job.pose, job.pose_bone_count, job.mesh_to_armature, job.armature_to_mesh, out_arena + job.arena_offset, job.matrix_count);
+		}
+	};
+
+	if (!in_workers || in_workers->worker_count() == 0 || in_batch.matrix_count < SKIN_PACK_PARALLEL_MIN_MATRICES)
+	{
+		write_jobs(0, job_count);
+		return;
+	}
+
+	DynamicArray<u32>& task_first_jobs = in_batch.task_first_jobs;
+	task_first_jobs.clear();
+	u32 task_matrices = SKIN_PACK_TASK_MATRICES;
+	for (u32 job_idx = 0; job_idx < job_count; ++job_idx)
+	{
+		if (task_matrices >= SKIN_PACK_TASK_MATRICES)
+		{
+			task_first_jobs.add(job_idx);
+			task_matrices = 0;
+		}
+		task_matrices += in_batch.jobs[job_idx].matrix_count;
+	}
+	task_first_jobs.add(job_count);
+
+	in_workers->parallel_for((u32) task_first_jobs.length() - 1, [&](u32 in_task)
+	{
+		write_jobs(task_first_jobs[in_task], task_first_jobs[in_task + 1]);
+	});
+}
+
+// Serial reference for one mesh: rows staged in in_out_mesh_matrices
+// ([in_matrix_count]), then appended to the arena. Returns their offset.
+inline u32 skin_pack_reference_mesh(
+	const HMM_Mat4* in_pose,
+	u32 in_pose_bone_count,
+	const HMM_Mat4& in_mesh_to_armature,
+	const HMM_Mat4& in_armature_to_mesh,
+	HMM_Mat4* in_out_mesh_matrices,
+	u32 in_matrix_count,
+	DynamicArray<HMM_Mat4>& in_out_arena)
+{
+	skin_pack_write_matrices(in_pose, in_pose_bone_count, in_mesh_to_armature, in_armature_to_mesh, in_out_mesh_matrices, in_matrix_count);
+	const u32 offset = (u32) in_out_arena.length();
+	for (u32 matrix_idx = 0; matrix_idx < in_matrix_count; ++matrix_idx)
+	{
+		in_out_arena.add(in_out_mesh_matrices[matrix_idx]);
+	}
+	return offset;
+}
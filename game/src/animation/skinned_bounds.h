@@ -0,0 +1,144 @@
+#pragma once
+
+#include "core/types.h"
+#include "render/vertex_types.h"
+
+// ---- Skinned bounds ----
+// Conservative mesh-space bounds for a skinned mesh in any pose, cheap enough
+// to refresh every frame. Import stores, per bone, the bind-pose box of the
+// vertices that bone influences; one extra box holds the vertices with no
+// weight, which the shaders leave unskinned (get_skin_matrix returns identity).
+//
+// A skinned position is sum(w_i * S_i * p) with the weights summing to one
+// (the exporter normalizes them), so it is a convex combination of points
+// S_i * p, each inside bone i's box transformed by S_i. The union of those
+// transformed boxes therefore contains every skinned vertex, at a cost of one
+// box transform per bone instead of one per vertex.
+
+// Matches get_skin_matrix's "no weight" threshold
+static constexpr f32 SKINNED_BOUNDS_MIN_TOTAL_WEIGHT = 0.00001f;
+
+// Relative slack for float rounding between this and the vertex shader
+static constexpr f32 SKINNED_BOUNDS_RELATIVE_PADDING = 0.0001f;
+
+inline bool skinned_bounds_box_is_empty(const BoundingBox& in_box)
+{
+	return in_box.min.X > in_box.max.X;
+}
+
+// Bone-box array length for a mesh with in_skin_matrix_count bones
+inline u32 skinned_bounds_bone_box_count(u32 in_skin_matrix_count)
+{
+	return in_skin_matrix_count + 1;
+}
+
+// Fills out_bone_bounds[0..in_skin_matrix_count] (see
+// skinned_bounds_bone_box_count). A vertex counts toward every joint it has a
+// positive weight for; joints outside [0, in_skin_matrix_count) are skipped
+// since no skin matrix is written for them. Bones nothing references stay
+// empty (bounding_box_init) and are skipped when evaluating.
+inline void skinned_bounds_compute_bone_boxes(
+	const Vertex* in_vertices,
+	const SkinnedVertex* in_skinned_vertices,
+	u32 in_vertex_count,
+	u32 in_skin_matrix_count,
+	BoundingBox* out_bone_bounds)
+{
+	const u32 box_count = skinned_bounds_bone_box_count(in_skin_matrix_count);
+	for (u32 box_idx = 0; box_idx < box_count; ++box_idx)
+	{
+		out_bone_bounds[box_idx] = bounding_box_init();
+	}
+	BoundingBox& unweighted_bounds = out_bone_bounds[in_skin_matrix_count];
+
+	for (u32 vertex_idx = 0; vertex_idx < in_vertex_count; ++vertex_idx)
+	{
+		const HMM_Vec3 position = in_vertices[vertex_idx].position.XYZ;
+		const HMM_Vec4& joints = in_skinned_vertices[vertex_idx].joint_indices;
+		const HMM_Vec4& weights = in_skinned_vertices[vertex_idx].joint_weights;
+		if (weights.X + weights.Y + weights.Z + weights.W <= SKINNED_BOUNDS_MIN_TOTAL_WEIGHT)
+		{
+			bounding_box_expand(unweighted_bounds, position);
+			continue;
+		}
+
+		for (i32 influence_idx = 0; influence_idx < 4; ++influence_idx)
+		{
+			// int() in the shader truncates toward zero
+			const i32 joint = (i32) joints.Elements[influence_idx];
+			if (weights.Elements[influence_idx] > 0.0f && joint >= 0 && (u32) joint < in_skin_matrix_count)
+			{
+				bounding_box_expand(out_bone_bounds[joint], position);
+			}
+		}
+	}
+}
+
+// Box of in_box under an affine matrix (Arvo): each output axis takes, per
+// input axis, whichever of min/max gives the smaller/larger product.
+inline BoundingBox skinned_bounds_transform_box(const BoundingBox& in_box, const HMM_Mat4& in_matrix)
+{
+	BoundingBox out_box = {
+		.min = in_matrix.Columns[3].XYZ,
+		.max = in_matrix.Columns[3].XYZ,
+	};
+	for (i32 column_idx = 0; column_idx < 3; ++column_idx)
+	{
+		const HMM_Vec3 column = in_matrix.Columns[column_idx].XYZ;
+		const HMM_Vec3 low = column * in_box.min.Elements[column_idx];
+		const HMM_Vec3 high = column * in_box.max.Elements[column_idx];
+		out_box.min = out_box.min + HMM_MinV3(low, high);
+		out_box.max = out_box.max + HMM_MaxV3(low, high);
+	}
+	return out_box;
+}
+
+// Mesh-space bounds of one pose. in_clip_frame holds in_clip_bone_count clip
+// matrices (a pose from armature_sample_pose) or is null for the bind pose; bones past the clip keep the identity skin matrix, as in
+// AnimationSystem::pack_skin_matrices.
+inline BoundingBox skinned_bounds_evaluate(
+	const BoundingBox* in_bone_bounds,
+	u32 in_skin_matrix_count,
+	const HMM_Mat4* in_clip_frame,
+	i32 in_clip_bone_count,
+	const HMM_Mat4& in_mesh_to_armature,
+	const HMM_Mat4& in_armature_to_mesh)
+{
+	BoundingBox out_bounds = bounding_box_init();
+	// The last box (unweighted vertices) never takes a clip matrix
+	const u32 clip_bone_count = in_clip_frame ? MIN((u32) MAX(in_clip_bone_count, 0), in_skin_matrix_count) : 0;
+	for (u32 bone_idx = 0; bone_idx <= in_skin_matrix_count; ++bone_idx)
+	{
+		const BoundingBox& bone_bounds = in_bone_bounds[bone_idx];
+		if (skinned_bounds_box_is_empty(bone_bounds))
+		{
+			continue;
+		}
+
+		if (bone_idx < clip_bone_count)
+		{
+			const HMM_Mat4 skin_matrix = HMM_MulM4(
+				in_armature_to_mesh,
+				HMM_MulM4(in_clip_frame[bone_idx], in_mesh_to_armature)
+			);
+			bounding_box_expand(out_bounds, skinned_bounds_transform_box(bone_bounds, skin_matrix));
+		}
+		else
+		{
+			bounding_box_expand(out_bounds, bone_bounds);
+		}
+	}
+
+	if (skinned_bounds_box_is_empty(out_bounds))
+	{
+		return out_bounds;
+	}
+
+	// Scaled by the largest coordinate as well as the size, since rounding
+	// error grows with distance from the mesh origin
+	const HMM_Vec3 reach = HMM_MaxV3(HMM_MaxV3(-out_bounds.min, out_bounds.max), out_bounds.max - out_bounds.min);
+	const f32 padding = SKINNED_BOUNDS_RELATIVE_PADDING * MAX(MAX(reach.X, reach.Y), reach.Z);
+	out_bounds.min = out_bounds.min - HMM_V3(padding, padding, padding);
+	out_bounds.max = out_bounds.max + HMM_V3(padding, padding, padding);
+	return out_bounds;
+}
@@ -73,12 +73,12 @@ public:
 		if (glfwGetTime() - started_at > timeout_seconds)
 		{
 			printf(
-				"Automated screenshot timeout: imports=%zu GI dirty=%i updating=%i probe=%i/%zu\n",
+				"Automated screenshot timeout: imports=%zu GI dirty=%i updating=%i stale probes=%i/%zu\n",
 				in_state.data_oriented.import_history.length(),
 				in_state.gi.layout_dirty ? 1 : 0,
 				in_state.gi.is_updating ? 1 : 0,
-				in_gi_scene.probe_idx_to_update,
-				in_gi_scene.probes.length()
+				in_gi_scene.scheduler.stale_count,
+				in_gi_scene.layout.probes.length()
 			);
 			fail("timeout");
 			return;
@@ -5,9 +5,13 @@
 #include <cstdio>
 #include <string>
 
+#include "core/content_hash.h"
 #include "core/dynamic_array.h"
 #include "core/timings.h"
+#include "render/pipeline_build_service.h"
+#include "render/texture_streaming.h"
 #include "render/vulkan_context.h"
+#include "scene/render_object_store.h"
 
 struct BenchmarkNamedSamples
 {
@@ -15,10 +19,22 @@ struct BenchmarkNamedSamples
 	DynamicArray<f64> values;
 };
 
+// Live-link ingest timings from --replay-live-link, one sample per update
+struct BenchmarkLiveLinkReplay
+{
+	bool enabled = false;
+	u64 update_count = 0;
+	u64 byte_count = 0;
+	f64 wall_seconds = 0.0;
+	DynamicArray<f64> parse_ms;
+	DynamicArray<f64> drain_ms;
+};
+
 struct BenchmarkState
 {
 	bool enabled = false;
 	bool finalized = false;
+	bool open_ended = false;	// measure until the caller closes the window
 	u64 warmup_frames = 300;
 	u64 measured_frames = 1000;
 	u64 rendered_frames = 0;
@@ -32,6 +48,8 @@ struct BenchmarkState
 	DynamicArray<f64> cloud_continuous_ms;
 	DynamicArray<BenchmarkNamedSamples> gpu_pass_ms;
 	VulkanMetrics metrics_start = {};
+	RenderObjectStoreCounters render_objects_start = {};
+	BenchmarkLiveLinkReplay live_link_replay;
 
 	void configure(u64 in_warmup_frames, u64 in_measured_frames, const std::string& in_output_path)
 	{
@@ -45,11 +63,20 @@ struct BenchmarkState
 			output_path.c_str());
 	}
 
-	void begin(VulkanContext* ctx)
+	// Measures every frame after warmup until the run ends on its own (e.g.
+	// a live-link replay finishing)
+	void configure_open_ended(u64 in_warmup_frames, const std::string& in_output_path)
+	{
+		configure(in_warmup_frames, 1ull << 40, in_output_path);
+		open_ended = true;
+	}
+
+	void begin(VulkanContext* ctx, const RenderObjectStoreCounters& in_render_objects)
 	{
 		if (enabled && warmup_frames == 0)
 		{
 			metrics_start = ctx->metrics;
+			render_objects_start = in_render_objects;
 			first_measured_cpu_frame = 0;
 		}
 	}
@@ -64,7 +91,7 @@ struct BenchmarkState
 		return gpu_pass_ms.last();
 	}
 
-	void after_frame(f64 in_wall_frame_ms, VulkanContext* ctx)
+	void after_frame(f64 in_wall_frame_ms, VulkanContext* ctx, const RenderObjectStoreCounters& in_render_objects)
 	{
 		if (!enabled || finalized) return;
 		++rendered_frames;
@@ -75,6 +102,7 @@ struct BenchmarkState
 		if (rendered_frames == warmup_frames)
 		{
 			metrics_start = ctx->metrics;
+			render_objects_start = in_render_objects;
 			first_measured_cpu_frame = has_cpu_frame ? latest_cpu_frame + 1 : (i64)warmup_frames;
 		}
 
@@ -135,7 +163,7 @@ struct BenchmarkState
 
 	bool should_exit() const
 	{
-		return enabled && rendered_frames >= warmup_frames + measured_frames + MAX_FRAMES_IN_FLIGHT + 1;
+		return enabled && !open_ended && rendered_frames >= warmup_frames + measured_frames + MAX_FRAMES_IN_FLIGHT + 1;
 	}
 };
 
@@ -169,10 +197,19 @@ inline void benchmark_write_summary(FILE* in_file, const char* in_name, const Dy
 		in_trailing_comma ? "," : "");
 }
 
-inline bool benchmark_finalize(BenchmarkState& state, VulkanContext* ctx)
+inline bool benchmark_finalize(
+	BenchmarkState& state,
+	VulkanContext* ctx,
+	const ContentCacheCounters& in_content_cache,
+	const RenderObjectStoreCounters& in_render_objects,
+	const TextureStreaming& in_texture_streaming)
 {
 	if (!state.enabled || state.finalized) return true;
 	state.finalized = true;
+	if (state.open_ended)
+	{
+		state.measured_frames = state.rendered_frames > state.warmup_frames ? state.rendered_frames - state.warmup_frames : 0;
+	}
 	const VulkanMetrics& end = ctx->metrics;
 	const VulkanMemoryStats memory = vulkan_context_get_memory_stats(ctx);
 	FILE* output = fopen(state.output_path.c_str(), "wb");
@@ -202,25 +239,73 @@ inline bool benchmark_finalize(BenchmarkState& state, VulkanContext* ctx)
 			pass_index + 1 < state.gpu_pass_ms.length() ? "," : "");
 	}
 	fprintf(output, "  },\n");
-	fprintf(output, "  \"commands\": { \"draws\": %llu, \"dispatches\": %llu, \"descriptor_update_calls\": %llu, \"descriptor_writes\": %llu, \"descriptors_written\": %llu },\n",
+	fprintf(output, "  \"commands\": { \"draws\": %llu, \"indirect_commands\": %llu, \"dispatches\": %llu, \"descriptor_update_calls\": %llu, \"descriptor_writes\": %llu, \"descriptors_written\": %llu },\n",
 		(unsigned long long)(end.draw_calls - state.metrics_start.draw_calls),
+		(unsigned long long)(end.indirect_commands - state.metrics_start.indirect_commands),
 		(unsigned long long)(end.dispatch_calls - state.metrics_start.dispatch_calls),
 		(unsigned long long)(end.descriptor_update_calls - state.metrics_start.descriptor_update_calls),
 		(unsigned long long)(end.descriptor_writes - state.metrics_start.descriptor_writes),
 		(unsigned long long)(end.descriptors_written - state.metrics_start.descriptors_written));
-	fprintf(output, "  \"uploads\": { \"bytes\": %llu, \"requests\": %llu, \"batches\": %llu, \"staging_grows\": %llu, \"staging_spills\": %llu, \"peak_frame_bytes\": %llu, \"immediate_submits\": %llu },\n",
+	fprintf(output, "  \"uploads\": { \"bytes\": %llu, \"requests\": %llu, \"batches\": %llu, \"staging_grows\": %llu, \"staging_spills\": %llu, \"peak_frame_bytes\": %llu, \"immediate_submits\": %llu, \"async_jobs\": %llu, \"async_bytes\": %llu, \"async_batches\": %llu },\n",
 		(unsigned long long)(end.upload_bytes - state.metrics_start.upload_bytes),
 		(unsigned long long)(end.upload_requests - state.metrics_start.upload_requests),
 		(unsigned long long)(end.upload_batches - state.metrics_start.upload_batches),
 		(unsigned long long)(end.upload_staging_grows - state.metrics_start.upload_staging_grows),
 		(unsigned long long)(end.upload_staging_spills - state.metrics_start.upload_staging_spills),
 		(unsigned long long)end.upload_peak_frame_bytes,
-		(unsigned long long)(end.immediate_submit_count - state.metrics_start.immediate_submit_count));
+		(unsigned long long)(end.immediate_submit_count - state.metrics_start.immediate_submit_count),
+		(unsigned long long)(end.upload_async_jobs - state.metrics_start.upload_async_jobs),
+		(unsigned long long)(end.upload_async_bytes - state.metrics_start.upload_async_bytes),
+		(unsigned long long)(end.upload_async_batches - state.metrics_start.upload_async_batches));
 	fprintf(output, "  \"idle_waits\": { \"queue\": %llu, \"device\": %llu },\n",
 		(unsigned long long)(end.queue_wait_idle_count - state.metrics_start.queue_wait_idle_count),
 		(unsigned long long)(end.device_wait_idle_count - state.metrics_start.device_wait_idle_count));
 	fprintf(output, "  \"pipelines\": { \"count\": %llu, \"creation_ms\": %.6f },\n",
 		(unsigned long long)end.pipeline_count, end.pipeline_creation_ms);
+	fprintf(output, "  \"instancing\": { \"bytes_saved\": %llu },\n",
+		(unsigned long long)end.instancing_bytes_saved);
+	fprintf(output, "  \"shadow_cascades\": { \"rendered\": %llu, \"cached\": %llu },\n",
+		(unsigned long long)(end.shadow_cascades_rendered - state.metrics_start.shadow_cascades_rendered),
+		(unsigned long long)(end.shadow_cascades_cached - state.metrics_start.shadow_cascades_cached));
+	// rebuild_bytes is what re-sending every row each frame would have cost
+	const RenderObjectStoreCounters& render_objects_start = state.render_objects_start;
+	fprintf(output, "  \"render_objects\": { \"frames\": %llu, \"upload_frames\": %llu, \"rows_packed\": %llu, \"rows_uploaded\": %llu, \"bytes\": %llu, \"copy_regions\": %llu, \"full_uploads\": %llu, \"rebuild_bytes\": %llu },\n",
+		(unsigned long long)(in_render_objects.frames - render_objects_start.frames),
+		(unsigned long long)(in_render_objects.upload_frames - render_objects_start.upload_frames),
+		(unsigned long long)(in_render_objects.rows_packed - render_objects_start.rows_packed),
+		(unsigned long long)(in_render_objects.rows_uploaded - render_objects_start.rows_uploaded),
+		(unsigned long long)(in_render_objects.upload_bytes - render_objects_start.upload_bytes),
+		(unsigned long long)(in_render_objects.copy_regions - render_objects_start.copy_regions),
+		(unsigned long long)(in_render_objects.full_uploads - render_objects_start.full_uploads),
+		(unsigned long long)(in_render_objects.rebuild_bytes - render_objects_start.rebuild_bytes));
+	const BenchmarkLiveLinkReplay& replay = state.live_link_replay;
+	if (replay.enabled)
+	{
+		fprintf(output, "  \"live_link_replay\": {\n");
+		fprintf(output, "    \"updates\": %llu, \"bytes\": %llu, \"wall_seconds\": %.6f, \"mb_per_second\": %.3f,\n",
+			(unsigned long long)replay.update_count, (unsigned long long)replay.byte_count, replay.wall_seconds,
+			replay.wall_seconds > 0.0 ? (f64)replay.byte_count / (1024.0 * 1024.0) / replay.wall_seconds : 0.0);
+		benchmark_write_summary(output, "parse", replay.parse_ms, true);
+		benchmark_write_summary(output, "drain", replay.drain_ms, false);
+		fprintf(output, "  },\n");
+	}
+	// Whole-run totals: scene import usually lands during warmup
+	fprintf(output, "  \"content_cache\": { \"mesh_hits\": %llu, \"mesh_misses\": %llu, \"mesh_evictions\": %llu, \"image_hits\": %llu, \"image_misses\": %llu },\n",
+		(unsigned long long)in_content_cache.mesh_hits, (unsigned long long)in_content_cache.mesh_misses,
+		(unsigned long long)in_content_cache.mesh_evictions,
+		(unsigned long long)in_content_cache.image_hits, (unsigned long long)in_content_cache.image_misses);
+	// Whole-run totals too; latency is demand seen to replacement bound
+	const TextureStreamingStats& streaming = in_texture_streaming.stats;
+	fprintf(output, "  \"texture_streaming\": { \"textures\": %zu, \"budget_bytes\": %llu, \"resident_bytes\": %llu, \"peak_bytes\": %llu, \"over_budget_frames\": %llu, \"stream_ins\": %llu, \"evictions\": %llu, \"deferred\": %llu, \"latency_samples\": %zu, \"latency_median_frames\": %.1f, \"latency_p95_frames\": %.1f, \"latency_median_ms\": %.3f, \"latency_p95_ms\": %.3f },\n",
+		in_texture_streaming.textures.length(),
+		(unsigned long long)in_texture_streaming.budget_bytes, (unsigned long long)in_texture_streaming.resident_bytes,
+		(unsigned long long)streaming.peak_bytes, (unsigned long long)streaming.over_budget_frames,
+		(unsigned long long)streaming.stream_in_count, (unsigned long long)streaming.eviction_count,
+		(unsigned long long)streaming.deferred_request_count, in_texture_streaming.latency_frames.length(),
+		texture_streaming_percentile(in_texture_streaming.latency_frames, 0.5f),
+		texture_streaming_percentile(in_texture_streaming.latency_frames, 0.95f),
+		texture_streaming_percentile(in_texture_streaming.latency_ms, 0.5f),
+		texture_streaming_percentile(in_texture_streaming.latency_ms, 0.95f));
 	fprintf(output, "  \"vma\": { \"allocations\": %llu, \"allocation_bytes\": %llu, \"blocks\": %llu, \"block_bytes\": %llu, \"device_usage_bytes\": %llu, \"device_budget_bytes\": %llu }\n",
 		(unsigned long long)memory.allocation_count, (unsigned long long)memory.allocation_bytes,
 		(unsigned long long)memory.block_count, (unsigned long long)memory.block_bytes,
@@ -231,5 +316,61 @@ inline bool benchmark_finalize(BenchmarkState& state, VulkanContext* ctx)
 		benchmark_percentile(state.cpu_frame_ms, 0.5), benchmark_percentile(state.cpu_frame_ms, 0.95),
 		benchmark_percentile(state.gpu_frame_ms, 0.5), benchmark_percentile(state.gpu_frame_ms, 0.95),
 		state.output_path.c_str());
+	printf("Render objects: rows uploaded in %llu of %llu frames, %.1f KB (rebuilding every frame: %.1f KB)\n",
+		(unsigned long long)(in_render_objects.upload_frames - state.render_objects_start.upload_frames),
+		(unsigned long long)(in_render_objects.frames - state.render_objects_start.frames),
+		(f64)(in_render_objects.upload_bytes - state.render_objects_start.upload_bytes) / 1024.0,
+		(f64)(in_render_objects.rebuild_bytes - state.render_objects_start.rebuild_bytes) / 1024.0);
+	if (!in_texture_streaming.textures.empty())
+	{
+		printf("Texture streaming: peak %.1f MB of %.1f MB budget (%llu frames over) | %llu stream-ins, %llu evictions | latency median %.0f frames p95 %.0f frames\n",
+			(f64)streaming.peak_bytes / (1024.0 * 1024.0), (f64)in_texture_streaming.budget_bytes / (1024.0 * 1024.0),
+			(unsigned long long)streaming.over_budget_frames,
+			(unsigned long long)streaming.stream_in_count, (unsigned long long)streaming.eviction_count,
+			texture_streaming_percentile(in_texture_streaming.latency_frames, 0.5f),
+			texture_streaming_percentile(in_texture_streaming.latency_frames, 0.95f));
+	}
+	if (replay.enabled)
+	{
+		printf("Live link replay: %llu updates, %.1f MB/s | parse median %.3fms p95 %.3fms | drain median %.3fms p95 %.3fms\n",
+			(unsigned long long)replay.update_count,
+			replay.wall_seconds > 0.0 ? (f64)replay.byte_count / (1024.0 * 1024.0) / replay.wall_seconds : 0.0,
+			benchmark_percentile(replay.parse_ms, 0.5), benchmark_percentile(replay.parse_ms, 0.95),
+			benchmark_percentile(replay.drain_ms, 0.5), benchmark_percentile(replay.drain_ms, 0.95));
+	}
+	return true;
+}
+
+// --benchmark-startup: in_init_ms is RenderSystem::initialize with the saved
+// pipeline cache ignored (cold). The warm figure rebuilds the same startup
+// pipelines against the cache that run produced, as the next launch would.
+inline bool benchmark_startup_finalize(VulkanContext* ctx, f64 in_init_ms, const std::string& in_output_path)
+{
+	const PipelineBuildStats& cold = PipelineBuildService::stats;
+	f64 warm_job_ms = 0.0;
+	const f64 warm_wall_ms = PipelineBuildService::benchmark_warm_rebuild(ctx, &warm_job_ms);
+	const f64 warm_init_ms = in_init_ms - cold.batch_wall_ms + warm_wall_ms;
+	FILE* output = fopen(in_output_path.c_str(), "wb");
+	if (!output)
+	{
+		printf("Failed to write benchmark output: %s\n", in_output_path.c_str());
+		return false;
+	}
+	fprintf(output, "{\n");
+	fprintf(output, "  \"build_config\": \"%s\",\n", GAME_BUILD_CONFIG_NAME);
+	fprintf(output, "  \"device\": "); benchmark_write_json_string(output, ctx->physical_device_properties.deviceName); fprintf(output, ",\n");
+	fprintf(output, "  \"threads\": %d,\n", cold.worker_count);
+	fprintf(output, "  \"shader_modules\": { \"loads\": %u, \"reused\": %u, \"load_ms\": %.6f },\n",
+		cold.shader_module_loads, cold.shader_module_hits, cold.shader_load_ms);
+	fprintf(output, "  \"cold\": { \"init_ms\": %.6f, \"pipelines\": %u, \"pipeline_wall_ms\": %.6f, \"pipeline_serial_ms\": %.6f },\n",
+		in_init_ms, cold.batched_pipelines, cold.batch_wall_ms, cold.batch_job_ms);
+	fprintf(output, "  \"warm\": { \"init_ms\": %.6f, \"pipelines\": %zu, \"pipeline_wall_ms\": %.6f, \"pipeline_serial_ms\": %.6f },\n",
+		warm_init_ms, PipelineBuildService::recorded_jobs.length(), warm_wall_ms, warm_job_ms);
+	fprintf(output, "  \"deferred_pipelines\": %u\n", cold.deferred_pipelines);
+	fprintf(output, "}\n");
+	fclose(output);
+	printf("Startup benchmark: cold init %.1fms (pipelines %.1fms, %.1fms serial) | warm init %.1fms (pipelines %.1fms) | %u pipelines on %d threads, %u deferred | %s\n",
+		in_init_ms, cold.batch_wall_ms, cold.batch_job_ms, warm_init_ms, warm_wall_ms,
+		cold.batched_pipelines, cold.worker_count, cold.deferred_pipelines, in_output_path.c_str());
 	return true;
 }
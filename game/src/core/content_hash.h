@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstring>
+
+#include "core/types.h"
+
+// ---- Content hash ----
+// 64-bit XXH64 over raw bytes, used to key the live-link content cache
+// (identical mesh streams and images share GPU resources). Not
+// cryptographic: a collision would alias two payloads, which at 64 bits is
+// accepted for editor-driven content.
+// Streams are chained by passing the previous hash as the seed.
+
+namespace content_hash_detail
+{
+	static constexpr u64 PRIME_1 = 0x9E3779B185EBCA87ull;
+	static constexpr u64 PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+	static constexpr u64 PRIME_3 = 0x165667B19E3779F9ull;
+	static constexpr u64 PRIME_4 = 0x85EBCA77C2B2AE63ull;
+	static constexpr u64 PRIME_5 = 0x27D4EB2F165667C5ull;
+
+	inline u64 rotl(u64 in_value, i32 in_bits)
+	{
+		return (in_value << in_bits) | (in_value >> (64 - in_bits));
+	}
+
+	inline u64 read_u64(const u8* in_bytes)
+	{
+		u64 value;
+		memcpy(&value, in_bytes, sizeof(value));
+		return value;
+	}
+
+	inline u32 read_u32(const u8* in_bytes)
+	{
+		u32 value;
+		memcpy(&value, in_bytes, sizeof(value));
+		return value;
+	}
+
+	inline u64 round(u64 in_accumulator, u64 in_lane)
+	{
+		in_accumulator += in_lane * PRIME_2;
+		in_accumulator = rotl(in_accumulator, 31);
+		return in_accumulator * PRIME_1;
+	}
+
+	inline u64 merge_round(u64 in_accumulator, u64 in_lane)
+	{
+		in_accumulator ^= round(0, in_lane);
+		return in_accumulator * PRIME_1 + PRIME_4;
+	}
+}
+
+inline u64 content_hash_64(const void* in_data, size_t in_size, u64 in_seed = 0)
+{
+	using namespace content_hash_detail;
+	const u8* bytes = (const u8*) in_data;
+	const u8* const end = bytes + in_size;
+	u64 hash;
+
+	if (in_size >= 32)
+	{
+		u64 lanes[4] = {
+			in_seed + PRIME_1 + PRIME_2,
+			in_seed + PRIME_2,
+			in_seed,
+			in_seed - PRIME_1,
+		};
+		const u8* const last_stripe = end - 32;
+		do
+		{
+			lanes[0] = round(lanes[0], read_u64(bytes + 0));
+			lanes[1] = round(lanes[1], read_u64(bytes + 8));
+			lanes[2] = round(lanes[2], read_u64(bytes + 16));
+			lanes[3] = round(lanes[3], read_u64(bytes + 24));
+			bytes += 32;
+		} while (bytes <= last_stripe);
+
+		hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+		for (u64 lane : lanes)
+		{
+			hash = merge_round(hash, lane);
+		}
+	}
+	else
+	{
+		hash = in_seed + PRIME_5;
+	}
+
+	hash += (u64) in_size;
+
+	while (bytes + 8 <= end)
+	{
+		hash ^= round(0, read_u64(bytes));
+		hash = rotl(hash, 27) * PRIME_1 + PRIME_4;
+		bytes += 8;
+	}
+	if (bytes + 4 <= end)
+	{
+		hash ^= (u64) read_u32(bytes) * PRIME_1;
+		hash = rotl(hash, 23) * PRIME_2 + PRIME_3;
+		bytes += 4;
+	}
+	while (bytes < end)
+	{
+		hash ^= (u64) (*bytes) * PRIME_5;
+		hash = rotl(hash, 11) * PRIME_1;
+		bytes += 1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME_2;
+	hash ^= hash >> 29;
+	hash *= PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+// Cumulative hit/miss totals for the content caches (reported in the
+// benchmark JSON; per-update deltas land in the live-link ImportStats)
+struct ContentCacheCounters
+{
+	u64 mesh_hits = 0;
+	u64 mesh_misses = 0;
+	u64 mesh_evictions = 0;
+	u64 image_hits = 0;
+	u64 image_misses = 0;
+};
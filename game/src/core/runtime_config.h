@@ -12,6 +12,8 @@ namespace RuntimeConfig
 		std::optional<long> render_scale;
 		std::optional<long> shadow_placement;
 		bool shadow_cascade_debug = false;
+		std::optional<bool> shadow_cache;
+		std::optional<long> shadow_cache_frames;
 		bool hide_ui = false;
 		std::optional<bool> ssao;
 		std::optional<bool> dof;
@@ -32,6 +34,7 @@ namespace RuntimeConfig
 		std::optional<std::string> tonemap_validation_output_mode;
 		std::optional<std::string> tonemap_validation_capture;
 		std::optional<std::string> cloud_shadow_validation_capture;
+		std::optional<std::string> gbuffer_capture;
 		std::optional<bool> bloom;
 		std::optional<double> bloom_threshold;
 		std::optional<double> bloom_soft_knee;
@@ -45,6 +48,14 @@ namespace RuntimeConfig
 		std::optional<long> gi_occlusion_mode;
 		std::optional<bool> gi_specular;
 		bool test_resize = false;
+		bool validate_scene_indexes = false;
+		bool cull_reference = false;
+		bool skin_pack_reference = false;
+		bool serial_frame = false;
+		std::optional<std::string> draw_path;
+		std::optional<bool> instancing;
+		std::optional<bool> transient_aliasing;
+		bool sync_validation = false;
 
 		std::optional<std::string> screenshot_path;
 		unsigned long long screenshot_frame = 60;
@@ -53,6 +64,11 @@ namespace RuntimeConfig
 		double screenshot_timeout_seconds = 600.0;
 
 		bool force_device_local = false;
+		std::optional<bool> transfer_queue;
+		std::optional<long> upload_budget_mb;
+		std::optional<bool> texture_compression;
+		std::optional<bool> texture_streaming;
+		std::optional<long> texture_budget_mb;
 		std::optional<std::string> present_mode;
 		std::optional<std::string> pipeline_cache_path;
 		bool print_gpu_timings = false;
@@ -102,6 +118,8 @@ namespace RuntimeConfig
 		config.render_scale = integer_value("GAME2_RENDER_SCALE");
 		config.shadow_placement = integer_value("GAME2_SHADOW_PLACEMENT");
 		config.shadow_cascade_debug = is_set("GAME2_SHADOW_CASCADE_DEBUG");
+		config.shadow_cache = boolean_value("GAME2_SHADOW_CACHE");
+		config.shadow_cache_frames = integer_value("GAME2_SHADOW_CACHE_FRAMES");
 		config.hide_ui = is_set("GAME2_HIDE_UI");
 		config.ssao = boolean_value("GAME2_SSAO");
 		config.dof = boolean_value("GAME2_DOF");
@@ -126,6 +144,7 @@ namespace RuntimeConfig
 		config.tonemap_validation_capture = string_value("GAME2_TONEMAP_VALIDATION_CAPTURE");
 		config.cloud_shadow_validation_capture = string_value(
 			"GAME2_CLOUD_SHADOW_VALIDATION_CAPTURE");
+		config.gbuffer_capture = string_value("GAME2_GBUFFER_CAPTURE");
 		config.bloom = boolean_value("GAME2_BLOOM");
 		config.bloom_threshold = float_value("GAME2_BLOOM_THRESHOLD");
 		config.bloom_soft_knee = float_value("GAME2_BLOOM_SOFT_KNEE");
@@ -139,6 +158,14 @@ namespace RuntimeConfig
 		config.gi_occlusion_mode = integer_value("GAME2_GI_OCCLUSION_MODE");
 		config.gi_specular = boolean_value("GAME2_GI_SPECULAR");
 		config.test_resize = is_set("GAME2_TEST_RESIZE");
+		config.validate_scene_indexes = is_set("GAME2_VALIDATE_SCENE_INDEXES");
+		config.cull_reference = is_set("GAME2_CULL_REFERENCE");
+		config.skin_pack_reference = is_set("GAME2_SKIN_PACK_REFERENCE");
+		config.serial_frame = is_set("GAME2_SERIAL_FRAME");
+		config.draw_path = string_value("GAME2_DRAW_PATH");
+		config.instancing = boolean_value("GAME2_INSTANCING");
+		config.transient_aliasing = boolean_value("GAME2_TRANSIENT_ALIASING");
+		config.sync_validation = is_set("GAME2_SYNC_VALIDATION");
 
 		config.screenshot_path = string_value("GAME2_SCREENSHOT");
 		if (const char* screenshot_frame = environment_value("GAME2_SCREENSHOT_FRAME"))
@@ -153,6 +180,11 @@ namespace RuntimeConfig
 		}
 
 		config.force_device_local = is_set("GAME2_FORCE_DEVICE_LOCAL");
+		config.transfer_queue = boolean_value("GAME2_TRANSFER_QUEUE");
+		config.upload_budget_mb = integer_value("GAME2_UPLOAD_BUDGET_MB");
+		config.texture_compression = boolean_value("GAME2_TEXTURE_COMPRESSION");
+		config.texture_streaming = boolean_value("GAME2_TEXTURE_STREAMING");
+		config.texture_budget_mb = integer_value("GAME2_TEXTURE_BUDGET_MB");
 		config.present_mode = string_value("GAME_PRESENT_MODE", "GAME2_PRESENT_MODE");
 		config.pipeline_cache_path = string_value("GAME_PIPELINE_CACHE", "GAME2_PIPELINE_CACHE");
 		config.print_gpu_timings = is_set("GAME2_PRINT_GPU_TIMINGS");
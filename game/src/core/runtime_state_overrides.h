@@ -20,6 +20,8 @@ namespace RuntimeStateOverrides
 				: EShadowCascadePlacementMode::Frustum;
 		}
 		if (config.shadow_cascade_debug) { in_state.shadow.debug_show_cascade_selection = true; }
+		if (config.shadow_cache) { in_state.shadow.cache_enable = *config.shadow_cache; }
+		if (config.shadow_cache_frames) { in_state.shadow.cache_dirty_interval = MAX(1, (i32) *config.shadow_cache_frames); }
 		if (config.hide_ui) { in_state.debug_ui.visible = false; }
 		if (config.ssao) { in_state.ssao.enable = *config.ssao; }
 		if (config.dof) { in_state.dof.enable = *config.dof; }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/types.h"
+
+// One heap block carved into many sub-allocations whose owners release
+// it together. Live-link decode places every mesh stream of an update in one
+// arena; each Mesh holds a reference and the block is freed when the last
+// mesh referencing it is cleaned up.
+// Sub-allocation offsets are planned up front, so the arena never grows.
+struct SharedArena
+{
+	u8* memory = nullptr;
+	size_t size = 0;
+	std::atomic<i32> ref_count = 0;
+};
+
+// Sub-allocations start on cache lines so parallel writers into neighbouring
+// ranges do not share a line. The block itself is allocated on a cache line,
+// so offsets aligned here are aligned in memory too.
+static constexpr size_t SHARED_ARENA_ALIGNMENT = 64;
+
+inline size_t shared_arena_align(size_t in_offset)
+{
+	return (in_offset + SHARED_ARENA_ALIGNMENT - 1) & ~(SHARED_ARENA_ALIGNMENT - 1);
+}
+
+// aligned_alloc needs a size that is a multiple of the alignment
+inline u8* shared_arena_alloc_block(size_t in_size)
+{
+#if defined(_WIN32)
+	return (u8*) _aligned_malloc(shared_arena_align(in_size), SHARED_ARENA_ALIGNMENT);
+#else
+	return (u8*) aligned_alloc(SHARED_ARENA_ALIGNMENT, shared_arena_align(in_size));
+#endif
+}
+
+inline void shared_arena_free_block(u8* in_memory)
+{
+#if defined(_WIN32)
+	_aligned_free(in_memory);
+#else
+	free(in_memory);
+#endif
+}
+
+// Reserves in_size bytes at the running offset and returns their offset
+inline size_t shared_arena_plan(size_t& in_out_size, size_t in_size)
+{
+	const size_t offset = shared_arena_align(in_out_size);
+	in_out_size = offset + in_size;
+	return offset;
+}
+
+// The creator holds the first reference
+inline SharedArena* shared_arena_create(size_t in_size)
+{
+	SharedArena* arena = new SharedArena();
+	arena->size = in_size;
+	arena->memory = in_size > 0 ? shared_arena_alloc_block(in_size) : nullptr;
+	arena->ref_count.store(1, std::memory_order_relaxed);
+	return arena;
+}
+
+inline void shared_arena_retain(SharedArena* in_arena)
+{
+	if (in_arena)
+	{
+		in_arena->ref_count.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+inline void shared_arena_release(SharedArena* in_arena)
+{
+	if (in_arena && in_arena->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		shared_arena_free_block(in_arena->memory);
+		delete in_arena;
+	}
+}
+
+template<typename T>
+T* shared_arena_at(SharedArena* in_arena, size_t in_offset)
+{
+	return (T*) (in_arena->memory + in_offset);
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+
+// ---- Task graph ----
+// A small DAG of named tasks, rebuilt each frame. task_graph_run releases a
+// task once every task it depends on has finished. Main-thread tasks run on
+// the thread that called task_graph_run; the rest go to a dispatch function
+// that runs them on some other thread (the game hands them to Jolt's job
+// system, so frame work and physics share one set of workers). Between
+// main-thread tasks the caller sleeps until something finishes.
+//
+// With no dispatch function every task runs on the caller in dependency
+// order, which is also the serial reference. The graph only orders tasks:
+// tasks that may run at the same time must not write the same state.
+
+using TaskGraphFunction = std::function<void()>;
+using TaskGraphDispatch = std::function<void(const char* in_name, const TaskGraphFunction& in_function)>;
+
+enum class TaskAffinity : u8
+{
+	AnyThread,
+	MainThread,
+};
+
+struct TaskGraphTask
+{
+	const char* name = nullptr;
+	TaskGraphFunction function;
+	TaskAffinity affinity = TaskAffinity::AnyThread;
+	u32 dependency_count = 0;
+	u32 first_dependent = 0;	// into TaskGraph::dependents
+	u32 dependent_count = 0;
+	u64 start_ticks = 0;	// steady-clock nanoseconds, comparable with timings_now_ticks
+	u64 end_ticks = 0;
+};
+
+struct TaskGraphEdge
+{
+	u32 from_task = 0;
+	u32 to_task = 0;
+};
+
+struct TaskGraph
+{
+	TaskGraph() = default;
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	DynamicArray<TaskGraphTask> tasks;
+	DynamicArray<TaskGraphEdge> edges;
+	DynamicArray<u32> dependents;	// edges grouped by from_task, built by task_graph_run
+	DynamicArray<u32> pending;	// unfinished dependencies per task (atomic_ref while running)
+
+	std::mutex mutex;
+	std::condition_variable wake_main_thread;
+	DynamicArray<u32> main_thread_ready;	// guarded by mutex
+	u32 main_thread_ready_head = 0;	// guarded by mutex
+	u32 finished_count = 0;	// guarded by mutex
+};
+
+inline u64 task_graph_now_ticks()
+{
+	return (u64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+inline void task_graph_clear(TaskGraph& in_graph)
+{
+	in_graph.tasks.clear();
+	in_graph.edges.clear();
+}
+
+// in_task runs after in_dependency, which must have been added before it,
+// so the graph cannot form a cycle
+inline void task_graph_add_dependency(TaskGraph& in_graph, u32 in_task, u32 in_dependency)
+{
+	assert(in_dependency < in_task && in_task < in_graph.tasks.length());
+	in_graph.edges.add({ .from_task = in_dependency, .to_task = in_task });
+	in_graph.tasks[in_task].dependency_count += 1;
+}
+
+// Adds a task that runs after every task in in_dependencies
+inline u32 task_graph_add(
+	TaskGraph& in_graph,
+	const char* in_name,
+	TaskAffinity in_affinity,
+	TaskGraphFunction in_function,
+	std::initializer_list<u32> in_dependencies = {})
+{
+	const u32 task_index = (u32) in_graph.tasks.length();
+	in_graph.tasks.add({
+		.name = in_name,
+		.function = std::move(in_function),
+		.affinity = in_affinity,
+	});
+	for (u32 dependency : in_dependencies)
+	{
+		task_graph_add_dependency(in_graph, task_index, dependency);
+	}
+	return task_index;
+}
+
+inline void task_graph_release(TaskGraph& in_graph, u32 in_task, const TaskGraphDispatch& in_dispatch);
+
+inline void task_graph_execute(TaskGraph& in_graph, u32 in_task, const TaskGraphDispatch& in_dispatch)
+{
+	TaskGraphTask& task = in_graph.tasks[in_task];
+	task.start_ticks = task_graph_now_ticks();
+	task.function();
+	task.end_ticks = task_graph_now_ticks();
+
+	for (u32 edge_idx = task.first_dependent; edge_idx < task.first_dependent + task.dependent_count; ++edge_idx)
+	{
+		const u32 dependent = in_graph.dependents[edge_idx];
+		if (std::atomic_ref<u32>(in_graph.pending[dependent]).fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			task_graph_release(in_graph, dependent, in_dispatch);
+		}
+	}
+
+	// Last touch of the graph: the caller may return as soon as this lands
+	std::lock_guard<std::mutex> lock(in_graph.mutex);
+	in_graph.finished_count += 1;
+	in_graph.wake_main_thread.notify_one();
+}
+
+inline void task_graph_release(TaskGraph& in_graph, u32 in_task, const TaskGraphDispatch& in_dispatch)
+{
+	const TaskGraphTask& task = in_graph.tasks[in_task];
+	if (task.affinity == TaskAffinity::MainThread || !in_dispatch)
+	{
+		std::lock_guard<std::mutex> lock(in_graph.mutex);
+		in_graph.main_thread_ready.add(in_task);
+		in_graph.wake_main_thread.notify_one();
+		return;
+	}
+
+	TaskGraph* graph = &in_graph;
+	const TaskGraphDispatch* dispatch = &in_dispatch;
+	in_dispatch(task.name, [graph, in_task, dispatch]()
+	{
+		task_graph_execute(*graph, in_task, *dispatch);
+	});
+}
+
+// Runs every task and returns once all have finished. in_dispatch must
+// eventually run each function it is given, and must stay valid until this
+// returns.
+inline void task_graph_run(TaskGraph& in_graph, const TaskGraphDispatch& in_dispatch)
+{
+	const u32 task_count = (u32) in_graph.tasks.length();
+	for (TaskGraphTask& task : in_graph.tasks)
+	{
+		task.dependent_count = 0;
+		task.start_ticks = 0;
+		task.end_ticks = 0;
+	}
+	for (const TaskGraphEdge& edge : in_graph.edges)
+	{
+		in_graph.tasks[edge.from_task].dependent_count += 1;
+	}
+	u32 edge_cursor = 0;
+	for (TaskGraphTask& task : in_graph.tasks)
+	{
+		task.first_dependent = edge_cursor;
+		edge_cursor += task.dependent_count;
+		task.dependent_count = 0;
+	}
+	in_graph.dependents.resize(in_graph.edges.length());
+	for (const TaskGraphEdge& edge : in_graph.edges)
+	{
+		TaskGraphTask& from = in_graph.tasks[edge.from_task];
+		in_graph.dependents[from.first_dependent + from.dependent_count] = edge.to_task;
+		from.dependent_count += 1;
+	}
+
+	in_graph.pending.resize(task_count);
+	for (u32 task_idx = 0; task_idx < task_count; ++task_idx)
+	{
+		in_graph.pending[task_idx] = in_graph.tasks[task_idx].dependency_count;
+	}
+	{
+		std::lock_guard<std::mutex> lock(in_graph.mutex);
+		in_graph.main_thread_ready.clear();
+		in_graph.main_thread_ready_head = 0;
+		in_graph.finished_count = 0;
+	}
+
+	for (u32 task_idx = 0; task_idx < task_count; ++task_idx)
+	{
+		if (in_graph.tasks[task_idx].dependency_count == 0)
+		{
+			task_graph_release(in_graph, task_idx, in_dispatch);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(in_graph.mutex);
+	while (in_graph.finished_count < task_count)
+	{
+		if (in_graph.main_thread_ready_head < in_graph.main_thread_ready.length())
+		{
+			const u32 task_idx = in_graph.main_thread_ready[in_graph.main_thread_ready_head++];
+			lock.unlock();
+			task_graph_execute(in_graph, task_idx, in_dispatch);
+			lock.lock();
+			continue;
+		}
+		in_graph.wake_main_thread.wait(lock);
+	}
+}
@@ -12,7 +12,9 @@ static constexpr i32 GPU_TIMINGS_MAX_DEPENDENCY_TEXT_LENGTH = 256;
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <mutex>
+#include <thread>
 
 #include "core/dynamic_array.h"
 
@@ -76,6 +78,9 @@ struct CpuTimings
 	i32 display_frame_count = 0;
 	bool frame_active = false;
 	bool display_is_frozen = false;
+	// Scopes only nest on the thread that opened the frame; frame tasks on
+	// other threads are recorded afterwards with cpu_timings_record_event
+	std::thread::id frame_thread;
 };
 
 CpuTimings& cpu_timings_get()
@@ -91,12 +96,13 @@ void cpu_timings_begin_frame()
 	timings.active_scope_stack.reset();
 	timings.current_frame_index = timings.next_frame_index++;
 	timings.frame_active = true;
+	timings.frame_thread = std::this_thread::get_id();
 }
 
 i32 cpu_timings_begin_scope(const char* in_name)
 {
 	CpuTimings& timings = cpu_timings_get();
-	if (!timings.frame_active)
+	if (!timings.frame_active || timings.frame_thread != std::this_thread::get_id())
 	{
 		return -1;
 	}
@@ -133,7 +139,8 @@ void cpu_timings_close_scope(CpuTimingEvent& event, u64 in_end_ticks)
 void cpu_timings_record_event(const char* in_name, u64 in_start_ticks, u64 in_end_ticks)
 {
 	CpuTimings& timings = cpu_timings_get();
-	if (!timings.frame_active || in_start_ticks == 0 || in_end_ticks < in_start_ticks)
+	if (!timings.frame_active || timings.frame_thread != std::this_thread::get_id()
+		|| in_start_ticks == 0 || in_end_ticks < in_start_ticks)
 	{
 		return;
 	}
@@ -817,6 +824,26 @@ bool gpu_timings_copy_history_frame(i64 in_frame_index, GpuTimingFrame& out_fram
 	return false;
 }
 
+// Elapsed time of the first scope named in_name in a completed frame (false
+// when the frame left the history or had no such scope)
+bool gpu_timings_find_scope_ms(i64 in_frame_index, const char* in_name, f64& out_ms)
+{
+	GpuTimings& timings = gpu_timings_get();
+	std::lock_guard<std::mutex> lock(timings.mutex);
+	if (GpuTimingFrame* frame = gpu_timings_find_history_frame_locked(timings, in_frame_index))
+	{
+		for (const GpuTimingEvent& event : frame->events)
+		{
+			if (event.valid && event.type != GpuTimingEventType::Frame && std::strcmp(event.name, in_name) == 0)
+			{
+				out_ms = event.elapsed_ms;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 struct CpuTimingScope
 {
 	explicit CpuTimingScope(const char* in_name)
@@ -921,6 +948,7 @@ bool gpu_timings_get_display_frame_total_ms(bool, f64&, bool& out_pending) { out
 bool gpu_timings_get_latest_completed_frame_total_ms(f64&, bool& out_pending) { out_pending = false; return false; }
 bool gpu_timings_get_latest_completed_frame(i64&, f64&) { return false; }
 bool gpu_timings_copy_history_frame(i64, GpuTimingFrame&) { return false; }
+bool gpu_timings_find_scope_ms(i64, const char*, f64&) { return false; }
 
 #define CPU_TIMING_SCOPE(name)
 #define CPU_TIMING_BACKEND_SCOPE(api_name, pass_name)
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "core/dynamic_array.h"
+#include "core/task_graph.h"
+#include "core/types.h"
+
+// Data-parallel loops (live-link decode, culling, skin packing, pipeline
+// builds). parallel_for blocks until every index has run and the calling
+// thread works alongside the pool, so a pool with zero workers degrades to a
+// plain serial loop.
+// A pool either owns threads (start) or queues helper jobs on workers the
+// application shares with it (start_shared): the game points those at Jolt's
+// job system, so its loops do not add threads on top of Jolt's.
+// One parallel_for may be in flight at a time per pool.
+namespace WorkerPoolSharing
+{
+	inline TaskGraphDispatch dispatch;
+	inline i32 worker_count = 0;
+}
+
+// Call before any pool starts shared, with the worker thread count behind
+// in_dispatch. An empty dispatch or zero workers leaves pools on their own
+// threads.
+inline void worker_pool_share(const TaskGraphDispatch& in_dispatch, i32 in_worker_count)
+{
+	WorkerPoolSharing::dispatch = in_dispatch;
+	WorkerPoolSharing::worker_count = in_dispatch ? MAX(in_worker_count, 0) : 0;
+}
+
+struct WorkerPool
+{
+	WorkerPool() = default;
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool() { stop(); }
+
+	// Leaves headroom for the main thread, the live-link thread and Jolt
+	static i32 default_worker_count()
+	{
+		const i32 hardware_threads = (i32) std::thread::hardware_concurrency();
+		return CLAMP(hardware_threads - 2, 0, 8);
+	}
+
+	void start(i32 in_worker_count)
+	{
+		stop();
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = false;
+		started = true;
+		for (i32 worker_index = 0; worker_index < in_worker_count; ++worker_index)
+		{
+			workers.emplace([this]() { worker_main(); });
+		}
+	}
+
+	// Runs on the shared workers once worker_pool_share has installed them,
+	// otherwise starts default_worker_count() threads of its own
+	void start_shared()
+	{
+		if (WorkerPoolSharing::worker_count == 0)
+		{
+			start(default_worker_count());
+			return;
+		}
+		stop();
+		std::lock_guard<std::mutex> lock(mutex);
+		started = true;
+		shared_dispatch = WorkerPoolSharing::dispatch;
+		shared_helper_count = WorkerPoolSharing::worker_count;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			started = false;
+			shared_dispatch = {};
+			shared_helper_count = 0;
+			if (workers.empty())
+			{
+				return;
+			}
+			stopping = true;
+		}
+		wake_workers.notify_all();
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+		workers.reset();
+	}
+
+	bool is_started() const { return started; }
+	i32 worker_count() const { return shared_helper_count > 0 ? shared_helper_count : (i32) workers.length(); }
+
+	// Calls in_function(index) for every index in [0, in_count). Indices are
+	// claimed in in_batch_size blocks so tiny items do not thrash the counter.
+	void parallel_for(u32 in_count, const std::function<void(u32)>& in_function, u32 in_batch_size = 1)
+	{
+		if (in_count == 0)
+		{
+			return;
+		}
+
+		in_batch_size = MAX(in_batch_size, 1u);
+		if ((workers.empty() && shared_helper_count == 0) || in_count <= in_batch_size)
+		{
+			for (u32 index = 0; index < in_count; ++index)
+			{
+				in_function(index);
+			}
+			return;
+		}
+		if (shared_helper_count > 0)
+		{
+			parallel_for_shared(in_count, in_function, in_batch_size);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job_function = &in_function;
+			job_count = in_count;
+			job_batch_size = in_batch_size;
+			next_index.store(0, std::memory_order_relaxed);
+			active_workers = (i32) workers.length();
+			++job_generation;
+		}
+		wake_workers.notify_all();
+
+		run_job_items();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		job_finished.wait(lock, [this]() { return active_workers == 0; });
+		job_function = nullptr;
+	}
+
+private:
+	// A helper job may start after every index is claimed and parallel_for
+	// has returned, so helpers hold the loop state rather than pointing into
+	// the caller's frame. The caller only waits for batches already claimed,
+	// never for queued jobs, so a loop started from inside a shared worker
+	// cannot deadlock waiting on the queue behind it.
+	struct SharedJob
+	{
+		const std::function<void(u32)>* function = nullptr;
+		u32 count = 0;
+		u32 batch_size = 1;
+		std::atomic<u32> next_index = 0;
+		std::atomic<u32> completed = 0;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+
+	static void run_shared_items(SharedJob& io_job)
+	{
+		while (true)
+		{
+			const u32 begin = io_job.next_index.fetch_add(io_job.batch_size, std::memory_order_relaxed);
+			if (begin >= io_job.count)
+			{
+				return;
+			}
+			const u32 end = MIN(begin + io_job.batch_size, io_job.count);
+			for (u32 index = begin; index < end; ++index)
+			{
+				(*io_job.function)(index);
+			}
+			if (io_job.completed.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == io_job.count)
+			{
+				std::lock_guard<std::mutex> lock(io_job.mutex);
+				io_job.finished.notify_all();
+			}
+		}
+	}
+
+	void parallel_for_shared(u32 in_count, const std::function<void(u32)>& in_function, u32 in_batch_size)
+	{
+		std::shared_ptr<SharedJob> job = std::make_shared<SharedJob>();
+		job->function = &in_function;
+		job->count = in_count;
+		job->batch_size = in_batch_size;
+
+		const u32 batch_count = (in_count + in_batch_size - 1) / in_batch_size;
+		const i32 helper_count = MIN(shared_helper_count, (i32) batch_count - 1);
+		for (i32 helper_index = 0; helper_index < helper_count; ++helper_index)
+		{
+			shared_dispatch("WorkerPool", [job]() { run_shared_items(*job); });
+		}
+
+		run_shared_items(*job);
+
+		std::unique_lock<std::mutex> lock(job->mutex);
+		job->finished.wait(lock, [&]() { return job->completed.load(std::memory_order_acquire) == in_count; });
+	}
+
+	void run_job_items()
+	{
+		while (true)
+		{
+			const u32 begin = next_index.fetch_add(job_batch_size, std::memory_order_relaxed);
+			if (begin >= job_count)
+			{
+				return;
+			}
+			const u32 end = MIN(begin + job_batch_size, job_count);
+			for (u32 index = begin; index < end; ++index)
+			{
+				(*job_function)(index);
+			}
+		}
+	}
+
+	void worker_main()
+	{
+		u64 seen_generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake_workers.wait(lock, [&]() { return stopping || job_generation != seen_generation; });
+				if (stopping)
+				{
+					return;
+				}
+				seen_generation = job_generation;
+			}
+
+			run_job_items();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				--active_workers;
+			}
+			job_finished.notify_one();
+		}
+	}
+
+	DynamicArray<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake_workers;
+	std::condition_variable job_finished;
+	bool stopping = false;
+	bool started = false;
+
+	TaskGraphDispatch shared_dispatch;
+	i32 shared_helper_count = 0;
+
+	const std::function<void(u32)>* job_function = nullptr;
+	u32 job_count = 0;
+	u32 job_batch_size = 1;
+	u64 job_generation = 0;
+	i32 active_workers = 0;
+	std::atomic<u32> next_index = 0;
+};
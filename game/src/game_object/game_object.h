@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+
+#include "animation/animation_clip.h"
 #include "core/types.h"
 #include "render/gpu_buffer.h"
 
@@ -183,16 +186,6 @@ struct ArmatureBone
 	HMM_Mat4 inverse_bind_matrix = HMM_M4D(1.0f);
 };
 
-struct AnimationClip
-{
-	char* name = nullptr;
-	f32 frame_rate = 0.0f;
-	f32 duration_seconds = 0.0f;
-	i32 frame_count = 0;
-	i32 bone_count = 0;
-	HMM_Mat4* skin_matrices = nullptr;	// frame-major [frame_count * bone_count]
-};
-
 struct Armature
 {
 	u32 bone_count = 0;
@@ -202,7 +195,16 @@ struct Armature
 	AnimationClip* animations = nullptr;
 	i32 active_animation_index = 0;
 	f32 playback_time = 0.0f;
-	i32 current_frame = 0;
+	f32 current_frame = 0.0f;	// fractional; clips interpolate between frames
+
+	// Active clip sampled at current_frame (armature_sample_pose), shared by
+	// skinning, skinned bounds and sockets. Owned by each armature object,
+	// runtime copies included. pose_serial changes whenever the pose does.
+	HMM_Mat4* pose_matrices = nullptr;
+	i32 pose_capacity = 0;
+	const AnimationClip* pose_clip = nullptr;
+	f32 pose_frame = 0.0f;
+	u64 pose_serial = 0;
 };
 
 AnimationClip* armature_get_active_animation(Armature& in_armature)
@@ -220,6 +222,54 @@ AnimationClip* armature_get_active_animation(Armature& in_armature)
 	return &in_armature.animations[in_armature.active_animation_index];
 }
 
+// Skin matrices of the active clip at current_frame (bone_count of the clip),
+// or null when there is no clip with frames. Resampled only when the clip or
+// frame changed since the last call. In a frame, skinned armatures are
+// sampled by the "Skinned Animation Advance" task only; later tasks read the
+// result through armature_sampled_pose.
+const HMM_Mat4* armature_sample_pose(Armature& in_armature)
+{
+	static std::atomic<u64> next_pose_serial = 1;
+
+	const AnimationClip* animation = armature_get_active_animation(in_armature);
+	if (!animation || !animation_clip_has_frames(*animation))
+	{
+		in_armature.pose_clip = nullptr;
+		in_armature.pose_serial = 0;
+		return nullptr;
+	}
+	if (in_armature.pose_clip == animation && in_armature.pose_frame == in_armature.current_frame)
+	{
+		return in_armature.pose_matrices;
+	}
+
+	if (in_armature.pose_capacity < animation->bone_count)
+	{
+		free(in_armature.pose_matrices);
+		in_armature.pose_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * animation->bone_count);
+		in_armature.pose_capacity = animation->bone_count;
+	}
+	animation_clip_sample_pose(*animation, in_armature.current_frame, in_armature.pose_matrices, animation->bone_count);
+	in_armature.pose_clip = animation;
+	in_armature.pose_frame = in_armature.current_frame;
+	in_armature.pose_serial = next_pose_serial.fetch_add(1, std::memory_order_relaxed);
+	return in_armature.pose_matrices;
+}
+
+// The pose armature_sample_pose last produced, without resampling. Asserts
+// that it is still current, i.e. that the caller runs after this frame's
+// sampling and never needs a pose of its own.
+const HMM_Mat4* armature_sampled_pose(Armature& in_armature)
+{
+	const AnimationClip* animation = armature_get_active_animation(in_armature);
+	if (!animation || !animation_clip_has_frames(*animation))
+	{
+		return nullptr;
+	}
+	assert(in_armature.pose_clip == animation && in_armature.pose_frame == in_armature.current_frame);
+	return in_armature.pose_matrices;
+}
+
 enum class ObjectStorageKind : u8
 {
 	Authored,
@@ -422,30 +472,37 @@ void object_reset_jolt_body(Object& in_object)
 	object_add_jolt_body(in_object);
 }
 
-// Physics -> object transform writeback (location + rotation only)
-void object_copy_physics_transform(Object& in_object, JPH::BodyInterface& in_body_interface)
+// Physics -> object transform writeback (location + rotation only).
+// Returns true when the transform changed (sleeping bodies report false).
+bool object_copy_physics_transform(Object& in_object, JPH::BodyInterface& in_body_interface)
 {
+	JPH::RVec3 body_position;
+	JPH::Quat body_rotation;
 	if (in_object.has_rigid_body && in_object.rigid_body.jolt_body)
 	{
 		const JPH::BodyID body_id = in_object.rigid_body.jolt_body->GetID();
-		JPH::RVec3 body_position;
-		JPH::Quat body_rotation;
 		in_body_interface.GetPositionAndRotation(body_id, body_position, body_rotation);
-
-		Transform& transform = in_object.current_transform;
-		transform.location = HMM_V4(body_position.GetX(), body_position.GetY(), body_position.GetZ(), 1.0);
-		transform.rotation = HMM_Q(body_rotation.GetX(), body_rotation.GetY(), body_rotation.GetZ(), body_rotation.GetW());
 	}
 	else if (in_object.has_character && in_object.character.jph_character)
 	{
-		JPH::RVec3 body_position;
-		JPH::Quat body_rotation;
 		in_object.character.jph_character->GetPositionAndRotation(body_position, body_rotation);
+	}
+	else
+	{
+		return false;
+	}
 
-		Transform& transform = in_object.current_transform;
-		transform.location = HMM_V4(body_position.GetX(), body_position.GetY(), body_position.GetZ(), 1.0);
-		transform.rotation = HMM_Q(body_rotation.GetX(), body_rotation.GetY(), body_rotation.GetZ(), body_rotation.GetW());
+	const HMM_Vec4 location = HMM_V4(body_position.GetX(), body_position.GetY(), body_position.GetZ(), 1.0);
+	const HMM_Quat rotation = HMM_Q(body_rotation.GetX(), body_rotation.GetY(), body_rotation.GetZ(), body_rotation.GetW());
+	Transform& transform = in_object.current_transform;
+	if (memcmp(&transform.location, &location, sizeof(location)) == 0 &&
+		memcmp(&transform.rotation, &rotation, sizeof(rotation)) == 0)
+	{
+		return false;
 	}
+	transform.location = location;
+	transform.rotation = rotation;
+	return true;
 }
 
 bool object_is_sun_light(const Object& in_object)
@@ -453,10 +510,14 @@ bool object_is_sun_light(const Object& in_object)
 	return in_object.has_light && in_object.light.type == LightType::Sun;
 }
 
+// World bounds of the mesh as drawn: skinned meshes use their current pose
+// (AnimationSystem::update_skinned_bounds) once it has been evaluated
 BoundingBox object_get_bounding_box(const Object& in_object)
 {
 	assert(in_object.has_mesh);
-	return bounding_box_transform(in_object.mesh.bounding_box, in_object.current_transform);
+	const Mesh& mesh = in_object.mesh;
+	const BoundingBox& mesh_bounds = mesh.animated_bounds_valid ? mesh.animated_bounding_box : mesh.bounding_box;
+	return bounding_box_transform(mesh_bounds, in_object.current_transform);
 }
 
 void object_add_camera_control(Object& in_object, const CameraControlSettings& in_settings)
@@ -556,6 +617,7 @@ void object_cleanup_armature(Object& in_object)
 		return;
 	}
 
+	free(in_object.armature.pose_matrices);
 	if (in_object.storage_kind == ObjectStorageKind::RuntimeArmature)
 	{
 		in_object.armature = {};
@@ -571,8 +633,7 @@ void object_cleanup_armature(Object& in_object)
 
 	for (u32 animation_idx = 0; animation_idx < in_object.armature.animation_count; ++animation_idx)
 	{
-		free(in_object.armature.animations[animation_idx].name);
-		free(in_object.armature.animations[animation_idx].skin_matrices);
+		animation_clip_free(in_object.armature.animations[animation_idx]);
 	}
 	free(in_object.armature.animations);
 
@@ -591,25 +652,20 @@ void object_cleanup(Object& in_object)
 	{
 		if (in_object.storage_kind != ObjectStorageKind::RuntimePart)
 		{
-			free(in_object.mesh.indices);
-			in_object.mesh.index_buffer.destroy_gpu_buffer();
-
-			free(in_object.mesh.wire_indices);
-			in_object.mesh.wire_index_buffer.destroy_gpu_buffer();
-
-			if (in_object.mesh.vertices)
+			// Arena-backed streams (live-link decode) go back with the arena;
+			// content-cache streams stay cached until the cache evicts them
+			SharedArena* storage_arena = in_object.mesh.storage_arena;
+			if (in_object.mesh.shared_streams)
 			{
-				free(in_object.mesh.vertices);
-				in_object.mesh.vertex_buffer.destroy_gpu_buffer();
+				mesh_release_shared_streams(in_object.mesh);
 			}
-
-			if (in_object.mesh.has_skinned_vertices)
+			else
 			{
-				free(in_object.mesh.skinned_vertices);
-				in_object.mesh.skinned_vertex_buffer.destroy_gpu_buffer();
+				mesh_free_owned_streams(in_object.mesh);
 			}
 
-			free(in_object.mesh.material_indices);
+			if (!storage_arena) { free(in_object.mesh.material_indices); }
+			shared_arena_release(storage_arena);
 		}
 
 		if (in_object.mesh.has_skinned_vertices)
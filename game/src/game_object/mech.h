@@ -88,7 +88,11 @@ i32 mech_clone_armature(MechInstance& in_mech, i32 in_template_uid)
 	armature_instance.has_armature = true;
 	armature_instance.armature = armature_template.armature;
 	armature_instance.armature.playback_time = 0.0f;
-	armature_instance.armature.current_frame = 0;
+	armature_instance.armature.current_frame = 0.0f;
+	armature_instance.armature.pose_matrices = nullptr;
+	armature_instance.armature.pose_capacity = 0;
+	armature_instance.armature.pose_clip = nullptr;
+	armature_instance.armature.pose_serial = 0;
 
 	scene_insert_or_replace_object(state, std::move(armature_instance));
 	in_mech.armature_instances.add({
@@ -123,6 +127,8 @@ i32 mech_clone_part(MechInstance& in_mech, const Object& in_template)
 		{
 			template_mesh.skinned_vertex_buffer.get_gpu_buffer();
 		}
+		if (template_mesh.compact_vertices) template_mesh.compact_vertex_buffer.get_gpu_buffer();
+		if (template_mesh.compact_indices) template_mesh.compact_index_buffer.get_gpu_buffer();
 
 		instance.mesh = template_mesh;
 		instance.mesh.skin_matrix_arena_offset = -1;
@@ -130,6 +136,7 @@ i32 mech_clone_part(MechInstance& in_mech, const Object& in_template)
 		instance.mesh.skinned_vertex_cache_capacity = 0;
 		instance.mesh.skinned_vertex_cache_valid = false;
 		instance.mesh.tessellated_geometry = {};
+		instance.mesh.animated_bounds_valid = false;
 		instance.mesh.skin_matrices = nullptr;
 		if (instance.mesh.has_skinned_vertices && instance.mesh.skin_matrix_count > 0)
 		{
@@ -443,6 +450,7 @@ void update_mech_transforms()
 				body.current_transform.location = character_found->second.current_transform.location;
 				body.current_transform.rotation = character_found->second.current_transform.rotation;
 				body.current_transform.scale = body.initial_transform.scale;
+				scene_mark_render_object_dirty(state, body);
 				std::string body_error;
 				if (mech_part_instance_can_render(body, body_error)) body.visibility = true;
 				else add_error(PartType::Body, body_error);
@@ -484,6 +492,7 @@ void update_mech_transforms()
 					}
 					attached_transform.scale = part.initial_transform.scale;
 					part.current_transform = attached_transform;
+					scene_mark_render_object_dirty(state, part);
 					std::string part_error;
 					if (mech_part_instance_can_render(part, part_error)) part.visibility = true;
 					else add_error(part_type, part_error);
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "animation/skinned_bounds.h"
+#include "core/shared_arena.h"
 #include "render/gpu_buffer.h"
 #include "render/render_types.h"
+#include "render/vertex_quantization.h"
 #include "tessellation_common.h"
 
+#include <atomic>
+
 static_assert(sizeof(Vertex) == 48, "Vertex must match TessellationVertex shader layout");
 static_assert(sizeof(TessellationPatch) == 80, "TessellationPatch shader layout mismatch");
 static_assert(sizeof(TessellationCounters) == 32, "TessellationCounters shader layout mismatch");
@@ -64,6 +69,17 @@ struct MeshInitData
 	i32 armature_id = -1;
 	HMM_Mat4 mesh_to_armature = HMM_M4D(1.0f);
 	HMM_Mat4 armature_to_mesh = HMM_M4D(1.0f);
+
+	// Optional quantized GPU copies of vertices (and of indices when they
+	// fit 16 bits), decoded from the exporter's quantized streams
+	CompactVertex* compact_vertices = nullptr;
+	u16* compact_indices = nullptr;
+	VertexQuantization quantization;
+
+	// When set, indices/vertices/material_indices/skinned_vertices (and the
+	// compact streams) live in this arena instead of their own mallocs;
+	// make_mesh takes a reference to it
+	SharedArena* storage_arena = nullptr;
 };
 
 MeshInitData mesh_init_data_uv_sphere(f32 radius, i32 latitudes, i32 longitudes)
@@ -137,6 +153,49 @@ MeshInitData mesh_init_data_uv_sphere(f32 radius, i32 latitudes, i32 longitudes)
 	};
 }
 
+// Immutable CPU + GPU streams shared by every mesh whose decoded payload has
+// the same content hash (see live_link/live_link_content_cache.h). The GPU
+// buffers are created with the entry, so every attached Mesh copies the same
+// handles. ref_count counts attached meshes (main thread only); an entry at
+// zero stays cached until the cache evicts it.
+struct MeshSharedStreams
+{
+	u64 content_hash = 0;
+	u64 stream_id = 0;
+	u32 ref_count = 0;
+	u64 last_used = 0;
+	u64 byte_count = 0;
+	u64 upload_ticket = 0;	// async upload of the GPU buffers (see vulkan_upload_ready)
+
+	u32 index_count = 0;
+	u32* indices = nullptr;
+	GpuBuffer<u32> index_buffer;
+
+	u32 wire_index_count = 0;
+	u32* wire_indices = nullptr;
+	GpuBuffer<u32> wire_index_buffer;
+
+	u32 vertex_count = 0;
+	Vertex* vertices = nullptr;
+	GpuBuffer<Vertex> vertex_buffer;
+
+	SkinnedVertex* skinned_vertices = nullptr;
+	GpuBuffer<SkinnedVertex> skinned_vertex_buffer;
+	u32 skin_matrix_count = 0;
+	BoundingBox* skin_bone_bounds = nullptr;
+
+	CompactVertex* compact_vertices = nullptr;
+	GpuBuffer<CompactVertex> compact_vertex_buffer;
+	u16* compact_indices = nullptr;
+	GpuBuffer<u16> compact_index_buffer;
+	VertexQuantization quantization;
+
+	BoundingBox bounding_box;
+
+	// Keeps arena-backed streams alive independently of the mesh they came from
+	SharedArena* storage_arena = nullptr;
+};
+
 struct Mesh
 {
 	u32 index_count;
@@ -151,13 +210,23 @@ struct Mesh
 	Vertex* vertices;
 	GpuBuffer<Vertex> vertex_buffer;
 
+	// Quantized copies the static raster passes draw from when set (see
+	// mesh_use_compact_vertex_source). The float streams above stay
+	// authoritative for the CPU, tessellation, capture and the wire overlay.
+	CompactVertex* compact_vertices = nullptr;
+	GpuBuffer<CompactVertex> compact_vertex_buffer;
+	u16* compact_indices = nullptr;
+	GpuBuffer<u16> compact_index_buffer;
+	VertexQuantization quantization;
+
 	// Raw material IDS until resolve_mesh_material_indices runs at drain;
 	// after that, indices into state.materials.items (-1 = none)
 	u32 material_indices_count;
 	i32* material_indices;
 
-	// Skinning. skin_matrices is the CPU array update_skinned_animations
-	// fills each frame and appends into the shared arena SSBO; there is no
+	// Skinning. pack_skin_matrices writes each mesh's rows straight into the
+	// shared arena SSBO (meshes with identical rows share an offset);
+	// skin_matrices is only filled by the serial reference path. There is no
 	// per-mesh GPU skin matrix buffer. The arena ring makes per-frame writes
 	// safe against frames in flight. The GPU
 	// skinning compute pass reads the same arena.
@@ -171,6 +240,16 @@ struct Mesh
 	HMM_Mat4 mesh_to_armature;
 	HMM_Mat4 armature_to_mesh;
 
+	// Per-bone bind-pose boxes (skinned_bounds_bone_box_count entries), owned
+	// with the streams. animated_bounding_box is skinned_bounds_evaluate for
+	// the armature pose with serial animated_bounds_pose_serial (0 = bind
+	// pose); AnimationSystem::update_skinned_bounds refreshes it when valid
+	// is false or the pose changes.
+	BoundingBox* skin_bone_bounds = nullptr;
+	BoundingBox animated_bounding_box;
+	u64 animated_bounds_pose_serial = 0;
+	bool animated_bounds_valid = false;
+
 	// GPU-skinned vertex cache (compute-baked; consumed by tessellation and
 	// the wire overlay via mesh_get_render_view)
 	GpuBuffer<Vertex> skinned_vertex_cache_buffer;
@@ -179,8 +258,35 @@ struct Mesh
 	TessellatedGeometry tessellated_geometry;
 
 	BoundingBox bounding_box;
+
+	// Owner of the CPU streams when they were decoded into a shared arena
+	// (see MeshInitData::storage_arena); released instead of freeing them
+	SharedArena* storage_arena = nullptr;
+
+	// Set when the index/vertex/skinned streams and their GPU buffers are
+	// borrowed from the content cache rather than owned by this mesh
+	MeshSharedStreams* shared_streams = nullptr;
+
+	// Content cache key set by live-link decode (0 = never shared)
+	u64 content_hash = 0;
+
+	// Identifies the streams above for the indirect draw mesh pool. Copies and
+	// meshes attached to the same shared streams carry the same id; new streams
+	// get a new one and ids are never reused (0 = never pooled).
+	u64 stream_id = 0;
+
+	// Shared GPU buffers are filled by the async upload engine; the mesh is
+	// not drawn until this ticket is ready (0 = nothing to wait for)
+	u64 upload_ticket = 0;
 };
 
+// make_mesh runs on the live-link decode workers
+inline u64 mesh_next_stream_id()
+{
+	static std::atomic<u64> next_stream_id = 1;
+	return next_stream_id.fetch_add(1, std::memory_order_relaxed);
+}
+
 void mesh_reset_skin_matrices(Mesh& in_mesh)
 {
 	for (u32 matrix_idx = 0; matrix_idx < in_mesh.skin_matrix_count; ++matrix_idx)
@@ -200,6 +306,7 @@ struct MeshRenderView
 	u32 index_count = 0;
 	u32 wire_index_count = 0;
 	bool is_tessellated = false;
+	VkIndexType index_type = VK_INDEX_TYPE_UINT32;
 };
 
 MeshRenderView mesh_get_render_view(Mesh& in_mesh)
@@ -251,6 +358,26 @@ bool mesh_use_deformed_vertex_source(Mesh& in_mesh, MeshRenderView& in_out_rende
 	return true;
 }
 
+// Swaps in the quantized vertex (and 16-bit index) buffers for the static
+// geometry and shadow passes. Only meshes that arrived quantized and draw
+// from their own unskinned, untessellated streams qualify; the caller then
+// binds the compact pipeline and pushes in_mesh.quantization.
+bool mesh_use_compact_vertex_source(Mesh& in_mesh, MeshRenderView& in_out_render_view)
+{
+	if (!in_mesh.compact_vertices || in_mesh.has_skinned_vertices || in_out_render_view.is_tessellated)
+	{
+		return false;
+	}
+
+	in_out_render_view.vertex_buffer = in_mesh.compact_vertex_buffer.get_gpu_buffer();
+	if (in_mesh.compact_indices)
+	{
+		in_out_render_view.index_buffer = in_mesh.compact_index_buffer.get_gpu_buffer();
+		in_out_render_view.index_type = VK_INDEX_TYPE_UINT16;
+	}
+	return true;
+}
+
 void mesh_cleanup_tessellated_geometry(Mesh& in_mesh)
 {
 	for (TessellatedGeometry::GpuSlot& slot : in_mesh.tessellated_geometry.gpu_slots)
@@ -265,7 +392,8 @@ void mesh_cleanup_tessellated_geometry(Mesh& in_mesh)
 	in_mesh.tessellated_geometry = {};
 }
 
-// Takes ownership of vertices and indices. Only constructs GpuBuffer
+// Takes ownership of vertices and indices (or a reference to their
+// storage_arena). Only constructs GpuBuffer
 // descriptors — actual GPU buffers are created lazily on the main thread.
 Mesh make_mesh(const MeshInitData& in_init_data)
 {
@@ -332,6 +460,25 @@ Mesh make_mesh(const MeshInitData& in_init_data)
 			},
 			.label = "Mesh::vertex_buffer",
 		}),
+		.compact_vertices = in_init_data.compact_vertices,
+		.compact_vertex_buffer = GpuBuffer((GpuBufferDesc<CompactVertex>){
+			.data = in_init_data.compact_vertices,
+			.size = in_init_data.compact_vertices ? sizeof(CompactVertex) * in_init_data.num_vertices : 0,
+			.usage = {
+				.vertex_buffer = true,
+			},
+			.label = "Mesh::compact_vertex_buffer",
+		}),
+		.compact_indices = in_init_data.compact_indices,
+		.compact_index_buffer = GpuBuffer((GpuBufferDesc<u16>){
+			.data = in_init_data.compact_indices,
+			.size = in_init_data.compact_indices ? sizeof(u16) * in_init_data.num_indices : 0,
+			.usage = {
+				.index_buffer = true,
+			},
+			.label = "Mesh::compact_index_buffer",
+		}),
+		.quantization = in_init_data.quantization,
 		.material_indices_count = in_init_data.num_material_indices,
 		.material_indices = in_init_data.material_indices,
 		.has_skinned_vertices = false,
@@ -343,7 +490,10 @@ Mesh make_mesh(const MeshInitData& in_init_data)
 		.mesh_to_armature = in_init_data.mesh_to_armature,
 		.armature_to_mesh = in_init_data.armature_to_mesh,
 		.bounding_box = bounding_box,
+		.storage_arena = in_init_data.storage_arena,
+		.stream_id = mesh_next_stream_id(),
 	};
+	shared_arena_retain(in_init_data.storage_arena);
 
 	if (in_init_data.skinned_vertices != nullptr)
 	{
@@ -365,7 +515,182 @@ Mesh make_mesh(const MeshInitData& in_init_data)
 		{
 			out_mesh.skin_matrices[matrix_idx] = HMM_M4D(1.0f);
 		}
+
+		out_mesh.skin_bone_bounds = (BoundingBox*) malloc(sizeof(BoundingBox) * skinned_bounds_bone_box_count(out_mesh.skin_matrix_count));
+		skinned_bounds_compute_bone_boxes(
+			in_init_data.vertices,
+			in_init_data.skinned_vertices,
+			in_init_data.num_vertices,
+			out_mesh.skin_matrix_count,
+			out_mesh.skin_bone_bounds
+		);
 	}
 
 	return out_mesh;
 }
+
+// Frees the index/wire/vertex/skinned streams and skin bone bounds a mesh
+// owns (material indices and skin matrices are left to the caller). GPU
+// destruction is deferred.
+void mesh_free_owned_streams(Mesh& in_mesh)
+{
+	assert(in_mesh.shared_streams == nullptr);
+	if (!in_mesh.storage_arena)
+	{
+		free(in_mesh.indices);
+		free(in_mesh.vertices);
+		free(in_mesh.skinned_vertices);
+		free(in_mesh.compact_vertices);
+		free(in_mesh.compact_indices);
+	}
+	free(in_mesh.wire_indices);
+	free(in_mesh.skin_bone_bounds);
+	in_mesh.index_buffer.destroy_gpu_buffer();
+	in_mesh.wire_index_buffer.destroy_gpu_buffer();
+	in_mesh.vertex_buffer.destroy_gpu_buffer();
+	in_mesh.skinned_vertex_buffer.destroy_gpu_buffer();
+	in_mesh.compact_vertex_buffer.destroy_gpu_buffer();
+	in_mesh.compact_index_buffer.destroy_gpu_buffer();
+
+	in_mesh.indices = nullptr;
+	in_mesh.wire_indices = nullptr;
+	in_mesh.vertices = nullptr;
+	in_mesh.skinned_vertices = nullptr;
+	in_mesh.compact_vertices = nullptr;
+	in_mesh.compact_indices = nullptr;
+	in_mesh.skin_bone_bounds = nullptr;
+	in_mesh.animated_bounds_valid = false;
+}
+
+// Points in_mesh at shared streams and takes a reference. Per-mesh state
+// (material indices, skin matrices, caches, tessellation) stays with the mesh.
+void mesh_attach_shared_streams(Mesh& in_mesh, MeshSharedStreams& in_shared)
+{
+	in_mesh.index_count = in_shared.index_count;
+	in_mesh.indices = in_shared.indices;
+	in_mesh.index_buffer = in_shared.index_buffer;
+	in_mesh.wire_index_count = in_shared.wire_index_count;
+	in_mesh.wire_indices = in_shared.wire_indices;
+	in_mesh.wire_index_buffer = in_shared.wire_index_buffer;
+	in_mesh.vertex_count = in_shared.vertex_count;
+	in_mesh.vertices = in_shared.vertices;
+	in_mesh.vertex_buffer = in_shared.vertex_buffer;
+	in_mesh.skinned_vertices = in_shared.skinned_vertices;
+	in_mesh.skinned_vertex_buffer = in_shared.skinned_vertex_buffer;
+	in_mesh.has_skinned_vertices = in_shared.skinned_vertices != nullptr;
+	in_mesh.compact_vertices = in_shared.compact_vertices;
+	in_mesh.compact_vertex_buffer = in_shared.compact_vertex_buffer;
+	in_mesh.compact_indices = in_shared.compact_indices;
+	in_mesh.compact_index_buffer = in_shared.compact_index_buffer;
+	in_mesh.quantization = in_shared.quantization;
+	in_mesh.bounding_box = in_shared.bounding_box;
+	in_mesh.skin_bone_bounds = in_shared.skin_bone_bounds;
+	in_mesh.animated_bounds_valid = false;
+	in_mesh.stream_id = in_shared.stream_id;
+	in_mesh.upload_ticket = in_shared.upload_ticket;
+
+	if (in_mesh.has_skinned_vertices && in_mesh.skin_matrix_count != in_shared.skin_matrix_count)
+	{
+		free(in_mesh.skin_matrices);
+		in_mesh.skin_matrix_count = in_shared.skin_matrix_count;
+		in_mesh.skin_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * in_mesh.skin_matrix_count);
+		mesh_reset_skin_matrices(in_mesh);
+	}
+
+	in_mesh.shared_streams = &in_shared;
+	in_shared.ref_count += 1;
+}
+
+// Moves in_mesh's streams into a new shared entry and attaches in_mesh to it.
+// GPU buffers are created here (main thread) so later attachments share them,
+// the same way mech clones share their template's buffers. Their contents go
+// through the async upload engine, so the mesh appears once they land.
+MeshSharedStreams* mesh_share_streams(Mesh& in_mesh, u64 in_content_hash)
+{
+	assert(in_mesh.shared_streams == nullptr);
+	MeshSharedStreams* shared = new MeshSharedStreams{
+		.content_hash = in_content_hash,
+		.stream_id = in_mesh.stream_id,
+		.byte_count =
+			sizeof(u32) * ((u64) in_mesh.index_count + in_mesh.wire_index_count) +
+			sizeof(Vertex) * (u64) in_mesh.vertex_count +
+			(in_mesh.has_skinned_vertices ? sizeof(SkinnedVertex) * (u64) in_mesh.vertex_count : 0) +
+			(in_mesh.compact_vertices ? sizeof(CompactVertex) * (u64) in_mesh.vertex_count : 0) +
+			(in_mesh.compact_indices ? sizeof(u16) * (u64) in_mesh.index_count : 0),
+		.index_count = in_mesh.index_count,
+		.indices = in_mesh.indices,
+		.index_buffer = in_mesh.index_buffer,
+		.wire_index_count = in_mesh.wire_index_count,
+		.wire_indices = in_mesh.wire_indices,
+		.wire_index_buffer = in_mesh.wire_index_buffer,
+		.vertex_count = in_mesh.vertex_count,
+		.vertices = in_mesh.vertices,
+		.vertex_buffer = in_mesh.vertex_buffer,
+		.skinned_vertices = in_mesh.has_skinned_vertices ? in_mesh.skinned_vertices : nullptr,
+		.skinned_vertex_buffer = in_mesh.skinned_vertex_buffer,
+		.skin_matrix_count = in_mesh.skin_matrix_count,
+		.skin_bone_bounds = in_mesh.skin_bone_bounds,
+		.compact_vertices = in_mesh.compact_vertices,
+		.compact_vertex_buffer = in_mesh.compact_vertex_buffer,
+		.compact_indices = in_mesh.compact_indices,
+		.compact_index_buffer = in_mesh.compact_index_buffer,
+		.quantization = in_mesh.quantization,
+		.bounding_box = in_mesh.bounding_box,
+		.storage_arena = in_mesh.storage_arena,
+	};
+	shared_arena_retain(shared->storage_arena);
+
+	if (shared->index_count > 0) shared->index_buffer.create_gpu_buffer_async();
+	if (shared->wire_index_count > 0) shared->wire_index_buffer.create_gpu_buffer_async();
+	if (shared->vertex_count > 0) shared->vertex_buffer.create_gpu_buffer_async();
+	if (shared->skinned_vertices) shared->skinned_vertex_buffer.create_gpu_buffer_async();
+	if (shared->compact_vertices) shared->compact_vertex_buffer.create_gpu_buffer_async();
+	if (shared->compact_indices) shared->compact_index_buffer.create_gpu_buffer_async();
+	// Tickets complete in order, so the newest covers all six
+	shared->upload_ticket = MAX(
+		MAX(MAX(shared->index_buffer.upload_ticket(), shared->wire_index_buffer.upload_ticket()),
+			MAX(shared->vertex_buffer.upload_ticket(), shared->skinned_vertex_buffer.upload_ticket())),
+		MAX(shared->compact_vertex_buffer.upload_ticket(), shared->compact_index_buffer.upload_ticket()));
+
+	mesh_attach_shared_streams(in_mesh, *shared);
+	return shared;
+}
+
+void mesh_release_shared_streams(Mesh& in_mesh)
+{
+	MeshSharedStreams* shared = in_mesh.shared_streams;
+	assert(shared && shared->ref_count > 0);
+	shared->ref_count -= 1;
+	in_mesh.shared_streams = nullptr;
+	in_mesh.upload_ticket = 0;
+}
+
+// False while the mesh's shared GPU buffers are still being uploaded
+inline bool mesh_gpu_ready(const Mesh& in_mesh)
+{
+	return in_mesh.upload_ticket == 0 || vulkan_upload_ready(g_vulkan_context, in_mesh.upload_ticket);
+}
+
+// Destroys an unreferenced entry. GPU destruction is deferred.
+void mesh_shared_streams_destroy(MeshSharedStreams* in_shared)
+{
+	assert(in_shared->ref_count == 0);
+	in_shared->index_buffer.destroy_gpu_buffer();
+	in_shared->wire_index_buffer.destroy_gpu_buffer();
+	in_shared->vertex_buffer.destroy_gpu_buffer();
+	in_shared->skinned_vertex_buffer.destroy_gpu_buffer();
+	in_shared->compact_vertex_buffer.destroy_gpu_buffer();
+	in_shared->compact_index_buffer.destroy_gpu_buffer();
+	free(in_shared->wire_indices);
+	free(in_shared->skin_bone_bounds);
+	if (!in_shared->storage_arena)
+	{
+		free(in_shared->indices);
+		free(in_shared->vertices);
+		free(in_shared->skinned_vertices);
+		free(in_shared->compact_vertices);
+		free(in_shared->compact_indices);
+	}
+	shared_arena_release(in_shared->storage_arena);
+	delete in_shared;
+}
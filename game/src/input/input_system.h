@@ -442,6 +442,7 @@ namespace InputSystem
 				for (auto& [reset_uid, reset_object] : in_state.scene.objects)
 				{
 					reset_object.current_transform = reset_object.initial_transform;
+					scene_mark_render_object_dirty(in_state, reset_object);
 					if (reset_object.has_rigid_body && reset_object.rigid_body.jolt_body != nullptr)
 					{
 						object_reset_jolt_body(reset_object);
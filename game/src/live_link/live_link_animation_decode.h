@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "animation/animation_clip.h"
+#include "blender_live_link_generated.h"
+#include "core/types.h"
+
+// ---- Live link animation decode ----
+// Fills an AnimationClip's frames from an Animation table (the caller owns
+// the name). The compact encoding (Animation.compact_tracks and key arrays)
+// is copied as is after validation. Matrix payloads are compressed on the
+// live-link thread when every matrix decomposes, and kept as matrices
+// otherwise. A malformed compact encoding falls back to the matrices.
+
+struct LiveLinkAnimationDecodeResult
+{
+	i32 matrix_count = 0;	// frame_count * bone_count
+	bool arrived_compact = false;
+	bool compressed = false;
+	u64 matrix_bytes = 0;	// size as frame-major matrices
+	u64 stored_bytes = 0;	// size as kept in memory
+};
+
+// Compact encoding -> out_animation. Returns false (out_animation empty) when
+// the arrays are missing, inconsistent or fail compressed_animation_is_valid.
+inline bool live_link_decode_compact_animation(const Blender::LiveLink::Animation* in_animation, CompressedAnimation& out_animation)
+{
+	out_animation = {};
+	auto tracks = in_animation->compact_tracks();
+	auto vector_key_frames = in_animation->vector_key_frames();
+	auto vector_keys = in_animation->vector_keys();
+	auto rotation_key_frames = in_animation->rotation_key_frames();
+	auto rotation_keys = in_animation->rotation_keys();
+	const i32 frame_count = in_animation->frame_count();
+	const i32 bone_count = in_animation->bone_count();
+	if (!tracks || !vector_key_frames || !vector_keys || !rotation_key_frames || !rotation_keys
+		|| frame_count <= 0 || bone_count <= 0
+		|| tracks->size() != (u32) bone_count * ANIMATION_CHANNEL_COUNT * 2
+		|| vector_keys->size() != vector_key_frames->size() * 3
+		|| rotation_keys->size() != rotation_key_frames->size() * 3)
+	{
+		return false;
+	}
+
+	compressed_animation_allocate(out_animation, frame_count, bone_count, vector_key_frames->size(), rotation_key_frames->size());
+	static_assert(sizeof(AnimationTrack) == sizeof(u32) * 2, "AnimationTrack matches two compact_tracks entries");
+	memcpy(out_animation.tracks, tracks->data(), sizeof(u32) * tracks->size());
+	memcpy(out_animation.vector_key_frames, vector_key_frames->data(), sizeof(u16) * vector_key_frames->size());
+	memcpy(out_animation.vector_keys, vector_keys->data(), sizeof(f32) * vector_keys->size());
+	memcpy(out_animation.rotation_key_frames, rotation_key_frames->data(), sizeof(u16) * rotation_key_frames->size());
+	memcpy(out_animation.rotation_keys, rotation_keys->data(), sizeof(u16) * rotation_keys->size());
+	if (!compressed_animation_is_valid(out_animation))
+	{
+		compressed_animation_free(out_animation);
+		return false;
+	}
+	return true;
+}
+
+inline void live_link_decode_animation(
+	const Blender::LiveLink::Animation* in_animation,
+	AnimationClip& out_clip,
+	AnimationReductionScratch& in_out_scratch,
+	LiveLinkAnimationDecodeResult& out_result)
+{
+	out_clip.frame_rate = in_animation->frame_rate();
+	out_clip.duration_seconds = in_animation->duration_seconds();
+	out_clip.frame_count = in_animation->frame_count();
+	out_clip.bone_count = in_animation->bone_count();
+
+	out_result = {};
+	out_result.matrix_count = MAX(0, out_clip.frame_count * out_clip.bone_count);
+	out_result.matrix_bytes = sizeof(HMM_Mat4) * (u64) out_result.matrix_count;
+	if (out_result.matrix_count == 0)
+	{
+		return;
+	}
+
+	if (in_animation->compact_tracks())
+	{
+		if (live_link_decode_compact_animation(in_animation, out_clip.compressed))
+		{
+			out_result.arrived_compact = true;
+			out_result.compressed = true;
+			out_result.stored_bytes = animation_clip_byte_count(out_clip);
+			return;
+		}
+		printf("\tAnimation has a malformed compact encoding; using its matrices\n");
+	}
+
+	const i32 matrix_count = out_result.matrix_count;
+	out_clip.skin_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * matrix_count);
+	for (i32 matrix_idx = 0; matrix_idx < matrix_count; ++matrix_idx)
+	{
+		out_clip.skin_matrices[matrix_idx] = HMM_M4D(1.0f);
+	}
+
+	if (auto flatbuffer_skin_matrices = in_animation->skin_matrices())
+	{
+		const i32 available_matrix_count = MIN((i32) (flatbuffer_skin_matrices->size() / 16), matrix_count);
+		memcpy(out_clip.skin_matrices, flatbuffer_skin_matrices->data(), sizeof(HMM_Mat4) * available_matrix_count);
+	}
+
+	out_result.compressed = animation_clip_compress(out_clip, in_out_scratch);
+	out_result.stored_bytes = animation_clip_byte_count(out_clip);
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "core/dynamic_array.h"
+#include "live_link/live_link_framing.h"
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// ---- Live link capture files ----
+// --record-live-link appends every Update the live-link thread hands to
+// parse_flatbuffer_data (a chunked transfer is stored once, assembled) and
+// --replay-live-link memory-maps the file and feeds the same frames back
+// through parse_flatbuffer_data -> live_link_drain_channels.
+//
+// Layout (little endian):
+//   LiveLinkCaptureHeader
+//   per frame: LiveLinkCaptureRecordHeader, size-prefixed Update, zero pad to 8
+//   LiveLinkCaptureIndexEntry[frame_count]		(written on close)
+//
+// header.index_offset stays 0 until the recorder closes, so a capture cut
+// short by a crash is still readable: the reader then walks the records and
+// keeps every complete one. Frames start 8-byte aligned in the file so
+// they can be parsed straight from the mapping.
+
+static constexpr char LIVE_LINK_CAPTURE_MAGIC[8] = { 'B', 'L', 'L', 'C', 'A', 'P', 'T', '\0' };
+static constexpr u32 LIVE_LINK_CAPTURE_VERSION = 1;
+
+struct LiveLinkCaptureHeader
+{
+	char magic[8];
+	u32 version;
+	u32 reserved;
+	u64 frame_count;		// valid once index_offset != 0
+	u64 index_offset;		// 0: recording was not closed, scan the records
+};
+
+struct LiveLinkCaptureRecordHeader
+{
+	u64 timestamp_ns;		// since the recorder opened
+	u32 connection_id;
+	u32 frame_size;			// size prefix + payload
+};
+
+struct LiveLinkCaptureIndexEntry
+{
+	u64 frame_offset;		// of the size prefix, past the record header
+	u64 timestamp_ns;
+	u32 frame_size;
+	u32 connection_id;
+};
+
+static_assert(sizeof(LiveLinkCaptureHeader) == 32);
+static_assert(sizeof(LiveLinkCaptureRecordHeader) == 16);
+static_assert(sizeof(LiveLinkCaptureIndexEntry) == 24);
+
+inline u64 live_link_capture_padded_size(u64 in_size)
+{
+	return (in_size + 7) & ~7ull;
+}
+
+// ---- Recording (live-link thread) ----
+
+struct LiveLinkCaptureWriter
+{
+	FILE* file = nullptr;
+	u64 write_offset = 0;
+	u64 byte_count = 0;		// frame bytes, excluding headers and padding
+	DynamicArray<LiveLinkCaptureIndexEntry> index;
+	std::chrono::steady_clock::time_point start_time;
+};
+
+inline bool live_link_capture_writer_open(LiveLinkCaptureWriter& in_writer, const char* in_path)
+{
+	in_writer.file = fopen(in_path, "wb");
+	if (!in_writer.file)
+	{
+		printf("live link: cannot create capture file %s\n", in_path);
+		return false;
+	}
+
+	LiveLinkCaptureHeader header = {};
+	memcpy(header.magic, LIVE_LINK_CAPTURE_MAGIC, sizeof(header.magic));
+	header.version = LIVE_LINK_CAPTURE_VERSION;
+	fwrite(&header, sizeof(header), 1, in_writer.file);
+	fflush(in_writer.file);
+
+	in_writer.write_offset = sizeof(header);
+	in_writer.byte_count = 0;
+	in_writer.index.clear();
+	in_writer.start_time = std::chrono::steady_clock::now();
+	printf("live link: recording to %s\n", in_path);
+	return true;
+}
+
+// Appends one size-prefixed Update. Flushed right away so a killed process
+// keeps everything it received.
+inline bool live_link_capture_writer_append(LiveLinkCaptureWriter& in_writer, u32 in_connection_id, const u8* in_frame, size_t in_size)
+{
+	if (!in_writer.file || in_size < LIVE_LINK_FRAME_PREFIX_BYTES || in_size > 0xFFFFFFFFull)
+	{
+		return false;
+	}
+
+	const LiveLinkCaptureRecordHeader record = {
+		.timestamp_ns = (u64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - in_writer.start_time).count(),
+		.connection_id = in_connection_id,
+		.frame_size = (u32) in_size,
+	};
+	static constexpr u8 padding[8] = {};
+	const u64 padding_size = live_link_capture_padded_size(in_size) - in_size;
+	if (	fwrite(&record, sizeof(record), 1, in_writer.file) != 1
+		||	fwrite(in_frame, 1, in_size, in_writer.file) != in_size
+		||	fwrite(padding, 1, padding_size, in_writer.file) != padding_size)
+	{
+		printf("live link: capture write failed; recording stopped\n");
+		fclose(in_writer.file);
+		in_writer.file = nullptr;
+		return false;
+	}
+	fflush(in_writer.file);
+
+	in_writer.index.add({
+		.frame_offset = in_writer.write_offset + sizeof(record),
+		.timestamp_ns = record.timestamp_ns,
+		.frame_size = record.frame_size,
+		.connection_id = in_connection_id,
+	});
+	in_writer.write_offset += sizeof(record) + in_size + padding_size;
+	in_writer.byte_count += in_size;
+	return true;
+}
+
+// Writes the index and finalizes the header
+inline void live_link_capture_writer_close(LiveLinkCaptureWriter& in_writer)
+{
+	if (!in_writer.file)
+	{
+		return;
+	}
+
+	LiveLinkCaptureHeader header = {};
+	memcpy(header.magic, LIVE_LINK_CAPTURE_MAGIC, sizeof(header.magic));
+	header.version = LIVE_LINK_CAPTURE_VERSION;
+	header.frame_count = in_writer.index.length();
+	header.index_offset = in_writer.write_offset;
+	fwrite(in_writer.index.data(), sizeof(LiveLinkCaptureIndexEntry), in_writer.index.length(), in_writer.file);
+	fseek(in_writer.file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, in_writer.file);
+	fclose(in_writer.file);
+	in_writer.file = nullptr;
+	printf("live link: recorded %zu updates (%llu bytes)\n",
+		in_writer.index.length(), (unsigned long long) in_writer.byte_count);
+}
+
+// ---- Reading ----
+
+struct LiveLinkCapture
+{
+	const u8* data = nullptr;	// read-only mapping of the whole file
+	u64 size = 0;
+	DynamicArray<LiveLinkCaptureIndexEntry> frames;
+	bool recovered = false;		// no index, frames found by scanning
+
+	#if defined(_WIN32)
+	HANDLE file_handle = INVALID_HANDLE_VALUE;
+	HANDLE mapping_handle = nullptr;
+	#endif
+};
+
+inline bool live_link_capture_frame_valid(const LiveLinkCapture& in_capture, const LiveLinkCaptureIndexEntry& in_entry)
+{
+	if (	in_entry.frame_size < LIVE_LINK_FRAME_PREFIX_BYTES
+		||	in_entry.frame_offset > in_capture.size
+		||	in_entry.frame_size > in_capture.size - in_entry.frame_offset)
+	{
+		return false;
+	}
+	const u8* prefix = in_capture.data + in_entry.frame_offset;
+	const u64 payload_size = (u64) prefix[0]
+		| ((u64) prefix[1] << 8)
+		| ((u64) prefix[2] << 16)
+		| ((u64) prefix[3] << 24);
+	return payload_size + LIVE_LINK_FRAME_PREFIX_BYTES == in_entry.frame_size;
+}
+
+// Builds the frame list from the index, or by walking the records when the
+// recording never closed
+inline bool live_link_capture_load_frames(LiveLinkCapture& in_capture)
+{
+	LiveLinkCaptureHeader header;
+	if (in_capture.size < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, in_capture.data, sizeof(header));
+	if (memcmp(header.magic, LIVE_LINK_CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != LIVE_LINK_CAPTURE_VERSION)
+	{
+		return false;
+	}
+
+	in_capture.frames.clear();
+	const u64 index_bytes = header.frame_count * sizeof(LiveLinkCaptureIndexEntry);
+	if (	header.index_offset >= sizeof(header)
+		&&	header.index_offset <= in_capture.size
+		&&	header.frame_count <= in_capture.size / sizeof(LiveLinkCaptureIndexEntry)
+		&&	index_bytes <= in_capture.size - header.index_offset)
+	{
+		in_capture.frames.resize(header.frame_count);
+		memcpy(in_capture.frames.data(), in_capture.data + header.index_offset, index_bytes);
+		bool index_valid = true;
+		for (const LiveLinkCaptureIndexEntry& entry : in_capture.frames)
+		{
+			index_valid = index_valid && live_link_capture_frame_valid(in_capture, entry);
+		}
+		if (index_valid)
+		{
+			return true;
+		}
+		in_capture.frames.clear();
+	}
+
+	in_capture.recovered = true;
+	u64 offset = sizeof(header);
+	while (offset + sizeof(LiveLinkCaptureRecordHeader) <= in_capture.size)
+	{
+		LiveLinkCaptureRecordHeader record;
+		memcpy(&record, in_capture.data + offset, sizeof(record));
+		const LiveLinkCaptureIndexEntry entry = {
+			.frame_offset = offset + sizeof(record),
+			.timestamp_ns = record.timestamp_ns,
+			.frame_size = record.frame_size,
+			.connection_id = record.connection_id,
+		};
+		if (!live_link_capture_frame_valid(in_capture, entry))
+		{
+			break;	// truncated tail
+		}
+		in_capture.frames.add(entry);
+		offset = entry.frame_offset + live_link_capture_padded_size(entry.frame_size);
+	}
+	return true;
+}
+
+inline void live_link_capture_unmap(LiveLinkCapture& in_capture)
+{
+	#if defined(_WIN32)
+	if (in_capture.data)
+	{
+		UnmapViewOfFile(in_capture.data);
+	}
+	if (in_capture.mapping_handle)
+	{
+		CloseHandle(in_capture.mapping_handle);
+	}
+	if (in_capture.file_handle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(in_capture.file_handle);
+	}
+	in_capture.mapping_handle = nullptr;
+	in_capture.file_handle = INVALID_HANDLE_VALUE;
+	#else
+	if (in_capture.data)
+	{
+		munmap((void*) in_capture.data, (size_t) in_capture.size);
+	}
+	#endif
+	in_capture.data = nullptr;
+	in_capture.size = 0;
+	in_capture.frames.reset();
+	in_capture.recovered = false;
+}
+
+// Maps in_path read-only. Frames point into the mapping until unmap.
+inline bool live_link_capture_map(LiveLinkCapture& in_capture, const char* in_path)
+{
+	live_link_capture_unmap(in_capture);
+
+	#if defined(_WIN32)
+	in_capture.file_handle = CreateFileA(in_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER file_size = {};
+	if (in_capture.file_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(in_capture.file_handle, &file_size) || file_size.QuadPart == 0)
+	{
+		printf("live link: cannot open capture file %s\n", in_path);
+		live_link_capture_unmap(in_capture);
+		return false;
+	}
+	in_capture.mapping_handle = CreateFileMappingA(in_capture.file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	in_capture.data = in_capture.mapping_handle
+		? (const u8*) MapViewOfFile(in_capture.mapping_handle, FILE_MAP_READ, 0, 0, 0)
+		: nullptr;
+	in_capture.size = (u64) file_size.QuadPart;
+	#else
+	const int file = open(in_path, O_RDONLY);
+	struct stat file_stat = {};
+	if (file < 0 || fstat(file, &file_stat) != 0 || file_stat.st_size == 0)
+	{
+		printf("live link: cannot open capture file %s\n", in_path);
+		if (file >= 0)
+		{
+			close(file);
+		}
+		return false;
+	}
+	void* mapping = mmap(nullptr, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (mapping != MAP_FAILED)
+	{
+		in_capture.data = (const u8*) mapping;
+		in_capture.size = (u64) file_stat.st_size;
+	}
+	#endif
+
+	if (!in_capture.data)
+	{
+		printf("live link: cannot map capture file %s\n", in_path);
+		live_link_capture_unmap(in_capture);
+		return false;
+	}
+	if (!live_link_capture_load_frames(in_capture))
+	{
+		printf("live link: %s is not a live-link capture\n", in_path);
+		live_link_capture_unmap(in_capture);
+		return false;
+	}
+	if (in_capture.recovered)
+	{
+		printf("live link: %s has no index (recording was interrupted); recovered %zu updates\n",
+			in_path, in_capture.frames.length());
+	}
+	return true;
+}
+
+inline const u8* live_link_capture_frame_data(const LiveLinkCapture& in_capture, const LiveLinkCaptureIndexEntry& in_entry)
+{
+	return in_capture.data + in_entry.frame_offset;
+}
+
+// ---- Replay ----
+
+struct LiveLinkReplay
+{
+	LiveLinkCapture capture;
+	bool max_speed = false;		// back to back instead of at recorded times
+	bool started = false;
+	bool finished = false;
+	u64 next_frame_index = 0;
+	std::chrono::steady_clock::time_point start_time;
+
+	// Timings, handed to the benchmark when the replay finishes
+	u64 byte_count = 0;
+	f64 wall_seconds = 0.0;
+	DynamicArray<f64> parse_ms;
+	DynamicArray<f64> drain_ms;
+};
+
+// Next captured frame that is due in_elapsed_ns after the replay started.
+// Recorded times count from the first frame, so idle time before Blender
+// connected is not replayed.
+inline const LiveLinkCaptureIndexEntry* live_link_replay_next_due(LiveLinkReplay& in_replay, u64 in_elapsed_ns)
+{
+	const DynamicArray<LiveLinkCaptureIndexEntry>& frames = in_replay.capture.frames;
+	if (in_replay.next_frame_index >= frames.length())
+	{
+		return nullptr;
+	}
+	const LiveLinkCaptureIndexEntry& entry = frames[in_replay.next_frame_index];
+	const u64 due_ns = entry.timestamp_ns - MIN(entry.timestamp_ns, frames[0].timestamp_ns);
+	if (!in_replay.max_speed && due_ns > in_elapsed_ns)
+	{
+		return nullptr;
+	}
+	in_replay.next_frame_index += 1;
+	return &entry;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "ankerl/unordered_dense.h"
+#include "blender_live_link_generated.h"
+#include "core/dynamic_array.h"
+#include "live_link/live_link_framing.h"
+
+// ---- Live link chunked transfers ----
+// Large Updates may travel as a transfer: a run of chunk frames, each a
+// size-prefixed Update that carries only Update.chunk (PayloadChunk). The
+// chunk data, placed at each chunk's offset, rebuilds the original
+// size-prefixed Update. The assembler allocates that buffer once, at its
+// final size, when a transfer's first chunk arrives and copies every chunk
+// straight into place, so the receive ring stays at chunk size and the
+// Update is never held twice. The completed Update is parsed exactly like
+// one that arrived as a single frame.
+//
+// The add-on also splits large exports into several self-contained Updates,
+// so each part's objects are published as soon as its last chunk lands
+// instead of after the whole scene.
+
+enum class ELiveLinkChunkStatus : i32
+{
+	Pending = 0,	// chunk stored, its transfer is still incomplete
+	Complete,		// last chunk stored, the assembled Update was handed out
+	Duplicate,		// chunk_index was already received; ignored
+	Malformed,		// header or slice inconsistent with its transfer; transfer dropped
+};
+
+struct LiveLinkChunkTransfer
+{
+	u8* data = nullptr;			// malloc'd, total_size bytes
+	u64 total_size = 0;
+	u64 received_byte_count = 0;
+	u32 chunk_count = 0;
+	u32 received_chunk_count = 0;
+	DynamicArray<u8> received_chunks;	// 1 per received chunk_index
+	std::chrono::steady_clock::time_point first_chunk_time;
+};
+
+// A completed transfer. data is malloc'd and owned by the receiver.
+struct LiveLinkAssembledUpdate
+{
+	u8* data = nullptr;
+	size_t size = 0;
+	u32 chunk_count = 0;
+	f64 transfer_seconds = 0.0;	// first chunk received -> last chunk received
+};
+
+struct LiveLinkChunkAssembler
+{
+	ankerl::unordered_dense::map<u32, LiveLinkChunkTransfer> transfers;
+
+	// Bytes allocated by incomplete transfers, and the most ever allocated
+	u64 buffered_byte_count = 0;
+	u64 peak_buffered_byte_count = 0;
+
+	u64 chunk_count = 0;
+	u64 completed_transfer_count = 0;
+	u64 dropped_transfer_count = 0;
+};
+
+inline void live_link_chunk_assembler_drop(LiveLinkChunkAssembler& in_assembler, u32 in_transfer_id)
+{
+	auto found = in_assembler.transfers.find(in_transfer_id);
+	if (found == in_assembler.transfers.end())
+	{
+		return;
+	}
+	in_assembler.buffered_byte_count -= found->second.total_size;
+	free(found->second.data);
+	in_assembler.transfers.erase(found);
+	in_assembler.dropped_transfer_count += 1;
+}
+
+// Frees every incomplete transfer (e.g. after the sender reconnected)
+inline void live_link_chunk_assembler_reset(LiveLinkChunkAssembler& in_assembler)
+{
+	for (auto& [transfer_id, transfer] : in_assembler.transfers)
+	{
+		free(transfer.data);
+		in_assembler.dropped_transfer_count += 1;
+	}
+	in_assembler.transfers.clear();
+	in_assembler.buffered_byte_count = 0;
+}
+
+// Copies one chunk into its transfer. On Complete, out_update owns the
+// assembled size-prefixed Update and the transfer is forgotten.
+inline ELiveLinkChunkStatus live_link_chunk_assembler_add(
+	LiveLinkChunkAssembler& in_assembler,
+	const Blender::LiveLink::PayloadChunk* in_chunk,
+	LiveLinkAssembledUpdate& out_update)
+{
+	const u32 transfer_id = in_chunk->transfer_id();
+	const u32 chunk_index = in_chunk->chunk_index();
+	const u32 chunk_count = in_chunk->chunk_count();
+	const u64 offset = in_chunk->offset();
+	const u64 total_size = in_chunk->total_size();
+	auto chunk_data = in_chunk->data();
+	const u64 chunk_size = chunk_data ? chunk_data->size() : 0;
+	in_assembler.chunk_count += 1;
+
+	const bool header_valid =
+		chunk_count > 0 &&
+		chunk_index < chunk_count &&
+		total_size > LIVE_LINK_FRAME_PREFIX_BYTES &&
+		total_size - LIVE_LINK_FRAME_PREFIX_BYTES <= LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES &&
+		offset <= total_size &&
+		chunk_size <= total_size - offset;
+	if (!header_valid)
+	{
+		printf("live link: malformed chunk %u/%u of transfer %u (offset %llu + %llu of %llu bytes)\n",
+			chunk_index, chunk_count, transfer_id,
+			(unsigned long long) offset, (unsigned long long) chunk_size, (unsigned long long) total_size);
+		live_link_chunk_assembler_drop(in_assembler, transfer_id);
+		return ELiveLinkChunkStatus::Malformed;
+	}
+
+	auto found = in_assembler.transfers.find(transfer_id);
+	if (found == in_assembler.transfers.end())
+	{
+		LiveLinkChunkTransfer new_transfer = {
+			.data = (u8*) malloc(total_size),
+			.total_size = total_size,
+			.chunk_count = chunk_count,
+			.first_chunk_time = std::chrono::steady_clock::now(),
+		};
+		new_transfer.received_chunks.resize(chunk_count, 0);
+		found = in_assembler.transfers.emplace(transfer_id, std::move(new_transfer)).first;
+		in_assembler.buffered_byte_count += total_size;
+		in_assembler.peak_buffered_byte_count = MAX(in_assembler.peak_buffered_byte_count, in_assembler.buffered_byte_count);
+	}
+
+	LiveLinkChunkTransfer& transfer = found->second;
+	if (transfer.total_size != total_size || transfer.chunk_count != chunk_count)
+	{
+		printf("live link: chunk %u of transfer %u disagrees with its transfer (%u chunks, %llu bytes)\n",
+			chunk_index, transfer_id, transfer.chunk_count, (unsigned long long) transfer.total_size);
+		live_link_chunk_assembler_drop(in_assembler, transfer_id);
+		return ELiveLinkChunkStatus::Malformed;
+	}
+	if (transfer.received_chunks[chunk_index])
+	{
+		return ELiveLinkChunkStatus::Duplicate;
+	}
+
+	if (chunk_size > 0)
+	{
+		memcpy(transfer.data + offset, chunk_data->data(), chunk_size);
+	}
+	transfer.received_chunks[chunk_index] = 1;
+	transfer.received_chunk_count += 1;
+	transfer.received_byte_count += chunk_size;
+	if (transfer.received_chunk_count < transfer.chunk_count)
+	{
+		return ELiveLinkChunkStatus::Pending;
+	}
+
+	// Every chunk is in: the slices must have tiled the buffer exactly and
+	// rebuilt a frame whose prefix matches its size
+	const u8* prefix = transfer.data;
+	const u64 prefixed_payload_size = (u64) prefix[0]
+		| ((u64) prefix[1] << 8)
+		| ((u64) prefix[2] << 16)
+		| ((u64) prefix[3] << 24);
+	if (transfer.received_byte_count != transfer.total_size ||
+		prefixed_payload_size + LIVE_LINK_FRAME_PREFIX_BYTES != transfer.total_size)
+	{
+		printf("live link: transfer %u assembled %llu of %llu bytes with prefix %llu; dropping\n",
+			transfer_id, (unsigned long long) transfer.received_byte_count,
+			(unsigned long long) transfer.total_size, (unsigned long long) prefixed_payload_size);
+		live_link_chunk_assembler_drop(in_assembler, transfer_id);
+		return ELiveLinkChunkStatus::Malformed;
+	}
+
+	out_update = {
+		.data = transfer.data,
+		.size = (size_t) transfer.total_size,
+		.chunk_count = transfer.chunk_count,
+		.transfer_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - transfer.first_chunk_time).count(),
+	};
+	in_assembler.buffered_byte_count -= transfer.total_size;
+	in_assembler.completed_transfer_count += 1;
+	in_assembler.transfers.erase(found);
+	return ELiveLinkChunkStatus::Complete;
+}
+
+// An Update ready to parse: either the received frame itself (borrowed, as
+// with LiveLinkFrame) or a just-completed transfer (assembled.data owned).
+struct LiveLinkRoutedUpdate
+{
+	const u8* data = nullptr;
+	size_t size = 0;
+	LiveLinkAssembledUpdate assembled;
+};
+
+// Sorts one received frame. Plain Updates are returned as they are; chunk
+// frames are stored, and the frame that completes a transfer returns the
+// assembled Update. Returns false when there is nothing to parse yet.
+inline bool live_link_route_frame(
+	LiveLinkChunkAssembler& in_assembler,
+	const u8* in_frame,
+	size_t in_size,
+	LiveLinkRoutedUpdate& out_update)
+{
+	out_update = {};
+	if (in_size < LIVE_LINK_FRAME_PREFIX_BYTES)
+	{
+		return false;
+	}
+
+	auto* update = Blender::LiveLink::GetSizePrefixedUpdate(in_frame);
+	auto* chunk = update->chunk();
+	if (!chunk)
+	{
+		out_update.data = in_frame;
+		out_update.size = in_size;
+		return true;
+	}
+
+	if (live_link_chunk_assembler_add(in_assembler, chunk, out_update.assembled) != ELiveLinkChunkStatus::Complete)
+	{
+		return false;
+	}
+	out_update.data = out_update.assembled.data;
+	out_update.size = out_update.assembled.size;
+	return true;
+}
+
+// Frees the assembled buffer of a routed transfer (no-op for plain frames)
+inline void live_link_routed_update_release(LiveLinkRoutedUpdate& in_update)
+{
+	free(in_update.assembled.data);
+	in_update = {};
+}
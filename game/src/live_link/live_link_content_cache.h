@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+
+#include "ankerl/unordered_dense.h"
+#include "core/content_hash.h"
+#include "game_object/mesh.h"
+
+// ---- Live link content cache ----
+// Decoded mesh streams keyed by content hash (the exporter's wire hash when
+// it sent one, otherwise content_hash_64 of the decoded streams). Objects
+// whose meshes hash the same share one MeshSharedStreams entry and its GPU
+// buffers. Entries no object references any more stay cached so a
+// re-export of the same geometry (undo, duplicate, re-link) is a hit; they
+// are evicted least-recently-used once their bytes exceed the budget.
+// Main thread only. Images are deduplicated separately via
+// state.images.hash_to_index.
+
+// Unreferenced mesh bytes kept alive between batches
+static constexpr u64 LIVE_LINK_CONTENT_CACHE_UNUSED_BUDGET_BYTES = 256ull * 1024 * 1024;
+
+struct LiveLinkContentCache
+{
+	ankerl::unordered_dense::map<u64, MeshSharedStreams*> meshes;
+	u64 use_counter = 0;
+	ContentCacheCounters counters;
+};
+
+// Replaces a freshly decoded mesh's streams with the cached copy of the same
+// content, or turns them into the new cache entry. Returns true on a hit.
+bool live_link_content_cache_share_mesh(LiveLinkContentCache& in_cache, Mesh& in_mesh, u64 in_content_hash)
+{
+	in_cache.use_counter += 1;
+	auto found = in_cache.meshes.find(in_content_hash);
+	if (found != in_cache.meshes.end())
+	{
+		mesh_free_owned_streams(in_mesh);
+		mesh_attach_shared_streams(in_mesh, *found->second);
+		found->second->last_used = in_cache.use_counter;
+		in_cache.counters.mesh_hits += 1;
+		return true;
+	}
+
+	MeshSharedStreams* shared = mesh_share_streams(in_mesh, in_content_hash);
+	shared->last_used = in_cache.use_counter;
+	in_cache.meshes[in_content_hash] = shared;
+	in_cache.counters.mesh_misses += 1;
+	return false;
+}
+
+// Attaches the cached streams for a hash-only mesh reference. Returns false
+// (counted as a miss) when the runtime no longer has that content.
+bool live_link_content_cache_attach_mesh(LiveLinkContentCache& in_cache, Mesh& in_mesh, u64 in_content_hash)
+{
+	in_cache.use_counter += 1;
+	auto found = in_cache.meshes.find(in_content_hash);
+	if (found == in_cache.meshes.end())
+	{
+		in_cache.counters.mesh_misses += 1;
+		return false;
+	}
+
+	mesh_attach_shared_streams(in_mesh, *found->second);
+	found->second->last_used = in_cache.use_counter;
+	in_cache.counters.mesh_hits += 1;
+	return true;
+}
+
+// Destroys unreferenced entries, least recently used first, until their
+// bytes fit in_budget_bytes. Run between batches, never while a batch is
+// still attaching (a hash the exporter references must survive its batch).
+void live_link_content_cache_trim(LiveLinkContentCache& in_cache, u64 in_budget_bytes)
+{
+	u64 unused_bytes = 0;
+	DynamicArray<MeshSharedStreams*> unused;
+	for (const auto& [content_hash, shared] : in_cache.meshes)
+	{
+		if (shared->ref_count == 0)
+		{
+			unused_bytes += shared->byte_count;
+			unused.add(shared);
+		}
+	}
+	if (unused_bytes <= in_budget_bytes)
+	{
+		return;
+	}
+
+	std::sort(unused.begin(), unused.end(), [](const MeshSharedStreams* in_a, const MeshSharedStreams* in_b) {
+		return in_a->last_used < in_b->last_used;
+	});
+	for (MeshSharedStreams* shared : unused)
+	{
+		if (unused_bytes <= in_budget_bytes)
+		{
+			break;
+		}
+		unused_bytes -= shared->byte_count;
+		in_cache.meshes.erase(shared->content_hash);
+		mesh_shared_streams_destroy(shared);
+		in_cache.counters.mesh_evictions += 1;
+	}
+}
+
+// Drops every entry (scene reset / shutdown). Objects must already be gone.
+void live_link_content_cache_clear(LiveLinkContentCache& in_cache)
+{
+	for (const auto& [content_hash, shared] : in_cache.meshes)
+	{
+		mesh_shared_streams_destroy(shared);
+	}
+	in_cache.meshes.clear();
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/dynamic_array.h"
+#include "network/socket_wrapper.h"
+
+// ---- Live link framing ----
+// Blender sends a stream of size-prefixed flatbuffer Updates: a little-endian
+// u32 payload length followed by the payload. One recv may contain several
+// frames, a fraction of one, or the tail of one and the head of the next.
+//
+// LiveLinkReceiveRing owns one reusable buffer. Each recv reads as large a
+// slice as fits straight into the unused tail, complete frames are handed out
+// in place (prefix included, so GetSizePrefixedUpdate works on them directly),
+// and only the bytes of a trailing partial frame are ever moved. Once a frame
+// prefix is known the buffer is grown so the whole frame lands contiguously.
+
+static constexpr size_t LIVE_LINK_FRAME_PREFIX_BYTES = sizeof(u32);
+static constexpr size_t LIVE_LINK_RECEIVE_RING_INITIAL_CAPACITY = 4 * 1024 * 1024;
+
+// Flatbuffers caps buffers at 2^31 - 1 bytes; anything larger is a desync.
+static constexpr u64 LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES = 0x7FFFFFFFull;
+
+enum class ELiveLinkReceiveStatus : i32
+{
+	Data = 0,		// bytes were appended; call next_frame until it returns false
+	WouldBlock,		// timeout / EAGAIN, nothing read
+	Closed,			// peer performed an orderly shutdown
+	Error,			// socket error, see socket_get_last_error
+	Malformed,		// frame prefix exceeds LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES
+};
+
+// A complete frame inside the ring. Valid until the next receive() call.
+struct LiveLinkFrame
+{
+	const u8* data = nullptr;	// points at the size prefix
+	size_t size = 0;			// prefix + payload bytes
+};
+
+struct LiveLinkReceiveRing
+{
+	DynamicArray<u8> storage;
+	size_t read_offset = 0;
+	size_t write_offset = 0;
+
+	// Counters surfaced by the thread log and used by the framing tests
+	u64 recv_count = 0;
+	u64 frame_count = 0;
+	u64 grow_count = 0;
+	u64 compacted_byte_count = 0;
+
+	LiveLinkReceiveRing() = default;
+	LiveLinkReceiveRing(const LiveLinkReceiveRing&) = delete;
+	LiveLinkReceiveRing& operator=(const LiveLinkReceiveRing&) = delete;
+
+	void init(size_t in_capacity = LIVE_LINK_RECEIVE_RING_INITIAL_CAPACITY)
+	{
+		reset();
+		ensure_capacity(MAX(in_capacity, LIVE_LINK_FRAME_PREFIX_BYTES));
+	}
+
+	// Drops buffered bytes (e.g. after a reconnect) but keeps the allocation
+	void reset()
+	{
+		read_offset = 0;
+		write_offset = 0;
+	}
+
+	size_t capacity() const { return storage.length(); }
+	size_t buffered_byte_count() const { return write_offset - read_offset; }
+
+	// Appends bytes without a socket. Used by the file loader and tests; the
+	// socket path goes through receive() so data is never staged twice.
+	ELiveLinkReceiveStatus append(const u8* in_data, size_t in_size)
+	{
+		while (in_size > 0)
+		{
+			if (!prepare_tail())
+			{
+				return ELiveLinkReceiveStatus::Malformed;
+			}
+			const size_t copy_size = MIN(in_size, capacity() - write_offset);
+			memcpy(storage.data() + write_offset, in_data, copy_size);
+			write_offset += copy_size;
+			in_data += copy_size;
+			in_size -= copy_size;
+		}
+		return ELiveLinkReceiveStatus::Data;
+	}
+
+	// Performs one recv directly into the free tail of the ring, reading at
+	// most in_max_bytes
+	ELiveLinkReceiveStatus receive(SOCKET in_socket, size_t in_max_bytes = SIZE_MAX)
+	{
+		if (!prepare_tail())
+		{
+			return ELiveLinkReceiveStatus::Malformed;
+		}
+
+		const i64 bytes_read = socket_recv(
+			in_socket, storage.data() + write_offset, MIN(capacity() - write_offset, MAX(in_max_bytes, (size_t) 1)), 0);
+		if (bytes_read < 0)
+		{
+			const int last_error = socket_get_last_error();
+			if (	last_error == socket_error_again()
+				||	last_error == socket_error_would_block()
+				||	last_error == socket_error_timed_out())
+			{
+				return ELiveLinkReceiveStatus::WouldBlock;
+			}
+			return ELiveLinkReceiveStatus::Error;
+		}
+		if (bytes_read == 0)
+		{
+			return ELiveLinkReceiveStatus::Closed;
+		}
+
+		++recv_count;
+		write_offset += (size_t) bytes_read;
+		return ELiveLinkReceiveStatus::Data;
+	}
+
+	// Pops the next complete frame, if any. Returned memory stays valid until
+	// the next receive()/append() call.
+	bool next_frame(LiveLinkFrame& out_frame)
+	{
+		const size_t buffered = buffered_byte_count();
+		if (buffered < LIVE_LINK_FRAME_PREFIX_BYTES)
+		{
+			return false;
+		}
+
+		const u64 payload_size = peek_payload_size();
+		if (payload_size > LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES)
+		{
+			return false;
+		}
+
+		const size_t frame_size = LIVE_LINK_FRAME_PREFIX_BYTES + (size_t) payload_size;
+		if (buffered < frame_size)
+		{
+			return false;
+		}
+
+		out_frame = {
+			.data = storage.data() + read_offset,
+			.size = frame_size,
+		};
+		read_offset += frame_size;
+		++frame_count;
+		return true;
+	}
+
+	// Bytes of the frame at read_offset that have not arrived yet (0 when the
+	// prefix itself is still incomplete or the frame is already complete)
+	size_t pending_frame_byte_count() const
+	{
+		const size_t buffered = buffered_byte_count();
+		if (buffered < LIVE_LINK_FRAME_PREFIX_BYTES)
+		{
+			return 0;
+		}
+		const u64 frame_size = LIVE_LINK_FRAME_PREFIX_BYTES + peek_payload_size();
+		return frame_size > buffered ? (size_t) (frame_size - buffered) : 0;
+	}
+
+private:
+	u64 peek_payload_size() const
+	{
+		const u8* prefix = storage.data() + read_offset;
+		return (u64) prefix[0]
+			| ((u64) prefix[1] << 8)
+			| ((u64) prefix[2] << 16)
+			| ((u64) prefix[3] << 24);
+	}
+
+	void ensure_capacity(size_t in_required_capacity)
+	{
+		if (in_required_capacity <= capacity())
+		{
+			return;
+		}
+
+		size_t new_capacity = MAX(capacity(), LIVE_LINK_FRAME_PREFIX_BYTES);
+		while (new_capacity < in_required_capacity)
+		{
+			new_capacity *= 2;
+		}
+		storage.resize(new_capacity);
+		++grow_count;
+	}
+
+	// Moves the unconsumed partial frame (if any) to the front of the buffer
+	void compact()
+	{
+		const size_t buffered = buffered_byte_count();
+		if (read_offset > 0 && buffered > 0)
+		{
+			memmove(storage.data(), storage.data() + read_offset, buffered);
+			compacted_byte_count += buffered;
+		}
+		read_offset = 0;
+		write_offset = buffered;
+	}
+
+	// Guarantees free tail space for the next read. When the current frame's
+	// size is known, the ring is sized and compacted so that frame's bytes can
+	// all be received in place.
+	bool prepare_tail()
+	{
+		if (read_offset == write_offset)
+		{
+			read_offset = 0;
+			write_offset = 0;
+		}
+
+		size_t required_frame_size = LIVE_LINK_FRAME_PREFIX_BYTES;
+		if (buffered_byte_count() >= LIVE_LINK_FRAME_PREFIX_BYTES)
+		{
+			const u64 payload_size = peek_payload_size();
+			if (payload_size > LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES)
+			{
+				return false;
+			}
+			required_frame_size = LIVE_LINK_FRAME_PREFIX_BYTES + (size_t) payload_size;
+		}
+
+		if (read_offset + required_frame_size > capacity() || write_offset == capacity())
+		{
+			compact();
+		}
+		ensure_capacity(MAX(required_frame_size, write_offset + 1));
+		return true;
+	}
+};
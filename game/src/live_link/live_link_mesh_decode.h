@@ -0,0 +1,415 @@
+#pragma once
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "blender_live_link_generated.h"
+#include "core/content_hash.h"
+#include "core/dynamic_array.h"
+#include "core/shared_arena.h"
+#include "core/types.h"
+#include "core/worker_pool.h"
+#include "render/vertex_quantization.h"
+#include "render/vertex_types.h"
+
+// ---- Live link mesh decode ----
+// Mesh payloads are decoded in two steps on the live-link thread:
+//  1. plan (serial, in wire order): validate the streams, log/drop malformed
+//     ones exactly as before, and reserve every output array of the update in
+//     one SharedArena layout;
+//  2. run (WorkerPool): each mesh expands its flatbuffer arrays straight into
+//     its reserved arena ranges with bulk reads of the raw vector storage.
+// Output is byte-identical to the original per-element Get() decode, which
+// tests/live_link_mesh_decode_tests.cpp keeps as its reference.
+// Each job also hashes its decoded streams (live_link_mesh_content_hash) so
+// the drain can share identical geometry through the content cache.
+// Quantized payloads (Mesh.quantized_positions/oct_normals/half_texcoords,
+// Mesh.indices16) are dequantized into the same Vertex/u32 streams; unskinned
+// ones also keep their CompactVertex (and 16-bit index) copy for the GPU.
+
+static_assert(FLATBUFFERS_LITTLEENDIAN, "bulk mesh decode reads flatbuffer vectors in place");
+
+// Decoded mesh streams. Arrays point into storage_arena, or into separate
+// malloc'd blocks for the reference path (storage_arena == nullptr).
+struct LiveLinkDecodedMesh
+{
+	SharedArena* storage_arena = nullptr;
+
+	u32 num_vertices = 0;
+	Vertex* vertices = nullptr;
+
+	SkinnedVertex* skinned_vertices = nullptr;
+	u32 skin_matrix_count = 0;
+
+	u32 num_indices = 0;
+	u32* indices = nullptr;
+
+	u32 num_material_indices = 0;
+	i32* material_indices = nullptr;
+
+	i32 armature_id = -1;
+
+	// GPU copies for meshes that arrived quantized and unskinned;
+	// compact_indices only when num_vertices fits 16-bit indices
+	CompactVertex* compact_vertices = nullptr;
+	u16* compact_indices = nullptr;
+	VertexQuantization quantization;
+
+	// Key for the content cache: the exporter's Mesh.content_hash when sent,
+	// otherwise live_link_mesh_content_hash of the streams above
+	u64 content_hash = 0;
+};
+
+// Hashes the streams a MeshSharedStreams entry holds (material ids and the
+// armature binding stay per object, so they are not part of the key)
+u64 live_link_mesh_content_hash(const LiveLinkDecodedMesh& in_mesh)
+{
+	u64 hash = content_hash_64(in_mesh.vertices, sizeof(Vertex) * in_mesh.num_vertices);
+	hash = content_hash_64(in_mesh.indices, sizeof(u32) * in_mesh.num_indices, hash);
+	if (in_mesh.skinned_vertices)
+	{
+		hash = content_hash_64(in_mesh.skinned_vertices, sizeof(SkinnedVertex) * in_mesh.num_vertices, hash);
+	}
+	if (in_mesh.compact_vertices)
+	{
+		hash = content_hash_64(in_mesh.compact_vertices, sizeof(CompactVertex) * in_mesh.num_vertices, hash);
+	}
+	if (in_mesh.compact_indices)
+	{
+		hash = content_hash_64(in_mesh.compact_indices, sizeof(u16) * in_mesh.num_indices, hash);
+	}
+	return hash;
+}
+
+// A mesh sent as Mesh.content_hash without vertex streams: geometry the
+// runtime already holds in its content cache
+inline bool live_link_mesh_is_content_reference(const Blender::LiveLink::Mesh* in_mesh)
+{
+	return in_mesh->content_hash() != 0 && !in_mesh->positions() && !in_mesh->quantized_positions();
+}
+
+// Float streams win when both encodings are present
+inline bool live_link_mesh_has_quantized_vertex_streams(const Blender::LiveLink::Mesh* in_mesh)
+{
+	auto quantized_positions = in_mesh->quantized_positions();
+	auto oct_normals = in_mesh->oct_normals();
+	auto half_texcoords = in_mesh->half_texcoords();
+	return !in_mesh->positions() &&
+		quantized_positions &&
+		oct_normals &&
+		half_texcoords &&
+		in_mesh->position_min() &&
+		in_mesh->position_extent() &&
+		(quantized_positions->size() % 3) == 0 &&
+		oct_normals->size() >= (quantized_positions->size() / 3) * 2 &&
+		half_texcoords->size() >= (quantized_positions->size() / 3) * 2;
+}
+
+inline VertexQuantization live_link_mesh_quantization(const Blender::LiveLink::Mesh* in_mesh)
+{
+	const Blender::LiveLink::Vec3* position_min = in_mesh->position_min();
+	const Blender::LiveLink::Vec3* position_extent = in_mesh->position_extent();
+	return (VertexQuantization) {
+		.position_min = HMM_V3(position_min->x(), position_min->y(), position_min->z()),
+		.position_extent = HMM_V3(position_extent->x(), position_extent->y(), position_extent->z()),
+	};
+}
+
+// Unskinned quantized meshes keep their compact vertices for the GPU
+inline bool live_link_mesh_keeps_compact_streams(bool in_has_quantized_vertices, bool in_has_skinning)
+{
+	return in_has_quantized_vertices && !in_has_skinning;
+}
+
+struct LiveLinkMeshDecodeJob
+{
+	const Blender::LiveLink::Mesh* source = nullptr;
+	i32 unique_id = 0;
+
+	// Caller-owned slot the decoded mesh belongs to (object index in the update)
+	u32 output_index = 0;
+
+	u32 num_vertices = 0;
+	u32 num_indices = 0;
+	u32 num_material_indices = 0;
+	bool has_skinning = false;
+	bool has_quantized_vertices = false;
+	bool has_indices16 = false;
+	bool has_compact_vertices = false;
+	bool has_compact_indices = false;
+
+	size_t vertices_offset = 0;
+	size_t skinned_vertices_offset = 0;
+	size_t indices_offset = 0;
+	size_t material_indices_offset = 0;
+	size_t compact_vertices_offset = 0;
+	size_t compact_indices_offset = 0;
+};
+
+// Per-update decode plan. Reused across updates by the live-link thread.
+struct LiveLinkMeshDecodeStage
+{
+	DynamicArray<LiveLinkMeshDecodeJob> jobs;
+	size_t arena_size = 0;
+
+	void clear()
+	{
+		jobs.clear();
+		arena_size = 0;
+	}
+};
+
+using LiveLinkMeshDecodedFunction = std::function<void(const LiveLinkMeshDecodeJob&, const LiveLinkDecodedMesh&)>;
+
+// Validates one mesh and reserves its arena ranges. Returns false (and logs)
+// when the mesh would be dropped; the log lines match the reference path.
+bool live_link_mesh_decode_plan(
+	LiveLinkMeshDecodeStage& in_stage,
+	const Blender::LiveLink::Mesh* in_mesh,
+	i32 in_unique_id,
+	u32 in_output_index)
+{
+	assert(in_mesh);
+	LiveLinkMeshDecodeJob job = {
+		.source = in_mesh,
+		.unique_id = in_unique_id,
+		.output_index = in_output_index,
+	};
+
+	auto flatbuffer_positions = in_mesh->positions();
+	auto flatbuffer_normals = in_mesh->normals();
+	auto flatbuffer_texcoords = in_mesh->texcoords();
+	const bool has_valid_vertex_streams =
+		flatbuffer_positions &&
+		flatbuffer_normals &&
+		flatbuffer_texcoords &&
+		(flatbuffer_positions->size() % 3) == 0 &&
+		flatbuffer_normals->size() >= flatbuffer_positions->size() &&
+		flatbuffer_texcoords->size() >= (flatbuffer_positions->size() / 3) * 2;
+	if (has_valid_vertex_streams)
+	{
+		job.num_vertices = flatbuffer_positions->size() / 3;
+	}
+	else if (live_link_mesh_has_quantized_vertex_streams(in_mesh))
+	{
+		job.num_vertices = in_mesh->quantized_positions()->size() / 3;
+		job.has_quantized_vertices = true;
+	}
+	else
+	{
+		printf("\tDropping malformed mesh vertex streams on object UID: %i\n", in_unique_id);
+	}
+
+	auto flatbuffer_joint_indices = in_mesh->joint_indices();
+	auto flatbuffer_joint_weights = in_mesh->joint_weights();
+	if (in_mesh->armature_id() > 0 && flatbuffer_joint_indices && flatbuffer_joint_weights)
+	{
+		const u32 num_joint_indices = flatbuffer_joint_indices->size();
+		const u32 num_joint_weights = flatbuffer_joint_weights->size();
+		if (job.num_vertices == 0 ||
+			num_joint_indices != num_joint_weights ||
+			(num_joint_indices % 4) != 0 ||
+			job.num_vertices != num_joint_indices / 4)
+		{
+			printf("\tDropping malformed skinning data on object UID: %i\n", in_unique_id);
+		}
+		else
+		{
+			job.has_skinning = true;
+		}
+	}
+
+	auto flatbuffer_indices = in_mesh->indices();
+	auto flatbuffer_indices16 = in_mesh->indices16();
+	const u32 num_source_indices = flatbuffer_indices ? flatbuffer_indices->size() : (flatbuffer_indices16 ? flatbuffer_indices16->size() : 0);
+	if ((num_source_indices % 3) != 0)
+	{
+		printf("\tDropping malformed triangle index stream on object UID: %i\n", in_unique_id);
+	}
+	else
+	{
+		job.num_indices = num_source_indices;
+		job.has_indices16 = !flatbuffer_indices && flatbuffer_indices16;
+	}
+
+	if (auto flatbuffer_material_ids = in_mesh->material_ids())
+	{
+		job.num_material_indices = flatbuffer_material_ids->size();
+	}
+
+	if (job.num_vertices == 0 || job.num_indices == 0)
+	{
+		return false;
+	}
+
+	job.has_compact_vertices = live_link_mesh_keeps_compact_streams(job.has_quantized_vertices, job.has_skinning);
+	job.has_compact_indices = job.has_compact_vertices && job.num_vertices <= COMPACT_INDEX_MAX_VERTEX_COUNT;
+
+	size_t& arena_size = in_stage.arena_size;
+	job.vertices_offset = shared_arena_plan(arena_size, sizeof(Vertex) * job.num_vertices);
+	if (job.has_skinning)
+	{
+		job.skinned_vertices_offset = shared_arena_plan(arena_size, sizeof(SkinnedVertex) * job.num_vertices);
+	}
+	job.indices_offset = shared_arena_plan(arena_size, sizeof(u32) * job.num_indices);
+	if (job.num_material_indices > 0)
+	{
+		job.material_indices_offset = shared_arena_plan(arena_size, sizeof(i32) * job.num_material_indices);
+	}
+	if (job.has_compact_vertices)
+	{
+		job.compact_vertices_offset = shared_arena_plan(arena_size, sizeof(CompactVertex) * job.num_vertices);
+	}
+	if (job.has_compact_indices)
+	{
+		job.compact_indices_offset = shared_arena_plan(arena_size, sizeof(u16) * job.num_indices);
+	}
+
+	in_stage.jobs.add(job);
+	return true;
+}
+
+// Expands one planned mesh into its arena ranges
+void live_link_mesh_decode_job(const LiveLinkMeshDecodeJob& in_job, SharedArena* in_arena, LiveLinkDecodedMesh& out_mesh)
+{
+	const Blender::LiveLink::Mesh* mesh = in_job.source;
+	const u32 num_vertices = in_job.num_vertices;
+
+	out_mesh = {
+		.storage_arena = in_arena,
+		.num_vertices = num_vertices,
+		.vertices = shared_arena_at<Vertex>(in_arena, in_job.vertices_offset),
+		.num_indices = in_job.num_indices,
+		.indices = shared_arena_at<u32>(in_arena, in_job.indices_offset),
+		.num_material_indices = in_job.num_material_indices,
+		.armature_id = mesh->armature_id(),
+	};
+
+	Vertex* vertices = out_mesh.vertices;
+	if (in_job.has_quantized_vertices)
+	{
+		const VertexQuantization quantization = live_link_mesh_quantization(mesh);
+		const u16* quantized_positions = mesh->quantized_positions()->data();
+		const i16* oct_normals = mesh->oct_normals()->data();
+		const u16* half_texcoords = mesh->half_texcoords()->data();
+		CompactVertex* compact_vertices = in_job.has_compact_vertices
+			? shared_arena_at<CompactVertex>(in_arena, in_job.compact_vertices_offset)
+			: nullptr;
+		for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+		{
+			const u16* position = quantized_positions + vertex_idx * 3;
+			const i16* normal = oct_normals + vertex_idx * 2;
+			const u16* texcoord = half_texcoords + vertex_idx * 2;
+			const CompactVertex compact_vertex = {
+				.position = { position[0], position[1], position[2], 0 },
+				.normal = { normal[0], normal[1] },
+				.texcoord = { texcoord[0], texcoord[1] },
+			};
+			vertices[vertex_idx] = vertex_dequantize(compact_vertex, quantization);
+			if (compact_vertices)
+			{
+				compact_vertices[vertex_idx] = compact_vertex;
+			}
+		}
+		if (compact_vertices)
+		{
+			out_mesh.compact_vertices = compact_vertices;
+			out_mesh.quantization = quantization;
+		}
+	}
+	else
+	{
+		const f32* positions = mesh->positions()->data();
+		const f32* normals = mesh->normals()->data();
+		const f32* texcoords = mesh->texcoords()->data();
+		for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+		{
+			const f32* position = positions + vertex_idx * 3;
+			const f32* normal = normals + vertex_idx * 3;
+			const f32* texcoord = texcoords + vertex_idx * 2;
+			vertices[vertex_idx] = {
+				.position = HMM_V4(position[0], position[1], position[2], 1.0f),
+				.normal = HMM_V4(normal[0], normal[1], normal[2], 0.0f),
+				.texcoord = HMM_V2(texcoord[0], texcoord[1]),
+			};
+		}
+	}
+
+	if (in_job.has_skinning)
+	{
+		const i32* joint_indices = mesh->joint_indices()->data();
+		const f32* joint_weights = mesh->joint_weights()->data();
+		SkinnedVertex* skinned_vertices = shared_arena_at<SkinnedVertex>(in_arena, in_job.skinned_vertices_offset);
+		i32 max_joint_index = 0;
+		for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+		{
+			const i32* joints = joint_indices + vertex_idx * 4;
+			const f32* weights = joint_weights + vertex_idx * 4;
+			max_joint_index = MAX(max_joint_index, MAX(MAX(joints[0], joints[1]), MAX(joints[2], joints[3])));
+			skinned_vertices[vertex_idx] = {
+				.joint_indices = HMM_V4((f32) joints[0], (f32) joints[1], (f32) joints[2], (f32) joints[3]),
+				.joint_weights = HMM_V4(weights[0], weights[1], weights[2], weights[3]),
+			};
+		}
+		out_mesh.skinned_vertices = skinned_vertices;
+		out_mesh.skin_matrix_count = (u32) max_joint_index + 1;
+	}
+
+	if (in_job.has_indices16)
+	{
+		const u16* indices16 = mesh->indices16()->data();
+		for (u32 index_idx = 0; index_idx < in_job.num_indices; ++index_idx)
+		{
+			out_mesh.indices[index_idx] = indices16[index_idx];
+		}
+	}
+	else
+	{
+		memcpy(out_mesh.indices, mesh->indices()->data(), sizeof(u32) * in_job.num_indices);
+	}
+
+	if (in_job.has_compact_indices)
+	{
+		out_mesh.compact_indices = shared_arena_at<u16>(in_arena, in_job.compact_indices_offset);
+		for (u32 index_idx = 0; index_idx < in_job.num_indices; ++index_idx)
+		{
+			out_mesh.compact_indices[index_idx] = (u16) out_mesh.indices[index_idx];
+		}
+	}
+
+	if (in_job.num_material_indices > 0)
+	{
+		out_mesh.material_indices = shared_arena_at<i32>(in_arena, in_job.material_indices_offset);
+		memcpy(out_mesh.material_indices, mesh->material_ids()->data(), sizeof(i32) * in_job.num_material_indices);
+	}
+
+	out_mesh.content_hash = mesh->content_hash() != 0 ? mesh->content_hash() : live_link_mesh_content_hash(out_mesh);
+}
+
+// Allocates the update arena and decodes every planned mesh on in_workers.
+// in_on_decoded runs on the worker that decoded the mesh, so it may only touch
+// the caller's in_job.output_index slot. Returns the arena holding one
+// reference for the caller (nullptr when nothing was planned); the caller
+// releases it once every consumer has taken its own reference.
+SharedArena* live_link_mesh_decode_run(
+	LiveLinkMeshDecodeStage& in_stage,
+	WorkerPool& in_workers,
+	const LiveLinkMeshDecodedFunction& in_on_decoded)
+{
+	if (in_stage.jobs.empty())
+	{
+		return nullptr;
+	}
+
+	SharedArena* arena = shared_arena_create(in_stage.arena_size);
+	in_workers.parallel_for((u32) in_stage.jobs.length(), [&](u32 in_job_index) {
+		const LiveLinkMeshDecodeJob& job = in_stage.jobs[in_job_index];
+		LiveLinkDecodedMesh decoded;
+		live_link_mesh_decode_job(job, arena, decoded);
+		in_on_decoded(job, decoded);
+	});
+	return arena;
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include "core/dynamic_array.h"
+#include "live_link/live_link_chunk_assembly.h"
+#include "live_link/live_link_framing.h"
+#include "network/socket_wrapper.h"
+
+// ---- Live link server ----
+// Event-driven listener for any number of senders (Blender, a restarted
+// Blender, test clients). One socket_poll per iteration covers the listener
+// and every connection; each connection owns its receive ring and chunk
+// assembler, so frames and transfers from different senders never mix. A
+// closed or misbehaving connection is dropped on its own and the listener
+// keeps accepting, so nothing here ever exits the process.
+//
+// Fairness and backpressure:
+//  - each ready connection reads at most read_budget_bytes per iteration
+//    before the next connection gets its turn, and the turn order rotates
+//    every iteration;
+//  - while the caller reports more than queue_budget_bytes of parsed but
+//    undrained updates (counting what this iteration already handed out),
+//    no further connection is read. The kernel buffers fill and TCP flow
+//    control stalls the senders until the main thread catches up.
+
+static constexpr u64 LIVE_LINK_SERVER_DEFAULT_READ_BUDGET_BYTES = 8ull * 1024 * 1024;
+static constexpr u64 LIVE_LINK_SERVER_DEFAULT_QUEUE_BUDGET_BYTES = 512ull * 1024 * 1024;
+
+struct LiveLinkServerConfig
+{
+	u64 read_budget_bytes = LIVE_LINK_SERVER_DEFAULT_READ_BUDGET_BYTES;	// per connection per poll
+	u64 queue_budget_bytes = LIVE_LINK_SERVER_DEFAULT_QUEUE_BUDGET_BYTES;
+	i32 max_connections = 16;
+	i32 poll_timeout_ms = 100;		// bounds how long shutdown waits
+	i32 backpressure_poll_ms = 5;	// re-check interval while paused
+};
+
+struct LiveLinkServerConnection
+{
+	SOCKET socket = INVALID_SOCKET;
+	u32 id = 0;
+	LiveLinkReceiveRing ring;
+	LiveLinkChunkAssembler chunk_assembler;
+	u64 received_byte_count = 0;
+	u64 update_count = 0;
+};
+
+// Counters for the thread log and the stress test
+struct LiveLinkServerCounters
+{
+	u64 accepted_count = 0;
+	u64 rejected_count = 0;		// over max_connections
+	u64 closed_count = 0;		// orderly shutdown by the sender
+	u64 dropped_count = 0;		// socket error or unframeable stream
+	u64 update_count = 0;
+	u64 budget_yield_count = 0;	// a connection still had data when its budget ran out
+	u64 backpressure_count = 0;	// times reading was paused for the queue budget
+};
+
+struct LiveLinkServer
+{
+	LiveLinkServerConfig config;
+	SOCKET listen_socket = INVALID_SOCKET;
+	DynamicArray<LiveLinkServerConnection*> connections;
+	DynamicArray<SocketPollFd> poll_fds;
+	DynamicArray<u32> drop_indices;
+	u32 next_connection_id = 1;
+	u32 read_cursor = 0;		// first connection read next iteration
+	bool backpressured = false;
+	LiveLinkServerCounters counters;
+
+	LiveLinkServer() = default;
+	LiveLinkServer(const LiveLinkServer&) = delete;
+	LiveLinkServer& operator=(const LiveLinkServer&) = delete;
+};
+
+// A complete Update from one connection. data is only valid during the callback.
+using LiveLinkServerUpdateFunction = std::function<void(const LiveLinkServerConnection&, const LiveLinkRoutedUpdate&)>;
+
+// Binds and listens on in_host:in_port ("0" picks a free port). Returns
+// false, with the reason logged, instead of exiting so the caller can retry.
+bool live_link_server_open(LiveLinkServer& in_server, const char* in_host, const char* in_port)
+{
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	struct addrinfo* res = nullptr;
+	const int getaddrinfo_result = getaddrinfo(in_host, in_port, &hints, &res);
+	if (getaddrinfo_result != 0 || res == nullptr)
+	{
+		printf("live link: getaddrinfo failed (%s)\n", gai_strerror(getaddrinfo_result));
+		return false;
+	}
+
+	SOCKET listen_socket = socket_open(res->ai_family, res->ai_socktype, res->ai_protocol);
+	if (!socket_is_valid(listen_socket))
+	{
+		printf("live link: socket failed: %i\n", socket_get_last_error());
+		freeaddrinfo(res);
+		return false;
+	}
+	if (!socket_set_reuse_addr_and_port(listen_socket, true))
+	{
+		printf("live link: address reuse unavailable: %i\n", socket_get_last_error());
+	}
+
+	if (bind(listen_socket, res->ai_addr, (socklen_t) res->ai_addrlen) != 0 ||
+		listen(listen_socket, in_server.config.max_connections) != 0)
+	{
+		printf("live link: bind/listen on %s:%s failed: %i\n", in_host, in_port, socket_get_last_error());
+		socket_close(listen_socket);
+		freeaddrinfo(res);
+		return false;
+	}
+	freeaddrinfo(res);
+
+	in_server.listen_socket = listen_socket;
+	return true;
+}
+
+// Port the listener is bound to (useful after opening port "0")
+i32 live_link_server_port(const LiveLinkServer& in_server)
+{
+	struct sockaddr_storage address;
+	socklen_t address_size = sizeof address;
+	if (getsockname(in_server.listen_socket, (struct sockaddr*) &address, &address_size) != 0)
+	{
+		return -1;
+	}
+	if (address.ss_family == AF_INET6)
+	{
+		return ntohs(((struct sockaddr_in6*) &address)->sin6_port);
+	}
+	return ntohs(((struct sockaddr_in*) &address)->sin_port);
+}
+
+void live_link_server_drop_connection(LiveLinkServer& in_server, u32 in_index)
+{
+	LiveLinkServerConnection* connection = in_server.connections[in_index];
+	socket_close(connection->socket);
+	live_link_chunk_assembler_reset(connection->chunk_assembler);
+	delete connection;
+	in_server.connections[in_index] = in_server.connections.last();
+	in_server.connections.pop();
+}
+
+void live_link_server_close(LiveLinkServer& in_server)
+{
+	while (!in_server.connections.empty())
+	{
+		live_link_server_drop_connection(in_server, (u32) in_server.connections.length() - 1);
+	}
+	if (socket_is_valid(in_server.listen_socket))
+	{
+		socket_close(in_server.listen_socket);
+		in_server.listen_socket = INVALID_SOCKET;
+	}
+}
+
+void live_link_server_accept(LiveLinkServer& in_server)
+{
+	for (;;)
+	{
+		SOCKET accepted = socket_accept(in_server.listen_socket);
+		if (!socket_is_valid(accepted))
+		{
+			return;
+		}
+		if ((i32) in_server.connections.length() >= in_server.config.max_connections)
+		{
+			printf("live link: rejecting connection, %i senders already connected\n", in_server.config.max_connections);
+			socket_close(accepted);
+			in_server.counters.rejected_count += 1;
+			continue;
+		}
+
+		LiveLinkServerConnection* connection = new LiveLinkServerConnection();
+		connection->socket = accepted;
+		connection->id = in_server.next_connection_id++;
+		connection->ring.init();
+		in_server.connections.add(connection);
+		in_server.counters.accepted_count += 1;
+		printf("live link: connection %u accepted (%zu connected)\n", connection->id, in_server.connections.length());
+	}
+}
+
+// Reads one connection up to its budget, handing out every complete Update
+// and adding their sizes to in_out_handed_out_bytes. Returns false when the
+// connection has to be dropped.
+bool live_link_server_read(
+	LiveLinkServer& in_server,
+	LiveLinkServerConnection& in_connection,
+	const LiveLinkServerUpdateFunction& in_on_update,
+	u64& in_out_handed_out_bytes)
+{
+	u64 read_byte_count = 0;
+	while (read_byte_count < in_server.config.read_budget_bytes)
+	{
+		const size_t buffered_before = in_connection.ring.buffered_byte_count();
+		const ELiveLinkReceiveStatus status = in_connection.ring.receive(
+			in_connection.socket, (size_t) (in_server.config.read_budget_bytes - read_byte_count));
+		switch (status)
+		{
+			case ELiveLinkReceiveStatus::Data:
+				break;
+			case ELiveLinkReceiveStatus::WouldBlock:
+				return true;
+			case ELiveLinkReceiveStatus::Closed:
+				printf("live link: connection %u closed after %llu updates\n",
+					in_connection.id, (unsigned long long) in_connection.update_count);
+				in_server.counters.closed_count += 1;
+				return false;
+			case ELiveLinkReceiveStatus::Malformed:
+				printf("live link: connection %u sent a frame prefix over %llu bytes; dropping it\n",
+					in_connection.id, (unsigned long long) LIVE_LINK_MAX_FRAME_PAYLOAD_BYTES);
+				in_server.counters.dropped_count += 1;
+				return false;
+			case ELiveLinkReceiveStatus::Error:
+			default:
+				printf("live link: connection %u recv error %i; dropping it\n", in_connection.id, socket_get_last_error());
+				in_server.counters.dropped_count += 1;
+				return false;
+		}
+
+		const u64 received = (u64) (in_connection.ring.buffered_byte_count() - buffered_before);
+		read_byte_count += received;
+		in_connection.received_byte_count += received;
+
+		// Frames live in the ring only until the next receive
+		LiveLinkFrame frame;
+		while (in_connection.ring.next_frame(frame))
+		{
+			LiveLinkRoutedUpdate routed_update;
+			if (!live_link_route_frame(in_connection.chunk_assembler, frame.data, frame.size, routed_update))
+			{
+				continue;	// chunk of a transfer that is still incomplete
+			}
+			in_connection.update_count += 1;
+			in_server.counters.update_count += 1;
+			in_out_handed_out_bytes += routed_update.size;
+			in_on_update(in_connection, routed_update);
+			live_link_routed_update_release(routed_update);
+		}
+	}
+
+	in_server.counters.budget_yield_count += 1;
+	return true;
+}
+
+// One server iteration: waits for activity (at most config.poll_timeout_ms),
+// accepts new senders and reads every ready connection within its budget.
+// in_queued_bytes is the size of parsed updates the consumer has not
+// drained yet; above config.queue_budget_bytes reads pause.
+void live_link_server_poll(LiveLinkServer& in_server, u64 in_queued_bytes, const LiveLinkServerUpdateFunction& in_on_update)
+{
+	const bool backpressured = in_queued_bytes > in_server.config.queue_budget_bytes;
+	if (backpressured != in_server.backpressured)
+	{
+		in_server.backpressured = backpressured;
+		if (backpressured)
+		{
+			in_server.counters.backpressure_count += 1;
+			printf("live link: %llu bytes of updates waiting to drain (budget %llu); pausing reads\n",
+				(unsigned long long) in_queued_bytes, (unsigned long long) in_server.config.queue_budget_bytes);
+		}
+		else
+		{
+			printf("live link: update queue drained; resuming reads\n");
+		}
+	}
+
+	in_server.poll_fds.clear();
+	in_server.poll_fds.add((SocketPollFd) { .fd = in_server.listen_socket, .events = POLLIN, .revents = 0 });
+	for (LiveLinkServerConnection* connection : in_server.connections)
+	{
+		in_server.poll_fds.add((SocketPollFd) { .fd = connection->socket, .events = (short) (backpressured ? 0 : POLLIN), .revents = 0 });
+	}
+
+	const i32 timeout_ms = backpressured ? in_server.config.backpressure_poll_ms : in_server.config.poll_timeout_ms;
+	const int ready_count = socket_poll(in_server.poll_fds.data(), (u32) in_server.poll_fds.length(), timeout_ms);
+	if (ready_count <= 0)
+	{
+		return;
+	}
+
+	// Start at a different connection each iteration so the ones that still
+	// get read once the queue budget runs out are not always the same
+	const u32 connection_count = (u32) in_server.connections.length();
+	const u32 first_index = connection_count > 0 ? in_server.read_cursor++ % connection_count : 0;
+	u64 handed_out_bytes = 0;
+	in_server.drop_indices.clear();
+	for (u32 visit_index = 0; visit_index < connection_count; ++visit_index)
+	{
+		const u32 connection_index = (first_index + visit_index) % connection_count;
+		if (in_server.poll_fds[connection_index + 1].revents == 0)
+		{
+			continue;
+		}
+		if (in_queued_bytes + handed_out_bytes > in_server.config.queue_budget_bytes)
+		{
+			break;	// still readable next iteration
+		}
+		// POLLHUP/POLLERR still go through recv so buffered frames are kept
+		// and the drop reason is logged
+		if (!live_link_server_read(in_server, *in_server.connections[connection_index], in_on_update, handed_out_bytes))
+		{
+			in_server.drop_indices.add(connection_index);
+		}
+	}
+
+	// Highest index first, so swapping the last connection in never moves
+	// one that is still waiting to be dropped
+	std::sort(in_server.drop_indices.begin(), in_server.drop_indices.end(), std::greater<u32>());
+	for (u32 connection_index : in_server.drop_indices)
+	{
+		live_link_server_drop_connection(in_server, connection_index);
+	}
+
+	if (in_server.poll_fds[0].revents & POLLIN)
+	{
+		live_link_server_accept(in_server);
+	}
+}
@@ -11,7 +11,13 @@
 
 #include "blender_live_link_generated.h"
 #include "core/dynamic_array.h"
+#include "live_link/live_link_animation_decode.h"
+#include "live_link/live_link_chunk_assembly.h"
+#include "live_link/live_link_framing.h"
+#include "live_link/live_link_mesh_decode.h"
+#include "live_link/live_link_server.h"
 #include "render/imgui_layer.h"
+#include "render/texture_streaming_system.h"
 #include "state/state.h"
 
 namespace LiveLinkSystem
@@ -105,23 +111,37 @@ namespace LiveLinkSystem
 	// described here (lazy GpuBuffer), never created.
 	// Parses the complete live-link payload used by game: content resources,
 	// objects/components, deletes, reset, and import statistics.
-	void parse_flatbuffer_data(DynamicArray<u8>& flatbuffer_data)
+	// in_data points at the size prefix and is only borrowed for this call
+	// (it usually lives inside the thread's LiveLinkReceiveRing, or is a
+	// transfer the chunk assembler just completed, described by in_transfer).
+	void parse_flatbuffer_data(const u8* in_data, size_t in_size, const LiveLinkAssembledUpdate* in_transfer = nullptr)
 	{
-		if (flatbuffer_data.length() == 0)
+		if (in_size < LIVE_LINK_FRAME_PREFIX_BYTES)
 		{
 			return;
 		}
 	
 		// Interpret Flatbuffer data
-		auto* update = Blender::LiveLink::GetSizePrefixedUpdate(flatbuffer_data.data());
+		auto* update = Blender::LiveLink::GetSizePrefixedUpdate(in_data);
 		assert(update);
+		if (update->chunk())
+		{
+			// Chunks are assembled by live_link_route_frame before parsing
+			printf("live link: ignoring a chunk frame outside of a transfer\n");
+			return;
+		}
 	
 		// Everything in this Update is packaged into one SceneUpdate message and
 		// registered/applied on the main thread at drain time
 		SceneUpdate scene_update;
-		scene_update.stats.byte_count = (u64) flatbuffer_data.length();
+		scene_update.stats.byte_count = (u64) in_size;
 		scene_update.stats.generation_seconds = update->generation_seconds();
 		scene_update.stats.reset = update->reset();
+		if (in_transfer)
+		{
+			scene_update.stats.chunk_count = (i32) in_transfer->chunk_count;
+			scene_update.stats.chunk_transfer_seconds = in_transfer->transfer_seconds;
+		}
 	
 		if (auto editor_camera = update->editor_camera())
 		{
@@ -172,10 +192,29 @@ namespace LiveLinkSystem
 			}
 		}
 	
-		// process images from update (pixels copied here — the flatbuffer memory
-		// dies with this function; the drain frees them after GPU upload)
+		// process images from update (processed into malloc'd mip chains here —
+		// the flatbuffer memory dies with this function; the drain frees them
+		// after GPU upload). How an image is stored follows the material slots
+		// that sample it in this update; see texture_processing.h.
 		if (auto images = update->images())
 		{
+			ankerl::unordered_dense::map<i32, u8> image_usage;
+			if (auto materials = update->materials())
+			{
+				for (u32 idx = 0; idx < materials->size(); ++idx)
+				{
+					auto material = materials->Get(idx);
+					image_usage[material->base_color_image_id()] |= TEXTURE_USAGE_COLOR;
+					image_usage[material->emission_color_image_id()] |= TEXTURE_USAGE_COLOR;
+					image_usage[material->metallic_image_id()] |= TEXTURE_USAGE_DATA;
+					image_usage[material->roughness_image_id()] |= TEXTURE_USAGE_DATA;
+				}
+			}
+			const bool block_compression = state.vk.texture_compression_bc_enabled;
+			TextureCache& texture_cache = state.live_link.texture_cache;
+			WorkerPool& texture_workers = state.live_link.decode_workers;
+			const auto texture_start = std::chrono::steady_clock::now();
+
 			scene_update.stats.image_count = (i32) images->size();
 			for (u32 idx = 0; idx < images->size(); ++idx)
 			{
@@ -186,6 +225,20 @@ namespace LiveLinkSystem
 				if (image_data) { scene_update.stats.image_byte_count += image_data->size(); }
 				const i32 width = image->width();
 				const i32 height = image->height();
+	
+				// Hash-only reference to pixels the runtime already has
+				if (!image_data && image->content_hash() != 0)
+				{
+					scene_update.stats.image_reference_count += 1;
+					scene_update.images.add((PendingImage) {
+						.unique_id = image->unique_id(),
+						.width = width,
+						.height = height,
+						.content_hash = image->content_hash(),
+					});
+					continue;
+				}
+	
 				if (!image_data || width <= 0 || height <= 0)
 				{
 					printf("\tSkipping malformed image UID: %i\n", image->unique_id());
@@ -200,16 +253,51 @@ namespace LiveLinkSystem
 					continue;
 				}
 	
-				u8* pixels = (u8*) malloc(expected_size);
-				memcpy(pixels, image_data->data(), expected_size);
+				u64 content_hash = image->content_hash();
+				if (content_hash == 0)
+				{
+					const i32 dimensions[2] = { width, height };
+					content_hash = content_hash_64(image_data->data(), expected_size, content_hash_64(dimensions, sizeof(dimensions)));
+				}
+	
+				auto usage = image_usage.find(image->unique_id());
+				const TextureEncoding encoding = texture_choose_encoding(
+					usage != image_usage.end() ? usage->second : 0, block_compression);
+				const u64 cache_key = texture_cache_key(content_hash, encoding);
+				const ProcessedTexture* processed = texture_cache_find(texture_cache, cache_key);
+				if (processed)
+				{
+					scene_update.stats.texture_cache_hits += 1;
+				}
+				else
+				{
+					if (!texture_workers.is_started())
+					{
+						texture_workers.start_shared();
+					}
+					ProcessedTexture texture;
+					texture_process(image_data->data(), (u32) width, (u32) height, encoding, texture, &texture_workers);
+					processed = &texture_cache_insert(texture_cache, cache_key, std::move(texture));
+				}
+	
+				const u64 byte_count = processed->data.length();
+				u8* pixels = (u8*) malloc(byte_count);
+				memcpy(pixels, processed->data.data(), byte_count);
+				scene_update.stats.texture_byte_count += byte_count;
 	
 				scene_update.images.add((PendingImage) {
 					.unique_id = image->unique_id(),
 					.width = width,
 					.height = height,
 					.pixels = pixels,
+					.byte_count = byte_count,
+					.encoding = processed->encoding,
+					.mip_count = processed->mip_count,
+					.content_hash = content_hash,
 				});
 			}
+			scene_update.stats.texture_process_seconds =
+				std::chrono::duration<f64>(std::chrono::steady_clock::now() - texture_start).count();
 		}
 	
 		// process materials from update (raw image ids; resolved at drain after
@@ -246,6 +334,9 @@ namespace LiveLinkSystem
 		}
 	
 		// process objects from update
+		static LiveLinkMeshDecodeStage mesh_decode_stage;
+		mesh_decode_stage.clear();
+		static AnimationReductionScratch animation_scratch;
 		if (auto objects = update->objects())
 		{
 			scene_update.has_object_batch = true;
@@ -284,160 +375,39 @@ namespace LiveLinkSystem
 					scale
 				);
 	
+				// Mesh streams are only validated and planned here; they are
+				// decoded in parallel once every object of the update is known.
+				// Hash-only meshes skip decode and attach to the cache at drain.
 				if (auto object_mesh = object->mesh())
 				{
-					u32 num_vertices = 0;
-					Vertex* vertices = nullptr;
-	
-					auto flatbuffer_positions = object_mesh->positions();
-					auto flatbuffer_normals = object_mesh->normals();
-					auto flatbuffer_texcoords = object_mesh->texcoords();
-					const bool has_valid_vertex_streams =
-						flatbuffer_positions &&
-						flatbuffer_normals &&
-						flatbuffer_texcoords &&
-						(flatbuffer_positions->size() % 3) == 0 &&
-						flatbuffer_normals->size() >= flatbuffer_positions->size() &&
-						flatbuffer_texcoords->size() >= (flatbuffer_positions->size() / 3) * 2;
-					if (has_valid_vertex_streams)
+					if (live_link_mesh_is_content_reference(object_mesh))
 					{
-						num_vertices = flatbuffer_positions->size() / 3;
-						vertices = (Vertex*) malloc(sizeof(Vertex) * num_vertices);
-						for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+						PendingMeshReference mesh_reference = {
+							.object_index = (u32) scene_update.objects.length(),
+							.content_hash = object_mesh->content_hash(),
+							.init_data = {
+								.armature_id = object_mesh->armature_id(),
+								.mesh_to_armature = flatbuffer_helpers::to_hmm_mat4(object_mesh->mesh_to_armature()),
+								.armature_to_mesh = flatbuffer_helpers::to_hmm_mat4(object_mesh->armature_to_mesh()),
+							},
+						};
+						if (auto material_ids = object_mesh->material_ids())
 						{
-							vertices[vertex_idx] = {
-								.position = {
-									.X = flatbuffer_positions->Get(vertex_idx * 3 + 0),
-									.Y = flatbuffer_positions->Get(vertex_idx * 3 + 1),
-									.Z = flatbuffer_positions->Get(vertex_idx * 3 + 2),
-									.W = 1.0,
-								},
-								.normal = {
-									.X = flatbuffer_normals->Get(vertex_idx * 3 + 0),
-									.Y = flatbuffer_normals->Get(vertex_idx * 3 + 1),
-									.Z = flatbuffer_normals->Get(vertex_idx * 3 + 2),
-									.W = 0.0,
-								},
-								.texcoord = {
-									.X = flatbuffer_texcoords->Get(vertex_idx * 2 + 0),
-									.Y = flatbuffer_texcoords->Get(vertex_idx * 2 + 1),
-								},
-							};
+							mesh_reference.init_data.num_material_indices = material_ids->size();
+							mesh_reference.init_data.material_indices = (i32*) malloc(sizeof(i32) * material_ids->size());
+							memcpy(mesh_reference.init_data.material_indices, material_ids->data(), sizeof(i32) * material_ids->size());
 						}
+						scene_update.mesh_references.add(mesh_reference);
+						scene_update.stats.mesh_reference_count += 1;
 					}
 					else
 					{
-						printf("\tDropping malformed mesh vertex streams on object UID: %i\n", unique_id);
-					}
-	
-					// Parse optional skinning data.
-					SkinnedVertex* skinned_vertices = nullptr;
-					u32 skin_matrix_count = 0;
-					i32 armature_id = object_mesh->armature_id();
-					auto flatbuffer_joint_indices = object_mesh->joint_indices();
-					auto flatbuffer_joint_weights = object_mesh->joint_weights();
-					if (armature_id > 0 && flatbuffer_joint_indices && flatbuffer_joint_weights)
-					{
-						const u32 num_joint_indices = flatbuffer_joint_indices->size();
-						const u32 num_joint_weights = flatbuffer_joint_weights->size();
-						u32 num_skinned_vertices = num_joint_indices / 4;
-						if (num_vertices == 0 ||
-							num_joint_indices != num_joint_weights ||
-							(num_joint_indices % 4) != 0 ||
-							num_vertices != num_skinned_vertices)
-						{
-							printf("\tDropping malformed skinning data on object UID: %i\n", unique_id);
-						}
-						else
-						{
-							i32 max_joint_index = 0;
-							skinned_vertices = (SkinnedVertex*) malloc(sizeof(SkinnedVertex) * num_vertices);
-							for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
-							{
-								for (u32 influence_idx = 0; influence_idx < 4; ++influence_idx)
-								{
-									max_joint_index = MAX(max_joint_index, flatbuffer_joint_indices->Get(vertex_idx * 4 + influence_idx));
-								}
-	
-								skinned_vertices[vertex_idx] = {
-									.joint_indices = {
-										.X = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 0),
-										.Y = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 1),
-										.Z = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 2),
-										.W = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 3),
-									},
-									.joint_weights = {
-										.X = flatbuffer_joint_weights->Get(vertex_idx * 4 + 0),
-										.Y = flatbuffer_joint_weights->Get(vertex_idx * 4 + 1),
-										.Z = flatbuffer_joint_weights->Get(vertex_idx * 4 + 2),
-										.W = flatbuffer_joint_weights->Get(vertex_idx * 4 + 3),
-									},
-								};
-							}
-							skin_matrix_count = (u32) max_joint_index + 1;
-						}
-					}
-	
-					u32 num_indices = 0;
-					u32* indices = nullptr;
-					if (auto flatbuffer_indices = object_mesh->indices())
-					{
-						if ((flatbuffer_indices->size() % 3) != 0)
-						{
-							printf("\tDropping malformed triangle index stream on object UID: %i\n", unique_id);
-						}
-						else
-						{
-							num_indices = flatbuffer_indices->size();
-							indices = (u32*) malloc(sizeof(u32) * num_indices);
-							for (u32 indices_idx = 0; indices_idx < num_indices; ++indices_idx)
-							{
-								indices[indices_idx] = flatbuffer_indices->Get(indices_idx);
-							}
-						}
-					}
-	
-					// Material ids stay raw here; resolve_mesh_material_indices
-					// maps them to indices when the main thread drains this update.
-					// Registration deliberately happens after parsing.
-					u32 num_material_indices = 0;
-					i32* material_indices = nullptr;
-					if (auto flatbuffer_material_ids = object_mesh->material_ids())
-					{
-						num_material_indices = flatbuffer_material_ids->size();
-						material_indices = (i32*) malloc(sizeof(i32) * num_material_indices);
-						for (u32 material_id_idx = 0; material_id_idx < num_material_indices; ++material_id_idx)
+						const bool planned = live_link_mesh_decode_plan(mesh_decode_stage, object_mesh, unique_id, (u32) scene_update.objects.length());
+						if (planned && mesh_decode_stage.jobs.last().has_quantized_vertices)
 						{
-							material_indices[material_id_idx] = flatbuffer_material_ids->Get(material_id_idx);
+							scene_update.stats.quantized_mesh_count += 1;
 						}
 					}
-	
-					// Set Mesh Data on Game Object
-					if (num_vertices > 0 && num_indices > 0)
-					{
-						const MeshInitData mesh_init_data = {
-							.num_indices = num_indices,
-							.indices = indices,
-							.num_vertices = num_vertices,
-							.vertices = vertices,
-							.num_material_indices = num_material_indices,
-							.material_indices = material_indices,
-							.skinned_vertices = skinned_vertices,
-							.skin_matrix_count = skin_matrix_count,
-							.armature_id = armature_id,
-							.mesh_to_armature = flatbuffer_helpers::to_hmm_mat4(object_mesh->mesh_to_armature()),
-							.armature_to_mesh = flatbuffer_helpers::to_hmm_mat4(object_mesh->armature_to_mesh()),
-						};
-						game_object.mesh = make_mesh(mesh_init_data);
-						game_object.has_mesh = true;
-					}
-					else
-					{
-						free(indices);
-						free(vertices);
-						free(material_indices);
-						free(skinned_vertices);
-					}
 				}
 	
 				// Parse armature bones and animation clips.
@@ -482,42 +452,14 @@ namespace LiveLinkSystem
 	
 							AnimationClip& animation = game_object.armature.animations[animation_idx];
 							animation.name = copy_flatbuffer_string(flatbuffer_animation->name());
-							animation.frame_rate = flatbuffer_animation->frame_rate();
-							animation.duration_seconds = flatbuffer_animation->duration_seconds();
-							animation.frame_count = flatbuffer_animation->frame_count();
-							animation.bone_count = flatbuffer_animation->bone_count();
-	
-							const i32 matrix_count = MAX(0, animation.frame_count * animation.bone_count);
-							scene_update.stats.animation_matrix_count += matrix_count;
-							if (matrix_count > 0)
-							{
-								animation.skin_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * matrix_count);
-								for (i32 matrix_idx = 0; matrix_idx < matrix_count; ++matrix_idx)
-								{
-									animation.skin_matrices[matrix_idx] = HMM_M4D(1.0f);
-								}
 	
-								if (auto flatbuffer_skin_matrices = flatbuffer_animation->skin_matrices())
-								{
-									const i32 available_float_count = (i32) flatbuffer_skin_matrices->size();
-									for (i32 matrix_idx = 0; matrix_idx < matrix_count; ++matrix_idx)
-									{
-										const i32 base_float_idx = matrix_idx * 16;
-										if (base_float_idx + 15 >= available_float_count)
-										{
-											break;
-										}
-	
-										for (i32 col = 0; col < 4; ++col)
-										{
-											for (i32 row = 0; row < 4; ++row)
-											{
-												animation.skin_matrices[matrix_idx].Elements[col][row] = flatbuffer_skin_matrices->Get(base_float_idx + col * 4 + row);
-											}
-										}
-									}
-								}
-							}
+							LiveLinkAnimationDecodeResult decode_result;
+							live_link_decode_animation(flatbuffer_animation, animation, animation_scratch, decode_result);
+							scene_update.stats.animation_matrix_count += decode_result.matrix_count;
+							scene_update.stats.compact_animation_count += decode_result.arrived_compact ? 1 : 0;
+							scene_update.stats.compressed_animation_count += decode_result.compressed ? 1 : 0;
+							scene_update.stats.animation_matrix_bytes += decode_result.matrix_bytes;
+							scene_update.stats.animation_stored_bytes += decode_result.stored_bytes;
 						}
 					}
 				}
@@ -805,6 +747,70 @@ namespace LiveLinkSystem
 	
 			}
 	
+		// Decode every planned mesh into one shared arena. Each worker only
+		// writes the object slot its job was planned for.
+		if (!mesh_decode_stage.jobs.empty())
+		{
+			WorkerPool& decode_workers = state.live_link.decode_workers;
+			if (!decode_workers.is_started())
+			{
+				decode_workers.start_shared();
+			}
+
+			const auto decode_start = std::chrono::steady_clock::now();
+			SharedArena* mesh_arena = live_link_mesh_decode_run(
+				mesh_decode_stage,
+				decode_workers,
+				[&](const LiveLinkMeshDecodeJob& in_job, const LiveLinkDecodedMesh& in_mesh)
+				{
+					const MeshInitData mesh_init_data = {
+						.num_indices = in_mesh.num_indices,
+						.indices = in_mesh.indices,
+						.num_vertices = in_mesh.num_vertices,
+						.vertices = in_mesh.vertices,
+						.num_material_indices = in_mesh.num_material_indices,
+						.material_indices = in_mesh.material_indices,
+						.skinned_vertices = in_mesh.skinned_vertices,
+						.skin_matrix_count = in_mesh.skin_matrix_count,
+						.armature_id = in_mesh.armature_id,
+						.mesh_to_armature = flatbuffer_helpers::to_hmm_mat4(in_job.source->mesh_to_armature()),
+						.armature_to_mesh = flatbuffer_helpers::to_hmm_mat4(in_job.source->armature_to_mesh()),
+						.compact_vertices = in_mesh.compact_vertices,
+						.compact_indices = in_mesh.compact_indices,
+						.quantization = in_mesh.quantization,
+						.storage_arena = in_mesh.storage_arena,
+					};
+					Object& game_object = scene_update.objects[in_job.output_index];
+					game_object.mesh = make_mesh(mesh_init_data);
+					game_object.mesh.content_hash = in_mesh.content_hash;
+					game_object.has_mesh = true;
+				});
+			scene_update.stats.mesh_decode_seconds =
+				std::chrono::duration<f64>(std::chrono::steady_clock::now() - decode_start).count();
+			scene_update.stats.mesh_decode_arena_bytes = (u64) mesh_decode_stage.arena_size;
+			scene_update.stats.mesh_decode_worker_count = decode_workers.worker_count();
+
+			// Every decoded mesh now holds its own reference
+			shared_arena_release(mesh_arena);
+		}
+
+		// Transform-only deltas (the object already exists on the runtime)
+		if (auto transforms = update->transforms())
+		{
+			scene_update.stats.transform_count = (i32) transforms->size();
+			for (const Blender::LiveLink::ObjectTransform* object_transform : *transforms)
+			{
+				scene_update.transforms.add((PendingTransform) {
+					.unique_id = object_transform->unique_id(),
+					.transform = {
+						.location = flatbuffer_helpers::to_hmm_vec4(&object_transform->location(), 1.0f),
+						.rotation = flatbuffer_helpers::to_hmm_quat(&object_transform->rotation()),
+						.scale = flatbuffer_helpers::to_hmm_vec3(&object_transform->scale()),
+					},
+				});
+			}
+		}
+	
 		if (auto deleted_object_uids = update->deleted_object_uids())
 		{
 			scene_update.stats.deleted_object_count = (i32) deleted_object_uids->size();
@@ -827,6 +833,7 @@ namespace LiveLinkSystem
 				scene_update.stats.mesh_vertex_count += (i32) object.mesh.vertex_count;
 				scene_update.stats.mesh_index_count += (i32) object.mesh.index_count;
 				if (object.mesh.has_skinned_vertices) { scene_update.stats.skinned_mesh_count++; }
+				if (object.mesh.compact_vertices) { scene_update.stats.compact_mesh_count++; }
 			}
 			if (object.has_light) { scene_update.stats.light_count++; }
 			if (object.has_armature)
@@ -836,154 +843,106 @@ namespace LiveLinkSystem
 			}
 		}
 	
-		// Send the whole update to the main thread
-		state.live_link.scene_updates.send(std::move(scene_update));
+		// Send the whole update to the main thread. Its wire size counts
+		// against the server's queue budget until the drain applies it.
+		// Waits while the main thread is a full queue behind; gives up only at shutdown.
+		const u64 byte_count = scene_update.stats.byte_count;
+		state.live_link.queued_update_bytes.fetch_add(byte_count, std::memory_order_relaxed);
+		scene_update.queued_time = std::chrono::steady_clock::now();
+		if (!state.live_link.scene_updates.push(std::move(scene_update), state.runtime.game_running))
+		{
+			state.live_link.queued_update_bytes.fetch_sub(byte_count, std::memory_order_relaxed);
+		}
 	}
 	
-	// Live Link Function. Runs on its own thread
+	// Live Link Function. Runs on its own thread. Serves any number of
+	// senders until shutdown; a sender that disconnects or misbehaves is
+	// dropped on its own and Blender may reconnect at any time.
 	void live_link_thread_function()
 	{
 		socket_lib_init();
 	
-		// Init socket we'll use to talk to blender
-		struct addrinfo hints, *res;
-	
-		memset(&hints, 0, sizeof hints);
-		hints.ai_family = AF_UNSPEC;
-		hints.ai_socktype = SOCK_STREAM;
-	
 		const char* HOST = "127.0.0.1";
 	
-		// getaddrinfo can transiently fail (system resolver hiccups) — retry
-		// instead of dereferencing a null result
-		res = nullptr;
-		while (state.runtime.game_running)
+		// Opening can transiently fail (resolver hiccups, the port still held
+		// by a previous run) — retry instead of exiting
+		LiveLinkServer server;
+		server.config.queue_budget_bytes = state.live_link.queue_budget_bytes;
+		while (state.runtime.game_running && !live_link_server_open(server, HOST, state.live_link.port.c_str()))
 		{
-			const int getaddrinfo_result = getaddrinfo(HOST, state.live_link.port.c_str(), &hints, &res);
-			if (getaddrinfo_result == 0 && res != nullptr)
-			{
-				break;
-			}
-	
-			printf("live link: getaddrinfo failed (%s), retrying\n", gai_strerror(getaddrinfo_result));
-			res = nullptr;
+			printf("live link: retrying in 1 s\n");
 			std::this_thread::sleep_for(std::chrono::seconds(1));
 		}
-		if (res == nullptr)
-		{
-			return;	// shutting down before the resolver ever succeeded
-		}
 	
-		// make a socket
-		state.live_link.blender_socket = socket_open(res->ai_family, res->ai_socktype, res->ai_protocol);
-	
-		// Allow us to reuse address and port
-		socket_set_reuse_addr_and_port(state.live_link.blender_socket, true);
-	
-		// bind our socket
-		SOCKET_OP(bind(state.live_link.blender_socket, res->ai_addr, res->ai_addrlen));
-	
-		const i32 backlog = 1;
-		SOCKET_OP(listen(state.live_link.blender_socket, backlog));
-	
-		// accept connections from blender
-		struct sockaddr_storage their_addr;
-		socklen_t addr_size = sizeof their_addr;
-		do
+		// Records exactly what parse_flatbuffer_data sees, so a replay takes
+		// the same path
+		LiveLinkCaptureWriter recorder;
+		if (state.live_link.record_path)
 		{
-			state.live_link.connection_socket = accept(state.live_link.blender_socket, (struct sockaddr *) &their_addr, &addr_size);
+			live_link_capture_writer_open(recorder, state.live_link.record_path->c_str());
 		}
-		while (!socket_is_valid(state.live_link.connection_socket) && state.runtime.game_running);
-	
-		// set recv timeout
-		struct timeval recv_timeout = {
-			.tv_sec = 1,
-			.tv_usec = 0
-		};
-		socket_set_recv_timeout(state.live_link.connection_socket, recv_timeout);
 	
-		// infinite recv loop
 		while (state.runtime.game_running)
 		{
-			DynamicArray<u8> flatbuffer_data;
-	
-			int current_bytes_read = 0;
-			int total_bytes_read = 0;
-			int packets_read = 0;
-			optional<flatbuffers::uoffset_t> flatbuffer_size;
-			do
-			{
-				const size_t buffer_len = 4096;
-				u8 buffer[buffer_len];
-				const int flags = 0;
-				current_bytes_read = socket_recv(state.live_link.connection_socket, buffer, buffer_len, flags);
-	
-				// Less than zero is an error
-				if (current_bytes_read < 0)
-				{
-					int last_error = socket_get_last_error();
-					if (	last_error == socket_error_again()
-						||	last_error == socket_error_would_block()
-						||	last_error == socket_error_timed_out())
-					{
-						current_bytes_read = 0;
-						continue;
-					}
-					else
-					{
-						printf("recv_error: %i\n", last_error);
-						exit(0);
-					}
-				}
-	
-				// No bytes read this iteration. Try again
-				if (current_bytes_read == 0)
+			live_link_server_poll(
+				server,
+				state.live_link.queued_update_bytes.load(std::memory_order_relaxed),
+				[&recorder](const LiveLinkServerConnection& in_connection, const LiveLinkRoutedUpdate& in_update)
 				{
-					continue;
-				}
-	
-				// current_bytes_read > 0, we've got data!
-				if (current_bytes_read > 0)
-				{
-					// Flatbuffer size will be prefixed to flatbuffer data. Set it when we encounter it
-					if (!flatbuffer_size)
-					{
-						assert(current_bytes_read >= sizeof(flatbuffers::uoffset_t));
-						flatbuffer_size = *(flatbuffers::uoffset_t*)(buffer);
-					}
-	
-					total_bytes_read += current_bytes_read;
-					i32 next_idx = flatbuffer_data.length();
-					flatbuffer_data.add_uninitialized(current_bytes_read);
-					memcpy(&flatbuffer_data[next_idx], buffer, current_bytes_read);
-					++packets_read;
-				}
-			}
-			while (state.runtime.game_running && (current_bytes_read == 0 || (flatbuffer_size && total_bytes_read < flatbuffer_size.value())));
-	
-			printf("We've got some data! Data Length: %td Packets Read: %i\n", flatbuffer_data.length(), packets_read);
-	
-			parse_flatbuffer_data(flatbuffer_data);
+					printf("We've got some data! Connection: %u Data Length: %zu Recv Calls: %llu Chunks: %u\n",
+						in_connection.id, in_update.size, (unsigned long long) in_connection.ring.recv_count,
+						in_update.assembled.chunk_count);
+					live_link_capture_writer_append(recorder, in_connection.id, in_update.data, in_update.size);
+					parse_flatbuffer_data(
+						in_update.data,
+						in_update.size,
+						in_update.assembled.data ? &in_update.assembled : nullptr);
+				});
 		}
 	
-		printf("Shutting down sockets\n");
-	
-		socket_close(state.live_link.connection_socket);
-		socket_close(state.live_link.blender_socket);
+		printf("Shutting down sockets (%llu accepted, %llu dropped, %llu updates, %llu backpressure pauses)\n",
+			(unsigned long long) server.counters.accepted_count,
+			(unsigned long long) server.counters.dropped_count,
+			(unsigned long long) server.counters.update_count,
+			(unsigned long long) server.counters.backpressure_count);
+		live_link_server_close(server);
+		live_link_capture_writer_close(recorder);
 	
 		socket_lib_quit();
 	}
 	
 	// Registers one image (main thread): creates + uploads the GPU image backing
-	// a bindless array slot. Takes ownership of pending.pixels and frees it in
-	// all paths.
-	void register_image(const PendingImage& in_pending)
+	// a bindless array slot, or maps the id onto the slot that already holds
+	// the same content hash. Takes ownership of pending.pixels: a registered
+	// image keeps them for texture streaming (freed by reset_images), every
+	// other path frees them.
+	void register_image(const PendingImage& in_pending, SceneUpdate::ImportStats& in_out_stats)
 	{
 		if (state.images.id_to_index.contains(in_pending.unique_id))
 		{
 			free(in_pending.pixels);
 			return;
 		}
+
+		ContentCacheCounters& cache_counters = state.live_link.content_cache.counters;
+		auto cached = state.images.hash_to_index.find(in_pending.content_hash);
+		if (cached != state.images.hash_to_index.end())
+		{
+			state.images.id_to_index[in_pending.unique_id] = cached->second;
+			free(in_pending.pixels);
+			in_out_stats.image_cache_hits += 1;
+			cache_counters.image_hits += 1;
+			return;
+		}
+		in_out_stats.image_cache_misses += 1;
+		cache_counters.image_misses += 1;
+
+		if (!in_pending.pixels)
+		{
+			printf("Missing cached pixels for image UID %i (hash %016llx); skipping\n",
+				in_pending.unique_id, (unsigned long long) in_pending.content_hash);
+			return;
+		}
 	
 		if (state.images.items.length() >= MAX_BINDLESS_IMAGES)
 		{
@@ -992,21 +951,42 @@ namespace LiveLinkSystem
 			return;
 		}
 	
-		// UNORM (not SRGB): the addon sends linear-encoded bytes (Blender
-		// image.pixels are scene-linear floats * 255). Banding in
-		// darks is the known tradeoff until the addon sends sRGB-encoded data.
-		GpuImage image = gpu_image_create_from_data(
+		// The parse stage already built the mip chain in the image's encoding
+		// (sRGB for color slots, red-only for data slots, BC when the device
+		// samples it). With streaming only the tail is uploaded now; finer
+		// levels follow from the kept chain once the geometry pass asks for
+		// them. The upload is async; the slot shows the placeholder until its
+		// ticket is ready.
+		const bool streaming = TextureStreamingSystem::enabled(&state.vk);
+		const u32 first_mip = texture_streaming_add(state.images.streaming,
+			(u32) in_pending.width, (u32) in_pending.height, in_pending.mip_count, in_pending.encoding, streaming);
+		const TextureResidency& residency = state.images.streaming.textures[state.images.streaming.textures.length() - 1];
+		u64 upload_ticket = 0;
+		GpuImage image = gpu_image_create_async(
 			&state.vk,
-			(u32) in_pending.width,
-			(u32) in_pending.height,
-			VK_FORMAT_R8G8B8A8_UNORM,
-			in_pending.pixels,
-			(u64) in_pending.width * (u64) in_pending.height * 4
+			texture_mip_extent((u32) in_pending.width, first_mip),
+			texture_mip_extent((u32) in_pending.height, first_mip),
+			in_pending.mip_count - first_mip,
+			texture_encoding_vk_format(in_pending.encoding),
+			in_pending.pixels + texture_residency_offset(residency, first_mip),
+			texture_residency_bytes(residency, first_mip),
+			"Live Link Image",
+			&upload_ticket
 		);
-		free(in_pending.pixels);
+	
+		const u64 rgba_bytes = texture_chain_bytes(TextureEncoding::RGBA8,
+			(u32) in_pending.width, (u32) in_pending.height, in_pending.mip_count);
+		state.images.vram_bytes += in_pending.byte_count;
+		state.images.vram_saved_bytes += rgba_bytes > in_pending.byte_count ? rgba_bytes - in_pending.byte_count : 0;
 	
 		state.images.id_to_index[in_pending.unique_id] = (i32) state.images.items.length();
+		state.images.hash_to_index[in_pending.content_hash] = (i32) state.images.items.length();
 		state.images.items.add(image);
+		state.images.upload_tickets.add(upload_ticket);
+		state.images.sources.add(in_pending.pixels);
+		state.images.first_mips.add((u8) first_mip);
+		state.images.replacements.add(GpuImage {});
+		state.images.replacement_tickets.add(0);
 	}
 	
 	// Images are only destroyed on scene reset; individual removal is unsupported.
@@ -1024,9 +1004,26 @@ namespace LiveLinkSystem
 				}
 				vulkan_context_retire_image(&state.vk, image);
 			}
+			for (GpuImage& replacement : state.images.replacements)
+			{
+				vulkan_context_retire_image(&state.vk, replacement);
+			}
+			for (u8* source : state.images.sources)
+			{
+				free(source);
+			}
 		}
 		state.images.items.reset();
+		state.images.upload_tickets.reset();
+		state.images.sources.reset();
+		state.images.first_mips.reset();
+		state.images.replacements.reset();
+		state.images.replacement_tickets.reset();
+		texture_streaming_reset(state.images.streaming);
+		state.images.vram_bytes = 0;
+		state.images.vram_saved_bytes = 0;
 		state.images.id_to_index.clear();
+		state.images.hash_to_index.clear();
 	}
 	
 	// Registers one material (main thread). Returns true when it was newly
@@ -1066,7 +1063,12 @@ namespace LiveLinkSystem
 				return -1;
 			}
 			auto found = state.images.id_to_index.find(in_image_id);
-			assert(found != state.images.id_to_index.end());
+			if (found == state.images.id_to_index.end())
+			{
+				// Skipped as malformed, or a hash reference the runtime no longer had
+				printf("\tFailed to find image with id: %i\n", in_image_id);
+				return -1;
+			}
 			return found->second;
 		};
 		material.base_color_image_index = resolve_image_index(in_pending.base_color_image_id);
@@ -1105,15 +1107,53 @@ namespace LiveLinkSystem
 		}
 	}
 	
+	// Builds the mesh of a hash-only reference from the content cache. Takes
+	// ownership of the reference's material ids; the object keeps no mesh when
+	// the runtime no longer has that content.
+	void attach_mesh_reference(Object& in_object, const PendingMeshReference& in_reference, SceneUpdate::ImportStats& in_out_stats)
+	{
+		const MeshInitData& init_data = in_reference.init_data;
+		Mesh mesh = {
+			.material_indices_count = init_data.num_material_indices,
+			.material_indices = init_data.material_indices,
+			.skin_matrix_arena_offset = -1,
+			.armature_id = init_data.armature_id,
+			.mesh_to_armature = init_data.mesh_to_armature,
+			.armature_to_mesh = init_data.armature_to_mesh,
+			.content_hash = in_reference.content_hash,
+		};
+		if (!live_link_content_cache_attach_mesh(state.live_link.content_cache, mesh, in_reference.content_hash))
+		{
+			printf("\tMissing cached mesh for object UID %i (hash %016llx); dropping mesh\n",
+				in_object.unique_id, (unsigned long long) in_reference.content_hash);
+			free(mesh.material_indices);
+			in_out_stats.mesh_cache_misses += 1;
+			return;
+		}
+		in_object.mesh = mesh;
+		in_object.has_mesh = true;
+		in_out_stats.mesh_cache_hits += 1;
+	}
+
 	// Drains SceneUpdate messages on the main thread. GPU buffer destruction for
 	// replaced/deleted objects routes through the deletion queue, so this is safe
 	// while frames are in flight. Per-message processing order is:
 	// images -> materials -> objects -> deleted -> reset.
 	void live_link_drain_channels()
 	{
-		while (optional<SceneUpdate> received_update = state.live_link.scene_updates.receive())
+		State::DataOrientedState::FrameAccessStats& frame_stats = state.data_oriented.frame;
+		frame_stats.live_link_queue_depth = MAX(frame_stats.live_link_queue_depth, (i32) state.live_link.scene_updates.size_approx());
+		const u64 producer_wait_ns = state.live_link.scene_updates.total_producer_wait_ns();
+		frame_stats.live_link_producer_wait_us += (i32) ((producer_wait_ns - state.live_link.reported_producer_wait_ns) / 1000);
+		state.live_link.reported_producer_wait_ns = producer_wait_ns;
+	
+		while (optional<SceneUpdate> received_update = state.live_link.scene_updates.try_pop())
 		{
 			SceneUpdate& scene_update = *received_update;
+			const i64 queue_wait_us = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now() - scene_update.queued_time).count();
+			frame_stats.live_link_queue_wait_us = MAX(frame_stats.live_link_queue_wait_us, (i32) queue_wait_us);
+			state.live_link.queued_update_bytes.fetch_sub(scene_update.stats.byte_count, std::memory_order_relaxed);
 			State::DataOrientedState::LiveLinkImportStats import_stats;
 			static_cast<SceneUpdate::ImportStats&>(import_stats) = scene_update.stats;
 			import_stats.update_index = state.data_oriented.last_import.update_index + 1;
@@ -1160,7 +1200,7 @@ namespace LiveLinkSystem
 			// Images (before materials — register_material resolves image ids)
 			for (const PendingImage& pending_image : scene_update.images)
 			{
-				register_image(pending_image);
+				register_image(pending_image, import_stats);
 			}
 	
 			// Materials
@@ -1177,16 +1217,39 @@ namespace LiveLinkSystem
 			}
 	
 			// Updated objects
-			for (Object& updated_object : scene_update.objects)
+			LiveLinkContentCache& content_cache = state.live_link.content_cache;
+			u32 next_mesh_reference = 0;
+			for (u32 object_idx = 0; object_idx < scene_update.objects.length(); ++object_idx)
 			{
+				Object& updated_object = scene_update.objects[object_idx];
 				state.data_oriented.frame.live_link_updated_objects += 1;
 				i32 updated_object_uid = updated_object.unique_id;
 	
 				printf("Updating Object. UID: %i\n", updated_object_uid);
 	
+				if (next_mesh_reference < scene_update.mesh_references.length() &&
+					scene_update.mesh_references[next_mesh_reference].object_index == object_idx)
+				{
+					attach_mesh_reference(updated_object, scene_update.mesh_references[next_mesh_reference], import_stats);
+					next_mesh_reference += 1;
+				}
+	
 				if (updated_object.has_mesh)
 				{
 					resolve_mesh_material_indices(updated_object.mesh);
+	
+					// Identical geometry already on the GPU: reuse its streams
+					if (updated_object.mesh.content_hash != 0 && !updated_object.mesh.shared_streams)
+					{
+						if (live_link_content_cache_share_mesh(content_cache, updated_object.mesh, updated_object.mesh.content_hash))
+						{
+							import_stats.mesh_cache_hits += 1;
+						}
+						else
+						{
+							import_stats.mesh_cache_misses += 1;
+						}
+					}
 				}
 	
 				// Create the Jolt body on the drained copy BEFORE the map insert
@@ -1217,6 +1280,13 @@ namespace LiveLinkSystem
 				}
 			}
 	
+			// Transform deltas: move in place, no mesh/body/scene-entry rebuild
+			for (const PendingTransform& pending_transform : scene_update.transforms)
+			{
+				state.data_oriented.frame.live_link_transformed_objects += 1;
+				scene_set_object_transform(state, pending_transform.unique_id, pending_transform.transform);
+			}
+	
 			// Deleted objects
 			for (i32 deleted_object_uid : scene_update.deleted_object_uids)
 			{
@@ -1236,18 +1306,29 @@ namespace LiveLinkSystem
 				scene_clear_objects(state);
 				reset_materials();
 				reset_images();
+				live_link_content_cache_clear(content_cache);
 			}
 	
 			if (!scene_update.reset)
 			{
 				mech_reconcile_instances();
+	
+				// Only between batches: hashes referenced by this batch had to
+				// survive until every object in it was attached
+				live_link_content_cache_trim(content_cache, LIVE_LINK_CONTENT_CACHE_UNUSED_BUDGET_BYTES);
 			}
+	
+			// Cache hits/misses are only known after the drain; republish
+			state.data_oriented.last_import = import_stats;
+			state.data_oriented.import_history.last() = import_stats;
 		}
 	}
 
+	// Main thread, before the socket thread starts. The main thread is also
+	// the queue's consumer, so the parse must find room instead of waiting
+	// for a drain; the update is then drained right away, as replay() does.
 	inline bool load_initial_file(State& in_state, const std::string& in_path)
 	{
-		(void) in_state;
 		if (FILE* file = fopen(in_path.c_str(), "rb"))
 		{
 			fseek(file, 0, SEEK_END);
@@ -1261,7 +1342,9 @@ namespace LiveLinkSystem
 			fclose(file);
 			assert(bytes_read == (size_t) file_size);
 
-			parse_flatbuffer_data(flatbuffer_data);
+			assert(in_state.live_link.scene_updates.size_approx() == 0);
+			parse_flatbuffer_data(flatbuffer_data.data(), flatbuffer_data.length());
+			live_link_drain_channels();
 			return true;
 		}
 
@@ -1269,6 +1352,59 @@ namespace LiveLinkSystem
 		return false;
 	}
 
+	// Maps a --replay-live-link capture; frames are fed by replay()
+	inline bool load_replay(State& in_state, const std::string& in_path, bool in_max_speed)
+	{
+		LiveLinkReplay& replay = in_state.live_link.replay;
+		if (!live_link_capture_map(replay.capture, in_path.c_str()))
+		{
+			return false;
+		}
+		replay.max_speed = in_max_speed;
+		printf("live link: replaying %zu updates from %s at %s\n",
+			replay.capture.frames.length(), in_path.c_str(), in_max_speed ? "maximum speed" : "recorded speed");
+		return true;
+	}
+	
+	// Feeds every captured update that is due through the same path as the
+	// socket thread, draining each one right away so its parse and apply
+	// costs are timed separately. Main thread, once per frame.
+	inline void replay(State& in_state)
+	{
+		LiveLinkReplay& replay = in_state.live_link.replay;
+		if (!replay.capture.data || replay.finished)
+		{
+			return;
+		}
+		if (!replay.started)
+		{
+			replay.started = true;
+			replay.start_time = std::chrono::steady_clock::now();
+		}
+	
+		const u64 elapsed_ns = (u64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - replay.start_time).count();
+		while (const LiveLinkCaptureIndexEntry* entry = live_link_replay_next_due(replay, elapsed_ns))
+		{
+			const auto parse_start = std::chrono::steady_clock::now();
+			parse_flatbuffer_data(live_link_capture_frame_data(replay.capture, *entry), entry->frame_size);
+			const auto drain_start = std::chrono::steady_clock::now();
+			live_link_drain_channels();
+			const auto drain_end = std::chrono::steady_clock::now();
+			replay.parse_ms.add(std::chrono::duration<f64, std::milli>(drain_start - parse_start).count());
+			replay.drain_ms.add(std::chrono::duration<f64, std::milli>(drain_end - drain_start).count());
+			replay.byte_count += entry->frame_size;
+		}
+	
+		if (replay.next_frame_index == replay.capture.frames.length())
+		{
+			replay.finished = true;
+			replay.wall_seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - replay.start_time).count();
+			printf("live link: replay finished, %zu updates, %llu bytes in %.3f s\n",
+				replay.capture.frames.length(), (unsigned long long) replay.byte_count, replay.wall_seconds);
+		}
+	}
+	
 	inline void start(State& in_state)
 	{
 		in_state.live_link.thread = std::thread(live_link_thread_function);
@@ -1287,11 +1423,14 @@ namespace LiveLinkSystem
 		{
 			in_state.live_link.thread.join();
 		}
+		in_state.live_link.decode_workers.stop();
 	}
 
 	inline void cleanup_imported_resources(State& in_state)
 	{
 		(void) in_state;
 		reset_images();
+		live_link_content_cache_clear(state.live_link.content_cache);
+		live_link_capture_unmap(state.live_link.replay.capture);
 	}
 }
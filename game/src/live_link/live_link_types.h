@@ -1,10 +1,12 @@
 #pragma once
 
+#include <chrono>
 #include <optional>
 
 #include "core/types.h"
 #include "game_object/camera.h"
 #include "game_object/game_object.h"
+#include "render/texture_processing.h"
 
 // ---- Live link messages ----
 // Images and materials must not be registered on the live-link thread: GPU
@@ -19,7 +21,16 @@ struct PendingImage
 	i32 unique_id = 0;
 	i32 width = 0;
 	i32 height = 0;
-	u8* pixels = nullptr;	// malloc'd RGBA8, width*height*4, validated at parse
+	// malloc'd mip chain in encoding (texture_process at parse), largest
+	// level first, byte_count bytes
+	u8* pixels = nullptr;
+	u64 byte_count = 0;
+	TextureEncoding encoding = TextureEncoding::RGBA8;
+	u32 mip_count = 1;
+
+	// Content cache key (wire Image.content_hash, or hashed at parse). A
+	// hash-only reference arrives with pixels == nullptr.
+	u64 content_hash = 0;
 };
 
 struct PendingMaterial
@@ -38,6 +49,23 @@ struct PendingMaterial
 	i32 roughness_image_id = 0;
 };
 
+// Transform-only delta for an object the runtime already has
+// (Update.transforms); applied without rebuilding the object
+struct PendingTransform
+{
+	i32 unique_id = 0;
+	Transform transform;
+};
+
+// Hash-only mesh (Mesh.content_hash without streams) for the object at
+// object_index; attached to the cached streams at drain
+struct PendingMeshReference
+{
+	u32 object_index = 0;
+	u64 content_hash = 0;
+	MeshInitData init_data;	// material ids + armature binding only
+};
+
 struct SceneUpdate
 {
 	struct ImportStats
@@ -53,11 +81,34 @@ struct SceneUpdate
 		i32 mesh_vertex_count = 0;
 		i32 mesh_index_count = 0;
 		i32 skinned_mesh_count = 0;
+		i32 quantized_mesh_count = 0;	// vertex streams arrived quantized
+		i32 compact_mesh_count = 0;	// ...and draw from the compact GPU format
 		i32 light_count = 0;
 		i32 armature_count = 0;
 		i32 animation_count = 0;
 		i32 animation_matrix_count = 0;
+		i32 compact_animation_count = 0;	// clips that arrived in the compact encoding
+		i32 compressed_animation_count = 0;	// clips kept compact (arrived or compressed at import)
+		u64 animation_matrix_bytes = 0;	// size the clips would take as matrices
+		u64 animation_stored_bytes = 0;	// size as kept
 		i32 malformed_object_count = 0;
+		i32 transform_count = 0;
+		f64 mesh_decode_seconds = 0.0;
+		u64 mesh_decode_arena_bytes = 0;
+		i32 mesh_decode_worker_count = 0;
+		i32 mesh_reference_count = 0;
+		i32 image_reference_count = 0;
+		f64 texture_process_seconds = 0.0;	// mips + encoding on the live-link thread
+		u64 texture_byte_count = 0;	// processed mip chains handed to the drain
+		i32 texture_cache_hits = 0;	// images served already processed
+		i32 chunk_count = 0;	// 0 unless the Update arrived as a chunked transfer
+		f64 chunk_transfer_seconds = 0.0;	// first chunk -> last chunk
+
+		// Filled at drain, when the content cache is consulted
+		i32 mesh_cache_hits = 0;
+		i32 mesh_cache_misses = 0;
+		i32 image_cache_hits = 0;
+		i32 image_cache_misses = 0;
 		bool reset = false;
 	} stats;
 	DynamicArray<PendingImage> images;
@@ -66,10 +117,13 @@ struct SceneUpdate
 	// Note: each Object's mesh.material_indices still holds raw material IDS
 	// here; resolve_mesh_material_indices converts them at drain
 	DynamicArray<Object> objects;
+	DynamicArray<PendingMeshReference> mesh_references;	// ascending object_index
 
+	DynamicArray<PendingTransform> transforms;
 	DynamicArray<i32> deleted_object_uids;
 	std::optional<Camera> editor_camera;
 	bool has_object_batch = false;
 	bool reset = false;
+	std::chrono::steady_clock::time_point queued_time;	// handed to the main thread
 };
 
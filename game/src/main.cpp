@@ -94,16 +94,38 @@ static bool cloud_shadow_validation_capture_finished = false;
 static bool tonemapping_validation_capture_finished = false;
 static bool tonemapping_validation_capture_failed = false;
 static i32 tonemapping_validation_capture_count = 0;
+static bool gbuffer_validation_capture_finished = false;
+static bool gbuffer_validation_capture_failed = false;
 
 // Copies Jolt body transforms back into object transforms every frame.
 // This is a no-op while paused because bodies do not move.
-// The object transforms therefore remain unchanged while paused.
+// The object transforms therefore remain unchanged while paused, and only
+// bodies that moved dirty their render rows.
 void update_physics_backed_object_transforms()
 {
 	JPH::BodyInterface& body_interface = jolt_state.physics_system.GetBodyInterface();
 	for (auto& [unique_id, object] : state.scene.objects)
 	{
-		object_copy_physics_transform(object, body_interface);
+		if (object_copy_physics_transform(object, body_interface))
+		{
+			scene_mark_render_object_dirty(state, object);
+		}
+	}
+}
+
+// Frame stages, rebuilt every frame (core/task_graph.h)
+static TaskGraph frame_task_graph;
+
+// Main-thread tasks time themselves with CPU_TIMING_SCOPE; tasks that ran
+// on Jolt's workers are added to the profiler once the graph has finished
+void record_frame_task_timings(const TaskGraph& in_graph)
+{
+	for (const TaskGraphTask& task : in_graph.tasks)
+	{
+		if (task.affinity == TaskAffinity::AnyThread)
+		{
+			cpu_timings_record_event(task.name, task.start_ticks, task.end_ticks);
+		}
 	}
 }
 
@@ -119,12 +141,22 @@ void frame(f32 in_delta_time)
 		return;
 	}
 
+	// The frame's stages as a task graph. Main-thread tasks own scene
+	// structure (live-link imports), input, the Jolt step and Vulkan
+	// recording. Skinned animation only touches armatures and skinned-mesh
+	// bounds, so it overlaps the physics step; once transforms are final the
+	// three packers read the scene and each fill their own arrays, side by
+	// side. Their GPU uploads are recorded together on the main thread.
+	TaskGraph& graph = frame_task_graph;
+	task_graph_clear(graph);
+	const u32 live_link = task_graph_add(graph, "Live Link", TaskAffinity::MainThread, []()
 	{
 		CPU_TIMING_SCOPE("Live Link");
+		LiveLinkSystem::replay(state);
 		LiveLinkSystem::drain(state);
-	}
-	automated_screenshot.begin_frame(state, RenderSystem::gi_scene());
-
+		automated_screenshot.begin_frame(state, RenderSystem::gi_scene());
+	});
+	const u32 controls = task_graph_add(graph, "Camera + Controls", TaskAffinity::MainThread, [in_delta_time]()
 	{
 		CPU_TIMING_SCOPE("Camera + Controls");
 		InputSystem::update_controls(state, in_delta_time, automated_screenshot.enabled());
@@ -132,39 +164,59 @@ void frame(f32 in_delta_time)
 		{
 			RenderSystem::pick_isolated_gi_probe(state);
 		}
-	}
-
+		if (state.runtime.is_simulating)
+		{
+			InputSystem::update_player_character(state, in_delta_time);
+		}
+	}, { live_link });
+	const u32 simulation = task_graph_add(graph, "Simulation", TaskAffinity::MainThread, [in_delta_time]()
 	{
 		CPU_TIMING_SCOPE("Simulation");
 		if (state.runtime.is_simulating)
 		{
-			InputSystem::update_player_character(state, in_delta_time);
 			jolt_update(in_delta_time);
 		}
-	}
-
+	}, { controls });
+	const u32 animation_advance = task_graph_add(graph, "Skinned Animation Advance", TaskAffinity::AnyThread, [in_delta_time]()
 	{
-		CPU_TIMING_SCOPE("Skinned Animation Advance");
 		AnimationSystem::advance(state, in_delta_time);
-	}
-
+		AnimationSystem::update_skinned_bounds(state);
+	}, { controls });
+	const u32 transforms = task_graph_add(graph, "Object Transforms", TaskAffinity::MainThread, []()
 	{
 		CPU_TIMING_SCOPE("Object Transforms");
 		update_physics_backed_object_transforms();
 		update_mech_transforms();
 		SceneSystem::refresh_derived_state(state);
+		prepare_render_object_snapshot(state);
+	}, { simulation, animation_advance });
+	const u32 snapshot = task_graph_add(graph, "Render Object Snapshot", TaskAffinity::AnyThread, []()
+	{
 		build_render_object_snapshot(state);
+	}, { transforms });
+	const u32 lights = task_graph_add(graph, "Pack Lights", TaskAffinity::AnyThread, []()
+	{
 		pack_lights(state);
-		upload_lights(state);
-	}
-
+	}, { transforms });
+	const u32 skin = task_graph_add(graph, "Skinned Animation Pack", TaskAffinity::AnyThread, []()
 	{
-		CPU_TIMING_SCOPE("Skinned Animation Pack");
 		AnimationSystem::pack_skin_matrices(state);
-	}
+	}, { transforms });
+	const u32 upload = task_graph_add(graph, "Frame Data Upload", TaskAffinity::MainThread, []()
+	{
+		CPU_TIMING_SCOPE("Frame Data Upload");
+		upload_render_object_snapshot(state);
+		upload_lights(state);
+		skin_matrix_arena_upload(state);
+	}, { snapshot, lights, skin });
+	task_graph_add(graph, "Render", TaskAffinity::MainThread, [in_delta_time]()
+	{
+		RenderSystem::render(state, in_delta_time);
+		automated_screenshot.queue_if_ready(state);
+	}, { upload });
 
-	RenderSystem::render(state, in_delta_time);
-	automated_screenshot.queue_if_ready(state);
+	task_graph_run(graph, RuntimeConfig::get().serial_frame ? TaskGraphDispatch() : jolt_task_graph_dispatch());
+	record_frame_task_timings(graph);
 
 	RenderSystem::end_frame(state);
 	automated_screenshot.after_frame(state);
@@ -182,6 +234,14 @@ void frame(f32 in_delta_time)
 		tonemapping_validation_capture_finished =
 			tonemapping_validation_capture_failed || tonemapping_validation_capture_count == 2;
 	}
+	if (runtime_config.gbuffer_capture
+		&& !gbuffer_validation_capture_finished
+		&& state.vk.frame_number >= runtime_config.screenshot_frame)
+	{
+		gbuffer_validation_capture_failed = !RenderSystem::dump_gbuffer_validation(
+			state, *runtime_config.gbuffer_capture);
+		gbuffer_validation_capture_finished = true;
+	}
 	if (runtime_config.cloud_shadow_validation_capture
 		&& !cloud_shadow_validation_capture_finished
 		&& state.vk.frame_number >= runtime_config.screenshot_frame
@@ -209,9 +269,14 @@ int main(int argc, char** argv)
 		("f,file", "File name", cxxopts::value<std::string>())
 		("p,port", "Live link TCP port", cxxopts::value<std::string>()->default_value("65432"))
 		("no-live-link", "Do not start the live-link server", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+		("live-link-queue-mb", "Undrained live-link update budget before senders are throttled", cxxopts::value<u64>()->default_value("512"))
+		("record-live-link", "Append every received live-link update to a capture file", cxxopts::value<std::string>())
+		("replay-live-link", "Replay a live-link capture instead of listening, then exit with a benchmark", cxxopts::value<std::string>())
+		("replay-max-speed", "Replay captured updates back to back instead of at their recorded times", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
 		("warmup-frames", "Benchmark warmup frame count", cxxopts::value<u64>()->default_value("300"))
 		("benchmark-frames", "Measured frame count; providing this enables benchmark mode", cxxopts::value<u64>())
 		("benchmark-output", "Benchmark JSON output path", cxxopts::value<std::string>()->default_value("benchmark.json"))
+		("benchmark-startup", "Time a cold startup and a warm pipeline rebuild, write them to --benchmark-output and exit", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
 		("fullscreen", "Use the primary monitor in fullscreen mode", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
 	;
 
@@ -226,7 +291,17 @@ int main(int argc, char** argv)
 		state.runtime.init_file = args["f"].as<std::string>();
 	}
 	state.live_link.port = args["port"].as<std::string>();
-	const bool no_live_link = args["no-live-link"].as<bool>();
+	state.live_link.queue_budget_bytes = args["live-link-queue-mb"].as<u64>() * 1024 * 1024;
+	if (args.count("record-live-link") > 0)
+	{
+		state.live_link.record_path = args["record-live-link"].as<std::string>();
+	}
+	// A replay owns the scene: no socket thread, so nothing else interleaves
+	const optional<std::string> replay_path = args.count("replay-live-link") > 0
+		? optional<std::string>(args["replay-live-link"].as<std::string>())
+		: std::nullopt;
+	const bool benchmark_startup = args["benchmark-startup"].as<bool>();
+	const bool no_live_link = args["no-live-link"].as<bool>() || replay_path.has_value() || benchmark_startup;
 	const bool fullscreen = args["fullscreen"].as<bool>();
 	BenchmarkState benchmark;
 	if (args.count("benchmark-frames") > 0)
@@ -238,6 +313,19 @@ int main(int argc, char** argv)
 		);
 		state.debug_ui.visible = false;
 	}
+	else if (replay_path)
+	{
+		// Without a frame count the replay decides when the run ends
+		benchmark.configure_open_ended(
+			args.count("warmup-frames") > 0 ? args["warmup-frames"].as<u64>() : 0,
+			args["benchmark-output"].as<std::string>()
+		);
+		state.debug_ui.visible = false;
+	}
+	if (replay_path && !LiveLinkSystem::load_replay(state, *replay_path, args["replay-max-speed"].as<bool>()))
+	{
+		return 1;
+	}
 
 	InputSystem::install_error_callback();
 	if (!glfwInit())
@@ -280,13 +368,30 @@ int main(int argc, char** argv)
 	InputSystem::install_callbacks(window);
 
 	jolt_init();
+	// Culling, skin packing, live-link decode and pipeline builds fan out on
+	// Jolt's workers too, instead of starting thread pools of their own
+	worker_pool_share(jolt_task_graph_dispatch(), (i32) jolt_job_system().GetMaxConcurrency() - 1);
 
 	RuntimeStateOverrides::apply(state);
 
+	if (benchmark_startup)
+	{
+		// Cold: ignore the saved pipeline cache and keep the startup jobs so
+		// they can be rebuilt warm afterwards
+		state.vk.pipeline_cache_cold_start = true;
+		PipelineBuildService::record_jobs = true;
+	}
+	const f64 init_start_time = glfwGetTime();
 	RenderSystem::initialize(state, window);
+	const f64 init_ms = (glfwGetTime() - init_start_time) * 1000.0;
+	if (benchmark_startup)
+	{
+		benchmark_startup_finalize(&state.vk, init_ms, args["benchmark-output"].as<std::string>());
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	}
 
 	// If an init file was provided, load it as a FlatBuffer Update on startup.
-	if (state.runtime.init_file)
+	if (state.runtime.init_file && !benchmark_startup)
 	{
 		LiveLinkSystem::load_initial_file(state, *state.runtime.init_file);
 	}
@@ -299,7 +404,7 @@ int main(int argc, char** argv)
 	}
 
 	f64 last_frame_time = glfwGetTime();
-	benchmark.begin(&state.vk);
+	benchmark.begin(&state.vk, state.render_objects.store.counters);
 
 	while (!glfwWindowShouldClose(window))
 	{
@@ -318,16 +423,20 @@ int main(int argc, char** argv)
 		const f64 frame_start_time = glfwGetTime();
 		frame(delta_time);
 		const f64 frame_end_time = glfwGetTime();
-		benchmark.after_frame((frame_end_time - frame_start_time) * 1000.0, &state.vk);
+		benchmark.after_frame((frame_end_time - frame_start_time) * 1000.0, &state.vk, state.render_objects.store.counters);
 		if (benchmark.should_exit())
 		{
 			glfwSetWindowShouldClose(window, GLFW_TRUE);
 		}
+		if (benchmark.open_ended && state.live_link.replay.finished)
+		{
+			glfwSetWindowShouldClose(window, GLFW_TRUE);
+		}
 		if (automated_screenshot.finished())
 		{
 			glfwSetWindowShouldClose(window, GLFW_TRUE);
 		}
-		if (tonemapping_validation_capture_finished)
+		if (tonemapping_validation_capture_finished || gbuffer_validation_capture_finished)
 		{
 			glfwSetWindowShouldClose(window, GLFW_TRUE);
 		}
@@ -336,7 +445,20 @@ int main(int argc, char** argv)
 	{
 		automated_screenshot.fail("window closed before capture completed");
 	}
-	benchmark_finalize(benchmark, &state.vk);
+	if (replay_path)
+	{
+		const LiveLinkReplay& replay = state.live_link.replay;
+		benchmark.live_link_replay = {
+			.enabled = true,
+			.update_count = replay.parse_ms.length(),
+			.byte_count = replay.byte_count,
+			.wall_seconds = replay.wall_seconds,
+			.parse_ms = replay.parse_ms,
+			.drain_ms = replay.drain_ms,
+		};
+	}
+	benchmark_finalize(benchmark, &state.vk, state.live_link.content_cache.counters, state.render_objects.store.counters,
+		state.images.streaming);
 
 	// Tell the Live Link thread we're done and wait for it to complete.
 	if (!no_live_link)
@@ -357,5 +479,6 @@ int main(int argc, char** argv)
 
 	glfwDestroyWindow(window);
 	glfwTerminate();
-	return automated_screenshot.failed() || tonemapping_validation_capture_failed ? 1 : 0;
+	return automated_screenshot.failed() || tonemapping_validation_capture_failed
+		|| gbuffer_validation_capture_failed ? 1 : 0;
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdio>
+#include <cstdlib>
+
+#include "core/types.h"
 
 #if defined(_WIN32)
 #define SOCKET_PLATFORM_WINDOWS 
@@ -8,7 +12,7 @@
 #if defined(SOCKET_PLATFORM_WINDOWS)
 	/* See http://stackoverflow.com/questions/12765743/getaddrinfo-on-win32 */
 	#ifndef _WIN32_WINNT
-	  #define _WIN32_WINNT 0x0501  /* Windows XP. */
+	  #define _WIN32_WINNT 0x0600  /* Windows Vista, for WSAPoll. */
 	#endif
 	#include <winsock2.h>
 	#include <Ws2tcpip.h>
@@ -23,20 +27,17 @@
 	#include <cerrno>
 	#include <fcntl.h>
 	#include <netdb.h>  /* Needed for getaddrinfo() and freeaddrinfo() */
+	#include <poll.h>
 	#include <unistd.h> /* Needed for close() */
 	typedef int SOCKET;
 	#define INVALID_SOCKET -1
 #endif
 
-#define SOCKET_OP(f) \
-{\
-	int result = (f);\
-	if (result != 0)\
-	{\
-		printf("Line %i error on %s: %i\n", __LINE__, #f, errno);\
-		exit(0);\
-	}\
-}
+#if defined(SOCKET_PLATFORM_WINDOWS)
+	typedef WSAPOLLFD SocketPollFd;
+#else
+	typedef struct pollfd SocketPollFd;
+#endif
 
 int socket_lib_init(void)
 {
@@ -57,33 +58,63 @@ int socket_lib_quit(void)
 #endif
 }
 
-SOCKET socket_open(int domain, int type, int protocol)
+void socket_set_nonblocking(SOCKET in_socket)
 {
-	SOCKET new_socket = socket(domain, type, protocol);
-
 #if defined(SOCKET_PLATFORM_WINDOWS)
 	// Change IO mode of socket to nonblocking (mode == 1)
 	u_long mode_nonblocking = 1;
-	ioctlsocket(new_socket, FIONBIO, &mode_nonblocking);
+	ioctlsocket(in_socket, FIONBIO, &mode_nonblocking);
 #else
 	// Add O_NONBLOCK flag to file descriptor
-	int flags = fcntl(new_socket, F_GETFL, 0);
-	fcntl(new_socket, F_SETFL, flags | O_NONBLOCK);
+	int flags = fcntl(in_socket, F_GETFL, 0);
+	fcntl(in_socket, F_SETFL, flags | O_NONBLOCK);
 #endif
+}
 
+SOCKET socket_open(int domain, int type, int protocol)
+{
+	SOCKET new_socket = socket(domain, type, protocol);
+	socket_set_nonblocking(new_socket);
 	return new_socket;
 }
 
+// Accepts one pending connection as a nonblocking socket (accepted sockets
+// do not inherit O_NONBLOCK everywhere). Invalid when none is pending.
+SOCKET socket_accept(SOCKET in_listen_socket)
+{
+	struct sockaddr_storage their_addr;
+	socklen_t addr_size = sizeof their_addr;
+	SOCKET accepted = accept(in_listen_socket, (struct sockaddr*) &their_addr, &addr_size);
+	if (accepted != INVALID_SOCKET)
+	{
+		socket_set_nonblocking(accepted);
+	}
+	return accepted;
+}
+
+// Waits up to in_timeout_ms for events on in_fds. Returns the number of
+// ready entries, 0 on timeout, or a negative value on error.
+int socket_poll(SocketPollFd* in_fds, u32 in_count, i32 in_timeout_ms)
+{
+#if defined(SOCKET_PLATFORM_WINDOWS)
+	return WSAPoll(in_fds, (ULONG) in_count, in_timeout_ms);
+#else
+	return poll(in_fds, (nfds_t) in_count, in_timeout_ms);
+#endif
+}
+
 int socket_close(SOCKET sock)
 {
   int status = 0;
 
 #if defined(SOCKET_PLATFORM_WINDOWS)
-    status = shutdown(sock, SD_BOTH);
-    if (status == 0) { status = closesocket(sock); }
+    shutdown(sock, SD_BOTH);
+    status = closesocket(sock);
 #else
-    status = shutdown(sock, SHUT_RDWR);
-    if (status == 0) { status = close(sock); }
+    // shutdown fails on a peer that already reset; close regardless so the
+    // descriptor is never leaked
+    shutdown(sock, SHUT_RDWR);
+    status = close(sock);
 #endif
 
   return status;
@@ -99,12 +130,15 @@ bool socket_is_valid(SOCKET sock)
 	return sock != INVALID_SOCKET;
 }
 
-size_t socket_recv(SOCKET in_socket, void* in_buffer, size_t in_len, int in_flags)
+// Returns the byte count, 0 on orderly shutdown, or a negative value on error
+i64 socket_recv(SOCKET in_socket, void* in_buffer, size_t in_len, int in_flags)
 {
 #if defined(SOCKET_PLATFORM_WINDOWS)
-	return recv(in_socket, (char*) in_buffer, in_len, in_flags);
+	// Winsock takes an int length; larger requests are split by the caller's loop
+	const int len = (int) MIN(in_len, (size_t) 0x7FFFFFFF);
+	return recv(in_socket, (char*) in_buffer, len, in_flags);
 #else
-	return recv(in_socket, in_buffer, in_len, in_flags);
+	return (i64) recv(in_socket, in_buffer, in_len, in_flags);
 #endif
 }
 
@@ -119,15 +153,16 @@ void socket_set_recv_timeout(SOCKET in_socket, const struct timeval& in_timeval)
 	#endif
 }
 
-void socket_set_reuse_addr_and_port(SOCKET in_socket, bool in_enable)
+// Returns false (the caller may carry on without reuse) if an option failed
+bool socket_set_reuse_addr_and_port(SOCKET in_socket, bool in_enable)
 {
 	int optval = in_enable ? 1 : 0;
 	
 	#if defined(SOCKET_PLATFORM_WINDOWS)
-		SOCKET_OP(setsockopt(in_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&optval, sizeof(optval)));
+		return setsockopt(in_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&optval, sizeof(optval)) == 0;
 	#else
-		SOCKET_OP(setsockopt(in_socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)));
-		SOCKET_OP(setsockopt(in_socket, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)));
+		return setsockopt(in_socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) == 0
+			&& setsockopt(in_socket, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) == 0;
 	#endif
 }
 
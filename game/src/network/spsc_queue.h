@@ -0,0 +1,185 @@
+#pragma once
+
+#include "core/types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+// ---- Single-producer / single-consumer ring ----
+// Bounded, lock-free handoff between exactly one producing and one consuming
+// thread (the two may be the same thread, as when the main thread parses an
+// init file or a replay and drains it). Values are moved into a slot once
+// and moved out once. No lock is held while a large value moves, and the
+// storage never grows or compacts.
+//
+// head is written only by the consumer and tail only by the producer. They
+// sit on separate cache lines, next to each side's cached copy of the other
+// index, so the two threads only share a line when the ring looks full or
+// empty to them.
+
+static constexpr size_t SPSC_QUEUE_CACHE_LINE_BYTES = 64;
+static constexpr size_t SPSC_QUEUE_DEFAULT_CAPACITY = 64;
+
+template <typename T>
+struct SpscQueue
+{
+public:
+	// in_capacity is rounded up to a power of two
+	explicit SpscQueue(size_t in_capacity = SPSC_QUEUE_DEFAULT_CAPACITY)
+	{
+		size_t capacity = 1;
+		while (capacity < in_capacity)
+		{
+			capacity <<= 1;
+		}
+		slots = new Slot[capacity];
+		mask = capacity - 1;
+	}
+
+	~SpscQueue()
+	{
+		while (try_pop()) {}
+		delete[] slots;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer. Returns false, leaving in_value untouched, when the ring is full.
+	bool try_push(T&& in_value)
+	{
+		const size_t current_tail = tail.load(std::memory_order_relaxed);
+		if (current_tail - producer_cached_head > mask)
+		{
+			producer_cached_head = head.load(std::memory_order_acquire);
+			if (current_tail - producer_cached_head > mask)
+			{
+				return false;
+			}
+		}
+		new (slots[current_tail & mask].storage) T(std::move(in_value));
+		tail.store(current_tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer. Waits while the ring is full. Gives up, returning false, once
+	// in_keep_waiting turns false (e.g. at shutdown, when nobody will drain).
+	bool push(T&& in_value, const std::atomic<bool>& in_keep_waiting)
+	{
+		if (try_push(std::move(in_value)))
+		{
+			return true;
+		}
+		const auto wait_start = std::chrono::steady_clock::now();
+		bool pushed = false;
+		for (u32 attempt = 0; in_keep_waiting.load(std::memory_order_relaxed); ++attempt)
+		{
+			if (try_push(std::move(in_value)))
+			{
+				pushed = true;
+				break;
+			}
+			backoff(attempt);
+		}
+		producer_wait_ns.fetch_add(elapsed_ns(wait_start), std::memory_order_relaxed);
+		return pushed;
+	}
+
+	// Consumer
+	std::optional<T> try_pop()
+	{
+		const size_t current_head = head.load(std::memory_order_relaxed);
+		if (current_head == consumer_cached_tail)
+		{
+			consumer_cached_tail = tail.load(std::memory_order_acquire);
+			if (current_head == consumer_cached_tail)
+			{
+				return std::nullopt;
+			}
+		}
+		T* value = slots[current_head & mask].value();
+		std::optional<T> out_value(std::move(*value));
+		value->~T();
+		head.store(current_head + 1, std::memory_order_release);
+		return out_value;
+	}
+
+	// Consumer. Waits for a value; returns nullopt once in_keep_waiting turns false.
+	std::optional<T> pop(const std::atomic<bool>& in_keep_waiting)
+	{
+		if (std::optional<T> value = try_pop())
+		{
+			return value;
+		}
+		const auto wait_start = std::chrono::steady_clock::now();
+		std::optional<T> out_value;
+		for (u32 attempt = 0; in_keep_waiting.load(std::memory_order_relaxed); ++attempt)
+		{
+			out_value = try_pop();
+			if (out_value)
+			{
+				break;
+			}
+			backoff(attempt);
+		}
+		consumer_wait_ns.fetch_add(elapsed_ns(wait_start), std::memory_order_relaxed);
+		return out_value;
+	}
+
+	// Exact on either side when the other side is idle, a snapshot otherwise
+	size_t size_approx() const
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const { return mask + 1; }
+
+	// Total time push / pop spent waiting on a full / empty ring
+	u64 total_producer_wait_ns() const { return producer_wait_ns.load(std::memory_order_relaxed); }
+	u64 total_consumer_wait_ns() const { return consumer_wait_ns.load(std::memory_order_relaxed); }
+
+protected:
+	struct Slot
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+	};
+
+	// Spin briefly, then yield, then sleep so a long wait costs no CPU
+	static void backoff(u32 in_attempt)
+	{
+		if (in_attempt < 64)
+		{
+			return;
+		}
+		if (in_attempt < 256)
+		{
+			std::this_thread::yield();
+			return;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+
+	static u64 elapsed_ns(std::chrono::steady_clock::time_point in_start)
+	{
+		return (u64) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - in_start).count();
+	}
+
+	Slot* slots = nullptr;
+	size_t mask = 0;
+
+	alignas(SPSC_QUEUE_CACHE_LINE_BYTES) std::atomic<size_t> head = 0;	// next slot to pop
+	size_t consumer_cached_tail = 0;
+
+	alignas(SPSC_QUEUE_CACHE_LINE_BYTES) std::atomic<size_t> tail = 0;	// next slot to fill
+	size_t producer_cached_head = 0;
+
+	alignas(SPSC_QUEUE_CACHE_LINE_BYTES) std::atomic<u64> producer_wait_ns = 0;
+	std::atomic<u64> consumer_wait_ns = 0;
+};
@@ -2,6 +2,7 @@
 
 // Basic Types
 #include "core/types.h"
+#include "core/task_graph.h"
 
 // cstdlib stdarg.h
 #include <cstdarg> 
@@ -219,6 +220,29 @@ void jolt_init()
 	jolt_state.physics_system.SetGravity(JPH::Vec3(0,0,-10));
 }
 
+// Jolt's worker threads. The frame task graph runs its any-thread tasks
+// here too (jolt_task_graph_dispatch), and WorkerPool loops queue their
+// helpers here (worker_pool_share), so physics and frame work share one set
+// of workers instead of oversubscribing the cores.
+JPH::JobSystemThreadPool& jolt_job_system()
+{
+	static JPH::JobSystemThreadPool job_system(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, JPH::thread::hardware_concurrency() - 1);
+	return job_system;
+}
+
+// Queues task graph work on the Jolt job system. Empty when the pool has no
+// threads of its own: its jobs would only run inside a barrier wait, so the
+// graph runs everything on the main thread instead.
+const TaskGraphDispatch& jolt_task_graph_dispatch()
+{
+	static const TaskGraphDispatch dispatch = [](const char* in_name, const TaskGraphFunction& in_function)
+	{
+		jolt_job_system().CreateJob(in_name, JPH::Color::sGrey, in_function);
+	};
+	static const TaskGraphDispatch serial;
+	return jolt_job_system().GetMaxConcurrency() > 1 ? dispatch : serial;
+}
+
 void jolt_update(float in_delta_time)
 {
 	/* 	If you take larger steps than 1 / 60th of a second you need to do multiple collision steps in order to 
@@ -228,10 +252,8 @@ void jolt_update(float in_delta_time)
 	// FCS TODO: store this? Use a real allocator?
     static JPH::TempAllocatorImpl temp_allocator(10 * 1024 * 1024);
 
-	static JPH::JobSystemThreadPool job_system(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, JPH::thread::hardware_concurrency() - 1);
-
 	// Step the world
-	jolt_state.physics_system.Update(in_delta_time, num_collision_steps, &temp_allocator, &job_system);
+	jolt_state.physics_system.Update(in_delta_time, num_collision_steps, &temp_allocator, &jolt_job_system());
 }
 
 void jolt_shutdown()
@@ -261,21 +261,21 @@ namespace BloomPass
 		VK_CHECK(vkCreatePipelineLayout(
 			ctx->device, &pipeline_layout_info, nullptr, &bloom_pass.pipeline_layout));
 
-		bloom_pass.downsample_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/bloom.vert.spv",
 			.fragment_shader_path = "bin/shaders/bloom_downsample.frag.spv",
 			.pipeline_layout = bloom_pass.pipeline_layout,
 			.color_formats = &Render::SCENE_COLOR_FORMAT,
 			.color_format_count = 1,
-		});
-		bloom_pass.upsample_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		}, &bloom_pass.downsample_pipeline);
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/bloom.vert.spv",
 			.fragment_shader_path = "bin/shaders/bloom_upsample.frag.spv",
 			.pipeline_layout = bloom_pass.pipeline_layout,
 			.color_formats = &Render::SCENE_COLOR_FORMAT,
 			.color_format_count = 1,
 			.additive_blending = true,
-		});
+		}, &bloom_pass.upsample_pipeline);
 	}
 
 	inline void release_image(VulkanContext* ctx)
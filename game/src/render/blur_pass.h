@@ -46,13 +46,13 @@ namespace BlurPass
 		};
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_create_info, nullptr, &pipeline_layout));
 
-		pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/blur.vert.spv",
 			.fragment_shader_path = "bin/shaders/blur.frag.spv",
 			.pipeline_layout = pipeline_layout,
 			.color_formats = &pipeline_format,
 			.color_format_count = 1,
-		});
+		}, &pipeline);
 	}
 
 	inline void draw_blur(VulkanContext* ctx, VkDescriptorSet in_input_set, HMM_Vec2 in_screen_size, HMM_Vec2 in_direction, i32 in_blur_size)
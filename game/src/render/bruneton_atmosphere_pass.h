@@ -190,22 +190,22 @@ struct BrunetonAtmospherePass
 		const VkFormat one_format[] = { BRUNETON_LUT_FORMAT };
 		const VkFormat two_formats[] = { BRUNETON_LUT_FORMAT, BRUNETON_LUT_FORMAT };
 		const VkFormat three_formats[] = { BRUNETON_LUT_FORMAT, BRUNETON_LUT_FORMAT, BRUNETON_LUT_FORMAT };
-		auto create_pipeline = [&](const char* shader, const VkFormat* formats, u32 count, u32 additive_mask = 0) {
-			return vulkan_create_fullscreen_pipeline(ctx, {
+		auto create_pipeline = [&](VkPipeline* out_pipeline, const char* shader, const VkFormat* formats, u32 count, u32 additive_mask = 0) {
+			vulkan_create_fullscreen_pipeline(ctx, {
 				.vertex_shader_path = "bin/shaders/bruneton_precompute.vert.spv",
 				.fragment_shader_path = shader,
 				.pipeline_layout = pipeline_layout,
 				.color_formats = formats,
 				.color_format_count = count,
 				.additive_blend_mask = additive_mask,
-			});
+			}, out_pipeline);
 		};
-		transmittance_pipeline = create_pipeline("bin/shaders/bruneton_transmittance.frag.spv", one_format, 1);
-		direct_irradiance_pipeline = create_pipeline("bin/shaders/bruneton_direct_irradiance.frag.spv", two_formats, 2);
-		single_scattering_pipeline = create_pipeline("bin/shaders/bruneton_single_scattering.frag.spv", three_formats, 3);
-		scattering_density_pipeline = create_pipeline("bin/shaders/bruneton_scattering_density.frag.spv", one_format, 1);
-		indirect_irradiance_pipeline = create_pipeline("bin/shaders/bruneton_indirect_irradiance.frag.spv", two_formats, 2, 1u << 1);
-		multiple_scattering_pipeline = create_pipeline("bin/shaders/bruneton_multiple_scattering.frag.spv", three_formats, 3, 1u << 2);
+		create_pipeline(&transmittance_pipeline, "bin/shaders/bruneton_transmittance.frag.spv", one_format, 1);
+		create_pipeline(&direct_irradiance_pipeline, "bin/shaders/bruneton_direct_irradiance.frag.spv", two_formats, 2);
+		create_pipeline(&single_scattering_pipeline, "bin/shaders/bruneton_single_scattering.frag.spv", three_formats, 3);
+		create_pipeline(&scattering_density_pipeline, "bin/shaders/bruneton_scattering_density.frag.spv", one_format, 1);
+		create_pipeline(&indirect_irradiance_pipeline, "bin/shaders/bruneton_indirect_irradiance.frag.spv", two_formats, 2, 1u << 1);
+		create_pipeline(&multiple_scattering_pipeline, "bin/shaders/bruneton_multiple_scattering.frag.spv", three_formats, 3, 1u << 2);
 	}
 
 	void update(VulkanContext* ctx, const SkyAtmosphere& sky)
@@ -202,30 +202,30 @@ namespace CloudPass
 		const VkFormat pair_formats[] = { Render::SCENE_COLOR_FORMAT, Render::SCENE_COLOR_FORMAT };
 		const VkFormat triple_formats[] = { Render::SCENE_COLOR_FORMAT, Render::SCENE_COLOR_FORMAT, Render::SCENE_COLOR_FORMAT };
 		const VkFormat shadow_format = VK_FORMAT_R16_SFLOAT;
-		pass.raymarch_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/cloud_raymarch.vert.spv",
 			.fragment_shader_path = "bin/shaders/cloud_raymarch.frag.spv",
 			.pipeline_layout = pass.atmosphere_pipeline_layout,
 			.color_formats = pair_formats, .color_format_count = 2,
-		});
-		pass.temporal_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		}, &pass.raymarch_pipeline);
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/cloud_temporal.vert.spv",
 			.fragment_shader_path = "bin/shaders/cloud_temporal.frag.spv",
 			.pipeline_layout = pass.basic_pipeline_layout,
 			.color_formats = pair_formats, .color_format_count = 2,
-		});
-		pass.composite_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		}, &pass.temporal_pipeline);
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/cloud_composite.vert.spv",
 			.fragment_shader_path = "bin/shaders/cloud_composite.frag.spv",
 			.pipeline_layout = pass.atmosphere_pipeline_layout,
 			.color_formats = triple_formats, .color_format_count = 3,
-		});
-		pass.shadow_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		}, &pass.composite_pipeline);
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/cloud_shadow.vert.spv",
 			.fragment_shader_path = "bin/shaders/cloud_shadow.frag.spv",
 			.pipeline_layout = pass.basic_pipeline_layout,
 			.color_formats = &shadow_format, .color_format_count = 1,
-		});
+		}, &pass.shadow_pipeline);
 	}
 
 	inline void generate_caches(VulkanContext* ctx, u32 seed, i32 layer_count)
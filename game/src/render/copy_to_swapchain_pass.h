@@ -3,7 +3,7 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
 
 // First upscales scene color into a full-resolution float composite target,
@@ -29,8 +29,8 @@ static CopyToSwapchainPass copy_to_swapchain_pass;
 
 void copy_to_swapchain_pass_init(VulkanContext* ctx)
 {
-	VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, "bin/shaders/copy_to_swapchain.vert.spv");
-	VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/copy_to_swapchain.frag.spv");
+	VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, "bin/shaders/copy_to_swapchain.vert.spv");
+	VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, "bin/shaders/copy_to_swapchain.frag.spv");
 
 	VkPipelineShaderStageCreateInfo shader_stages[] = {
 		{
@@ -149,12 +149,9 @@ void copy_to_swapchain_pass_init(VulkanContext* ctx)
 		.renderPass = VK_NULL_HANDLE,
 	};
 
-	VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &copy_to_swapchain_pass.presentation_pipeline));
+	PipelineBuildService::graphics(ctx, pipeline_create_info, &copy_to_swapchain_pass.presentation_pipeline);
 	output_format = ctx->surface_format.format;
-	VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &copy_to_swapchain_pass.swapchain_pipeline));
-
-	vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-	vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
+	PipelineBuildService::graphics(ctx, pipeline_create_info, &copy_to_swapchain_pass.swapchain_pipeline);
 }
 
 void copy_to_swapchain_pass_update_presentation_input(VulkanContext* ctx, VkImageView in_view)
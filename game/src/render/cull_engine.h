@@ -0,0 +1,770 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "core/worker_pool.h"
+
+// ---- Cull engine ----
+// Frustum and influence-sphere culling over structure-of-arrays bounds,
+// independent of State so it can be tested and benchmarked on its own.
+// Slots (render-object store slots) are kept in one of three places:
+//  - BVH: slots whose bounds have not changed for CULL_STATIC_AFTER_SYNCS
+//    syncs. Each leaf is one lane block. A node outside the view drops its
+//    subtree and a node fully inside accepts it without per-box tests. A
+//    slot that moves after the build is refit in place.
+//  - dynamic list: new or recently moved slots in a flat padded list,
+//    tested one lane block at a time.
+//  - always visible: skinned meshes without valid pose bounds.
+// Block tests are fixed-width loops over CULL_LANE_COUNT floats, which the
+// compiler turns into SSE/AVX or NEON without per-target intrinsics. Large
+// views are split across a WorkerPool, and per-task outputs are appended in
+// task order so results do not depend on scheduling.
+// cull_box_reference is the scalar definition the engine must agree with.
+
+static constexpr i32 CULL_LANE_COUNT = 8;
+static constexpr u64 CULL_STATIC_AFTER_SYNCS = 60;
+static constexpr i32 CULL_REBUILD_MIN_CHANGES = 64;
+static constexpr i32 CULL_PARALLEL_MIN_ENTRIES = 16384;
+static constexpr i32 CULL_PARALLEL_TASK_BLOCKS = 256;	// lane blocks per dynamic-list task
+
+// Per-slot flags, kept beside the slot bounds
+enum CullSlotFlags : u8
+{
+	CULL_SLOT_LIVE = 1 << 0,
+	CULL_SLOT_ALWAYS_VISIBLE = 1 << 1,
+};
+
+struct CullBounds
+{
+	DynamicArray<f32> min_x;
+	DynamicArray<f32> min_y;
+	DynamicArray<f32> min_z;
+	DynamicArray<f32> max_x;
+	DynamicArray<f32> max_y;
+	DynamicArray<f32> max_z;
+};
+
+inline size_t cull_bounds_length(const CullBounds& in_bounds)
+{
+	return in_bounds.min_x.length();
+}
+
+inline void cull_bounds_add(CullBounds& in_bounds, const BoundingBox& in_box)
+{
+	in_bounds.min_x.add(in_box.min.X);
+	in_bounds.min_y.add(in_box.min.Y);
+	in_bounds.min_z.add(in_box.min.Z);
+	in_bounds.max_x.add(in_box.max.X);
+	in_bounds.max_y.add(in_box.max.Y);
+	in_bounds.max_z.add(in_box.max.Z);
+}
+
+inline void cull_bounds_set(CullBounds& in_bounds, size_t in_index, const BoundingBox& in_box)
+{
+	in_bounds.min_x[in_index] = in_box.min.X;
+	in_bounds.min_y[in_index] = in_box.min.Y;
+	in_bounds.min_z[in_index] = in_box.min.Z;
+	in_bounds.max_x[in_index] = in_box.max.X;
+	in_bounds.max_y[in_index] = in_box.max.Y;
+	in_bounds.max_z[in_index] = in_box.max.Z;
+}
+
+inline BoundingBox cull_bounds_get(const CullBounds& in_bounds, size_t in_index)
+{
+	return {
+		.min = HMM_V3(in_bounds.min_x[in_index], in_bounds.min_y[in_index], in_bounds.min_z[in_index]),
+		.max = HMM_V3(in_bounds.max_x[in_index], in_bounds.max_y[in_index], in_bounds.max_z[in_index]),
+	};
+}
+
+inline bool cull_bounds_equal(const CullBounds& in_bounds, size_t in_index, const BoundingBox& in_box)
+{
+	return in_bounds.min_x[in_index] == in_box.min.X && in_bounds.min_y[in_index] == in_box.min.Y
+		&& in_bounds.min_z[in_index] == in_box.min.Z && in_bounds.max_x[in_index] == in_box.max.X
+		&& in_bounds.max_y[in_index] == in_box.max.Y && in_bounds.max_z[in_index] == in_box.max.Z;
+}
+
+inline void cull_bounds_clear(CullBounds& in_bounds)
+{
+	in_bounds.min_x.clear();
+	in_bounds.min_y.clear();
+	in_bounds.min_z.clear();
+	in_bounds.max_x.clear();
+	in_bounds.max_y.clear();
+	in_bounds.max_z.clear();
+}
+
+struct CullView
+{
+	Frustum frustum = {};
+	f32 bounds_padding = 0.0f;	// grows every box; ignored when <= 0
+	const BoundingSphere* influence_sphere = nullptr;
+};
+
+enum class ECullBoxResult : u8
+{
+	Visible,
+	InfluenceCulled,
+	FrustumCulled,
+};
+
+// Scalar reference: one box through the padding, sphere and plane tests
+// cull_objects has always applied
+inline ECullBoxResult cull_box_reference(const CullView& in_view, BoundingBox in_box)
+{
+	if (in_view.bounds_padding > 0.0f)
+	{
+		const HMM_Vec3 padding = HMM_V3(in_view.bounds_padding, in_view.bounds_padding, in_view.bounds_padding);
+		in_box.min -= padding;
+		in_box.max += padding;
+	}
+
+	if (in_view.influence_sphere != nullptr && bounding_box_outside_sphere(in_box, *in_view.influence_sphere))
+	{
+		return ECullBoxResult::InfluenceCulled;
+	}
+
+	if (frustum_cull(in_view.frustum, in_box))
+	{
+		return ECullBoxResult::FrustumCulled;
+	}
+
+	return ECullBoxResult::Visible;
+}
+
+// Tests the CULL_LANE_COUNT boxes starting at in_first with the reference's
+// arithmetic. Returns the mask of lanes that survive; out_influence_mask
+// receives the lanes rejected by the influence sphere.
+inline u32 cull_test_block(const CullView& in_view, const CullBounds& in_bounds, size_t in_first, u32& out_influence_mask)
+{
+	const f32 padding = MAX(in_view.bounds_padding, 0.0f);
+	const f32* min_x = in_bounds.min_x.data() + in_first;
+	const f32* min_y = in_bounds.min_y.data() + in_first;
+	const f32* min_z = in_bounds.min_z.data() + in_first;
+	const f32* max_x = in_bounds.max_x.data() + in_first;
+	const f32* max_y = in_bounds.max_y.data() + in_first;
+	const f32* max_z = in_bounds.max_z.data() + in_first;
+
+	i32 outside[CULL_LANE_COUNT] = {};
+	i32 influence_outside[CULL_LANE_COUNT] = {};
+
+	if (in_view.influence_sphere != nullptr)
+	{
+		const HMM_Vec3 center = in_view.influence_sphere->center;
+		const f32 radius = MAX(in_view.influence_sphere->radius, 0.0f);
+		const f32 radius_sq = radius * radius;
+		for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+		{
+			const f32 dx = CLAMP(center.X, min_x[lane] - padding, max_x[lane] + padding) - center.X;
+			const f32 dy = CLAMP(center.Y, min_y[lane] - padding, max_y[lane] + padding) - center.Y;
+			const f32 dz = CLAMP(center.Z, min_z[lane] - padding, max_z[lane] + padding) - center.Z;
+			influence_outside[lane] = (dx * dx) + (dy * dy) + (dz * dz) > radius_sq;
+		}
+	}
+
+	for (const HMM_Vec4& plane : in_view.frustum.planes)
+	{
+		// The positive vertex takes the same column in every lane
+		const f32* px = plane.X >= 0 ? max_x : min_x;
+		const f32* py = plane.Y >= 0 ? max_y : min_y;
+		const f32* pz = plane.Z >= 0 ? max_z : min_z;
+		const f32 pad_x = plane.X >= 0 ? padding : -padding;
+		const f32 pad_y = plane.Y >= 0 ? padding : -padding;
+		const f32 pad_z = plane.Z >= 0 ? padding : -padding;
+		for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+		{
+			const f32 distance = plane.X * (px[lane] + pad_x) + plane.Y * (py[lane] + pad_y) + plane.Z * (pz[lane] + pad_z) + plane.W;
+			outside[lane] |= distance < 0.0f;
+		}
+	}
+
+	u32 visible_mask = 0;
+	out_influence_mask = 0;
+	for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+	{
+		visible_mask |= (u32) (!outside[lane] && !influence_outside[lane]) << lane;
+		out_influence_mask |= (u32) influence_outside[lane] << lane;
+	}
+	return visible_mask;
+}
+
+// -1: the padded box is outside the view, 1: fully inside, 0: straddling
+inline i32 cull_classify_box(const CullView& in_view, const BoundingBox& in_box)
+{
+	const f32 padding = MAX(in_view.bounds_padding, 0.0f);
+	const HMM_Vec3 box_min = in_box.min - HMM_V3(padding, padding, padding);
+	const HMM_Vec3 box_max = in_box.max + HMM_V3(padding, padding, padding);
+
+	bool inside = true;
+	if (in_view.influence_sphere != nullptr)
+	{
+		const HMM_Vec3 center = in_view.influence_sphere->center;
+		const f32 radius = MAX(in_view.influence_sphere->radius, 0.0f);
+		const HMM_Vec3 closest = HMM_V3(
+			CLAMP(center.X, box_min.X, box_max.X),
+			CLAMP(center.Y, box_min.Y, box_max.Y),
+			CLAMP(center.Z, box_min.Z, box_max.Z));
+		if (HMM_LenSqrV3(closest - center) > radius * radius)
+		{
+			return -1;
+		}
+		const HMM_Vec3 farthest = HMM_V3(
+			MAX(center.X - box_min.X, box_max.X - center.X),
+			MAX(center.Y - box_min.Y, box_max.Y - center.Y),
+			MAX(center.Z - box_min.Z, box_max.Z - center.Z));
+		inside = HMM_LenSqrV3(farthest) <= radius * radius;
+	}
+
+	for (const HMM_Vec4& plane : in_view.frustum.planes)
+	{
+		const HMM_Vec3 positive = HMM_V3(
+			plane.X >= 0 ? box_max.X : box_min.X,
+			plane.Y >= 0 ? box_max.Y : box_min.Y,
+			plane.Z >= 0 ? box_max.Z : box_min.Z);
+		if (plane.X * positive.X + plane.Y * positive.Y + plane.Z * positive.Z + plane.W < 0.0f)
+		{
+			return -1;
+		}
+		const HMM_Vec3 negative = HMM_V3(
+			plane.X >= 0 ? box_min.X : box_max.X,
+			plane.Y >= 0 ? box_min.Y : box_max.Y,
+			plane.Z >= 0 ? box_min.Z : box_max.Z);
+		inside = inside && plane.X * negative.X + plane.Y * negative.Y + plane.Z * negative.Z + plane.W >= 0.0f;
+	}
+	return inside ? 1 : 0;
+}
+
+enum class ECullSlotLocation : u8
+{
+	None,
+	Dynamic,
+	Bvh,
+	AlwaysVisible,
+};
+
+struct CullSlotState
+{
+	ECullSlotLocation location = ECullSlotLocation::None;
+	i32 entry = -1;				// index into the list named by location
+	u64 last_changed_sync = 0;
+};
+
+struct CullBvhNode
+{
+	BoundingBox bounds;
+	i32 left_child = -1;	// the right child is left_child + 1; -1 for leaves
+	i32 first_entry = 0;	// the subtree's entries are one contiguous run of lane blocks
+	i32 entry_count = 0;
+};
+
+// Per-call counts (summed over tasks)
+struct CullEngineCounts
+{
+	i32 influence_cull_count = 0;	// boxes rejected by the sphere in block tests
+	i32 tested_count = 0;			// lanes block-tested, padding included
+	i32 accepted_count = 0;			// boxes accepted by a node fully inside the view
+	i32 node_count = 0;				// BVH nodes classified
+};
+
+struct CullBuildItem
+{
+	HMM_Vec3 center;
+	i32 slot = -1;
+};
+
+struct CullTaskOutput
+{
+	DynamicArray<i32> slots;
+	CullEngineCounts counts;
+};
+
+struct CullEngine
+{
+	DynamicArray<CullSlotState> slots;	// indexed by slot
+	u64 sync_count = 0;
+
+	// Flat list, compact and padded with -1 slots to whole lane blocks
+	CullBounds dynamic_bounds;
+	DynamicArray<i32> dynamic_slots;
+	i32 dynamic_count = 0;
+
+	// BVH entries in leaf order, one lane block per leaf. Released slots
+	// leave a -1 hole until the next rebuild.
+	DynamicArray<CullBvhNode> bvh_nodes;
+	CullBounds bvh_bounds;
+	DynamicArray<i32> bvh_slots;
+	DynamicArray<i32> bvh_task_roots;	// subtrees handed to workers
+	i32 bvh_live_count = 0;
+	i32 bvh_hole_count = 0;
+	i32 bvh_change_count = 0;			// refit moves since the build
+	bool bvh_needs_refit = false;
+
+	DynamicArray<i32> always_visible_slots;
+
+	WorkerPool* workers = nullptr;	// optional; used for large views
+
+	u64 rebuild_count = 0;
+	u64 refit_count = 0;
+
+	// Scratch
+	DynamicArray<CullBuildItem> build_items;
+	DynamicArray<i32> dynamic_rebuild_slots;
+	DynamicArray<CullTaskOutput> task_outputs;
+};
+
+inline void cull_engine_clear(CullEngine& in_engine)
+{
+	in_engine.slots.clear();
+	cull_bounds_clear(in_engine.dynamic_bounds);
+	in_engine.dynamic_slots.clear();
+	in_engine.dynamic_count = 0;
+	in_engine.bvh_nodes.clear();
+	cull_bounds_clear(in_engine.bvh_bounds);
+	in_engine.bvh_slots.clear();
+	in_engine.bvh_task_roots.clear();
+	in_engine.bvh_live_count = 0;
+	in_engine.bvh_hole_count = 0;
+	in_engine.bvh_change_count = 0;
+	in_engine.bvh_needs_refit = false;
+	in_engine.always_visible_slots.clear();
+}
+
+inline void cull_engine_dynamic_add(CullEngine& in_engine, i32 in_slot, const BoundingBox& in_box)
+{
+	if ((size_t) in_engine.dynamic_count == in_engine.dynamic_slots.length())
+	{
+		for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+		{
+			cull_bounds_add(in_engine.dynamic_bounds, {});
+			in_engine.dynamic_slots.add(-1);
+		}
+	}
+	const i32 entry = in_engine.dynamic_count++;
+	cull_bounds_set(in_engine.dynamic_bounds, entry, in_box);
+	in_engine.dynamic_slots[entry] = in_slot;
+	in_engine.slots[in_slot].location = ECullSlotLocation::Dynamic;
+	in_engine.slots[in_slot].entry = entry;
+}
+
+inline void cull_engine_detach(CullEngine& in_engine, i32 in_slot)
+{
+	CullSlotState& state = in_engine.slots[in_slot];
+	switch (state.location)
+	{
+		case ECullSlotLocation::None:
+			return;
+		case ECullSlotLocation::Dynamic:
+		{
+			// Swap-remove keeps the list compact
+			const i32 last_entry = --in_engine.dynamic_count;
+			const i32 moved_slot = in_engine.dynamic_slots[last_entry];
+			if (state.entry != last_entry)
+			{
+				cull_bounds_set(in_engine.dynamic_bounds, state.entry, cull_bounds_get(in_engine.dynamic_bounds, last_entry));
+				in_engine.dynamic_slots[state.entry] = moved_slot;
+				in_engine.slots[moved_slot].entry = state.entry;
+			}
+			in_engine.dynamic_slots[last_entry] = -1;
+			break;
+		}
+		case ECullSlotLocation::Bvh:
+			in_engine.bvh_slots[state.entry] = -1;
+			in_engine.bvh_live_count -= 1;
+			in_engine.bvh_hole_count += 1;
+			break;
+		case ECullSlotLocation::AlwaysVisible:
+		{
+			const i32 moved_slot = in_engine.always_visible_slots.last();
+			in_engine.always_visible_slots[state.entry] = moved_slot;
+			in_engine.slots[moved_slot].entry = state.entry;
+			in_engine.always_visible_slots.pop();
+			break;
+		}
+	}
+	state.location = ECullSlotLocation::None;
+	state.entry = -1;
+}
+
+// Builds the subtree for build_items[in_first, in_first + in_count) into the
+// already-allocated node in_node_index. Splits land on lane-block
+// boundaries so only the last leaf of a run carries padding.
+inline void cull_bvh_build_node(
+	CullEngine& in_engine,
+	const CullBounds& in_slot_bounds,
+	i32 in_node_index,
+	i32 in_first,
+	i32 in_count)
+{
+	CullBuildItem* items = in_engine.build_items.data() + in_first;
+	if (in_count <= CULL_LANE_COUNT)
+	{
+		const i32 first_entry = (i32) in_engine.bvh_slots.length();
+		BoundingBox bounds = bounding_box_init();
+		for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+		{
+			if (lane < in_count)
+			{
+				const i32 slot = items[lane].slot;
+				const BoundingBox box = cull_bounds_get(in_slot_bounds, slot);
+				bounding_box_expand(bounds, box);
+				cull_bounds_add(in_engine.bvh_bounds, box);
+				in_engine.bvh_slots.add(slot);
+				in_engine.slots[slot].location = ECullSlotLocation::Bvh;
+				in_engine.slots[slot].entry = first_entry + lane;
+			}
+			else
+			{
+				cull_bounds_add(in_engine.bvh_bounds, {});
+				in_engine.bvh_slots.add(-1);
+			}
+		}
+		CullBvhNode& node = in_engine.bvh_nodes[in_node_index];
+		node.bounds = bounds;
+		node.first_entry = first_entry;
+		node.entry_count = CULL_LANE_COUNT;
+		return;
+	}
+
+	// Median split of the centers along the widest axis
+	BoundingBox center_bounds = bounding_box_init();
+	for (i32 item_idx = 0; item_idx < in_count; ++item_idx)
+	{
+		bounding_box_expand(center_bounds, items[item_idx].center);
+	}
+	const HMM_Vec3 extent = center_bounds.max - center_bounds.min;
+	const i32 axis = extent.X >= extent.Y && extent.X >= extent.Z ? 0 : (extent.Y >= extent.Z ? 1 : 2);
+	const i32 split = MIN(((in_count / 2 + CULL_LANE_COUNT - 1) / CULL_LANE_COUNT) * CULL_LANE_COUNT, in_count - 1);
+	std::nth_element(items, items + split, items + in_count,
+		[axis](const CullBuildItem& in_a, const CullBuildItem& in_b) { return in_a.center.Elements[axis] < in_b.center.Elements[axis]; });
+
+	const i32 left_child = (i32) in_engine.bvh_nodes.length();
+	in_engine.bvh_nodes.add({});
+	in_engine.bvh_nodes.add({});
+	cull_bvh_build_node(in_engine, in_slot_bounds, left_child, in_first, split);
+	cull_bvh_build_node(in_engine, in_slot_bounds, left_child + 1, in_first + split, in_count - split);
+
+	const CullBvhNode& left = in_engine.bvh_nodes[left_child];
+	const CullBvhNode& right = in_engine.bvh_nodes[left_child + 1];
+	CullBvhNode& node = in_engine.bvh_nodes[in_node_index];
+	node.bounds = left.bounds;
+	bounding_box_expand(node.bounds, right.bounds);
+	node.left_child = left_child;
+	node.first_entry = left.first_entry;
+	node.entry_count = left.entry_count + right.entry_count;
+}
+
+// Recomputes node bounds bottom-up. Children always follow their parent,
+// so a reverse walk visits both children first.
+inline void cull_bvh_refit(CullEngine& in_engine)
+{
+	for (i32 node_idx = (i32) in_engine.bvh_nodes.length() - 1; node_idx >= 0; --node_idx)
+	{
+		CullBvhNode& node = in_engine.bvh_nodes[node_idx];
+		if (node.left_child >= 0)
+		{
+			node.bounds = in_engine.bvh_nodes[node.left_child].bounds;
+			bounding_box_expand(node.bounds, in_engine.bvh_nodes[node.left_child + 1].bounds);
+			continue;
+		}
+
+		// A leaf whose entries were all released keeps its old bounds
+		BoundingBox bounds = bounding_box_init();
+		bool any_live = false;
+		for (i32 entry = node.first_entry; entry < node.first_entry + node.entry_count; ++entry)
+		{
+			if (in_engine.bvh_slots[entry] >= 0)
+			{
+				bounding_box_expand(bounds, cull_bounds_get(in_engine.bvh_bounds, entry));
+				any_live = true;
+			}
+		}
+		if (any_live)
+		{
+			node.bounds = bounds;
+		}
+	}
+	in_engine.bvh_needs_refit = false;
+	in_engine.refit_count += 1;
+}
+
+// Re-sorts every tracked slot: unchanged for CULL_STATIC_AFTER_SYNCS syncs
+// goes into a fresh BVH, the rest into the dynamic list
+inline void cull_engine_rebuild(CullEngine& in_engine, const CullBounds& in_slot_bounds)
+{
+	in_engine.build_items.clear();
+	in_engine.dynamic_rebuild_slots.clear();
+	for (i32 slot = 0; slot < (i32) in_engine.slots.length(); ++slot)
+	{
+		CullSlotState& state = in_engine.slots[slot];
+		if (state.location != ECullSlotLocation::Dynamic && state.location != ECullSlotLocation::Bvh)
+		{
+			continue;
+		}
+		if (in_engine.sync_count - state.last_changed_sync >= CULL_STATIC_AFTER_SYNCS)
+		{
+			const BoundingBox box = cull_bounds_get(in_slot_bounds, slot);
+			in_engine.build_items.add({ .center = (box.min + box.max) * 0.5f, .slot = slot });
+		}
+		else
+		{
+			in_engine.dynamic_rebuild_slots.add(slot);
+		}
+	}
+
+	cull_bounds_clear(in_engine.dynamic_bounds);
+	in_engine.dynamic_slots.clear();
+	in_engine.dynamic_count = 0;
+	for (i32 slot : in_engine.dynamic_rebuild_slots)
+	{
+		cull_engine_dynamic_add(in_engine, slot, cull_bounds_get(in_slot_bounds, slot));
+	}
+
+	in_engine.bvh_nodes.clear();
+	cull_bounds_clear(in_engine.bvh_bounds);
+	in_engine.bvh_slots.clear();
+	in_engine.bvh_task_roots.clear();
+	in_engine.bvh_live_count = (i32) in_engine.build_items.length();
+	in_engine.bvh_hole_count = 0;
+	in_engine.bvh_change_count = 0;
+	in_engine.bvh_needs_refit = false;
+	if (!in_engine.build_items.empty())
+	{
+		in_engine.bvh_nodes.reserve(2 * (in_engine.build_items.length() / CULL_LANE_COUNT + 1));
+		in_engine.bvh_nodes.add({});
+		cull_bvh_build_node(in_engine, in_slot_bounds, 0, 0, in_engine.bvh_live_count);
+
+		// Breadth-first frontier of subtrees, several per worker
+		const i32 target_roots = 4 * ((in_engine.workers ? in_engine.workers->worker_count() : 0) + 1);
+		in_engine.bvh_task_roots.add(0);
+		for (size_t root_idx = 0; root_idx < in_engine.bvh_task_roots.length() && (i32) in_engine.bvh_task_roots.length() < target_roots; )
+		{
+			const CullBvhNode& node = in_engine.bvh_nodes[in_engine.bvh_task_roots[root_idx]];
+			if (node.left_child < 0)
+			{
+				++root_idx;
+				continue;
+			}
+			in_engine.bvh_task_roots[root_idx] = node.left_child;
+			in_engine.bvh_task_roots.add(node.left_child + 1);
+		}
+	}
+	in_engine.rebuild_count += 1;
+}
+
+// Brings the engine up to date with the slot columns. in_released_slots are
+// slots freed since the last sync, in_changed_slots slots whose bounds or
+// flags were written since then (newly live ones included). Releases are
+// applied first, so a slot freed and reused in between ends up tracked.
+inline void cull_engine_sync(
+	CullEngine& in_engine,
+	const CullBounds& in_slot_bounds,
+	const DynamicArray<u8>& in_slot_flags,
+	const DynamicArray<i32>& in_released_slots,
+	const DynamicArray<i32>& in_changed_slots)
+{
+	in_engine.sync_count += 1;
+	if (in_engine.slots.length() < cull_bounds_length(in_slot_bounds))
+	{
+		in_engine.slots.resize(cull_bounds_length(in_slot_bounds));
+	}
+
+	for (i32 slot : in_released_slots)
+	{
+		cull_engine_detach(in_engine, slot);
+	}
+
+	for (i32 slot : in_changed_slots)
+	{
+		CullSlotState& state = in_engine.slots[slot];
+		const u8 flags = in_slot_flags[slot];
+		state.last_changed_sync = in_engine.sync_count;
+		if (!(flags & CULL_SLOT_LIVE))
+		{
+			cull_engine_detach(in_engine, slot);
+		}
+		else if (flags & CULL_SLOT_ALWAYS_VISIBLE)
+		{
+			if (state.location != ECullSlotLocation::AlwaysVisible)
+			{
+				cull_engine_detach(in_engine, slot);
+				state.location = ECullSlotLocation::AlwaysVisible;
+				state.entry = (i32) in_engine.always_visible_slots.length();
+				in_engine.always_visible_slots.add(slot);
+			}
+		}
+		else if (state.location == ECullSlotLocation::Bvh)
+		{
+			cull_bounds_set(in_engine.bvh_bounds, state.entry, cull_bounds_get(in_slot_bounds, slot));
+			in_engine.bvh_needs_refit = true;
+			in_engine.bvh_change_count += 1;
+		}
+		else if (state.location == ECullSlotLocation::Dynamic)
+		{
+			cull_bounds_set(in_engine.dynamic_bounds, state.entry, cull_bounds_get(in_slot_bounds, slot));
+		}
+		else
+		{
+			cull_engine_detach(in_engine, slot);
+			cull_engine_dynamic_add(in_engine, slot, cull_bounds_get(in_slot_bounds, slot));
+		}
+	}
+
+	// Rebuild once enough has changed that the BVH no longer matches the
+	// scene: settled dynamic slots, moving BVH slots, or released holes
+	i32 settled_count = 0;
+	for (i32 entry = 0; entry < in_engine.dynamic_count; ++entry)
+	{
+		const CullSlotState& state = in_engine.slots[in_engine.dynamic_slots[entry]];
+		settled_count += in_engine.sync_count - state.last_changed_sync >= CULL_STATIC_AFTER_SYNCS;
+	}
+	const i32 bvh_size = in_engine.bvh_live_count + in_engine.bvh_hole_count;
+	if (settled_count >= MAX(CULL_REBUILD_MIN_CHANGES, in_engine.bvh_live_count / 8)
+		|| in_engine.bvh_change_count >= MAX(CULL_REBUILD_MIN_CHANGES, in_engine.bvh_live_count / 4)
+		|| in_engine.bvh_hole_count >= MAX(CULL_REBUILD_MIN_CHANGES, bvh_size / 4))
+	{
+		cull_engine_rebuild(in_engine, in_slot_bounds);
+	}
+	else if (in_engine.bvh_needs_refit)
+	{
+		cull_bvh_refit(in_engine);
+	}
+}
+
+// Block-tests entries [in_first, in_end) (whole lane blocks)
+inline void cull_engine_test_entries(
+	const CullView& in_view,
+	const CullBounds& in_bounds,
+	const DynamicArray<i32>& in_slots,
+	i32 in_first,
+	i32 in_end,
+	CullTaskOutput& out_output)
+{
+	// Survivors are compacted branch-free into space reserved up front;
+	// padding lanes (slot -1) are tested like the rest and dropped here
+	const size_t output_start = out_output.slots.length();
+	out_output.slots.resize(output_start + (size_t) (in_end - in_first));
+	i32* output = out_output.slots.data() + output_start;
+	i32 output_count = 0;
+	for (i32 block_first = in_first; block_first < in_end; block_first += CULL_LANE_COUNT)
+	{
+		u32 influence_mask = 0;
+		const u32 visible_mask = cull_test_block(in_view, in_bounds, block_first, influence_mask);
+		const i32* block_slots = in_slots.data() + block_first;
+		for (i32 lane = 0; lane < CULL_LANE_COUNT; ++lane)
+		{
+			output[output_count] = block_slots[lane];
+			output_count += ((visible_mask >> lane) & 1) & (block_slots[lane] >= 0);
+		}
+		while (influence_mask != 0)
+		{
+			out_output.counts.influence_cull_count += block_slots[std::countr_zero(influence_mask)] >= 0;
+			influence_mask &= influence_mask - 1;
+		}
+	}
+	out_output.counts.tested_count += in_end - in_first;
+	out_output.slots.resize(output_start + (size_t) output_count);
+}
+
+inline void cull_engine_traverse(const CullEngine& in_engine, const CullView& in_view, i32 in_root, CullTaskOutput& out_output)
+{
+	i32 stack[64];	// median splits keep depth near log2(entries / CULL_LANE_COUNT)
+	i32 stack_size = 0;
+	stack[stack_size++] = in_root;
+	while (stack_size > 0)
+	{
+		const CullBvhNode& node = in_engine.bvh_nodes[stack[--stack_size]];
+		out_output.counts.node_count += 1;
+		const i32 classification = cull_classify_box(in_view, node.bounds);
+		if (classification < 0)
+		{
+			continue;
+		}
+		if (classification > 0)
+		{
+			for (i32 entry = node.first_entry; entry < node.first_entry + node.entry_count; ++entry)
+			{
+				const i32 slot = in_engine.bvh_slots[entry];
+				if (slot >= 0)
+				{
+					out_output.slots.add(slot);
+					out_output.counts.accepted_count += 1;
+				}
+			}
+			continue;
+		}
+		if (node.left_child < 0)
+		{
+			cull_engine_test_entries(in_view, in_engine.bvh_bounds, in_engine.bvh_slots, node.first_entry, node.first_entry + node.entry_count, out_output);
+			continue;
+		}
+		stack[stack_size++] = node.left_child + 1;
+		stack[stack_size++] = node.left_child;
+	}
+}
+
+// Appends the slots visible to in_view to out_slots. Influence-sphere counts
+// cover block tests only; boxes dropped with a whole BVH node are not
+// attributed to a particular test.
+inline void cull_engine_cull(CullEngine& in_engine, const CullView& in_view, DynamicArray<i32>& out_slots, CullEngineCounts& out_counts)
+{
+	for (i32 slot : in_engine.always_visible_slots)
+	{
+		out_slots.add(slot);
+	}
+
+	const i32 dynamic_end = (in_engine.dynamic_count + CULL_LANE_COUNT - 1) / CULL_LANE_COUNT * CULL_LANE_COUNT;
+	const i32 bvh_size = (i32) in_engine.bvh_slots.length();
+	const bool parallel = in_engine.workers != nullptr && in_engine.workers->worker_count() > 0
+		&& dynamic_end + bvh_size >= CULL_PARALLEL_MIN_ENTRIES;
+
+	if (!parallel)
+	{
+		in_engine.task_outputs.resize(1);
+		CullTaskOutput& output = in_engine.task_outputs[0];
+		output.slots.clear();
+		output.counts = {};
+		cull_engine_test_entries(in_view, in_engine.dynamic_bounds, in_engine.dynamic_slots, 0, dynamic_end, output);
+		if (!in_engine.bvh_nodes.empty())
+		{
+			cull_engine_traverse(in_engine, in_view, 0, output);
+		}
+	}
+	else
+	{
+		const i32 task_entries = CULL_PARALLEL_TASK_BLOCKS * CULL_LANE_COUNT;
+		const i32 dynamic_task_count = (dynamic_end + task_entries - 1) / task_entries;
+		const i32 task_count = dynamic_task_count + (i32) in_engine.bvh_task_roots.length();
+		in_engine.task_outputs.resize(task_count);
+		const CullEngine& engine = in_engine;
+		in_engine.workers->parallel_for((u32) task_count, [&](u32 in_task)
+		{
+			CullTaskOutput& output = in_engine.task_outputs[in_task];
+			output.slots.clear();
+			output.counts = {};
+			if ((i32) in_task < dynamic_task_count)
+			{
+				const i32 first = (i32) in_task * task_entries;
+				cull_engine_test_entries(in_view, engine.dynamic_bounds, engine.dynamic_slots, first, MIN(first + task_entries, dynamic_end), output);
+			}
+			else
+			{
+				cull_engine_traverse(engine, in_view, engine.bvh_task_roots[in_task - dynamic_task_count], output);
+			}
+		});
+	}
+
+	for (const CullTaskOutput& output : in_engine.task_outputs)
+	{
+		for (i32 slot : output.slots)
+		{
+			out_slots.add(slot);
+		}
+		out_counts.influence_cull_count += output.counts.influence_cull_count;
+		out_counts.tested_count += output.counts.tested_count;
+		out_counts.accepted_count += output.counts.accepted_count;
+		out_counts.node_count += output.counts.node_count;
+	}
+}
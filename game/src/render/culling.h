@@ -2,9 +2,12 @@
 
 #include "core/types.h"
 #include "core/dynamic_array.h"
+#include "core/runtime_config.h"
+#include "render/cull_engine.h"
 
 // CPU frustum culling.
-// Frustum/frustum_create/frustum_cull live in core/types.h.
+// Frustum/frustum_create/frustum_cull live in core/types.h; the block tests,
+// BVH and worker split live in render/cull_engine.h.
 
 struct CullResult
 {
@@ -16,19 +19,26 @@ struct CullResult
 	i32 frustum_cull_count = 0;
 };
 
-// Culls scene mesh objects against an optional influence sphere and a
-// view-projection frustum. Skinned meshes bypass the CPU bounds tests because
-// animated bounds are not yet available.
-CullResult cull_objects(
+void cull_record_stats(State& in_state, const CullResult& in_cull_result)
+{
+	in_state.data_oriented.frame.cull_calls += 1;
+	in_state.data_oriented.frame.cull_candidate_count += in_cull_result.candidate_count;
+	in_state.data_oriented.frame.cull_visible_count += (i32) in_cull_result.object_ids.length();
+	in_state.data_oriented.frame.cull_non_renderable_count += in_cull_result.non_renderable_cull_count;
+	in_state.data_oriented.frame.cull_visibility_count += in_cull_result.visibility_cull_count;
+	in_state.data_oriented.frame.cull_influence_count += in_cull_result.influence_cull_count;
+	in_state.data_oriented.frame.cull_frustum_count += in_cull_result.frustum_cull_count;
+}
+
+// Scalar reference: walks every mesh object, transforms its box and tests it
+// on its own. Selected with GAME2_CULL_REFERENCE=1 for A/B comparisons.
+// Skinned meshes are tested with their current pose bounds.
+CullResult cull_objects_reference(
 	State& in_state,
-	const HMM_Mat4& in_view_proj,
-	f32 in_bounds_padding,
-	const BoundingSphere* in_influence_sphere = nullptr)
+	const CullView& in_view)
 {
 	CullResult out_cull_result;
 
-	Frustum frustum = frustum_create(in_view_proj);
-
 	scene_ensure_indexes(in_state);
 	out_cull_result.candidate_count = (i32) in_state.scene.indexes.mesh_object_ids.length();
 	for (i32 mesh_object_id : in_state.scene.indexes.mesh_object_ids)
@@ -46,47 +56,104 @@ CullResult cull_objects(
 			out_cull_result.visibility_cull_count += 1;
 			continue;
 		}
+		if (!mesh_gpu_ready(object.mesh))
+		{
+			// Still uploading
+			out_cull_result.non_renderable_cull_count += 1;
+			continue;
+		}
 
-		// TODO: Compute animated bounds for skinned meshes so they can be
-		// frustum culled safely.
-		if (object.mesh.has_skinned_vertices)
+		if (mesh_is_always_visible(object.mesh))
 		{
 			out_cull_result.object_ids.add(mesh_object_id);
 			in_state.data_oriented.frame.cull_skinned_visible_count += 1;
 			continue;
 		}
 
-		BoundingBox object_bounding_box = bounding_box_transform(object.mesh.bounding_box, object.current_transform);
-		if (in_bounds_padding > 0.0f)
+		switch (cull_box_reference(in_view, object_get_bounding_box(object)))
 		{
-			const HMM_Vec3 padding = HMM_V3(in_bounds_padding, in_bounds_padding, in_bounds_padding);
-			object_bounding_box.min -= padding;
-			object_bounding_box.max += padding;
+			case ECullBoxResult::InfluenceCulled:
+				out_cull_result.influence_cull_count += 1;
+				break;
+			case ECullBoxResult::FrustumCulled:
+				out_cull_result.frustum_cull_count += 1;
+				break;
+			case ECullBoxResult::Visible:
+				out_cull_result.object_ids.add(mesh_object_id);
+				if (object.mesh.has_skinned_vertices)
+				{
+					in_state.data_oriented.frame.cull_skinned_visible_count += 1;
+				}
+				break;
 		}
+	}
+
+	return out_cull_result;
+}
 
-		if (in_influence_sphere != nullptr
-			&& bounding_box_outside_sphere(object_bounding_box, *in_influence_sphere))
+// Culls scene mesh objects against an optional influence sphere and a
+// view-projection frustum. The cull engine tests the render-object store's
+// bounds columns (as of the last flush); visibility flags are only checked
+// for the slots that survive, so a hidden object outside the view counts as
+// frustum culled.
+CullResult cull_objects(
+	State& in_state,
+	const HMM_Mat4& in_view_proj,
+	f32 in_bounds_padding,
+	const BoundingSphere* in_influence_sphere = nullptr)
+{
+	const CullView view = {
+		.frustum = frustum_create(in_view_proj),
+		.bounds_padding = in_bounds_padding,
+		.influence_sphere = in_influence_sphere,
+	};
+
+	if (RuntimeConfig::get().cull_reference)
+	{
+		CullResult out_cull_result = cull_objects_reference(in_state, view);
+		cull_record_stats(in_state, out_cull_result);
+		return out_cull_result;
+	}
+
+	CullResult out_cull_result;
+	const RenderObjectStore& store = in_state.render_objects.store;
+	DynamicArray<i32>& visible_slots = in_state.culling.visible_slots;
+	visible_slots.clear();
+	CullEngineCounts counts;
+	cull_engine_cull(in_state.culling.engine, view, visible_slots, counts);
+
+	out_cull_result.candidate_count = render_object_store_live_count(store);
+	for (i32 slot : visible_slots)
+	{
+		const i32 unique_id = store.slot_object_ids[slot];
+		auto found = in_state.scene.objects.find(unique_id);
+		if (found == in_state.scene.objects.end())
 		{
-			out_cull_result.influence_cull_count += 1;
+			out_cull_result.non_renderable_cull_count += 1;
 			continue;
 		}
 
-		if (frustum_cull(frustum, object_bounding_box))
+		const Object& object = found->second;
+		if (!object.visibility || !object.has_mesh)
 		{
-			out_cull_result.frustum_cull_count += 1;
+			out_cull_result.visibility_cull_count += 1;
+			continue;
+		}
+		if (!mesh_gpu_ready(object.mesh))
+		{
+			out_cull_result.non_renderable_cull_count += 1;
 			continue;
 		}
 
-		out_cull_result.object_ids.add(mesh_object_id);
+		if (object.mesh.has_skinned_vertices)
+		{
+			in_state.data_oriented.frame.cull_skinned_visible_count += 1;
+		}
+		out_cull_result.object_ids.add(unique_id);
 	}
 
-	in_state.data_oriented.frame.cull_calls += 1;
-	in_state.data_oriented.frame.cull_candidate_count += out_cull_result.candidate_count;
-	in_state.data_oriented.frame.cull_visible_count += (i32) out_cull_result.object_ids.length();
-	in_state.data_oriented.frame.cull_non_renderable_count += out_cull_result.non_renderable_cull_count;
-	in_state.data_oriented.frame.cull_visibility_count += out_cull_result.visibility_cull_count;
-	in_state.data_oriented.frame.cull_influence_count += out_cull_result.influence_cull_count;
-	in_state.data_oriented.frame.cull_frustum_count += out_cull_result.frustum_cull_count;
-
+	out_cull_result.influence_cull_count = counts.influence_cull_count;
+	out_cull_result.frustum_cull_count = MAX(out_cull_result.candidate_count - (i32) visible_slots.length() - counts.influence_cull_count, 0);
+	cull_record_stats(in_state, out_cull_result);
 	return out_cull_result;
 }
@@ -3,6 +3,7 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/gpu_buffer.h"
+#include "render/texture_streaming.h"
 
 // GLSL-shared struct definitions (PerFrameData, ObjectData)
 #include "shader_common.h"
@@ -10,6 +11,7 @@
 static_assert(sizeof(PerFrameData) == 320, "PerFrameData must match its std140 layout (vec4/mat4 members only)");
 static_assert(sizeof(ObjectData) == 144, "ObjectData must match the geometry shader SSBO stride");
 static_assert(sizeof(Material) == 64, "Material must match the geometry shader SSBO stride");
+static_assert(sizeof(DrawRecord) == 48, "DrawRecord must match the indirect vertex shader SSBO stride");
 
 // Descriptor set 0 plumbing shared by scene passes, plus the sampled-input
 // set used by fullscreen passes (copy-to-swapchain now, post passes later).
@@ -30,15 +32,30 @@ struct FrameData
 	VkDescriptorSet copy_input_sets[MAX_FRAMES_IN_FLIGHT] = {};
 
 	VkSampler linear_sampler = VK_NULL_HANDLE;
+	VkSampler scene_texture_sampler = VK_NULL_HANDLE;	// trilinear, for the mip chains of imported textures
+
+	// 1x1 white, bound in place of images whose async upload has not landed
+	GpuImage placeholder_image;
 
 	GpuBuffer<PerFrameData> per_frame_ubos[MAX_FRAMES_IN_FLIGHT];
 
+	// Texture streaming feedback (binding 8): written by the geometry pass,
+	// read back and reset once the slot's fence has passed. bound_mips
+	// records which resident mip each slot showed when the frame was
+	// recorded (TEXTURE_FEEDBACK_NOT_BOUND for the placeholder).
+	GpuBuffer<u32> texture_feedback[MAX_FRAMES_IN_FLIGHT];
+	u8 texture_feedback_bound_mips[MAX_FRAMES_IN_FLIGHT][MAX_BINDLESS_IMAGES] = {};
+	i32 texture_feedback_count[MAX_FRAMES_IN_FLIGHT] = {};
+
 	struct BindingCache
 	{
 		VkBuffer ubo = VK_NULL_HANDLE;
 		VkBuffer object_data = VK_NULL_HANDLE;
 		VkBuffer material = VK_NULL_HANDLE;
 		VkBuffer skin_matrices = VK_NULL_HANDLE;
+		VkBuffer draw_records = VK_NULL_HANDLE;
+		VkBuffer draw_instances = VK_NULL_HANDLE;
+		VkBuffer texture_feedback = VK_NULL_HANDLE;
 		i32 image_count = -1;
 		VkImageView image_views[MAX_BINDLESS_IMAGES] = {};
 		VkImageView copy_input = VK_NULL_HANDLE;
@@ -49,8 +66,8 @@ static FrameData frame_data;
 
 void frame_data_init(VulkanContext* ctx)
 {
-	// Linear clamp sampler, created first: layout A embeds it as an immutable
-	// sampler (binding 5); the copy pass shares it
+	// Linear clamp samplers, created first: layout A embeds the trilinear one
+	// as an immutable sampler (binding 5); the copy pass shares the other
 	{
 		VkSamplerCreateInfo sampler_create_info = {
 			.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
@@ -63,6 +80,12 @@ void frame_data_init(VulkanContext* ctx)
 		};
 		VK_CHECK(vkCreateSampler(ctx->device, &sampler_create_info, nullptr, &frame_data.linear_sampler));
 		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_SAMPLER, (u64)frame_data.linear_sampler, "Shared Linear Sampler");
+
+		// Material textures carry full mip chains (texture_processing.h)
+		sampler_create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		sampler_create_info.maxLod = VK_LOD_CLAMP_NONE;
+		VK_CHECK(vkCreateSampler(ctx->device, &sampler_create_info, nullptr, &frame_data.scene_texture_sampler));
+		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_SAMPLER, (u64)frame_data.scene_texture_sampler, "Scene Texture Sampler");
 	}
 
 	// Layout A (scene passes):
@@ -71,7 +94,10 @@ void frame_data_init(VulkanContext* ctx)
 	//   2 = Material SSBO             (FS)
 	//   3 = skin matrix arena SSBO    (VS)
 	//   4 = bindless texture array    (FS, PARTIALLY_BOUND)
-	//   5 = immutable linear sampler  (FS)
+	//   5 = immutable mip sampler     (FS)
+	//   6 = DrawRecord SSBO           (VS, indirect draws)
+	//   7 = draw instance SSBO        (VS, indirect draws)
+	//   8 = texture feedback SSBO     (FS, written by the geometry pass)
 	{
 		VkDescriptorSetLayoutBinding bindings[] = {
 			{
@@ -109,7 +135,25 @@ void frame_data_init(VulkanContext* ctx)
 				.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
 				.descriptorCount = 1,
 				.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-				.pImmutableSamplers = &frame_data.linear_sampler,
+				.pImmutableSamplers = &frame_data.scene_texture_sampler,
+			},
+			{
+				.binding = 6,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+			},
+			{
+				.binding = 7,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+			},
+			{
+				.binding = 8,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
 			},
 		};
 
@@ -119,7 +163,7 @@ void frame_data_init(VulkanContext* ctx)
 		VkDescriptorBindingFlags binding_flags[] = {
 			0, 0, 0, 0,
 			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
-			0,
+			0, 0, 0, 0,
 		};
 		VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info = {
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
@@ -183,20 +227,47 @@ void frame_data_init(VulkanContext* ctx)
 			},
 			.label = "FrameData::per_frame_ubo",
 		});
+
+		static u32 unsampled[MAX_BINDLESS_IMAGES];
+		std::fill(unsampled, unsampled + MAX_BINDLESS_IMAGES, TEXTURE_FEEDBACK_UNSAMPLED);
+		frame_data.texture_feedback[frame_idx] = GpuBuffer((GpuBufferDesc<u32>){
+			.data = nullptr,
+			.size = sizeof(unsampled),
+			.usage = {
+				.storage_buffer = true,
+				.stream_update = true,
+				.readback = true,
+			},
+			.label = "FrameData::texture_feedback",
+		});
+		frame_data.texture_feedback[frame_idx].update_gpu_buffer(unsampled, sizeof(unsampled));
+	}
+
+	{
+		const u32 white_pixel = 0xFFFFFFFFu;
+		frame_data.placeholder_image = gpu_image_create_from_data(
+			ctx, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, &white_pixel, sizeof(white_pixel), 1, "Placeholder Image");
 	}
 }
 
 // Call once per frame, after vulkan_context_begin_frame's fence wait for
 // this slot. Uploads the UBO and rewrites this frame's descriptor sets —
 // buffer growth, image registration, and resize-recreated views are picked
-// up automatically because the bindings are refreshed every frame.
+// up automatically because the bindings are refreshed every frame. Images
+// whose upload ticket is not ready yet bind the placeholder.
+// in_image_first_mips[i] is the full-chain mip image i starts at (texture
+// streaming); it is recorded with the frame so the feedback can be resolved.
 void frame_data_update(
 	VulkanContext* ctx,
 	const PerFrameData& in_per_frame_data,
 	VkBuffer in_object_data_buffer,
 	VkBuffer in_material_buffer,
 	VkBuffer in_skin_matrix_buffer,
+	VkBuffer in_draw_record_buffer,
+	VkBuffer in_draw_instance_buffer,
 	const GpuImage* in_images,
+	const u64* in_image_upload_tickets,
+	const u8* in_image_first_mips,
 	i32 in_image_count
 )
 {
@@ -228,8 +299,26 @@ void frame_data_update(
 		.range = VK_WHOLE_SIZE,
 	};
 
+	VkDescriptorBufferInfo draw_record_info = {
+		.buffer = in_draw_record_buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	};
+
+	VkDescriptorBufferInfo draw_instance_info = {
+		.buffer = in_draw_instance_buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	};
+
+	VkDescriptorBufferInfo texture_feedback_info = {
+		.buffer = frame_data.texture_feedback[frame_index].get_gpu_buffer(),
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	};
+
 	FrameData::BindingCache& cache = frame_data.binding_cache[frame_index];
-	VkWriteDescriptorSet writes[5] = {};
+	static VkWriteDescriptorSet writes[8 + MAX_BINDLESS_IMAGES];
 	u32 write_count = 0;
 	auto append_buffer_write = [&](u32 in_binding, VkDescriptorType in_type, VkDescriptorBufferInfo* in_info)
 	{
@@ -262,38 +351,68 @@ void frame_data_update(
 		append_buffer_write(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &skin_matrix_info);
 		cache.skin_matrices = skin_matrix_info.buffer;
 	}
+	if (cache.draw_records != draw_record_info.buffer)
+	{
+		append_buffer_write(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &draw_record_info);
+		cache.draw_records = draw_record_info.buffer;
+	}
+	if (cache.draw_instances != draw_instance_info.buffer)
+	{
+		append_buffer_write(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &draw_instance_info);
+		cache.draw_instances = draw_instance_info.buffer;
+	}
+	if (cache.texture_feedback != texture_feedback_info.buffer)
+	{
+		append_buffer_write(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &texture_feedback_info);
+		cache.texture_feedback = texture_feedback_info.buffer;
+	}
 
 	// Bindless texture array: write only the registered prefix
-	// (PARTIALLY_BOUND covers the rest; shader guards image_index >= 0)
+	// (PARTIALLY_BOUND covers the rest; shader guards image_index >= 0).
+	// Slots are swapped in place: one write per run of changed views, so a
+	// streamed replacement or a finished upload touches only its own slot.
+	assert(in_image_count <= MAX_BINDLESS_IMAGES);
 	static VkDescriptorImageInfo image_infos[MAX_BINDLESS_IMAGES];
-	bool images_dirty = cache.image_count != in_image_count;
-	for (i32 image_idx = 0; !images_dirty && image_idx < in_image_count; ++image_idx)
-	{
-		images_dirty = cache.image_views[image_idx] != in_images[image_idx].view;
-	}
-	if (images_dirty && in_image_count > 0)
+	const bool rewrite_all = cache.image_count != in_image_count;
+	i32 run_start = -1;
+	for (i32 image_idx = 0; image_idx <= in_image_count; ++image_idx)
 	{
-		assert(in_image_count <= MAX_BINDLESS_IMAGES);
-		for (i32 image_idx = 0; image_idx < in_image_count; ++image_idx)
+		bool changed = false;
+		if (image_idx < in_image_count)
 		{
-			image_infos[image_idx] = (VkDescriptorImageInfo) {
-				.imageView = in_images[image_idx].view,
-				.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			const bool ready = vulkan_upload_ready(ctx, in_image_upload_tickets[image_idx]);
+			const VkImageView view = ready ? in_images[image_idx].view : frame_data.placeholder_image.view;
+			frame_data.texture_feedback_bound_mips[frame_index][image_idx] = ready ? in_image_first_mips[image_idx] : TEXTURE_FEEDBACK_NOT_BOUND;
+			changed = rewrite_all || cache.image_views[image_idx] != view;
+			if (changed)
+			{
+				image_infos[image_idx] = (VkDescriptorImageInfo) {
+					.imageView = view,
+					.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				};
+				cache.image_views[image_idx] = view;
+			}
+		}
+		if (changed && run_start < 0)
+		{
+			run_start = image_idx;
+		}
+		else if (!changed && run_start >= 0)
+		{
+			writes[write_count++] = (VkWriteDescriptorSet) {
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.dstSet = frame_data.per_frame_sets[frame_index],
+				.dstBinding = 4,
+				.dstArrayElement = (u32) run_start,
+				.descriptorCount = (u32) (image_idx - run_start),
+				.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+				.pImageInfo = &image_infos[run_start],
 			};
-			cache.image_views[image_idx] = in_images[image_idx].view;
+			run_start = -1;
 		}
-
-		writes[write_count++] = (VkWriteDescriptorSet) {
-			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			.dstSet = frame_data.per_frame_sets[frame_index],
-			.dstBinding = 4,
-			.dstArrayElement = 0,
-			.descriptorCount = (u32) in_image_count,
-			.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-			.pImageInfo = image_infos,
-		};
 	}
-	if (images_dirty) cache.image_count = in_image_count;
+	cache.image_count = in_image_count;
+	frame_data.texture_feedback_count[frame_index] = in_image_count;
 
 	if (write_count > 0) vulkan_update_descriptor_sets(ctx, write_count, writes);
 }
@@ -324,14 +443,36 @@ void frame_data_write_copy_input(VulkanContext* ctx, VkImageView in_view)
 	vulkan_update_descriptor_sets(ctx, 1, &write);
 }
 
+// Call after vulkan_context_begin_frame's fence wait and before
+// frame_data_update: copies out the feedback the frame that last used this
+// slot wrote, with the mips it was resolved against, and resets the buffer.
+// Returns the slot count (0 when nothing was recorded).
+i32 frame_data_take_texture_feedback(VulkanContext* ctx, u32* out_feedback, u8* out_bound_mips)
+{
+	const u32 frame_index = ctx->frame_index;
+	const i32 count = frame_data.texture_feedback_count[frame_index];
+	if (count <= 0) return 0;
+
+	static u32 unsampled[MAX_BINDLESS_IMAGES];
+	std::fill(unsampled, unsampled + count, TEXTURE_FEEDBACK_UNSAMPLED);
+	frame_data.texture_feedback[frame_index].read_gpu_buffer(out_feedback, (u64) count * sizeof(u32));
+	frame_data.texture_feedback[frame_index].update_gpu_buffer(unsampled, (u64) count * sizeof(u32));
+	memcpy(out_bound_mips, frame_data.texture_feedback_bound_mips[frame_index], (size_t) count);
+	frame_data.texture_feedback_count[frame_index] = 0;
+	return count;
+}
+
 void frame_data_shutdown(VulkanContext* ctx)
 {
 	for (u32 frame_idx = 0; frame_idx < MAX_FRAMES_IN_FLIGHT; ++frame_idx)
 	{
 		frame_data.per_frame_ubos[frame_idx].destroy_gpu_buffer();
+		frame_data.texture_feedback[frame_idx].destroy_gpu_buffer();
 	}
+	gpu_image_destroy(ctx->allocator, ctx->device, frame_data.placeholder_image);
 
 	vkDestroySampler(ctx->device, frame_data.linear_sampler, nullptr);
+	vkDestroySampler(ctx->device, frame_data.scene_texture_sampler, nullptr);
 	vkDestroyDescriptorSetLayout(ctx->device, frame_data.sampled_input_layout, nullptr);
 	vkDestroyDescriptorSetLayout(ctx->device, frame_data.per_frame_layout, nullptr);
 }
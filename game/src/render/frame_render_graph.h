@@ -6,10 +6,14 @@
 
 // Lightweight ordered frame graph. It does not schedule or own images: it
 // resolves persistent/imported resources, batches declared reads immediately
-// before a node, and delegates attachment writes to RenderPass::execute.
+// before a node, and delegates attachment writes to RenderPass::execute,
+// which issues the reads and its own attachment transitions as one barrier.
+// Memory for transient targets is planned from the schedule declared to
+// RenderTargetRegistry, not from this per-frame order.
 struct FrameGraphImage
 {
 	GpuImage* image = nullptr;
+	RenderPass* target = nullptr;	// owning render target, when there is one
 
 	VkImageView view() const
 	{
@@ -25,7 +29,10 @@ inline FrameGraphImage frame_graph_color(
 	i32 in_output_index = 0,
 	i32 in_image_index = 0)
 {
-	return { .image = &in_target.get_color_output(in_output_index, in_image_index) };
+	return {
+		.image = &in_target.get_color_output(in_output_index, in_image_index),
+		.target = &in_target,
+	};
 }
 
 inline FrameGraphImage frame_graph_select(
@@ -46,6 +53,9 @@ struct FrameRenderGraph
 	FrameGraphImage sampled(FrameGraphImage in_resource)
 	{
 		assert(in_resource.image);
+		// A transient target must have been written this frame, and not
+		// overwritten since by another target sharing its memory
+		assert(!in_resource.target || in_resource.target->holds_frame_contents(ctx->frame_number));
 		GpuImage& image = *in_resource.image;
 		pending_reads.images.add({
 			.image = &image,
@@ -66,8 +76,7 @@ struct FrameRenderGraph
 	void apply_reads()
 	{
 		vulkan_apply_pass_resource_usage(ctx, pending_reads);
-		pending_reads.images.clear();
-		pending_reads.buffers.clear();
+		pending_reads.clear();
 	}
 
 	void make_sampled(FrameGraphImage in_resource)
@@ -81,8 +90,7 @@ struct FrameRenderGraph
 		const std::function<void(i32)>& in_callback,
 		i32 in_pass_count = -1)
 	{
-		apply_reads();
-		in_target.execute(ctx, in_callback, in_pass_count);
+		in_target.execute(ctx, in_callback, in_pass_count, ~0u, &pending_reads);
 	}
 
 private:
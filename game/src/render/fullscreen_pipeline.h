@@ -3,7 +3,7 @@
 #include "core/types.h"
 #include "core/dynamic_array.h"
 #include "render/gpu_buffer.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/vulkan_context.h"
 
 #include <cassert>
@@ -23,7 +23,7 @@ struct FullscreenPipelineDesc
 	u32 additive_blend_mask = 0;
 };
 
-inline VkPipeline vulkan_create_fullscreen_pipeline(
+inline PipelineBuildJob vulkan_fullscreen_pipeline_job(
 	VulkanContext* ctx,
 	const FullscreenPipelineDesc& in_desc)
 {
@@ -34,9 +34,9 @@ inline VkPipeline vulkan_create_fullscreen_pipeline(
 	assert(in_desc.color_format_count > 0);
 
 	VkShaderModule vertex_module =
-		create_shader_module_from_file(ctx->device, in_desc.vertex_shader_path);
+		PipelineBuildService::shader_module(ctx, in_desc.vertex_shader_path);
 	VkShaderModule fragment_module =
-		create_shader_module_from_file(ctx->device, in_desc.fragment_shader_path);
+		PipelineBuildService::shader_module(ctx, in_desc.fragment_shader_path);
 	VkPipelineShaderStageCreateInfo shader_stages[] = {
 		{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -141,12 +141,25 @@ inline VkPipeline vulkan_create_fullscreen_pipeline(
 		.layout = in_desc.pipeline_layout,
 		.renderPass = VK_NULL_HANDLE,
 	};
+	return pipeline_build_job_graphics(pipeline_info);
+}
 
-	VkPipeline pipeline = VK_NULL_HANDLE;
-	VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_info, &pipeline));
-	vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-	vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-	return pipeline;
+// Writes *out_pipeline once built: immediately, or when the startup batch
+// flushes
+inline void vulkan_create_fullscreen_pipeline(
+	VulkanContext* ctx,
+	const FullscreenPipelineDesc& in_desc,
+	VkPipeline* out_pipeline)
+{
+	PipelineBuildService::submit(ctx, vulkan_fullscreen_pipeline_job(ctx, in_desc), out_pipeline);
+}
+
+inline void vulkan_defer_fullscreen_pipeline(
+	VulkanContext* ctx,
+	const FullscreenPipelineDesc& in_desc,
+	DeferredPipeline* out_pipeline)
+{
+	PipelineBuildService::defer(vulkan_fullscreen_pipeline_job(ctx, in_desc), out_pipeline);
 }
 
 struct FullscreenPipeline
@@ -156,7 +169,7 @@ struct FullscreenPipeline
 	void init(VulkanContext* ctx, const FullscreenPipelineDesc& in_desc)
 	{
 		assert(pipeline == VK_NULL_HANDLE);
-		pipeline = vulkan_create_fullscreen_pipeline(ctx, in_desc);
+		vulkan_create_fullscreen_pipeline(ctx, in_desc, &pipeline);
 	}
 
 	void bind(VulkanContext* ctx) const
@@ -516,7 +529,7 @@ struct ComputeEffect
 			in_desc.push_constant_size, VK_SHADER_STAGE_COMPUTE_BIT);
 
 		VkShaderModule module =
-			create_shader_module_from_file(ctx->device, in_desc.shader_path);
+			PipelineBuildService::shader_module(ctx, in_desc.shader_path);
 		VkComputePipelineCreateInfo pipeline_info = {
 			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
 			.stage = {
@@ -527,9 +540,7 @@ struct ComputeEffect
 			},
 			.layout = pipeline_layout.layout,
 		};
-		VK_CHECK(vulkan_create_compute_pipelines(
-			ctx, 1, &pipeline_info, &pipeline));
-		vkDestroyShaderModule(ctx->device, module, nullptr);
+		PipelineBuildService::compute(ctx, pipeline_info, &pipeline);
 	}
 
 	DescriptorWriter writer(VulkanContext* ctx)
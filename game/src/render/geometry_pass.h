@@ -3,12 +3,13 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
+#include "render/indirect_draw.h"
 #include "game_object/mesh.h"
 
 // Deferred geometry pass: writes the 4-attachment G-buffer (see
-// geometry.frag for the layout). Same descriptor set 0 (layout A) and push
+// geometry_fs.h for the layout). Same descriptor set 0 (layout A) and push
 // constants as the old forward pass; materials/bindless textures are baked
 // into the G-buffer here and consumed by the lighting pass.
 
@@ -17,27 +18,74 @@ struct GeometryPassPushConstants
 	i32 object_index;
 	i32 skin_matrix_offset;	// arena offset for skinned draws; ignored otherwise
 	i32 skinning_debug_view;
-	i32 _pad0;
+	i32 texture_feedback;	// 0 = off, else 1 + the reporting pixel of each 4x4 block (geometry_fs.h)
+
+	// Compact draws only: the mesh AABB unorm16 positions decode against
+	HMM_Vec4 position_min;
+	HMM_Vec4 position_extent;
 };
-static_assert(sizeof(GeometryPassPushConstants) == 16, "Geometry push constants must match GLSL");
+static_assert(sizeof(GeometryPassPushConstants) == 48, "Geometry push constants must match GLSL");
+
+// Vertex input variants shared by the geometry and shadow depth passes
+enum class MeshVertexInput
+{
+	Static,		// Vertex
+	Skinned,	// Vertex + SkinnedVertex
+	Compact,	// CompactVertex (mesh_use_compact_vertex_source)
+};
+
+// CompactVertex fetch: 16 bytes per vertex against Vertex's 48. The shader
+// rebuilds position = min + unorm * extent and decodes the octahedral normal;
+// locations match the static layout.
+static const VkVertexInputBindingDescription COMPACT_VERTEX_BINDING = {
+	.binding = 0,
+	.stride = sizeof(CompactVertex),
+	.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+};
+static const VkVertexInputAttributeDescription COMPACT_VERTEX_ATTRIBUTES[] = {
+	{ .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_UNORM, .offset = offsetof(CompactVertex, position) },
+	{ .location = 1, .binding = 0, .format = VK_FORMAT_R16G16_SNORM, .offset = offsetof(CompactVertex, normal) },
+	{ .location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(CompactVertex, texcoord) },
+};
+
+inline VkPipelineVertexInputStateCreateInfo compact_vertex_input_state()
+{
+	return (VkPipelineVertexInputStateCreateInfo) {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.vertexBindingDescriptionCount = 1,
+		.pVertexBindingDescriptions = &COMPACT_VERTEX_BINDING,
+		.vertexAttributeDescriptionCount = sizeof(COMPACT_VERTEX_ATTRIBUTES) / sizeof(COMPACT_VERTEX_ATTRIBUTES[0]),
+		.pVertexAttributeDescriptions = COMPACT_VERTEX_ATTRIBUTES,
+	};
+}
 
 struct GeometryPass
 {
 	VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
 	VkPipeline pipeline = VK_NULL_HANDLE;
 	VkPipeline skinned_pipeline = VK_NULL_HANDLE;
+	VkPipeline compact_pipeline = VK_NULL_HANDLE;
+
+	// Mesh pool draws; only created when IndirectDraw is enabled
+	VkPipeline indirect_pipeline = VK_NULL_HANDLE;
+	VkPipeline indirect_compact_pipeline = VK_NULL_HANDLE;
 
 	// Bind-on-change tracker, reset each pass begin
 	VkPipeline bound_pipeline = VK_NULL_HANDLE;
+	i32 texture_feedback = 0;	// pushed with every draw, set at pass begin
 };
 
 static GeometryPass geometry_pass;
 
-// Builds one geometry pipeline variant (static or skinned vertex input)
-static VkPipeline geometry_pass_create_pipeline(VulkanContext* ctx, const char* in_vertex_shader_path, bool in_skinned)
+// Builds one geometry pipeline variant (static, skinned or compact vertex input)
+static void geometry_pass_create_pipeline(VulkanContext* ctx, const char* in_vertex_shader_path, MeshVertexInput in_vertex_input, VkPipeline* out_pipeline)
 {
-	VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, in_vertex_shader_path);
-	VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/geometry.frag.spv");
+	const bool skinned = in_vertex_input == MeshVertexInput::Skinned;
+	VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, in_vertex_shader_path);
+	// Without fragmentStoresAndAtomics the fragment shader must not declare
+	// the feedback buffer at all, so that variant leaves it out
+	VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, ctx->texture_feedback_enabled
+		? "bin/shaders/geometry.frag.spv" : "bin/shaders/geometry_no_feedback.frag.spv");
 
 	VkPipelineShaderStageCreateInfo shader_stages[] = {
 		{
@@ -88,11 +136,15 @@ static VkPipeline geometry_pass_create_pipeline(VulkanContext* ctx, const char*
 
 	VkPipelineVertexInputStateCreateInfo vertex_input = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		.vertexBindingDescriptionCount = in_skinned ? 2u : 1u,
+		.vertexBindingDescriptionCount = skinned ? 2u : 1u,
 		.pVertexBindingDescriptions = vertex_bindings,
-		.vertexAttributeDescriptionCount = in_skinned ? 5u : 3u,
+		.vertexAttributeDescriptionCount = skinned ? 5u : 3u,
 		.pVertexAttributeDescriptions = vertex_attributes,
 	};
+	if (in_vertex_input == MeshVertexInput::Compact)
+	{
+		vertex_input = compact_vertex_input_state();
+	}
 
 	VkPipelineInputAssemblyStateCreateInfo input_assembly = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -175,13 +227,7 @@ static VkPipeline geometry_pass_create_pipeline(VulkanContext* ctx, const char*
 		.renderPass = VK_NULL_HANDLE,
 	};
 
-	VkPipeline pipeline = VK_NULL_HANDLE;
-	VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &pipeline));
-
-	vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-	vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-
-	return pipeline;
+	PipelineBuildService::graphics(ctx, pipeline_create_info, out_pipeline);
 }
 
 void geometry_pass_init(VulkanContext* ctx)
@@ -202,15 +248,24 @@ void geometry_pass_init(VulkanContext* ctx)
 
 	VK_CHECK(vkCreatePipelineLayout(ctx->device, &pipeline_layout_create_info, nullptr, &geometry_pass.pipeline_layout));
 
-	geometry_pass.pipeline = geometry_pass_create_pipeline(ctx, "bin/shaders/geometry.vert.spv", /*in_skinned*/ false);
-	geometry_pass.skinned_pipeline = geometry_pass_create_pipeline(ctx, "bin/shaders/geometry_skinned.vert.spv", /*in_skinned*/ true);
+	geometry_pass_create_pipeline(ctx, "bin/shaders/geometry.vert.spv", MeshVertexInput::Static, &geometry_pass.pipeline);
+	geometry_pass_create_pipeline(ctx, "bin/shaders/geometry_skinned.vert.spv", MeshVertexInput::Skinned, &geometry_pass.skinned_pipeline);
+	geometry_pass_create_pipeline(ctx, "bin/shaders/geometry_compact.vert.spv", MeshVertexInput::Compact, &geometry_pass.compact_pipeline);
+	if (IndirectDraw::enabled())
+	{
+		geometry_pass_create_pipeline(ctx, "bin/shaders/geometry_indirect.vert.spv", MeshVertexInput::Static, &geometry_pass.indirect_pipeline);
+		geometry_pass_create_pipeline(ctx, "bin/shaders/geometry_compact_indirect.vert.spv", MeshVertexInput::Compact, &geometry_pass.indirect_compact_pipeline);
+	}
 }
 
-void geometry_pass_bind(VulkanContext* ctx)
+// in_texture_feedback: write texture streaming feedback this frame; the
+// reporting pixel rotates with ctx->frame_number
+void geometry_pass_bind(VulkanContext* ctx, bool in_texture_feedback)
 {
 	VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
 
 	geometry_pass.bound_pipeline = VK_NULL_HANDLE;
+	geometry_pass.texture_feedback = in_texture_feedback ? 1 + (i32) (ctx->frame_number & 15) : 0;
 
 	vkCmdBindDescriptorSets(
 		command_buffer,
@@ -233,7 +288,10 @@ void geometry_pass_draw_mesh(VulkanContext* ctx, Mesh& in_mesh, i32 in_object_in
 		return;
 	}
 
-	VkPipeline wanted_pipeline = skinned ? geometry_pass.skinned_pipeline : geometry_pass.pipeline;
+	const bool compact = mesh_use_compact_vertex_source(in_mesh, render_view);
+	VkPipeline wanted_pipeline = compact ? geometry_pass.compact_pipeline
+		: skinned ? geometry_pass.skinned_pipeline
+		: geometry_pass.pipeline;
 	if (geometry_pass.bound_pipeline != wanted_pipeline)
 	{
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, wanted_pipeline);
@@ -244,7 +302,9 @@ void geometry_pass_draw_mesh(VulkanContext* ctx, Mesh& in_mesh, i32 in_object_in
 		.object_index = in_object_index,
 		.skin_matrix_offset = skinned ? in_mesh.skin_matrix_arena_offset : -1,
 		.skinning_debug_view = in_skinning_debug_view ? 1 : 0,
-		._pad0 = 0,
+		.texture_feedback = geometry_pass.texture_feedback,
+		.position_min = HMM_V4V(in_mesh.quantization.position_min, 0.0f),
+		.position_extent = HMM_V4V(in_mesh.quantization.position_extent, 0.0f),
 	};
 
 	vkCmdPushConstants(
@@ -267,13 +327,45 @@ void geometry_pass_draw_mesh(VulkanContext* ctx, Mesh& in_mesh, i32 in_object_in
 		vkCmdBindVertexBuffers(command_buffer, 1, 1, &skinned_vertex_buffer, &skinned_offset);
 	}
 
-	vkCmdBindIndexBuffer(command_buffer, render_view.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+	vkCmdBindIndexBuffer(command_buffer, render_view.index_buffer, 0, render_view.index_type);
 
 	vulkan_cmd_draw_indexed(ctx, render_view.index_count, 1, 0, 0, 0);
 }
 
+// Draws the camera view's pooled meshes. The indirect vertex shaders read
+// the object from the draw record; only skinning_debug_view is pushed.
+IndirectDraw::DrawCounts geometry_pass_draw_indirect(VulkanContext* ctx, bool in_skinning_debug_view)
+{
+	const VkPipeline pipelines[MESH_POOL_BATCH_COUNT] = {
+		geometry_pass.indirect_pipeline,
+		geometry_pass.indirect_compact_pipeline,
+		geometry_pass.indirect_compact_pipeline,
+	};
+	GeometryPassPushConstants push_constants = {
+		.object_index = -1,
+		.skin_matrix_offset = -1,
+		.skinning_debug_view = in_skinning_debug_view ? 1 : 0,
+		.texture_feedback = geometry_pass.texture_feedback,
+	};
+	vkCmdPushConstants(
+		vulkan_current_command_buffer(ctx),
+		geometry_pass.pipeline_layout,
+		VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+		0,
+		sizeof(push_constants),
+		&push_constants
+	);
+	return IndirectDraw::draw_view(ctx, IndirectDraw::CAMERA_VIEW, pipelines, geometry_pass.bound_pipeline);
+}
+
 void geometry_pass_shutdown(VulkanContext* ctx)
 {
+	if (geometry_pass.indirect_pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(ctx->device, geometry_pass.indirect_compact_pipeline, nullptr);
+		vkDestroyPipeline(ctx->device, geometry_pass.indirect_pipeline, nullptr);
+	}
+	vkDestroyPipeline(ctx->device, geometry_pass.compact_pipeline, nullptr);
 	vkDestroyPipeline(ctx->device, geometry_pass.skinned_pipeline, nullptr);
 	vkDestroyPipeline(ctx->device, geometry_pass.pipeline, nullptr);
 	vkDestroyPipelineLayout(ctx->device, geometry_pass.pipeline_layout, nullptr);
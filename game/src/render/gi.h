@@ -4,23 +4,20 @@
 #include <cassert>
 #include <cmath>
 
-#include "ankerl/unordered_dense.h"
 #include "core/types.h"
 #include "core/dynamic_array.h"
 #include "game_object/game_object.h"
 #include "render/lighting_capture.h"
-
-#include "gi_helpers.h"
-
-// GI probe scene: a sparse octree over the
-// static scene geometry, probes at occupied-cell corners, radiance captured
-// a few probes per frame into an octahedral atlas (+ optional SH9/SG9).
+#include "render/gi_layout.h"
+#include "render/gi_probe_scheduler.h"
+
+// GI probe scene: the sparse octree probe layout (gi_layout.h) uploaded for
+// the lighting pass, radiance captured into an octahedral atlas (+ optional
+// SH9/SG9) for the stale probes the scheduler ranks highest, within a
+// per-frame GPU time budget (gi_probe_scheduler.h). Geometry edits patch the
+// layout around the changed objects instead of rebuilding it.
 // The debug probe visualization lives separately in gi_debug_pass.h.
 
-static_assert(sizeof(GI_Cell) == 32, "GI_Cell must match shader storage layout.");
-static_assert(sizeof(GI_Probe) == 32, "GI_Probe must match shader storage layout.");
-static_assert(sizeof(GI_OctreeNode) == 80, "GI_OctreeNode must match shader storage layout.");
-
 struct GI_SG9_Lobe
 {
 	HMM_Vec4 params;
@@ -29,9 +26,7 @@ struct GI_SG9_Lobe
 
 struct GI_Scene
 {
-	DynamicArray<GI_OctreeNode> octree_nodes;
-	DynamicArray<GI_Cell> cells;
-	DynamicArray<GI_Probe> probes;
+	GI_Layout layout;
 	DynamicArray<HMM_Vec4> sh9_coefficients;
 	DynamicArray<GI_SG9_Lobe> sg9_lobes;
 
@@ -43,27 +38,13 @@ struct GI_Scene
 
 	// Probe Update State
 	LightingCapture lighting_capture;
-	i32 probe_idx_to_update = 0;
-	i32 next_atlas_index = 0;
-
-	// Dynamic Layout
-	BoundingBox scene_bounds = {};
-	i32 octree_depth = 4;
-	i32 leaf_divisions = 16;
-	i32 fallback_probe_index = -1;
-	i32 non_fallback_probe_count = 0;
-	i32 payload_count = 0;
-	f32 leaf_cell_extent = 1.0f;
-	f32 max_radial_depth = 4.0f;
-	f32 min_occupied_cell_extent = 0.0f;
-	f32 max_occupied_cell_extent = 0.0f;
+	GI_ProbeScheduler scheduler;
+	DynamicArray<i32> probes_to_capture;
+	// Last capture batch still waiting for its GPU time (CPU frame index)
+	i64 pending_timing_frame = -1;
+	i32 pending_timing_probe_count = 0;
 
 	// Static Parameters
-	static constexpr i32 min_octree_depth = 1;
-	static constexpr i32 max_octree_depth = 4;
-	static constexpr f32 fallback_scene_extent = 30.0f;
-	static constexpr f32 minimum_scene_extent = 1.0f;
-	static constexpr f32 radial_depth_cell_scale = (f32) GI_RADIAL_DEPTH_CELL_SCALE;
 	static constexpr i32 cubemap_capture_size = 256;
 	static constexpr i32 atlas_total_size = 2048;
 	static constexpr i32 atlas_entry_size = 16;
@@ -73,7 +54,7 @@ struct GI_Scene
 	static constexpr i32 maximum_specular_slots_per_dimension = 71;
 	static constexpr i32 maximum_specular_atlas_size =
 		maximum_specular_slots_per_dimension * specular_atlas_entry_size;
-	static constexpr i32 probes_to_update_per_frame = 4;
+	static constexpr i32 maximum_patch_regions = 64;	// more edits than this in a frame rebuild
 };
 static_assert(
 	GI_Scene::maximum_specular_slots_per_dimension * GI_Scene::maximum_specular_slots_per_dimension
@@ -88,96 +69,31 @@ static_assert(
 #define GI_LOG_SCENE_INIT 0
 #define GI_LOG_SCENE_UPDATE 0
 
+static const char* GI_PROBE_CAPTURE_TIMING_SCOPE = "GI Probe Capture";
+
 i32 gi_scene_atlas_capacity()
 {
 	const i32 atlas_entries_per_dimension = GI_Scene::atlas_total_size / GI_Scene::atlas_entry_size;
 	return atlas_entries_per_dimension * atlas_entries_per_dimension;
 }
 
-i32 gi_scene_leaf_divisions_from_depth(const i32 in_octree_depth)
-{
-	return 1 << in_octree_depth;
-}
-
-HMM_Vec3 gi_scene_bounds_center(const BoundingBox& in_bounds)
-{
-	return (in_bounds.min + in_bounds.max) * 0.5f;
-}
-
-BoundingBox gi_scene_cube_bounds_from_center_extent(const HMM_Vec3 in_center, const f32 in_extent)
-{
-	const HMM_Vec3 half_extent = HMM_V3(in_extent, in_extent, in_extent) * 0.5f;
-	return (BoundingBox) {
-		.min = in_center - half_extent,
-		.max = in_center + half_extent,
-	};
-}
-
-BoundingBox gi_scene_expand_bounds_to_cube(const BoundingBox& in_bounds)
-{
-	const HMM_Vec3 extent = in_bounds.max - in_bounds.min;
-	f32 cube_extent = std::max(extent.X, std::max(extent.Y, extent.Z));
-	if (!std::isfinite(cube_extent) || cube_extent < GI_Scene::minimum_scene_extent)
-	{
-		cube_extent = GI_Scene::minimum_scene_extent;
-	}
-	return gi_scene_cube_bounds_from_center_extent(gi_scene_bounds_center(in_bounds), cube_extent);
-}
-
 bool gi_scene_collect_visible_mesh_bounds(
 	const State& in_state,
 	DynamicArray<BoundingBox>& out_geometry_bounds,
 	BoundingBox& out_scene_bounds)
 {
 	out_geometry_bounds.reset();
-	out_scene_bounds = bounding_box_init();
-
 	for (auto const& [unique_id, object] : in_state.scene.objects)
 	{
 		if (!object_contributes_to_gi_scene(object))
 		{
 			continue;
 		}
-
-		const BoundingBox object_bounds = object_get_bounding_box(object);
-		out_geometry_bounds.add(object_bounds);
-		bounding_box_expand(out_scene_bounds, object_bounds.min);
-		bounding_box_expand(out_scene_bounds, object_bounds.max);
-	}
-
-	if (out_geometry_bounds.length() == 0)
-	{
-		out_scene_bounds = gi_scene_cube_bounds_from_center_extent(HMM_V3(0.0f, 0.0f, 0.0f), GI_Scene::fallback_scene_extent);
-		return false;
+		out_geometry_bounds.add(object_get_bounding_box(object));
 	}
 
-	out_scene_bounds = gi_scene_expand_bounds_to_cube(out_scene_bounds);
-	return true;
-}
-
-HMM_Vec3 gi_scene_lattice_position(const BoundingBox& in_bounds, const i32 in_leaf_divisions, const GI_Coords in_coords)
-{
-	const f32 cell_extent = (in_bounds.max.X - in_bounds.min.X) / (f32) in_leaf_divisions;
-	return in_bounds.min + HMM_V3(
-		(f32) in_coords.x * cell_extent,
-		(f32) in_coords.y * cell_extent,
-		(f32) in_coords.z * cell_extent
-	);
-}
-
-void gi_scene_reset_layout_buffers(GI_Scene& in_gi_scene)
-{
-	in_gi_scene.octree_nodes.reset();
-	in_gi_scene.cells.reset();
-	in_gi_scene.probes.reset();
-	in_gi_scene.sh9_coefficients.reset();
-	in_gi_scene.sg9_lobes.reset();
-	in_gi_scene.fallback_probe_index = -1;
-	in_gi_scene.non_fallback_probe_count = 0;
-	in_gi_scene.payload_count = 0;
-	in_gi_scene.min_occupied_cell_extent = 0.0f;
-	in_gi_scene.max_occupied_cell_extent = 0.0f;
-	in_gi_scene.max_radial_depth = 0.0f;
+	out_scene_bounds = gi_layout_scene_bounds(out_geometry_bounds);
+	return out_geometry_bounds.length() > 0;
 }
 
 void gi_scene_destroy_layout_gpu_resources(GI_Scene& in_gi_scene)
@@ -189,247 +105,14 @@ void gi_scene_destroy_layout_gpu_resources(GI_Scene& in_gi_scene)
 	in_gi_scene.sg9_lobes_buffer.destroy_gpu_buffer();
 }
 
-u64 gi_scene_probe_corner_key(const GI_Coords in_coords)
-{
-	assert(in_coords.x >= 0 && in_coords.y >= 0 && in_coords.z >= 0);
-	constexpr u64 coord_mask = (1ull << 21ull) - 1ull;
-	return (((u64) in_coords.x & coord_mask) << 42ull) |
-		(((u64) in_coords.y & coord_mask) << 21ull) |
-		((u64) in_coords.z & coord_mask);
-}
-
-f32 gi_scene_cell_extent_from_depth(const GI_Scene& in_gi_scene, const i32 in_depth)
-{
-	const i32 divisions = 1 << in_depth;
-	return (in_gi_scene.scene_bounds.max.X - in_gi_scene.scene_bounds.min.X) / (f32) divisions;
-}
-
-f32 gi_scene_max_radial_depth_from_cell_extent(const f32 in_cell_extent)
-{
-	return std::max(in_cell_extent * GI_Scene::radial_depth_cell_scale, GI_Scene::minimum_scene_extent);
-}
-
-GI_Probe gi_scene_make_probe(
-	const HMM_Vec3 in_position,
-	const f32 in_max_radial_depth,
-	const i32 in_octree_level)
-{
-	GI_Probe probe = {};
-	probe.position = HMM_V4V(in_position, 1.0f);
-	probe.atlas_idx = -1;
-	probe.max_radial_depth = in_max_radial_depth;
-	probe.octree_level = in_octree_level;
-	probe.padding = 0;
-	return probe;
-}
-
-void gi_scene_init_empty_cell_sentinel(GI_Scene& out_gi_scene)
-{
-	GI_Cell cell = {};
-	for (i32 i = 0; i < 8; ++i)
-	{
-		cell.probe_indices[i] = -1;
-	}
-	out_gi_scene.cells.add(cell);
-}
-
-void gi_scene_add_fallback_probe(GI_Scene& out_gi_scene)
-{
-	out_gi_scene.non_fallback_probe_count = (i32) out_gi_scene.probes.length();
-	out_gi_scene.fallback_probe_index = out_gi_scene.non_fallback_probe_count;
-
-	const f32 fallback_radial_depth = gi_scene_max_radial_depth_from_cell_extent(out_gi_scene.scene_bounds.max.X - out_gi_scene.scene_bounds.min.X);
-	out_gi_scene.probes.add(gi_scene_make_probe(
-		gi_scene_bounds_center(out_gi_scene.scene_bounds), fallback_radial_depth, -1));
-	out_gi_scene.max_radial_depth = std::max(out_gi_scene.max_radial_depth, fallback_radial_depth);
-}
-
-bool gi_scene_bounds_intersect(const BoundingBox& in_a, const BoundingBox& in_b)
-{
-	return in_a.min.X <= in_b.max.X && in_a.max.X >= in_b.min.X &&
-		in_a.min.Y <= in_b.max.Y && in_a.max.Y >= in_b.min.Y &&
-		in_a.min.Z <= in_b.max.Z && in_a.max.Z >= in_b.min.Z;
-}
-
-bool gi_scene_bounds_intersect_any(const BoundingBox& in_bounds, const DynamicArray<BoundingBox>& in_geometry_bounds)
-{
-	for (const BoundingBox& geometry_bounds : in_geometry_bounds)
-	{
-		if (gi_scene_bounds_intersect(in_bounds, geometry_bounds))
-		{
-			return true;
-		}
-	}
-	return false;
-}
-
-BoundingBox gi_scene_child_bounds(const BoundingBox& in_bounds, const i32 in_child_x, const i32 in_child_y, const i32 in_child_z)
-{
-	const HMM_Vec3 center = (in_bounds.min + in_bounds.max) * 0.5f;
-	return (BoundingBox) {
-		.min = HMM_V3(
-			in_child_x == 0 ? in_bounds.min.X : center.X,
-			in_child_y == 0 ? in_bounds.min.Y : center.Y,
-			in_child_z == 0 ? in_bounds.min.Z : center.Z
-		),
-		.max = HMM_V3(
-			in_child_x == 0 ? center.X : in_bounds.max.X,
-			in_child_y == 0 ? center.Y : in_bounds.max.Y,
-			in_child_z == 0 ? center.Z : in_bounds.max.Z
-		),
-	};
-}
-
-i32 gi_scene_get_or_create_probe(
-	GI_Scene& out_gi_scene,
-	ankerl::unordered_dense::map<u64, i32>& out_probe_indices_by_corner,
-	const GI_Coords in_max_depth_coords,
-	const f32 in_required_radial_depth,
-	const i32 in_octree_level)
-{
-	const u64 probe_key = gi_scene_probe_corner_key(in_max_depth_coords);
-	auto existing_probe = out_probe_indices_by_corner.find(probe_key);
-	if (existing_probe != out_probe_indices_by_corner.end())
-	{
-		GI_Probe& probe = out_gi_scene.probes[existing_probe->second];
-		probe.max_radial_depth = std::max(probe.max_radial_depth, in_required_radial_depth);
-		probe.octree_level = std::min(probe.octree_level, in_octree_level);
-		return existing_probe->second;
-	}
-
-	const i32 probe_index = (i32) out_gi_scene.probes.length();
-	const HMM_Vec3 probe_position = gi_scene_lattice_position(out_gi_scene.scene_bounds, out_gi_scene.leaf_divisions, in_max_depth_coords);
-	out_gi_scene.probes.add(gi_scene_make_probe(
-		probe_position, in_required_radial_depth, in_octree_level));
-	out_probe_indices_by_corner[probe_key] = probe_index;
-	return probe_index;
-}
-
-i32 gi_scene_add_node_payload(
-	GI_Scene& out_gi_scene,
-	ankerl::unordered_dense::map<u64, i32>& out_probe_indices_by_corner,
-	const i32 in_depth,
-	const GI_Coords in_coords)
-{
-	const i32 coord_scale = 1 << (out_gi_scene.octree_depth - in_depth);
-	const f32 cell_extent = gi_scene_cell_extent_from_depth(out_gi_scene, in_depth);
-	const f32 required_radial_depth = gi_scene_max_radial_depth_from_cell_extent(cell_extent);
-
-	if (out_gi_scene.payload_count == 0)
-	{
-		out_gi_scene.min_occupied_cell_extent = cell_extent;
-		out_gi_scene.max_occupied_cell_extent = cell_extent;
-	}
-	else
-	{
-		out_gi_scene.min_occupied_cell_extent = std::min(out_gi_scene.min_occupied_cell_extent, cell_extent);
-		out_gi_scene.max_occupied_cell_extent = std::max(out_gi_scene.max_occupied_cell_extent, cell_extent);
-	}
-	out_gi_scene.max_radial_depth = std::max(out_gi_scene.max_radial_depth, required_radial_depth);
-
-	GI_Cell cell = {};
-	for (i32 corner_z = 0; corner_z < 2; ++corner_z)
-	{
-		for (i32 corner_y = 0; corner_y < 2; ++corner_y)
-		{
-			for (i32 corner_x = 0; corner_x < 2; ++corner_x)
-			{
-				const GI_Coords probe_coords = {
-					(in_coords.x + corner_x) * coord_scale,
-					(in_coords.y + corner_y) * coord_scale,
-					(in_coords.z + corner_z) * coord_scale,
-				};
-				const i32 corner_index = corner_x + corner_y * 2 + corner_z * 4;
-				cell.probe_indices[corner_index] = gi_scene_get_or_create_probe(
-					out_gi_scene,
-					out_probe_indices_by_corner,
-					probe_coords,
-					required_radial_depth,
-					in_depth);
-			}
-		}
-	}
-
-	const i32 payload_index = (i32) out_gi_scene.cells.length();
-	out_gi_scene.cells.add(cell);
-	out_gi_scene.payload_count += 1;
-	return payload_index;
-}
-
-GI_OctreeNode gi_scene_make_octree_node(const BoundingBox& in_bounds)
-{
-	GI_OctreeNode node = {};
-	node.min = HMM_V4V(in_bounds.min, 1.0f);
-	node.max = HMM_V4V(in_bounds.max, 1.0f);
-	node.is_leaf = 1;
-	node.payload_index = -1;
-	node.padding[0] = node.padding[1] = 0;
-	for (i32 i = 0; i < 8; ++i)
-	{
-		node.child_indices[i] = -1;
-	}
-	return node;
-}
-
-void gi_scene_init_empty_octree(GI_Scene& out_gi_scene)
-{
-	out_gi_scene.octree_nodes.add(gi_scene_make_octree_node(out_gi_scene.scene_bounds));
-	gi_scene_init_empty_cell_sentinel(out_gi_scene);
-}
-
-i32 gi_scene_build_sparse_octree_node(
-	GI_Scene& out_gi_scene,
-	const DynamicArray<BoundingBox>& in_geometry_bounds,
-	ankerl::unordered_dense::map<u64, i32>& out_probe_indices_by_corner,
-	const BoundingBox& in_bounds,
-	const i32 in_depth,
-	const GI_Coords in_coords)
-{
-	GI_OctreeNode node = gi_scene_make_octree_node(in_bounds);
-	node.payload_index = gi_scene_add_node_payload(out_gi_scene, out_probe_indices_by_corner, in_depth, in_coords);
-
-	const i32 node_index = (i32) out_gi_scene.octree_nodes.length();
-	out_gi_scene.octree_nodes.add(node);
-
-	if (in_depth >= out_gi_scene.octree_depth)
-	{
-		return node_index;
-	}
-
-	i32 child_count = 0;
-	for (i32 child_z = 0; child_z < 2; ++child_z)
-	{
-		for (i32 child_y = 0; child_y < 2; ++child_y)
-		{
-			for (i32 child_x = 0; child_x < 2; ++child_x)
-			{
-				const BoundingBox child_bounds = gi_scene_child_bounds(in_bounds, child_x, child_y, child_z);
-				if (!gi_scene_bounds_intersect_any(child_bounds, in_geometry_bounds))
-				{
-					continue;
-				}
-
-				const GI_Coords child_coords = {
-					in_coords.x * 2 + child_x,
-					in_coords.y * 2 + child_y,
-					in_coords.z * 2 + child_z,
-				};
-				const i32 child_slot = child_x + child_y * 2 + child_z * 4;
-				const i32 child_index = gi_scene_build_sparse_octree_node(out_gi_scene, in_geometry_bounds, out_probe_indices_by_corner, child_bounds, in_depth + 1, child_coords);
-				out_gi_scene.octree_nodes[node_index].child_indices[child_slot] = child_index;
-				child_count += 1;
-			}
-		}
-	}
-
-	out_gi_scene.octree_nodes[node_index].is_leaf = child_count == 0 ? 1 : 0;
-	return node_index;
-}
-
+// Radiance storage covers every probe slot a layout of this depth can use,
+// so layout patches keep the captured SH9/SG9 data in place
 void gi_scene_init_radiance_buffers(GI_Scene& out_gi_scene)
 {
-	out_gi_scene.sh9_coefficients.add_uninitialized(out_gi_scene.probes.length() * 9);
-	out_gi_scene.sg9_lobes.add_uninitialized(out_gi_scene.probes.length() * 9);
+	out_gi_scene.sh9_coefficients.reset();
+	out_gi_scene.sg9_lobes.reset();
+	out_gi_scene.sh9_coefficients.add_uninitialized(GI_Scene::maximum_lattice_probe_count * 9);
+	out_gi_scene.sg9_lobes.add_uninitialized(GI_Scene::maximum_lattice_probe_count * 9);
 
 	for (HMM_Vec4& coefficient : out_gi_scene.sh9_coefficients)
 	{
@@ -443,20 +126,25 @@ void gi_scene_init_radiance_buffers(GI_Scene& out_gi_scene)
 	}
 }
 
-void gi_scene_recreate_gpu_buffers(GI_Scene& out_gi_scene)
+// Re-uploads the octree, cells and probes (replaced buffers retire against
+// the current frame fence)
+void gi_scene_recreate_layout_gpu_buffers(GI_Scene& out_gi_scene)
 {
-	gi_scene_destroy_layout_gpu_resources(out_gi_scene);
+	GI_Layout& layout = out_gi_scene.layout;
+	out_gi_scene.octree_nodes_buffer.destroy_gpu_buffer();
+	out_gi_scene.probes_buffer.destroy_gpu_buffer();
+	out_gi_scene.cells_buffer.destroy_gpu_buffer();
 
 	out_gi_scene.octree_nodes_buffer = GpuBuffer((GpuBufferDesc<GI_OctreeNode>){
-		.data = out_gi_scene.octree_nodes.data(),
-		.size = sizeof(GI_OctreeNode) * out_gi_scene.octree_nodes.length(),
+		.data = layout.octree_nodes.data(),
+		.size = sizeof(GI_OctreeNode) * layout.octree_nodes.length(),
 		.usage = { .storage_buffer = true },
 		.label = "GI Octree Nodes Buffer",
 	});
 
 	out_gi_scene.probes_buffer = GpuBuffer((GpuBufferDesc<GI_Probe>){
-		.data = out_gi_scene.probes.data(),
-		.size = sizeof(GI_Probe) * out_gi_scene.probes.length(),
+		.data = layout.probes.data(),
+		.size = sizeof(GI_Probe) * layout.probes.length(),
 		.usage = {
 			.storage_buffer = true,
 			.stream_update = true,	// atlas indices assigned as probes update
@@ -465,11 +153,17 @@ void gi_scene_recreate_gpu_buffers(GI_Scene& out_gi_scene)
 	});
 
 	out_gi_scene.cells_buffer = GpuBuffer((GpuBufferDesc<GI_Cell>){
-		.data = out_gi_scene.cells.data(),
-		.size = sizeof(GI_Cell) * out_gi_scene.cells.length(),
+		.data = layout.cells.data(),
+		.size = sizeof(GI_Cell) * layout.cells.length(),
 		.usage = { .storage_buffer = true },
 		.label = "GI Cells Buffer",
 	});
+}
+
+void gi_scene_recreate_gpu_buffers(GI_Scene& out_gi_scene)
+{
+	gi_scene_destroy_layout_gpu_resources(out_gi_scene);
+	gi_scene_recreate_layout_gpu_buffers(out_gi_scene);
 
 	out_gi_scene.sh9_coefficients_buffer = GpuBuffer((GpuBufferDesc<HMM_Vec4>){
 		.data = out_gi_scene.sh9_coefficients.data(),
@@ -486,38 +180,34 @@ void gi_scene_recreate_gpu_buffers(GI_Scene& out_gi_scene)
 	});
 }
 
+void gi_scene_clear_pending_layout_edits(State& in_state)
+{
+	in_state.gi.layout_dirty = false;
+	in_state.gi.layout_rebuild_all = false;
+	in_state.gi.layout_dirty_regions.reset();
+}
+
 void gi_scene_rebuild_layout(VulkanContext* ctx, GI_Scene& out_gi_scene, State& in_state)
 {
-	out_gi_scene.octree_depth = std::clamp(in_state.gi.octree_depth, GI_Scene::min_octree_depth, GI_Scene::max_octree_depth);
-	in_state.gi.octree_depth = out_gi_scene.octree_depth;
-	out_gi_scene.leaf_divisions = gi_scene_leaf_divisions_from_depth(out_gi_scene.octree_depth);
+	GI_Layout& layout = out_gi_scene.layout;
 	DynamicArray<BoundingBox> geometry_bounds;
-	const bool has_visible_geometry = gi_scene_collect_visible_mesh_bounds(in_state, geometry_bounds, out_gi_scene.scene_bounds);
-	out_gi_scene.leaf_cell_extent = (out_gi_scene.scene_bounds.max.X - out_gi_scene.scene_bounds.min.X) / (f32) out_gi_scene.leaf_divisions;
-
-	gi_scene_reset_layout_buffers(out_gi_scene);
-	if (has_visible_geometry)
-	{
-		ankerl::unordered_dense::map<u64, i32> probe_indices_by_corner;
-		gi_scene_build_sparse_octree_node(out_gi_scene, geometry_bounds, probe_indices_by_corner, out_gi_scene.scene_bounds, 0, (GI_Coords){0, 0, 0});
-	}
-	else
-	{
-		gi_scene_init_empty_octree(out_gi_scene);
-	}
-	gi_scene_add_fallback_probe(out_gi_scene);
+	BoundingBox scene_bounds = {};
+	gi_scene_collect_visible_mesh_bounds(in_state, geometry_bounds, scene_bounds);
+	gi_layout_build(layout, geometry_bounds, scene_bounds, in_state.gi.octree_depth);
+	in_state.gi.octree_depth = layout.octree_depth;
 	gi_scene_init_radiance_buffers(out_gi_scene);
 
-	assert(out_gi_scene.probes.length() <= (size_t) gi_scene_atlas_capacity());
-	assert(out_gi_scene.probes.length() > 0);
-	assert(out_gi_scene.octree_nodes.length() > 0);
-	assert(out_gi_scene.cells.length() > 0);
+	assert(layout.probes.length() <= (size_t) GI_Scene::maximum_lattice_probe_count);
+	assert(layout.probes.length() <= (size_t) gi_scene_atlas_capacity());
+	assert(layout.probes.length() > 0);
+	assert(layout.octree_nodes.length() > 0);
+	assert(layout.cells.length() > 0);
 	gi_scene_recreate_gpu_buffers(out_gi_scene);
-	out_gi_scene.lighting_capture.resize_specular_atlas(ctx, (i32)out_gi_scene.probes.length());
+	out_gi_scene.lighting_capture.resize_specular_atlas(ctx, (i32)layout.probes.length());
 
-	out_gi_scene.probe_idx_to_update = 0;
-	out_gi_scene.next_atlas_index = 0;
-	in_state.gi.layout_dirty = false;
+	gi_probe_scheduler_reset(out_gi_scene.scheduler, (i32) layout.probes.length());
+	gi_probe_scheduler_mark_all(out_gi_scene.scheduler, layout.probes, ctx->frame_number);
+	gi_scene_clear_pending_layout_edits(in_state);
 	in_state.gi.is_updating = true;
 	in_state.gi.isolated_probe_index = -1;
 
@@ -525,29 +215,91 @@ void gi_scene_rebuild_layout(VulkanContext* ctx, GI_Scene& out_gi_scene, State&
 	{
 		printf(
 			"GI octree depth: %d nodes: %zu payloads: %d probes: %zu min/max cell extent: %f/%f max radial depth: %f\n",
-			out_gi_scene.octree_depth,
-			out_gi_scene.octree_nodes.length(),
-			out_gi_scene.payload_count,
-			out_gi_scene.probes.length(),
-			out_gi_scene.min_occupied_cell_extent,
-			out_gi_scene.max_occupied_cell_extent,
-			out_gi_scene.max_radial_depth
+			layout.octree_depth,
+			layout.octree_nodes.length(),
+			layout.payload_count,
+			layout.probes.length(),
+			layout.min_occupied_cell_extent,
+			layout.max_occupied_cell_extent,
+			layout.max_radial_depth
 		);
 	}
 }
 
+// Applies queued geometry edits: patches the layout around the changed
+// objects' old and new bounds, or rebuilds when the lattice changed (scene
+// cube, depth), the scene was cleared, or too many edits piled up. Patched
+// probes keep their radiance; the ones near an edit are queued for capture.
+void gi_scene_update_layout(VulkanContext* ctx, GI_Scene& io_gi_scene, State& in_state)
+{
+	GI_Layout& layout = io_gi_scene.layout;
+	const DynamicArray<BoundingBox>& dirty_regions = in_state.gi.layout_dirty_regions;
+	bool patched = false;
+	GI_LayoutPatchStats patch_stats = {};
+	if (!in_state.gi.layout_rebuild_all
+		&& dirty_regions.length() > 0
+		&& dirty_regions.length() <= (size_t) GI_Scene::maximum_patch_regions)
+	{
+		DynamicArray<BoundingBox> geometry_bounds;
+		BoundingBox scene_bounds = {};
+		gi_scene_collect_visible_mesh_bounds(in_state, geometry_bounds, scene_bounds);
+		patched = gi_layout_patch(layout, geometry_bounds, scene_bounds, in_state.gi.octree_depth, dirty_regions, &patch_stats);
+	}
+
+	if (!patched)
+	{
+		printf("GI Scene Layout Dirty. Rebuilding...\n");
+		// Replaced buffers/images retire against the current frame fence.
+		gi_scene_rebuild_layout(ctx, io_gi_scene, in_state);
+		return;
+	}
+
+	assert(layout.probes.length() <= (size_t) GI_Scene::maximum_lattice_probe_count);
+	gi_scene_recreate_layout_gpu_buffers(io_gi_scene);
+	gi_probe_scheduler_resize(io_gi_scene.scheduler, (i32) layout.probes.length());
+	if ((i32) layout.probes.length() > io_gi_scene.lighting_capture.specular_atlas_capacity)
+	{
+		// A larger specular atlas starts cleared: recapture everything
+		io_gi_scene.lighting_capture.resize_specular_atlas(ctx, (i32) layout.probes.length());
+		gi_probe_scheduler_mark_all(io_gi_scene.scheduler, layout.probes, ctx->frame_number);
+	}
+	gi_probe_scheduler_mark_regions(io_gi_scene.scheduler, layout.probes, dirty_regions, ctx->frame_number);
+	if (in_state.gi.isolated_probe_index >= 0
+		&& (in_state.gi.isolated_probe_index >= (i32) layout.probes.length()
+			|| !gi_layout_probe_is_used(layout.probes[in_state.gi.isolated_probe_index])))
+	{
+		in_state.gi.isolated_probe_index = -1;
+	}
+
+	if (GI_LOG_SCENE_UPDATE)
+	{
+		printf(
+			"GI layout patch: %zu regions, %d nodes tested, nodes +%d -%d, probes +%d -%d, %d stale\n",
+			dirty_regions.length(),
+			patch_stats.nodes_tested,
+			patch_stats.nodes_added,
+			patch_stats.nodes_removed,
+			patch_stats.probes_added,
+			patch_stats.probes_removed,
+			io_gi_scene.scheduler.stale_count
+		);
+	}
+	gi_scene_clear_pending_layout_edits(in_state);
+}
+
 f32 gi_scene_debug_probe_radius(const GI_Scene& in_gi_scene)
 {
-	return std::max(in_gi_scene.leaf_cell_extent * 0.1f, 0.025f);
+	return std::max(in_gi_scene.layout.leaf_cell_extent * 0.1f, 0.025f);
 }
 
 f32 gi_scene_debug_probe_radius_for_probe(const GI_Scene& in_gi_scene, const i32 in_probe_index)
 {
-	assert(in_gi_scene.probes.is_valid_index(in_probe_index));
-	const i32 probe_level = in_gi_scene.probes[in_probe_index].octree_level;
+	const GI_Layout& layout = in_gi_scene.layout;
+	assert(layout.probes.is_valid_index(in_probe_index));
+	const i32 probe_level = layout.probes[in_probe_index].octree_level;
 	const i32 levels_above_deepest = probe_level < 0
-		? in_gi_scene.octree_depth + 1
-		: std::clamp(in_gi_scene.octree_depth - probe_level, 0, in_gi_scene.octree_depth);
+		? layout.octree_depth + 1
+		: std::clamp(layout.octree_depth - probe_level, 0, layout.octree_depth);
 	return gi_scene_debug_probe_radius(in_gi_scene)
 		* std::pow(1.1f, (f32) levels_above_deepest);
 }
@@ -558,23 +310,24 @@ bool gi_scene_debug_probe_matches_level_filter(
 	const bool in_filter_enabled,
 	const i32 in_filter_selection)
 {
-	assert(in_gi_scene.probes.is_valid_index(in_probe_index));
-	const i32 probe_level = in_gi_scene.probes[in_probe_index].octree_level;
+	const GI_Layout& layout = in_gi_scene.layout;
+	assert(layout.probes.is_valid_index(in_probe_index));
+	const i32 probe_level = layout.probes[in_probe_index].octree_level;
 	if (!in_filter_enabled)
 	{
 		return probe_level >= 0;
 	}
 	const i32 filter_selection = std::clamp(
-		in_filter_selection, 0, in_gi_scene.octree_depth + 1);
+		in_filter_selection, 0, layout.octree_depth + 1);
 	return filter_selection == 0
-		? probe_level < 0
+		? probe_level == GI_PROBE_LEVEL_FALLBACK
 		: probe_level == filter_selection - 1;
 }
 
 HMM_Vec3 gi_scene_probe_position_from_index(GI_Scene& in_gi_scene, const i32 in_probe_index)
 {
-	assert(in_gi_scene.probes.is_valid_index(in_probe_index));
-	return in_gi_scene.probes[in_probe_index].position.XYZ;
+	assert(in_gi_scene.layout.probes.is_valid_index(in_probe_index));
+	return in_gi_scene.layout.probes[in_probe_index].position.XYZ;
 }
 
 void gi_scene_init(VulkanContext* ctx, GI_Scene& out_gi_scene, State& in_state)
@@ -593,49 +346,91 @@ void gi_scene_init(VulkanContext* ctx, GI_Scene& out_gi_scene, State& in_state)
 	gi_scene_rebuild_layout(ctx, out_gi_scene, in_state);
 }
 
-// Records this frame's probe captures into the command buffer (a few probes
-// per frame while is_updating). Call after begin_frame + descriptor updates,
-// before the main pass chain executes.
-void gi_scene_update(VulkanContext* ctx, GI_Scene& in_gi_scene, State& in_state)
+// Feeds the GPU time of the last measured capture batch into the scheduler's
+// per-probe cost once its frame has completed (debug-UI builds only; other
+// builds keep the default estimate)
+void gi_scene_collect_capture_timing(GI_Scene& io_gi_scene)
+{
+	if (io_gi_scene.pending_timing_frame < 0)
+	{
+		return;
+	}
+
+	i64 latest_frame = -1;
+	f64 latest_frame_ms = 0.0;
+	if (!gpu_timings_get_latest_completed_frame(latest_frame, latest_frame_ms)
+		|| latest_frame < io_gi_scene.pending_timing_frame)
+	{
+		return;
+	}
+
+	f64 capture_ms = 0.0;
+	if (gpu_timings_find_scope_ms(io_gi_scene.pending_timing_frame, GI_PROBE_CAPTURE_TIMING_SCOPE, capture_ms))
+	{
+		gi_probe_scheduler_record_gpu_time(io_gi_scene.scheduler, capture_ms, io_gi_scene.pending_timing_probe_count);
+	}
+	io_gi_scene.pending_timing_frame = -1;
+}
+
+// Records this frame's probe captures into the command buffer: the highest
+// priority stale probes, as many as state.gi.update_budget_ms buys. Call after
+// begin_frame + descriptor updates, before the main pass chain executes.
+void gi_scene_update(
+	VulkanContext* ctx,
+	GI_Scene& in_gi_scene,
+	State& in_state,
+	const HMM_Vec3 in_camera_location,
+	const HMM_Mat4& in_view_projection)
 {
 	in_gi_scene.lighting_capture.begin_frame(ctx);
+	gi_scene_collect_capture_timing(in_gi_scene);
 
+	// is_updating raised while nothing is stale asks for a full refresh
+	const bool refresh_requested = in_state.gi.is_updating && in_gi_scene.scheduler.stale_count == 0;
 	if (in_state.gi.layout_dirty)
 	{
-		printf("GI Scene Layout Dirty. Rebuilding...\n");
-		// Replaced buffers/images retire against the current frame fence.
-		gi_scene_rebuild_layout(ctx, in_gi_scene, in_state);
+		gi_scene_update_layout(ctx, in_gi_scene, in_state);
+	}
+	GI_Layout& layout = in_gi_scene.layout;
+	if (refresh_requested)
+	{
+		gi_probe_scheduler_mark_all(in_gi_scene.scheduler, layout.probes, ctx->frame_number);
 	}
 
-	if (!in_state.gi.is_updating)
+	const i32 capture_count = gi_probe_scheduler_budget_count(
+		in_gi_scene.scheduler, in_state.gi.update_budget_ms, LightingCapture::MAX_CAPTURES_PER_FRAME);
+	gi_probe_scheduler_select(
+		in_gi_scene.scheduler, layout.probes, in_camera_location, in_view_projection,
+		ctx->frame_number, capture_count, in_gi_scene.probes_to_capture);
+	in_state.gi.is_updating = in_gi_scene.scheduler.stale_count > 0;
+	if (in_gi_scene.probes_to_capture.length() == 0)
 	{
 		return;
 	}
 
-	assert(in_gi_scene.probes.is_valid_index(in_gi_scene.probe_idx_to_update));
-
 	bool needs_gpu_update = false;
-	for (i32 i = 0; i < GI_Scene::probes_to_update_per_frame; ++i)
+	const i32 timing_slot = gpu_timestamps_begin_scope(ctx, GI_PROBE_CAPTURE_TIMING_SCOPE);
+	for (const i32 probe_index : in_gi_scene.probes_to_capture)
 	{
-		GI_Probe& probe_to_update = in_gi_scene.probes[in_gi_scene.probe_idx_to_update];
+		GI_Probe& probe_to_update = layout.probes[probe_index];
 
+		// Atlas slots follow probe slots, so a patch never moves radiance
 		if (probe_to_update.atlas_idx < 0)
 		{
-			assert(in_gi_scene.next_atlas_index < gi_scene_atlas_capacity());
-			probe_to_update.atlas_idx = in_gi_scene.next_atlas_index;
-			in_gi_scene.next_atlas_index += 1;
+			assert(probe_index < gi_scene_atlas_capacity());
+			probe_to_update.atlas_idx = probe_index;
 			needs_gpu_update = true;
 		}
 
 		const HMM_Vec3 lighting_capture_position = probe_to_update.position.XYZ;
-		const bool should_render_geometry = in_gi_scene.probe_idx_to_update != in_gi_scene.fallback_probe_index;
+		const bool should_render_geometry = probe_index != layout.fallback_probe_index;
 		in_gi_scene.lighting_capture.render(
 			ctx,
 			in_state,
 			lighting_capture_position,
 			probe_to_update.atlas_idx,
 			should_render_geometry,
-			in_gi_scene.probe_idx_to_update,
+			probe_index,
 			probe_to_update.max_radial_depth,
 			in_gi_scene.sh9_coefficients_buffer.get_gpu_buffer(),
 			in_gi_scene.sg9_lobes_buffer.get_gpu_buffer()
@@ -644,29 +439,29 @@ void gi_scene_update(VulkanContext* ctx, GI_Scene& in_gi_scene, State& in_state)
 		if (GI_LOG_SCENE_UPDATE)
 		{
 			printf(
-				"Updating GI Probe %i/%zu at Position: %f, %f, %f\n",
-				in_gi_scene.probe_idx_to_update,
-				in_gi_scene.probes.length(),
+				"Updating GI Probe %i/%zu at Position: %f, %f, %f (%d stale)\n",
+				probe_index,
+				layout.probes.length(),
 				lighting_capture_position.X,
 				lighting_capture_position.Y,
-				lighting_capture_position.Z
+				lighting_capture_position.Z,
+				in_gi_scene.scheduler.stale_count
 			);
 		}
+	}
+	gpu_timestamps_end_scope(ctx, timing_slot);
 
-		in_gi_scene.probe_idx_to_update = (in_gi_scene.probe_idx_to_update + 1) % (i32) in_gi_scene.probes.length();
-
-		if (in_gi_scene.probe_idx_to_update == 0)
-		{
-			in_state.gi.is_updating = false;
-			break;
-		}
+	if (timing_slot >= 0 && in_gi_scene.pending_timing_frame < 0)
+	{
+		in_gi_scene.pending_timing_frame = cpu_timings_get_current_frame_index();
+		in_gi_scene.pending_timing_probe_count = (i32) in_gi_scene.probes_to_capture.length();
 	}
 
 	if (needs_gpu_update)
 	{
 		in_gi_scene.probes_buffer.update_gpu_buffer(
-			in_gi_scene.probes.data(),
-			sizeof(GI_Probe) * in_gi_scene.probes.length()
+			layout.probes.data(),
+			sizeof(GI_Probe) * layout.probes.length()
 		);
 	}
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/gi.h"
 
 namespace GIDebugPass
@@ -27,7 +27,7 @@ namespace GIDebugPass
 	inline VkDescriptorPool pool = VK_NULL_HANDLE;
 	inline VkDescriptorSet sets[MAX_FRAMES_IN_FLIGHT] = {};
 	inline VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
-	inline VkPipeline pipeline = VK_NULL_HANDLE;
+	inline DeferredPipeline pipeline;	// probe view only; built when first shown
 	inline Mesh sphere_mesh;
 
 	inline void init(VulkanContext* ctx)
@@ -73,8 +73,8 @@ namespace GIDebugPass
 		};
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_info, nullptr, &pipeline_layout));
 
-		VkShaderModule vs = create_shader_module_from_file(ctx->device, "bin/shaders/gi_debug.vert.spv");
-		VkShaderModule fs = create_shader_module_from_file(ctx->device, "bin/shaders/gi_debug.frag.spv");
+		VkShaderModule vs = PipelineBuildService::shader_module(ctx, "bin/shaders/gi_debug.vert.spv");
+		VkShaderModule fs = PipelineBuildService::shader_module(ctx, "bin/shaders/gi_debug.frag.spv");
 		VkPipelineShaderStageCreateInfo stages[] = {
 			{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = vs, .pName = "main" },
 			{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = fs, .pName = "main" },
@@ -109,8 +109,7 @@ namespace GIDebugPass
 			.pDepthStencilState = &depth, .pColorBlendState = &blending,
 			.pDynamicState = &dynamic, .layout = pipeline_layout,
 		};
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_info, &pipeline));
-		vkDestroyShaderModule(ctx->device, vs, nullptr); vkDestroyShaderModule(ctx->device, fs, nullptr);
+		PipelineBuildService::defer_graphics(pipeline_info, &pipeline);
 
 		MeshInitData sphere_init = mesh_init_data_uv_sphere(1.0f, 12, 16);
 		sphere_mesh = make_mesh(sphere_init);
@@ -119,7 +118,7 @@ namespace GIDebugPass
 
 	inline void draw(VulkanContext* ctx, GI_Scene& gi_scene, State& state, const HMM_Mat4& view_projection)
 	{
-		if (!state.gi.show_probes || gi_scene.probes.empty()) { return; }
+		if (!state.gi.show_probes || gi_scene.layout.probes.empty()) { return; }
 		VkDescriptorBufferInfo buffers[] = {
 			{ .buffer = gi_scene.probes_buffer.get_gpu_buffer(), .range = VK_WHOLE_SIZE },
 			{ .buffer = gi_scene.probes_buffer.get_gpu_buffer(), .range = VK_WHOLE_SIZE },
@@ -143,7 +142,7 @@ namespace GIDebugPass
 				.pBufferInfo = image ? nullptr : &buffers[buffer_idx] };
 		}
 		vulkan_update_descriptor_sets(ctx, 7, writes);
-		PushConstants params = { .view_projection = view_projection, .octree_depth = gi_scene.octree_depth,
+		PushConstants params = { .view_projection = view_projection, .octree_depth = gi_scene.layout.octree_depth,
 			.probe_debug_radius = gi_scene_debug_probe_radius(gi_scene), .atlas_total_size = GI_Scene::atlas_total_size,
 			.atlas_entry_size = GI_Scene::atlas_entry_size, .probe_vis_mode = (i32) state.gi.probe_vis_mode,
 			.isolated_probe_index = state.gi.probe_isolation_enable ? state.gi.isolated_probe_index : -1,
@@ -153,22 +152,22 @@ namespace GIDebugPass
 			.specular_debug_roughness = state.gi.specular_debug_roughness,
 			.probe_level_filter_enable = state.gi.probe_level_filter_enable ? 1 : 0,
 			.probe_level_filter_selection = std::clamp(
-				state.gi.probe_level_filter_selection, 0, gi_scene.octree_depth + 1) };
+				state.gi.probe_level_filter_selection, 0, gi_scene.layout.octree_depth + 1) };
 		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
-		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineBuildService::resolve(ctx, pipeline));
 		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &sets[ctx->frame_index], 0, nullptr);
 		vkCmdPushConstants(command_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(params), &params);
 		VkBuffer vertex = sphere_mesh.vertex_buffer.get_gpu_buffer(); VkDeviceSize offset = 0;
 		vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex, &offset);
 		vkCmdBindIndexBuffer(command_buffer, sphere_mesh.index_buffer.get_gpu_buffer(), 0, VK_INDEX_TYPE_UINT32);
-		vulkan_cmd_draw_indexed(ctx, sphere_mesh.index_count, (u32)gi_scene.probes.length(), 0, 0, 0);
+		vulkan_cmd_draw_indexed(ctx, sphere_mesh.index_count, (u32)gi_scene.layout.probes.length(), 0, 0, 0);
 	}
 
 	inline void shutdown(VulkanContext* ctx)
 	{
 		free(sphere_mesh.vertices); free(sphere_mesh.indices); free(sphere_mesh.wire_indices); free(sphere_mesh.material_indices);
 		sphere_mesh.vertex_buffer.destroy_gpu_buffer(); sphere_mesh.index_buffer.destroy_gpu_buffer(); sphere_mesh.wire_index_buffer.destroy_gpu_buffer();
-		vkDestroyPipeline(ctx->device, pipeline, nullptr); vkDestroyPipelineLayout(ctx->device, pipeline_layout, nullptr);
+		PipelineBuildService::destroy(ctx, pipeline); vkDestroyPipelineLayout(ctx->device, pipeline_layout, nullptr);
 		vkDestroyDescriptorPool(ctx->device, pool, nullptr); vkDestroyDescriptorSetLayout(ctx->device, set_layout, nullptr);
 	}
 }
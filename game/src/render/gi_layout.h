@@ -0,0 +1,689 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ankerl/unordered_dense.h"
+#include "core/types.h"
+#include "core/dynamic_array.h"
+
+#include "gi_helpers.h"
+
+// ---- GI probe layout ----
+// CPU side of the GI probe scene: a sparse octree over the static scene
+// geometry (a node exists where any geometry box touches its bounds), one
+// cell per node with probes at its eight corners, and a fallback probe at the
+// scene centre. Probes sit on the deepest level's lattice and are shared by
+// every cell with a corner there; a probe takes the shallowest referencing
+// cell's level and radial depth.
+//
+// gi_layout_build rebuilds everything. gi_layout_patch applies geometry edits
+// in place: only nodes touching a dirty region (a changed object's old or new
+// box) are re-tested, subtrees are added or released there, and probes keep
+// their indices (and so their captured radiance) unless no cell references
+// them any more. Released slots are reused before the arrays grow. The patch
+// requires the same scene cube and depth, since those fix the lattice.
+
+static_assert(sizeof(GI_Cell) == 32, "GI_Cell must match shader storage layout.");
+static_assert(sizeof(GI_Probe) == 32, "GI_Probe must match shader storage layout.");
+static_assert(sizeof(GI_OctreeNode) == 80, "GI_OctreeNode must match shader storage layout.");
+
+struct GI_Layout
+{
+	static constexpr i32 min_octree_depth = 1;
+	static constexpr i32 max_octree_depth = 4;
+	static constexpr f32 fallback_scene_extent = 30.0f;
+	static constexpr f32 minimum_scene_extent = 1.0f;
+	static constexpr f32 radial_depth_cell_scale = (f32) GI_RADIAL_DEPTH_CELL_SCALE;
+
+	DynamicArray<GI_OctreeNode> octree_nodes;
+	DynamicArray<GI_Cell> cells;
+	DynamicArray<GI_Probe> probes;
+
+	// Deepest-level lattice corner -> probe index
+	ankerl::unordered_dense::map<u64, i32> probe_indices_by_corner;
+	// Slots released by patches
+	DynamicArray<i32> free_node_indices;
+	DynamicArray<i32> free_cell_indices;
+	DynamicArray<i32> free_probe_indices;
+	i32 cells_per_depth[max_octree_depth + 1] = {};
+
+	BoundingBox scene_bounds = {};
+	i32 octree_depth = 4;
+	i32 leaf_divisions = 16;
+	i32 fallback_probe_index = -1;
+	i32 non_fallback_probe_count = 0;
+	i32 payload_count = 0;
+	f32 leaf_cell_extent = 1.0f;
+	f32 max_radial_depth = 4.0f;
+	f32 min_occupied_cell_extent = 0.0f;
+	f32 max_occupied_cell_extent = 0.0f;
+	bool has_geometry = false;
+};
+
+struct GI_LayoutPatchStats
+{
+	i32 nodes_tested = 0;	// occupancy tests against the geometry
+	i32 nodes_added = 0;
+	i32 nodes_removed = 0;
+	i32 probes_added = 0;
+	i32 probes_removed = 0;
+};
+
+i32 gi_layout_leaf_divisions_from_depth(const i32 in_octree_depth)
+{
+	return 1 << in_octree_depth;
+}
+
+HMM_Vec3 gi_layout_bounds_center(const BoundingBox& in_bounds)
+{
+	return (in_bounds.min + in_bounds.max) * 0.5f;
+}
+
+BoundingBox gi_layout_cube_bounds_from_center_extent(const HMM_Vec3 in_center, const f32 in_extent)
+{
+	const HMM_Vec3 half_extent = HMM_V3(in_extent, in_extent, in_extent) * 0.5f;
+	return (BoundingBox) {
+		.min = in_center - half_extent,
+		.max = in_center + half_extent,
+	};
+}
+
+BoundingBox gi_layout_expand_bounds_to_cube(const BoundingBox& in_bounds)
+{
+	const HMM_Vec3 extent = in_bounds.max - in_bounds.min;
+	f32 cube_extent = std::max(extent.X, std::max(extent.Y, extent.Z));
+	if (!std::isfinite(cube_extent) || cube_extent < GI_Layout::minimum_scene_extent)
+	{
+		cube_extent = GI_Layout::minimum_scene_extent;
+	}
+	return gi_layout_cube_bounds_from_center_extent(gi_layout_bounds_center(in_bounds), cube_extent);
+}
+
+// Scene cube around in_geometry_bounds, or the fallback cube when empty
+BoundingBox gi_layout_scene_bounds(const DynamicArray<BoundingBox>& in_geometry_bounds)
+{
+	if (in_geometry_bounds.length() == 0)
+	{
+		return gi_layout_cube_bounds_from_center_extent(HMM_V3(0.0f, 0.0f, 0.0f), GI_Layout::fallback_scene_extent);
+	}
+
+	BoundingBox scene_bounds = bounding_box_init();
+	for (const BoundingBox& geometry_bounds : in_geometry_bounds)
+	{
+		bounding_box_expand(scene_bounds, geometry_bounds);
+	}
+	return gi_layout_expand_bounds_to_cube(scene_bounds);
+}
+
+bool gi_layout_bounds_equal(const BoundingBox& in_a, const BoundingBox& in_b)
+{
+	return in_a.min.X == in_b.min.X && in_a.min.Y == in_b.min.Y && in_a.min.Z == in_b.min.Z &&
+		in_a.max.X == in_b.max.X && in_a.max.Y == in_b.max.Y && in_a.max.Z == in_b.max.Z;
+}
+
+HMM_Vec3 gi_layout_lattice_position(const BoundingBox& in_bounds, const i32 in_leaf_divisions, const GI_Coords in_coords)
+{
+	const f32 cell_extent = (in_bounds.max.X - in_bounds.min.X) / (f32) in_leaf_divisions;
+	return in_bounds.min + HMM_V3(
+		(f32) in_coords.x * cell_extent,
+		(f32) in_coords.y * cell_extent,
+		(f32) in_coords.z * cell_extent
+	);
+}
+
+u64 gi_layout_probe_corner_key(const GI_Coords in_coords)
+{
+	assert(in_coords.x >= 0 && in_coords.y >= 0 && in_coords.z >= 0);
+	constexpr u64 coord_mask = (1ull << 21ull) - 1ull;
+	return (((u64) in_coords.x & coord_mask) << 42ull) |
+		(((u64) in_coords.y & coord_mask) << 21ull) |
+		((u64) in_coords.z & coord_mask);
+}
+
+f32 gi_layout_cell_extent_from_depth(const GI_Layout& in_layout, const i32 in_depth)
+{
+	const i32 divisions = 1 << in_depth;
+	return (in_layout.scene_bounds.max.X - in_layout.scene_bounds.min.X) / (f32) divisions;
+}
+
+f32 gi_layout_max_radial_depth_from_cell_extent(const f32 in_cell_extent)
+{
+	return std::max(in_cell_extent * GI_Layout::radial_depth_cell_scale, GI_Layout::minimum_scene_extent);
+}
+
+GI_Probe gi_layout_make_probe(
+	const HMM_Vec3 in_position,
+	const f32 in_max_radial_depth,
+	const i32 in_octree_level)
+{
+	GI_Probe probe = {};
+	probe.position = HMM_V4V(in_position, 1.0f);
+	probe.atlas_idx = -1;
+	probe.max_radial_depth = in_max_radial_depth;
+	probe.octree_level = in_octree_level;
+	probe.padding = 0;
+	return probe;
+}
+
+bool gi_layout_probe_is_used(const GI_Probe& in_probe)
+{
+	return in_probe.octree_level != GI_PROBE_LEVEL_UNUSED;
+}
+
+GI_Cell gi_layout_make_empty_cell()
+{
+	GI_Cell cell = {};
+	for (i32 i = 0; i < 8; ++i)
+	{
+		cell.probe_indices[i] = -1;
+	}
+	return cell;
+}
+
+GI_OctreeNode gi_layout_make_octree_node(const BoundingBox& in_bounds)
+{
+	GI_OctreeNode node = {};
+	node.min = HMM_V4V(in_bounds.min, 1.0f);
+	node.max = HMM_V4V(in_bounds.max, 1.0f);
+	node.is_leaf = 1;
+	node.payload_index = -1;
+	node.padding[0] = node.padding[1] = 0;
+	for (i32 i = 0; i < 8; ++i)
+	{
+		node.child_indices[i] = -1;
+	}
+	return node;
+}
+
+BoundingBox gi_layout_node_bounds(const GI_OctreeNode& in_node)
+{
+	return (BoundingBox) { .min = in_node.min.XYZ, .max = in_node.max.XYZ };
+}
+
+bool gi_layout_bounds_intersect(const BoundingBox& in_a, const BoundingBox& in_b)
+{
+	return in_a.min.X <= in_b.max.X && in_a.max.X >= in_b.min.X &&
+		in_a.min.Y <= in_b.max.Y && in_a.max.Y >= in_b.min.Y &&
+		in_a.min.Z <= in_b.max.Z && in_a.max.Z >= in_b.min.Z;
+}
+
+bool gi_layout_bounds_intersect_any(const BoundingBox& in_bounds, const DynamicArray<BoundingBox>& in_geometry_bounds)
+{
+	for (const BoundingBox& geometry_bounds : in_geometry_bounds)
+	{
+		if (gi_layout_bounds_intersect(in_bounds, geometry_bounds))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+BoundingBox gi_layout_child_bounds(const BoundingBox& in_bounds, const i32 in_child_x, const i32 in_child_y, const i32 in_child_z)
+{
+	const HMM_Vec3 center = (in_bounds.min + in_bounds.max) * 0.5f;
+	return (BoundingBox) {
+		.min = HMM_V3(
+			in_child_x == 0 ? in_bounds.min.X : center.X,
+			in_child_y == 0 ? in_bounds.min.Y : center.Y,
+			in_child_z == 0 ? in_bounds.min.Z : center.Z
+		),
+		.max = HMM_V3(
+			in_child_x == 0 ? center.X : in_bounds.max.X,
+			in_child_y == 0 ? center.Y : in_bounds.max.Y,
+			in_child_z == 0 ? center.Z : in_bounds.max.Z
+		),
+	};
+}
+
+GI_Coords gi_layout_child_coords(const GI_Coords in_coords, const i32 in_child_slot)
+{
+	return (GI_Coords) {
+		in_coords.x * 2 + (in_child_slot & 1),
+		in_coords.y * 2 + ((in_child_slot >> 1) & 1),
+		in_coords.z * 2 + ((in_child_slot >> 2) & 1),
+	};
+}
+
+// Deepest-level lattice coordinates of corner in_corner_index of the cell at
+// (in_depth, in_coords)
+GI_Coords gi_layout_cell_corner_coords(const GI_Layout& in_layout, const i32 in_depth, const GI_Coords in_coords, const i32 in_corner_index)
+{
+	const i32 coord_scale = 1 << (in_layout.octree_depth - in_depth);
+	return (GI_Coords) {
+		(in_coords.x + (in_corner_index & 1)) * coord_scale,
+		(in_coords.y + ((in_corner_index >> 1) & 1)) * coord_scale,
+		(in_coords.z + ((in_corner_index >> 2) & 1)) * coord_scale,
+	};
+}
+
+i32 gi_layout_allocate_node(GI_Layout& io_layout, const GI_OctreeNode& in_node)
+{
+	if (io_layout.free_node_indices.length() > 0)
+	{
+		const i32 node_index = io_layout.free_node_indices[io_layout.free_node_indices.length() - 1];
+		io_layout.free_node_indices.pop();
+		io_layout.octree_nodes[node_index] = in_node;
+		return node_index;
+	}
+	io_layout.octree_nodes.add(in_node);
+	return (i32) io_layout.octree_nodes.length() - 1;
+}
+
+i32 gi_layout_allocate_cell(GI_Layout& io_layout, const GI_Cell& in_cell)
+{
+	if (io_layout.free_cell_indices.length() > 0)
+	{
+		const i32 cell_index = io_layout.free_cell_indices[io_layout.free_cell_indices.length() - 1];
+		io_layout.free_cell_indices.pop();
+		io_layout.cells[cell_index] = in_cell;
+		return cell_index;
+	}
+	io_layout.cells.add(in_cell);
+	return (i32) io_layout.cells.length() - 1;
+}
+
+i32 gi_layout_allocate_probe(GI_Layout& io_layout, const GI_Probe& in_probe)
+{
+	if (io_layout.free_probe_indices.length() > 0)
+	{
+		const i32 probe_index = io_layout.free_probe_indices[io_layout.free_probe_indices.length() - 1];
+		io_layout.free_probe_indices.pop();
+		io_layout.probes[probe_index] = in_probe;
+		return probe_index;
+	}
+	io_layout.probes.add(in_probe);
+	return (i32) io_layout.probes.length() - 1;
+}
+
+i32 gi_layout_get_or_create_probe(
+	GI_Layout& io_layout,
+	const GI_Coords in_max_depth_coords,
+	const f32 in_required_radial_depth,
+	const i32 in_octree_level)
+{
+	const u64 probe_key = gi_layout_probe_corner_key(in_max_depth_coords);
+	auto existing_probe = io_layout.probe_indices_by_corner.find(probe_key);
+	if (existing_probe != io_layout.probe_indices_by_corner.end())
+	{
+		GI_Probe& probe = io_layout.probes[existing_probe->second];
+		probe.max_radial_depth = std::max(probe.max_radial_depth, in_required_radial_depth);
+		probe.octree_level = std::min(probe.octree_level, in_octree_level);
+		return existing_probe->second;
+	}
+
+	const HMM_Vec3 probe_position = gi_layout_lattice_position(io_layout.scene_bounds, io_layout.leaf_divisions, in_max_depth_coords);
+	const i32 probe_index = gi_layout_allocate_probe(io_layout, gi_layout_make_probe(
+		probe_position, in_required_radial_depth, in_octree_level));
+	io_layout.probe_indices_by_corner[probe_key] = probe_index;
+	return probe_index;
+}
+
+i32 gi_layout_add_node_payload(
+	GI_Layout& io_layout,
+	const i32 in_depth,
+	const GI_Coords in_coords)
+{
+	const f32 cell_extent = gi_layout_cell_extent_from_depth(io_layout, in_depth);
+	const f32 required_radial_depth = gi_layout_max_radial_depth_from_cell_extent(cell_extent);
+
+	GI_Cell cell = {};
+	for (i32 corner_index = 0; corner_index < 8; ++corner_index)
+	{
+		cell.probe_indices[corner_index] = gi_layout_get_or_create_probe(
+			io_layout,
+			gi_layout_cell_corner_coords(io_layout, in_depth, in_coords, corner_index),
+			required_radial_depth,
+			in_depth);
+	}
+
+	io_layout.cells_per_depth[in_depth] += 1;
+	return gi_layout_allocate_cell(io_layout, cell);
+}
+
+i32 gi_layout_build_sparse_octree_node(
+	GI_Layout& io_layout,
+	const DynamicArray<BoundingBox>& in_geometry_bounds,
+	const BoundingBox& in_bounds,
+	const i32 in_depth,
+	const GI_Coords in_coords,
+	GI_LayoutPatchStats* out_stats)
+{
+	GI_OctreeNode node = gi_layout_make_octree_node(in_bounds);
+	node.payload_index = gi_layout_add_node_payload(io_layout, in_depth, in_coords);
+	const i32 node_index = gi_layout_allocate_node(io_layout, node);
+
+	if (in_depth >= io_layout.octree_depth)
+	{
+		return node_index;
+	}
+
+	i32 child_count = 0;
+	for (i32 child_slot = 0; child_slot < 8; ++child_slot)
+	{
+		const BoundingBox child_bounds = gi_layout_child_bounds(
+			in_bounds, child_slot & 1, (child_slot >> 1) & 1, (child_slot >> 2) & 1);
+		if (out_stats)
+		{
+			out_stats->nodes_tested += 1;
+		}
+		if (!gi_layout_bounds_intersect_any(child_bounds, in_geometry_bounds))
+		{
+			continue;
+		}
+
+		const i32 child_index = gi_layout_build_sparse_octree_node(
+			io_layout, in_geometry_bounds, child_bounds, in_depth + 1,
+			gi_layout_child_coords(in_coords, child_slot), out_stats);
+		io_layout.octree_nodes[node_index].child_indices[child_slot] = child_index;
+		child_count += 1;
+	}
+
+	io_layout.octree_nodes[node_index].is_leaf = child_count == 0 ? 1 : 0;
+	return node_index;
+}
+
+void gi_layout_add_fallback_probe(GI_Layout& io_layout)
+{
+	const f32 fallback_radial_depth = gi_layout_max_radial_depth_from_cell_extent(
+		io_layout.scene_bounds.max.X - io_layout.scene_bounds.min.X);
+	io_layout.fallback_probe_index = gi_layout_allocate_probe(io_layout, gi_layout_make_probe(
+		gi_layout_bounds_center(io_layout.scene_bounds), fallback_radial_depth, GI_PROBE_LEVEL_FALLBACK));
+}
+
+// Recomputes the summary fields from the per-depth cell counts and the
+// fallback probe
+void gi_layout_refresh_stats(GI_Layout& io_layout)
+{
+	io_layout.payload_count = 0;
+	io_layout.min_occupied_cell_extent = 0.0f;
+	io_layout.max_occupied_cell_extent = 0.0f;
+	io_layout.max_radial_depth = io_layout.probes[io_layout.fallback_probe_index].max_radial_depth;
+	for (i32 depth = 0; depth <= io_layout.octree_depth; ++depth)
+	{
+		if (io_layout.cells_per_depth[depth] == 0)
+		{
+			continue;
+		}
+		const f32 cell_extent = gi_layout_cell_extent_from_depth(io_layout, depth);
+		if (io_layout.payload_count == 0)
+		{
+			io_layout.max_occupied_cell_extent = cell_extent;
+			io_layout.max_radial_depth = std::max(
+				io_layout.max_radial_depth, gi_layout_max_radial_depth_from_cell_extent(cell_extent));
+		}
+		io_layout.min_occupied_cell_extent = cell_extent;
+		io_layout.payload_count += io_layout.cells_per_depth[depth];
+	}
+	io_layout.non_fallback_probe_count =
+		(i32) io_layout.probes.length() - (i32) io_layout.free_probe_indices.length() - 1;
+}
+
+// Rebuilds the layout from scratch. Empty geometry leaves a single leaf root
+// without a payload (plus an all-empty sentinel cell so the cell buffer is
+// never empty); lookups fall through to the fallback probe.
+void gi_layout_build(
+	GI_Layout& out_layout,
+	const DynamicArray<BoundingBox>& in_geometry_bounds,
+	const BoundingBox& in_scene_bounds,
+	const i32 in_octree_depth)
+{
+	out_layout.octree_nodes.reset();
+	out_layout.cells.reset();
+	out_layout.probes.reset();
+	out_layout.probe_indices_by_corner.clear();
+	out_layout.free_node_indices.reset();
+	out_layout.free_cell_indices.reset();
+	out_layout.free_probe_indices.reset();
+	for (i32& cell_count : out_layout.cells_per_depth)
+	{
+		cell_count = 0;
+	}
+
+	out_layout.octree_depth = std::clamp(in_octree_depth, GI_Layout::min_octree_depth, GI_Layout::max_octree_depth);
+	out_layout.leaf_divisions = gi_layout_leaf_divisions_from_depth(out_layout.octree_depth);
+	out_layout.scene_bounds = in_scene_bounds;
+	out_layout.leaf_cell_extent = (in_scene_bounds.max.X - in_scene_bounds.min.X) / (f32) out_layout.leaf_divisions;
+	out_layout.has_geometry = in_geometry_bounds.length() > 0;
+
+	if (out_layout.has_geometry)
+	{
+		gi_layout_build_sparse_octree_node(
+			out_layout, in_geometry_bounds, out_layout.scene_bounds, 0, (GI_Coords){0, 0, 0}, nullptr);
+	}
+	else
+	{
+		out_layout.octree_nodes.add(gi_layout_make_octree_node(out_layout.scene_bounds));
+		out_layout.cells.add(gi_layout_make_empty_cell());
+	}
+	gi_layout_add_fallback_probe(out_layout);
+	gi_layout_refresh_stats(out_layout);
+}
+
+// Node at (in_depth, in_coords), or -1 when that part of the tree is empty
+i32 gi_layout_find_node(const GI_Layout& in_layout, const i32 in_depth, const GI_Coords in_coords)
+{
+	i32 node_index = 0;
+	for (i32 level = 1; level <= in_depth && node_index >= 0; ++level)
+	{
+		const i32 shift = in_depth - level;
+		const i32 child_slot = ((in_coords.x >> shift) & 1)
+			+ ((in_coords.y >> shift) & 1) * 2
+			+ ((in_coords.z >> shift) & 1) * 4;
+		node_index = in_layout.octree_nodes[node_index].child_indices[child_slot];
+	}
+	return node_index;
+}
+
+// Shallowest depth with a cell that has a corner at in_max_depth_coords, or
+// -1 when no cell uses that corner
+i32 gi_layout_corner_min_cell_depth(const GI_Layout& in_layout, const GI_Coords in_max_depth_coords)
+{
+	for (i32 depth = 0; depth <= in_layout.octree_depth; ++depth)
+	{
+		const i32 coord_scale = 1 << (in_layout.octree_depth - depth);
+		if (in_max_depth_coords.x % coord_scale != 0
+			|| in_max_depth_coords.y % coord_scale != 0
+			|| in_max_depth_coords.z % coord_scale != 0)
+		{
+			continue;
+		}
+
+		const i32 divisions = 1 << depth;
+		const GI_Coords corner = {
+			in_max_depth_coords.x / coord_scale,
+			in_max_depth_coords.y / coord_scale,
+			in_max_depth_coords.z / coord_scale,
+		};
+		for (i32 corner_index = 0; corner_index < 8; ++corner_index)
+		{
+			const GI_Coords cell_coords = {
+				corner.x - (corner_index & 1),
+				corner.y - ((corner_index >> 1) & 1),
+				corner.z - ((corner_index >> 2) & 1),
+			};
+			if (cell_coords.x < 0 || cell_coords.y < 0 || cell_coords.z < 0
+				|| cell_coords.x >= divisions || cell_coords.y >= divisions || cell_coords.z >= divisions)
+			{
+				continue;
+			}
+			if (gi_layout_find_node(in_layout, depth, cell_coords) >= 0)
+			{
+				return depth;
+			}
+		}
+	}
+	return -1;
+}
+
+// Re-derives a probe's level and radial depth after cells using it were
+// released, or releases the probe when none are left
+void gi_layout_refresh_corner_probe(GI_Layout& io_layout, const GI_Coords in_max_depth_coords, GI_LayoutPatchStats* out_stats)
+{
+	auto found = io_layout.probe_indices_by_corner.find(gi_layout_probe_corner_key(in_max_depth_coords));
+	if (found == io_layout.probe_indices_by_corner.end())
+	{
+		return;
+	}
+
+	const i32 probe_index = found->second;
+	const i32 depth = gi_layout_corner_min_cell_depth(io_layout, in_max_depth_coords);
+	if (depth < 0)
+	{
+		GI_Probe unused_probe = gi_layout_make_probe(HMM_V3(0.0f, 0.0f, 0.0f), 0.0f, GI_PROBE_LEVEL_UNUSED);
+		unused_probe.position.W = 0.0f;
+		io_layout.probes[probe_index] = unused_probe;
+		io_layout.free_probe_indices.add(probe_index);
+		io_layout.probe_indices_by_corner.erase(found);
+		if (out_stats)
+		{
+			out_stats->probes_removed += 1;
+		}
+		return;
+	}
+
+	GI_Probe& probe = io_layout.probes[probe_index];
+	probe.octree_level = depth;
+	probe.max_radial_depth = gi_layout_max_radial_depth_from_cell_extent(
+		gi_layout_cell_extent_from_depth(io_layout, depth));
+}
+
+// Releases a subtree's nodes and cells; the corners of the released cells are
+// collected so their probes can be refreshed once the patch is complete
+void gi_layout_release_subtree(
+	GI_Layout& io_layout,
+	const i32 in_node_index,
+	const i32 in_depth,
+	const GI_Coords in_coords,
+	DynamicArray<GI_Coords>& out_released_corners,
+	GI_LayoutPatchStats* out_stats)
+{
+	const GI_OctreeNode node = io_layout.octree_nodes[in_node_index];
+	for (i32 child_slot = 0; child_slot < 8; ++child_slot)
+	{
+		if (node.child_indices[child_slot] >= 0)
+		{
+			gi_layout_release_subtree(
+				io_layout, node.child_indices[child_slot], in_depth + 1,
+				gi_layout_child_coords(in_coords, child_slot), out_released_corners, out_stats);
+		}
+	}
+
+	for (i32 corner_index = 0; corner_index < 8; ++corner_index)
+	{
+		out_released_corners.add(gi_layout_cell_corner_coords(io_layout, in_depth, in_coords, corner_index));
+	}
+	io_layout.cells[node.payload_index] = gi_layout_make_empty_cell();
+	io_layout.free_cell_indices.add(node.payload_index);
+	io_layout.cells_per_depth[in_depth] -= 1;
+
+	io_layout.octree_nodes[in_node_index] = gi_layout_make_octree_node((BoundingBox) {});
+	io_layout.free_node_indices.add(in_node_index);
+	if (out_stats)
+	{
+		out_stats->nodes_removed += 1;
+	}
+}
+
+void gi_layout_patch_node(
+	GI_Layout& io_layout,
+	const DynamicArray<BoundingBox>& in_geometry_bounds,
+	const DynamicArray<BoundingBox>& in_dirty_regions,
+	const i32 in_node_index,
+	const i32 in_depth,
+	const GI_Coords in_coords,
+	DynamicArray<GI_Coords>& out_released_corners,
+	GI_LayoutPatchStats* out_stats)
+{
+	if (in_depth >= io_layout.octree_depth)
+	{
+		return;
+	}
+
+	const BoundingBox bounds = gi_layout_node_bounds(io_layout.octree_nodes[in_node_index]);
+	i32 child_count = 0;
+	for (i32 child_slot = 0; child_slot < 8; ++child_slot)
+	{
+		// Re-read each time: building a child may grow the node array
+		i32 child_index = io_layout.octree_nodes[in_node_index].child_indices[child_slot];
+		const BoundingBox child_bounds = gi_layout_child_bounds(
+			bounds, child_slot & 1, (child_slot >> 1) & 1, (child_slot >> 2) & 1);
+		if (gi_layout_bounds_intersect_any(child_bounds, in_dirty_regions))
+		{
+			const GI_Coords child_coords = gi_layout_child_coords(in_coords, child_slot);
+			if (out_stats)
+			{
+				out_stats->nodes_tested += 1;
+			}
+			const bool occupied = gi_layout_bounds_intersect_any(child_bounds, in_geometry_bounds);
+			if (child_index >= 0 && !occupied)
+			{
+				gi_layout_release_subtree(
+					io_layout, child_index, in_depth + 1, child_coords, out_released_corners, out_stats);
+				child_index = -1;
+			}
+			else if (child_index < 0 && occupied)
+			{
+				const i32 nodes_before = (i32) io_layout.octree_nodes.length() - (i32) io_layout.free_node_indices.length();
+				child_index = gi_layout_build_sparse_octree_node(
+					io_layout, in_geometry_bounds, child_bounds, in_depth + 1, child_coords, out_stats);
+				if (out_stats)
+				{
+					out_stats->nodes_added += (i32) io_layout.octree_nodes.length()
+						- (i32) io_layout.free_node_indices.length() - nodes_before;
+				}
+			}
+			else if (child_index >= 0)
+			{
+				gi_layout_patch_node(
+					io_layout, in_geometry_bounds, in_dirty_regions, child_index, in_depth + 1,
+					child_coords, out_released_corners, out_stats);
+			}
+			io_layout.octree_nodes[in_node_index].child_indices[child_slot] = child_index;
+		}
+		child_count += child_index >= 0 ? 1 : 0;
+	}
+	io_layout.octree_nodes[in_node_index].is_leaf = child_count == 0 ? 1 : 0;
+}
+
+// Updates the layout in place for geometry edits inside in_dirty_regions
+// (every changed object's old and new bounds). in_geometry_bounds is the full
+// new geometry list. Returns false, leaving the layout untouched, when the
+// edit changes the lattice (scene cube, depth, empty <-> non-empty); the
+// caller then rebuilds. The result matches gi_layout_build on the new
+// geometry except for slot order.
+bool gi_layout_patch(
+	GI_Layout& io_layout,
+	const DynamicArray<BoundingBox>& in_geometry_bounds,
+	const BoundingBox& in_scene_bounds,
+	const i32 in_octree_depth,
+	const DynamicArray<BoundingBox>& in_dirty_regions,
+	GI_LayoutPatchStats* out_stats)
+{
+	if (!io_layout.has_geometry
+		|| in_geometry_bounds.length() == 0
+		|| std::clamp(in_octree_depth, GI_Layout::min_octree_depth, GI_Layout::max_octree_depth) != io_layout.octree_depth
+		|| !gi_layout_bounds_equal(in_scene_bounds, io_layout.scene_bounds))
+	{
+		return false;
+	}
+
+	const i32 probes_before = io_layout.non_fallback_probe_count;
+	DynamicArray<GI_Coords> released_corners;
+	gi_layout_patch_node(
+		io_layout, in_geometry_bounds, in_dirty_regions, 0, 0, (GI_Coords){0, 0, 0},
+		released_corners, out_stats);
+	for (const GI_Coords& corner : released_corners)
+	{
+		gi_layout_refresh_corner_probe(io_layout, corner, out_stats);
+	}
+	gi_layout_refresh_stats(io_layout);
+
+	if (out_stats)
+	{
+		out_stats->probes_added = io_layout.non_fallback_probe_count - probes_before + out_stats->probes_removed;
+	}
+	return true;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/types.h"
+#include "core/dynamic_array.h"
+#include "render/gi_layout.h"
+
+// ---- GI probe update scheduler ----
+// A probe goes stale when what it sees may have changed: geometry edits near
+// it (its influence sphere reaches a changed object's old or new box), a new
+// probe without radiance, or a full refresh (sky, capture settings). Each
+// frame the stale probes are ranked and the best few captured, as many as the
+// GPU time budget buys at the measured cost of one capture.
+//
+// Ranking favours probes whose influence sphere looks large from the camera
+// (close, or containing it), probes in the view frustum, and probes next to
+// an edit. A small waiting term keeps off-screen probes from starving.
+
+static constexpr u64 GI_PROBE_CURRENT = ~0ull;
+
+struct GI_ProbeCandidate
+{
+	f32 priority;
+	i32 probe_index;
+};
+
+struct GI_ProbeScheduler
+{
+	static constexpr f32 default_gpu_ms_per_probe = 0.5f;
+	static constexpr f32 gpu_time_smoothing = 0.25f;	// weight of a new measurement
+	static constexpr f32 off_screen_weight = 0.25f;
+	static constexpr f32 near_edit_bonus = 1.0f;
+	static constexpr f32 wait_weight_per_frame = 1.0f / 240.0f;
+
+	DynamicArray<u64> stale_frames;	// per probe: frame it went stale, GI_PROBE_CURRENT when up to date
+	DynamicArray<u8> near_edit;		// per probe: stale because geometry nearby changed
+	DynamicArray<GI_ProbeCandidate> candidates;
+	i32 stale_count = 0;
+	f32 gpu_ms_per_probe = default_gpu_ms_per_probe;
+};
+
+// Forgets all pending work and tracks in_probe_count current probes
+void gi_probe_scheduler_reset(GI_ProbeScheduler& io_scheduler, const i32 in_probe_count)
+{
+	io_scheduler.stale_frames.reset();
+	io_scheduler.near_edit.reset();
+	io_scheduler.stale_frames.resize((size_t) in_probe_count, GI_PROBE_CURRENT);
+	io_scheduler.near_edit.resize((size_t) in_probe_count, (u8) 0);
+	io_scheduler.stale_count = 0;
+}
+
+// Tracks in_probe_count probes; existing entries keep their state and new
+// ones start current (mark them explicitly)
+void gi_probe_scheduler_resize(GI_ProbeScheduler& io_scheduler, const i32 in_probe_count)
+{
+	const size_t previous_count = io_scheduler.stale_frames.length();
+	for (size_t probe_index = (size_t) in_probe_count; probe_index < previous_count; ++probe_index)
+	{
+		io_scheduler.stale_count -= io_scheduler.stale_frames[probe_index] != GI_PROBE_CURRENT ? 1 : 0;
+	}
+	io_scheduler.stale_frames.resize((size_t) in_probe_count, GI_PROBE_CURRENT);
+	io_scheduler.near_edit.resize((size_t) in_probe_count, (u8) 0);
+}
+
+void gi_probe_scheduler_mark_stale(GI_ProbeScheduler& io_scheduler, const i32 in_probe_index, const u64 in_frame, const bool in_near_edit)
+{
+	if (io_scheduler.stale_frames[in_probe_index] == GI_PROBE_CURRENT)
+	{
+		io_scheduler.stale_frames[in_probe_index] = in_frame;
+		io_scheduler.stale_count += 1;
+	}
+	io_scheduler.near_edit[in_probe_index] |= in_near_edit ? 1 : 0;
+}
+
+void gi_probe_scheduler_mark_all(GI_ProbeScheduler& io_scheduler, const DynamicArray<GI_Probe>& in_probes, const u64 in_frame)
+{
+	for (i32 probe_index = 0; probe_index < (i32) in_probes.length(); ++probe_index)
+	{
+		if (gi_layout_probe_is_used(in_probes[probe_index]))
+		{
+			gi_probe_scheduler_mark_stale(io_scheduler, probe_index, in_frame, false);
+		}
+	}
+}
+
+// Marks probes whose influence sphere reaches any of in_regions, plus probes
+// that have never been captured (new slots from a layout patch)
+void gi_probe_scheduler_mark_regions(
+	GI_ProbeScheduler& io_scheduler,
+	const DynamicArray<GI_Probe>& in_probes,
+	const DynamicArray<BoundingBox>& in_regions,
+	const u64 in_frame)
+{
+	for (i32 probe_index = 0; probe_index < (i32) in_probes.length(); ++probe_index)
+	{
+		const GI_Probe& probe = in_probes[probe_index];
+		if (!gi_layout_probe_is_used(probe))
+		{
+			continue;
+		}
+
+		const BoundingSphere influence = { .center = probe.position.XYZ, .radius = probe.max_radial_depth };
+		bool near_edit = false;
+		for (const BoundingBox& region : in_regions)
+		{
+			if (!bounding_box_outside_sphere(region, influence))
+			{
+				near_edit = true;
+				break;
+			}
+		}
+		if (near_edit || probe.atlas_idx < 0)
+		{
+			gi_probe_scheduler_mark_stale(io_scheduler, probe_index, in_frame, near_edit);
+		}
+	}
+}
+
+f32 gi_probe_priority(
+	const GI_Probe& in_probe,
+	const HMM_Vec3 in_camera_location,
+	const Frustum& in_view_frustum,
+	const bool in_near_edit,
+	const u64 in_frames_waited)
+{
+	const f32 radius = std::max(in_probe.max_radial_depth, 1e-3f);
+	const f32 distance = HMM_LenV3(in_probe.position.XYZ - in_camera_location);
+	const f32 screen_influence = radius / std::max(distance, radius);
+	const BoundingBox influence_bounds = {
+		.min = in_probe.position.XYZ - HMM_V3(radius, radius, radius),
+		.max = in_probe.position.XYZ + HMM_V3(radius, radius, radius),
+	};
+	const bool on_screen = !frustum_cull(in_view_frustum, influence_bounds);
+
+	return screen_influence * (on_screen ? 1.0f : GI_ProbeScheduler::off_screen_weight)
+		+ (in_near_edit ? GI_ProbeScheduler::near_edit_bonus : 0.0f)
+		+ (f32) in_frames_waited * GI_ProbeScheduler::wait_weight_per_frame;
+}
+
+// Captures that fit in in_budget_ms at the current cost estimate; at least one
+// so a tiny budget still makes progress
+i32 gi_probe_scheduler_budget_count(const GI_ProbeScheduler& in_scheduler, const f32 in_budget_ms, const i32 in_max_count)
+{
+	const f32 affordable = in_budget_ms / std::max(in_scheduler.gpu_ms_per_probe, 1e-3f);
+	return std::clamp((i32) std::floor(affordable), 1, std::max(in_max_count, 1));
+}
+
+// Picks up to in_max_count stale probes, highest priority first, and marks
+// them current
+void gi_probe_scheduler_select(
+	GI_ProbeScheduler& io_scheduler,
+	const DynamicArray<GI_Probe>& in_probes,
+	const HMM_Vec3 in_camera_location,
+	const HMM_Mat4& in_view_projection,
+	const u64 in_frame,
+	const i32 in_max_count,
+	DynamicArray<i32>& out_probe_indices)
+{
+	out_probe_indices.clear();
+	io_scheduler.candidates.clear();
+	if (io_scheduler.stale_count == 0 || in_max_count <= 0)
+	{
+		return;
+	}
+
+	const Frustum view_frustum = frustum_create(in_view_projection);
+	for (i32 probe_index = 0; probe_index < (i32) io_scheduler.stale_frames.length(); ++probe_index)
+	{
+		const u64 stale_frame = io_scheduler.stale_frames[probe_index];
+		if (stale_frame == GI_PROBE_CURRENT)
+		{
+			continue;
+		}
+		if (!gi_layout_probe_is_used(in_probes[probe_index]))
+		{
+			// Released by a layout patch while waiting
+			io_scheduler.stale_frames[probe_index] = GI_PROBE_CURRENT;
+			io_scheduler.near_edit[probe_index] = 0;
+			io_scheduler.stale_count -= 1;
+			continue;
+		}
+		io_scheduler.candidates.add((GI_ProbeCandidate) {
+			.priority = gi_probe_priority(
+				in_probes[probe_index], in_camera_location, view_frustum,
+				io_scheduler.near_edit[probe_index] != 0,
+				in_frame > stale_frame ? in_frame - stale_frame : 0),
+			.probe_index = probe_index,
+		});
+	}
+
+	const size_t selected_count = std::min((size_t) in_max_count, io_scheduler.candidates.length());
+	GI_ProbeCandidate* candidates = io_scheduler.candidates.data();
+	const auto higher_priority = [](const GI_ProbeCandidate& in_a, const GI_ProbeCandidate& in_b)
+	{
+		return in_a.priority > in_b.priority
+			|| (in_a.priority == in_b.priority && in_a.probe_index < in_b.probe_index);
+	};
+	std::partial_sort(candidates, candidates + selected_count, candidates + io_scheduler.candidates.length(), higher_priority);
+
+	for (size_t candidate_index = 0; candidate_index < selected_count; ++candidate_index)
+	{
+		const i32 probe_index = candidates[candidate_index].probe_index;
+		out_probe_indices.add(probe_index);
+		io_scheduler.stale_frames[probe_index] = GI_PROBE_CURRENT;
+		io_scheduler.near_edit[probe_index] = 0;
+		io_scheduler.stale_count -= 1;
+	}
+}
+
+// Folds a measured GPU time for in_probe_count captures into the estimate
+void gi_probe_scheduler_record_gpu_time(GI_ProbeScheduler& io_scheduler, const f64 in_elapsed_ms, const i32 in_probe_count)
+{
+	if (in_probe_count <= 0 || !(in_elapsed_ms > 0.0))
+	{
+		return;
+	}
+	const f32 measured = (f32) (in_elapsed_ms / (f64) in_probe_count);
+	io_scheduler.gpu_ms_per_probe += (measured - io_scheduler.gpu_ms_per_probe) * GI_ProbeScheduler::gpu_time_smoothing;
+}
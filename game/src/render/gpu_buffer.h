@@ -19,6 +19,7 @@ struct GpuBufferUsage
 	bool index_buffer = false;
 	bool storage_buffer = false;
 	bool uniform_buffer = false;
+	bool indirect_buffer = false;
 	bool stream_update = false;
 	bool prefer_device_local = false;
 	bool transfer_src = false;
@@ -108,6 +109,7 @@ public:
 			if (usage.index_buffer)		{ usage_flags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT; }
 			if (usage.storage_buffer)	{ usage_flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; }
 			if (usage.uniform_buffer)	{ usage_flags |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; }
+			if (usage.indirect_buffer)	{ usage_flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT; }
 			if (usage.transfer_src)		{ usage_flags |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT; }
 
 			VkBufferCreateInfo buffer_create_info = {
@@ -214,7 +216,57 @@ public:
 	u64 length() const { return _length; }
 	u64 resource_generation() const { return generation; }
 
+	// Creates the buffer with its initial contents going through the async
+	// upload engine instead of a copy in this frame (or an immediate submit).
+	// Nothing may read it before vulkan_upload_ready(upload_ticket()).
+	void create_gpu_buffer_async()
+	{
+		async_upload = true;
+		get_gpu_buffer();
+	}
+
+	// 0 unless the last creation queued an async upload
+	u64 upload_ticket() const { return _upload_ticket; }
+
 protected:
+	// Stages/accesses of the buffer's first reads, for the barrier that
+	// follows its initial copy
+	void first_use_sync_info(VkPipelineStageFlags2* out_stage, VkAccessFlags2* out_access) const
+	{
+		if (usage.vertex_buffer)
+		{
+			*out_stage |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+			*out_access |= VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
+		}
+		if (usage.index_buffer)
+		{
+			*out_stage |= VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+			*out_access |= VK_ACCESS_2_INDEX_READ_BIT;
+		}
+		if (usage.storage_buffer)
+		{
+			*out_stage |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT
+					  | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+					  | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			*out_access |= VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		}
+		if (usage.uniform_buffer)
+		{
+			*out_stage |= VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			*out_access |= VK_ACCESS_2_UNIFORM_READ_BIT;
+		}
+		if (usage.indirect_buffer)
+		{
+			*out_stage |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+			*out_access |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+		}
+		if (*out_stage == 0)
+		{
+			*out_stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			*out_access = VK_ACCESS_2_MEMORY_READ_BIT;
+		}
+	}
+
 	// Fills a device-local buffer: direct memcpy when the allocation happens
 	// to be host-visible (UMA), otherwise via a throwaway staging buffer +
 	// one-shot copy (safe to destroy immediately — the submit waits idle)
@@ -233,37 +285,27 @@ protected:
 			return;
 		}
 
+		if (async_upload)
+		{
+			VkPipelineStageFlags2 dst_stage = 0;
+			VkAccessFlags2 dst_access = 0;
+			first_use_sync_info(&dst_stage, &dst_access);
+			_upload_ticket = vulkan_upload_queue_buffer(
+				g_vulkan_context,
+				in_target_buffer,
+				data,
+				size,
+				dst_stage,
+				dst_access
+			);
+			return;
+		}
+
 		if (vulkan_current_frame(g_vulkan_context).recording)
 		{
 			VkPipelineStageFlags2 dst_stage = 0;
 			VkAccessFlags2 dst_access = 0;
-			if (usage.vertex_buffer)
-			{
-				dst_stage |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
-				dst_access |= VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
-			}
-			if (usage.index_buffer)
-			{
-				dst_stage |= VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
-				dst_access |= VK_ACCESS_2_INDEX_READ_BIT;
-			}
-			if (usage.storage_buffer)
-			{
-				dst_stage |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT
-						  | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
-						  | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-				dst_access |= VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
-			}
-			if (usage.uniform_buffer)
-			{
-				dst_stage |= VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-				dst_access |= VK_ACCESS_2_UNIFORM_READ_BIT;
-			}
-			if (dst_stage == 0)
-			{
-				dst_stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-				dst_access = VK_ACCESS_2_MEMORY_READ_BIT;
-			}
+			first_use_sync_info(&dst_stage, &dst_access);
 			vulkan_upload_record_buffer(
 				g_vulkan_context,
 				in_target_buffer,
@@ -337,6 +379,8 @@ protected:
 	VmaAllocation allocation = VK_NULL_HANDLE;
 	void* mapped_data = nullptr;
 	u64 generation = 0;
+	bool async_upload = false;
+	u64 _upload_ticket = 0;
 
 	// Optional Label
 	optional<std::string> label;
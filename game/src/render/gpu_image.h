@@ -74,6 +74,14 @@ struct PassResourceUsage
 {
 	DynamicArray<ImageUsage> images;
 	DynamicArray<BufferUsage> buffers;
+	DynamicArray<VkMemoryBarrier2> memory;	// global, e.g. handing aliased memory to a transient target
+
+	void clear()
+	{
+		images.clear();
+		buffers.clear();
+		memory.clear();
+	}
 };
 
 inline u64 gpu_image_next_generation()
@@ -168,12 +176,47 @@ inline bool gpu_access_has_write(VkAccessFlags2 in_access)
 	return (in_access & writes) != 0;
 }
 
-void gpu_image_apply_usages(
-	VkCommandBuffer in_command_buffer,
+// Pipeline barriers recorded since the frame began; vulkan_context_end_frame
+// moves them into the metrics
+struct GpuBarrierCounters
+{
+	u64 batches = 0;	// vkCmdPipelineBarrier2 calls
+	u64 barriers = 0;
+};
+static GpuBarrierCounters g_gpu_barrier_counters;
+
+inline void gpu_cmd_pipeline_barrier(VkCommandBuffer in_command_buffer, const VkDependencyInfo& in_dependency)
+{
+	g_gpu_barrier_counters.batches += 1;
+	g_gpu_barrier_counters.barriers += in_dependency.memoryBarrierCount
+		+ in_dependency.bufferMemoryBarrierCount
+		+ in_dependency.imageMemoryBarrierCount;
+	vkCmdPipelineBarrier2(in_command_buffer, &in_dependency);
+}
+
+// Same image, aspect, sync scopes and layouts: the two barriers can be one
+inline bool gpu_image_barriers_match(const VkImageMemoryBarrier2& in_a, const VkImageMemoryBarrier2& in_b)
+{
+	return in_a.image == in_b.image
+		&& in_a.subresourceRange.aspectMask == in_b.subresourceRange.aspectMask
+		&& in_a.srcStageMask == in_b.srcStageMask
+		&& in_a.srcAccessMask == in_b.srcAccessMask
+		&& in_a.dstStageMask == in_b.dstStageMask
+		&& in_a.dstAccessMask == in_b.dstAccessMask
+		&& in_a.oldLayout == in_b.oldLayout
+		&& in_a.newLayout == in_b.newLayout;
+}
+
+// Updates the tracked subresource states and appends the barriers the usages
+// need. Subresource states are tracked one by one, but neighbouring layers of
+// a mip, and then neighbouring mips covering the same layers, that need the
+// same barrier are merged into one range.
+void gpu_image_collect_barriers(
 	const ImageUsage* in_usages,
-	u32 in_usage_count)
+	u32 in_usage_count,
+	DynamicArray<VkImageMemoryBarrier2>& io_barriers)
 {
-	DynamicArray<VkImageMemoryBarrier2> barriers;
+	DynamicArray<VkImageMemoryBarrier2>& barriers = io_barriers;
 	for (u32 usage_index = 0; usage_index < in_usage_count; ++usage_index)
 	{
 		const ImageUsage& usage = in_usages[usage_index];
@@ -209,7 +252,7 @@ void gpu_image_apply_usages(
 						|| usage.discard;
 					if (needs_barrier)
 					{
-						barriers.add((VkImageMemoryBarrier2) {
+						const VkImageMemoryBarrier2 barrier = {
 							.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
 							.srcStageMask = state.stage,
 							.srcAccessMask = state.access,
@@ -227,7 +270,20 @@ void gpu_image_apply_usages(
 								.baseArrayLayer = layer,
 								.layerCount = 1,
 							},
-						});
+						};
+						VkImageMemoryBarrier2* previous = barriers.empty() ? nullptr : &barriers[barriers.length() - 1];
+						if (previous
+							&& gpu_image_barriers_match(*previous, barrier)
+							&& previous->subresourceRange.baseMipLevel == mip
+							&& previous->subresourceRange.levelCount == 1
+							&& previous->subresourceRange.baseArrayLayer + previous->subresourceRange.layerCount == layer)
+						{
+							previous->subresourceRange.layerCount += 1;
+						}
+						else
+						{
+							barriers.add(barrier);
+						}
 						state.stage = usage.stage;
 						state.access = usage.access;
 						state.layout = usage.layout;
@@ -238,17 +294,41 @@ void gpu_image_apply_usages(
 						state.access |= usage.access;
 					}
 				}
+
+				// This mip's layer run continues the previous mip's
+				if (barriers.length() >= 2)
+				{
+					VkImageMemoryBarrier2& last = barriers[barriers.length() - 1];
+					VkImageMemoryBarrier2& previous = barriers[barriers.length() - 2];
+					if (last.subresourceRange.baseMipLevel == mip
+						&& gpu_image_barriers_match(previous, last)
+						&& previous.subresourceRange.baseArrayLayer == last.subresourceRange.baseArrayLayer
+						&& previous.subresourceRange.layerCount == last.subresourceRange.layerCount
+						&& previous.subresourceRange.baseMipLevel + previous.subresourceRange.levelCount == mip)
+					{
+						previous.subresourceRange.levelCount += 1;
+						barriers.pop();
+					}
+				}
 			}
 		}
 	}
+}
 
+void gpu_image_apply_usages(
+	VkCommandBuffer in_command_buffer,
+	const ImageUsage* in_usages,
+	u32 in_usage_count)
+{
+	DynamicArray<VkImageMemoryBarrier2> barriers;
+	gpu_image_collect_barriers(in_usages, in_usage_count, barriers);
 	if (barriers.empty()) return;
 	VkDependencyInfo dependency_info = {
 		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
 		.imageMemoryBarrierCount = (u32)barriers.length(),
 		.pImageMemoryBarriers = barriers.data(),
 	};
-	vkCmdPipelineBarrier2(in_command_buffer, &dependency_info);
+	gpu_cmd_pipeline_barrier(in_command_buffer, dependency_info);
 }
 
 // Compatibility wrapper for call sites that have not yet moved their usage
@@ -279,24 +359,13 @@ void gpu_image_transition(
 	gpu_image_apply_usages(in_command_buffer, &usage, 1);
 }
 
-GpuImage gpu_image_create(VmaAllocator in_allocator, VkDevice in_device, const GpuImageDesc& in_desc)
+VkImageCreateInfo gpu_image_create_info(const GpuImageDesc& in_desc)
 {
 	const u32 array_layers = MAX(in_desc.array_layers, 1u);
 	const u32 mip_levels = MAX(in_desc.mip_levels, 1u);
-
-	GpuImage result = {
-		.format = in_desc.format,
-		.extent = { in_desc.width, in_desc.height },
-		.array_layers = array_layers,
-		.mip_levels = mip_levels,
-		.aspects = in_desc.aspect,
-		.generation = gpu_image_next_generation(),
-	};
-	result.subresource_states.resize(3 * result.mip_levels * result.array_layers);
-
 	assert(!in_desc.cubemap || array_layers == 6);
 
-	VkImageCreateInfo image_create_info = {
+	return {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 		.flags = in_desc.cubemap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : (VkImageCreateFlags) 0,
 		.imageType = VK_IMAGE_TYPE_2D,
@@ -314,32 +383,52 @@ GpuImage gpu_image_create(VmaAllocator in_allocator, VkDevice in_device, const G
 		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 	};
+}
 
-	VmaAllocationCreateInfo allocation_create_info = {
-		.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+// What an image of this desc needs from its memory, without creating one
+VkMemoryRequirements gpu_image_memory_requirements(VkDevice in_device, const GpuImageDesc& in_desc)
+{
+	const VkImageCreateInfo image_create_info = gpu_image_create_info(in_desc);
+	const VkDeviceImageMemoryRequirements requirements_info = {
+		.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+		.pCreateInfo = &image_create_info,
+	};
+	VkMemoryRequirements2 requirements = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
 	};
+	vkGetDeviceImageMemoryRequirements(in_device, &requirements_info, &requirements);
+	return requirements.memoryRequirements;
+}
 
-	VK_CHECK(vmaCreateImage(
-		in_allocator,
-		&image_create_info,
-		&allocation_create_info,
-		&result.image,
-		&result.allocation,
-		nullptr
-	));
-	if (in_desc.label)
+GpuImage gpu_image_from_create_info(const VkImageCreateInfo& in_create_info, const GpuImageDesc& in_desc)
+{
+	GpuImage result = {
+		.format = in_desc.format,
+		.extent = { in_desc.width, in_desc.height },
+		.array_layers = in_create_info.arrayLayers,
+		.mip_levels = in_create_info.mipLevels,
+		.aspects = in_desc.aspect,
+		.generation = gpu_image_next_generation(),
+	};
+	result.subresource_states.resize(3 * result.mip_levels * result.array_layers);
+	return result;
+}
+
+// Names a freshly bound image and creates its views
+void gpu_image_create_views(VkDevice in_device, const GpuImageDesc& in_desc, GpuImage& io_image)
+{
+	GpuImage& result = io_image;
+	const u32 array_layers = result.array_layers;
+	const u32 mip_levels = result.mip_levels;
+	if (in_desc.label && g_vulkan_debug_utils_enabled && vkSetDebugUtilsObjectNameEXT)
 	{
-		vmaSetAllocationName(in_allocator, result.allocation, in_desc.label);
-		if (g_vulkan_debug_utils_enabled && vkSetDebugUtilsObjectNameEXT)
-		{
-			VkDebugUtilsObjectNameInfoEXT name_info = {
-				.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-				.objectType = VK_OBJECT_TYPE_IMAGE,
-				.objectHandle = (u64)result.image,
-				.pObjectName = in_desc.label,
-			};
-			vkSetDebugUtilsObjectNameEXT(in_device, &name_info);
-		}
+		VkDebugUtilsObjectNameInfoEXT name_info = {
+			.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+			.objectType = VK_OBJECT_TYPE_IMAGE,
+			.objectHandle = (u64)result.image,
+			.pObjectName = in_desc.label,
+		};
+		vkSetDebugUtilsObjectNameEXT(in_device, &name_info);
 	}
 
 	VkImageViewCreateInfo image_view_create_info = {
@@ -442,7 +531,47 @@ GpuImage gpu_image_create(VmaAllocator in_allocator, VkDevice in_device, const G
 			result.mip_views.add(mip_view);
 		}
 	}
+}
+
+GpuImage gpu_image_create(VmaAllocator in_allocator, VkDevice in_device, const GpuImageDesc& in_desc)
+{
+	const VkImageCreateInfo image_create_info = gpu_image_create_info(in_desc);
+	GpuImage result = gpu_image_from_create_info(image_create_info, in_desc);
+
+	VmaAllocationCreateInfo allocation_create_info = {
+		.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+	};
+
+	VK_CHECK(vmaCreateImage(
+		in_allocator,
+		&image_create_info,
+		&allocation_create_info,
+		&result.image,
+		&result.allocation,
+		nullptr
+	));
+	if (in_desc.label)
+	{
+		vmaSetAllocationName(in_allocator, result.allocation, in_desc.label);
+	}
+	gpu_image_create_views(in_device, in_desc, result);
+	return result;
+}
 
+// Binds the image at in_offset inside in_heap instead of giving it its own
+// allocation. Other images may share that memory; the image does not own it
+// (allocation stays null) and whoever allocated in_heap frees it.
+GpuImage gpu_image_create_aliased(
+	VmaAllocator in_allocator,
+	VkDevice in_device,
+	const GpuImageDesc& in_desc,
+	VmaAllocation in_heap,
+	VkDeviceSize in_offset)
+{
+	const VkImageCreateInfo image_create_info = gpu_image_create_info(in_desc);
+	GpuImage result = gpu_image_from_create_info(image_create_info, in_desc);
+	VK_CHECK(vmaCreateAliasingImage2(in_allocator, in_heap, in_offset, &image_create_info, &result.image));
+	gpu_image_create_views(in_device, in_desc, result);
 	return result;
 }
 
@@ -75,6 +75,7 @@ namespace GpuSkinning
 	{
 		in_mesh.skinned_vertex_cache_valid = false;
 		if (!in_mesh.has_skinned_vertices
+			|| !mesh_gpu_ready(in_mesh)
 			|| in_mesh.vertex_count == 0
 			|| in_mesh.skinned_vertices == nullptr
 			|| in_mesh.skin_matrices == nullptr
@@ -179,7 +180,7 @@ namespace GpuSkinning
 				.memoryBarrierCount = 1,
 				.pMemoryBarriers = &memory_barrier,
 			};
-			vkCmdPipelineBarrier2(vulkan_current_command_buffer(ctx), &dependency_info);
+			gpu_cmd_pipeline_barrier(vulkan_current_command_buffer(ctx), dependency_info);
 		}
 	}
 
@@ -244,7 +244,7 @@ namespace ImGuiLayer
 					for (u32 idx = 0; idx < armature.animation_count; ++idx)
 					{
 						const char* name = armature.animations[idx].name ? armature.animations[idx].name : "<Unnamed Animation>";
-						if (ImGui::Selectable(name, selected == (i32) idx)) { armature.active_animation_index = (i32) idx; armature.playback_time = 0.0f; armature.current_frame = 0; }
+						if (ImGui::Selectable(name, selected == (i32) idx)) { armature.active_animation_index = (i32) idx; armature.playback_time = 0.0f; armature.current_frame = 0.0f; }
 						if (selected == (i32) idx) ImGui::SetItemDefaultFocus();
 					}
 					ImGui::EndCombo();
@@ -580,6 +580,10 @@ namespace ImGuiLayer
 					ImGui::Checkbox("Shadow Rendering", &state.shadow.rendering_enable);
 					ImGui::Checkbox("Shadow Blur", &state.shadow.blur_enable);
 					ImGui::Checkbox("Freeze Shadow Depth", &state.shadow.depth_freeze);
+					ImGui::Checkbox("Cache Distant Cascades", &state.shadow.cache_enable);
+					ImGui::BeginDisabled(!state.shadow.cache_enable);
+					ImGui::SliderInt("Dirty Cascade Interval", &state.shadow.cache_dirty_interval, 1, 30);
+					ImGui::EndDisabled();
 					if (ImGui::Button("Recapture Shadow Depth"))
 					{
 						state.shadow.force_recapture = true;
@@ -637,13 +641,13 @@ namespace ImGuiLayer
 						if (ImGui::Checkbox("GI Probe Influence Culling", &state.gi.probe_influence_culling))
 							state.gi.is_updating = true;
 						ImGui::Checkbox("GI Probe Occlusion", &state.gi.probe_occlusion);
-						if (ImGui::SliderInt("GI Octree Depth", &state.gi.octree_depth, GI_Scene::min_octree_depth, GI_Scene::max_octree_depth))
+						if (ImGui::SliderInt("GI Octree Depth", &state.gi.octree_depth, GI_Layout::min_octree_depth, GI_Layout::max_octree_depth))
 						{
 							state.gi.layout_dirty = true;
 							state.gi.is_updating = true;
 						}
-						ImGui::Text("Octree: depth %d  nodes %zu  payloads %d  probes %d", gi_scene.octree_depth, gi_scene.octree_nodes.length(), gi_scene.payload_count, gi_scene.non_fallback_probe_count);
-						ImGui::Text("Atlas: %zu / %d", gi_scene.probes.length(), gi_scene_atlas_capacity());
+						ImGui::Text("Octree: depth %d  nodes %zu  payloads %d  probes %d", gi_scene.layout.octree_depth, gi_scene.layout.octree_nodes.length(), gi_scene.layout.payload_count, gi_scene.layout.non_fallback_probe_count);
+						ImGui::Text("Atlas: %zu / %d", gi_scene.layout.probes.length(), gi_scene_atlas_capacity());
 						u64 specular_pixels = 0;
 						for (i32 mip = 0; mip < gi_scene.lighting_capture.desc.specular_mip_count; ++mip)
 						{
@@ -659,9 +663,9 @@ namespace ImGuiLayer
 							gi_scene.lighting_capture.desc.specular_entry_size,
 							gi_scene.lighting_capture.desc.specular_mip_count,
 							(f64)(specular_pixels * specular_bytes_per_pixel) / (1024.0 * 1024.0));
-						ImGui::Text("Bounds Min: %.2f %.2f %.2f", gi_scene.scene_bounds.min.X, gi_scene.scene_bounds.min.Y, gi_scene.scene_bounds.min.Z);
-						ImGui::Text("Bounds Max: %.2f %.2f %.2f", gi_scene.scene_bounds.max.X, gi_scene.scene_bounds.max.Y, gi_scene.scene_bounds.max.Z);
-						ImGui::Text("Cell Extent: %.2f / %.2f  Max Radial Depth: %.2f", gi_scene.min_occupied_cell_extent, gi_scene.max_occupied_cell_extent, gi_scene.max_radial_depth);
+						ImGui::Text("Bounds Min: %.2f %.2f %.2f", gi_scene.layout.scene_bounds.min.X, gi_scene.layout.scene_bounds.min.Y, gi_scene.layout.scene_bounds.min.Z);
+						ImGui::Text("Bounds Max: %.2f %.2f %.2f", gi_scene.layout.scene_bounds.max.X, gi_scene.layout.scene_bounds.max.Y, gi_scene.layout.scene_bounds.max.Z);
+						ImGui::Text("Cell Extent: %.2f / %.2f  Max Radial Depth: %.2f", gi_scene.layout.min_occupied_cell_extent, gi_scene.layout.max_occupied_cell_extent, gi_scene.layout.max_radial_depth);
 						if (ImGui::Combo("Probe Radiance Mode", (i32*)&state.gi.probe_radiance_mode, "Octahedral\0SH9\0SG9\0"))
 							state.gi.is_updating = true;
 						if (ImGui::Combo("Probe Occlusion Mode", (i32*)&state.gi.probe_occlusion_mode, "Chebyshev\0EVRP4\0"))
@@ -673,15 +677,15 @@ namespace ImGuiLayer
 						ImGui::Checkbox("Filter Probe Level", &state.gi.probe_level_filter_enable);
 						ImGui::SameLine();
 						state.gi.probe_level_filter_selection = CLAMP(
-							state.gi.probe_level_filter_selection, 0, gi_scene.octree_depth + 1);
+							state.gi.probe_level_filter_selection, 0, gi_scene.layout.octree_depth + 1);
 						char probe_level_label[48] = {};
 						if (state.gi.probe_level_filter_selection == 0)
 							snprintf(probe_level_label, sizeof(probe_level_label), "Fallback");
 						else if (state.gi.probe_level_filter_selection == 1)
 							snprintf(probe_level_label, sizeof(probe_level_label), "Level 0 (largest)");
-						else if (state.gi.probe_level_filter_selection == gi_scene.octree_depth + 1)
+						else if (state.gi.probe_level_filter_selection == gi_scene.layout.octree_depth + 1)
 							snprintf(probe_level_label, sizeof(probe_level_label),
-								"Level %d (deepest)", gi_scene.octree_depth);
+								"Level %d (deepest)", gi_scene.layout.octree_depth);
 						else
 							snprintf(probe_level_label, sizeof(probe_level_label),
 								"Level %d", state.gi.probe_level_filter_selection - 1);
@@ -691,7 +695,7 @@ namespace ImGuiLayer
 							"##Probe Level",
 							&state.gi.probe_level_filter_selection,
 							0,
-							gi_scene.octree_depth + 1,
+							gi_scene.layout.octree_depth + 1,
 							probe_level_label,
 							ImGuiSliderFlags_AlwaysClamp);
 						ImGui::EndDisabled();
@@ -723,6 +727,8 @@ namespace ImGuiLayer
 							ImGui::SameLine();
 							ImGui::Text("Updating...");
 						}
+						ImGui::SliderFloat("GI Update Budget (ms)", &state.gi.update_budget_ms, 0.25f, 8.0f, "%.2f");
+						ImGui::Text("Stale probes: %d  Capture cost: %.3f ms/probe", gi_scene.scheduler.stale_count, gi_scene.scheduler.gpu_ms_per_probe);
 						if (ImGui::Combo("Probe Vis Mode", (i32*)&state.gi.probe_vis_mode, "Irradiance\0SH9 Irradiance\0SG9 Irradiance\0Radial Depth\0Radial Depth Squared\0EVRP Positive Moment\0Specular\0") && (state.gi.probe_vis_mode == EProbeVisMode::SH9Irradiance || state.gi.probe_vis_mode == EProbeVisMode::SG9Irradiance))
 							state.gi.is_updating = true;
 						if (state.gi.probe_vis_mode == EProbeVisMode::Specular)
@@ -955,7 +961,14 @@ namespace ImGuiLayer
 			state.images.debug_index = CLAMP(state.images.debug_index, 0, (i32) state.images.items.length() - 1);
 			ImGui::Checkbox("Fullscreen", &state.images.enable_debug_fullscreen);
 			ImGui::SliderInt("Image Index", &state.images.debug_index, 0, (i32) state.images.items.length() - 1, "%d", ImGuiSliderFlags_ClampOnInput);
-			draw_texture(frame_data.linear_sampler, "Imported Image", state.images.items[state.images.debug_index], 256.0f);
+			if (vulkan_upload_ready(&state.vk, state.images.upload_tickets[state.images.debug_index]))
+			{
+				draw_texture(frame_data.linear_sampler, "Imported Image", state.images.items[state.images.debug_index], 256.0f);
+			}
+			else
+			{
+				ImGui::TextUnformatted("Uploading...");
+			}
 		}
 		ImGui::End();
 
@@ -0,0 +1,906 @@
+#pragma once
+
+#include <cstring>
+
+#include "core/types.h"
+#include "core/timings.h"
+#include "core/runtime_config.h"
+#include "render/culling.h"
+#include "render/fullscreen_pipeline.h"
+#include "render/gpu_buffer.h"
+#include "render/mesh_pool.h"
+#include "render/vulkan_context.h"
+#include "state/state.h"
+
+// Indirect draw path for static meshes. Every unskinned, untessellated mesh
+// object is copied into the mesh pool (render/mesh_pool.h) and gets a
+// DrawRecord (shader_common.h); each view then draws its visible records with
+// one vkCmdDrawIndexedIndirect per batch instead of one bind + draw per mesh.
+//
+// Instancing: objects whose meshes share streams (linked duplicates, matched
+// by content hash on import) share a pool entry, and the visible ones become
+// one command with instanceCount > 1. Each view lists the DrawRecord index of
+// every instance in command order (draw_instance_array, binding 7), so the
+// *_indirect vertex shaders fetch their object through gl_InstanceIndex.
+// Transforms and materials stay per object in ObjectData. GAME2_INSTANCING=0
+// gives every object its own command for A/B comparisons.
+//
+// Views: 0 is the camera (geometry pass), 1 + i is shadow cascade i. Skinned
+// and tessellated meshes, and anything the pool cannot hold, are listed in
+// the view's direct_object_ids and drawn by the existing per-mesh loops.
+//
+// GAME2_DRAW_PATH selects the path:
+//   direct    the per-mesh loops only (default, and the fallback without
+//             multiDrawIndirect / drawIndirectFirstInstance)
+//   indirect  CPU culling (cull_objects) writes the commands
+//   gpu_cull  indirect_cull.comp culls every pooled record per view and
+//             appends the visible ones to their group's command; groups with
+//             nothing visible keep instanceCount = 0
+
+namespace IndirectDraw
+{
+	enum class Mode : u8
+	{
+		Direct,
+		Indirect,
+		GpuCull,
+	};
+
+	constexpr u32 CAMERA_VIEW = 0;
+	constexpr u32 MAX_VIEWS = 1 + MAX_SHADOW_CASCADES;
+	constexpr u32 CULL_WORKGROUP_SIZE = 64;
+
+	// Entries not drawn for this many frames leave the pool. Their ranges are
+	// only reclaimed by the next relocation, which copies into a new buffer,
+	// so in-flight frames never see a range reused.
+	constexpr u64 EVICT_AFTER_FRAMES = 120;
+
+	struct CullCandidate
+	{
+		HMM_Vec4 bounds_min;
+		HMM_Vec4 bounds_max;
+		u32 index_count;
+		u32 first_index;
+		i32 vertex_offset;
+		u32 instance_first;	// group's first instance within the view
+		u32 record;
+		u32 command_slot;	// group's command within the view
+		u32 _pad0;
+		u32 _pad1;
+	};
+	static_assert(sizeof(CullCandidate) == 64, "Must match indirect_cull.comp's CullCandidate");
+
+	struct CullParams
+	{
+		HMM_Vec4 planes[6];
+		u32 candidate_count;
+		u32 view_command_base;
+		u32 view_instance_base;
+		u32 _pad0;
+	};
+	static_assert(sizeof(CullParams) == 112, "Must match indirect_cull.comp's push constant block");
+	static_assert(sizeof(DrawIndexedCommand) == sizeof(VkDrawIndexedIndirectCommand), "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+	static_assert(sizeof(DrawRecord) == 48, "DrawRecord must match shader_common.h");
+
+	struct View
+	{
+		bool active = false;
+		MeshPoolBatchRange ranges[MESH_POOL_BATCH_COUNT];
+		u32 instance_counts[MESH_POOL_BATCH_COUNT] = {};	// per batch; on gpu_cull every candidate
+		u32 command_base = 0;	// in DrawIndexedCommands
+		DynamicArray<i32> direct_object_ids;
+	};
+
+	// Per frame in flight: the host writes records/commands/candidates for the
+	// frame it is recording while the GPU may still read the previous slot
+	struct FrameBuffers
+	{
+		GpuBuffer<DrawRecord> records;
+		u32 record_capacity = 0;
+		GpuBuffer<u32> instances;	// every view's instance -> record lists
+		u32 instance_capacity = 0;
+		GpuBuffer<DrawIndexedCommand> commands;
+		u32 command_capacity = 0;
+		GpuBuffer<CullCandidate> candidates;
+		u32 candidate_capacity = 0;
+	};
+
+	// One pooled mesh object this frame; its index is its DrawRecord index
+	struct Candidate
+	{
+		i32 object_id = -1;
+		Mesh* mesh = nullptr;
+		MeshPoolBatch batch = MeshPoolBatch::Static;
+	};
+
+	struct DrawCounts
+	{
+		i32 draw_calls = 0;
+		i32 command_count = 0;
+		i32 mesh_count = 0;
+	};
+
+	inline Mode mode = Mode::Direct;
+	inline bool instancing = true;
+
+	inline MeshPool pool;
+	inline GpuBuffer<u8> pool_buffers[MESH_POOL_STREAM_COUNT];
+	inline FrameBuffers frames[MAX_FRAMES_IN_FLIGHT];
+	inline View views[MAX_VIEWS];
+	inline TypedComputeEffect<CullParams> cull_effect;
+
+	inline DynamicArray<Candidate> candidates;
+	inline DynamicArray<u32> candidate_entries;	// per candidate: pool entry
+	inline DynamicArray<i32> candidate_of_slot;	// render object slot -> candidate, -1
+	inline DynamicArray<i32> added_candidates;
+	inline ankerl::unordered_dense::set<u64> pending_stream_ids;
+	inline DynamicArray<DrawRecord> records;
+	inline DynamicArray<u32> visible_records;
+	inline DynamicArray<u32> command_slots;
+	inline MeshPoolCommandScratch command_scratch;
+	inline DynamicArray<DrawIndexedCommand> view_commands;
+	inline DynamicArray<u32> view_instances;
+	inline DynamicArray<DrawIndexedCommand> frame_commands;
+	inline DynamicArray<u32> frame_instances;
+	inline DynamicArray<u32> entry_instance_counts;	// per pool entry, this frame's candidates
+	inline DynamicArray<CullCandidate> cull_candidates;
+	inline DynamicArray<VulkanUploadRegion> upload_regions[MESH_POOL_STREAM_COUNT];
+	inline MeshPoolRelocation relocation;
+
+	static const char* const POOL_BUFFER_LABELS[MESH_POOL_STREAM_COUNT] = {
+		"IndirectDraw::pool_vertices",
+		"IndirectDraw::pool_compact_vertices",
+		"IndirectDraw::pool_indices32",
+		"IndirectDraw::pool_indices16",
+	};
+
+	inline const char* mode_name(Mode in_mode)
+	{
+		switch (in_mode)
+		{
+			case Mode::Direct: return "direct";
+			case Mode::Indirect: return "indirect";
+			case Mode::GpuCull: return "gpu_cull";
+		}
+		return "unknown";
+	}
+
+	inline Mode resolve_mode(const VulkanContext* ctx)
+	{
+		// Direct until tools/validate_indirect_draw.py has passed on a device
+		Mode requested = Mode::Direct;
+		const std::optional<std::string>& draw_path = RuntimeConfig::get().draw_path;
+		if (draw_path.has_value())
+		{
+			if (*draw_path == "direct") requested = Mode::Direct;
+			else if (*draw_path == "indirect") requested = Mode::Indirect;
+			else if (*draw_path == "gpu_cull") requested = Mode::GpuCull;
+			else printf("GAME2_DRAW_PATH: unknown path '%s', using direct\n", draw_path->c_str());
+		}
+		if (requested != Mode::Direct && !ctx->draw_indirect_enabled)
+		{
+			printf("GAME2_DRAW_PATH: %s needs multiDrawIndirect, using direct\n", mode_name(requested));
+			return Mode::Direct;
+		}
+		return requested;
+	}
+
+	inline bool enabled()
+	{
+		return mode != Mode::Direct;
+	}
+
+	inline void init(VulkanContext* ctx)
+	{
+		mode = resolve_mode(ctx);
+		instancing = RuntimeConfig::get().instancing.value_or(true);
+		printf("Geometry draw path: %s%s\n", mode_name(mode),
+			enabled() ? (instancing ? " (instanced)" : " (one command per mesh)") : "");
+
+		if (mode == Mode::GpuCull)
+		{
+			DescriptorBindingSpec bindings[3] = {};
+			for (u32 binding_idx = 0; binding_idx < 3; ++binding_idx)
+			{
+				bindings[binding_idx] = {
+					.binding = binding_idx,
+					.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+					.stages = VK_SHADER_STAGE_COMPUTE_BIT,
+				};
+			}
+			cull_effect.init(ctx, {
+				.shader_path = "bin/shaders/indirect_cull.comp.spv",
+				.bindings = bindings,
+				.binding_count = 3,
+			});
+		}
+	}
+
+	// Recreates in_out_buffer when it holds fewer than in_required elements.
+	// The old buffer is retired with the frame that last used it.
+	template<typename T>
+	inline void ensure_capacity(GpuBuffer<T>& in_out_buffer, u32& in_out_capacity, u32 in_required, GpuBufferUsage in_usage, const char* in_label)
+	{
+		if (in_required <= in_out_capacity && in_out_buffer.is_gpu_buffer_valid())
+		{
+			return;
+		}
+		in_out_buffer.destroy_gpu_buffer();
+		in_out_capacity = MAX(in_required, MAX(64u, in_out_capacity + in_out_capacity / 2));
+		in_out_buffer = GpuBuffer((GpuBufferDesc<T>) {
+			.data = nullptr,
+			.size = sizeof(T) * in_out_capacity,
+			.usage = in_usage,
+			.label = in_label,
+		});
+		in_out_buffer.get_gpu_buffer();
+	}
+
+	// This frame's DrawRecord buffer for frame_data_update (binding 6). Sized
+	// for every mesh object so prepare never has to replace it after the
+	// descriptor write; always valid, even on the direct path.
+	inline VkBuffer records_buffer(VulkanContext* ctx, State& in_state)
+	{
+		scene_ensure_indexes(in_state);
+		FrameBuffers& frame = frames[ctx->frame_index];
+		ensure_capacity(frame.records, frame.record_capacity,
+			MAX((u32) in_state.scene.indexes.mesh_object_ids.length(), 1u),
+			{ .storage_buffer = true, .stream_update = true },
+			"IndirectDraw::records");
+		return frame.records.get_gpu_buffer();
+	}
+
+	// This frame's instance buffer (binding 7): room for every mesh object in
+	// every view. gpu_cull writes it from indirect_cull.comp, so it stays on
+	// the device there.
+	inline VkBuffer instances_buffer(VulkanContext* ctx, State& in_state)
+	{
+		scene_ensure_indexes(in_state);
+		FrameBuffers& frame = frames[ctx->frame_index];
+		const GpuBufferUsage usage = mode == Mode::GpuCull
+			? (GpuBufferUsage) { .storage_buffer = true, .prefer_device_local = true }
+			: (GpuBufferUsage) { .storage_buffer = true, .stream_update = true };
+		ensure_capacity(frame.instances, frame.instance_capacity,
+			MAX((u32) in_state.scene.indexes.mesh_object_ids.length() * MAX_VIEWS, 1u),
+			usage, "IndirectDraw::instances");
+		return frame.instances.get_gpu_buffer();
+	}
+
+	inline bool view_active(u32 in_view)
+	{
+		return enabled() && in_view < MAX_VIEWS && views[in_view].active;
+	}
+
+	inline const DynamicArray<i32>& direct_object_ids(u32 in_view)
+	{
+		return views[in_view].direct_object_ids;
+	}
+
+	inline bool mesh_is_poolable(const Object& in_object)
+	{
+		const Mesh& mesh = in_object.mesh;
+		const TessellatedGeometry& tessellated = mesh.tessellated_geometry;
+		const bool is_tessellated = tessellated.active && tessellated.index_count > 0
+			&& tessellated.active_gpu_slot < TessellatedGeometry::GPU_SLOT_COUNT;
+		return in_object.visibility
+			&& in_object.has_mesh
+			&& in_object.render_object_index >= 0
+			&& mesh.stream_id != 0
+			&& !mesh.has_skinned_vertices
+			&& !is_tessellated
+			&& mesh.index_count > 0
+			&& mesh.vertex_count > 0
+			&& mesh.indices != nullptr
+			&& mesh.vertices != nullptr;
+	}
+
+	// Same choice as mesh_use_compact_vertex_source
+	inline MeshPoolBatch mesh_batch(const Mesh& in_mesh)
+	{
+		if (!in_mesh.compact_vertices)
+		{
+			return MeshPoolBatch::Static;
+		}
+		return in_mesh.compact_indices ? MeshPoolBatch::Compact16 : MeshPoolBatch::Compact;
+	}
+
+	inline GpuBufferUsage pool_buffer_usage(MeshPoolStream in_stream)
+	{
+		const bool is_vertex_stream = in_stream == MeshPoolStream::Vertices || in_stream == MeshPoolStream::CompactVertices;
+		return {
+			.vertex_buffer = is_vertex_stream,
+			.index_buffer = !is_vertex_stream,
+			.prefer_device_local = true,
+			.transfer_src = true,
+		};
+	}
+
+	// Replaces a stream's buffer with one of in_new_capacity elements and
+	// records the copies that pack its live entries to the front
+	inline void relocate_stream(VulkanContext* ctx, u32 in_stream_idx, u32 in_new_capacity, const DynamicArray<MeshPoolMove>& in_moves)
+	{
+		const u64 stride = MESH_POOL_STREAM_STRIDES[in_stream_idx];
+		GpuBuffer<u8> old_buffer = pool_buffers[in_stream_idx];
+		pool_buffers[in_stream_idx] = GpuBuffer((GpuBufferDesc<u8>) {
+			.data = nullptr,
+			.size = (u64) in_new_capacity * stride,
+			.usage = pool_buffer_usage((MeshPoolStream) in_stream_idx),
+			.label = POOL_BUFFER_LABELS[in_stream_idx],
+		});
+		VkBuffer new_buffer = pool_buffers[in_stream_idx].get_gpu_buffer();
+
+		if (!in_moves.empty() && old_buffer.is_gpu_buffer_valid())
+		{
+			VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
+			const VkPipelineStageFlags2 draw_stages = VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+			const VkAccessFlags2 draw_access = VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT;
+
+			// Uploads earlier this frame may still be writing the old buffer
+			VkMemoryBarrier2 before_copy = {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT | draw_stages,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT,
+			};
+			VkDependencyInfo before_dependency = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.memoryBarrierCount = 1,
+				.pMemoryBarriers = &before_copy,
+			};
+			gpu_cmd_pipeline_barrier(command_buffer, before_dependency);
+
+			DynamicArray<VkBufferCopy> copies;
+			for (const MeshPoolMove& move : in_moves)
+			{
+				copies.add({
+					.srcOffset = (u64) move.src_first * stride,
+					.dstOffset = (u64) move.dst_first * stride,
+					.size = (u64) move.count * stride,
+				});
+			}
+			vkCmdCopyBuffer(command_buffer, old_buffer.get_gpu_buffer(), new_buffer, (u32) copies.length(), copies.data());
+
+			VkMemoryBarrier2 after_copy = {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+				.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+				.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+				.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT | draw_stages,
+				.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT | draw_access,
+			};
+			VkDependencyInfo after_dependency = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.memoryBarrierCount = 1,
+				.pMemoryBarriers = &after_copy,
+			};
+			gpu_cmd_pipeline_barrier(command_buffer, after_dependency);
+		}
+		old_buffer.destroy_gpu_buffer();
+	}
+
+	// Finds or adds every candidate's pool entry and records the uploads and
+	// relocation copies. Fills candidate_entries.
+	inline void update_pool(VulkanContext* ctx)
+	{
+		const u64 frame = ctx->frame_number;
+		candidate_entries.resize(candidates.length());
+		added_candidates.clear();
+		u32 extra[MESH_POOL_STREAM_COUNT] = {};
+		pending_stream_ids.clear();
+		for (u32 candidate_idx = 0; candidate_idx < candidates.length(); ++candidate_idx)
+		{
+			const Candidate& candidate = candidates[candidate_idx];
+			if (mesh_pool_find(pool, candidate.mesh->stream_id, frame) >= 0)
+			{
+				continue;
+			}
+			// Objects sharing streams are uploaded once
+			if (pending_stream_ids.insert(candidate.mesh->stream_id).second)
+			{
+				added_candidates.add((i32) candidate_idx);
+				mesh_pool_add_stream_counts(candidate.batch, candidate.mesh->vertex_count, candidate.mesh->index_count, extra);
+			}
+		}
+
+		mesh_pool_evict(pool, frame, EVICT_AFTER_FRAMES);
+		if (mesh_pool_reserve(pool, extra, relocation))
+		{
+			for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+			{
+				if (relocation.relocated[stream_idx])
+				{
+					relocate_stream(ctx, stream_idx, relocation.new_capacity[stream_idx], relocation.moves[stream_idx]);
+				}
+			}
+		}
+
+		for (DynamicArray<VulkanUploadRegion>& regions : upload_regions)
+		{
+			regions.clear();
+		}
+		for (i32 candidate_idx : added_candidates)
+		{
+			const Candidate& candidate = candidates[candidate_idx];
+			const Mesh& mesh = *candidate.mesh;
+			const u32 entry_idx = mesh_pool_add(pool, mesh.stream_id, candidate.batch, mesh.vertex_count, mesh.index_count, frame);
+			const MeshPoolEntry& entry = pool.entries[entry_idx];
+
+			const u32 vertex_stream = (u32) mesh_pool_batch_vertex_stream(candidate.batch);
+			const u32 index_stream = (u32) mesh_pool_batch_index_stream(candidate.batch);
+			const void* vertex_data = candidate.batch == MeshPoolBatch::Static ? (const void*) mesh.vertices : (const void*) mesh.compact_vertices;
+			const void* index_data = candidate.batch == MeshPoolBatch::Compact16 ? (const void*) mesh.compact_indices : (const void*) mesh.indices;
+			upload_regions[vertex_stream].add({
+				.data = vertex_data,
+				.dst_offset = (u64) entry.vertex_first * MESH_POOL_STREAM_STRIDES[vertex_stream],
+				.size = (u64) entry.vertex_count * MESH_POOL_STREAM_STRIDES[vertex_stream],
+			});
+			upload_regions[index_stream].add({
+				.data = index_data,
+				.dst_offset = (u64) entry.index_first * MESH_POOL_STREAM_STRIDES[index_stream],
+				.size = (u64) entry.index_count * MESH_POOL_STREAM_STRIDES[index_stream],
+			});
+		}
+		for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+		{
+			if (upload_regions[stream_idx].empty())
+			{
+				continue;
+			}
+			const bool is_index_stream = stream_idx == (u32) MeshPoolStream::Indices32 || stream_idx == (u32) MeshPoolStream::Indices16;
+			vulkan_upload_record_buffer_regions(
+				ctx,
+				pool_buffers[stream_idx].get_gpu_buffer(),
+				upload_regions[stream_idx].data(),
+				(u32) upload_regions[stream_idx].length(),
+				is_index_stream ? VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT : VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+				is_index_stream ? VK_ACCESS_2_INDEX_READ_BIT : VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT
+			);
+		}
+
+		// Eviction and adds move entries; look every candidate up again
+		for (u32 candidate_idx = 0; candidate_idx < candidates.length(); ++candidate_idx)
+		{
+			const i32 entry_idx = mesh_pool_find(pool, candidates[candidate_idx].mesh->stream_id, frame);
+			assert(entry_idx >= 0);
+			candidate_entries[candidate_idx] = (u32) entry_idx;
+		}
+	}
+
+	// CPU culling: cull_objects per view; visible pooled objects become
+	// (instanced) commands and their view's instance list
+	inline void build_views_cpu(State& in_state, const HMM_Mat4* in_view_projections, const bool* in_view_active, u32 in_view_count, f32 in_bounds_padding)
+	{
+		frame_commands.clear();
+		frame_instances.clear();
+		for (u32 view_idx = 0; view_idx < in_view_count; ++view_idx)
+		{
+			View& view = views[view_idx];
+			if (!in_view_active[view_idx])
+			{
+				continue;
+			}
+
+			CullResult cull_result = cull_objects(in_state, in_view_projections[view_idx], in_bounds_padding);
+			visible_records.clear();
+			for (i32 object_id : cull_result.object_ids)
+			{
+				auto found = in_state.scene.objects.find(object_id);
+				if (found == in_state.scene.objects.end())
+				{
+					continue;
+				}
+				const i32 slot = found->second.render_object_index;
+				const i32 candidate_idx = slot >= 0 && slot < (i32) candidate_of_slot.length() ? candidate_of_slot[slot] : -1;
+				if (candidate_idx >= 0)
+				{
+					visible_records.add((u32) candidate_idx);
+				}
+				else
+				{
+					view.direct_object_ids.add(object_id);
+				}
+			}
+
+			mesh_pool_build_commands(pool, candidate_entries.data(), visible_records.data(), (u32) visible_records.length(),
+				instancing, (u32) frame_instances.length(), command_scratch, view_commands, view_instances, view.ranges);
+			view.command_base = (u32) frame_commands.length();
+			view.active = true;
+			for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+			{
+				const MeshPoolBatchRange& range = view.ranges[batch_idx];
+				for (u32 slot = range.first; slot < range.first + range.count; ++slot)
+				{
+					view.instance_counts[batch_idx] += view_commands[slot].instance_count;
+				}
+			}
+			for (const DrawIndexedCommand& command : view_commands)
+			{
+				frame_commands.add(command);
+			}
+			for (u32 record : view_instances)
+			{
+				frame_instances.add(record);
+			}
+		}
+	}
+
+	// GPU culling: every candidate group is a command in every view, zeroed
+	// here; indirect_cull.comp adds the visible instances. Non-candidates are
+	// culled here.
+	inline void build_views_gpu(VulkanContext* ctx, State& in_state, const HMM_Mat4* in_view_projections, const bool* in_view_active, u32 in_view_count, f32 in_bounds_padding)
+	{
+		const u32 candidate_count = (u32) candidates.length();
+		MeshPoolBatchRange ranges[MESH_POOL_BATCH_COUNT];
+		visible_records.resize(candidate_count);
+		for (u32 candidate_idx = 0; candidate_idx < candidate_count; ++candidate_idx)
+		{
+			visible_records[candidate_idx] = candidate_idx;
+		}
+		command_slots.resize(candidate_count);
+		mesh_pool_build_commands(pool, candidate_entries.data(), visible_records.data(), candidate_count,
+			instancing, 0, command_scratch, view_commands, view_instances, ranges, command_slots.data());
+		const u32 group_count = (u32) view_commands.length();
+
+		u32 batch_candidate_counts[MESH_POOL_BATCH_COUNT] = {};
+		cull_candidates.resize(candidate_count);
+		for (u32 candidate_idx = 0; candidate_idx < candidate_count; ++candidate_idx)
+		{
+			const Candidate& candidate = candidates[candidate_idx];
+			BoundingBox bounds = object_get_bounding_box(in_state.scene.objects[candidate.object_id]);
+			if (in_bounds_padding > 0.0f)
+			{
+				const HMM_Vec3 padding = HMM_V3(in_bounds_padding, in_bounds_padding, in_bounds_padding);
+				bounds.min -= padding;
+				bounds.max += padding;
+			}
+			const u32 slot = command_slots[candidate_idx];
+			const DrawIndexedCommand& command = view_commands[slot];
+			cull_candidates[candidate_idx] = {
+				.bounds_min = HMM_V4V(bounds.min, 0.0f),
+				.bounds_max = HMM_V4V(bounds.max, 0.0f),
+				.index_count = command.index_count,
+				.first_index = command.first_index,
+				.vertex_offset = command.vertex_offset,
+				.instance_first = command.first_instance,
+				.record = candidate_idx,
+				.command_slot = slot,
+			};
+			batch_candidate_counts[(u32) candidate.batch] += 1;
+		}
+
+		FrameBuffers& frame = frames[ctx->frame_index];
+		ensure_capacity(frame.commands, frame.command_capacity, MAX(group_count * in_view_count, 1u),
+			{ .storage_buffer = true, .indirect_buffer = true, .prefer_device_local = true },
+			"IndirectDraw::gpu_commands");
+		assert(candidate_count * in_view_count <= frame.instance_capacity);
+		u32 active_view_count = 0;
+		for (u32 view_idx = 0; view_idx < in_view_count; ++view_idx)
+		{
+			View& view = views[view_idx];
+			if (!in_view_active[view_idx])
+			{
+				continue;
+			}
+			view.active = true;
+			view.command_base = view_idx * group_count;
+			for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+			{
+				view.ranges[batch_idx] = ranges[batch_idx];
+				view.instance_counts[batch_idx] = batch_candidate_counts[batch_idx];
+			}
+			active_view_count += 1;
+
+			const CullView cull_view = {
+				.frustum = frustum_create(in_view_projections[view_idx]),
+				.bounds_padding = in_bounds_padding,
+			};
+			for (i32 mesh_object_id : in_state.scene.indexes.mesh_object_ids)
+			{
+				auto found = in_state.scene.objects.find(mesh_object_id);
+				if (found == in_state.scene.objects.end())
+				{
+					continue;
+				}
+				const Object& object = found->second;
+				if (!object.visibility || !object.has_mesh || mesh_is_poolable(object) || !mesh_gpu_ready(object.mesh))
+				{
+					continue;
+				}
+				if (mesh_is_always_visible(object.mesh)
+					|| cull_box_reference(cull_view, object_get_bounding_box(object)) == ECullBoxResult::Visible)
+				{
+					view.direct_object_ids.add(mesh_object_id);
+				}
+			}
+		}
+		if (active_view_count == 0 || candidate_count == 0)
+		{
+			return;
+		}
+
+		ensure_capacity(frame.candidates, frame.candidate_capacity, candidate_count,
+			{ .storage_buffer = true, .stream_update = true },
+			"IndirectDraw::cull_candidates");
+		frame.candidates.update_gpu_buffer(cull_candidates.data(), sizeof(CullCandidate) * candidate_count);
+
+		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
+		VkBuffer commands_buffer = frame.commands.get_gpu_buffer();
+
+		// Last frame in this slot finished reading before begin_frame returned;
+		// this orders the fill after any earlier read in the same slot
+		VkMemoryBarrier2 before_fill = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+			.srcAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		};
+		VkDependencyInfo before_fill_dependency = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = 1,
+			.pMemoryBarriers = &before_fill,
+		};
+		gpu_cmd_pipeline_barrier(command_buffer, before_fill_dependency);
+		vkCmdFillBuffer(command_buffer, commands_buffer, 0,
+			(VkDeviceSize) group_count * in_view_count * sizeof(DrawIndexedCommand), 0);
+		VkMemoryBarrier2 after_fill = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+			.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		};
+		VkDependencyInfo after_fill_dependency = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = 1,
+			.pMemoryBarriers = &after_fill,
+		};
+		gpu_cmd_pipeline_barrier(command_buffer, after_fill_dependency);
+
+		DescriptorWriter writer = cull_effect.writer(ctx);
+		writer.buffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.candidates.get_gpu_buffer());
+		writer.buffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, commands_buffer);
+		writer.buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.instances.get_gpu_buffer());
+		writer.commit();
+		cull_effect.bind(ctx, writer.set);
+
+		const u32 workgroup_count = (candidate_count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE;
+		for (u32 view_idx = 0; view_idx < in_view_count; ++view_idx)
+		{
+			if (!views[view_idx].active)
+			{
+				continue;
+			}
+			const Frustum frustum = frustum_create(in_view_projections[view_idx]);
+			CullParams params = {
+				.candidate_count = candidate_count,
+				.view_command_base = views[view_idx].command_base,
+				.view_instance_base = view_idx * candidate_count,
+			};
+			memcpy(params.planes, frustum.planes, sizeof(params.planes));
+			cull_effect.dispatch(ctx, params, workgroup_count, 1, 1);
+		}
+
+		VkMemoryBarrier2 after_cull = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+			.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+		};
+		VkDependencyInfo after_cull_dependency = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = 1,
+			.pMemoryBarriers = &after_cull,
+		};
+		gpu_cmd_pipeline_barrier(command_buffer, after_cull_dependency);
+	}
+
+	// Builds this frame's records, pool contents and per-view commands.
+	// in_view_projections[0] is the camera; 1 + i is cascade i. Records
+	// transfers and dispatches, so call it outside any render pass and before
+	// the passes that draw the views.
+	inline void prepare(VulkanContext* ctx, State& in_state, const HMM_Mat4* in_view_projections, const bool* in_view_active, u32 in_view_count)
+	{
+		assert(in_view_count <= MAX_VIEWS);
+		for (View& view : views)
+		{
+			view.active = false;
+			view.command_base = 0;
+			for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+			{
+				view.ranges[batch_idx] = {};
+				view.instance_counts[batch_idx] = 0;
+			}
+			view.direct_object_ids.clear();
+		}
+		if (!enabled() || !in_state.render_objects.valid)
+		{
+			return;
+		}
+
+		CPU_TIMING_SCOPE("Indirect Draw Prepare");
+		scene_ensure_indexes(in_state);
+
+		candidates.clear();
+		candidate_of_slot.clear();
+		for (i32 mesh_object_id : in_state.scene.indexes.mesh_object_ids)
+		{
+			auto found = in_state.scene.objects.find(mesh_object_id);
+			if (found == in_state.scene.objects.end() || !mesh_is_poolable(found->second))
+			{
+				continue;
+			}
+			Object& object = found->second;
+			if (object.render_object_index >= (i32) candidate_of_slot.length())
+			{
+				const u32 old_length = (u32) candidate_of_slot.length();
+				candidate_of_slot.resize(object.render_object_index + 1);
+				for (u32 slot = old_length; slot < candidate_of_slot.length(); ++slot)
+				{
+					candidate_of_slot[slot] = -1;
+				}
+			}
+			candidate_of_slot[object.render_object_index] = (i32) candidates.length();
+			candidates.add({
+				.object_id = mesh_object_id,
+				.mesh = &object.mesh,
+				.batch = mesh_batch(object.mesh),
+			});
+		}
+
+		update_pool(ctx);
+
+		FrameBuffers& frame = frames[ctx->frame_index];
+		assert(candidates.length() <= frame.record_capacity);
+		records.resize(candidates.length());
+		for (u32 candidate_idx = 0; candidate_idx < candidates.length(); ++candidate_idx)
+		{
+			const Candidate& candidate = candidates[candidate_idx];
+			records[candidate_idx] = {
+				.object_index = in_state.scene.objects[candidate.object_id].render_object_index,
+				.position_min = HMM_V4V(candidate.mesh->quantization.position_min, 0.0f),
+				.position_extent = HMM_V4V(candidate.mesh->quantization.position_extent, 0.0f),
+			};
+		}
+		if (!records.empty())
+		{
+			frame.records.update_gpu_buffer(records.data(), sizeof(DrawRecord) * records.length());
+		}
+
+		const f32 bounds_padding = in_state.tessellation.enabled ? in_state.tessellation.bounds_padding : 0.0f;
+		if (mode == Mode::GpuCull)
+		{
+			build_views_gpu(ctx, in_state, in_view_projections, in_view_active, in_view_count, bounds_padding);
+		}
+		else
+		{
+			build_views_cpu(in_state, in_view_projections, in_view_active, in_view_count, bounds_padding);
+			ensure_capacity(frame.commands, frame.command_capacity, MAX((u32) frame_commands.length(), 1u),
+				{ .storage_buffer = true, .indirect_buffer = true, .stream_update = true },
+				"IndirectDraw::commands");
+			if (!frame_commands.empty())
+			{
+				frame.commands.update_gpu_buffer(frame_commands.data(), sizeof(DrawIndexedCommand) * frame_commands.length());
+			}
+			assert(frame_instances.length() <= frame.instance_capacity);
+			if (!frame_instances.empty())
+			{
+				frame.instances.update_gpu_buffer(frame_instances.data(), sizeof(u32) * frame_instances.length());
+			}
+		}
+
+		// What sharing entries saves: every object past the first of a group
+		// would otherwise hold its own copy of the streams and its own command
+		entry_instance_counts.resize(pool.entries.length());
+		for (u32& count : entry_instance_counts)
+		{
+			count = 0;
+		}
+		for (u32 entry_idx : candidate_entries)
+		{
+			entry_instance_counts[entry_idx] += 1;
+		}
+		State::DataOrientedState::FrameAccessStats& stats = in_state.data_oriented.frame;
+		stats.instance_groups = 0;
+		stats.instanced_meshes = 0;
+		stats.instancing_bytes_saved = 0;
+		for (u32 entry_idx = 0; entry_idx < pool.entries.length(); ++entry_idx)
+		{
+			const u32 count = entry_instance_counts[entry_idx];
+			if (count < 2)
+			{
+				continue;
+			}
+			const MeshPoolEntry& entry = pool.entries[entry_idx];
+			const u64 entry_bytes = (u64) entry.vertex_count * MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_vertex_stream(entry.batch)]
+				+ (u64) entry.index_count * MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_index_stream(entry.batch)];
+			stats.instance_groups += 1;
+			stats.instanced_meshes += (i32) count;
+			stats.instancing_bytes_saved += (count - 1) * entry_bytes;
+		}
+		ctx->metrics.instancing_bytes_saved = stats.instancing_bytes_saved;
+
+		stats.indirect_pool_meshes = (i32) pool.entries.length();
+		stats.indirect_pool_bytes = 0;
+		for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+		{
+			stats.indirect_pool_bytes += (u64) pool.streams[stream_idx].capacity * MESH_POOL_STREAM_STRIDES[stream_idx];
+		}
+	}
+
+	// Records one view's indirect draws: per batch with commands, bind its
+	// pipeline and pool buffers and draw the range. The caller has bound the
+	// pass's descriptor set and pushed its constants. Mesh counts are the
+	// culled instance totals; on gpu_cull they count every candidate.
+	inline DrawCounts draw_view(VulkanContext* ctx, u32 in_view, const VkPipeline in_pipelines[MESH_POOL_BATCH_COUNT], VkPipeline& in_out_bound_pipeline)
+	{
+		DrawCounts out_counts;
+		if (!view_active(in_view))
+		{
+			return out_counts;
+		}
+
+		const View& view = views[in_view];
+		FrameBuffers& frame = frames[ctx->frame_index];
+		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
+		VkBuffer commands_buffer = frame.commands.get_gpu_buffer();
+		const u32 max_draw_count = MAX(ctx->physical_device_properties.limits.maxDrawIndirectCount, 1u);
+
+		for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+		{
+			const MeshPoolBatchRange& range = view.ranges[batch_idx];
+			if (range.count == 0)
+			{
+				continue;
+			}
+
+			const MeshPoolBatch batch = (MeshPoolBatch) batch_idx;
+			if (in_out_bound_pipeline != in_pipelines[batch_idx])
+			{
+				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, in_pipelines[batch_idx]);
+				in_out_bound_pipeline = in_pipelines[batch_idx];
+			}
+			VkBuffer vertex_buffer = pool_buffers[(u32) mesh_pool_batch_vertex_stream(batch)].get_gpu_buffer();
+			VkDeviceSize vertex_offset = 0;
+			vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertex_buffer, &vertex_offset);
+			vkCmdBindIndexBuffer(command_buffer, pool_buffers[(u32) mesh_pool_batch_index_stream(batch)].get_gpu_buffer(), 0,
+				batch == MeshPoolBatch::Compact16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+			const VkDeviceSize first_offset = (VkDeviceSize) (view.command_base + range.first) * sizeof(DrawIndexedCommand);
+			for (u32 first = 0; first < range.count; first += max_draw_count)
+			{
+				const u32 draw_count = MIN(range.count - first, max_draw_count);
+				vulkan_cmd_draw_indexed_indirect(ctx, commands_buffer,
+					first_offset + (VkDeviceSize) first * sizeof(DrawIndexedCommand),
+					draw_count, sizeof(DrawIndexedCommand));
+				out_counts.draw_calls += 1;
+			}
+			out_counts.command_count += (i32) range.count;
+			out_counts.mesh_count += (i32) view.instance_counts[batch_idx];
+		}
+		ctx->metrics.indirect_commands += (u64) out_counts.command_count;
+		return out_counts;
+	}
+
+	inline void shutdown(VulkanContext* ctx)
+	{
+		if (mode == Mode::GpuCull)
+		{
+			cull_effect.shutdown(ctx);
+		}
+		for (GpuBuffer<u8>& buffer : pool_buffers)
+		{
+			buffer.destroy_gpu_buffer();
+		}
+		for (FrameBuffers& frame : frames)
+		{
+			frame.records.destroy_gpu_buffer();
+			frame.instances.destroy_gpu_buffer();
+			frame.commands.destroy_gpu_buffer();
+			frame.candidates.destroy_gpu_buffer();
+			frame = {};
+		}
+		pool = {};
+	}
+}
@@ -8,7 +8,7 @@
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
 #include "render/render_pass.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
 #include "render/geometry_pass.h"
 #include "render/lighting_pass.h"
@@ -135,6 +135,11 @@ static_assert(sizeof(SpecularPrefilterPushConstants) == 16, "Specular prefilter
 
 struct LightingCapture
 {
+	// Probe captures one frame can record; sizes the per-frame slot rings
+	// below and the descriptor pool (sized for 4 captures, scaled from there)
+	static constexpr i32 MAX_CAPTURES_PER_FRAME = 8;
+	static constexpr u32 DESCRIPTOR_POOL_SCALE = (u32) MAX_CAPTURES_PER_FRAME / 4;
+
 	LightingCaptureDesc desc;
 
 	RenderPass geometry_pass;		// Multi: 6 face G-buffers
@@ -153,7 +158,7 @@ struct LightingCapture
 
 	// Capture lighting: layout C reused; RGBA32F pipeline variant + slot ring
 	VkPipeline capture_lighting_pipeline = VK_NULL_HANDLE;
-	static constexpr i32 LIGHTING_SLOTS_PER_FRAME = NUM_CUBE_FACES * 4;	// probes_to_update_per_frame
+	static constexpr i32 LIGHTING_SLOTS_PER_FRAME = NUM_CUBE_FACES * MAX_CAPTURES_PER_FRAME;
 	GpuBuffer<LightingFsParams> lighting_slot_ubos[MAX_FRAMES_IN_FLIGHT][LIGHTING_SLOTS_PER_FRAME];
 	VkDescriptorSet lighting_slot_sets[MAX_FRAMES_IN_FLIGHT][LIGHTING_SLOTS_PER_FRAME] = {};
 	i32 lighting_slot_cursor = 0;
@@ -162,7 +167,7 @@ struct LightingCapture
 	VkDescriptorSetLayout radial_depth_set_layout = VK_NULL_HANDLE;
 	VkPipelineLayout radial_depth_pipeline_layout = VK_NULL_HANDLE;
 	VkPipeline radial_depth_pipeline = VK_NULL_HANDLE;
-	static constexpr i32 RADIAL_SLOTS_PER_FRAME = NUM_CUBE_FACES * 4;
+	static constexpr i32 RADIAL_SLOTS_PER_FRAME = NUM_CUBE_FACES * MAX_CAPTURES_PER_FRAME;
 	VkDescriptorSet radial_slot_sets[MAX_FRAMES_IN_FLIGHT][RADIAL_SLOTS_PER_FRAME] = {};
 	i32 radial_slot_cursor = 0;
 
@@ -175,7 +180,7 @@ struct LightingCapture
 	// Probe radiance projection compute (per-frame sets: sh9/sg9 buffers
 	// change on layout rebuilds)
 	TypedComputeEffect<ProbeProjectionPushConstants> projection_effect;
-	static constexpr i32 PROJECTION_SLOTS_PER_FRAME = 8;	// <=2 modes * 4 probes
+	static constexpr i32 PROJECTION_SLOTS_PER_FRAME = 2 * MAX_CAPTURES_PER_FRAME;	// <=2 modes per probe
 	VkDescriptorSet projection_slot_sets[MAX_FRAMES_IN_FLIGHT][PROJECTION_SLOTS_PER_FRAME] = {};
 	i32 projection_slot_cursor = 0;
 
@@ -202,7 +207,7 @@ struct LightingCapture
 
 	VkFormat color_format = VK_FORMAT_R32G32B32A32_SFLOAT;
 
-	VkPipeline create_fullscreen_pipeline(
+	void create_fullscreen_pipeline(
 		VulkanContext* ctx,
 		VkPipelineLayout in_layout,
 		const char* in_vert_path,
@@ -210,11 +215,12 @@ struct LightingCapture
 		const VkFormat* in_color_formats,
 		u32 in_color_count,
 		VkFormat in_depth_format,
-		bool in_depth_write
+		bool in_depth_write,
+		VkPipeline* out_pipeline
 	)
 	{
-		VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, in_vert_path);
-		VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, in_frag_path);
+		VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, in_vert_path);
+		VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, in_frag_path);
 
 		VkPipelineShaderStageCreateInfo shader_stages[] = {
 			{
@@ -303,18 +309,13 @@ struct LightingCapture
 			.layout = in_layout,
 			.renderPass = VK_NULL_HANDLE,
 		};
-		VkPipeline out_pipeline = VK_NULL_HANDLE;
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &out_pipeline));
-
-		vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-		vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-		return out_pipeline;
+		PipelineBuildService::graphics(ctx, pipeline_create_info, out_pipeline);
 	}
 
-	VkPipeline create_capture_geometry_pipeline(VulkanContext* ctx, const char* in_vert_path, bool in_skinned)
+	void create_capture_geometry_pipeline(VulkanContext* ctx, const char* in_vert_path, bool in_skinned, VkPipeline* out_pipeline)
 	{
-		VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, in_vert_path);
-		VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/geometry_capture.frag.spv");
+		VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, in_vert_path);
+		VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, "bin/shaders/geometry_capture.frag.spv");
 
 		VkPipelineShaderStageCreateInfo shader_stages[] = {
 			{
@@ -424,12 +425,7 @@ struct LightingCapture
 			.layout = capture_geometry_pipeline_layout,
 			.renderPass = VK_NULL_HANDLE,
 		};
-		VkPipeline out_pipeline = VK_NULL_HANDLE;
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &out_pipeline));
-
-		vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-		vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-		return out_pipeline;
+		PipelineBuildService::graphics(ctx, pipeline_create_info, out_pipeline);
 	}
 
 	void init(VulkanContext* ctx, const LightingCaptureDesc& in_desc)
@@ -547,13 +543,13 @@ struct LightingCapture
 		// ---- Pool + sets ----
 		{
 			VkDescriptorPoolSize pool_sizes[] = {
-				{ .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 128 },
-				{ .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 512 },
-				{ .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 512 },
+				{ .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 128 * DESCRIPTOR_POOL_SCALE },
+				{ .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 512 * DESCRIPTOR_POOL_SCALE },
+				{ .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 512 * DESCRIPTOR_POOL_SCALE },
 			};
 			VkDescriptorPoolCreateInfo pool_create_info = {
 				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-				.maxSets = 192,
+				.maxSets = 192 * DESCRIPTOR_POOL_SCALE,
 				.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]),
 				.pPoolSizes = pool_sizes,
 			};
@@ -689,55 +685,61 @@ struct LightingCapture
 		}
 
 		// ---- Pipelines ----
-		capture_geometry_pipeline = create_capture_geometry_pipeline(ctx, "bin/shaders/geometry_capture.vert.spv", false);
-		capture_geometry_skinned_pipeline = create_capture_geometry_pipeline(ctx, "bin/shaders/geometry_capture_skinned.vert.spv", true);
+		create_capture_geometry_pipeline(ctx, "bin/shaders/geometry_capture.vert.spv", false, &capture_geometry_pipeline);
+		create_capture_geometry_pipeline(ctx, "bin/shaders/geometry_capture_skinned.vert.spv", true, &capture_geometry_skinned_pipeline);
 
 		{
 			VkFormat sky_formats[4] = {
 				Render::GBUFFER_FORMAT, Render::GBUFFER_FORMAT,
 				Render::GBUFFER_FORMAT, Render::GBUFFER_FORMAT,
 			};
-			capture_sky_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, capture_sky_pipeline_layout,
 				"bin/shaders/sky_capture.vert.spv", "bin/shaders/sky_capture.frag.spv",
-				sky_formats, 4, Render::SCENE_DEPTH_FORMAT, /*depth write*/ true
+				sky_formats, 4, Render::SCENE_DEPTH_FORMAT, /*depth write*/ true,
+				&capture_sky_pipeline
 			);
 		}
 		{
 			VkFormat lighting_formats[1] = { color_format };
-			capture_lighting_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, ::lighting_pass.pipeline_layout,
 				"bin/shaders/lighting.vert.spv", "bin/shaders/lighting.frag.spv",
-				lighting_formats, 1, VK_FORMAT_UNDEFINED, false
+				lighting_formats, 1, VK_FORMAT_UNDEFINED, false,
+				&capture_lighting_pipeline
 			);
 		}
 		{
 			VkFormat radial_formats[1] = { color_format };
-			radial_depth_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, radial_depth_pipeline_layout,
 				"bin/shaders/radial_depth.vert.spv", "bin/shaders/radial_depth.frag.spv",
-				radial_formats, 1, VK_FORMAT_UNDEFINED, false
+				radial_formats, 1, VK_FORMAT_UNDEFINED, false,
+				&radial_depth_pipeline
 			);
 		}
 		{
 			VkFormat oct_formats[2] = { color_format, color_format };
-			cube_to_oct_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, cube_to_oct_pipeline_layout,
 				"bin/shaders/cubemap_to_octahedral.vert.spv", "bin/shaders/cubemap_to_octahedral.frag.spv",
-				oct_formats, 2, VK_FORMAT_UNDEFINED, false
+				oct_formats, 2, VK_FORMAT_UNDEFINED, false,
+				&cube_to_oct_pipeline
 			);
 		}
 		{
 			VkFormat prefilter_formats[1] = { ctx->capabilities.scene_color_format };
-			specular_prefilter_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, specular_prefilter_pipeline_layout,
 				"bin/shaders/cubemap_to_octahedral.vert.spv", "bin/shaders/probe_specular_prefilter.frag.spv",
-				prefilter_formats, 1, VK_FORMAT_UNDEFINED, false
+				prefilter_formats, 1, VK_FORMAT_UNDEFINED, false,
+				&specular_prefilter_pipeline
 			);
-			brdf_lut_pipeline = create_fullscreen_pipeline(
+			create_fullscreen_pipeline(
 				ctx, brdf_lut_pipeline_layout,
 				"bin/shaders/cubemap_to_octahedral.vert.spv", "bin/shaders/brdf_integration.frag.spv",
-				prefilter_formats, 1, VK_FORMAT_UNDEFINED, false
+				prefilter_formats, 1, VK_FORMAT_UNDEFINED, false,
+				&brdf_lut_pipeline
 			);
 		}
 		// ---- Static resources ----
@@ -795,6 +797,9 @@ struct LightingCapture
 			.aspect = VK_IMAGE_ASPECT_COLOR_BIT,
 			.label = "GI Split-Sum BRDF LUT",
 		});
+		// The LUT draw binds brdf_lut_pipeline, which may still be queued in
+		// the startup batch
+		PipelineBuildService::flush(ctx);
 		vulkan_context_immediate_submit(ctx, [&](VkCommandBuffer command_buffer)
 		{
 			gpu_image_transition(command_buffer, brdf_lut, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true);
@@ -1475,7 +1480,7 @@ struct LightingCapture
 				.memoryBarrierCount = 1,
 				.pMemoryBarriers = &memory_barrier,
 			};
-			vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+			gpu_cmd_pipeline_barrier(command_buffer, dependency_info);
 		}
 	}
 
@@ -3,7 +3,7 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/gpu_buffer.h"
 #include "render/bruneton_atmosphere_pass.h"
 
@@ -234,8 +234,8 @@ void lighting_pass_init(VulkanContext* ctx, VkSampler in_linear_sampler)
 		};
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &pipeline_layout_create_info, nullptr, &lighting_pass.pipeline_layout));
 
-		VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, "bin/shaders/lighting.vert.spv");
-		VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/lighting.frag.spv");
+		VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, "bin/shaders/lighting.vert.spv");
+		VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, "bin/shaders/lighting.frag.spv");
 
 		VkPipelineShaderStageCreateInfo shader_stages[] = {
 			{
@@ -319,10 +319,7 @@ void lighting_pass_init(VulkanContext* ctx, VkSampler in_linear_sampler)
 			.layout = lighting_pass.pipeline_layout,
 			.renderPass = VK_NULL_HANDLE,
 		};
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &lighting_pass.pipeline));
-
-		vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-		vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
+		PipelineBuildService::graphics(ctx, pipeline_create_info, &lighting_pass.pipeline);
 	}
 }
 
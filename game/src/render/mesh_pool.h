@@ -0,0 +1,424 @@
+#pragma once
+
+#include <cassert>
+
+#include "ankerl/unordered_dense.h"
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "render/vertex_types.h"
+
+// ---- Mesh pool ----
+// Bookkeeping for the indirect draw path (render/indirect_draw.h). Static
+// meshes are copied into four shared streams (float vertices, compact
+// vertices, 32-bit and 16-bit indices) so every mesh of one batch draws from
+// the same bound vertex/index buffer and a whole view becomes a few
+// vkCmdDrawIndexedIndirect calls.
+//
+// Entries are keyed by Mesh::stream_id, which is never reused, so a resident
+// entry always matches its mesh's streams. Each stream is a bump allocator:
+// new entries go after the last one, and entries nobody drew for a while are
+// evicted without freeing their range. When a stream runs out,
+// mesh_pool_reserve packs the live entries into a new buffer (grown if
+// needed) and returns the copies the caller must record. Old ranges are
+// never overwritten, so frames still in flight can keep reading them.
+//
+// Nothing here touches Vulkan; the test drives it against CPU arrays.
+
+enum class MeshPoolStream : u8
+{
+	Vertices,			// Vertex
+	CompactVertices,	// CompactVertex
+	Indices32,
+	Indices16,
+	Count,
+};
+static constexpr u32 MESH_POOL_STREAM_COUNT = (u32) MeshPoolStream::Count;
+static constexpr u32 MESH_POOL_STREAM_STRIDES[MESH_POOL_STREAM_COUNT] = {
+	sizeof(Vertex),
+	sizeof(CompactVertex),
+	sizeof(u32),
+	sizeof(u16),
+};
+static constexpr u32 MESH_POOL_MIN_CAPACITY = 1u << 16;	// elements, per stream
+
+// One pipeline + vertex/index buffer pair per batch
+enum class MeshPoolBatch : u8
+{
+	Static,		// Vertex + u32
+	Compact,	// CompactVertex + u32
+	Compact16,	// CompactVertex + u16
+	Count,
+};
+static constexpr u32 MESH_POOL_BATCH_COUNT = (u32) MeshPoolBatch::Count;
+
+inline MeshPoolStream mesh_pool_batch_vertex_stream(MeshPoolBatch in_batch)
+{
+	return in_batch == MeshPoolBatch::Static ? MeshPoolStream::Vertices : MeshPoolStream::CompactVertices;
+}
+
+inline MeshPoolStream mesh_pool_batch_index_stream(MeshPoolBatch in_batch)
+{
+	return in_batch == MeshPoolBatch::Compact16 ? MeshPoolStream::Indices16 : MeshPoolStream::Indices32;
+}
+
+// Same layout as VkDrawIndexedIndirectCommand (checked in indirect_draw.h)
+struct DrawIndexedCommand
+{
+	u32 index_count;
+	u32 instance_count;
+	u32 first_index;
+	i32 vertex_offset;
+	u32 first_instance;
+};
+static_assert(sizeof(DrawIndexedCommand) == 20, "DrawIndexedCommand must match VkDrawIndexedIndirectCommand");
+
+struct MeshPoolEntry
+{
+	u64 stream_id = 0;
+	u64 last_used_frame = 0;
+	MeshPoolBatch batch = MeshPoolBatch::Static;
+	u32 vertex_first = 0;	// elements into the batch's vertex stream
+	u32 vertex_count = 0;
+	u32 index_first = 0;	// elements into the batch's index stream
+	u32 index_count = 0;
+};
+
+struct MeshPoolStreamState
+{
+	u32 used = 0;		// bump cursor
+	u32 capacity = 0;	// 0 until the first reserve
+	u32 live = 0;		// elements owned by resident entries
+};
+
+// Contiguous run copied from the old buffer to the new one, in elements
+struct MeshPoolMove
+{
+	u32 src_first = 0;
+	u32 dst_first = 0;
+	u32 count = 0;
+};
+
+// Streams mesh_pool_reserve moved to a new buffer of new_capacity elements
+struct MeshPoolRelocation
+{
+	bool relocated[MESH_POOL_STREAM_COUNT] = {};
+	u32 new_capacity[MESH_POOL_STREAM_COUNT] = {};
+	DynamicArray<MeshPoolMove> moves[MESH_POOL_STREAM_COUNT];
+};
+
+// Cumulative counters for logs and the benchmark report
+struct MeshPoolCounters
+{
+	u64 entries_added = 0;
+	u64 entries_evicted = 0;
+	u64 relocations = 0;		// streams moved to a new buffer
+	u64 elements_moved = 0;
+};
+
+struct MeshPool
+{
+	DynamicArray<MeshPoolEntry> entries;
+	ankerl::unordered_dense::map<u64, u32> entry_of_stream;	// stream id -> entries index
+	MeshPoolStreamState streams[MESH_POOL_STREAM_COUNT];
+	MeshPoolCounters counters;
+};
+
+inline MeshPoolStreamState& mesh_pool_stream(MeshPool& in_pool, MeshPoolStream in_stream)
+{
+	return in_pool.streams[(u32) in_stream];
+}
+
+// Entry index for a resident stream id, or -1. A hit counts as a use this frame.
+inline i32 mesh_pool_find(MeshPool& in_pool, u64 in_stream_id, u64 in_frame)
+{
+	auto found = in_pool.entry_of_stream.find(in_stream_id);
+	if (found == in_pool.entry_of_stream.end())
+	{
+		return -1;
+	}
+	in_pool.entries[found->second].last_used_frame = in_frame;
+	return (i32) found->second;
+}
+
+// Element counts an entry of in_batch takes from each stream
+inline void mesh_pool_add_stream_counts(MeshPoolBatch in_batch, u32 in_vertex_count, u32 in_index_count, u32 in_out_counts[MESH_POOL_STREAM_COUNT])
+{
+	in_out_counts[(u32) mesh_pool_batch_vertex_stream(in_batch)] += in_vertex_count;
+	in_out_counts[(u32) mesh_pool_batch_index_stream(in_batch)] += in_index_count;
+}
+
+// Drops entries last drawn more than in_unused_frames frames ago. Their
+// ranges stay allocated until the next relocation packs them out.
+inline u32 mesh_pool_evict(MeshPool& in_pool, u64 in_frame, u64 in_unused_frames)
+{
+	u32 evicted = 0;
+	for (u32 entry_idx = 0; entry_idx < in_pool.entries.length();)
+	{
+		const MeshPoolEntry entry = in_pool.entries[entry_idx];
+		if (in_frame - entry.last_used_frame <= in_unused_frames)
+		{
+			++entry_idx;
+			continue;
+		}
+
+		mesh_pool_stream(in_pool, mesh_pool_batch_vertex_stream(entry.batch)).live -= entry.vertex_count;
+		mesh_pool_stream(in_pool, mesh_pool_batch_index_stream(entry.batch)).live -= entry.index_count;
+		in_pool.entry_of_stream.erase(entry.stream_id);
+
+		const u32 last_idx = (u32) in_pool.entries.length() - 1;
+		if (entry_idx != last_idx)
+		{
+			in_pool.entries[entry_idx] = in_pool.entries[last_idx];
+			in_pool.entry_of_stream[in_pool.entries[entry_idx].stream_id] = entry_idx;
+		}
+		in_pool.entries.pop();
+		evicted += 1;
+	}
+	in_pool.counters.entries_evicted += evicted;
+	return evicted;
+}
+
+// Makes room for in_extra more elements per stream before they are added.
+// A stream without room is packed into a new buffer: its live entries move
+// to the front in entry order and their offsets are rewritten. The buffer
+// grows by half when packing alone would not fit. Returns true when any
+// stream relocated; the caller then creates the new buffers and records
+// out_relocation's moves from the old ones.
+inline bool mesh_pool_reserve(MeshPool& in_pool, const u32 in_extra[MESH_POOL_STREAM_COUNT], MeshPoolRelocation& out_relocation)
+{
+	bool any_relocated = false;
+	for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+	{
+		MeshPoolStreamState& stream = in_pool.streams[stream_idx];
+		out_relocation.relocated[stream_idx] = false;
+		out_relocation.new_capacity[stream_idx] = stream.capacity;
+		out_relocation.moves[stream_idx].clear();
+
+		const u64 required_used = (u64) stream.used + in_extra[stream_idx];
+		if (required_used <= stream.capacity)
+		{
+			continue;
+		}
+
+		const u64 required_live = (u64) stream.live + in_extra[stream_idx];
+		u64 new_capacity = stream.capacity;
+		if (required_live > new_capacity)
+		{
+			new_capacity = MAX((u64) MESH_POOL_MIN_CAPACITY, (u64) stream.capacity + stream.capacity / 2);
+			new_capacity = MAX(new_capacity, required_live);
+		}
+		assert(new_capacity <= UINT32_MAX);
+		out_relocation.relocated[stream_idx] = true;
+		out_relocation.new_capacity[stream_idx] = (u32) new_capacity;
+		stream.capacity = (u32) new_capacity;
+		in_pool.counters.relocations += 1;
+		any_relocated = true;
+	}
+	if (!any_relocated)
+	{
+		return false;
+	}
+
+	u32 cursors[MESH_POOL_STREAM_COUNT] = {};
+	const auto pack = [&](u32 in_stream_idx, u32& in_out_first, u32 in_count)
+	{
+		if (!out_relocation.relocated[in_stream_idx] || in_count == 0)
+		{
+			return;
+		}
+		DynamicArray<MeshPoolMove>& moves = out_relocation.moves[in_stream_idx];
+		const u32 dst_first = cursors[in_stream_idx];
+		if (!moves.empty()
+			&& moves.last().src_first + moves.last().count == in_out_first
+			&& moves.last().dst_first + moves.last().count == dst_first)
+		{
+			moves.last().count += in_count;
+		}
+		else
+		{
+			moves.add({ .src_first = in_out_first, .dst_first = dst_first, .count = in_count });
+		}
+		in_out_first = dst_first;
+		cursors[in_stream_idx] += in_count;
+		in_pool.counters.elements_moved += in_count;
+	};
+	for (MeshPoolEntry& entry : in_pool.entries)
+	{
+		pack((u32) mesh_pool_batch_vertex_stream(entry.batch), entry.vertex_first, entry.vertex_count);
+		pack((u32) mesh_pool_batch_index_stream(entry.batch), entry.index_first, entry.index_count);
+	}
+	for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+	{
+		if (out_relocation.relocated[stream_idx])
+		{
+			assert(cursors[stream_idx] == in_pool.streams[stream_idx].live);
+			in_pool.streams[stream_idx].used = cursors[stream_idx];
+		}
+	}
+	return true;
+}
+
+// Appends an entry after its streams' last one. mesh_pool_reserve must have
+// made room for it this frame; the caller uploads the mesh's vertices and
+// indices to the returned entry's ranges.
+inline u32 mesh_pool_add(MeshPool& in_pool, u64 in_stream_id, MeshPoolBatch in_batch, u32 in_vertex_count, u32 in_index_count, u64 in_frame)
+{
+	assert(in_stream_id != 0 && !in_pool.entry_of_stream.contains(in_stream_id));
+	MeshPoolStreamState& vertex_stream = mesh_pool_stream(in_pool, mesh_pool_batch_vertex_stream(in_batch));
+	MeshPoolStreamState& index_stream = mesh_pool_stream(in_pool, mesh_pool_batch_index_stream(in_batch));
+	assert((u64) vertex_stream.used + in_vertex_count <= vertex_stream.capacity);
+	assert((u64) index_stream.used + in_index_count <= index_stream.capacity);
+
+	const u32 entry_idx = (u32) in_pool.entries.length();
+	in_pool.entries.add({
+		.stream_id = in_stream_id,
+		.last_used_frame = in_frame,
+		.batch = in_batch,
+		.vertex_first = vertex_stream.used,
+		.vertex_count = in_vertex_count,
+		.index_first = index_stream.used,
+		.index_count = in_index_count,
+	});
+	in_pool.entry_of_stream[in_stream_id] = entry_idx;
+	vertex_stream.used += in_vertex_count;
+	vertex_stream.live += in_vertex_count;
+	index_stream.used += in_index_count;
+	index_stream.live += in_index_count;
+	in_pool.counters.entries_added += 1;
+	return entry_idx;
+}
+
+// Range of a view's command array drawn with one batch's pipeline and buffers
+struct MeshPoolBatchRange
+{
+	u32 first = 0;
+	u32 count = 0;
+};
+
+// Scratch for mesh_pool_build_commands, kept by the caller across calls so
+// building a view's commands does not allocate
+struct MeshPoolCommandScratch
+{
+	DynamicArray<i32> group_of_entry;	// pool entry -> group, -1
+	DynamicArray<u32> group_entries;
+	DynamicArray<u32> group_sizes;
+	DynamicArray<u32> group_slots;
+	DynamicArray<u32> group_instance_cursors;
+	DynamicArray<u32> input_groups;
+};
+
+// Builds the indexed draws for the drawn records. in_entries[i] is record i's
+// pool entry and in_records lists the records to draw. With in_instance,
+// records sharing an entry (linked duplicates share streams, so they share
+// the entry) become one command whose instanceCount is the group size;
+// otherwise every record gets its own command. Commands are grouped by batch
+// and otherwise in first-seen order, and instances keep input order.
+//
+// out_instances lists the record of every instance: command c draws
+// out_instances[c.firstInstance - in_instance_base ...] so the indirect
+// vertex shaders find their record through gl_InstanceIndex.
+// out_slots (optional) receives each input's command position.
+inline void mesh_pool_build_commands(
+	const MeshPool& in_pool,
+	const u32* in_entries,
+	const u32* in_records,
+	u32 in_record_count,
+	bool in_instance,
+	u32 in_instance_base,
+	MeshPoolCommandScratch& in_out_scratch,
+	DynamicArray<DrawIndexedCommand>& out_commands,
+	DynamicArray<u32>& out_instances,
+	MeshPoolBatchRange out_ranges[MESH_POOL_BATCH_COUNT],
+	u32* out_slots = nullptr)
+{
+	MeshPoolCommandScratch& scratch = in_out_scratch;
+	if (scratch.group_of_entry.length() < in_pool.entries.length())
+	{
+		const u32 old_length = (u32) scratch.group_of_entry.length();
+		scratch.group_of_entry.resize(in_pool.entries.length());
+		for (u32 entry_idx = old_length; entry_idx < scratch.group_of_entry.length(); ++entry_idx)
+		{
+			scratch.group_of_entry[entry_idx] = -1;
+		}
+	}
+	scratch.group_entries.clear();
+	scratch.group_sizes.clear();
+	scratch.input_groups.resize(in_record_count);
+	for (u32 input_idx = 0; input_idx < in_record_count; ++input_idx)
+	{
+		const u32 entry_idx = in_entries[in_records[input_idx]];
+		i32 group = in_instance ? scratch.group_of_entry[entry_idx] : -1;
+		if (group < 0)
+		{
+			group = (i32) scratch.group_entries.length();
+			scratch.group_entries.add(entry_idx);
+			scratch.group_sizes.add(0);
+			if (in_instance)
+			{
+				scratch.group_of_entry[entry_idx] = group;
+			}
+		}
+		scratch.group_sizes[group] += 1;
+		scratch.input_groups[input_idx] = (u32) group;
+	}
+	const u32 group_count = (u32) scratch.group_entries.length();
+
+	for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+	{
+		out_ranges[batch_idx] = {};
+	}
+	for (u32 entry_idx : scratch.group_entries)
+	{
+		out_ranges[(u32) in_pool.entries[entry_idx].batch].count += 1;
+	}
+	u32 cursors[MESH_POOL_BATCH_COUNT];
+	u32 first = 0;
+	for (u32 batch_idx = 0; batch_idx < MESH_POOL_BATCH_COUNT; ++batch_idx)
+	{
+		out_ranges[batch_idx].first = first;
+		cursors[batch_idx] = first;
+		first += out_ranges[batch_idx].count;
+	}
+
+	// Instances are laid out in command order
+	scratch.group_slots.resize(group_count);
+	out_commands.resize(group_count);
+	for (u32 group = 0; group < group_count; ++group)
+	{
+		const MeshPoolEntry& entry = in_pool.entries[scratch.group_entries[group]];
+		const u32 slot = cursors[(u32) entry.batch]++;
+		scratch.group_slots[group] = slot;
+		out_commands[slot] = {
+			.index_count = entry.index_count,
+			.instance_count = scratch.group_sizes[group],
+			.first_index = entry.index_first,
+			.vertex_offset = (i32) entry.vertex_first,
+		};
+		if (in_instance)
+		{
+			scratch.group_of_entry[scratch.group_entries[group]] = -1;
+		}
+	}
+	u32 instance_first = 0;
+	for (DrawIndexedCommand& command : out_commands)
+	{
+		command.first_instance = in_instance_base + instance_first;
+		instance_first += command.instance_count;
+	}
+	scratch.group_instance_cursors.resize(group_count);
+	for (u32 group = 0; group < group_count; ++group)
+	{
+		scratch.group_instance_cursors[group] = out_commands[scratch.group_slots[group]].first_instance - in_instance_base;
+	}
+
+	out_instances.resize(in_record_count);
+	for (u32 input_idx = 0; input_idx < in_record_count; ++input_idx)
+	{
+		const u32 group = scratch.input_groups[input_idx];
+		out_instances[scratch.group_instance_cursors[group]++] = in_records[input_idx];
+		if (out_slots)
+		{
+			out_slots[input_idx] = scratch.group_slots[group];
+		}
+	}
+}
@@ -0,0 +1,466 @@
+#pragma once
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "core/worker_pool.h"
+#include "render/vulkan_context.h"
+#include "render/shader_module.h"
+
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <utility>
+
+// Owning copy of a graphics or compute pipeline create info. Pass init code
+// fills its create infos from stack locals; the job copies every block they
+// point at so the pipeline can be created after init returns, on a worker
+// thread or on first use. Pointer fields in `graphics` are only non-null
+// markers until pipeline_build_job_link re-points them at the job's storage,
+// which must happen once the job has stopped moving.
+struct PipelineBuildJob
+{
+	static constexpr u32 MAX_STAGES = 4;
+
+	VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	VkGraphicsPipelineCreateInfo graphics = {};
+	VkComputePipelineCreateInfo compute = {};
+	VkPipelineShaderStageCreateInfo stages[MAX_STAGES] = {};
+	VkPipelineVertexInputStateCreateInfo vertex_input = {};
+	DynamicArray<VkVertexInputBindingDescription> vertex_bindings;
+	DynamicArray<VkVertexInputAttributeDescription> vertex_attributes;
+	VkPipelineInputAssemblyStateCreateInfo input_assembly = {};
+	VkPipelineViewportStateCreateInfo viewport = {};
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	VkPipelineDepthStencilStateCreateInfo depth_stencil = {};
+	VkPipelineColorBlendStateCreateInfo color_blend = {};
+	DynamicArray<VkPipelineColorBlendAttachmentState> blend_attachments;
+	VkPipelineDynamicStateCreateInfo dynamic_state = {};
+	DynamicArray<VkDynamicState> dynamic_states;
+	VkPipelineRenderingCreateInfo rendering = {};
+	DynamicArray<VkFormat> color_formats;
+	bool has_rendering = false;
+
+	VkPipeline* out_pipeline = nullptr;
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkResult result = VK_NOT_READY;
+	f64 build_ms = 0.0;
+};
+
+template<typename T>
+static void pipeline_build_copy_array(DynamicArray<T>& out_array, const T* in_items, u32 in_count)
+{
+	assert(in_items || in_count == 0);
+	out_array.resize(in_count);
+	for (u32 index = 0; index < in_count; ++index)
+	{
+		out_array[index] = in_items[index];
+	}
+}
+
+PipelineBuildJob pipeline_build_job_graphics(const VkGraphicsPipelineCreateInfo& in_info)
+{
+	assert(in_info.stageCount <= PipelineBuildJob::MAX_STAGES);
+	PipelineBuildJob job;
+	job.bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	job.graphics = in_info;
+	job.graphics.pNext = nullptr;
+	for (u32 stage_index = 0; stage_index < in_info.stageCount; ++stage_index)
+	{
+		// Entry point names are string literals; specialization is unused
+		assert(in_info.pStages[stage_index].pSpecializationInfo == nullptr);
+		job.stages[stage_index] = in_info.pStages[stage_index];
+	}
+	for (const VkBaseInStructure* next = (const VkBaseInStructure*) in_info.pNext; next; next = next->pNext)
+	{
+		assert(next->sType == VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO);
+		const VkPipelineRenderingCreateInfo& rendering = *(const VkPipelineRenderingCreateInfo*) next;
+		job.rendering = rendering;
+		job.rendering.pNext = nullptr;
+		pipeline_build_copy_array(job.color_formats, rendering.pColorAttachmentFormats, rendering.colorAttachmentCount);
+		job.has_rendering = true;
+	}
+	if (in_info.pVertexInputState)
+	{
+		const VkPipelineVertexInputStateCreateInfo& vertex_input = *in_info.pVertexInputState;
+		assert(vertex_input.pNext == nullptr);
+		job.vertex_input = vertex_input;
+		pipeline_build_copy_array(job.vertex_bindings,
+			vertex_input.pVertexBindingDescriptions, vertex_input.vertexBindingDescriptionCount);
+		pipeline_build_copy_array(job.vertex_attributes,
+			vertex_input.pVertexAttributeDescriptions, vertex_input.vertexAttributeDescriptionCount);
+	}
+	if (in_info.pInputAssemblyState) job.input_assembly = *in_info.pInputAssemblyState;
+	if (in_info.pViewportState)
+	{
+		// Every pass sets viewport and scissor dynamically
+		assert(!in_info.pViewportState->pViewports && !in_info.pViewportState->pScissors);
+		job.viewport = *in_info.pViewportState;
+	}
+	if (in_info.pRasterizationState)
+	{
+		assert(in_info.pRasterizationState->pNext == nullptr);
+		job.rasterization = *in_info.pRasterizationState;
+	}
+	if (in_info.pMultisampleState)
+	{
+		assert(in_info.pMultisampleState->pSampleMask == nullptr);
+		job.multisample = *in_info.pMultisampleState;
+	}
+	if (in_info.pDepthStencilState) job.depth_stencil = *in_info.pDepthStencilState;
+	if (in_info.pColorBlendState)
+	{
+		job.color_blend = *in_info.pColorBlendState;
+		pipeline_build_copy_array(job.blend_attachments,
+			in_info.pColorBlendState->pAttachments, in_info.pColorBlendState->attachmentCount);
+	}
+	if (in_info.pDynamicState)
+	{
+		job.dynamic_state = *in_info.pDynamicState;
+		pipeline_build_copy_array(job.dynamic_states,
+			in_info.pDynamicState->pDynamicStates, in_info.pDynamicState->dynamicStateCount);
+	}
+	assert(in_info.pTessellationState == nullptr);
+	return job;
+}
+
+PipelineBuildJob pipeline_build_job_compute(const VkComputePipelineCreateInfo& in_info)
+{
+	assert(in_info.pNext == nullptr);
+	assert(in_info.stage.pSpecializationInfo == nullptr);
+	PipelineBuildJob job;
+	job.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+	job.compute = in_info;
+	return job;
+}
+
+void pipeline_build_job_link(PipelineBuildJob& io_job)
+{
+	if (io_job.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
+	{
+		return;
+	}
+	VkGraphicsPipelineCreateInfo& info = io_job.graphics;
+	info.pNext = io_job.has_rendering ? &io_job.rendering : nullptr;
+	io_job.rendering.pColorAttachmentFormats = io_job.color_formats.empty() ? nullptr : io_job.color_formats.data();
+	info.pStages = io_job.stages;
+	if (info.pVertexInputState)
+	{
+		io_job.vertex_input.pVertexBindingDescriptions = io_job.vertex_bindings.empty() ? nullptr : io_job.vertex_bindings.data();
+		io_job.vertex_input.pVertexAttributeDescriptions = io_job.vertex_attributes.empty() ? nullptr : io_job.vertex_attributes.data();
+		info.pVertexInputState = &io_job.vertex_input;
+	}
+	if (info.pInputAssemblyState) info.pInputAssemblyState = &io_job.input_assembly;
+	if (info.pViewportState) info.pViewportState = &io_job.viewport;
+	if (info.pRasterizationState) info.pRasterizationState = &io_job.rasterization;
+	if (info.pMultisampleState) info.pMultisampleState = &io_job.multisample;
+	if (info.pDepthStencilState) info.pDepthStencilState = &io_job.depth_stencil;
+	if (info.pColorBlendState)
+	{
+		io_job.color_blend.pAttachments = io_job.blend_attachments.empty() ? nullptr : io_job.blend_attachments.data();
+		info.pColorBlendState = &io_job.color_blend;
+	}
+	if (info.pDynamicState)
+	{
+		io_job.dynamic_state.pDynamicStates = io_job.dynamic_states.empty() ? nullptr : io_job.dynamic_states.data();
+		info.pDynamicState = &io_job.dynamic_state;
+	}
+}
+
+// Thread-safe: the cache is created without EXTERNALLY_SYNCHRONIZED, so
+// drivers lock it internally, and nothing here touches the context metrics
+void pipeline_build_job_run(VkDevice in_device, VkPipelineCache in_cache, PipelineBuildJob& io_job)
+{
+	const auto start = std::chrono::steady_clock::now();
+	io_job.result = io_job.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE
+		? vkCreateComputePipelines(in_device, in_cache, 1, &io_job.compute, nullptr, &io_job.pipeline)
+		: vkCreateGraphicsPipelines(in_device, in_cache, 1, &io_job.graphics, nullptr, &io_job.pipeline);
+	const auto end = std::chrono::steady_clock::now();
+	io_job.build_ms = std::chrono::duration<f64, std::milli>(end - start).count();
+}
+
+// Pipeline created on first use, for effects most sessions never enable
+// (debug views). The pass keeps the create info in the build service and
+// calls PipelineBuildService::resolve when it records the draw.
+struct DeferredPipeline
+{
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	i32 job_index = -1;
+};
+
+struct PipelineBuildStats
+{
+	u32 shader_module_loads = 0;
+	u32 shader_module_hits = 0;	// requests served by an already loaded module
+	f64 shader_load_ms = 0.0;
+	u32 batched_pipelines = 0;
+	f64 batch_wall_ms = 0.0;	// main-thread time spent waiting on batches
+	f64 batch_job_ms = 0.0;		// sum of per-pipeline creation times
+	u32 immediate_pipelines = 0;
+	u32 deferred_pipelines = 0;
+	u32 deferred_resolved = 0;
+	i32 worker_count = 0;
+};
+
+// Startup pipeline creation. While a batch is open (RenderSystem::initialize)
+// pipeline requests are queued and flushed in parallel on a WorkerPool that
+// shares ctx->pipeline_cache; outside a batch they build immediately, as
+// before. Shader modules are loaded once per path and owned here, so callers
+// no longer destroy them after creating their pipelines.
+namespace PipelineBuildService
+{
+	struct ShaderModuleEntry
+	{
+		std::string path;
+		VkShaderModule module = VK_NULL_HANDLE;
+	};
+
+	inline DynamicArray<ShaderModuleEntry> shader_modules;
+	inline DynamicArray<PipelineBuildJob> pending_jobs;
+	inline DynamicArray<PipelineBuildJob> deferred_jobs;
+	inline DynamicArray<PipelineBuildJob> recorded_jobs;	// batched jobs kept for benchmark_rebuild
+	inline bool batching = false;
+	inline bool record_jobs = false;
+	inline WorkerPool workers;
+	inline PipelineBuildStats stats;
+
+	inline VkShaderModule shader_module(VulkanContext* ctx, const char* in_path)
+	{
+		for (const ShaderModuleEntry& entry : shader_modules)
+		{
+			if (entry.path == in_path)
+			{
+				++stats.shader_module_hits;
+				return entry.module;
+			}
+		}
+		const auto start = std::chrono::steady_clock::now();
+		const VkShaderModule module = create_shader_module_from_file(ctx->device, in_path);
+		const auto end = std::chrono::steady_clock::now();
+		stats.shader_load_ms += std::chrono::duration<f64, std::milli>(end - start).count();
+		++stats.shader_module_loads;
+		shader_modules.add({ .path = in_path, .module = module });
+		return module;
+	}
+
+	inline void build_now(VulkanContext* ctx, PipelineBuildJob& io_job)
+	{
+		pipeline_build_job_link(io_job);
+		VK_CHECK(io_job.bind_point == VK_PIPELINE_BIND_POINT_COMPUTE
+			? vulkan_create_compute_pipelines(ctx, 1, &io_job.compute, &io_job.pipeline)
+			: vulkan_create_graphics_pipelines(ctx, 1, &io_job.graphics, &io_job.pipeline));
+	}
+
+	inline void submit(VulkanContext* ctx, PipelineBuildJob&& in_job, VkPipeline* out_pipeline)
+	{
+		assert(out_pipeline);
+		in_job.out_pipeline = out_pipeline;
+		if (!batching)
+		{
+			build_now(ctx, in_job);
+			*out_pipeline = in_job.pipeline;
+			++stats.immediate_pipelines;
+			return;
+		}
+		if (record_jobs)
+		{
+			recorded_jobs.add(in_job);
+		}
+		pending_jobs.add(std::move(in_job));
+	}
+
+	inline void graphics(VulkanContext* ctx, const VkGraphicsPipelineCreateInfo& in_info, VkPipeline* out_pipeline)
+	{
+		submit(ctx, pipeline_build_job_graphics(in_info), out_pipeline);
+	}
+
+	inline void compute(VulkanContext* ctx, const VkComputePipelineCreateInfo& in_info, VkPipeline* out_pipeline)
+	{
+		submit(ctx, pipeline_build_job_compute(in_info), out_pipeline);
+	}
+
+	inline void defer(PipelineBuildJob&& in_job, DeferredPipeline* out_deferred)
+	{
+		assert(out_deferred && out_deferred->job_index < 0);
+		out_deferred->pipeline = VK_NULL_HANDLE;
+		out_deferred->job_index = (i32) deferred_jobs.length();
+		deferred_jobs.add(std::move(in_job));
+		++stats.deferred_pipelines;
+	}
+
+	inline void defer_graphics(const VkGraphicsPipelineCreateInfo& in_info, DeferredPipeline* out_deferred)
+	{
+		defer(pipeline_build_job_graphics(in_info), out_deferred);
+	}
+
+	inline VkPipeline resolve(VulkanContext* ctx, DeferredPipeline& io_deferred)
+	{
+		if (io_deferred.pipeline == VK_NULL_HANDLE && io_deferred.job_index >= 0)
+		{
+			PipelineBuildJob& job = deferred_jobs[(u32) io_deferred.job_index];
+			build_now(ctx, job);
+			io_deferred.pipeline = job.pipeline;
+			++stats.deferred_resolved;
+		}
+		return io_deferred.pipeline;
+	}
+
+	inline void destroy(VulkanContext* ctx, DeferredPipeline& io_deferred)
+	{
+		vkDestroyPipeline(ctx->device, io_deferred.pipeline, nullptr);
+		io_deferred = {};
+	}
+
+	inline void begin_batch(VulkanContext* ctx)
+	{
+		assert(!batching);
+		(void) ctx;
+		batching = true;
+		if (!workers.is_started())
+		{
+			workers.start_shared();
+		}
+		stats.worker_count = workers.worker_count() + 1;
+	}
+
+	// Builds everything queued so far. Call before recording commands that
+	// bind a pipeline requested in the open batch.
+	inline void flush(VulkanContext* ctx)
+	{
+		if (pending_jobs.empty())
+		{
+			return;
+		}
+		for (PipelineBuildJob& job : pending_jobs)
+		{
+			pipeline_build_job_link(job);
+		}
+		const VkDevice device = ctx->device;
+		const VkPipelineCache cache = ctx->pipeline_cache;
+		const auto start = std::chrono::steady_clock::now();
+		workers.parallel_for((u32) pending_jobs.length(), [&](u32 in_index)
+		{
+			pipeline_build_job_run(device, cache, pending_jobs[in_index]);
+		});
+		const auto end = std::chrono::steady_clock::now();
+		const f64 wall_ms = std::chrono::duration<f64, std::milli>(end - start).count();
+
+		for (PipelineBuildJob& job : pending_jobs)
+		{
+			VK_CHECK(job.result);
+			vulkan_record_created_pipelines(ctx, job.bind_point, 1, &job.pipeline, 0.0);
+			*job.out_pipeline = job.pipeline;
+			stats.batch_job_ms += job.build_ms;
+		}
+		ctx->metrics.pipeline_creation_ms += wall_ms;
+		stats.batched_pipelines += (u32) pending_jobs.length();
+		stats.batch_wall_ms += wall_ms;
+		pending_jobs.clear();
+	}
+
+	// Destroys the modules no unresolved deferred job still points at; a
+	// later request for the same path simply loads it again
+	inline void release_unused_shader_modules(VulkanContext* ctx)
+	{
+		u32 kept = 0;
+		for (u32 entry_index = 0; entry_index < (u32) shader_modules.length(); ++entry_index)
+		{
+			ShaderModuleEntry& entry = shader_modules[entry_index];
+			bool needed = false;
+			for (const PipelineBuildJob& job : deferred_jobs)
+			{
+				for (u32 stage_index = 0; job.pipeline == VK_NULL_HANDLE && stage_index < job.graphics.stageCount; ++stage_index)
+				{
+					needed = needed || job.stages[stage_index].module == entry.module;
+				}
+			}
+			if (needed)
+			{
+				shader_modules[kept++] = entry;
+			}
+			else
+			{
+				vkDestroyShaderModule(ctx->device, entry.module, nullptr);
+			}
+		}
+		shader_modules.resize(kept);
+	}
+
+	// Benchmark runs keep the workers and modules for benchmark_rebuild
+	inline void end_batch(VulkanContext* ctx)
+	{
+		assert(batching);
+		flush(ctx);
+		batching = false;
+		if (!record_jobs)
+		{
+			workers.stop();
+			release_unused_shader_modules(ctx);
+		}
+		printf("Pipeline build: %u pipelines in %.2f ms on %d threads (%.2f ms serial), %u shader modules (%u reused)\n",
+			stats.batched_pipelines, stats.batch_wall_ms, stats.worker_count, stats.batch_job_ms,
+			stats.shader_module_loads, stats.shader_module_hits);
+	}
+
+	// --benchmark-startup: recreates every batched pipeline against in_cache
+	// and returns the wall time, discarding the results
+	inline f64 benchmark_rebuild(VulkanContext* ctx, VkPipelineCache in_cache, f64* out_job_ms)
+	{
+		for (PipelineBuildJob& job : recorded_jobs)
+		{
+			pipeline_build_job_link(job);
+			job.pipeline = VK_NULL_HANDLE;
+		}
+		const VkDevice device = ctx->device;
+		const auto start = std::chrono::steady_clock::now();
+		workers.parallel_for((u32) recorded_jobs.length(), [&](u32 in_index)
+		{
+			pipeline_build_job_run(device, in_cache, recorded_jobs[in_index]);
+		});
+		const auto end = std::chrono::steady_clock::now();
+		*out_job_ms = 0.0;
+		for (PipelineBuildJob& job : recorded_jobs)
+		{
+			VK_CHECK(job.result);
+			vkDestroyPipeline(device, job.pipeline, nullptr);
+			job.pipeline = VK_NULL_HANDLE;
+			*out_job_ms += job.build_ms;
+		}
+		return std::chrono::duration<f64, std::milli>(end - start).count();
+	}
+
+	// Rebuilds against a copy of what the cold startup left in
+	// ctx->pipeline_cache, i.e. what the next launch loads from disk
+	inline f64 benchmark_warm_rebuild(VulkanContext* ctx, f64* out_job_ms)
+	{
+		size_t data_size = 0;
+		VK_CHECK(vkGetPipelineCacheData(ctx->device, ctx->pipeline_cache, &data_size, nullptr));
+		DynamicArray<u8> data;
+		data.resize(data_size);
+		VK_CHECK(vkGetPipelineCacheData(ctx->device, ctx->pipeline_cache, &data_size, data.data()));
+		VkPipelineCacheCreateInfo create_info = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = data_size,
+			.pInitialData = data_size > 0 ? data.data() : nullptr,
+		};
+		VkPipelineCache warm_cache = VK_NULL_HANDLE;
+		VK_CHECK(vkCreatePipelineCache(ctx->device, &create_info, nullptr, &warm_cache));
+		const f64 wall_ms = benchmark_rebuild(ctx, warm_cache, out_job_ms);
+		vkDestroyPipelineCache(ctx->device, warm_cache, nullptr);
+		return wall_ms;
+	}
+
+	inline void shutdown(VulkanContext* ctx)
+	{
+		assert(!batching && pending_jobs.empty());
+		workers.stop();
+		for (const ShaderModuleEntry& entry : shader_modules)
+		{
+			vkDestroyShaderModule(ctx->device, entry.module, nullptr);
+		}
+		shader_modules.reset();
+		deferred_jobs.reset();
+		recorded_jobs.reset();
+		stats = {};
+	}
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+
+// ---- Render graph lifetimes and transient aliasing ----
+// The frame declares its schedule up front as an ordered list of nodes, each
+// with the resources it may read and write. A resource lives from the first
+// node that touches it to the last one. Nodes a frame skips (a disabled
+// effect) only shorten the real lifetimes, so a plan built from the full
+// declaration holds for every combination of enabled passes.
+//
+// Transient resources keep nothing between frames. Two of them may share
+// memory when their lifetimes are disjoint; the planner packs them into as
+// few heaps as their memory types allow, largest first, each at the lowest
+// offset that does not collide with a resource live at the same time.
+// Nothing here touches Vulkan: RenderTargetRegistry turns the plan into VMA
+// heaps and aliasing images.
+
+static constexpr i32 RENDER_GRAPH_MAX_RESOURCES = 64;
+
+using RenderGraphResourceMask = u64;
+
+constexpr RenderGraphResourceMask render_graph_bit(i32 in_resource)
+{
+	return 1ull << in_resource;
+}
+
+struct RenderGraphNodeDecl
+{
+	const char* label = nullptr;
+	RenderGraphResourceMask reads = 0;
+	RenderGraphResourceMask writes = 0;
+};
+
+struct RenderGraphLifetime
+{
+	i32 first_node = -1;	// -1: no node touches the resource
+	i32 last_node = -1;
+	bool read_before_write = false;	// first touched by a read: the contents must survive the frame
+
+	bool used() const { return first_node >= 0; }
+
+	bool overlaps(const RenderGraphLifetime& in_other) const
+	{
+		return used() && in_other.used()
+			&& first_node <= in_other.last_node && in_other.first_node <= last_node;
+	}
+};
+
+// size == 0 marks a resource that does not take part (persistent, or absent)
+struct RenderGraphMemoryRequest
+{
+	u64 size = 0;
+	u64 alignment = 1;
+	u32 memory_type_bits = ~0u;
+};
+
+struct RenderGraphPlacement
+{
+	i32 heap = -1;	// -1: not aliased, the resource allocates on its own
+	u64 offset = 0;
+};
+
+struct RenderGraphHeap
+{
+	u64 size = 0;
+	u64 alignment = 1;
+	u32 memory_type_bits = ~0u;
+};
+
+struct RenderGraphAliasPlan
+{
+	RenderGraphPlacement placements[RENDER_GRAPH_MAX_RESOURCES];
+	// Other placed resources whose memory range overlaps this one's. Each of
+	// them may have touched the memory last, in this frame or the previous one.
+	RenderGraphResourceMask aliases[RENDER_GRAPH_MAX_RESOURCES] = {};
+	DynamicArray<RenderGraphHeap> heaps;
+	u64 requested_bytes = 0;	// placed resources, one allocation each
+	u64 heap_bytes = 0;
+
+	u64 saved_bytes() const
+	{
+		return requested_bytes > heap_bytes ? requested_bytes - heap_bytes : 0;
+	}
+};
+
+inline u64 render_graph_align(u64 in_value, u64 in_alignment)
+{
+	assert(in_alignment > 0);
+	return (in_value + in_alignment - 1) / in_alignment * in_alignment;
+}
+
+void render_graph_compute_lifetimes(
+	const RenderGraphNodeDecl* in_nodes,
+	i32 in_node_count,
+	RenderGraphLifetime* out_lifetimes,
+	i32 in_resource_count)
+{
+	assert(in_resource_count <= RENDER_GRAPH_MAX_RESOURCES);
+	for (i32 resource = 0; resource < in_resource_count; ++resource)
+	{
+		out_lifetimes[resource] = {};
+	}
+	for (i32 node_index = 0; node_index < in_node_count; ++node_index)
+	{
+		const RenderGraphNodeDecl& node = in_nodes[node_index];
+		for (i32 resource = 0; resource < in_resource_count; ++resource)
+		{
+			const RenderGraphResourceMask bit = render_graph_bit(resource);
+			if (((node.reads | node.writes) & bit) == 0)
+			{
+				continue;
+			}
+			RenderGraphLifetime& lifetime = out_lifetimes[resource];
+			if (!lifetime.used())
+			{
+				lifetime.first_node = node_index;
+				// A node that reads and writes the same resource blends onto it
+				lifetime.read_before_write = (node.reads & bit) != 0;
+			}
+			lifetime.last_node = node_index;
+		}
+	}
+}
+
+void render_graph_plan_aliasing(
+	const RenderGraphMemoryRequest* in_requests,
+	const RenderGraphLifetime* in_lifetimes,
+	i32 in_resource_count,
+	RenderGraphAliasPlan& out_plan)
+{
+	assert(in_resource_count <= RENDER_GRAPH_MAX_RESOURCES);
+	out_plan = {};
+
+	i32 order[RENDER_GRAPH_MAX_RESOURCES];
+	i32 candidate_count = 0;
+	for (i32 resource = 0; resource < in_resource_count; ++resource)
+	{
+		const RenderGraphLifetime& lifetime = in_lifetimes[resource];
+		if (in_requests[resource].size > 0 && lifetime.used() && !lifetime.read_before_write)
+		{
+			order[candidate_count++] = resource;
+		}
+	}
+	// Largest first; ties keep declaration order so the plan is stable
+	std::stable_sort(order, order + candidate_count, [&](i32 in_a, i32 in_b)
+	{
+		return in_requests[in_a].size > in_requests[in_b].size;
+	});
+
+	i32 placed[RENDER_GRAPH_MAX_RESOURCES];
+	i32 placed_count = 0;
+	for (i32 order_index = 0; order_index < candidate_count; ++order_index)
+	{
+		const i32 resource = order[order_index];
+		const RenderGraphMemoryRequest& request = in_requests[resource];
+		assert(request.alignment > 0 && request.memory_type_bits != 0);
+
+		i32 heap_index = -1;
+		for (i32 candidate = 0; candidate < (i32) out_plan.heaps.length(); ++candidate)
+		{
+			if ((out_plan.heaps[candidate].memory_type_bits & request.memory_type_bits) != 0)
+			{
+				heap_index = candidate;
+				break;
+			}
+		}
+		if (heap_index < 0)
+		{
+			heap_index = (i32) out_plan.heaps.length();
+			out_plan.heaps.add({ .memory_type_bits = request.memory_type_bits });
+		}
+
+		// Lowest aligned offset clear of everything in the heap that is live
+		// at the same time. Candidates are 0 and the end of each such range.
+		u64 best_offset = ~0ull;
+		for (i32 candidate_index = -1; candidate_index < placed_count; ++candidate_index)
+		{
+			u64 offset = 0;
+			if (candidate_index >= 0)
+			{
+				const i32 other = placed[candidate_index];
+				if (out_plan.placements[other].heap != heap_index
+					|| !in_lifetimes[other].overlaps(in_lifetimes[resource]))
+				{
+					continue;
+				}
+				offset = render_graph_align(
+					out_plan.placements[other].offset + in_requests[other].size, request.alignment);
+			}
+			if (offset >= best_offset)
+			{
+				continue;
+			}
+			bool collides = false;
+			for (i32 placed_index = 0; placed_index < placed_count && !collides; ++placed_index)
+			{
+				const i32 other = placed[placed_index];
+				const RenderGraphPlacement& other_placement = out_plan.placements[other];
+				collides = other_placement.heap == heap_index
+					&& in_lifetimes[other].overlaps(in_lifetimes[resource])
+					&& offset < other_placement.offset + in_requests[other].size
+					&& other_placement.offset < offset + request.size;
+			}
+			if (!collides)
+			{
+				best_offset = offset;
+			}
+		}
+		assert(best_offset != ~0ull);
+
+		RenderGraphHeap& heap = out_plan.heaps[heap_index];
+		heap.size = std::max(heap.size, best_offset + request.size);
+		heap.alignment = std::max(heap.alignment, request.alignment);
+		heap.memory_type_bits &= request.memory_type_bits;
+		out_plan.placements[resource] = { .heap = heap_index, .offset = best_offset };
+		out_plan.requested_bytes += request.size;
+		placed[placed_count++] = resource;
+	}
+
+	for (i32 a = 0; a < placed_count; ++a)
+	{
+		for (i32 b = a + 1; b < placed_count; ++b)
+		{
+			const i32 first = placed[a];
+			const i32 second = placed[b];
+			const RenderGraphPlacement& first_placement = out_plan.placements[first];
+			const RenderGraphPlacement& second_placement = out_plan.placements[second];
+			if (first_placement.heap == second_placement.heap
+				&& first_placement.offset < second_placement.offset + in_requests[second].size
+				&& second_placement.offset < first_placement.offset + in_requests[first].size)
+			{
+				assert(!in_lifetimes[first].overlaps(in_lifetimes[second]));
+				out_plan.aliases[first] |= render_graph_bit(second);
+				out_plan.aliases[second] |= render_graph_bit(first);
+			}
+		}
+	}
+	for (const RenderGraphHeap& heap : out_plan.heaps)
+	{
+		out_plan.heap_bytes += heap.size;
+	}
+}
@@ -2,10 +2,13 @@
 
 #include <cassert>
 #include <functional>
+#include <initializer_list>
 
 #include "core/types.h"
 #include "core/dynamic_array.h"
+#include "core/runtime_config.h"
 #include "core/timings.h"
+#include "render/render_graph_aliasing.h"
 #include "render/vulkan_context.h"
 
 // Render-pass framework built on Vulkan dynamic rendering.
@@ -17,6 +20,10 @@
 //
 // The top-level ordered frame graph declares cross-pass reads. Specialized
 // internal workflows can still issue explicit usages for subresources.
+//
+// Transient targets (render_target_transient) hold nothing between frames.
+// RenderTargetRegistry places them in shared heaps from the lifetimes of the
+// declared frame schedule (render/render_graph_aliasing.h).
 
 // Single/Swapchain (Phase 1), Array (Phase 3a shadows), Multi/Cubemap
 // (Phase 3c GI captures)
@@ -116,6 +123,7 @@ struct RenderPassDesc
 	RenderTargetExtent extent;
 	ERenderPassType type = ERenderPassType::Single;
 	const char* debug_label = nullptr;
+	bool transient = false;
 };
 
 inline RenderPassDesc render_target_color_desc(
@@ -163,6 +171,16 @@ inline RenderPassDesc render_target_mrt_desc(
 	return result;
 }
 
+// Contents are written before they are read every frame and are not needed
+// afterwards, so the target may share memory with other transient targets
+inline RenderPassDesc render_target_transient(RenderPassDesc in_desc)
+{
+	in_desc.transient = true;
+	return in_desc;
+}
+
+static u64 g_render_pass_write_sequence = 0;
+
 struct RenderPass
 {
 	RenderPassDesc desc = {};
@@ -177,6 +195,12 @@ struct RenderPass
 	i32 current_width = -1;
 	i32 current_height = -1;
 
+	// Transient targets: the others placed over the same memory, and when
+	// this one was last written (frame, then order among all pass writes)
+	DynamicArray<RenderPass*> memory_aliases;
+	u64 written_frame = ~0ull;
+	u64 written_sequence = 0;
+
 	void validate_desc()
 	{
 		const bool has_any_output = desc.num_outputs > 0 || desc.depth_output.format != VK_FORMAT_UNDEFINED;
@@ -184,6 +208,14 @@ struct RenderPass
 		assert(desc.num_outputs <= RENDER_PASS_MAX_COLOR_OUTPUTS);
 		assert(desc.type != ERenderPassType::Array || desc.pass_count >= 1);
 		assert(desc.type != ERenderPassType::Multi || desc.pass_count >= 1);
+		// One image set rendered once, and nothing loaded: every execute
+		// starts from undefined contents
+		assert(!desc.transient || desc.type == ERenderPassType::Single);
+		for (i32 output_idx = 0; output_idx < desc.num_outputs; ++output_idx)
+		{
+			assert(!desc.transient || desc.outputs[output_idx].load_op != VK_ATTACHMENT_LOAD_OP_LOAD);
+		}
+		assert(!desc.transient || !has_depth() || desc.depth_output.load_op != VK_ATTACHMENT_LOAD_OP_LOAD);
 	}
 
 	bool has_depth() const
@@ -226,56 +258,81 @@ struct RenderPass
 		depth_outputs.reset();
 	}
 
-	void allocate_outputs()
+	// Images per set: the color outputs, then depth
+	i32 get_images_per_set() const
 	{
-		if (desc.type == ERenderPassType::Swapchain)
-		{
-			return;
-		}
+		return desc.num_outputs + (has_depth() ? 1 : 0);
+	}
 
+	GpuImageDesc get_output_image_desc(i32 in_image_idx, i32 in_output_idx, char (&out_label)[192]) const
+	{
 		const bool is_cubemap = desc.type == ERenderPassType::Cubemap;
 		const u32 array_layers = desc.type == ERenderPassType::Array ? (u32) desc.pass_count
 								: is_cubemap ? (u32) NUM_CUBE_FACES
 								: 1u;
-		const i32 image_set_count = get_image_set_count();
+		if (in_output_idx < desc.num_outputs)
+		{
+			snprintf(out_label, sizeof(out_label), "%s Color %i Set %i",
+				desc.debug_label ? desc.debug_label : "RenderPass", in_output_idx, in_image_idx);
+			return {
+				.width = (u32) current_width,
+				.height = (u32) current_height,
+				.format = desc.outputs[in_output_idx].format,
+				.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+					   | VK_IMAGE_USAGE_SAMPLED_BIT
+					   | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+					   | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+				.aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+				.array_layers = array_layers,
+				.cubemap = is_cubemap,
+				.label = out_label,
+			};
+		}
 
-		for (i32 image_idx = 0; image_idx < image_set_count; ++image_idx)
+		assert(has_depth() && in_output_idx == desc.num_outputs);
+		snprintf(out_label, sizeof(out_label), "%s Depth Set %i",
+			desc.debug_label ? desc.debug_label : "RenderPass", in_image_idx);
+		return {
+			.width = (u32) current_width,
+			.height = (u32) current_height,
+			.format = desc.depth_output.format,
+			.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			.aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
+			.array_layers = array_layers,
+			.cubemap = is_cubemap,
+			.label = out_label,
+		};
+	}
+
+	// in_heap: place image i of each set at in_image_offsets[i] inside it
+	// (transient targets, one set) instead of giving each its own allocation
+	void allocate_outputs(VmaAllocation in_heap = VK_NULL_HANDLE, const VkDeviceSize* in_image_offsets = nullptr)
+	{
+		if (desc.type == ERenderPassType::Swapchain)
 		{
-			for (i32 output_idx = 0; output_idx < desc.num_outputs; ++output_idx)
-			{
-				char output_label[192];
-				snprintf(output_label, sizeof(output_label), "%s Color %i Set %i",
-					desc.debug_label ? desc.debug_label : "RenderPass", output_idx, image_idx);
-				color_outputs.add(gpu_image_create(g_vulkan_context->allocator, g_vulkan_context->device, (GpuImageDesc) {
-					.width = (u32) current_width,
-					.height = (u32) current_height,
-					.format = desc.outputs[output_idx].format,
-					.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
-						   | VK_IMAGE_USAGE_SAMPLED_BIT
-						   | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
-						   | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-					.aspect = VK_IMAGE_ASPECT_COLOR_BIT,
-					.array_layers = array_layers,
-					.cubemap = is_cubemap,
-					.label = output_label,
-				}));
-			}
+			return;
+		}
+		assert(in_heap == VK_NULL_HANDLE || get_image_set_count() == 1);
 
-			if (has_depth())
+		const i32 image_set_count = get_image_set_count();
+		for (i32 image_idx = 0; image_idx < image_set_count; ++image_idx)
+		{
+			for (i32 output_idx = 0; output_idx < get_images_per_set(); ++output_idx)
 			{
-				char depth_label[192];
-				snprintf(depth_label, sizeof(depth_label), "%s Depth Set %i",
-					desc.debug_label ? desc.debug_label : "RenderPass", image_idx);
-				depth_outputs.add(gpu_image_create(g_vulkan_context->allocator, g_vulkan_context->device, (GpuImageDesc) {
-					.width = (u32) current_width,
-					.height = (u32) current_height,
-					.format = desc.depth_output.format,
-					.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-					.aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
-					.array_layers = array_layers,
-					.cubemap = is_cubemap,
-					.label = depth_label,
-				}));
+				char label[192];
+				const GpuImageDesc image_desc = get_output_image_desc(image_idx, output_idx, label);
+				GpuImage image = in_heap != VK_NULL_HANDLE
+					? gpu_image_create_aliased(g_vulkan_context->allocator, g_vulkan_context->device,
+						image_desc, in_heap, in_image_offsets[output_idx])
+					: gpu_image_create(g_vulkan_context->allocator, g_vulkan_context->device, image_desc);
+				if (output_idx < desc.num_outputs)
+				{
+					color_outputs.add(std::move(image));
+				}
+				else
+				{
+					depth_outputs.add(std::move(image));
+				}
 			}
 		}
 	}
@@ -307,13 +364,15 @@ struct RenderPass
 
 	// Recreates targets at the new size. Old targets retire against the
 	// current frame fence, so render-scale changes do not idle the device.
-	void handle_resize(i32 in_width, i32 in_height)
+	// Transient targets only take the new size: RenderTargetRegistry
+	// allocates them together. Returns whether the size changed.
+	bool handle_resize(i32 in_width, i32 in_height)
 	{
 		if (desc.extent.type == ERenderTargetExtent::Fixed)
 		{
 			if (current_width > 0)
 			{
-				return;
+				return false;
 			}
 			in_width = desc.extent.width;
 			in_height = desc.extent.height;
@@ -323,27 +382,114 @@ struct RenderPass
 		const i32 new_height = MAX(1, (i32)(in_height * desc.extent.height_scale + 0.5f));
 		if (new_width == current_width && new_height == current_height)
 		{
-			return;
+			return false;
 		}
 
 		current_width = new_width;
 		current_height = new_height;
 
-		if (desc.type != ERenderPassType::Swapchain)
+		if (desc.type != ERenderPassType::Swapchain && !desc.transient)
 		{
 			release_targets();
 			allocate_outputs();
 		}
+		return true;
+	}
+
+	// Whether this frame's contents are still intact: written this frame, and
+	// no target sharing the memory written since
+	bool holds_frame_contents(u64 in_frame) const
+	{
+		if (!desc.transient)
+		{
+			return true;
+		}
+		if (written_frame != in_frame)
+		{
+			return false;
+		}
+		for (const RenderPass* alias : memory_aliases)
+		{
+			if (alias->written_frame == in_frame && alias->written_sequence > written_sequence)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Whoever used the shared memory last, earlier this frame or in the
+	// previous one, must be done before this target's first layout transition
+	// writes to it. The transition's source scope is only this image's, so the
+	// aliases' stages are folded into its tracked state, and a global barrier
+	// makes their writes available.
+	void acquire_aliased_memory(PassResourceUsage& io_usage)
+	{
+		if (memory_aliases.empty())
+		{
+			return;
+		}
+
+		VkPipelineStageFlags2 stages = 0;
+		VkAccessFlags2 access = 0;
+		for (const RenderPass* alias : memory_aliases)
+		{
+			for (const DynamicArray<GpuImage>* images : { &alias->color_outputs, &alias->depth_outputs })
+			{
+				for (const GpuImage& image : *images)
+				{
+					for (const GpuImage::ImageSubresourceState& state : image.subresource_states)
+					{
+						stages |= state.stage;
+						access |= state.access;
+					}
+				}
+			}
+		}
+		if (stages == 0)
+		{
+			return;
+		}
+
+		for (DynamicArray<GpuImage>* images : { &color_outputs, &depth_outputs })
+		{
+			for (GpuImage& image : *images)
+			{
+				for (GpuImage::ImageSubresourceState& state : image.subresource_states)
+				{
+					state.stage |= stages;
+					state.access |= access;
+				}
+			}
+		}
+		io_usage.memory.add({
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+			.srcStageMask = stages,
+			.srcAccessMask = access,
+			.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+						  | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT
+						  | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT
+						   | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+						   | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+						   | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		});
 	}
 
 	// Transitions outputs, begins dynamic rendering with the declared
 	// attachments, sets the Y-flipped viewport + scissor, runs the callback,
 	// ends rendering. The callback binds its own pipeline/sets and draws.
 	// Array passes loop once per slice (callback receives the slice index).
+	// Slices whose bit is clear in in_pass_mask are skipped and keep their
+	// contents. io_boundary_usage holds barriers the caller still owes at this
+	// pass boundary (the frame graph's reads); they go out in the same
+	// dependency as the first instance's attachments and are consumed.
 	void execute(
 		VulkanContext* ctx,
 		const std::function<void(i32)>& in_callback,
-		i32 in_pass_count = -1)
+		i32 in_pass_count = -1,
+		u32 in_pass_mask = ~0u,
+		PassResourceUsage* io_boundary_usage = nullptr)
 	{
 		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
 
@@ -362,11 +508,19 @@ struct RenderPass
 		const i32 natural_pass_count = get_natural_pass_count();
 		const i32 pass_count =
 			in_pass_count >= 0 ? MIN(in_pass_count, natural_pass_count) : natural_pass_count;
+		bool boundary_applied = io_boundary_usage == nullptr;
 		for (i32 pass_idx = 0; pass_idx < pass_count; ++pass_idx)
 		{
+			if (pass_idx < 32 && (in_pass_mask & (1u << pass_idx)) == 0)
+			{
+				continue;
+			}
+
 			// Declare the exact attachment slices used by this rendering
 			// instance and apply all required barriers in one dependency.
-			DynamicArray<ImageUsage> attachment_usages;
+			PassResourceUsage instance_usage;
+			PassResourceUsage& usage = boundary_applied ? instance_usage : *io_boundary_usage;
+			DynamicArray<ImageUsage>& attachment_usages = usage.images;
 			if (!is_swapchain)
 			{
 				for (i32 output_idx = 0; output_idx < desc.num_outputs; ++output_idx)
@@ -407,12 +561,14 @@ struct RenderPass
 						.discard = desc.depth_output.load_op != VK_ATTACHMENT_LOAD_OP_LOAD,
 					});
 				}
-				gpu_image_apply_usages(
-					command_buffer,
-					attachment_usages.data(),
-					(u32)attachment_usages.length()
-				);
+				if (desc.transient)
+				{
+					acquire_aliased_memory(usage);
+				}
 			}
+			vulkan_apply_pass_resource_usage(ctx, usage);
+			usage.clear();
+			boundary_applied = true;
 
 			VkRenderingAttachmentInfo color_attachments[RENDER_PASS_MAX_COLOR_OUTPUTS] = {};
 			u32 color_attachment_count = 0;
@@ -495,6 +651,13 @@ struct RenderPass
 			in_callback(pass_idx);
 
 			vkCmdEndRendering(command_buffer);
+			written_frame = ctx->frame_number;
+			written_sequence = ++g_render_pass_write_sequence;
+		}
+		if (!boundary_applied)
+		{
+			vulkan_apply_pass_resource_usage(ctx, *io_boundary_usage);
+			io_boundary_usage->clear();
 		}
 
 		gpu_timestamps_end_scope(ctx, gpu_timing_slot);
@@ -532,10 +695,29 @@ struct RenderPass
 	}
 };
 
+inline RenderGraphResourceMask render_target_bits(std::initializer_list<RenderTargetId> in_ids)
+{
+	RenderGraphResourceMask mask = 0;
+	for (RenderTargetId id : in_ids)
+	{
+		mask |= render_graph_bit((i32) id);
+	}
+	return mask;
+}
+
 struct RenderTargetRegistry
 {
+	static_assert((i32) RenderTargetId::COUNT <= RENDER_GRAPH_MAX_RESOURCES);
+
 	RenderPass targets[(i32) RenderTargetId::COUNT];
 
+	// Target lifetimes over the declared frame schedule, and where the
+	// transient targets live as a result
+	RenderGraphLifetime lifetimes[(i32) RenderTargetId::COUNT];
+	RenderGraphAliasPlan alias_plan;
+	DynamicArray<VmaAllocation> alias_heaps;
+	bool transient_dirty = false;
+
 	RenderPass& get(RenderTargetId in_id)
 	{
 		return targets[(i32) in_id];
@@ -544,6 +726,15 @@ struct RenderTargetRegistry
 	void init(RenderTargetId in_id, const RenderPassDesc& in_desc)
 	{
 		get(in_id).init(in_desc);
+		transient_dirty |= in_desc.transient;
+	}
+
+	// Nodes name the targets they read and write (render_target_bits). Until
+	// a schedule is declared, transient targets get their own allocations.
+	void declare_schedule(const RenderGraphNodeDecl* in_nodes, i32 in_node_count)
+	{
+		render_graph_compute_lifetimes(in_nodes, in_node_count, lifetimes, (i32) RenderTargetId::COUNT);
+		transient_dirty = true;
 	}
 
 	void handle_resize(
@@ -555,17 +746,136 @@ struct RenderTargetRegistry
 		for (RenderPass& target : targets)
 		{
 			const bool output = target.desc.extent.type == ERenderTargetExtent::Output;
-			target.handle_resize(
+			const bool resized = target.handle_resize(
 				output ? in_output_width : in_render_width,
 				output ? in_output_height : in_render_height);
+			transient_dirty |= resized && target.desc.transient;
+		}
+		if (transient_dirty)
+		{
+			place_transient_targets();
 		}
 	}
 
+	// Recreates every sized transient target. Those the plan places share
+	// heaps; the rest (read before written, or not in the schedule) get
+	// their own allocations, as do all of them with GAME2_TRANSIENT_ALIASING=0.
+	void place_transient_targets()
+	{
+		constexpr i32 target_count = (i32) RenderTargetId::COUNT;
+		VulkanContext* ctx = g_vulkan_context;
+		transient_dirty = false;
+
+		// One request per target: its images back to back
+		RenderGraphMemoryRequest requests[target_count] = {};
+		VkDeviceSize image_offsets[target_count][RENDER_PASS_MAX_COLOR_OUTPUTS + 1] = {};
+		for (i32 target_idx = 0; target_idx < target_count; ++target_idx)
+		{
+			RenderPass& target = targets[target_idx];
+			if (!target.desc.transient || target.current_width <= 0)
+			{
+				continue;
+			}
+			target.release_targets();
+			RenderGraphMemoryRequest& request = requests[target_idx];
+			for (i32 output_idx = 0; output_idx < target.get_images_per_set(); ++output_idx)
+			{
+				char label[192];
+				const VkMemoryRequirements requirements = gpu_image_memory_requirements(
+					ctx->device, target.get_output_image_desc(0, output_idx, label));
+				image_offsets[target_idx][output_idx] = render_graph_align(request.size, requirements.alignment);
+				request.size = image_offsets[target_idx][output_idx] + requirements.size;
+				request.alignment = MAX(request.alignment, (u64) requirements.alignment);
+				request.memory_type_bits &= requirements.memoryTypeBits;
+			}
+		}
+		if (RuntimeConfig::get().transient_aliasing.value_or(true))
+		{
+			render_graph_plan_aliasing(requests, lifetimes, target_count, alias_plan);
+		}
+		else
+		{
+			alias_plan = {};
+		}
+
+		// The old images were retired above, ahead of their heaps
+		for (VmaAllocation& heap : alias_heaps)
+		{
+			vulkan_context_retire_allocation(ctx, heap);
+		}
+		alias_heaps.clear();
+		for (const RenderGraphHeap& heap : alias_plan.heaps)
+		{
+			const VkMemoryRequirements requirements = {
+				.size = heap.size,
+				.alignment = heap.alignment,
+				.memoryTypeBits = heap.memory_type_bits,
+			};
+			const VmaAllocationCreateInfo allocation_create_info = {
+				.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT,
+				.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			};
+			VmaAllocation allocation = VK_NULL_HANDLE;
+			VK_CHECK(vmaAllocateMemory(ctx->allocator, &requirements, &allocation_create_info, &allocation, nullptr));
+			vmaSetAllocationName(ctx->allocator, allocation, "Transient Render Target Heap");
+			alias_heaps.add(allocation);
+		}
+
+		u64 target_bytes = 0;
+		i32 placed_count = 0;
+		for (i32 target_idx = 0; target_idx < target_count; ++target_idx)
+		{
+			RenderPass& target = targets[target_idx];
+			if (!target.desc.transient || target.current_width <= 0)
+			{
+				continue;
+			}
+			target.memory_aliases.clear();
+			target.written_frame = ~0ull;
+			target_bytes += requests[target_idx].size;
+
+			const RenderGraphPlacement& placement = alias_plan.placements[target_idx];
+			if (placement.heap < 0)
+			{
+				target.allocate_outputs();
+				continue;
+			}
+			VkDeviceSize offsets[RENDER_PASS_MAX_COLOR_OUTPUTS + 1];
+			for (i32 output_idx = 0; output_idx < target.get_images_per_set(); ++output_idx)
+			{
+				offsets[output_idx] = placement.offset + image_offsets[target_idx][output_idx];
+			}
+			target.allocate_outputs(alias_heaps[placement.heap], offsets);
+			for (i32 other_idx = 0; other_idx < target_count; ++other_idx)
+			{
+				if ((alias_plan.aliases[target_idx] & render_graph_bit(other_idx)) != 0)
+				{
+					target.memory_aliases.add(&targets[other_idx]);
+				}
+			}
+			++placed_count;
+		}
+
+		ctx->metrics.transient_target_bytes = target_bytes;
+		ctx->metrics.transient_heap_bytes = target_bytes - alias_plan.saved_bytes();
+		printf("Transient render targets: %i aliased in %i heaps, %.1f MB instead of %.1f MB\n",
+			placed_count,
+			(i32) alias_heaps.length(),
+			(f64) ctx->metrics.transient_heap_bytes / (1024.0 * 1024.0),
+			(f64) target_bytes / (1024.0 * 1024.0));
+	}
+
 	void cleanup()
 	{
 		for (RenderPass& target : targets)
 		{
 			target.cleanup();
 		}
+		for (VmaAllocation& heap : alias_heaps)
+		{
+			vulkan_context_retire_allocation(g_vulkan_context, heap);
+		}
+		alias_heaps.reset();
+		transient_dirty = false;
 	}
 };
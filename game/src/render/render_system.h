@@ -28,6 +28,7 @@
 #include "render/ssao_pass.h"
 #include "render/temporal_aa_pass.h"
 #include "render/tessellation.h"
+#include "render/texture_streaming_system.h"
 #include "render/tonemapping_pass.h"
 #include "render/wire_overlay_pass.h"
 #include "state/state.h"
@@ -53,6 +54,20 @@ namespace RenderSystem
 				&in_state.vk, &composite, (prefix + ".composite.pfm").c_str());
 	}
 
+	// One exact capture per G-buffer output: <prefix>.gbuffer<N>.raw
+	inline bool dump_gbuffer_validation(State& in_state, const std::string& prefix)
+	{
+		RenderPass& geometry = get_render_target(RenderTargetId::Geometry);
+		bool succeeded = true;
+		for (i32 output_idx = 0; output_idx < Render::GBUFFER_OUTPUT_COUNT; ++output_idx)
+		{
+			const std::string path = prefix + ".gbuffer" + std::to_string(output_idx) + ".raw";
+			succeeded = vulkan_context_dump_image_raw(
+				&in_state.vk, &geometry.get_color_output(output_idx), path.c_str()) && succeeded;
+		}
+		return succeeded;
+	}
+
 	inline bool dump_cloud_shadow_validation(State& in_state, const std::string& path)
 	{
 		const bool shadow_succeeded = vulkan_context_dump_image_pfm(
@@ -186,7 +201,7 @@ namespace RenderSystem
 	
 		i32 closest_probe_index = -1;
 		f32 closest_t = std::numeric_limits<f32>::max();
-		for (i32 probe_index = 0; probe_index < (i32)g_gi_scene.probes.length(); ++probe_index)
+		for (i32 probe_index = 0; probe_index < (i32)g_gi_scene.layout.probes.length(); ++probe_index)
 		{
 			if (!gi_scene_debug_probe_matches_level_filter(
 				g_gi_scene,
@@ -222,7 +237,11 @@ namespace RenderSystem
 			#if defined(WITH_DEBUG_UI) && WITH_DEBUG_UI
 			glfwSetMonitorCallback(ImGui_ImplGlfw_MonitorCallback);
 			#endif
+			// Pass init only queues its pipelines; they build in parallel when
+			// the batch ends below
+			PipelineBuildService::begin_batch(&in_state.vk);
 			frame_data_init(&in_state.vk);
+			IndirectDraw::init(&in_state.vk);
 			geometry_pass_init(&in_state.vk);
 			ShadowDepthPass::init(&in_state.vk);
 			ShadowBlurPass::init(&in_state.vk);
@@ -334,13 +353,15 @@ namespace RenderSystem
 					in_debug_label, Render::SSAO_FORMAT, render_target_extent_scaled(0.5f),
 					VK_ATTACHMENT_LOAD_OP_CLEAR, {{{ 1.0f, 1.0f, 1.0f, 1.0f }}});
 			};
-			in_state.render_targets.init(RenderTargetId::SSAO, make_ssao_desc("SSAO"));
-			in_state.render_targets.init(RenderTargetId::SSAOBlurHorizontal, make_ssao_desc("SSAO Blur Horizontal"));
+			in_state.render_targets.init(RenderTargetId::SSAO, render_target_transient(make_ssao_desc("SSAO")));
+			in_state.render_targets.init(RenderTargetId::SSAOBlurHorizontal,
+				render_target_transient(make_ssao_desc("SSAO Blur Horizontal")));
 			in_state.render_targets.init(RenderTargetId::SSAOBlurred, make_ssao_desc("SSAO Blur Vertical"));
 		
 			// Screen-space contact shadows share the SSAO target shape (half res,
 			// R8, clear 1 = fully visible)
-			in_state.render_targets.init(RenderTargetId::ScreenSpaceShadowTrace, make_ssao_desc("Screen Space Shadows Trace"));
+			in_state.render_targets.init(RenderTargetId::ScreenSpaceShadowTrace,
+				render_target_transient(make_ssao_desc("Screen Space Shadows Trace")));
 			in_state.render_targets.init(RenderTargetId::ScreenSpaceShadows, make_ssao_desc("Screen Space Shadows Filter"));
 		
 			in_state.render_targets.init(RenderTargetId::Geometry, (RenderPassDesc) {
@@ -413,11 +434,11 @@ namespace RenderSystem
 			});
 		
 			in_state.render_targets.init(RenderTargetId::Fog,
-				render_target_color_desc("Fog", Render::SCENE_COLOR_FORMAT));
+				render_target_transient(render_target_color_desc("Fog", Render::SCENE_COLOR_FORMAT)));
 			in_state.render_targets.init(RenderTargetId::DofCombine,
-				render_target_color_desc("DOF Combine", Render::SCENE_COLOR_FORMAT));
+				render_target_transient(render_target_color_desc("DOF Combine", Render::SCENE_COLOR_FORMAT)));
 			in_state.render_targets.init(RenderTargetId::WireOverlay,
-				render_target_color_desc("Wire Overlay", Render::SCENE_COLOR_FORMAT));
+				render_target_transient(render_target_color_desc("Wire Overlay", Render::SCENE_COLOR_FORMAT)));
 		
 			// TAA ping-pong: two target sets (intermediate = set 0, final = set 1),
 			// each MRT [resolved, history]; the shader reads the other set's history
@@ -432,7 +453,7 @@ namespace RenderSystem
 			in_state.render_targets.init(RenderTargetId::Tonemapping,
 				render_target_color_desc("Tonemapping", Render::SCENE_COLOR_FORMAT));
 			in_state.render_targets.init(RenderTargetId::FXAA,
-				render_target_color_desc("FXAA", Render::SCENE_COLOR_FORMAT));
+				render_target_transient(render_target_color_desc("FXAA", Render::SCENE_COLOR_FORMAT)));
 			in_state.render_targets.init(RenderTargetId::PresentationComposite,
 				render_target_color_desc("Presentation Composite", Render::SCENE_COLOR_FORMAT,
 					render_target_extent_output()));
@@ -442,6 +463,56 @@ namespace RenderSystem
 				.type = ERenderPassType::Swapchain,
 				.debug_label = "Copy To Swapchain",
 			});
+
+			// Every pass the frame may run, in order, with the targets it may
+			// read and write. Transient targets alias by these lifetimes, so a
+			// pass that reads a target must list it even if it only sometimes does.
+			using RT = RenderTargetId;
+			const RenderGraphResourceMask scene_color = render_target_bits({ RT::Lighting, RT::CloudComposite });
+			const RenderGraphResourceMask post_fog = scene_color | render_target_bits({ RT::Fog });
+			const RenderGraphResourceMask post_dof = post_fog | render_target_bits({ RT::DofCombine });
+			const RenderGraphResourceMask post_wire = post_dof | render_target_bits({ RT::WireOverlay });
+			const RenderGraphResourceMask pre_tonemap = post_wire
+				| render_target_bits({ RT::TemporalAAHistory0, RT::TemporalAAHistory1 });
+			const RenderGraphResourceMask scene_position = render_target_bits({ RT::Geometry, RT::CloudComposite });
+			const RenderGraphNodeDecl frame_schedule[] = {
+				{ "Shadow Depth", 0, render_target_bits({ RT::ShadowDepth }) },
+				{ "Shadow Blur Horizontal", render_target_bits({ RT::ShadowDepth }), render_target_bits({ RT::ShadowBlurHorizontal }) },
+				{ "Shadow Blur Vertical", render_target_bits({ RT::ShadowBlurHorizontal }), render_target_bits({ RT::ShadowBlurred }) },
+				{ "Shadow Cascade Debug", render_target_bits({ RT::ShadowDepth, RT::ShadowBlurred }), render_target_bits({ RT::ShadowCascadeDebug }) },
+				{ "Geometry", 0, render_target_bits({ RT::Geometry }) },
+				{ "SSAO", render_target_bits({ RT::Geometry }), render_target_bits({ RT::SSAO }) },
+				{ "SSAO Blur Horizontal", render_target_bits({ RT::SSAO }), render_target_bits({ RT::SSAOBlurHorizontal }) },
+				{ "SSAO Blur Vertical", render_target_bits({ RT::SSAOBlurHorizontal }), render_target_bits({ RT::SSAOBlurred }) },
+				{ "Screen Space Shadows Trace", render_target_bits({ RT::Geometry }), render_target_bits({ RT::ScreenSpaceShadowTrace }) },
+				{ "Screen Space Shadows Filter", render_target_bits({ RT::ScreenSpaceShadowTrace, RT::Geometry }), render_target_bits({ RT::ScreenSpaceShadows }) },
+				{ "Cloud Sun Shadow", render_target_bits({ RT::Geometry, RT::CloudShadow }), render_target_bits({ RT::CloudShadow }) },
+				{ "Lighting",
+					render_target_bits({ RT::Geometry, RT::ShadowDepth, RT::ShadowBlurred, RT::SSAOBlurred, RT::ScreenSpaceShadows, RT::CloudShadow }),
+					render_target_bits({ RT::Lighting }) },
+				{ "Cloud Ray March", render_target_bits({ RT::Geometry }), render_target_bits({ RT::CloudRaymarch }) },
+				{ "Cloud Temporal",
+					render_target_bits({ RT::CloudRaymarch, RT::CloudHistory0, RT::CloudHistory1 }),
+					render_target_bits({ RT::CloudHistory0, RT::CloudHistory1 }) },
+				{ "Cloud Composite",
+					render_target_bits({ RT::Lighting, RT::Geometry, RT::CloudHistory0, RT::CloudHistory1 }),
+					render_target_bits({ RT::CloudComposite }) },
+				{ "Fog", scene_color | scene_position, render_target_bits({ RT::Fog }) },
+				{ "DOF Combine", post_fog | scene_position, render_target_bits({ RT::DofCombine }) },
+				{ "Wire Overlay", post_dof | render_target_bits({ RT::Geometry }), render_target_bits({ RT::WireOverlay }) },
+				{ "Temporal AA",
+					post_wire | scene_position | render_target_bits({ RT::TemporalAAHistory0, RT::TemporalAAHistory1 }),
+					render_target_bits({ RT::TemporalAAHistory0, RT::TemporalAAHistory1 }) },
+				{ "Exposure And Bloom", pre_tonemap | render_target_bits({ RT::Geometry }), 0 },
+				{ "Tonemapping", pre_tonemap | render_target_bits({ RT::Geometry }), render_target_bits({ RT::Tonemapping }) },
+				{ "FXAA", render_target_bits({ RT::Tonemapping }), render_target_bits({ RT::FXAA }) },
+				{ "Presentation Composite",
+					render_target_bits({ RT::FXAA, RT::Tonemapping, RT::CloudShadow }),
+					render_target_bits({ RT::PresentationComposite }) },
+				{ "Copy To Swapchain", render_target_bits({ RT::PresentationComposite }), render_target_bits({ RT::Swapchain }) },
+			};
+			in_state.render_targets.declare_schedule(frame_schedule, (i32) (sizeof(frame_schedule) / sizeof(frame_schedule[0])));
+			PipelineBuildService::end_batch(&in_state.vk);
 		
 			resize(in_state, /*in_force=*/ true);
 	}
@@ -455,6 +526,7 @@ namespace RenderSystem
 		resize(in_state, in_state.window.render_resolution_dirty);
 		AutoAdaptationPass::consume_diagnostics(
 			&in_state.vk, in_state.tonemapping);
+		TextureStreamingSystem::begin_frame(in_state);
 		ImGuiLayer::begin_frame();
 		return true;
 	}
@@ -537,7 +609,11 @@ namespace RenderSystem
 				get_render_object_snapshot_buffer(in_state).get_gpu_buffer(),
 				in_state.materials.buffer.get_gpu_buffer(),
 				get_skin_matrix_arena_buffer(in_state).get_gpu_buffer(),
+				IndirectDraw::records_buffer(&in_state.vk, in_state),
+				IndirectDraw::instances_buffer(&in_state.vk, in_state),
 				in_state.images.items.data(),
+				in_state.images.upload_tickets.data(),
+				in_state.images.first_mips.data(),
 				(i32) in_state.images.items.length()
 			);
 			RenderPass& tonemapping_render_pass = get_render_target(RenderTargetId::Tonemapping);
@@ -777,11 +853,14 @@ namespace RenderSystem
 			}
 			const bool show_cloud_shadow_fullscreen =
 				in_state.clouds.debug_show_shadow_map_fullscreen;
+			const i32 debug_image_index = CLAMP(
+				in_state.images.debug_index, 0, (i32) in_state.images.items.length() - 1);
 			FrameGraphImage presentation_input = show_cloud_shadow_fullscreen
 				? frame_graph_color(cloud_shadow_render_pass)
 				: in_state.images.enable_debug_fullscreen && in_state.images.items.length() > 0
-					? FrameGraphImage { .image = &in_state.images.items[CLAMP(
-						in_state.images.debug_index, 0, (i32) in_state.images.items.length() - 1)] }
+					? FrameGraphImage { .image = vulkan_upload_ready(&in_state.vk, in_state.images.upload_tickets[debug_image_index])
+						? &in_state.images.items[debug_image_index]
+						: &frame_data.placeholder_image }
 					: frame_graph_select(fxaa_active, frame_graph_color(fxaa_render_pass),
 						frame_graph_color(tonemapping_render_pass));
 			copy_to_swapchain_pass_update_presentation_input(
@@ -793,7 +872,7 @@ namespace RenderSystem
 			// atmosphere update, before the main pass chain samples the probe atlas.
 			{
 				CPU_TIMING_SCOPE("GI Scene Update");
-				gi_scene_update(&in_state.vk, g_gi_scene, in_state);
+				gi_scene_update(&in_state.vk, g_gi_scene, in_state, camera.location, view_projection_matrix);
 			}
 		
 			// Cascade matrices are CPU-side inputs to both the shadow draw and the
@@ -805,8 +884,27 @@ namespace RenderSystem
 				in_state.shadow.centered_square_center = camera.location
 					+ HMM_NormV3(camera.forward) * in_state.shadow.centered_square_lookahead_distance;
 			}
-			const bool shadow_map_updated = ShadowDepthPass::compute_cascade_matrices(in_state, camera);
+			const ShadowDepthPass::CascadeUpdate shadow_update = ShadowDepthPass::compute_cascade_matrices(in_state, camera);
 			in_state.shadow.force_recapture = false;
+			in_state.vk.metrics.shadow_cascades_rendered += (u64) in_state.data_oriented.frame.shadow_cascades_rendered;
+			in_state.vk.metrics.shadow_cascades_cached += (u64) in_state.data_oriented.frame.shadow_cascades_cached;
+
+			// Pool uploads, draw records and per-view commands for the camera and
+			// the cascades that re-render this frame
+			{
+				HMM_Mat4 indirect_view_projections[IndirectDraw::MAX_VIEWS];
+				bool indirect_view_active[IndirectDraw::MAX_VIEWS] = {};
+				indirect_view_projections[IndirectDraw::CAMERA_VIEW] = view_projection_matrix;
+				indirect_view_active[IndirectDraw::CAMERA_VIEW] = true;
+				const i32 cascade_count = ShadowDepthPass::get_active_cascade_count(in_state);
+				for (i32 cascade_idx = 0; cascade_idx < MAX_SHADOW_CASCADES; ++cascade_idx)
+				{
+					indirect_view_projections[1 + cascade_idx] = ShadowDepthPass::shadow_view_projections[cascade_idx];
+					indirect_view_active[1 + cascade_idx] = cascade_idx < cascade_count
+						&& (shadow_update.render_mask & (1u << cascade_idx)) != 0;
+				}
+				IndirectDraw::prepare(&in_state.vk, in_state, indirect_view_projections, indirect_view_active, IndirectDraw::MAX_VIEWS);
+			}
 		
 			// Lighting fs_params: direct, shadow, post-occlusion, and probe GI in_state.
 			LightingFsParams lighting_fs_params = {};
@@ -828,8 +926,8 @@ namespace RenderSystem
 			lighting_fs_params.gi_intensity = in_state.gi.intensity;
 			lighting_fs_params.atlas_total_size = GI_Scene::atlas_total_size;
 			lighting_fs_params.atlas_entry_size = GI_Scene::atlas_entry_size;
-			lighting_fs_params.gi_fallback_probe_index = g_gi_scene.fallback_probe_index;
-			lighting_fs_params.gi_octree_node_count = (i32) g_gi_scene.octree_nodes.length();
+			lighting_fs_params.gi_fallback_probe_index = g_gi_scene.layout.fallback_probe_index;
+			lighting_fs_params.gi_octree_node_count = (i32) g_gi_scene.layout.octree_nodes.length();
 			lighting_fs_params.isolated_probe_index = in_state.gi.probe_isolation_enable
 				? (in_state.gi.isolated_probe_index >= 0 ? in_state.gi.isolated_probe_index : -2)
 				: -1;
@@ -957,27 +1055,30 @@ namespace RenderSystem
 		
 			FrameRenderGraph graph(&in_state.vk);
 
-			// Shadow cascades: one moments slice per active cascade. Skipped entirely
-			// without a valid shadow sun; under depth_freeze the stale map remains a
-			// persistent graph resource sampled with its frozen matrices.
-			if (shadow_map_updated)
+			// Shadow cascades: one moments slice per active cascade, rendering only
+			// the slices the cascade cache marked. Skipped entirely without a valid
+			// shadow sun; under depth_freeze the stale map remains a persistent
+			// graph resource sampled with its frozen matrices. The pass still runs
+			// (and times) when every slice is cached.
+			if (shadow_update.updated)
 			{
 				shadow_render_pass.execute(&in_state.vk, [&](i32 in_cascade_idx)
 				{
 					ShadowDepthPass::render_cascade(&in_state.vk, in_state, in_cascade_idx);
-				}, ShadowDepthPass::get_active_cascade_count(in_state));
+				}, ShadowDepthPass::get_active_cascade_count(in_state), shadow_update.render_mask);
 			}
 			// Separable blur over the moments — the source of EVSM's soft penumbra.
-			// Runs only when the shadow map re-rendered; graph reads transition stale
-			// or freshly rendered targets when a consumer actually selects them.
-			if (shadow_map_updated && in_state.shadow.blur_enable)
+			// Runs only over re-rendered slices; graph reads transition stale or
+			// freshly rendered targets when a consumer actually selects them.
+			if (shadow_update.updated && in_state.shadow.blur_enable)
 			{
 				graph.make_sampled(frame_graph_color(shadow_render_pass));
 				ShadowBlurPass::execute_separable(
 					&in_state.vk,
 					shadow_blur_horizontal,
 					shadow_blurred,
-					ShadowDepthPass::get_active_cascade_count(in_state)
+					ShadowDepthPass::get_active_cascade_count(in_state),
+					shadow_update.render_mask
 				);
 			}
 			in_state.shadow.debug_cascade_index = CLAMP(
@@ -1004,13 +1105,29 @@ namespace RenderSystem
 			// culled on the CPU; skinned meshes bypass the frustum test.
 			graph.execute(geometry_render_pass, [&](i32)
 			{
-				geometry_pass_bind(&in_state.vk);
+				geometry_pass_bind(&in_state.vk, TextureStreamingSystem::enabled(&in_state.vk));
 		
 				if (in_state.render_objects.valid)
 				{
-					CullResult cull_result = cull_objects(in_state, view_projection_matrix,
-						in_state.tessellation.enabled ? in_state.tessellation.bounds_padding : 0.0f);
-					for (i32 mesh_object_id : cull_result.object_ids)
+					// Pooled meshes go out as indirect draws; the rest (or all of
+					// them on the direct path) draw one by one below
+					CullResult cull_result;
+					const DynamicArray<i32>* object_ids = &cull_result.object_ids;
+					if (IndirectDraw::view_active(IndirectDraw::CAMERA_VIEW))
+					{
+						const IndirectDraw::DrawCounts counts = geometry_pass_draw_indirect(&in_state.vk, in_state.animation.skinning_debug_view);
+						in_state.data_oriented.frame.draw_calls += counts.draw_calls;
+						in_state.data_oriented.frame.draw_mesh_count += counts.mesh_count;
+						in_state.data_oriented.frame.indirect_draw_meshes += counts.mesh_count;
+						in_state.data_oriented.frame.indirect_draw_commands += counts.command_count;
+						object_ids = &IndirectDraw::direct_object_ids(IndirectDraw::CAMERA_VIEW);
+					}
+					else
+					{
+						cull_result = cull_objects(in_state, view_projection_matrix,
+							in_state.tessellation.enabled ? in_state.tessellation.bounds_padding : 0.0f);
+					}
+					for (i32 mesh_object_id : *object_ids)
 					{
 						auto found = in_state.scene.objects.find(mesh_object_id);
 						if (found == in_state.scene.objects.end())
@@ -1311,7 +1428,7 @@ namespace RenderSystem
 
 		in_state.render_targets.cleanup();
 
-		in_state.render_objects.shutdown();
+		in_state.render_objects.buffer.destroy_gpu_buffer();
 		in_state.skin_matrices.shutdown();
 		in_state.materials.buffer.destroy_gpu_buffer();
 		for (i32 buffer_idx = 0; buffer_idx < RENDER_OBJECT_SNAPSHOT_BUFFER_COUNT; ++buffer_idx)
@@ -1342,7 +1459,9 @@ namespace RenderSystem
 		ShadowCascadeDebugPass::shutdown(&in_state.vk);
 		ShadowDepthPass::shutdown(&in_state.vk);
 		geometry_pass_shutdown(&in_state.vk);
+		IndirectDraw::shutdown(&in_state.vk);
 		frame_data_shutdown(&in_state.vk);
+		PipelineBuildService::shutdown(&in_state.vk);
 		vulkan_context_shutdown(&in_state.vk);
 	}
 }
@@ -2,24 +2,7 @@
 
 #include "core/types.h"
 #include "handmade_math/HandmadeMath.h"
-
-// The flatbuffer parser and shader vertex input both require this 48-byte layout.
-struct Vertex
-{
-	HMM_Vec4 position;
-	HMM_Vec4 normal;
-	HMM_Vec2 texcoord;
-	f32 _padding[2];
-};
-static_assert(sizeof(Vertex) == 48, "Vertex must stay 48 bytes for flatbuffer and shader input compatibility");
-
-// Per-vertex skinning data (second vertex buffer for skinned draws)
-struct SkinnedVertex
-{
-	HMM_Vec4 joint_indices;
-	HMM_Vec4 joint_weights;
-};
-static_assert(sizeof(SkinnedVertex) == 32, "SkinnedVertex must match the skinned vertex input layout");
+#include "render/vertex_types.h"
 
 // Vulkan uses [0, 1] clip-space depth. Reverse-Z swaps far/near in the
 // projection, uses GREATER comparison, and clears depth to 0. This improves
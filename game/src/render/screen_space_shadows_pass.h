@@ -84,16 +84,16 @@ namespace ScreenSpaceShadowsPass
 		return out_layout;
 	}
 
-	inline VkPipeline create_pipeline(VulkanContext* ctx, VkPipelineLayout in_layout, const char* in_vert_path, const char* in_frag_path)
+	inline void create_pipeline(VulkanContext* ctx, VkPipelineLayout in_layout, const char* in_vert_path, const char* in_frag_path, VkPipeline* out_pipeline)
 	{
 		VkFormat mask_format = Render::SSAO_FORMAT;
-		return vulkan_create_fullscreen_pipeline(ctx, {
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = in_vert_path,
 			.fragment_shader_path = in_frag_path,
 			.pipeline_layout = in_layout,
 			.color_formats = &mask_format,
 			.color_format_count = 1,
-		});
+		}, out_pipeline);
 	}
 
 	inline void init(VulkanContext* ctx, VkSampler in_linear_sampler)
@@ -154,15 +154,17 @@ namespace ScreenSpaceShadowsPass
 			VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_create_info, nullptr, &filter_pipeline_layout));
 		}
 
-		trace_pipeline = create_pipeline(
+		create_pipeline(
 			ctx, trace_pipeline_layout,
 			"bin/shaders/screen_space_shadows_trace.vert.spv",
-			"bin/shaders/screen_space_shadows_trace.frag.spv"
+			"bin/shaders/screen_space_shadows_trace.frag.spv",
+			&trace_pipeline
 		);
-		filter_pipeline = create_pipeline(
+		create_pipeline(
 			ctx, filter_pipeline_layout,
 			"bin/shaders/screen_space_shadows_filter.vert.spv",
-			"bin/shaders/screen_space_shadows_filter.frag.spv"
+			"bin/shaders/screen_space_shadows_filter.frag.spv",
+			&filter_pipeline
 		);
 	}
 
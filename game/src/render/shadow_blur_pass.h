@@ -73,13 +73,13 @@ namespace ShadowBlurPass
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_create_info, nullptr, &pipeline_layout));
 
 		VkFormat moments_format = Render::SHADOW_MOMENTS_FORMAT;
-		pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+		vulkan_create_fullscreen_pipeline(ctx, {
 			.vertex_shader_path = "bin/shaders/shadow_blur.vert.spv",
 			.fragment_shader_path = "bin/shaders/shadow_blur.frag.spv",
 			.pipeline_layout = pipeline_layout,
 			.color_formats = &moments_format,
 			.color_format_count = 1,
-		});
+		}, &pipeline);
 	}
 
 	// Writes the two static input sets. Called once after the ShadowDepth +
@@ -144,12 +144,14 @@ namespace ShadowBlurPass
 
 	// Horizontal into the intermediate target, vertical into the final one.
 	// Expects the raw moments image already in SHADER_READ_ONLY; leaves both
-	// blur targets in SHADER_READ_ONLY.
+	// blur targets in SHADER_READ_ONLY. Only the cascades in in_cascade_mask
+	// are blurred; the others keep their cached result.
 	inline void execute_separable(
 		VulkanContext* ctx,
 		RenderPass& in_horizontal_pass,
 		RenderPass& in_vertical_pass,
-		i32 in_active_cascade_count)
+		i32 in_active_cascade_count,
+		u32 in_cascade_mask = ~0u)
 	{
 		RenderPass& horizontal_pass = in_horizontal_pass;
 		RenderPass& vertical_pass = in_vertical_pass;
@@ -158,14 +160,14 @@ namespace ShadowBlurPass
 		horizontal_pass.execute(ctx, [&](i32 in_cascade_idx)
 		{
 			draw_blur_slice(ctx, horizontal_input_set, HMM_V2(1.0f, 0.0f), in_cascade_idx);
-		}, in_active_cascade_count);
+		}, in_active_cascade_count, in_cascade_mask);
 
 		gpu_image_transition(command_buffer, horizontal_pass.get_color_output(0), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
 		vertical_pass.execute(ctx, [&](i32 in_cascade_idx)
 		{
 			draw_blur_slice(ctx, vertical_input_set, HMM_V2(0.0f, 1.0f), in_cascade_idx);
-		}, in_active_cascade_count);
+		}, in_active_cascade_count, in_cascade_mask);
 	}
 
 	inline void shutdown(VulkanContext* ctx)
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include "core/types.h"
+
+// ---- Shadow cascade cache ----
+// Texel-snapped cascade projections and the policy that decides which
+// cascade slices re-render. A cascade covers a fixed-size light-space square:
+// the bounding sphere of its frustum slice (a function of the cascade
+// distances, fov and aspect only), padded by one snap step. The light basis
+// is a pure rotation of the sun direction, and the square's centre moves in
+// whole snap steps of in_snap_texels texels. Camera motion therefore shifts
+// the map by whole texels (no shimmering), and a camera that stays within a
+// step reproduces last frame's matrix bit for bit.
+//
+// A slice is reused while its matrix is unchanged and no caster inside it
+// moved. Casters that moved mark the slices they touch (old and new boxes);
+// a dirty slice re-renders once its update interval has passed.
+
+static constexpr i32 SHADOW_CASCADE_CACHE_SLOTS = 4;
+
+struct ShadowCascadeCacheSlot
+{
+	HMM_Mat4 view_projection = {};	// matrix the slice was last rendered with
+	u64 rendered_frame = 0;
+	bool valid = false;
+	bool contents_dirty = false;
+};
+
+struct ShadowCascadeCache
+{
+	ShadowCascadeCacheSlot slots[SHADOW_CASCADE_CACHE_SLOTS];
+	u64 scene_revision = ~0ull;	// SceneIndexes::revision the slices were rendered against
+	u32 settings_key = 0;		// other inputs the slices depend on (blur, tessellation, ...)
+};
+
+// View matrix looking along in_sun_direction with no translation. Snapping
+// happens in this basis, so it must not depend on the camera.
+inline HMM_Mat4 shadow_cascade_light_rotation(HMM_Vec3 in_sun_direction)
+{
+	HMM_Vec3 light_up = HMM_V3(0.0f, 0.0f, 1.0f);
+	if (fabsf(HMM_DotV3(in_sun_direction, light_up)) > 0.99f)
+	{
+		light_up = HMM_V3(0.0f, 1.0f, 0.0f);
+	}
+	return HMM_LookAt_RH(HMM_V3(0.0f, 0.0f, 0.0f), in_sun_direction, light_up);
+}
+
+// Bounding-sphere radius of the frustum slice between two view distances,
+// around its centre at (near + far) / 2 along the view direction. Computed
+// in view space so it does not pick up rounding from the camera position.
+inline f32 shadow_cascade_slice_radius(f32 in_near_distance, f32 in_far_distance, f32 in_fov_radians, f32 in_aspect_ratio)
+{
+	const f32 tan_half_fov = tanf(in_fov_radians * 0.5f);
+	const f32 center_distance = (in_near_distance + in_far_distance) * 0.5f;
+	const auto corner_distance_squared = [&](f32 in_distance)
+	{
+		const f32 half_height = tan_half_fov * in_distance;
+		const f32 half_width = half_height * in_aspect_ratio;
+		const f32 depth = in_distance - center_distance;
+		return half_width * half_width + half_height * half_height + depth * depth;
+	};
+	return sqrtf(fmaxf(corner_distance_squared(in_near_distance), corner_distance_squared(in_far_distance)));
+}
+
+// Half extent of the square whose snapped placement still covers a sphere of
+// in_radius: the centre moves up to half a step (step = snap_texels texels of
+// 2 * half_extent / resolution), so half_extent = radius + step / 2.
+inline f32 shadow_cascade_half_extent(f32 in_radius, i32 in_resolution, i32 in_snap_texels)
+{
+	const f32 snap_fraction = (f32) in_snap_texels / (f32) in_resolution;
+	return in_radius / (1.0f - snap_fraction);
+}
+
+inline f32 shadow_cascade_snap_step(f32 in_half_extent, i32 in_resolution, i32 in_snap_texels)
+{
+	return 2.0f * in_half_extent / (f32) in_resolution * (f32) in_snap_texels;
+}
+
+// Reverse-Z orthographic light view-projection centred on in_center, with
+// the centre snapped to whole steps in light space. Covers
+// +-in_half_extent across and +-in_depth_radius along the light.
+inline HMM_Mat4 shadow_cascade_snapped_view_projection(
+	const HMM_Mat4& in_light_rotation,
+	HMM_Vec3 in_center,
+	f32 in_half_extent,
+	f32 in_depth_radius,
+	i32 in_resolution,
+	i32 in_snap_texels)
+{
+	const f32 step = shadow_cascade_snap_step(in_half_extent, in_resolution, in_snap_texels);
+	const HMM_Vec4 light_center = HMM_MulM4V4(in_light_rotation, HMM_V4V(in_center, 1.0f));
+	const f32 center_x = roundf(light_center.X / step) * step;
+	const f32 center_y = roundf(light_center.Y / step) * step;
+	const f32 center_depth = -roundf(light_center.Z / step) * step;
+
+	// Reverse-Z orthographic (near depth 1, far 0), written out so the scale
+	// terms do not pick up rounding from the centre: every snapped matrix of
+	// a cascade shares its rotation and scale and differs only in translation.
+	HMM_Mat4 light_projection = {};
+	light_projection.Elements[0][0] = 1.0f / in_half_extent;
+	light_projection.Elements[1][1] = 1.0f / in_half_extent;
+	light_projection.Elements[2][2] = 0.5f / in_depth_radius;
+	light_projection.Elements[3][0] = -center_x / in_half_extent;
+	light_projection.Elements[3][1] = -center_y / in_half_extent;
+	light_projection.Elements[3][2] = 0.5f + center_depth * (0.5f / in_depth_radius);
+	light_projection.Elements[3][3] = 1.0f;
+	return HMM_MulM4(light_projection, in_light_rotation);
+}
+
+// Forgets every slice (new sun, resized map, settings the slices bake in)
+inline void shadow_cascade_cache_invalidate(ShadowCascadeCache& in_cache)
+{
+	for (ShadowCascadeCacheSlot& slot : in_cache.slots)
+	{
+		slot.valid = false;
+		slot.contents_dirty = false;
+	}
+}
+
+// Marks the valid slices that any of in_boxes overlaps (conservative box vs
+// light-volume test, the same planes the cascade's cull uses)
+inline void shadow_cascade_cache_mark_moved(ShadowCascadeCache& in_cache, const BoundingBox* in_boxes, size_t in_box_count)
+{
+	if (in_box_count == 0)
+	{
+		return;
+	}
+
+	for (ShadowCascadeCacheSlot& slot : in_cache.slots)
+	{
+		if (!slot.valid || slot.contents_dirty)
+		{
+			continue;
+		}
+		const Frustum frustum = frustum_create(slot.view_projection);
+		for (size_t box_idx = 0; box_idx < in_box_count; ++box_idx)
+		{
+			if (!frustum_cull(frustum, in_boxes[box_idx]))
+			{
+				slot.contents_dirty = true;
+				break;
+			}
+		}
+	}
+}
+
+// Decides whether a slice re-renders this frame with in_view_projection and,
+// if so, records it as rendered. in_always bypasses the cache (near cascade,
+// caching disabled); a dirty slice waits until in_dirty_interval frames have
+// passed since it last rendered.
+inline bool shadow_cascade_cache_update_slot(
+	ShadowCascadeCacheSlot& in_slot,
+	const HMM_Mat4& in_view_projection,
+	u64 in_frame,
+	i32 in_dirty_interval,
+	bool in_always)
+{
+	const bool render = in_always
+		|| !in_slot.valid
+		|| memcmp(&in_slot.view_projection, &in_view_projection, sizeof(HMM_Mat4)) != 0
+		|| (in_slot.contents_dirty && in_frame - in_slot.rendered_frame >= (u64) MAX(1, in_dirty_interval));
+	if (render)
+	{
+		in_slot.view_projection = in_view_projection;
+		in_slot.rendered_frame = in_frame;
+		in_slot.valid = true;
+		in_slot.contents_dirty = false;
+	}
+	return render;
+}
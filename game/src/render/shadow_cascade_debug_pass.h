@@ -2,7 +2,7 @@
 
 #include "render/frame_data.h"
 #include "render/render_pass.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 
 namespace ShadowCascadeDebugPass
 {
@@ -15,7 +15,7 @@ namespace ShadowCascadeDebugPass
 	inline VkDescriptorPool pool = VK_NULL_HANDLE;
 	inline VkDescriptorSet sets[MAX_FRAMES_IN_FLIGHT] = {};
 	inline VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
-	inline VkPipeline pipeline = VK_NULL_HANDLE;
+	inline DeferredPipeline pipeline;	// debug view only; built when first shown
 
 	inline void init(VulkanContext* ctx)
 	{
@@ -51,8 +51,8 @@ namespace ShadowCascadeDebugPass
 		};
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_info, nullptr, &pipeline_layout));
 
-		VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, "bin/shaders/shadow_cascade_debug.vert.spv");
-		VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/shadow_cascade_debug.frag.spv");
+		VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, "bin/shaders/shadow_cascade_debug.vert.spv");
+		VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, "bin/shaders/shadow_cascade_debug.frag.spv");
 		VkPipelineShaderStageCreateInfo stages[] = {
 			{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = vertex_module, .pName = "main" },
 			{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = fragment_module, .pName = "main" },
@@ -84,9 +84,7 @@ namespace ShadowCascadeDebugPass
 			.pDynamicState = &dynamic,
 			.layout = pipeline_layout,
 		};
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_info, &pipeline));
-		vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-		vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
+		PipelineBuildService::defer_graphics(pipeline_info, &pipeline);
 	}
 
 	inline void render(VulkanContext* ctx, VkImageView moments_view, VkSampler sampler, i32 cascade_index, i32 view_mode)
@@ -96,7 +94,7 @@ namespace ShadowCascadeDebugPass
 		vulkan_update_descriptor_sets(ctx, 1, &write);
 
 		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
-		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, PipelineBuildService::resolve(ctx, pipeline));
 		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &sets[ctx->frame_index], 0, nullptr);
 		PushConstants push = { .cascade_index = cascade_index, .view_mode = view_mode };
 		vkCmdPushConstants(command_buffer, pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
@@ -105,7 +103,7 @@ namespace ShadowCascadeDebugPass
 
 	inline void shutdown(VulkanContext* ctx)
 	{
-		vkDestroyPipeline(ctx->device, pipeline, nullptr);
+		PipelineBuildService::destroy(ctx, pipeline);
 		vkDestroyPipelineLayout(ctx->device, pipeline_layout, nullptr);
 		vkDestroyDescriptorPool(ctx->device, pool, nullptr);
 	}
@@ -3,53 +3,74 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
 #include "render/culling.h"
+#include "render/geometry_pass.h"
+#include "render/shadow_cascade_cache.h"
 #include "game_object/mesh.h"
 
-#include <cfloat>
+#include <bit>
 #include <cmath>
 
 // Cascaded EVSM shadow maps using frustum or centered-squares placement.
 // Cascade view-projection matrices are computed on the CPU.
 // Array pass: one 2048x2048 RGBA16F moments image with MAX_SHADOW_CASCADES
 // layers + throwaway D32; each slice renders one cascade. Exponential
-// doubling splits (100 * scale * 2^(i-1)), sphere-bounded frustum fit,
-// and no texel snapping.
+// doubling splits (100 * scale * 2^(i-1)) and a sphere-bounded frustum fit,
+// texel-snapped in a camera-independent light basis
+// (render/shadow_cascade_cache.h). The near cascade re-renders every frame;
+// the others keep their slice while their snapped matrix is unchanged and no
+// caster inside them moved.
 
 namespace ShadowDepthPass
 {
 	constexpr i32 ShadowMapResolution = 2048;
 	constexpr f32 BaselineCascadeDistance = 100.0f;
+	constexpr i32 FirstCachedCascade = 1;
+	// Snap steps: distant cascades move 8 texels at a time (0.4% padding per
+	// side), so a walking camera invalidates them about 8x less often
+	constexpr i32 NearCascadeSnapTexels = 1;
+	constexpr i32 CachedCascadeSnapTexels = 8;
+	static_assert(MAX_SHADOW_CASCADES <= SHADOW_CASCADE_CACHE_SLOTS, "One cache slot per cascade");
 
 	inline bool has_valid_shadow_map = false;
 	inline HMM_Mat4 shadow_view_projections[MAX_SHADOW_CASCADES] = {};
 	inline f32 cascade_distances[MAX_SHADOW_CASCADES] = {};
 	inline HMM_Vec3 cascade_view_position = {};
 	inline HMM_Vec3 cascade_view_forward = HMM_V3(0.0f, 1.0f, 0.0f);
+	inline ShadowCascadeCache cascade_cache;
+	inline DynamicArray<BoundingBox> animated_caster_bounds;	// scratch
+
+	// What compute_cascade_matrices decided for this frame
+	struct CascadeUpdate
+	{
+		bool updated = false;	// matrices recomputed (false while frozen or without a sun)
+		u32 render_mask = 0;	// cascades whose slices re-render
+	};
 
 	struct PushConstants
 	{
 		HMM_Mat4 light_view_projection;
 		i32 object_index;
 		i32 skin_matrix_offset;
+		i32 _pad0[2];
+
+		// Compact draws only: the mesh AABB unorm16 positions decode against
+		HMM_Vec4 position_min;
+		HMM_Vec4 position_extent;
 	};
-	// 72 bytes of payload, padded to 80 by HMM_Mat4's 16-byte alignment —
-	// still under the 128-byte push constant minimum
-	static_assert(sizeof(PushConstants) == 80, "Must fit the 128-byte push constant minimum");
+	// 112 bytes — still under the 128-byte push constant minimum
+	static_assert(sizeof(PushConstants) == 112, "Must fit the 128-byte push constant minimum");
 
 	inline VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
 	inline VkPipeline pipeline = VK_NULL_HANDLE;
 	inline VkPipeline skinned_pipeline = VK_NULL_HANDLE;
+	inline VkPipeline compact_pipeline = VK_NULL_HANDLE;
+	inline VkPipeline indirect_pipeline = VK_NULL_HANDLE;	// IndirectDraw views 1 + cascade
+	inline VkPipeline indirect_compact_pipeline = VK_NULL_HANDLE;
 	inline VkPipeline bound_pipeline = VK_NULL_HANDLE;
 
-	// Reverse-Z orthographic projection swaps near and far.
-	inline HMM_Mat4 mat4_orthographic(f32 left, f32 right, f32 bottom, f32 top, f32 near_plane, f32 far_plane)
-	{
-		return HMM_Orthographic_RH_ZO(left, right, bottom, top, far_plane, near_plane);
-	}
-
 	inline i32 get_active_cascade_count(const State& in_state)
 	{
 		if (in_state.shadow.num_cascades < 1)
@@ -83,38 +104,6 @@ namespace ShadowDepthPass
 		return get_cascade_distance(in_state, get_active_cascade_count(in_state) - 1);
 	}
 
-	inline void get_frustum_slice_corners(
-		const Camera& in_camera,
-		f32 in_near_distance,
-		f32 in_far_distance,
-		f32 in_fov_radians,
-		f32 in_aspect_ratio,
-		HMM_Vec3 out_corners[8]
-	)
-	{
-		const HMM_Vec3 forward = HMM_NormV3(in_camera.forward);
-		const HMM_Vec3 right = HMM_NormV3(HMM_Cross(forward, in_camera.up));
-		const HMM_Vec3 up = HMM_NormV3(HMM_Cross(right, forward));
-		const f32 tan_half_fov = tanf(in_fov_radians * 0.5f);
-
-		const f32 near_half_height = tan_half_fov * in_near_distance;
-		const f32 near_half_width = near_half_height * in_aspect_ratio;
-		const f32 far_half_height = tan_half_fov * in_far_distance;
-		const f32 far_half_width = far_half_height * in_aspect_ratio;
-
-		const HMM_Vec3 near_center = in_camera.location + forward * in_near_distance;
-		const HMM_Vec3 far_center = in_camera.location + forward * in_far_distance;
-
-		out_corners[0] = near_center - right * near_half_width - up * near_half_height;
-		out_corners[1] = near_center + right * near_half_width - up * near_half_height;
-		out_corners[2] = near_center - right * near_half_width + up * near_half_height;
-		out_corners[3] = near_center + right * near_half_width + up * near_half_height;
-		out_corners[4] = far_center - right * far_half_width - up * far_half_height;
-		out_corners[5] = far_center + right * far_half_width - up * far_half_height;
-		out_corners[6] = far_center - right * far_half_width + up * far_half_height;
-		out_corners[7] = far_center + right * far_half_width + up * far_half_height;
-	}
-
 	inline Object* get_valid_shadow_sun(State& in_state)
 	{
 		if (!in_state.scene.primary_sun_id.has_value())
@@ -139,10 +128,11 @@ namespace ShadowDepthPass
 		return &sun_object;
 	}
 
-	inline VkPipeline create_pipeline(VulkanContext* ctx, const char* in_vertex_shader_path, bool in_skinned)
+	inline void create_pipeline(VulkanContext* ctx, const char* in_vertex_shader_path, MeshVertexInput in_vertex_input, VkPipeline* out_pipeline)
 	{
-		VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, in_vertex_shader_path);
-		VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, "bin/shaders/shadow_depth.frag.spv");
+		const bool skinned = in_vertex_input == MeshVertexInput::Skinned;
+		VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, in_vertex_shader_path);
+		VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, "bin/shaders/shadow_depth.frag.spv");
 
 		VkPipelineShaderStageCreateInfo shader_stages[] = {
 			{
@@ -179,11 +169,15 @@ namespace ShadowDepthPass
 		};
 		VkPipelineVertexInputStateCreateInfo vertex_input = {
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-			.vertexBindingDescriptionCount = in_skinned ? 2u : 1u,
+			.vertexBindingDescriptionCount = skinned ? 2u : 1u,
 			.pVertexBindingDescriptions = vertex_bindings,
-			.vertexAttributeDescriptionCount = in_skinned ? 5u : 3u,
+			.vertexAttributeDescriptionCount = skinned ? 5u : 3u,
 			.pVertexAttributeDescriptions = vertex_attributes,
 		};
+		if (in_vertex_input == MeshVertexInput::Compact)
+		{
+			vertex_input = compact_vertex_input_state();
+		}
 
 		VkPipelineInputAssemblyStateCreateInfo input_assembly = {
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -246,12 +240,7 @@ namespace ShadowDepthPass
 			.renderPass = VK_NULL_HANDLE,
 		};
 
-		VkPipeline out_pipeline = VK_NULL_HANDLE;
-		VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &out_pipeline));
-
-		vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-		vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-		return out_pipeline;
+		PipelineBuildService::graphics(ctx, pipeline_create_info, out_pipeline);
 	}
 
 	inline void init(VulkanContext* ctx)
@@ -270,25 +259,92 @@ namespace ShadowDepthPass
 		};
 		VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_create_info, nullptr, &pipeline_layout));
 
-		pipeline = create_pipeline(ctx, "bin/shaders/shadow_depth.vert.spv", /*in_skinned*/ false);
-		skinned_pipeline = create_pipeline(ctx, "bin/shaders/shadow_depth_skinned.vert.spv", /*in_skinned*/ true);
+		create_pipeline(ctx, "bin/shaders/shadow_depth.vert.spv", MeshVertexInput::Static, &pipeline);
+		create_pipeline(ctx, "bin/shaders/shadow_depth_skinned.vert.spv", MeshVertexInput::Skinned, &skinned_pipeline);
+		create_pipeline(ctx, "bin/shaders/shadow_depth_compact.vert.spv", MeshVertexInput::Compact, &compact_pipeline);
+		if (IndirectDraw::enabled())
+		{
+			create_pipeline(ctx, "bin/shaders/shadow_depth_indirect.vert.spv", MeshVertexInput::Static, &indirect_pipeline);
+			create_pipeline(ctx, "bin/shaders/shadow_depth_compact_indirect.vert.spv", MeshVertexInput::Compact, &indirect_compact_pipeline);
+		}
+	}
+
+	// Picks the cascades that re-render this frame against cascade_cache.
+	// Slices are dropped wholesale when the map was invalidated (UI edits,
+	// no sun last frame), the scene's object set changed, or a setting they
+	// bake in changed. Otherwise casters that moved since the last flush
+	// (State::RenderObjectState::moved_bounds) and animated skinned meshes
+	// dirty the slices they overlap. Tessellated geometry is regenerated per
+	// view, so it disables caching.
+	inline u32 update_cascade_cache(State& in_state, bool in_was_valid, i32 in_cascade_count)
+	{
+		ShadowCascadeCache& cache = cascade_cache;
+		const u32 settings_key = (in_state.shadow.blur_enable ? 1u : 0u)
+			| ((u32) in_state.shadow.cascade_placement_mode << 1);
+		const u64 scene_revision = in_state.scene.indexes.revision;
+		if (!in_was_valid || cache.settings_key != settings_key || cache.scene_revision != scene_revision)
+		{
+			shadow_cascade_cache_invalidate(cache);
+			cache.settings_key = settings_key;
+			cache.scene_revision = scene_revision;
+		}
+
+		const DynamicArray<BoundingBox>& moved_bounds = in_state.render_objects.moved_bounds;
+		shadow_cascade_cache_mark_moved(cache, moved_bounds.data(), moved_bounds.length());
+
+		// A new pose only reaches the store through bone-box bounds; meshes
+		// without them, or whose box did not change, still deform
+		if (in_state.data_oriented.frame.animation_armatures_updated > 0)
+		{
+			animated_caster_bounds.clear();
+			for (i32 skinned_object_id : in_state.scene.indexes.skinned_mesh_object_ids)
+			{
+				auto found = in_state.scene.objects.find(skinned_object_id);
+				if (found != in_state.scene.objects.end())
+				{
+					animated_caster_bounds.add(object_get_bounding_box(found->second));
+				}
+			}
+			shadow_cascade_cache_mark_moved(cache, animated_caster_bounds.data(), animated_caster_bounds.length());
+		}
+
+		const bool caching = in_state.shadow.cache_enable && !in_state.tessellation.enabled;
+		const u64 frame = in_state.data_oriented.frame_index;
+		u32 render_mask = 0;
+		for (i32 cascade_idx = 0; cascade_idx < in_cascade_count; ++cascade_idx)
+		{
+			const bool always = !caching || cascade_idx < FirstCachedCascade;
+			if (shadow_cascade_cache_update_slot(cache.slots[cascade_idx], shadow_view_projections[cascade_idx],
+				frame, in_state.shadow.cache_dirty_interval, always))
+			{
+				render_mask |= 1u << cascade_idx;
+			}
+		}
+
+		const i32 rendered = std::popcount(render_mask);
+		in_state.data_oriented.frame.shadow_cascades_rendered += rendered;
+		in_state.data_oriented.frame.shadow_cascades_cached += in_cascade_count - rendered;
+		return render_mask;
 	}
 
 	// Computes all cascade light view-projections on the CPU for either
 	// placement mode. Must run before the
 	// lighting fs_params upload each frame — the matrices feed both the shadow
-	// draw and the lighting shader's receiver reprojection. Returns true when
-	// the matrices changed and the shadow map should re-render this frame;
-	// under depth_freeze the previous matrices are kept (stale map stays
-	// consistent with them) unless force_recapture is set.
-	inline bool compute_cascade_matrices(State& in_state, const Camera& in_camera)
+	// draw and the lighting shader's receiver reprojection. Returns the
+	// cascades that re-render this frame; under depth_freeze the previous
+	// matrices are kept (stale map stays consistent with them) and nothing
+	// re-renders unless force_recapture is set.
+	inline CascadeUpdate compute_cascade_matrices(State& in_state, const Camera& in_camera)
 	{
 		if (in_state.shadow.rendering_enable && in_state.shadow.depth_freeze
 			&& has_valid_shadow_map && !in_state.shadow.force_recapture)
 		{
-			return false;
+			// Casters that move meanwhile are not tracked
+			shadow_cascade_cache_invalidate(cascade_cache);
+			return {};
 		}
 
+		const bool was_valid = has_valid_shadow_map;
 		for (i32 i = 0; i < MAX_SHADOW_CASCADES; ++i)
 		{
 			shadow_view_projections[i] = HMM_M4D(1.0f);
@@ -298,13 +354,13 @@ namespace ShadowDepthPass
 
 		if (!in_state.shadow.rendering_enable)
 		{
-			return false;
+			return {};
 		}
 
 		Object* sun_object = get_valid_shadow_sun(in_state);
 		if (!sun_object)
 		{
-			return false;
+			return {};
 		}
 
 		// Frustum cascade selection must use the same camera basis that produced
@@ -315,12 +371,7 @@ namespace ShadowDepthPass
 
 		Transform transform = sun_object->current_transform;
 		HMM_Vec3 sun_dir = HMM_NormV3(HMM_RotateV3Q(HMM_V3(0, 0, -1), transform.rotation));
-
-		HMM_Vec3 light_up = HMM_V3(0.0f, 0.0f, 1.0f);
-		if (fabsf(HMM_DotV3(sun_dir, light_up)) > 0.99f)
-		{
-			light_up = HMM_V3(0.0f, 1.0f, 0.0f);
-		}
+		const HMM_Mat4 light_rotation = shadow_cascade_light_rotation(sun_dir);
 
 		const f32 fov = HMM_AngleDeg(60.0f);
 		const f32 aspect_ratio = (f32) in_state.window.render_width / (f32) in_state.window.render_height;
@@ -328,82 +379,64 @@ namespace ShadowDepthPass
 		const i32 cascade_count = get_active_cascade_count(in_state);
 		for (i32 cascade_idx = 0; cascade_idx < cascade_count; ++cascade_idx)
 		{
-			// Centered squares: axis-aligned ortho squares around a point
-			// ahead of the camera.
+			const i32 snap_texels = cascade_idx < FirstCachedCascade ? NearCascadeSnapTexels : CachedCascadeSnapTexels;
+
+			// Centered squares: ortho squares around a point ahead of the
+			// camera.
 			if (in_state.shadow.cascade_placement_mode == EShadowCascadePlacementMode::CenteredSquares)
 			{
 				const f32 cascade_half_extent = get_cascade_distance(in_state, cascade_idx);
 				const f32 largest_half_extent = get_largest_active_cascade_distance(in_state);
 				const f32 light_depth_range = fmaxf(100.0f, largest_half_extent * 4.0f);
-				HMM_Vec3 light_pos = in_state.shadow.centered_square_center - sun_dir * (light_depth_range * 0.5f);
-				HMM_Mat4 light_view = HMM_LookAt_RH(light_pos, in_state.shadow.centered_square_center, light_up);
-				HMM_Mat4 light_proj = mat4_orthographic(
-					-cascade_half_extent,
-					cascade_half_extent,
-					-cascade_half_extent,
-					cascade_half_extent,
-					0.01f,
-					light_depth_range
+				shadow_view_projections[cascade_idx] = shadow_cascade_snapped_view_projection(
+					light_rotation,
+					in_state.shadow.centered_square_center,
+					shadow_cascade_half_extent(cascade_half_extent, ShadowMapResolution, snap_texels),
+					light_depth_range * 0.5f,
+					ShadowMapResolution,
+					snap_texels
 				);
-
-				shadow_view_projections[cascade_idx] = HMM_MulM4(light_proj, light_view);
 				cascade_distances[cascade_idx] = cascade_half_extent;
 				has_valid_shadow_map = true;
 				continue;
 			}
 
-			// Frustum-slice fit
+			// Frustum-slice fit: the slice's bounding sphere, so the extent
+			// does not change as the camera turns
 			const f32 cascade_near_distance = cascade_idx == 0 ? 0.01f : get_cascade_distance(in_state, cascade_idx - 1);
 			const f32 cascade_far_distance = get_cascade_distance(in_state, cascade_idx);
+			const f32 bounding_radius = shadow_cascade_slice_radius(cascade_near_distance, cascade_far_distance, fov, aspect_ratio);
+			const HMM_Vec3 slice_center = in_camera.location
+				+ cascade_view_forward * ((cascade_near_distance + cascade_far_distance) * 0.5f);
 
-			HMM_Vec3 frustum_corners[8];
-			get_frustum_slice_corners(in_camera, cascade_near_distance, cascade_far_distance, fov, aspect_ratio, frustum_corners);
-
-			HMM_Vec3 frustum_center = HMM_V3(0.0f, 0.0f, 0.0f);
-			for (i32 i = 0; i < 8; ++i)
-			{
-				frustum_center += frustum_corners[i] * 0.125f;
-			}
-
-			f32 bounding_radius = 0.0f;
-			for (i32 i = 0; i < 8; ++i)
-			{
-				bounding_radius = fmaxf(bounding_radius, HMM_LenV3(frustum_corners[i] - frustum_center));
-			}
-
+			// Casters up to a margin beyond the sphere, toward the sun, still land
 			const f32 depth_margin = fmaxf(10.0f, bounding_radius * 0.25f);
-			HMM_Vec3 light_pos = frustum_center - sun_dir * (bounding_radius + depth_margin);
-			HMM_Mat4 light_view = HMM_LookAt_RH(light_pos, frustum_center, light_up);
-
-			f32 min_x = FLT_MAX, max_x = -FLT_MAX;
-			f32 min_y = FLT_MAX, max_y = -FLT_MAX;
-			f32 min_z = FLT_MAX, max_z = -FLT_MAX;
-			for (i32 i = 0; i < 8; ++i)
-			{
-				HMM_Vec4 light_space_corner = HMM_MulM4V4(light_view, HMM_V4V(frustum_corners[i], 1.0f));
-				min_x = fminf(min_x, light_space_corner.X);
-				max_x = fmaxf(max_x, light_space_corner.X);
-				min_y = fminf(min_y, light_space_corner.Y);
-				max_y = fmaxf(max_y, light_space_corner.Y);
-				min_z = fminf(min_z, light_space_corner.Z);
-				max_z = fmaxf(max_z, light_space_corner.Z);
-			}
-
-			f32 near_plane = fmaxf(0.01f, -max_z - depth_margin);
-			f32 far_plane = fmaxf(near_plane + 1.0f, -min_z + depth_margin);
-			HMM_Mat4 light_proj = mat4_orthographic(min_x, max_x, min_y, max_y, near_plane, far_plane);
-
-			shadow_view_projections[cascade_idx] = HMM_MulM4(light_proj, light_view);
+			shadow_view_projections[cascade_idx] = shadow_cascade_snapped_view_projection(
+				light_rotation,
+				slice_center,
+				shadow_cascade_half_extent(bounding_radius, ShadowMapResolution, snap_texels),
+				bounding_radius + depth_margin,
+				ShadowMapResolution,
+				snap_texels
+			);
 			cascade_distances[cascade_idx] = cascade_far_distance;
 			has_valid_shadow_map = true;
 		}
 
-		return has_valid_shadow_map;
+		if (!has_valid_shadow_map)
+		{
+			return {};
+		}
+		return (CascadeUpdate) {
+			.updated = true,
+			.render_mask = update_cascade_cache(in_state, was_valid, cascade_count),
+		};
 	}
 
 	// Draws shadow casters for one cascade using the matrix stored by
 	// compute_cascade_matrices. Runs inside the Array pass execute callback;
-	// pass_idx = cascade.
+	// pass_idx = cascade. When IndirectDraw prepared the cascade's view, its
+	// pooled casters go out as indirect draws and only the rest loop here.
 	inline void render_cascade(VulkanContext* ctx, State& in_state, i32 in_cascade_idx)
 	{
 		if (!has_valid_shadow_map || in_cascade_idx >= get_active_cascade_count(in_state))
@@ -413,10 +446,6 @@ namespace ShadowDepthPass
 
 		const HMM_Mat4& light_view_proj = shadow_view_projections[in_cascade_idx];
 
-		// Cull + draw casters
-		CullResult cull_result = cull_objects(in_state, light_view_proj,
-			in_state.tessellation.enabled ? in_state.tessellation.bounds_padding : 0.0f);
-
 		VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
 		bound_pipeline = VK_NULL_HANDLE;
 
@@ -428,7 +457,37 @@ namespace ShadowDepthPass
 			0, nullptr
 		);
 
-		for (i32 object_id : cull_result.object_ids)
+		// Cull + draw casters
+		const u32 indirect_view = 1 + (u32) in_cascade_idx;
+		CullResult cull_result;
+		const DynamicArray<i32>* object_ids = &cull_result.object_ids;
+		if (IndirectDraw::view_active(indirect_view))
+		{
+			PushConstants push_constants = {
+				.light_view_projection = light_view_proj,
+				.object_index = -1,
+				.skin_matrix_offset = -1,
+			};
+			vkCmdPushConstants(command_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_constants), &push_constants);
+			const VkPipeline pipelines[MESH_POOL_BATCH_COUNT] = {
+				indirect_pipeline,
+				indirect_compact_pipeline,
+				indirect_compact_pipeline,
+			};
+			const IndirectDraw::DrawCounts counts = IndirectDraw::draw_view(ctx, indirect_view, pipelines, bound_pipeline);
+			in_state.data_oriented.frame.draw_calls += counts.draw_calls;
+			in_state.data_oriented.frame.draw_mesh_count += counts.mesh_count;
+			in_state.data_oriented.frame.indirect_draw_meshes += counts.mesh_count;
+			in_state.data_oriented.frame.indirect_draw_commands += counts.command_count;
+			object_ids = &IndirectDraw::direct_object_ids(indirect_view);
+		}
+		else
+		{
+			cull_result = cull_objects(in_state, light_view_proj,
+				in_state.tessellation.enabled ? in_state.tessellation.bounds_padding : 0.0f);
+		}
+
+		for (i32 object_id : *object_ids)
 		{
 			auto found = in_state.scene.objects.find(object_id);
 			if (found == in_state.scene.objects.end())
@@ -450,7 +509,8 @@ namespace ShadowDepthPass
 				continue;
 			}
 
-			VkPipeline wanted_pipeline = skinned ? skinned_pipeline : pipeline;
+			const bool compact = mesh_use_compact_vertex_source(mesh, render_view);
+			VkPipeline wanted_pipeline = compact ? compact_pipeline : (skinned ? skinned_pipeline : pipeline);
 			if (bound_pipeline != wanted_pipeline)
 			{
 				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, wanted_pipeline);
@@ -461,6 +521,8 @@ namespace ShadowDepthPass
 				.light_view_projection = light_view_proj,
 				.object_index = object.render_object_index,
 				.skin_matrix_offset = skinned ? mesh.skin_matrix_arena_offset : -1,
+				.position_min = HMM_V4V(mesh.quantization.position_min, 0.0f),
+				.position_extent = HMM_V4V(mesh.quantization.position_extent, 0.0f),
 			};
 			vkCmdPushConstants(command_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_constants), &push_constants);
 
@@ -473,7 +535,7 @@ namespace ShadowDepthPass
 				VkDeviceSize skinned_offset = 0;
 				vkCmdBindVertexBuffers(command_buffer, 1, 1, &skinned_vertex_buffer, &skinned_offset);
 			}
-			vkCmdBindIndexBuffer(command_buffer, render_view.index_buffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(command_buffer, render_view.index_buffer, 0, render_view.index_type);
 			vulkan_cmd_draw_indexed(ctx, render_view.index_count, 1, 0, 0, 0);
 			in_state.data_oriented.frame.draw_calls += 1;
 			in_state.data_oriented.frame.draw_mesh_count += 1;
@@ -482,6 +544,12 @@ namespace ShadowDepthPass
 
 	inline void shutdown(VulkanContext* ctx)
 	{
+		if (indirect_pipeline != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(ctx->device, indirect_compact_pipeline, nullptr);
+			vkDestroyPipeline(ctx->device, indirect_pipeline, nullptr);
+		}
+		vkDestroyPipeline(ctx->device, compact_pipeline, nullptr);
 		vkDestroyPipeline(ctx->device, skinned_pipeline, nullptr);
 		vkDestroyPipeline(ctx->device, pipeline, nullptr);
 		vkDestroyPipelineLayout(ctx->device, pipeline_layout, nullptr);
@@ -3,7 +3,7 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
 #include "render/bruneton_atmosphere_pass.h"
 #include "render/solar_calibration.h"
@@ -113,9 +113,9 @@ inline void sky_pass_init(VulkanContext* ctx)
 		.depthAttachmentFormat = Render::SCENE_DEPTH_FORMAT,
 	};
 	VkShaderModule vertex_module =
-		create_shader_module_from_file(ctx->device, "bin/shaders/sky.vert.spv");
+		PipelineBuildService::shader_module(ctx, "bin/shaders/sky.vert.spv");
 	VkShaderModule fragment_module =
-		create_shader_module_from_file(ctx->device, "bin/shaders/sky.frag.spv");
+		PipelineBuildService::shader_module(ctx, "bin/shaders/sky.frag.spv");
 	VkPipelineShaderStageCreateInfo stages[] = {
 		{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 			.stage = VK_SHADER_STAGE_VERTEX_BIT, .module = vertex_module, .pName = "main" },
@@ -137,9 +137,7 @@ inline void sky_pass_init(VulkanContext* ctx)
 		.pDynamicState = &dynamic_state,
 		.layout = sky_pass.composite_pipeline_layout,
 	};
-	VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_info, &sky_pass.composite_pipeline));
-	vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-	vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
+	PipelineBuildService::graphics(ctx, pipeline_info, &sky_pass.composite_pipeline);
 }
 
 // Updates the active controller and records a full LUT precompute only when
@@ -158,13 +158,13 @@ namespace TemporalAAPass
 			VK_CHECK(vkCreatePipelineLayout(ctx->device, &layout_create_info, nullptr, &pipeline_layout));
 
 			VkFormat color_formats[2] = { Render::SCENE_COLOR_FORMAT, Render::SCENE_COLOR_FORMAT };
-			pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+			vulkan_create_fullscreen_pipeline(ctx, {
 				.vertex_shader_path = "bin/shaders/temporal_aa.vert.spv",
 				.fragment_shader_path = "bin/shaders/temporal_aa.frag.spv",
 				.pipeline_layout = pipeline_layout,
 				.color_formats = color_formats,
 				.color_format_count = 2,
-			});
+			}, &pipeline);
 		}
 	}
 
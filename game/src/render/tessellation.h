@@ -132,7 +132,7 @@ namespace Tessellation
 			.memoryBarrierCount = 1,
 			.pMemoryBarriers = &barrier,
 		};
-		vkCmdPipelineBarrier2(vulkan_current_command_buffer(ctx), &info);
+		gpu_cmd_pipeline_barrier(vulkan_current_command_buffer(ctx), info);
 	}
 
 	inline void cleanup_slot(TessellatedGeometry::GpuSlot& slot)
@@ -271,7 +271,7 @@ namespace Tessellation
 	{
 		Mesh& mesh = object.mesh;
 		TessellatedGeometry& tessellated = mesh.tessellated_geometry;
-		if (mesh.index_count < 3 || mesh.vertex_count == 0
+		if (mesh.index_count < 3 || mesh.vertex_count == 0 || !mesh_gpu_ready(mesh)
 			|| (mesh.has_skinned_vertices && !mesh.skinned_vertex_cache_valid))
 		{
 			tessellated.active = false;
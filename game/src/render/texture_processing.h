@@ -0,0 +1,737 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ankerl/unordered_dense.h"
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "core/worker_pool.h"
+
+// ---- Texture processing ----
+// Turns an imported RGBA8 image into the mip chain the GPU samples. Nothing
+// here touches Vulkan; the live-link thread runs it and the test drives it.
+//
+// The exporter sends linear-encoded bytes (Blender's scene-linear floats *
+// 255). How the image is stored follows the material slots that use it:
+//   - color slots (base color, emission) are re-encoded as sRGB, so the
+//     darks get the finer steps and the hardware decodes before filtering
+//   - data slots (metallic, roughness) only read red and stay linear
+//   - anything else (both kinds, or no material yet) stays linear RGBA
+// Mips are box-filtered in linear space from float levels (odd sizes use
+// the three-tap weights that keep the mean), then quantized per level.
+// With block compression, RGBA levels become BC7 (mode 6) and red-only
+// levels BC4; levels are tightly packed, largest first.
+
+enum class TextureEncoding : u8
+{
+	RGBA8,
+	RGBA8_SRGB,
+	R8,
+	BC7,
+	BC7_SRGB,
+	BC4,
+};
+
+static constexpr u8 TEXTURE_USAGE_COLOR = 1 << 0;	// base color / emission
+static constexpr u8 TEXTURE_USAGE_DATA = 1 << 1;	// metallic / roughness (red only)
+
+// Processed images kept by the live-link thread for re-sent content
+static constexpr u64 TEXTURE_CACHE_DEFAULT_BUDGET_BYTES = 256ull * 1024 * 1024;
+
+struct ProcessedTexture
+{
+	TextureEncoding encoding = TextureEncoding::RGBA8;
+	u32 width = 0;
+	u32 height = 0;
+	u32 mip_count = 0;
+	DynamicArray<u8> data;	// every level, largest first
+};
+
+inline bool texture_encoding_is_srgb(const TextureEncoding in_encoding)
+{
+	return in_encoding == TextureEncoding::RGBA8_SRGB || in_encoding == TextureEncoding::BC7_SRGB;
+}
+
+inline bool texture_encoding_is_red_only(const TextureEncoding in_encoding)
+{
+	return in_encoding == TextureEncoding::R8 || in_encoding == TextureEncoding::BC4;
+}
+
+inline bool texture_encoding_is_block(const TextureEncoding in_encoding)
+{
+	return in_encoding == TextureEncoding::BC7 || in_encoding == TextureEncoding::BC7_SRGB
+		|| in_encoding == TextureEncoding::BC4;
+}
+
+TextureEncoding texture_choose_encoding(const u8 in_usage, const bool in_block_compression)
+{
+	if (in_usage == TEXTURE_USAGE_COLOR)
+	{
+		return in_block_compression ? TextureEncoding::BC7_SRGB : TextureEncoding::RGBA8_SRGB;
+	}
+	if (in_usage == TEXTURE_USAGE_DATA)
+	{
+		return in_block_compression ? TextureEncoding::BC4 : TextureEncoding::R8;
+	}
+	return in_block_compression ? TextureEncoding::BC7 : TextureEncoding::RGBA8;
+}
+
+inline u32 texture_mip_count(const u32 in_width, const u32 in_height)
+{
+	u32 count = 1;
+	for (u32 size = MAX(in_width, in_height); size > 1; size >>= 1)
+	{
+		count += 1;
+	}
+	return count;
+}
+
+inline u32 texture_mip_extent(const u32 in_size, const u32 in_level)
+{
+	return MAX(in_size >> in_level, 1u);
+}
+
+// Tightly packed bytes of one level
+u64 texture_level_bytes(const TextureEncoding in_encoding, const u32 in_width, const u32 in_height)
+{
+	const u64 block_count = (u64) ((in_width + 3) / 4) * ((in_height + 3) / 4);
+	switch (in_encoding)
+	{
+		case TextureEncoding::RGBA8:
+		case TextureEncoding::RGBA8_SRGB:
+			return (u64) in_width * in_height * 4;
+		case TextureEncoding::R8:
+			return (u64) in_width * in_height;
+		case TextureEncoding::BC7:
+		case TextureEncoding::BC7_SRGB:
+			return block_count * 16;
+		case TextureEncoding::BC4:
+			return block_count * 8;
+	}
+	return 0;
+}
+
+u64 texture_chain_bytes(const TextureEncoding in_encoding, const u32 in_width, const u32 in_height, const u32 in_mip_count)
+{
+	u64 byte_count = 0;
+	for (u32 level = 0; level < in_mip_count; ++level)
+	{
+		byte_count += texture_level_bytes(in_encoding,
+			texture_mip_extent(in_width, level), texture_mip_extent(in_height, level));
+	}
+	return byte_count;
+}
+
+// Key of a processed image: the same pixels stored two ways are two images
+inline u64 texture_cache_key(const u64 in_content_hash, const TextureEncoding in_encoding)
+{
+	return in_content_hash ^ ((u64) in_encoding + 1) * 0x9E3779B97F4A7C15ull;
+}
+
+inline f32 texture_srgb_to_linear(const f32 in_value)
+{
+	return in_value <= 0.04045f ? in_value / 12.92f : powf((in_value + 0.055f) / 1.055f, 2.4f);
+}
+
+inline f32 texture_linear_to_srgb(const f32 in_value)
+{
+	return in_value <= 0.0031308f ? in_value * 12.92f : 1.055f * powf(in_value, 1.0f / 2.4f) - 0.055f;
+}
+
+inline u8 texture_quantize(const f32 in_value)
+{
+	return (u8) std::clamp((i32) lrintf(in_value * 255.0f), 0, 255);
+}
+
+// Runs in_function(index) for [0, in_count) on in_workers, or inline without
+void texture_parallel_for(WorkerPool* in_workers, const u32 in_count, const std::function<void(u32)>& in_function)
+{
+	if (in_workers && in_workers->is_started())
+	{
+		in_workers->parallel_for(in_count, in_function);
+		return;
+	}
+	for (u32 index = 0; index < in_count; ++index)
+	{
+		in_function(index);
+	}
+}
+
+// ---- Mip generation ----
+
+struct TextureFilterTaps
+{
+	u32 first = 0;
+	u32 count = 1;
+	f32 weights[3] = { 1.0f, 0.0f, 0.0f };
+};
+
+// Source texels and weights behind destination texel in_index along one axis
+TextureFilterTaps texture_filter_taps(const u32 in_src_size, const u32 in_index)
+{
+	TextureFilterTaps taps;
+	if (in_src_size == 1)
+	{
+		return taps;
+	}
+	taps.first = in_index * 2;
+	if (in_src_size % 2 == 0)
+	{
+		taps.count = 2;
+		taps.weights[0] = 0.5f;
+		taps.weights[1] = 0.5f;
+		return taps;
+	}
+
+	// 2n+1 texels onto n: each destination covers 2 + 1/n source texels
+	const f32 half = (f32) (in_src_size / 2);
+	const f32 src_size = (f32) in_src_size;
+	taps.count = 3;
+	taps.weights[0] = (half - (f32) in_index) / src_size;
+	taps.weights[1] = half / src_size;
+	taps.weights[2] = ((f32) in_index + 1.0f) / src_size;
+	return taps;
+}
+
+// Box-filters one linear RGBA float level into the next
+void texture_downsample(
+	const f32* in_src,
+	const u32 in_src_width,
+	const u32 in_src_height,
+	f32* out_dst,
+	WorkerPool* in_workers)
+{
+	const u32 dst_width = MAX(in_src_width / 2, 1u);
+	const u32 dst_height = MAX(in_src_height / 2, 1u);
+	texture_parallel_for(in_workers, dst_height, [&](u32 in_y)
+	{
+		const TextureFilterTaps taps_y = texture_filter_taps(in_src_height, in_y);
+		for (u32 x = 0; x < dst_width; ++x)
+		{
+			const TextureFilterTaps taps_x = texture_filter_taps(in_src_width, x);
+			f32 sum[4] = {};
+			for (u32 tap_y = 0; tap_y < taps_y.count; ++tap_y)
+			{
+				const f32* src_row = in_src + (size_t) (taps_y.first + tap_y) * in_src_width * 4;
+				for (u32 tap_x = 0; tap_x < taps_x.count; ++tap_x)
+				{
+					const f32 weight = taps_y.weights[tap_y] * taps_x.weights[tap_x];
+					const f32* texel = src_row + (size_t) (taps_x.first + tap_x) * 4;
+					for (u32 channel = 0; channel < 4; ++channel)
+					{
+						sum[channel] += texel[channel] * weight;
+					}
+				}
+			}
+			memcpy(out_dst + ((size_t) in_y * dst_width + x) * 4, sum, sizeof(sum));
+		}
+	});
+}
+
+// ---- Block encoders ----
+
+// BC4: two 8-bit endpoints and a 3-bit index per texel. red0 > red1 selects
+// the eight-value palette; a flat block stores red0 == red1.
+void texture_encode_bc4_block(const u8 in_values[16], u8 out_block[8])
+{
+	u8 low = 255;
+	u8 high = 0;
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		low = std::min(low, in_values[texel]);
+		high = std::max(high, in_values[texel]);
+	}
+	memset(out_block, 0, 8);
+	out_block[0] = high;
+	out_block[1] = low;
+	if (high == low)
+	{
+		return;
+	}
+
+	f32 palette[8] = { (f32) high, (f32) low };
+	for (u32 entry = 2; entry < 8; ++entry)
+	{
+		palette[entry] = ((f32) (8 - entry) * high + (f32) (entry - 1) * low) / 7.0f;
+	}
+	u64 index_bits = 0;
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		u32 best_entry = 0;
+		f32 best_error = 1e30f;
+		for (u32 entry = 0; entry < 8; ++entry)
+		{
+			const f32 error = fabsf(palette[entry] - (f32) in_values[texel]);
+			if (error < best_error)
+			{
+				best_error = error;
+				best_entry = entry;
+			}
+		}
+		index_bits |= (u64) best_entry << (3 * texel);
+	}
+	for (u32 byte = 0; byte < 6; ++byte)
+	{
+		out_block[2 + byte] = (u8) (index_bits >> (8 * byte));
+	}
+}
+
+static constexpr u8 TEXTURE_BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct TextureBC7Endpoints
+{
+	u8 color[2][4];		// 7-bit per channel
+	u8 p_bits[2];
+};
+
+inline u8 texture_bc7_endpoint_value(const TextureBC7Endpoints& in_endpoints, const u32 in_endpoint, const u32 in_channel)
+{
+	return (u8) ((in_endpoints.color[in_endpoint][in_channel] << 1) | in_endpoints.p_bits[in_endpoint]);
+}
+
+// Nearest 7-bit + p-bit representation of an RGBA endpoint
+void texture_bc7_quantize_endpoint(const f32 in_color[4], TextureBC7Endpoints& io_endpoints, const u32 in_endpoint)
+{
+	f32 best_error = 1e30f;
+	for (u8 p_bit = 0; p_bit < 2; ++p_bit)
+	{
+		u8 quantized[4];
+		f32 error = 0.0f;
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			const f32 value = std::clamp(in_color[channel], 0.0f, 255.0f);
+			quantized[channel] = (u8) std::clamp((i32) lrintf((value - (f32) p_bit) * 0.5f), 0, 127);
+			const f32 delta = (f32) ((quantized[channel] << 1) | p_bit) - value;
+			error += delta * delta;
+		}
+		if (error < best_error)
+		{
+			best_error = error;
+			memcpy(io_endpoints.color[in_endpoint], quantized, 4);
+			io_endpoints.p_bits[in_endpoint] = p_bit;
+		}
+	}
+}
+
+// Picks the best of the 16 interpolated colors per texel; returns the
+// squared error of the block
+f32 texture_bc7_select_indices(const u8 in_texels[16][4], const TextureBC7Endpoints& in_endpoints, u8 out_indices[16])
+{
+	f32 palette[16][4];
+	for (u32 entry = 0; entry < 16; ++entry)
+	{
+		const u32 weight = TEXTURE_BC7_WEIGHTS_4[entry];
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			const u32 e0 = texture_bc7_endpoint_value(in_endpoints, 0, channel);
+			const u32 e1 = texture_bc7_endpoint_value(in_endpoints, 1, channel);
+			palette[entry][channel] = (f32) (((64 - weight) * e0 + weight * e1 + 32) >> 6);
+		}
+	}
+
+	f32 total_error = 0.0f;
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		f32 best_error = 1e30f;
+		for (u32 entry = 0; entry < 16; ++entry)
+		{
+			f32 error = 0.0f;
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				const f32 delta = palette[entry][channel] - (f32) in_texels[texel][channel];
+				error += delta * delta;
+			}
+			if (error < best_error)
+			{
+				best_error = error;
+				out_indices[texel] = (u8) entry;
+			}
+		}
+		total_error += best_error;
+	}
+	return total_error;
+}
+
+struct TextureBC7Candidate
+{
+	TextureBC7Endpoints endpoints;
+	u8 indices[16];
+	f32 error = 1e30f;
+};
+
+void texture_bc7_try_endpoints(const u8 in_texels[16][4], const f32 in_e0[4], const f32 in_e1[4], TextureBC7Candidate& io_best)
+{
+	TextureBC7Candidate candidate;
+	texture_bc7_quantize_endpoint(in_e0, candidate.endpoints, 0);
+	texture_bc7_quantize_endpoint(in_e1, candidate.endpoints, 1);
+	candidate.error = texture_bc7_select_indices(in_texels, candidate.endpoints, candidate.indices);
+	if (candidate.error < io_best.error)
+	{
+		io_best = candidate;
+	}
+}
+
+// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit each, and a
+// 4-bit index per texel. Endpoints start on the block's principal axis and
+// are refined by least squares against the chosen indices; the flat block
+// (both endpoints at the mean) is always a candidate, so no block decodes
+// worse than its average color.
+void texture_encode_bc7_block(const u8 in_texels[16][4], u8 out_block[16])
+{
+	f32 mean[4] = {};
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			mean[channel] += (f32) in_texels[texel][channel] / 16.0f;
+		}
+	}
+
+	TextureBC7Candidate best;
+	texture_bc7_try_endpoints(in_texels, mean, mean, best);
+
+	f32 covariance[4][4] = {};
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		f32 delta[4];
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			delta[channel] = (f32) in_texels[texel][channel] - mean[channel];
+		}
+		for (u32 row = 0; row < 4; ++row)
+		{
+			for (u32 column = 0; column < 4; ++column)
+			{
+				covariance[row][column] += delta[row] * delta[column];
+			}
+		}
+	}
+
+	// Principal axis by power iteration, seeded with the dominant channel
+	f32 axis[4] = {};
+	u32 seed_channel = 0;
+	for (u32 channel = 1; channel < 4; ++channel)
+	{
+		if (covariance[channel][channel] > covariance[seed_channel][seed_channel]) seed_channel = channel;
+	}
+	axis[seed_channel] = 1.0f;
+	bool has_axis = covariance[seed_channel][seed_channel] > 0.0f;
+	for (u32 iteration = 0; has_axis && iteration < 8; ++iteration)
+	{
+		f32 next[4] = {};
+		for (u32 row = 0; row < 4; ++row)
+		{
+			for (u32 column = 0; column < 4; ++column)
+			{
+				next[row] += covariance[row][column] * axis[column];
+			}
+		}
+		const f32 length = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+		has_axis = length > 1e-6f;
+		for (u32 channel = 0; has_axis && channel < 4; ++channel)
+		{
+			axis[channel] = next[channel] / length;
+		}
+	}
+
+	if (has_axis)
+	{
+		f32 min_projection = 1e30f;
+		f32 max_projection = -1e30f;
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			f32 projection = 0.0f;
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				projection += ((f32) in_texels[texel][channel] - mean[channel]) * axis[channel];
+			}
+			min_projection = std::min(min_projection, projection);
+			max_projection = std::max(max_projection, projection);
+		}
+		f32 e0[4];
+		f32 e1[4];
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			e0[channel] = mean[channel] + axis[channel] * min_projection;
+			e1[channel] = mean[channel] + axis[channel] * max_projection;
+		}
+		texture_bc7_try_endpoints(in_texels, e0, e1, best);
+
+		// Least squares endpoints for the current indices
+		for (u32 iteration = 0; iteration < 2; ++iteration)
+		{
+			f32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			f32 ax[4] = {}, bx[4] = {};
+			for (u32 texel = 0; texel < 16; ++texel)
+			{
+				const f32 t = (f32) TEXTURE_BC7_WEIGHTS_4[best.indices[texel]] / 64.0f;
+				const f32 s = 1.0f - t;
+				aa += s * s;
+				ab += s * t;
+				bb += t * t;
+				for (u32 channel = 0; channel < 4; ++channel)
+				{
+					ax[channel] += s * (f32) in_texels[texel][channel];
+					bx[channel] += t * (f32) in_texels[texel][channel];
+				}
+			}
+			const f32 determinant = aa * bb - ab * ab;
+			if (fabsf(determinant) < 1e-6f)
+			{
+				break;
+			}
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				e0[channel] = (bb * ax[channel] - ab * bx[channel]) / determinant;
+				e1[channel] = (aa * bx[channel] - ab * ax[channel]) / determinant;
+			}
+			texture_bc7_try_endpoints(in_texels, e0, e1, best);
+		}
+	}
+
+	// Texel 0's index is stored in 3 bits: keep its top bit clear
+	if (best.indices[0] >= 8)
+	{
+		std::swap(best.endpoints.color[0], best.endpoints.color[1]);
+		std::swap(best.endpoints.p_bits[0], best.endpoints.p_bits[1]);
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			best.indices[texel] = (u8) (15 - best.indices[texel]);
+		}
+	}
+
+	memset(out_block, 0, 16);
+	u32 bit = 0;
+	auto write_bits = [&](u32 in_value, u32 in_count)
+	{
+		for (u32 bit_index = 0; bit_index < in_count; ++bit_index, ++bit)
+		{
+			out_block[bit / 8] |= (u8) (((in_value >> bit_index) & 1) << (bit % 8));
+		}
+	};
+	write_bits(1u << 6, 7);	// mode 6
+	for (u32 channel = 0; channel < 4; ++channel)
+	{
+		write_bits(best.endpoints.color[0][channel], 7);
+		write_bits(best.endpoints.color[1][channel], 7);
+	}
+	write_bits(best.endpoints.p_bits[0], 1);
+	write_bits(best.endpoints.p_bits[1], 1);
+	write_bits(best.indices[0], 3);
+	for (u32 texel = 1; texel < 16; ++texel)
+	{
+		write_bits(best.indices[texel], 4);
+	}
+}
+
+// ---- Processing ----
+
+// Writes one quantized RGBA8 level in in_encoding at out_data. Partial
+// edge blocks repeat the last row/column.
+void texture_encode_level(
+	const u8* in_rgba,
+	const u32 in_width,
+	const u32 in_height,
+	const TextureEncoding in_encoding,
+	u8* out_data,
+	WorkerPool* in_workers)
+{
+	switch (in_encoding)
+	{
+		case TextureEncoding::RGBA8:
+		case TextureEncoding::RGBA8_SRGB:
+			memcpy(out_data, in_rgba, (size_t) in_width * in_height * 4);
+			return;
+		case TextureEncoding::R8:
+			for (size_t texel = 0; texel < (size_t) in_width * in_height; ++texel)
+			{
+				out_data[texel] = in_rgba[texel * 4];
+			}
+			return;
+		case TextureEncoding::BC7:
+		case TextureEncoding::BC7_SRGB:
+		case TextureEncoding::BC4:
+			break;
+	}
+
+	const u32 blocks_x = (in_width + 3) / 4;
+	const u32 blocks_y = (in_height + 3) / 4;
+	const u32 block_bytes = in_encoding == TextureEncoding::BC4 ? 8 : 16;
+	texture_parallel_for(in_workers, blocks_y, [&](u32 in_block_y)
+	{
+		for (u32 block_x = 0; block_x < blocks_x; ++block_x)
+		{
+			u8 texels[16][4];
+			for (u32 texel = 0; texel < 16; ++texel)
+			{
+				const u32 x = std::min(block_x * 4 + texel % 4, in_width - 1);
+				const u32 y = std::min(in_block_y * 4 + texel / 4, in_height - 1);
+				memcpy(texels[texel], in_rgba + ((size_t) y * in_width + x) * 4, 4);
+			}
+			u8* block = out_data + ((size_t) in_block_y * blocks_x + block_x) * block_bytes;
+			if (in_encoding == TextureEncoding::BC4)
+			{
+				u8 values[16];
+				for (u32 texel = 0; texel < 16; ++texel)
+				{
+					values[texel] = texels[texel][0];
+				}
+				texture_encode_bc4_block(values, block);
+			}
+			else
+			{
+				texture_encode_bc7_block(texels, block);
+			}
+		}
+	});
+}
+
+// Builds the full mip chain of a linear-encoded RGBA8 image in in_encoding.
+// in_workers may be nullptr (serial).
+void texture_process(
+	const u8* in_linear_rgba,
+	const u32 in_width,
+	const u32 in_height,
+	const TextureEncoding in_encoding,
+	ProcessedTexture& out_texture,
+	WorkerPool* in_workers)
+{
+	assert(in_width > 0 && in_height > 0);
+	out_texture.encoding = in_encoding;
+	out_texture.width = in_width;
+	out_texture.height = in_height;
+	out_texture.mip_count = texture_mip_count(in_width, in_height);
+	out_texture.data.reset();
+	out_texture.data.resize(texture_chain_bytes(in_encoding, in_width, in_height, out_texture.mip_count));
+
+	const bool srgb = texture_encoding_is_srgb(in_encoding);
+	u8 srgb_table[256];
+	for (u32 value = 0; value < 256; ++value)
+	{
+		srgb_table[value] = srgb ? texture_quantize(texture_linear_to_srgb((f32) value / 255.0f)) : (u8) value;
+	}
+
+	// Level 0 comes straight from the bytes; the rest from float levels
+	DynamicArray<u8> level_rgba;
+	level_rgba.resize((size_t) in_width * in_height * 4);
+	for (size_t texel = 0; texel < (size_t) in_width * in_height; ++texel)
+	{
+		for (u32 channel = 0; channel < 3; ++channel)
+		{
+			level_rgba[texel * 4 + channel] = srgb_table[in_linear_rgba[texel * 4 + channel]];
+		}
+		level_rgba[texel * 4 + 3] = in_linear_rgba[texel * 4 + 3];
+	}
+	u64 level_offset = 0;
+	texture_encode_level(level_rgba.data(), in_width, in_height, in_encoding, out_texture.data.data(), in_workers);
+	level_offset += texture_level_bytes(in_encoding, in_width, in_height);
+	if (out_texture.mip_count == 1)
+	{
+		return;
+	}
+
+	DynamicArray<f32> source_level;
+	source_level.resize((size_t) in_width * in_height * 4);
+	for (size_t value = 0; value < source_level.length(); ++value)
+	{
+		source_level[value] = (f32) in_linear_rgba[value] / 255.0f;
+	}
+	DynamicArray<f32> next_level;
+	u32 width = in_width;
+	u32 height = in_height;
+	for (u32 level = 1; level < out_texture.mip_count; ++level)
+	{
+		const u32 next_width = texture_mip_extent(in_width, level);
+		const u32 next_height = texture_mip_extent(in_height, level);
+		next_level.resize((size_t) next_width * next_height * 4);
+		texture_downsample(source_level.data(), width, height, next_level.data(), in_workers);
+
+		for (size_t texel = 0; texel < (size_t) next_width * next_height; ++texel)
+		{
+			for (u32 channel = 0; channel < 3; ++channel)
+			{
+				const f32 value = next_level[texel * 4 + channel];
+				level_rgba[texel * 4 + channel] = texture_quantize(srgb ? texture_linear_to_srgb(value) : value);
+			}
+			level_rgba[texel * 4 + 3] = texture_quantize(next_level[texel * 4 + 3]);
+		}
+		texture_encode_level(level_rgba.data(), next_width, next_height, in_encoding,
+			out_texture.data.data() + level_offset, in_workers);
+		level_offset += texture_level_bytes(in_encoding, next_width, next_height);
+
+		std::swap(source_level, next_level);
+		width = next_width;
+		height = next_height;
+	}
+	assert(level_offset == out_texture.data.length());
+}
+
+// ---- Texture cache ----
+// Processed images keyed by texture_cache_key, so re-sent pixels (a scene
+// reset, a re-link, a hash-only reference to an image the runtime dropped)
+// skip processing. Least recently used entries go once the budget is
+// exceeded. Owned by one thread.
+
+struct TextureCacheEntry
+{
+	ProcessedTexture texture;
+	u64 last_used = 0;
+};
+
+struct TextureCache
+{
+	ankerl::unordered_dense::map<u64, TextureCacheEntry> entries;
+	u64 use_counter = 0;
+	u64 byte_count = 0;
+	u64 budget_bytes = TEXTURE_CACHE_DEFAULT_BUDGET_BYTES;
+	u64 hits = 0;
+	u64 misses = 0;
+};
+
+const ProcessedTexture* texture_cache_find(TextureCache& io_cache, const u64 in_key)
+{
+	auto found = io_cache.entries.find(in_key);
+	if (found == io_cache.entries.end())
+	{
+		io_cache.misses += 1;
+		return nullptr;
+	}
+	found->second.last_used = ++io_cache.use_counter;
+	io_cache.hits += 1;
+	return &found->second.texture;
+}
+
+// Takes in_texture and evicts older entries past the budget (never the new
+// one). Returns the cached copy.
+const ProcessedTexture& texture_cache_insert(TextureCache& io_cache, const u64 in_key, ProcessedTexture&& in_texture)
+{
+	auto existing = io_cache.entries.find(in_key);
+	if (existing != io_cache.entries.end())
+	{
+		io_cache.byte_count -= existing->second.texture.data.length();
+		io_cache.entries.erase(existing);
+	}
+	io_cache.byte_count += in_texture.data.length();
+	io_cache.entries[in_key] = (TextureCacheEntry) {
+		.texture = std::move(in_texture),
+		.last_used = ++io_cache.use_counter,
+	};
+
+	while (io_cache.byte_count > io_cache.budget_bytes && io_cache.entries.size() > 1)
+	{
+		auto oldest = io_cache.entries.end();
+		for (auto entry = io_cache.entries.begin(); entry != io_cache.entries.end(); ++entry)
+		{
+			if (entry->first != in_key && (oldest == io_cache.entries.end() || entry->second.last_used < oldest->second.last_used))
+			{
+				oldest = entry;
+			}
+		}
+		io_cache.byte_count -= oldest->second.texture.data.length();
+		io_cache.entries.erase(oldest);
+	}
+	return io_cache.entries[in_key].texture;
+}
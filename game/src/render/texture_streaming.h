@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "render/texture_processing.h"
+
+// ---- Texture streaming ----
+// Keeps scene textures partially resident under a VRAM budget. The CPU keeps
+// every processed mip chain; the GPU holds each texture from its resident mip
+// down to the tail as one image, and a change of resident mip is a new image
+// built from the CPU chain that replaces the old one in its bindless slot
+// once its upload is done. Nothing here touches Vulkan.
+//
+// Demand comes from the geometry pass: for each bindless slot the fragment
+// shader atomicMin's floor(lod) + TEXTURE_FEEDBACK_LOD_BIAS into a buffer,
+// where lod is measured against the image that was bound. Adding the mip
+// that image starts at gives the finest full-chain level any pixel wanted.
+// Finer demand applies at once; coarser demand only after a whole window of
+// frames without the finer one, so a texture does not flicker between
+// levels while the camera moves.
+//
+// Each frame the planner resolves the wanted levels against the budget
+// (least recently sampled textures give up their finest level first, larger
+// levels before smaller ones), then issues evictions and stream-ins. A
+// request only goes out while resident + in-flight bytes stay within the
+// budget, so the old and new image of a swap are both counted.
+
+static constexpr u32 TEXTURE_FEEDBACK_UNSAMPLED = ~0u;
+static constexpr u32 TEXTURE_FEEDBACK_LOD_BIAS = 16;	// the shader stores floor(lod) + 16, clamped to [0, 31]
+static constexpr u8 TEXTURE_FEEDBACK_NOT_BOUND = 0xFF;	// bound mip of a slot showing the placeholder
+static constexpr u64 TEXTURE_STREAMING_NEVER = ~0ull;
+
+struct TextureResidency
+{
+	u32 width = 0;
+	u32 height = 0;
+	u32 mip_count = 0;
+	TextureEncoding encoding = TextureEncoding::RGBA8;
+	u32 tail_mip = 0;		// always resident from here down
+	u32 resident_mip = 0;	// first level of the image bound in the slot
+	u32 target_mip = 0;		// first level of the replacement in flight (== resident_mip when none)
+	u32 demand_mip = 0;		// finest level asked for in the current window
+	u32 window_mip = 0;		// finest level asked for in the previous window
+	u64 last_sampled_frame = TEXTURE_STREAMING_NEVER;
+	u64 demand_frame = TEXTURE_STREAMING_NEVER;	// first frame a level finer than resident was asked for
+	f64 demand_seconds = 0.0;
+};
+
+struct TextureStreamRequest
+{
+	u32 texture_index;
+	u32 first_mip;
+	u64 byte_count;
+};
+
+struct TextureStreamingStats
+{
+	u64 stream_in_count = 0;
+	u64 eviction_count = 0;
+	u64 peak_bytes = 0;				// resident + in flight
+	u64 over_budget_frames = 0;
+	u64 deferred_request_count = 0;	// stream-ins held back by the budget or the per-frame cap
+};
+
+struct TextureStreaming
+{
+	static constexpr u32 tail_size = 64;		// levels at or below this size are never evicted
+	static constexpr u64 window_frames = 30;
+	static constexpr u32 latency_sample_capacity = 256;
+
+	DynamicArray<TextureResidency> textures;
+	DynamicArray<u64> wanted_bytes;		// per texture, scratch for the planner
+	DynamicArray<u32> wanted_mips;
+	u64 resident_bytes = 0;
+	u64 pending_bytes = 0;
+	u64 budget_bytes = 0;
+	u64 window_start_frame = 0;
+
+	// Demand-to-bound latency of recent stream-ins, ring buffers
+	DynamicArray<f32> latency_frames;
+	DynamicArray<f32> latency_ms;
+	u32 latency_cursor = 0;
+
+	TextureStreamingStats stats;
+};
+
+void texture_streaming_reset(TextureStreaming& io_streaming)
+{
+	io_streaming.textures.reset();
+	io_streaming.resident_bytes = 0;
+	io_streaming.pending_bytes = 0;
+	io_streaming.window_start_frame = 0;
+	io_streaming.latency_frames.reset();
+	io_streaming.latency_ms.reset();
+	io_streaming.latency_cursor = 0;
+	io_streaming.stats = {};
+}
+
+// Bytes of the image holding levels [in_first_mip, mip_count)
+inline u64 texture_residency_bytes(const TextureResidency& in_texture, const u32 in_first_mip)
+{
+	return texture_chain_bytes(in_texture.encoding, in_texture.width, in_texture.height, in_texture.mip_count)
+		- texture_chain_bytes(in_texture.encoding, in_texture.width, in_texture.height, in_first_mip);
+}
+
+// Offset of in_first_mip in the tightly packed CPU chain
+inline u64 texture_residency_offset(const TextureResidency& in_texture, const u32 in_first_mip)
+{
+	return texture_chain_bytes(in_texture.encoding, in_texture.width, in_texture.height, in_first_mip);
+}
+
+// Tracks a new texture and returns the first mip of its initial upload: the
+// tail when streaming, the whole chain otherwise
+u32 texture_streaming_add(
+	TextureStreaming& io_streaming,
+	const u32 in_width,
+	const u32 in_height,
+	const u32 in_mip_count,
+	const TextureEncoding in_encoding,
+	const bool in_streaming)
+{
+	TextureResidency texture = {
+		.width = in_width,
+		.height = in_height,
+		.mip_count = std::max(in_mip_count, 1u),
+		.encoding = in_encoding,
+	};
+	if (in_streaming)
+	{
+		while (texture.tail_mip + 1 < texture.mip_count
+			&& std::max(texture_mip_extent(in_width, texture.tail_mip), texture_mip_extent(in_height, texture.tail_mip)) > TextureStreaming::tail_size)
+		{
+			texture.tail_mip += 1;
+		}
+	}
+	texture.resident_mip = texture.tail_mip;
+	texture.target_mip = texture.tail_mip;
+	texture.demand_mip = texture.tail_mip;
+	texture.window_mip = texture.tail_mip;
+
+	io_streaming.resident_bytes += texture_residency_bytes(texture, texture.tail_mip);
+	io_streaming.textures.add(texture);
+	return texture.tail_mip;
+}
+
+// Folds one frame of GPU feedback in. in_bound_mips[i] is the resident mip of
+// the image slot i showed when that frame was recorded.
+void texture_streaming_record_feedback(
+	TextureStreaming& io_streaming,
+	const u32* in_feedback,
+	const u8* in_bound_mips,
+	const u32 in_count,
+	const u64 in_frame,
+	const f64 in_seconds)
+{
+	const u32 count = std::min(in_count, (u32) io_streaming.textures.length());
+	for (u32 texture_index = 0; texture_index < count; ++texture_index)
+	{
+		if (in_feedback[texture_index] == TEXTURE_FEEDBACK_UNSAMPLED || in_bound_mips[texture_index] == TEXTURE_FEEDBACK_NOT_BOUND)
+		{
+			continue;
+		}
+
+		TextureResidency& texture = io_streaming.textures[texture_index];
+		const i32 level = (i32) in_bound_mips[texture_index] + (i32) in_feedback[texture_index] - (i32) TEXTURE_FEEDBACK_LOD_BIAS;
+		const u32 wanted = (u32) std::clamp(level, 0, (i32) texture.tail_mip);
+		texture.demand_mip = std::min(texture.demand_mip, wanted);
+		texture.last_sampled_frame = in_frame;
+		if (wanted < texture.resident_mip && texture.demand_frame == TEXTURE_STREAMING_NEVER)
+		{
+			texture.demand_frame = in_frame;
+			texture.demand_seconds = in_seconds;
+		}
+	}
+}
+
+inline u32 texture_residency_wanted_mip(const TextureResidency& in_texture)
+{
+	return std::min(in_texture.demand_mip, in_texture.window_mip);
+}
+
+// Resolves the wanted levels against in_budget_bytes and appends the uploads
+// to start this frame. Evictions go first (they free memory once swapped);
+// stream-ins follow, most recently sampled first, while they fit in the
+// budget and in in_frame_byte_limit (at least one per frame).
+void texture_streaming_plan(
+	TextureStreaming& io_streaming,
+	const u64 in_budget_bytes,
+	const u64 in_frame_byte_limit,
+	DynamicArray<TextureStreamRequest>& out_requests)
+{
+	out_requests.reset();
+	io_streaming.budget_bytes = in_budget_bytes;
+	const u32 texture_count = (u32) io_streaming.textures.length();
+	io_streaming.wanted_mips.resize(texture_count);
+	io_streaming.wanted_bytes.resize(texture_count);
+
+	u64 wanted_total = 0;
+	for (u32 texture_index = 0; texture_index < texture_count; ++texture_index)
+	{
+		const TextureResidency& texture = io_streaming.textures[texture_index];
+		io_streaming.wanted_mips[texture_index] = texture_residency_wanted_mip(texture);
+		io_streaming.wanted_bytes[texture_index] = texture_residency_bytes(texture, io_streaming.wanted_mips[texture_index]);
+		wanted_total += io_streaming.wanted_bytes[texture_index];
+	}
+
+	// Over budget: drop one level at a time from the least recently sampled
+	// texture (never-sampled ones first), largest level first on ties
+	while (wanted_total > in_budget_bytes)
+	{
+		i32 victim = -1;
+		u64 victim_frame = 0;
+		u64 victim_level_bytes = 0;
+		for (u32 texture_index = 0; texture_index < texture_count; ++texture_index)
+		{
+			const TextureResidency& texture = io_streaming.textures[texture_index];
+			const u32 wanted = io_streaming.wanted_mips[texture_index];
+			if (wanted >= texture.tail_mip)
+			{
+				continue;
+			}
+			const u64 sampled_frame = texture.last_sampled_frame == TEXTURE_STREAMING_NEVER ? 0 : texture.last_sampled_frame + 1;
+			const u64 level_bytes = texture_level_bytes(texture.encoding,
+				texture_mip_extent(texture.width, wanted), texture_mip_extent(texture.height, wanted));
+			if (victim < 0 || sampled_frame < victim_frame || (sampled_frame == victim_frame && level_bytes > victim_level_bytes))
+			{
+				victim = (i32) texture_index;
+				victim_frame = sampled_frame;
+				victim_level_bytes = level_bytes;
+			}
+		}
+		if (victim < 0)
+		{
+			break;	// every texture is at its tail
+		}
+		io_streaming.wanted_mips[victim] += 1;
+		io_streaming.wanted_bytes[victim] -= victim_level_bytes;
+		wanted_total -= victim_level_bytes;
+	}
+
+	// Evictions. One may overshoot the budget only when nothing else is in
+	// flight, so memory can always be reclaimed after the budget shrinks.
+	for (u32 texture_index = 0; texture_index < texture_count; ++texture_index)
+	{
+		TextureResidency& texture = io_streaming.textures[texture_index];
+		const u32 wanted = io_streaming.wanted_mips[texture_index];
+		if (texture.target_mip != texture.resident_mip || wanted <= texture.resident_mip)
+		{
+			continue;
+		}
+		const u64 bytes = io_streaming.wanted_bytes[texture_index];
+		const u64 allocated = io_streaming.resident_bytes + io_streaming.pending_bytes;
+		if (allocated + bytes > in_budget_bytes && io_streaming.pending_bytes > 0)
+		{
+			continue;
+		}
+		texture.target_mip = wanted;
+		io_streaming.pending_bytes += bytes;
+		out_requests.add((TextureStreamRequest) { .texture_index = texture_index, .first_mip = wanted, .byte_count = bytes });
+	}
+
+	// Stream-ins: one pass per candidate, best first
+	const u32 eviction_count = (u32) out_requests.length();
+	u64 frame_bytes = 0;
+	for (;;)
+	{
+		i32 best = -1;
+		for (u32 texture_index = 0; texture_index < texture_count; ++texture_index)
+		{
+			const TextureResidency& texture = io_streaming.textures[texture_index];
+			if (texture.target_mip != texture.resident_mip || io_streaming.wanted_mips[texture_index] >= texture.resident_mip)
+			{
+				continue;
+			}
+			if (best < 0)
+			{
+				best = (i32) texture_index;
+				continue;
+			}
+			const TextureResidency& best_texture = io_streaming.textures[best];
+			const u64 sampled = texture.last_sampled_frame == TEXTURE_STREAMING_NEVER ? 0 : texture.last_sampled_frame + 1;
+			const u64 best_sampled = best_texture.last_sampled_frame == TEXTURE_STREAMING_NEVER ? 0 : best_texture.last_sampled_frame + 1;
+			const u32 gap = texture.resident_mip - io_streaming.wanted_mips[texture_index];
+			const u32 best_gap = best_texture.resident_mip - io_streaming.wanted_mips[best];
+			if (sampled > best_sampled || (sampled == best_sampled && gap > best_gap))
+			{
+				best = (i32) texture_index;
+			}
+		}
+		if (best < 0)
+		{
+			break;
+		}
+
+		TextureResidency& texture = io_streaming.textures[best];
+		const u64 bytes = io_streaming.wanted_bytes[best];
+		const u64 allocated = io_streaming.resident_bytes + io_streaming.pending_bytes;
+		const bool first_of_frame = (u32) out_requests.length() == eviction_count;
+		if (allocated + bytes > in_budget_bytes || (!first_of_frame && frame_bytes + bytes > in_frame_byte_limit))
+		{
+			// Stop at the first that does not fit: it is the most wanted, and
+			// letting smaller ones past would starve it
+			io_streaming.stats.deferred_request_count += 1;
+			break;
+		}
+		texture.target_mip = io_streaming.wanted_mips[best];
+		io_streaming.pending_bytes += bytes;
+		frame_bytes += bytes;
+		out_requests.add((TextureStreamRequest) { .texture_index = (u32) best, .first_mip = texture.target_mip, .byte_count = bytes });
+	}
+}
+
+// The replacement for in_texture_index is bound from now on; the old image is
+// the caller's to retire
+void texture_streaming_complete(
+	TextureStreaming& io_streaming,
+	const u32 in_texture_index,
+	const u64 in_frame,
+	const f64 in_seconds)
+{
+	TextureResidency& texture = io_streaming.textures[in_texture_index];
+	const u64 old_bytes = texture_residency_bytes(texture, texture.resident_mip);
+	const u64 new_bytes = texture_residency_bytes(texture, texture.target_mip);
+	const bool stream_in = texture.target_mip < texture.resident_mip;
+	io_streaming.resident_bytes = io_streaming.resident_bytes - old_bytes + new_bytes;
+	io_streaming.pending_bytes -= new_bytes;
+	texture.resident_mip = texture.target_mip;
+
+	if (!stream_in)
+	{
+		io_streaming.stats.eviction_count += 1;
+		return;
+	}
+	io_streaming.stats.stream_in_count += 1;
+	if (texture.demand_frame != TEXTURE_STREAMING_NEVER)
+	{
+		const f32 frames = (f32) (in_frame - std::min(in_frame, texture.demand_frame));
+		const f32 ms = (f32) std::max(0.0, (in_seconds - texture.demand_seconds) * 1000.0);
+		if (io_streaming.latency_frames.length() < TextureStreaming::latency_sample_capacity)
+		{
+			io_streaming.latency_frames.add(frames);
+			io_streaming.latency_ms.add(ms);
+		}
+		else
+		{
+			io_streaming.latency_frames[io_streaming.latency_cursor] = frames;
+			io_streaming.latency_ms[io_streaming.latency_cursor] = ms;
+		}
+		io_streaming.latency_cursor = (io_streaming.latency_cursor + 1) % TextureStreaming::latency_sample_capacity;
+		texture.demand_frame = TEXTURE_STREAMING_NEVER;
+	}
+}
+
+// The replacement for in_texture_index was dropped (scene reset, failure)
+void texture_streaming_cancel(TextureStreaming& io_streaming, const u32 in_texture_index)
+{
+	TextureResidency& texture = io_streaming.textures[in_texture_index];
+	io_streaming.pending_bytes -= texture_residency_bytes(texture, texture.target_mip);
+	texture.target_mip = texture.resident_mip;
+}
+
+// Tracks the peak and rolls the demand window
+void texture_streaming_end_frame(TextureStreaming& io_streaming, const u64 in_frame)
+{
+	const u64 allocated = io_streaming.resident_bytes + io_streaming.pending_bytes;
+	io_streaming.stats.peak_bytes = std::max(io_streaming.stats.peak_bytes, allocated);
+	io_streaming.stats.over_budget_frames += allocated > io_streaming.budget_bytes ? 1 : 0;
+
+	if (in_frame < io_streaming.window_start_frame + TextureStreaming::window_frames)
+	{
+		return;
+	}
+	io_streaming.window_start_frame = in_frame;
+	for (TextureResidency& texture : io_streaming.textures)
+	{
+		texture.window_mip = texture.demand_mip;
+		texture.demand_mip = texture.tail_mip;
+		if (texture.window_mip >= texture.resident_mip)
+		{
+			texture.demand_frame = TEXTURE_STREAMING_NEVER;	// asked for nothing finer all window
+		}
+	}
+}
+
+// The budget the planner gets: the configured one, capped to 90% of what the
+// device heaps have left once everything but the textures is accounted for,
+// and never below what the tails need
+u64 texture_streaming_effective_budget(
+	const TextureStreaming& in_streaming,
+	const u64 in_configured_bytes,
+	const u64 in_heap_budget_bytes,
+	const u64 in_heap_usage_bytes)
+{
+	u64 budget = in_configured_bytes;
+	if (in_heap_budget_bytes > 0)
+	{
+		const u64 texture_bytes = in_streaming.resident_bytes + in_streaming.pending_bytes;
+		const u64 other_bytes = in_heap_usage_bytes - std::min(in_heap_usage_bytes, texture_bytes);
+		const u64 available = in_heap_budget_bytes > other_bytes ? in_heap_budget_bytes - other_bytes : 0;
+		budget = std::min(budget, available / 10 * 9);
+	}
+
+	u64 tail_bytes = 0;
+	for (const TextureResidency& texture : in_streaming.textures)
+	{
+		tail_bytes += texture_residency_bytes(texture, texture.tail_mip);
+	}
+	return std::max(budget, tail_bytes);
+}
+
+// in_percentile in [0, 1]; 0 for no samples
+f32 texture_streaming_percentile(const DynamicArray<f32>& in_samples, const f32 in_percentile)
+{
+	if (in_samples.empty())
+	{
+		return 0.0f;
+	}
+	DynamicArray<f32> sorted = in_samples;
+	std::sort(sorted.data(), sorted.data() + sorted.length());
+	const size_t index = std::min(sorted.length() - 1, (size_t) std::floor(in_percentile * (f32) (sorted.length() - 1) + 0.5f));
+	return sorted[index];
+}
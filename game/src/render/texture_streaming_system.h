@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/runtime_config.h"
+#include "core/timings.h"
+#include "render/frame_data.h"
+#include "render/imgui_layer.h"
+#include "render/texture_streaming.h"
+#include "render/vulkan_context.h"
+#include "state/state.h"
+
+// Main-thread side of texture streaming (render/texture_streaming.h): reads
+// back the geometry pass feedback, swaps finished replacements into their
+// bindless slots and starts the uploads the planner asks for.
+namespace TextureStreamingSystem
+{
+	static constexpr u64 DEFAULT_BUDGET_MB = 512;
+	static constexpr u64 FRAME_UPLOAD_BYTES = 16ull << 20;	// stream-in bytes started per frame
+
+	// Needs the geometry pass feedback, which needs fragmentStoresAndAtomics
+	inline bool enabled(const VulkanContext* ctx)
+	{
+		return ctx->texture_feedback_enabled && RuntimeConfig::get().texture_streaming.value_or(true);
+	}
+
+	inline u64 configured_budget_bytes()
+	{
+		const long budget_mb = RuntimeConfig::get().texture_budget_mb.value_or((long) DEFAULT_BUDGET_MB);
+		return (u64) std::max(budget_mb, 1l) << 20;
+	}
+
+	// Call after vulkan_context_begin_frame's fence wait and before
+	// frame_data_update
+	inline void begin_frame(State& in_state)
+	{
+		VulkanContext* ctx = &in_state.vk;
+		State::ImageState& images = in_state.images;
+		TextureStreaming& streaming = images.streaming;
+		const u64 frame = ctx->frame_number;
+		const f64 seconds = timings_ticks_to_ms(timings_now_ticks()) / 1000.0;
+
+		static u32 feedback[MAX_BINDLESS_IMAGES];
+		static u8 bound_mips[MAX_BINDLESS_IMAGES];
+		const i32 feedback_count = frame_data_take_texture_feedback(ctx, feedback, bound_mips);
+		if (!enabled(ctx) || streaming.textures.empty())
+		{
+			return;
+		}
+		texture_streaming_record_feedback(streaming, feedback, bound_mips, (u32) feedback_count, frame, seconds);
+
+		// Finished replacements take their slot; the old image retires with
+		// this frame slot, after the frames that may still sample it
+		for (u32 image_index = 0; image_index < (u32) images.items.length(); ++image_index)
+		{
+			GpuImage& replacement = images.replacements[image_index];
+			if (replacement.image == VK_NULL_HANDLE || !vulkan_upload_ready(ctx, images.replacement_tickets[image_index]))
+			{
+				continue;
+			}
+			ImGuiLayer::unregister_texture(images.items[image_index].view);
+			vulkan_context_retire_image(ctx, images.items[image_index]);
+			images.items[image_index] = replacement;
+			images.upload_tickets[image_index] = images.replacement_tickets[image_index];
+			replacement = {};
+			images.replacement_tickets[image_index] = 0;
+			images.first_mips[image_index] = (u8) streaming.textures[image_index].target_mip;
+			texture_streaming_complete(streaming, image_index, frame, seconds);
+		}
+
+		// Budget: the configured one within what VMA says the heaps have left
+		const VulkanMemoryStats memory = vulkan_context_get_memory_stats(ctx);
+		const u64 budget = texture_streaming_effective_budget(
+			streaming, configured_budget_bytes(), memory.budget_bytes, memory.usage_bytes);
+		texture_streaming_plan(streaming, budget, FRAME_UPLOAD_BYTES, images.stream_requests);
+		for (const TextureStreamRequest& request : images.stream_requests)
+		{
+			const TextureResidency& texture = streaming.textures[request.texture_index];
+			images.replacements[request.texture_index] = gpu_image_create_async(
+				ctx,
+				texture_mip_extent(texture.width, request.first_mip),
+				texture_mip_extent(texture.height, request.first_mip),
+				texture.mip_count - request.first_mip,
+				texture_encoding_vk_format(texture.encoding),
+				images.sources[request.texture_index] + texture_residency_offset(texture, request.first_mip),
+				request.byte_count,
+				"Streamed Image",
+				&images.replacement_tickets[request.texture_index]
+			);
+		}
+		texture_streaming_end_frame(streaming, frame);
+	}
+}
@@ -114,9 +114,10 @@ struct TonemappingPass
 	VkPipeline local_blend_pipeline = VK_NULL_HANDLE;
 	VkPipeline local_reconstruct_pipeline = VK_NULL_HANDLE;
 #if defined(WITH_DEBUG_UI) && WITH_DEBUG_UI
-	VkPipeline local_debug_laplacian_pipeline = VK_NULL_HANDLE;
-	VkPipeline local_debug_guided_pipeline = VK_NULL_HANDLE;
-	VkPipeline local_debug_channel_pipeline = VK_NULL_HANDLE;
+	// Debug views: built the first time one is shown
+	DeferredPipeline local_debug_laplacian_pipeline;
+	DeferredPipeline local_debug_guided_pipeline;
+	DeferredPipeline local_debug_channel_pipeline;
 #endif
 
 	GpuImage local_exposure_pyramid;
@@ -344,68 +345,68 @@ void tonemapping_pass_init(VulkanContext* ctx)
 	tonemapping_pass.local_pipeline_layout = tonemapping_create_pipeline_layout(
 		ctx, tonemapping_pass.local_set_layout, sizeof(TonemappingLocalProxyPushConstants));
 
-	tonemapping_pass.final_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	vulkan_create_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping.frag.spv",
 		.pipeline_layout = tonemapping_pass.final_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
+	}, &tonemapping_pass.final_pipeline);
 
 	VkFormat two_color_formats[2] = {
 		Render::SCENE_COLOR_FORMAT,
 		Render::SCENE_COLOR_FORMAT,
 	};
-	tonemapping_pass.local_proxy_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	vulkan_create_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_proxy.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = two_color_formats,
 		.color_format_count = 2,
-	});
-	tonemapping_pass.local_downsample_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	}, &tonemapping_pass.local_proxy_pipeline);
+	vulkan_create_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_downsample.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = two_color_formats,
 		.color_format_count = 2,
-	});
-	tonemapping_pass.local_blend_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	}, &tonemapping_pass.local_downsample_pipeline);
+	vulkan_create_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_blend.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
-	tonemapping_pass.local_reconstruct_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	}, &tonemapping_pass.local_blend_pipeline);
+	vulkan_create_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_reconstruct.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
+	}, &tonemapping_pass.local_reconstruct_pipeline);
 #if defined(WITH_DEBUG_UI) && WITH_DEBUG_UI
-	tonemapping_pass.local_debug_laplacian_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	vulkan_defer_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_debug_laplacian.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
-	tonemapping_pass.local_debug_guided_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	}, &tonemapping_pass.local_debug_laplacian_pipeline);
+	vulkan_defer_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_debug_guided.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
-	tonemapping_pass.local_debug_channel_pipeline = vulkan_create_fullscreen_pipeline(ctx, {
+	}, &tonemapping_pass.local_debug_guided_pipeline);
+	vulkan_defer_fullscreen_pipeline(ctx, {
 		.vertex_shader_path = "bin/shaders/tonemapping.vert.spv",
 		.fragment_shader_path = "bin/shaders/tonemapping_local_debug_channel.frag.spv",
 		.pipeline_layout = tonemapping_pass.local_pipeline_layout,
 		.color_formats = &Render::SCENE_COLOR_FORMAT,
 		.color_format_count = 1,
-	});
+	}, &tonemapping_pass.local_debug_channel_pipeline);
 #endif
 }
 
@@ -1080,7 +1081,7 @@ void tonemapping_pass_prepare_local_debug(
 		tonemapping_begin_mip_render(ctx, laplacian_output, 1, selected_mip);
 		tonemapping_draw_local_stage(
 			ctx,
-			tonemapping_pass.local_debug_laplacian_pipeline,
+			PipelineBuildService::resolve(ctx, tonemapping_pass.local_debug_laplacian_pipeline),
 			laplacian_set);
 		tonemapping_end_mip_render(ctx);
 	}
@@ -1140,7 +1141,7 @@ void tonemapping_pass_prepare_local_debug(
 	};
 	tonemapping_draw_local_stage(
 		ctx,
-		tonemapping_pass.local_debug_guided_pipeline,
+		PipelineBuildService::resolve(ctx, tonemapping_pass.local_debug_guided_pipeline),
 		guided_set,
 		&constants,
 		sizeof(constants));
@@ -1175,7 +1176,7 @@ void tonemapping_pass_prepare_local_debug(
 		};
 		tonemapping_draw_local_stage(
 			ctx,
-			tonemapping_pass.local_debug_channel_pipeline,
+			PipelineBuildService::resolve(ctx, tonemapping_pass.local_debug_channel_pipeline),
 			set,
 			&channel_constants,
 			sizeof(channel_constants));
@@ -1341,9 +1342,9 @@ void tonemapping_pass_shutdown(VulkanContext* ctx)
 		ctx->allocator, ctx->device, tonemapping_pass.local_debug_guided);
 	gpu_image_destroy(
 		ctx->allocator, ctx->device, tonemapping_pass.local_debug_panels);
-	vkDestroyPipeline(ctx->device, tonemapping_pass.local_debug_channel_pipeline, nullptr);
-	vkDestroyPipeline(ctx->device, tonemapping_pass.local_debug_guided_pipeline, nullptr);
-	vkDestroyPipeline(ctx->device, tonemapping_pass.local_debug_laplacian_pipeline, nullptr);
+	PipelineBuildService::destroy(ctx, tonemapping_pass.local_debug_channel_pipeline);
+	PipelineBuildService::destroy(ctx, tonemapping_pass.local_debug_guided_pipeline);
+	PipelineBuildService::destroy(ctx, tonemapping_pass.local_debug_laplacian_pipeline);
 #endif
 
 	vkDestroyPipeline(ctx->device, tonemapping_pass.local_reconstruct_pipeline, nullptr);
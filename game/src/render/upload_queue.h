@@ -0,0 +1,178 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/dynamic_array.h"
+
+// ---- Upload queue ----
+// Bookkeeping for the asynchronous upload engine in vulkan_context.h. Nothing
+// here touches Vulkan; the test drives it.
+//
+// Jobs are queued in FIFO order and numbered by a ticket. Once per frame the
+// longest prefix of the queue that fits the byte budget becomes one batch
+// (always at least one job, so an oversized asset still goes, alone). The
+// batch is submitted on the transfer queue and signals the next value of a
+// timeline semaphore. A queue runs its submissions in order, so batches
+// complete in order: when the semaphore reaches a batch's value, every job
+// up to that batch's last ticket has landed, and a ticket is ready once it
+// is <= completed_ticket. Ticket 0 means "nothing to wait for".
+
+static constexpr u32 UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT = 4;
+
+struct UploadQueueJob
+{
+	u64 ticket = 0;
+	u64 byte_count = 0;
+	u32 payload = 0;	// caller's index for whatever the job copies
+};
+
+struct UploadQueueBatch
+{
+	u64 timeline_value = 0;	// signalled when every job in the batch has landed
+	u64 byte_count = 0;
+	u32 slot = 0;			// per-batch resources (command buffer, staging) the caller owns
+	DynamicArray<UploadQueueJob> jobs;
+};
+
+struct UploadQueue
+{
+	DynamicArray<UploadQueueJob> pending;		// FIFO from pending_head
+	size_t pending_head = 0;
+	DynamicArray<UploadQueueBatch> in_flight;	// submission order
+	u64 next_ticket = 1;
+	u64 completed_ticket = 0;
+	u64 last_timeline_value = 0;	// value handed to the newest batch
+	u64 pending_bytes = 0;
+	u64 in_flight_bytes = 0;
+	u32 busy_slots = 0;				// bit per batch slot in flight
+};
+
+inline bool upload_queue_ready(const UploadQueue& in_queue, const u64 in_ticket)
+{
+	return in_ticket <= in_queue.completed_ticket;
+}
+
+inline size_t upload_queue_pending_count(const UploadQueue& in_queue)
+{
+	return in_queue.pending.length() - in_queue.pending_head;
+}
+
+inline bool upload_queue_idle(const UploadQueue& in_queue)
+{
+	return upload_queue_pending_count(in_queue) == 0 && in_queue.in_flight.empty();
+}
+
+// Queues a job and returns its ticket
+u64 upload_queue_push(UploadQueue& io_queue, const u64 in_byte_count, const u32 in_payload)
+{
+	const u64 ticket = io_queue.next_ticket++;
+	io_queue.pending.add((UploadQueueJob) {
+		.ticket = ticket,
+		.byte_count = in_byte_count,
+		.payload = in_payload,
+	});
+	io_queue.pending_bytes += in_byte_count;
+	return ticket;
+}
+
+// Drops a job that has not been taken into a batch yet (its target is being
+// destroyed). Returns false when the ticket is not pending.
+bool upload_queue_cancel(UploadQueue& io_queue, const u64 in_ticket)
+{
+	for (size_t job_index = io_queue.pending_head; job_index < io_queue.pending.length(); ++job_index)
+	{
+		if (io_queue.pending[job_index].ticket == in_ticket)
+		{
+			io_queue.pending_bytes -= io_queue.pending[job_index].byte_count;
+			for (size_t next_index = job_index + 1; next_index < io_queue.pending.length(); ++next_index)
+			{
+				io_queue.pending[next_index - 1] = io_queue.pending[next_index];
+			}
+			io_queue.pending.pop();
+			return true;
+		}
+	}
+	return false;
+}
+
+// Moves the FIFO prefix that fits in_budget_bytes into a new in-flight batch
+// and returns it, or nullptr when nothing is pending or every slot is busy.
+// The pointer is valid until the queue is next modified.
+UploadQueueBatch* upload_queue_take_batch(UploadQueue& io_queue, const u64 in_budget_bytes)
+{
+	if (upload_queue_pending_count(io_queue) == 0
+		|| io_queue.in_flight.length() >= UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT)
+	{
+		return nullptr;
+	}
+
+	u32 slot = 0;
+	while (io_queue.busy_slots & (1u << slot)) ++slot;
+	io_queue.busy_slots |= 1u << slot;
+
+	UploadQueueBatch batch = {
+		.timeline_value = ++io_queue.last_timeline_value,
+		.slot = slot,
+	};
+	while (io_queue.pending_head < io_queue.pending.length())
+	{
+		const UploadQueueJob& job = io_queue.pending[io_queue.pending_head];
+		if (!batch.jobs.empty() && batch.byte_count + job.byte_count > in_budget_bytes)
+		{
+			break;
+		}
+		batch.byte_count += job.byte_count;
+		batch.jobs.add(job);
+		io_queue.pending_head += 1;
+	}
+	io_queue.pending_bytes -= batch.byte_count;
+	io_queue.in_flight_bytes += batch.byte_count;
+
+	// Compact once the consumed prefix dominates so the FIFO stays bounded
+	if (io_queue.pending_head == io_queue.pending.length())
+	{
+		io_queue.pending.clear();
+		io_queue.pending_head = 0;
+	}
+	else if (io_queue.pending_head * 2 >= io_queue.pending.length())
+	{
+		for (size_t job_index = io_queue.pending_head; job_index < io_queue.pending.length(); ++job_index)
+		{
+			io_queue.pending[job_index - io_queue.pending_head] = io_queue.pending[job_index];
+		}
+		io_queue.pending.resize(io_queue.pending.length() - io_queue.pending_head);
+		io_queue.pending_head = 0;
+	}
+
+	io_queue.in_flight.add(std::move(batch));
+	return &io_queue.in_flight[io_queue.in_flight.length() - 1];
+}
+
+// Retires every batch whose timeline value in_completed_value has reached
+// (the semaphore's current value), oldest first, into out_completed so the
+// caller can recycle their slots' resources. Advances completed_ticket.
+void upload_queue_complete(UploadQueue& io_queue, const u64 in_completed_value, DynamicArray<UploadQueueBatch>& out_completed)
+{
+	out_completed.clear();
+	size_t completed_count = 0;
+	while (completed_count < io_queue.in_flight.length()
+		&& io_queue.in_flight[completed_count].timeline_value <= in_completed_value)
+	{
+		UploadQueueBatch& batch = io_queue.in_flight[completed_count];
+		if (!batch.jobs.empty())
+		{
+			io_queue.completed_ticket = batch.jobs[batch.jobs.length() - 1].ticket;
+		}
+		io_queue.in_flight_bytes -= batch.byte_count;
+		io_queue.busy_slots &= ~(1u << batch.slot);
+		out_completed.add(std::move(batch));
+		completed_count += 1;
+	}
+	if (completed_count > 0)
+	{
+		for (size_t batch_index = completed_count; batch_index < io_queue.in_flight.length(); ++batch_index)
+		{
+			io_queue.in_flight[batch_index - completed_count] = std::move(io_queue.in_flight[batch_index]);
+		}
+		io_queue.in_flight.resize(io_queue.in_flight.length() - completed_count);
+	}
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include "core/types.h"
+#include "render/vertex_types.h"
+
+// ---- Vertex quantization ----
+// CPU side of the compact vertex format. Every decode here matches what the
+// fixed-function vertex fetch plus geometry_compact.vert produce, so the
+// dequantized Vertex the CPU keeps (physics, picking, tessellation) is the
+// geometry the GPU draws:
+//  - position: R16G16B16A16_UNORM, min + unorm * extent
+//  - normal:   R16G16_SNORM octahedral (octahedral_helpers.h)
+//  - texcoord: R16G16_SFLOAT
+
+// Mesh-local AABB the unorm16 positions are relative to
+struct VertexQuantization
+{
+	HMM_Vec3 position_min = {};
+	HMM_Vec3 position_extent = {};
+};
+
+// 16-bit indices address at most this many vertices
+static constexpr u32 COMPACT_INDEX_MAX_VERTEX_COUNT = 65536;
+
+inline u16 quantize_unorm16(f32 in_value)
+{
+	const f32 clamped = in_value > 0.0f ? (in_value < 1.0f ? in_value : 1.0f) : 0.0f;
+	return (u16) lrintf(clamped * 65535.0f);
+}
+
+inline f32 dequantize_unorm16(u16 in_value)
+{
+	return (f32) in_value / 65535.0f;
+}
+
+inline i16 quantize_snorm16(f32 in_value)
+{
+	const f32 clamped = in_value > -1.0f ? (in_value < 1.0f ? in_value : 1.0f) : -1.0f;
+	return (i16) lrintf(clamped * 32767.0f);
+}
+
+// Vulkan SNORM rule: -32768 and -32767 both decode to -1
+inline f32 dequantize_snorm16(i16 in_value)
+{
+	const f32 value = (f32) in_value / 32767.0f;
+	return value > -1.0f ? value : -1.0f;
+}
+
+inline f32 octahedral_sign_not_zero(f32 in_value)
+{
+	return in_value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// Unit vector -> [-1, 1]^2. A zero vector encodes as +Z.
+inline HMM_Vec2 octahedral_encode(HMM_Vec3 in_normal)
+{
+	const f32 l1_norm = fabsf(in_normal.X) + fabsf(in_normal.Y) + fabsf(in_normal.Z);
+	if (l1_norm <= 0.0f)
+	{
+		return HMM_V2(0.0f, 0.0f);
+	}
+	HMM_Vec2 out_encoded = HMM_V2(in_normal.X / l1_norm, in_normal.Y / l1_norm);
+	if (in_normal.Z < 0.0f)
+	{
+		out_encoded = HMM_V2(
+			(1.0f - fabsf(out_encoded.Y)) * octahedral_sign_not_zero(out_encoded.X),
+			(1.0f - fabsf(out_encoded.X)) * octahedral_sign_not_zero(out_encoded.Y));
+	}
+	return out_encoded;
+}
+
+inline HMM_Vec3 octahedral_decode(HMM_Vec2 in_encoded)
+{
+	HMM_Vec3 decoded = HMM_V3(in_encoded.X, in_encoded.Y, 1.0f - fabsf(in_encoded.X) - fabsf(in_encoded.Y));
+	if (decoded.Z < 0.0f)
+	{
+		const f32 x = decoded.X;
+		decoded.X = (1.0f - fabsf(decoded.Y)) * octahedral_sign_not_zero(x);
+		decoded.Y = (1.0f - fabsf(x)) * octahedral_sign_not_zero(decoded.Y);
+	}
+	return HMM_NormV3(decoded);
+}
+
+// Round-to-nearest-even f32 -> IEEE binary16, with subnormals, inf and NaN
+inline u16 f32_to_half(f32 in_value)
+{
+	u32 bits;
+	memcpy(&bits, &in_value, sizeof(bits));
+	const u32 sign = (bits >> 16) & 0x8000u;
+	const u32 exponent = (bits >> 23) & 0xFFu;
+	u32 mantissa = bits & 0x7FFFFFu;
+
+	if (exponent == 0xFFu)
+	{
+		return (u16) (sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+	}
+
+	const i32 half_exponent = (i32) exponent - 127 + 15;
+	if (half_exponent >= 0x1F)
+	{
+		return (u16) (sign | 0x7C00u);
+	}
+	if (half_exponent <= 0)
+	{
+		if (half_exponent < -10)
+		{
+			return (u16) sign;
+		}
+		mantissa |= 0x800000u;
+		const u32 shift = (u32) (14 - half_exponent);
+		u32 half_mantissa = mantissa >> shift;
+		const u32 remainder = mantissa & ((1u << shift) - 1u);
+		const u32 halfway = 1u << (shift - 1u);
+		if (remainder > halfway || (remainder == halfway && (half_mantissa & 1u)))
+		{
+			half_mantissa += 1;
+		}
+		return (u16) (sign | half_mantissa);
+	}
+
+	u32 half = sign | ((u32) half_exponent << 10) | (mantissa >> 13);
+	const u32 remainder = mantissa & 0x1FFFu;
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+	{
+		// May carry into the exponent, which rounds up to the next power of
+		// two or to infinity as IEEE requires
+		half += 1;
+	}
+	return (u16) half;
+}
+
+inline f32 half_to_f32(u16 in_half)
+{
+	const u32 sign = ((u32) in_half & 0x8000u) << 16;
+	const u32 exponent = ((u32) in_half >> 10) & 0x1Fu;
+	const u32 mantissa = (u32) in_half & 0x3FFu;
+
+	u32 bits;
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			const f32 value = ldexpf((f32) mantissa, -24);
+			memcpy(&bits, &value, sizeof(bits));
+			bits |= sign;
+		}
+	}
+	else if (exponent == 0x1Fu)
+	{
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	f32 out_value;
+	memcpy(&out_value, &bits, sizeof(out_value));
+	return out_value;
+}
+
+inline VertexQuantization vertex_quantization_from_bounds(HMM_Vec3 in_min, HMM_Vec3 in_max)
+{
+	return (VertexQuantization) {
+		.position_min = in_min,
+		.position_extent = HMM_V3(
+			MAX(in_max.X - in_min.X, 0.0f),
+			MAX(in_max.Y - in_min.Y, 0.0f),
+			MAX(in_max.Z - in_min.Z, 0.0f)),
+	};
+}
+
+inline u16 quantize_position_axis(f32 in_value, f32 in_min, f32 in_extent)
+{
+	return in_extent > 0.0f ? quantize_unorm16((in_value - in_min) / in_extent) : 0;
+}
+
+inline CompactVertex vertex_quantize(const Vertex& in_vertex, const VertexQuantization& in_quantization)
+{
+	const HMM_Vec3& min = in_quantization.position_min;
+	const HMM_Vec3& extent = in_quantization.position_extent;
+	const HMM_Vec2 octahedral = octahedral_encode(in_vertex.normal.XYZ);
+	return (CompactVertex) {
+		.position = {
+			quantize_position_axis(in_vertex.position.X, min.X, extent.X),
+			quantize_position_axis(in_vertex.position.Y, min.Y, extent.Y),
+			quantize_position_axis(in_vertex.position.Z, min.Z, extent.Z),
+			0,
+		},
+		.normal = { quantize_snorm16(octahedral.X), quantize_snorm16(octahedral.Y) },
+		.texcoord = { f32_to_half(in_vertex.texcoord.X), f32_to_half(in_vertex.texcoord.Y) },
+	};
+}
+
+inline Vertex vertex_dequantize(const CompactVertex& in_vertex, const VertexQuantization& in_quantization)
+{
+	const HMM_Vec3& min = in_quantization.position_min;
+	const HMM_Vec3& extent = in_quantization.position_extent;
+	const HMM_Vec3 normal = octahedral_decode(HMM_V2(
+		dequantize_snorm16(in_vertex.normal[0]),
+		dequantize_snorm16(in_vertex.normal[1])));
+	return (Vertex) {
+		.position = HMM_V4(
+			min.X + dequantize_unorm16(in_vertex.position[0]) * extent.X,
+			min.Y + dequantize_unorm16(in_vertex.position[1]) * extent.Y,
+			min.Z + dequantize_unorm16(in_vertex.position[2]) * extent.Z,
+			1.0f),
+		.normal = HMM_V4V(normal, 0.0f),
+		.texcoord = HMM_V2(half_to_f32(in_vertex.texcoord[0]), half_to_f32(in_vertex.texcoord[1])),
+	};
+}
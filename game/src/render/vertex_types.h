@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/types.h"
+#include "handmade_math/HandmadeMath.h"
+
+// The flatbuffer parser and shader vertex input both require this 48-byte layout.
+struct Vertex
+{
+	HMM_Vec4 position;
+	HMM_Vec4 normal;
+	HMM_Vec2 texcoord;
+	f32 _padding[2];
+};
+static_assert(sizeof(Vertex) == 48, "Vertex must stay 48 bytes for flatbuffer and shader input compatibility");
+
+// Per-vertex skinning data (second vertex buffer for skinned draws)
+struct SkinnedVertex
+{
+	HMM_Vec4 joint_indices;
+	HMM_Vec4 joint_weights;
+};
+static_assert(sizeof(SkinnedVertex) == 32, "SkinnedVertex must match the skinned vertex input layout");
+
+// Quantized static-mesh vertex (16 bytes vs Vertex's 48): unorm16 position
+// relative to the mesh AABB (w unused), snorm16 octahedral normal and IEEE
+// half-float texcoord. Encode/decode in render/vertex_quantization.h; the
+// GPU input layout is in geometry_pass.h.
+struct CompactVertex
+{
+	u16 position[4];
+	i16 normal[2];
+	u16 texcoord[2];
+};
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must match the compact vertex input layout");
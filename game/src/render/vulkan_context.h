@@ -17,6 +17,8 @@
 #include "core/dynamic_array.h"
 #include "core/timings.h"
 #include "core/runtime_config.h"
+#include "render/texture_processing.h"
+#include "render/upload_queue.h"
 #include "shader_common.h"
 
 #define VK_CHECK(f)                                                                 \
@@ -37,9 +39,11 @@ static const u32 MAX_FRAMES_IN_FLIGHT = 2;
 
 // GPU timestamp queries: one pool per frame in flight; query 0/1 span the
 // frame, 2+2i / 3+2i bracket timed scope i (one per render pass today)
-static constexpr i32 MAX_GPU_TIMED_SCOPES = 48;	// main chain ~15 + GI capture passes
+static constexpr i32 MAX_GPU_TIMED_SCOPES = 80;	// main chain ~30 + up to 8 GI captures x 4 passes
 static constexpr i32 GPU_TIMESTAMP_QUERY_COUNT = 2 + 2 * MAX_GPU_TIMED_SCOPES;
 static constexpr u64 FRAME_STAGING_ARENA_SIZE = 64ull * 1024ull * 1024ull;
+static constexpr u64 UPLOAD_ENGINE_DEFAULT_FRAME_BUDGET = 32ull * 1024ull * 1024ull;
+static constexpr u64 UPLOAD_ENGINE_MIN_STAGING_SIZE = 8ull * 1024ull * 1024ull;
 
 enum class RetiredResourceType
 {
@@ -53,6 +57,7 @@ enum class RetiredResourceType
 	QueryPool,
 	Semaphore,
 	Fence,
+	Allocation,
 };
 
 // A typed retirement record. Composite image records own all views and the VMA
@@ -90,6 +95,68 @@ struct UploadArena
 	u64 peak_bytes = 0;
 };
 
+// ---- Upload engine ----
+// Asynchronous uploads for assets that may appear a few frames late (live-link
+// geometry and textures). Jobs copy their source bytes when queued; at the end
+// of each frame a budgeted batch is staged and submitted on the transfer queue
+// (render/upload_queue.h does the bookkeeping), signalling a timeline
+// semaphore. A later begin_frame sees the value, records the queue-family
+// acquire barriers and makes the frame's submit wait on it; from then on the
+// tickets read as ready. Without a dedicated transfer family (lavapipe, or
+// GAME2_TRANSFER_QUEUE=0) the same batches go to the graphics queue and no
+// ownership moves. Without timelineSemaphore they also go to the graphics
+// queue, each batch signalling its slot's fence instead; begin_frame polls
+// the fences in batch order and the frame submit has nothing to wait for.
+enum class UploadTargetType : u8
+{
+	Buffer,
+	Image,
+};
+
+struct UploadPayload
+{
+	UploadTargetType type = UploadTargetType::Buffer;
+	void* data = nullptr;	// copy of the source bytes, freed once staged
+	u64 byte_count = 0;
+	u64 ticket = 0;
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkPipelineStageFlags2 dst_stage = 0;	// first graphics-queue use, for the acquire
+	VkAccessFlags2 dst_access = 0;
+	VkImage image = VK_NULL_HANDLE;
+	VkExtent2D extent = {};	// mip 0
+	u32 mip_levels = 1;		// data holds every level, largest first, tightly packed
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	bool cancelled = false;	// target destroyed while the batch was in flight
+};
+
+// Resources of one in-flight batch, reused once it completes
+struct UploadBatchSlot
+{
+	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;	// only without timeline semaphores
+	UploadChunk staging;
+};
+
+// A target destroyed while an in-flight batch still writes it
+struct UploadDeferredRetirement
+{
+	u64 timeline_value = 0;
+	RetiredResource resource;
+};
+
+struct UploadEngine
+{
+	UploadQueue queue;
+	DynamicArray<UploadPayload> payloads;
+	DynamicArray<u32> free_payloads;
+	UploadBatchSlot slots[UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT];
+	DynamicArray<UploadQueueBatch> completed;
+	DynamicArray<UploadDeferredRetirement> deferred_retirements;
+	VkCommandPool command_pool = VK_NULL_HANDLE;
+	VkSemaphore timeline = VK_NULL_HANDLE;	// null without timelineSemaphore (slot fences instead)
+	u64 frame_budget_bytes = UPLOAD_ENGINE_DEFAULT_FRAME_BUDGET;
+};
+
 struct GpuTimestampFrameState
 {
 	i64 cpu_frame_index = -1;
@@ -106,6 +173,7 @@ struct FrameResources
 	VkQueryPool timestamp_pool = VK_NULL_HANDLE;
 	GpuTimestampFrameState timestamp_state;
 	UploadArena staging;
+	u64 upload_wait_value = 0;	// upload timeline value this frame's submit waits for (0 = none)
 	VkDescriptorPool transient_descriptor_pool = VK_NULL_HANDLE;
 	DynamicArray<RetiredResource> retirement_list;
 	u64 submission_serial = 0;
@@ -119,6 +187,7 @@ struct VulkanMetrics
 	u64 descriptor_writes = 0;
 	u64 descriptors_written = 0;
 	u64 draw_calls = 0;
+	u64 indirect_commands = 0;	// commands read by indirect draw calls
 	u64 dispatch_calls = 0;
 	u64 immediate_submit_count = 0;
 	u64 queue_wait_idle_count = 0;
@@ -129,8 +198,22 @@ struct VulkanMetrics
 	u64 upload_staging_grows = 0;
 	u64 upload_staging_spills = 0;
 	u64 upload_peak_frame_bytes = 0;
+	u64 upload_async_jobs = 0;			// queued on the upload engine
+	u64 upload_async_bytes = 0;			// submitted by the upload engine
+	u64 upload_async_batches = 0;
+	u64 upload_async_pending_jobs = 0;	// latest frame: queued or in flight
+	u64 upload_async_pending_bytes = 0;
 	u64 pipeline_count = 0;
 	f64 pipeline_creation_ms = 0.0;
+	u64 instancing_bytes_saved = 0;	// latest frame: mesh pool bytes linked duplicates did not need
+	u64 shadow_cascades_rendered = 0;
+	u64 shadow_cascades_cached = 0;	// cascade slices kept from an earlier frame
+	u64 barrier_batches = 0;		// vkCmdPipelineBarrier2 calls recorded into frames
+	u64 barriers = 0;				// memory, buffer and image barriers in those calls
+	u64 frame_barrier_batches = 0;	// latest frame
+	u64 frame_barriers = 0;
+	u64 transient_target_bytes = 0;	// transient render targets if each had its own allocation
+	u64 transient_heap_bytes = 0;	// the aliasing heaps that hold them instead
 };
 
 struct VulkanMemoryStats
@@ -147,6 +230,7 @@ struct QueueSelection
 {
 	u32 graphics_family = UINT32_MAX;
 	u32 present_family = UINT32_MAX;
+	u32 transfer_family = UINT32_MAX;	// TRANSFER without GRAPHICS, when the device has one
 	bool complete() const { return graphics_family != UINT32_MAX && present_family != UINT32_MAX; }
 	bool shared_family() const { return complete() && graphics_family == present_family; }
 };
@@ -179,6 +263,7 @@ struct VulkanCapabilities
 	bool swapchain_extension = false;
 	bool portability_subset_extension = false;
 	bool hdr_metadata_extension = false;
+	bool texture_compression_bc = false;	// textureCompressionBC + the BC7/BC4 formats imported textures use
 	bool compatible = false;
 	i32 score = -1;
 	VkSurfaceFormatKHR surface_format = {};
@@ -216,8 +301,13 @@ struct VulkanContext
 	VkDevice device = VK_NULL_HANDLE;
 	VkQueue graphics_queue = VK_NULL_HANDLE;
 	VkQueue present_queue = VK_NULL_HANDLE;
+	u32 transfer_queue_family_index = 0;
+	VkQueue transfer_queue = VK_NULL_HANDLE;	// graphics_queue when there is no dedicated family
+	bool dedicated_transfer_queue = false;
+	bool upload_timeline_enabled = false;	// upload batches signal a timeline semaphore, else slot fences
 	VmaAllocator allocator = VK_NULL_HANDLE;
 	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+	bool pipeline_cache_cold_start = false;	// set before init to ignore the saved cache (--benchmark-startup)
 	VkPhysicalDeviceProperties physical_device_properties = {};
 	VulkanCapabilities capabilities;
 	u64 shader_build_hash = 0;
@@ -225,6 +315,9 @@ struct VulkanContext
 	bool portability_enumeration_enabled = false;
 	bool swapchain_colorspace_enabled = false;
 	bool hdr_metadata_enabled = false;
+	bool draw_indirect_enabled = false;	// multiDrawIndirect + drawIndirectFirstInstance
+	bool texture_compression_bc_enabled = false;	// imported textures may be BC7/BC4 (texture_processing.h)
+	bool texture_feedback_enabled = false;	// the geometry pass writes texture streaming feedback (fragmentStoresAndAtomics)
 	bool screenshot_supported = false;
 	EDisplayOutputMode requested_output_mode = EDisplayOutputMode::SDR;
 	EDisplayOutputMode active_output_mode = EDisplayOutputMode::SDR;
@@ -241,6 +334,7 @@ struct VulkanContext
 	VkDescriptorPool persistent_descriptor_pool = VK_NULL_HANDLE;
 
 	FrameResources frames[MAX_FRAMES_IN_FLIGHT];
+	UploadEngine uploads;
 
 	// Per swapchain image (present can't wait on a per-frame semaphore safely)
 	DynamicArray<VkSemaphore> render_finished_semaphores;
@@ -282,12 +376,15 @@ inline VkCommandBuffer vulkan_current_command_buffer(VulkanContext* ctx)
 	return vulkan_current_frame(ctx).command_buffer;
 }
 
+// Records every barrier the usage needs (global, buffer and image) as one
+// dependency
 inline void vulkan_apply_pass_resource_usage(VulkanContext* ctx, const PassResourceUsage& in_usage)
 {
 	VkCommandBuffer command_buffer = vulkan_current_command_buffer(ctx);
+	DynamicArray<VkImageMemoryBarrier2> image_barriers;
 	if (!in_usage.images.empty())
 	{
-		gpu_image_apply_usages(command_buffer, in_usage.images.data(), (u32)in_usage.images.length());
+		gpu_image_collect_barriers(in_usage.images.data(), (u32)in_usage.images.length(), image_barriers);
 	}
 
 	DynamicArray<VkBufferMemoryBarrier2> barriers;
@@ -320,14 +417,18 @@ inline void vulkan_apply_pass_resource_usage(VulkanContext* ctx, const PassResou
 		state.offset = usage.offset;
 		state.size = usage.size;
 	}
-	if (!barriers.empty())
+	if (!in_usage.memory.empty() || !barriers.empty() || !image_barriers.empty())
 	{
 		VkDependencyInfo dependency = {
 			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = (u32)in_usage.memory.length(),
+			.pMemoryBarriers = in_usage.memory.data(),
 			.bufferMemoryBarrierCount = (u32)barriers.length(),
 			.pBufferMemoryBarriers = barriers.data(),
+			.imageMemoryBarrierCount = (u32)image_barriers.length(),
+			.pImageMemoryBarriers = image_barriers.data(),
 		};
-		vkCmdPipelineBarrier2(command_buffer, &dependency);
+		gpu_cmd_pipeline_barrier(command_buffer, dependency);
 	}
 }
 
@@ -592,6 +693,27 @@ void vulkan_update_descriptor_sets(
 	);
 }
 
+// Metrics and debug names for pipelines created against ctx->pipeline_cache,
+// including ones the pipeline build service created on worker threads
+void vulkan_record_created_pipelines(
+	VulkanContext* ctx,
+	VkPipelineBindPoint in_bind_point,
+	u32 in_count,
+	const VkPipeline* in_pipelines,
+	f64 in_creation_ms)
+{
+	ctx->metrics.pipeline_creation_ms += in_creation_ms;
+	ctx->metrics.pipeline_count += in_count;
+	for (u32 index = 0; in_pipelines && index < in_count; ++index)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "%s Pipeline %llu",
+			in_bind_point == VK_PIPELINE_BIND_POINT_COMPUTE ? "Compute" : "Graphics",
+			(unsigned long long)(ctx->metrics.pipeline_count - in_count + index));
+		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_PIPELINE, (u64)in_pipelines[index], name);
+	}
+}
+
 VkResult vulkan_create_graphics_pipelines(
 	VulkanContext* ctx,
 	u32 in_count,
@@ -601,14 +723,9 @@ VkResult vulkan_create_graphics_pipelines(
 	const auto start = std::chrono::steady_clock::now();
 	VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, in_count, in_infos, nullptr, out_pipelines);
 	const auto end = std::chrono::steady_clock::now();
-	ctx->metrics.pipeline_creation_ms += std::chrono::duration<f64, std::milli>(end - start).count();
-	ctx->metrics.pipeline_count += in_count;
-	for (u32 index = 0; result == VK_SUCCESS && index < in_count; ++index)
-	{
-		char name[64];
-		snprintf(name, sizeof(name), "Graphics Pipeline %llu", (unsigned long long)(ctx->metrics.pipeline_count - in_count + index));
-		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_PIPELINE, (u64)out_pipelines[index], name);
-	}
+	vulkan_record_created_pipelines(ctx, VK_PIPELINE_BIND_POINT_GRAPHICS, in_count,
+		result == VK_SUCCESS ? out_pipelines : nullptr,
+		std::chrono::duration<f64, std::milli>(end - start).count());
 	return result;
 }
 
@@ -621,14 +738,9 @@ VkResult vulkan_create_compute_pipelines(
 	const auto start = std::chrono::steady_clock::now();
 	VkResult result = vkCreateComputePipelines(ctx->device, ctx->pipeline_cache, in_count, in_infos, nullptr, out_pipelines);
 	const auto end = std::chrono::steady_clock::now();
-	ctx->metrics.pipeline_creation_ms += std::chrono::duration<f64, std::milli>(end - start).count();
-	ctx->metrics.pipeline_count += in_count;
-	for (u32 index = 0; result == VK_SUCCESS && index < in_count; ++index)
-	{
-		char name[64];
-		snprintf(name, sizeof(name), "Compute Pipeline %llu", (unsigned long long)(ctx->metrics.pipeline_count - in_count + index));
-		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_PIPELINE, (u64)out_pipelines[index], name);
-	}
+	vulkan_record_created_pipelines(ctx, VK_PIPELINE_BIND_POINT_COMPUTE, in_count,
+		result == VK_SUCCESS ? out_pipelines : nullptr,
+		std::chrono::duration<f64, std::milli>(end - start).count());
 	return result;
 }
 
@@ -644,6 +756,13 @@ void vulkan_cmd_draw_indexed(VulkanContext* ctx, u32 index_count, u32 instance_c
 	vkCmdDrawIndexed(vulkan_current_command_buffer(ctx), index_count, instance_count, first_index, vertex_offset, first_instance);
 }
 
+// Counts one draw call per vkCmdDrawIndexedIndirect*, not per command
+void vulkan_cmd_draw_indexed_indirect(VulkanContext* ctx, VkBuffer in_buffer, VkDeviceSize in_offset, u32 in_draw_count, u32 in_stride)
+{
+	ctx->metrics.draw_calls += 1;
+	vkCmdDrawIndexedIndirect(vulkan_current_command_buffer(ctx), in_buffer, in_offset, in_draw_count, in_stride);
+}
+
 void vulkan_cmd_dispatch(VulkanContext* ctx, u32 x, u32 y, u32 z)
 {
 	ctx->metrics.dispatch_calls += 1;
@@ -856,6 +975,17 @@ VulkanCapabilities vulkan_evaluate_device(VkPhysicalDevice in_device, VkSurfaceK
 			break;
 		}
 	}
+	// Copy-only families map to the DMA engines; prefer one without compute
+	for (u32 queue_index = 0; queue_index < queue_count; ++queue_index)
+	{
+		const VkQueueFlags flags = queues[queue_index].queueFlags;
+		if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT) || queues[queue_index].queueCount == 0)
+			continue;
+		if (result.queues.transfer_family == UINT32_MAX || !(flags & VK_QUEUE_COMPUTE_BIT))
+			result.queues.transfer_family = queue_index;
+		if (!(flags & VK_QUEUE_COMPUTE_BIT))
+			break;
+	}
 
 	u32 format_count = 0;
 	vkGetPhysicalDeviceSurfaceFormatsKHR(in_device, in_surface, &format_count, nullptr);
@@ -897,6 +1027,13 @@ VulkanCapabilities vulkan_evaluate_device(VkPhysicalDevice in_device, VkSurfaceK
 	result.shadow_moments_format = vulkan_choose_format(in_device, color_16_candidates, 2, color_features | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
 	result.ssao_format = vulkan_choose_format(in_device, ssao_candidates, 2, color_features | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
 
+	const VkFormatFeatureFlags2 uploaded_texture_features =
+		VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_2_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_2_TRANSFER_DST_BIT;
+	result.texture_compression_bc = result.features.textureCompressionBC
+		&& vulkan_format_supports(in_device, VK_FORMAT_BC7_UNORM_BLOCK, uploaded_texture_features)
+		&& vulkan_format_supports(in_device, VK_FORMAT_BC7_SRGB_BLOCK, uploaded_texture_features)
+		&& vulkan_format_supports(in_device, VK_FORMAT_BC4_UNORM_BLOCK, uploaded_texture_features);
+
 	if (VK_API_VERSION_MAJOR(result.properties.apiVersion) < 1 ||
 		(VK_API_VERSION_MAJOR(result.properties.apiVersion) == 1 && VK_API_VERSION_MINOR(result.properties.apiVersion) < 3))
 		vulkan_append_rejection(result.rejection_reason, sizeof(result.rejection_reason), "Vulkan 1.3 required");
@@ -981,8 +1118,12 @@ void vulkan_context_create_pipeline_cache(VulkanContext* ctx)
 {
 	ctx->shader_build_hash = vulkan_shader_build_hash();
 	DynamicArray<u8> initial_data;
-	std::ifstream input(vulkan_pipeline_cache_path(), std::ios::binary);
-	if (input)
+	std::ifstream input;
+	if (!ctx->pipeline_cache_cold_start)
+	{
+		input.open(vulkan_pipeline_cache_path(), std::ios::binary);
+	}
+	if (input.is_open())
 	{
 		PipelineCacheFileHeader header = {};
 		input.read((char*)&header, sizeof(header));
@@ -1340,8 +1481,30 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		g_vulkan_debug_utils_enabled = ctx->debug_utils_enabled;
 		if (ctx->debug_utils_enabled) instance_extensions.add(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
+		// GAME2_SYNC_VALIDATION=1 adds the layer's synchronization validation
+		// (hazards between passes, aliased transient targets included)
+		const VkValidationFeatureEnableEXT sync_validation_feature = VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT;
+		VkValidationFeaturesEXT validation_features = {
+			.sType = VK_STRUCTURE_TYPE_VALIDATION_FEATURES_EXT,
+			.enabledValidationFeatureCount = 1,
+			.pEnabledValidationFeatures = &sync_validation_feature,
+		};
+		bool sync_validation = false;
+		if (enabled_layer_count > 0 && RuntimeConfig::get().sync_validation)
+		{
+			u32 layer_extension_count = 0;
+			vkEnumerateInstanceExtensionProperties(validation_layers[0], &layer_extension_count, nullptr);
+			DynamicArray<VkExtensionProperties> layer_extensions;
+			layer_extensions.resize(layer_extension_count);
+			vkEnumerateInstanceExtensionProperties(validation_layers[0], &layer_extension_count, layer_extensions.data());
+			sync_validation = vulkan_has_extension(layer_extensions, VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+			if (sync_validation) instance_extensions.add(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+			printf("Synchronization validation: %s\n", sync_validation ? "enabled" : "unavailable (no VK_EXT_validation_features)");
+		}
+
 		VkInstanceCreateInfo instance_create_info = {
 			.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+			.pNext = sync_validation ? &validation_features : nullptr,
 			.flags = instance_create_flags,
 			.pApplicationInfo = &app_info,
 			.enabledLayerCount = enabled_layer_count,
@@ -1413,6 +1576,15 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		ctx->present_mode = ctx->capabilities.present_mode;
 		ctx->graphics_queue_family_index = ctx->capabilities.queues.graphics_family;
 		ctx->present_queue_family_index = ctx->capabilities.queues.present_family;
+		// Optional: timeline semaphores. Without them uploads complete through
+		// per-batch fences, which only the graphics queue can order against
+		// the frames that use them.
+		ctx->upload_timeline_enabled = ctx->capabilities.features_1_2.timelineSemaphore;
+		ctx->dedicated_transfer_queue = ctx->capabilities.queues.transfer_family != UINT32_MAX
+			&& ctx->upload_timeline_enabled
+			&& RuntimeConfig::get().transfer_queue.value_or(true);
+		ctx->transfer_queue_family_index = ctx->dedicated_transfer_queue
+			? ctx->capabilities.queues.transfer_family : ctx->graphics_queue_family_index;
 		const VkPresentModeKHR requested_present_mode = vulkan_requested_present_mode();
 		if (ctx->present_mode != requested_present_mode)
 		{
@@ -1449,7 +1621,7 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 	// Logical device + queue
 	{
 		f32 queue_priority = 1.0f;
-		VkDeviceQueueCreateInfo queue_create_infos[2] = {{
+		VkDeviceQueueCreateInfo queue_create_infos[3] = {{
 			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 			.queueFamilyIndex = ctx->graphics_queue_family_index,
 			.queueCount = 1,
@@ -1466,6 +1638,15 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 			};
 			queue_create_info_count = 2;
 		}
+		if (ctx->dedicated_transfer_queue)
+		{
+			queue_create_infos[queue_create_info_count++] = (VkDeviceQueueCreateInfo) {
+				.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+				.queueFamilyIndex = ctx->transfer_queue_family_index,
+				.queueCount = 1,
+				.pQueuePriorities = &queue_priority,
+			};
+		}
 
 		DynamicArray<const char*> device_extensions;
 		device_extensions.add(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
@@ -1474,10 +1655,25 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		if (ctx->capabilities.hdr_metadata_extension)
 			device_extensions.add(VK_EXT_HDR_METADATA_EXTENSION_NAME);
 
+		// Optional: the indirect geometry path (render/indirect_draw.h) needs
+		// multi-draw with a non-zero firstInstance
+		const bool draw_indirect_supported = ctx->capabilities.features.multiDrawIndirect
+			&& ctx->capabilities.features.drawIndirectFirstInstance;
+
+		// Optional: block-compressed imported textures. GAME2_TEXTURE_COMPRESSION=0
+		// keeps them uncompressed for comparisons.
+		const bool texture_compression_bc = ctx->capabilities.texture_compression_bc
+			&& RuntimeConfig::get().texture_compression.value_or(true);
+
+		// Optional: texture streaming feedback from the geometry pass. Without
+		// fragment stores every imported chain is uploaded whole.
+		const bool texture_feedback = ctx->capabilities.features.fragmentStoresAndAtomics;
+
 		VkPhysicalDeviceVulkan12Features enabled_features_1_2 = {
 			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
 			.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
 			.descriptorBindingPartiallyBound = VK_TRUE,
+			.timelineSemaphore = ctx->upload_timeline_enabled ? VK_TRUE : VK_FALSE,
 		};
 
 		VkPhysicalDeviceVulkan13Features enabled_features_1_3 = {
@@ -1490,6 +1686,11 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		};
 		VkPhysicalDeviceFeatures enabled_features = {
 			.independentBlend = VK_TRUE,
+			.multiDrawIndirect = draw_indirect_supported ? VK_TRUE : VK_FALSE,
+			.drawIndirectFirstInstance = draw_indirect_supported ? VK_TRUE : VK_FALSE,
+			.textureCompressionBC = texture_compression_bc ? VK_TRUE : VK_FALSE,
+			// The geometry pass writes texture streaming feedback
+			.fragmentStoresAndAtomics = texture_feedback ? VK_TRUE : VK_FALSE,
 		};
 
 		VkDeviceCreateInfo device_create_info = {
@@ -1506,11 +1707,30 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		volkLoadDevice(ctx->device);
 		ctx->hdr_metadata_enabled = ctx->capabilities.hdr_metadata_extension && vkSetHdrMetadataEXT != nullptr;
 		printf("HDR metadata: %s\n", ctx->hdr_metadata_enabled ? "VK_EXT_hdr_metadata enabled" : "unavailable");
+		ctx->draw_indirect_enabled = draw_indirect_supported;
+		printf("Indirect draws: %s\n", draw_indirect_supported ? "multi-draw" : "unavailable");
+		ctx->texture_compression_bc_enabled = texture_compression_bc;
+		ctx->texture_feedback_enabled = texture_feedback;
+		printf("Texture streaming feedback: %s\n", texture_feedback ? "enabled" : "unavailable (no fragmentStoresAndAtomics)");
+		printf("Texture compression: %s\n", texture_compression_bc ? "BC7/BC4"
+			: ctx->capabilities.texture_compression_bc ? "disabled" : "unavailable");
 		vkGetDeviceQueue(ctx->device, ctx->graphics_queue_family_index, 0, &ctx->graphics_queue);
 		vkGetDeviceQueue(ctx->device, ctx->present_queue_family_index, 0, &ctx->present_queue);
 		vulkan_set_object_name(ctx, VK_OBJECT_TYPE_QUEUE, (u64)ctx->graphics_queue, "Graphics Queue");
 		if (ctx->present_queue != ctx->graphics_queue)
 			vulkan_set_object_name(ctx, VK_OBJECT_TYPE_QUEUE, (u64)ctx->present_queue, "Present Queue");
+		if (ctx->dedicated_transfer_queue)
+		{
+			vkGetDeviceQueue(ctx->device, ctx->transfer_queue_family_index, 0, &ctx->transfer_queue);
+			vulkan_set_object_name(ctx, VK_OBJECT_TYPE_QUEUE, (u64)ctx->transfer_queue, "Transfer Queue");
+			printf("Uploads: dedicated transfer queue family %u\n", ctx->transfer_queue_family_index);
+		}
+		else
+		{
+			ctx->transfer_queue = ctx->graphics_queue;
+			printf("Uploads: graphics queue (%s)\n", !ctx->upload_timeline_enabled ? "no timelineSemaphore, fences"
+				: ctx->capabilities.queues.transfer_family == UINT32_MAX ? "no dedicated transfer family" : "GAME2_TRANSFER_QUEUE=0");
+		}
 	}
 
 	vulkan_context_create_pipeline_cache(ctx);
@@ -1599,6 +1819,68 @@ void vulkan_context_init(VulkanContext* ctx, GLFWwindow* in_window)
 		}
 	}
 
+	// Upload engine: a command pool on the transfer family, one command buffer
+	// per batch slot, and the timeline semaphore batches signal (or, without
+	// timeline semaphores, one fence per slot)
+	{
+		UploadEngine& uploads = ctx->uploads;
+		VkCommandPoolCreateInfo command_pool_create_info = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+			.queueFamilyIndex = ctx->transfer_queue_family_index,
+		};
+		VK_CHECK(vkCreateCommandPool(ctx->device, &command_pool_create_info, nullptr, &uploads.command_pool));
+
+		VkCommandBufferAllocateInfo command_buffer_allocate_info = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = uploads.command_pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT,
+		};
+		VkCommandBuffer command_buffers[UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT] = {};
+		VK_CHECK(vkAllocateCommandBuffers(ctx->device, &command_buffer_allocate_info, command_buffers));
+		for (u32 slot_idx = 0; slot_idx < UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT; ++slot_idx)
+		{
+			uploads.slots[slot_idx].command_buffer = command_buffers[slot_idx];
+			char command_name[64];
+			snprintf(command_name, sizeof(command_name), "Upload Batch %u Command Buffer", slot_idx);
+			vulkan_set_object_name(ctx, VK_OBJECT_TYPE_COMMAND_BUFFER, (u64)command_buffers[slot_idx], command_name);
+		}
+
+		if (ctx->upload_timeline_enabled)
+		{
+			VkSemaphoreTypeCreateInfo timeline_create_info = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				.initialValue = 0,
+			};
+			VkSemaphoreCreateInfo semaphore_create_info = {
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+				.pNext = &timeline_create_info,
+			};
+			VK_CHECK(vkCreateSemaphore(ctx->device, &semaphore_create_info, nullptr, &uploads.timeline));
+			vulkan_set_object_name(ctx, VK_OBJECT_TYPE_SEMAPHORE, (u64)uploads.timeline, "Upload Timeline");
+		}
+		else
+		{
+			VkFenceCreateInfo fence_create_info = {
+				.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			};
+			for (u32 slot_idx = 0; slot_idx < UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT; ++slot_idx)
+			{
+				VK_CHECK(vkCreateFence(ctx->device, &fence_create_info, nullptr, &uploads.slots[slot_idx].fence));
+				char fence_name[64];
+				snprintf(fence_name, sizeof(fence_name), "Upload Batch %u Fence", slot_idx);
+				vulkan_set_object_name(ctx, VK_OBJECT_TYPE_FENCE, (u64)uploads.slots[slot_idx].fence, fence_name);
+			}
+		}
+
+		if (const std::optional<long> budget_mb = RuntimeConfig::get().upload_budget_mb)
+		{
+			uploads.frame_budget_bytes = (u64)MAX(*budget_mb, 1l) * 1024ull * 1024ull;
+		}
+	}
+
 	// Long-lived descriptor sets share a persistent arena. Transient
 	// per-dispatch/per-draw sets use the resettable pool in each frame slot.
 	{
@@ -1872,35 +2154,94 @@ UploadReservation vulkan_upload_reserve(VulkanContext* ctx, u64 in_size, u64 in_
 	return vulkan_upload_reserve(ctx, in_size, in_alignment);
 }
 
-void vulkan_upload_record_buffer(
+// One source range copied to in_dst_offset of the target buffer
+struct VulkanUploadRegion
+{
+	const void* data = nullptr;
+	u64 dst_offset = 0;
+	u64 size = 0;
+};
+
+// Stages every region in one arena reservation and records a single
+// multi-region copy. A buffer the GPU already reads (tracked in
+// buffer_states) gets a barrier before the copy as well as after, so
+// partial rewrites of a persistent buffer wait for earlier frames' reads.
+void vulkan_upload_record_buffer_regions(
 	VulkanContext* ctx,
 	VkBuffer in_target,
-	const void* in_data,
-	u64 in_size,
+	const VulkanUploadRegion* in_regions,
+	u32 in_region_count,
 	VkPipelineStageFlags2 in_dst_stage,
 	VkAccessFlags2 in_dst_access
 )
 {
-	assert(in_target && in_data && in_size > 0);
+	assert(in_target && in_regions && in_region_count > 0);
 	FrameResources& frame = vulkan_current_frame(ctx);
 	const bool first_request = frame.staging.bytes_used == 0;
-	UploadReservation reservation = vulkan_upload_reserve(ctx, in_size, 16);
-	memcpy(reservation.mapped_data, in_data, in_size);
+
+	u64 staging_size = 0;
+	u64 payload_size = 0;
+	u64 dst_begin = UINT64_MAX;
+	u64 dst_end = 0;
+	for (u32 region_idx = 0; region_idx < in_region_count; ++region_idx)
+	{
+		const VulkanUploadRegion& region = in_regions[region_idx];
+		assert(region.data && region.size > 0);
+		staging_size = vulkan_align_up(staging_size, 16) + region.size;
+		payload_size += region.size;
+		dst_begin = MIN(dst_begin, region.dst_offset);
+		dst_end = MAX(dst_end, region.dst_offset + region.size);
+	}
+
+	UploadReservation reservation = vulkan_upload_reserve(ctx, staging_size, 16);
+	DynamicArray<VkBufferCopy> copies;
+	copies.reserve(in_region_count);
+	u64 staging_offset = 0;
+	for (u32 region_idx = 0; region_idx < in_region_count; ++region_idx)
+	{
+		const VulkanUploadRegion& region = in_regions[region_idx];
+		staging_offset = vulkan_align_up(staging_offset, 16);
+		memcpy((u8*)reservation.mapped_data + staging_offset, region.data, region.size);
+		copies.add({
+			.srcOffset = reservation.offset + staging_offset,
+			.dstOffset = region.dst_offset,
+			.size = region.size,
+		});
+		staging_offset += region.size;
+	}
 	for (UploadChunk& chunk : frame.staging.chunks)
 	{
 		if (chunk.buffer == reservation.buffer)
 		{
-			VK_CHECK(vmaFlushAllocation(ctx->allocator, chunk.allocation, reservation.offset, in_size));
+			VK_CHECK(vmaFlushAllocation(ctx->allocator, chunk.allocation, reservation.offset, staging_size));
 			break;
 		}
 	}
 
-	VkBufferCopy copy = {
-		.srcOffset = reservation.offset,
-		.dstOffset = 0,
-		.size = in_size,
-	};
-	vkCmdCopyBuffer(frame.command_buffer, reservation.buffer, in_target, 1, &copy);
+	auto tracked = ctx->buffer_states.find(in_target);
+	if (tracked != ctx->buffer_states.end() && tracked->second.access != 0)
+	{
+		VkBufferMemoryBarrier2 barrier = {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+			.srcStageMask = tracked->second.stage,
+			.srcAccessMask = tracked->second.access,
+			.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+			.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.buffer = in_target,
+			.offset = dst_begin,
+			.size = dst_end - dst_begin,
+		};
+		VkDependencyInfo dependency = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount = 1,
+			.pBufferMemoryBarriers = &barrier,
+		};
+		gpu_cmd_pipeline_barrier(frame.command_buffer, dependency);
+	}
+
+	vkCmdCopyBuffer(frame.command_buffer, reservation.buffer, in_target, (u32)copies.length(), copies.data());
 
 	VkBufferMemoryBarrier2 barrier = {
 		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
@@ -1911,27 +2252,44 @@ void vulkan_upload_record_buffer(
 		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.buffer = in_target,
-		.offset = 0,
-		.size = in_size,
+		.offset = dst_begin,
+		.size = dst_end - dst_begin,
 	};
 	VkDependencyInfo dependency = {
 		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
 		.bufferMemoryBarrierCount = 1,
 		.pBufferMemoryBarriers = &barrier,
 	};
-	vkCmdPipelineBarrier2(frame.command_buffer, &dependency);
+	gpu_cmd_pipeline_barrier(frame.command_buffer, dependency);
 	ctx->buffer_states[in_target] = {
 		.stage = in_dst_stage,
 		.access = in_dst_access,
-		.offset = 0,
-		.size = in_size,
+		.offset = dst_begin,
+		.size = dst_end - dst_begin,
 	};
 
 	ctx->metrics.upload_requests += 1;
-	ctx->metrics.upload_bytes += in_size;
+	ctx->metrics.upload_bytes += payload_size;
 	if (first_request) ctx->metrics.upload_batches += 1;
 }
 
+void vulkan_upload_record_buffer(
+	VulkanContext* ctx,
+	VkBuffer in_target,
+	const void* in_data,
+	u64 in_size,
+	VkPipelineStageFlags2 in_dst_stage,
+	VkAccessFlags2 in_dst_access
+)
+{
+	const VulkanUploadRegion region = {
+		.data = in_data,
+		.dst_offset = 0,
+		.size = in_size,
+	};
+	vulkan_upload_record_buffer_regions(ctx, in_target, &region, 1, in_dst_stage, in_dst_access);
+}
+
 // Records and submits a one-shot command buffer, waiting for completion.
 // Main-thread only; retained for startup/debug operations before frame
 // recording begins. Steady-state uploads use the current FrameResources arena.
@@ -2102,11 +2460,21 @@ void vulkan_context_destroy_retired_resource(VulkanContext* ctx, RetiredResource
 		case RetiredResourceType::Fence:
 			if (in_resource.fence) vkDestroyFence(ctx->device, in_resource.fence, nullptr);
 			break;
+		case RetiredResourceType::Allocation:
+			if (in_resource.allocation) vmaFreeMemory(ctx->allocator, in_resource.allocation);
+			break;
 	}
 }
 
+bool vulkan_upload_adopt_retired(VulkanContext* ctx, RetiredResource& io_resource);
+
 void vulkan_context_retire(VulkanContext* ctx, RetiredResource&& in_resource)
 {
+	if (vulkan_upload_adopt_retired(ctx, in_resource))
+	{
+		return;
+	}
+
 	FrameResources* target = nullptr;
 	if (vulkan_current_frame(ctx).recording)
 	{
@@ -2154,6 +2522,18 @@ void vulkan_context_retire_image(VulkanContext* ctx, GpuImage& in_image)
 	in_image.generation = gpu_image_next_generation();
 }
 
+// Memory with no buffer or image of its own, such as a heap transient render
+// targets alias into. Retire the images bound to it first.
+void vulkan_context_retire_allocation(VulkanContext* ctx, VmaAllocation& io_allocation)
+{
+	if (io_allocation == VK_NULL_HANDLE) return;
+	vulkan_context_retire(ctx, {
+		.type = RetiredResourceType::Allocation,
+		.allocation = io_allocation,
+	});
+	io_allocation = VK_NULL_HANDLE;
+}
+
 void vulkan_context_flush_retirement(FrameResources& in_frame, VulkanContext* ctx)
 {
 	for (RetiredResource& resource : in_frame.retirement_list)
@@ -2182,6 +2562,570 @@ void vulkan_context_flush_all_retirement(VulkanContext* ctx)
 	}
 }
 
+// ---- Upload engine ----
+
+inline bool vulkan_upload_ready(const VulkanContext* ctx, u64 in_ticket)
+{
+	return upload_queue_ready(ctx->uploads.queue, in_ticket);
+}
+
+u32 vulkan_upload_allocate_payload(UploadEngine& io_uploads)
+{
+	if (!io_uploads.free_payloads.empty())
+	{
+		const u32 payload_index = io_uploads.free_payloads.last();
+		io_uploads.free_payloads.pop();
+		return payload_index;
+	}
+	io_uploads.payloads.add({});
+	return (u32)io_uploads.payloads.length() - 1;
+}
+
+void vulkan_upload_release_payload(UploadEngine& io_uploads, u32 in_payload_index)
+{
+	UploadPayload& payload = io_uploads.payloads[in_payload_index];
+	free(payload.data);
+	payload = {};
+	io_uploads.free_payloads.add(in_payload_index);
+}
+
+// Copies in_data (the caller may free it right away) and queues the job
+u64 vulkan_upload_push(VulkanContext* ctx, const UploadPayload& in_payload, const void* in_data)
+{
+	assert(in_data && in_payload.byte_count > 0);
+	UploadEngine& uploads = ctx->uploads;
+	const u32 payload_index = vulkan_upload_allocate_payload(uploads);
+	UploadPayload& payload = uploads.payloads[payload_index];
+	payload = in_payload;
+	payload.data = malloc(in_payload.byte_count);
+	memcpy(payload.data, in_data, in_payload.byte_count);
+	payload.ticket = upload_queue_push(uploads.queue, payload.byte_count, payload_index);
+	ctx->metrics.upload_async_jobs += 1;
+	return payload.ticket;
+}
+
+// Queues the initial contents of a new device-local buffer. in_dst_stage /
+// in_dst_access describe its first graphics-queue use. Nothing may read the
+// buffer before vulkan_upload_ready(ticket).
+u64 vulkan_upload_queue_buffer(
+	VulkanContext* ctx,
+	VkBuffer in_target,
+	const void* in_data,
+	u64 in_size,
+	VkPipelineStageFlags2 in_dst_stage,
+	VkAccessFlags2 in_dst_access
+)
+{
+	assert(in_target);
+	return vulkan_upload_push(ctx, (UploadPayload) {
+		.type = UploadTargetType::Buffer,
+		.byte_count = in_size,
+		.buffer = in_target,
+		.dst_stage = in_dst_stage,
+		.dst_access = in_dst_access,
+	}, in_data);
+}
+
+VkFormat texture_encoding_vk_format(TextureEncoding in_encoding)
+{
+	switch (in_encoding)
+	{
+		case TextureEncoding::RGBA8: return VK_FORMAT_R8G8B8A8_UNORM;
+		case TextureEncoding::RGBA8_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+		case TextureEncoding::R8: return VK_FORMAT_R8_UNORM;
+		case TextureEncoding::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case TextureEncoding::BC7_SRGB: return VK_FORMAT_BC7_SRGB_BLOCK;
+		case TextureEncoding::BC4: return VK_FORMAT_BC4_UNORM_BLOCK;
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+// Tightly packed bytes of one level of an uploaded image
+u64 vulkan_image_level_bytes(VkFormat in_format, u32 in_width, u32 in_height)
+{
+	const u64 block_count = (u64)((in_width + 3) / 4) * ((in_height + 3) / 4);
+	switch (in_format)
+	{
+		case VK_FORMAT_R8_UNORM: return (u64)in_width * in_height;
+		case VK_FORMAT_BC4_UNORM_BLOCK: return block_count * 8;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK: return block_count * 16;
+		default:
+			assert(in_format == VK_FORMAT_R8G8B8A8_UNORM || in_format == VK_FORMAT_R8G8B8A8_SRGB);
+			return (u64)in_width * in_height * 4;
+	}
+}
+
+// Staging bytes of a payload: image levels each start 16-byte aligned (a
+// texel block, and the 4 bytes a transfer-only queue needs for R8 levels)
+u64 vulkan_upload_staged_bytes(const UploadPayload& in_payload)
+{
+	if (in_payload.type != UploadTargetType::Image || in_payload.mip_levels <= 1)
+	{
+		return in_payload.byte_count;
+	}
+	u64 staged_bytes = 0;
+	for (u32 level = 0; level < in_payload.mip_levels; ++level)
+	{
+		staged_bytes = vulkan_align_up(staged_bytes, 16) + vulkan_image_level_bytes(in_payload.format,
+			MAX(in_payload.extent.width >> level, 1u), MAX(in_payload.extent.height >> level, 1u));
+	}
+	return staged_bytes;
+}
+
+// gpu_image_create_from_data without the wait: the pixels (in_mip_levels
+// levels, largest first, tightly packed) go through the upload engine. The
+// image must not be sampled before vulkan_upload_ready(*out_ticket); from
+// then on every level is SHADER_READ_ONLY.
+GpuImage gpu_image_create_async(
+	VulkanContext* ctx,
+	u32 in_width,
+	u32 in_height,
+	u32 in_mip_levels,
+	VkFormat in_format,
+	const void* in_pixels,
+	u64 in_byte_count,
+	const char* in_label,
+	u64* out_ticket
+)
+{
+	GpuImage image = gpu_image_create(ctx->allocator, ctx->device, (GpuImageDesc) {
+		.width = in_width,
+		.height = in_height,
+		.mip_levels = in_mip_levels,
+		.format = in_format,
+		.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		.aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+		.label = in_label,
+	});
+
+	// The upload's barriers are recorded outside gpu_image_transition; track
+	// the state they leave behind
+	for (u32 level = 0; level < in_mip_levels; ++level)
+	{
+		GpuImage::ImageSubresourceState& state =
+			image.subresource_states[gpu_image_state_index(image, VK_IMAGE_ASPECT_COLOR_BIT, level, 0)];
+		gpu_image_layout_sync_info(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, &state.stage, &state.access);
+		state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+
+	const UploadPayload payload = {
+		.type = UploadTargetType::Image,
+		.byte_count = in_byte_count,
+		.image = image.image,
+		.extent = { in_width, in_height },
+		.mip_levels = in_mip_levels,
+		.format = in_format,
+	};
+#ifndef NDEBUG
+	u64 expected_bytes = 0;
+	for (u32 level = 0; level < in_mip_levels; ++level)
+	{
+		expected_bytes += vulkan_image_level_bytes(in_format, MAX(in_width >> level, 1u), MAX(in_height >> level, 1u));
+	}
+	assert(expected_bytes == in_byte_count);
+#endif
+	*out_ticket = vulkan_upload_push(ctx, payload, in_pixels);
+	return image;
+}
+
+// Hands an upload target from the transfer family to the graphics family.
+// The release half follows the copy on the transfer queue, the acquire half
+// opens the frame that first sees the batch complete; the image's layout
+// change is part of both. Without a dedicated family only the release half
+// is used, as a plain layout transition.
+VkImageMemoryBarrier2 vulkan_upload_image_barrier(const VulkanContext* ctx, const UploadPayload& in_payload, bool in_acquire)
+{
+	const bool transfer_ownership = ctx->dedicated_transfer_queue;
+	return (VkImageMemoryBarrier2) {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		.srcStageMask = in_acquire ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+		.srcAccessMask = in_acquire ? VK_ACCESS_2_NONE : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = in_acquire
+			? VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+			: transfer_ownership ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		.dstAccessMask = in_acquire ? VK_ACCESS_2_SHADER_SAMPLED_READ_BIT : VK_ACCESS_2_NONE,
+		.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		.srcQueueFamilyIndex = transfer_ownership ? ctx->transfer_queue_family_index : VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = transfer_ownership ? ctx->graphics_queue_family_index : VK_QUEUE_FAMILY_IGNORED,
+		.image = in_payload.image,
+		.subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = in_payload.mip_levels,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		},
+	};
+}
+
+// Buffers only need the ownership transfer; same-family uploads are covered
+// by the frame's wait on the upload timeline
+VkBufferMemoryBarrier2 vulkan_upload_buffer_barrier(const VulkanContext* ctx, const UploadPayload& in_payload, bool in_acquire)
+{
+	return (VkBufferMemoryBarrier2) {
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+		.srcStageMask = in_acquire ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+		.srcAccessMask = in_acquire ? VK_ACCESS_2_NONE : VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = in_acquire ? in_payload.dst_stage : VK_PIPELINE_STAGE_2_NONE,
+		.dstAccessMask = in_acquire ? in_payload.dst_access : VK_ACCESS_2_NONE,
+		.srcQueueFamilyIndex = ctx->transfer_queue_family_index,
+		.dstQueueFamilyIndex = ctx->graphics_queue_family_index,
+		.buffer = in_payload.buffer,
+		.offset = 0,
+		.size = VK_WHOLE_SIZE,
+	};
+}
+
+// Called for every retirement. Queued jobs for the resource are dropped; if
+// an in-flight batch still writes it, the engine keeps the resource (returns
+// true) and retires it once that batch completes.
+bool vulkan_upload_adopt_retired(VulkanContext* ctx, RetiredResource& io_resource)
+{
+	UploadEngine& uploads = ctx->uploads;
+	if (upload_queue_idle(uploads.queue)
+		|| (io_resource.type != RetiredResourceType::Buffer && io_resource.type != RetiredResourceType::Image))
+	{
+		return false;
+	}
+	auto targets_resource = [&](const UploadPayload& in_payload)
+	{
+		return io_resource.type == RetiredResourceType::Buffer
+			? in_payload.type == UploadTargetType::Buffer && in_payload.buffer == io_resource.buffer
+			: in_payload.type == UploadTargetType::Image && in_payload.image == io_resource.image;
+	};
+
+	UploadQueue& queue = uploads.queue;
+	for (size_t job_index = queue.pending_head; job_index < queue.pending.length();)
+	{
+		const UploadQueueJob job = queue.pending[job_index];
+		if (targets_resource(uploads.payloads[job.payload]))
+		{
+			upload_queue_cancel(queue, job.ticket);
+			vulkan_upload_release_payload(uploads, job.payload);
+			continue;
+		}
+		++job_index;
+	}
+
+	u64 last_write_value = 0;
+	for (const UploadQueueBatch& batch : queue.in_flight)
+	{
+		for (const UploadQueueJob& job : batch.jobs)
+		{
+			UploadPayload& payload = uploads.payloads[job.payload];
+			if (targets_resource(payload))
+			{
+				payload.cancelled = true;
+				last_write_value = batch.timeline_value;
+			}
+		}
+	}
+	if (last_write_value == 0)
+	{
+		return false;
+	}
+	uploads.deferred_retirements.add((UploadDeferredRetirement) {
+		.timeline_value = last_write_value,
+		.resource = std::move(io_resource),
+	});
+	return true;
+}
+
+// Picks up batches the transfer queue has finished: records their acquires
+// into this frame's command buffer, makes this frame's submit wait for them,
+// and frees what they held. Called by begin_frame once recording.
+void vulkan_upload_engine_begin_frame(VulkanContext* ctx)
+{
+	UploadEngine& uploads = ctx->uploads;
+	FrameResources& frame = vulkan_current_frame(ctx);
+	frame.upload_wait_value = 0;
+	if (uploads.queue.in_flight.empty())
+	{
+		return;
+	}
+
+	u64 completed_value = 0;
+	if (ctx->upload_timeline_enabled)
+	{
+		VK_CHECK(vkGetSemaphoreCounterValue(ctx->device, uploads.timeline, &completed_value));
+	}
+	else
+	{
+		// Batches complete in submission order on the one queue
+		for (const UploadQueueBatch& batch : uploads.queue.in_flight)
+		{
+			if (vkGetFenceStatus(ctx->device, uploads.slots[batch.slot].fence) != VK_SUCCESS) break;
+			completed_value = batch.timeline_value;
+		}
+	}
+	upload_queue_complete(uploads.queue, completed_value, uploads.completed);
+	if (uploads.completed.empty())
+	{
+		return;
+	}
+
+	DynamicArray<VkBufferMemoryBarrier2> buffer_barriers;
+	DynamicArray<VkImageMemoryBarrier2> image_barriers;
+	for (const UploadQueueBatch& batch : uploads.completed)
+	{
+		// A signalled fence was already seen on the host, so there is nothing to wait for
+		if (ctx->upload_timeline_enabled) frame.upload_wait_value = batch.timeline_value;
+		for (const UploadQueueJob& job : batch.jobs)
+		{
+			const UploadPayload& payload = uploads.payloads[job.payload];
+			if (ctx->dedicated_transfer_queue && !payload.cancelled)
+			{
+				if (payload.type == UploadTargetType::Buffer)
+					buffer_barriers.add(vulkan_upload_buffer_barrier(ctx, payload, /*in_acquire*/ true));
+				else
+					image_barriers.add(vulkan_upload_image_barrier(ctx, payload, /*in_acquire*/ true));
+			}
+			vulkan_upload_release_payload(uploads, job.payload);
+		}
+	}
+	// Fence-completed batches ran earlier on this queue; with no semaphore
+	// wait, one barrier makes their copies visible to the frame
+	const VkMemoryBarrier2 fence_upload_barrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT,
+	};
+	const bool fence_upload_visibility = !ctx->upload_timeline_enabled;
+	if (!buffer_barriers.empty() || !image_barriers.empty() || fence_upload_visibility)
+	{
+		VkDependencyInfo dependency = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.memoryBarrierCount = fence_upload_visibility ? 1u : 0u,
+			.pMemoryBarriers = &fence_upload_barrier,
+			.bufferMemoryBarrierCount = (u32)buffer_barriers.length(),
+			.pBufferMemoryBarriers = buffer_barriers.data(),
+			.imageMemoryBarrierCount = (u32)image_barriers.length(),
+			.pImageMemoryBarriers = image_barriers.data(),
+		};
+		gpu_cmd_pipeline_barrier(frame.command_buffer, dependency);
+	}
+
+	// Targets destroyed mid-flight go through normal retirement now
+	for (size_t retirement_index = 0; retirement_index < uploads.deferred_retirements.length();)
+	{
+		UploadDeferredRetirement& deferred = uploads.deferred_retirements[retirement_index];
+		if (deferred.timeline_value > completed_value)
+		{
+			++retirement_index;
+			continue;
+		}
+		RetiredResource resource = std::move(deferred.resource);
+		if (retirement_index + 1 < uploads.deferred_retirements.length())
+		{
+			deferred = std::move(uploads.deferred_retirements.last());
+		}
+		uploads.deferred_retirements.pop();
+		vulkan_context_retire(ctx, std::move(resource));
+	}
+}
+
+// Stages the next batch that fits the frame budget and submits it on the
+// transfer queue, signalling its upload timeline value. Called by end_frame.
+void vulkan_upload_engine_submit(VulkanContext* ctx)
+{
+	UploadEngine& uploads = ctx->uploads;
+	if (UploadQueueBatch* batch = upload_queue_take_batch(uploads.queue, uploads.frame_budget_bytes))
+	{
+		const u64 copy_alignment = MAX(
+			(u64)ctx->physical_device_properties.limits.optimalBufferCopyOffsetAlignment,
+			MAX((u64)ctx->physical_device_properties.limits.nonCoherentAtomSize, 16ull)
+		);
+		u64 staging_size = 0;
+		for (const UploadQueueJob& job : batch->jobs)
+		{
+			staging_size = vulkan_align_up(staging_size, copy_alignment) + vulkan_upload_staged_bytes(uploads.payloads[job.payload]);
+		}
+
+		// The slot's previous batch has completed, so its staging is free
+		UploadBatchSlot& slot = uploads.slots[batch->slot];
+		if (slot.staging.size < staging_size)
+		{
+			if (slot.staging.buffer) vmaDestroyBuffer(ctx->allocator, slot.staging.buffer, slot.staging.allocation);
+			u64 chunk_size = UPLOAD_ENGINE_MIN_STAGING_SIZE;
+			while (chunk_size < staging_size) chunk_size *= 2;
+			slot.staging = vulkan_create_upload_chunk(ctx, chunk_size, "Upload Engine Staging");
+			ctx->metrics.upload_staging_grows += 1;
+		}
+
+		VK_CHECK(vkResetCommandBuffer(slot.command_buffer, 0));
+		VkCommandBufferBeginInfo begin_info = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		};
+		VK_CHECK(vkBeginCommandBuffer(slot.command_buffer, &begin_info));
+
+		// New images: UNDEFINED -> TRANSFER_DST (contents are replaced)
+		DynamicArray<VkImageMemoryBarrier2> image_barriers;
+		for (const UploadQueueJob& job : batch->jobs)
+		{
+			const UploadPayload& payload = uploads.payloads[job.payload];
+			if (payload.type != UploadTargetType::Image) continue;
+			VkImageMemoryBarrier2 barrier = vulkan_upload_image_barrier(ctx, payload, /*in_acquire*/ false);
+			barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+			barrier.srcAccessMask = VK_ACCESS_2_NONE;
+			barrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+			barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			image_barriers.add(barrier);
+		}
+		if (!image_barriers.empty())
+		{
+			VkDependencyInfo dependency = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.imageMemoryBarrierCount = (u32)image_barriers.length(),
+				.pImageMemoryBarriers = image_barriers.data(),
+			};
+			vkCmdPipelineBarrier2(slot.command_buffer, &dependency);
+		}
+
+		u64 staging_offset = 0;
+		for (const UploadQueueJob& job : batch->jobs)
+		{
+			UploadPayload& payload = uploads.payloads[job.payload];
+			staging_offset = vulkan_align_up(staging_offset, copy_alignment);
+			if (payload.type == UploadTargetType::Buffer)
+			{
+				memcpy((u8*)slot.staging.mapped_data + staging_offset, payload.data, payload.byte_count);
+				const VkBufferCopy copy_region = {
+					.srcOffset = staging_offset,
+					.dstOffset = 0,
+					.size = payload.byte_count,
+				};
+				vkCmdCopyBuffer(slot.command_buffer, slot.staging.buffer, payload.buffer, 1, &copy_region);
+				staging_offset += payload.byte_count;
+			}
+			else
+			{
+				// One region per level; levels are packed in the payload and
+				// re-aligned in staging
+				DynamicArray<VkBufferImageCopy> copy_regions;
+				u64 source_offset = 0;
+				for (u32 level = 0; level < payload.mip_levels; ++level)
+				{
+					const u32 level_width = MAX(payload.extent.width >> level, 1u);
+					const u32 level_height = MAX(payload.extent.height >> level, 1u);
+					const u64 level_bytes = payload.mip_levels > 1
+						? vulkan_image_level_bytes(payload.format, level_width, level_height)
+						: payload.byte_count;
+					if (level > 0) staging_offset = vulkan_align_up(staging_offset, 16);
+					memcpy((u8*)slot.staging.mapped_data + staging_offset, (const u8*)payload.data + source_offset, level_bytes);
+					copy_regions.add((VkBufferImageCopy) {
+						.bufferOffset = staging_offset,
+						.imageSubresource = {
+							.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+							.mipLevel = level,
+							.baseArrayLayer = 0,
+							.layerCount = 1,
+						},
+						.imageOffset = { 0, 0, 0 },
+						.imageExtent = { level_width, level_height, 1 },
+					});
+					source_offset += level_bytes;
+					staging_offset += level_bytes;
+				}
+				vkCmdCopyBufferToImage(slot.command_buffer, slot.staging.buffer, payload.image,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (u32)copy_regions.length(), copy_regions.data());
+			}
+			free(payload.data);
+			payload.data = nullptr;
+		}
+		VK_CHECK(vmaFlushAllocation(ctx->allocator, slot.staging.allocation, 0, staging_size));
+
+		// Release to the graphics family (or just the final layout)
+		image_barriers.clear();
+		DynamicArray<VkBufferMemoryBarrier2> buffer_barriers;
+		for (const UploadQueueJob& job : batch->jobs)
+		{
+			const UploadPayload& payload = uploads.payloads[job.payload];
+			if (payload.type == UploadTargetType::Image)
+				image_barriers.add(vulkan_upload_image_barrier(ctx, payload, /*in_acquire*/ false));
+			else if (ctx->dedicated_transfer_queue)
+				buffer_barriers.add(vulkan_upload_buffer_barrier(ctx, payload, /*in_acquire*/ false));
+		}
+		if (!image_barriers.empty() || !buffer_barriers.empty())
+		{
+			VkDependencyInfo dependency = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.bufferMemoryBarrierCount = (u32)buffer_barriers.length(),
+				.pBufferMemoryBarriers = buffer_barriers.data(),
+				.imageMemoryBarrierCount = (u32)image_barriers.length(),
+				.pImageMemoryBarriers = image_barriers.data(),
+			};
+			vkCmdPipelineBarrier2(slot.command_buffer, &dependency);
+		}
+		VK_CHECK(vkEndCommandBuffer(slot.command_buffer));
+
+		VkSemaphoreSubmitInfo signal_info = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = uploads.timeline,
+			.value = batch->timeline_value,
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		};
+		if (slot.fence)
+		{
+			VK_CHECK(vkResetFences(ctx->device, 1, &slot.fence));
+		}
+		VkCommandBufferSubmitInfo command_buffer_info = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer = slot.command_buffer,
+		};
+		VkSubmitInfo2 submit_info = {
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.commandBufferInfoCount = 1,
+			.pCommandBufferInfos = &command_buffer_info,
+			.signalSemaphoreInfoCount = ctx->upload_timeline_enabled ? 1u : 0u,
+			.pSignalSemaphoreInfos = &signal_info,
+		};
+		VK_CHECK(vkQueueSubmit2(ctx->transfer_queue, 1, &submit_info, slot.fence));
+		ctx->metrics.upload_async_bytes += batch->byte_count;
+		ctx->metrics.upload_async_batches += 1;
+	}
+
+	u64 in_flight_jobs = 0;
+	for (const UploadQueueBatch& batch : uploads.queue.in_flight) in_flight_jobs += batch.jobs.length();
+	ctx->metrics.upload_async_pending_jobs = upload_queue_pending_count(uploads.queue) + in_flight_jobs;
+	ctx->metrics.upload_async_pending_bytes = uploads.queue.pending_bytes + uploads.queue.in_flight_bytes;
+}
+
+void vulkan_upload_engine_shutdown(VulkanContext* ctx)
+{
+	UploadEngine& uploads = ctx->uploads;
+	for (UploadPayload& payload : uploads.payloads)
+	{
+		free(payload.data);
+	}
+	uploads.queue = {};
+	uploads.completed.reset();
+	uploads.payloads.reset();
+	uploads.free_payloads.reset();
+	for (UploadDeferredRetirement& deferred : uploads.deferred_retirements)
+	{
+		vulkan_context_destroy_retired_resource(ctx, deferred.resource);
+	}
+	uploads.deferred_retirements.reset();
+	for (UploadBatchSlot& slot : uploads.slots)
+	{
+		if (slot.staging.buffer) vmaDestroyBuffer(ctx->allocator, slot.staging.buffer, slot.staging.allocation);
+		slot.staging = {};
+		vkDestroyFence(ctx->device, slot.fence, nullptr);
+		slot.fence = VK_NULL_HANDLE;
+	}
+	vkDestroySemaphore(ctx->device, uploads.timeline, nullptr);
+	vkDestroyCommandPool(ctx->device, uploads.command_pool, nullptr);
+}
+
 // Waits for the frame slot, acquires a swapchain image, and begins recording.
 // The completed slot owns every transient object that can now be reused.
 bool vulkan_context_begin_frame(VulkanContext* ctx)
@@ -2229,6 +3173,7 @@ bool vulkan_context_begin_frame(VulkanContext* ctx)
 	};
 	VK_CHECK(vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info));
 	frame.recording = true;
+	g_gpu_barrier_counters = {};
 
 	// Start this frame's GPU timing (pool was harvested above; reset must be
 	// recorded, hostQueryReset is deliberately not enabled)
@@ -2269,7 +3214,9 @@ bool vulkan_context_begin_frame(VulkanContext* ctx)
 		.imageMemoryBarrierCount = 1,
 		.pImageMemoryBarriers = &to_color_attachment,
 	};
-	vkCmdPipelineBarrier2(command_buffer, &begin_dependency_info);
+	gpu_cmd_pipeline_barrier(command_buffer, begin_dependency_info);
+
+	vulkan_upload_engine_begin_frame(ctx);
 
 	return true;
 }
@@ -2281,6 +3228,8 @@ void vulkan_context_end_frame(VulkanContext* ctx)
 	FrameResources& frame = vulkan_current_frame(ctx);
 	VkCommandBuffer command_buffer = frame.command_buffer;
 
+	vulkan_upload_engine_submit(ctx);
+
 	// Swapchain image: COLOR_ATTACHMENT_OPTIMAL -> PRESENT_SRC
 	VkImageMemoryBarrier2 to_present = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
@@ -2307,7 +3256,12 @@ void vulkan_context_end_frame(VulkanContext* ctx)
 		.imageMemoryBarrierCount = 1,
 		.pImageMemoryBarriers = &to_present,
 	};
-	vkCmdPipelineBarrier2(command_buffer, &end_dependency_info);
+	gpu_cmd_pipeline_barrier(command_buffer, end_dependency_info);
+	ctx->metrics.frame_barrier_batches = g_gpu_barrier_counters.batches;
+	ctx->metrics.frame_barriers = g_gpu_barrier_counters.barriers;
+	ctx->metrics.barrier_batches += g_gpu_barrier_counters.batches;
+	ctx->metrics.barriers += g_gpu_barrier_counters.barriers;
+	g_gpu_barrier_counters = {};
 
 	// Close this frame's GPU timing span
 	if (ctx->timestamps_supported)
@@ -2317,10 +3271,19 @@ void vulkan_context_end_frame(VulkanContext* ctx)
 
 	VK_CHECK(vkEndCommandBuffer(command_buffer));
 
-	VkSemaphoreSubmitInfo wait_semaphore_info = {
-		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-		.semaphore = frame.image_available_semaphore,
-		.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+	// Also waits for upload batches whose acquires begin_frame recorded
+	VkSemaphoreSubmitInfo wait_semaphore_infos[2] = {
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = frame.image_available_semaphore,
+			.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = ctx->uploads.timeline,
+			.value = frame.upload_wait_value,
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		},
 	};
 
 	VkSemaphoreSubmitInfo signal_semaphore_info = {
@@ -2338,8 +3301,8 @@ void vulkan_context_end_frame(VulkanContext* ctx)
 
 	VkSubmitInfo2 submit_info = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-		.waitSemaphoreInfoCount = 1,
-		.pWaitSemaphoreInfos = &wait_semaphore_info,
+		.waitSemaphoreInfoCount = frame.upload_wait_value > 0 ? 2u : 1u,
+		.pWaitSemaphoreInfos = wait_semaphore_infos,
 		.commandBufferInfoCount = 1,
 		.pCommandBufferInfos = &command_buffer_submit_info,
 		.signalSemaphoreInfoCount = 1,
@@ -2580,27 +3543,36 @@ inline f32 vulkan_validation_half_to_float(u16 value)
 	return std::bit_cast<f32>(bits);
 }
 
-// Validation-only float capture. PFM preserves negative and extended values
-// from the R16G16B16A16 tonemapping/composite targets without display encoding.
-bool vulkan_context_dump_image_pfm(
+// Bytes per texel for the formats the validation captures read back
+u32 vulkan_validation_texel_size(VkFormat in_format)
+{
+	switch (in_format)
+	{
+		case VK_FORMAT_R16_SFLOAT: return 2;
+		case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+		case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+		default: return 0;
+	}
+}
+
+// Validation-only readback of a single-layer, single-mip color image into
+// out_texels (tightly packed rows, top row first). Waits for the device and
+// restores the image's tracked state afterwards.
+bool vulkan_context_read_image(
 	VulkanContext* ctx,
 	GpuImage* in_image,
-	const char* in_path)
+	DynamicArray<u8>& out_texels)
 {
-	const bool rgba16 = in_image && in_image->format == VK_FORMAT_R16G16B16A16_SFLOAT;
-	const bool r16 = in_image && in_image->format == VK_FORMAT_R16_SFLOAT;
-	if (!in_image || in_image->image == VK_NULL_HANDLE
-		|| (!rgba16 && !r16)
+	const u32 texel_size = in_image ? vulkan_validation_texel_size(in_image->format) : 0;
+	if (!in_image || in_image->image == VK_NULL_HANDLE || texel_size == 0
 		|| in_image->array_layers != 1 || in_image->mip_levels != 1)
 	{
-		printf("PFM validation capture requires a single-layer R16F or RGBA16F image\n");
 		return false;
 	}
 	VK_CHECK(vulkan_device_wait_idle(ctx));
 	const u32 width = in_image->extent.width;
 	const u32 height = in_image->extent.height;
-	const u32 channel_count = rgba16 ? 4u : 1u;
-	const u64 buffer_size = (u64)width * height * channel_count * sizeof(u16);
+	const u64 buffer_size = (u64)width * height * texel_size;
 	VkBufferCreateInfo buffer_info = {
 		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 		.size = buffer_size,
@@ -2670,25 +3642,23 @@ bool vulkan_context_dump_image_pfm(
 	vkFreeCommandBuffers(ctx->device, ctx->command_pool, 1, &command_buffer);
 	VK_CHECK(vmaInvalidateAllocation(ctx->allocator, allocation, 0, VK_WHOLE_SIZE));
 
+	out_texels.resize(buffer_size);
+	memcpy(out_texels.data(), mapped_info.pMappedData, buffer_size);
+	vmaDestroyBuffer(ctx->allocator, buffer, allocation);
+	return true;
+}
+
+// Writes through a temporary file so a failed capture never leaves a
+// partial image at in_path
+template<typename WriteFunction>
+bool vulkan_validation_write_file(const char* in_path, WriteFunction in_write)
+{
 	const std::string temporary_path = std::string(in_path) + ".tmp";
 	std::remove(temporary_path.c_str());
 	FILE* file = fopen(temporary_path.c_str(), "wb");
-	bool succeeded = file && fprintf(file, "PF\n%u %u\n-1.0\n", width, height) > 0;
-	const u16* pixels = (const u16*)mapped_info.pMappedData;
+	bool succeeded = file && in_write(file);
 	if (file)
 	{
-		for (i32 y = (i32)height - 1; y >= 0 && succeeded; --y)
-			for (u32 x = 0; x < width && succeeded; ++x)
-			{
-				const u16* pixel = &pixels[((u64)y * width + x) * channel_count];
-				const f32 red = vulkan_validation_half_to_float(pixel[0]);
-				const f32 rgb[3] = {
-					red,
-					rgba16 ? vulkan_validation_half_to_float(pixel[1]) : red,
-					rgba16 ? vulkan_validation_half_to_float(pixel[2]) : red,
-				};
-				succeeded = fwrite(rgb, sizeof(f32), 3, file) == 3;
-			}
 		succeeded = fclose(file) == 0 && succeeded;
 	}
 	if (succeeded)
@@ -2699,17 +3669,83 @@ bool vulkan_context_dump_image_pfm(
 		succeeded = std::rename(temporary_path.c_str(), in_path) == 0;
 	}
 	if (!succeeded) std::remove(temporary_path.c_str());
-	vmaDestroyBuffer(ctx->allocator, buffer, allocation);
+	return succeeded;
+}
+
+// Validation-only float capture. PFM preserves negative and extended values
+// from the R16G16B16A16 tonemapping/composite targets without display encoding.
+bool vulkan_context_dump_image_pfm(
+	VulkanContext* ctx,
+	GpuImage* in_image,
+	const char* in_path)
+{
+	const bool rgba16 = in_image && in_image->format == VK_FORMAT_R16G16B16A16_SFLOAT;
+	const bool r16 = in_image && in_image->format == VK_FORMAT_R16_SFLOAT;
+	DynamicArray<u8> texels;
+	if ((!rgba16 && !r16) || !vulkan_context_read_image(ctx, in_image, texels))
+	{
+		printf("PFM validation capture requires a single-layer R16F or RGBA16F image\n");
+		return false;
+	}
+	const u32 width = in_image->extent.width;
+	const u32 height = in_image->extent.height;
+	const u32 channel_count = rgba16 ? 4u : 1u;
+	const u16* pixels = (const u16*)texels.data();
+
+	const bool succeeded = vulkan_validation_write_file(in_path, [&](FILE* file)
+	{
+		bool written = fprintf(file, "PF\n%u %u\n-1.0\n", width, height) > 0;
+		for (i32 y = (i32)height - 1; y >= 0 && written; --y)
+			for (u32 x = 0; x < width && written; ++x)
+			{
+				const u16* pixel = &pixels[((u64)y * width + x) * channel_count];
+				const f32 red = vulkan_validation_half_to_float(pixel[0]);
+				const f32 rgb[3] = {
+					red,
+					rgba16 ? vulkan_validation_half_to_float(pixel[1]) : red,
+					rgba16 ? vulkan_validation_half_to_float(pixel[2]) : red,
+				};
+				written = fwrite(rgb, sizeof(f32), 3, file) == 3;
+			}
+		return written;
+	});
 	printf("%s PFM validation capture %s\n", succeeded ? "Wrote" : "Failed",
 		in_path);
 	return succeeded;
 }
 
+// Validation-only exact capture: a one-line "RAW <vk format> <width>
+// <height>" header followed by the texels as stored, top row first, so two
+// captures can be compared byte for byte (G-buffer targets are RGBA32F or
+// RGBA16F depending on the device).
+bool vulkan_context_dump_image_raw(
+	VulkanContext* ctx,
+	GpuImage* in_image,
+	const char* in_path)
+{
+	DynamicArray<u8> texels;
+	if (!vulkan_context_read_image(ctx, in_image, texels))
+	{
+		printf("Raw validation capture requires a single-layer R16F, RGBA16F or RGBA32F image\n");
+		return false;
+	}
+	const bool succeeded = vulkan_validation_write_file(in_path, [&](FILE* file)
+	{
+		return fprintf(file, "RAW %d %u %u\n", (i32)in_image->format,
+				in_image->extent.width, in_image->extent.height) > 0
+			&& fwrite(texels.data(), 1, texels.length(), file) == texels.length();
+	});
+	printf("%s raw validation capture %s\n", succeeded ? "Wrote" : "Failed",
+		in_path);
+	return succeeded;
+}
+
 void vulkan_context_shutdown(VulkanContext* ctx)
 {
 	vulkan_device_wait_idle(ctx);
 	vulkan_context_save_pipeline_cache(ctx);
 
+	vulkan_upload_engine_shutdown(ctx);
 	vulkan_context_flush_all_retirement(ctx);
 
 	for (u32 frame_idx = 0; frame_idx < MAX_FRAMES_IN_FLIGHT; ++frame_idx)
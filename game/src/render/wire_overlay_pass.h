@@ -3,7 +3,7 @@
 #include "core/types.h"
 #include "render/vulkan_context.h"
 #include "render/render_types.h"
-#include "render/shader_module.h"
+#include "render/pipeline_build_service.h"
 #include "render/frame_data.h"
 #include "render/gpu_buffer.h"
 #include "render/culling.h"
@@ -184,11 +184,12 @@ namespace WireOverlayPass
 			VkPipelineLayout in_layout,
 			const char* in_vert_path,
 			const char* in_frag_path,
-			bool in_blend
-		) -> VkPipeline
+			bool in_blend,
+			VkPipeline* out_pipeline
+		)
 		{
-			VkShaderModule vertex_module = create_shader_module_from_file(ctx->device, in_vert_path);
-			VkShaderModule fragment_module = create_shader_module_from_file(ctx->device, in_frag_path);
+			VkShaderModule vertex_module = PipelineBuildService::shader_module(ctx, in_vert_path);
+			VkShaderModule fragment_module = PipelineBuildService::shader_module(ctx, in_frag_path);
 
 			VkPipelineShaderStageCreateInfo shader_stages[] = {
 				{
@@ -278,25 +279,22 @@ namespace WireOverlayPass
 				.layout = in_layout,
 				.renderPass = VK_NULL_HANDLE,
 			};
-			VkPipeline out_pipeline = VK_NULL_HANDLE;
-			VK_CHECK(vulkan_create_graphics_pipelines(ctx, 1, &pipeline_create_info, &out_pipeline));
-
-			vkDestroyShaderModule(ctx->device, vertex_module, nullptr);
-			vkDestroyShaderModule(ctx->device, fragment_module, nullptr);
-			return out_pipeline;
+			PipelineBuildService::graphics(ctx, pipeline_create_info, out_pipeline);
 		};
 
-		copy_pipeline = create_wire_pipeline(
+		create_wire_pipeline(
 			copy_pipeline_layout,
 			"bin/shaders/wire_overlay_copy.vert.spv",
 			"bin/shaders/wire_overlay_copy.frag.spv",
-			/*in_blend*/ false
+			/*in_blend*/ false,
+			&copy_pipeline
 		);
-		mesh_pipeline = create_wire_pipeline(
+		create_wire_pipeline(
 			mesh_pipeline_layout,
 			"bin/shaders/wire_overlay_mesh.vert.spv",
 			"bin/shaders/wire_overlay_mesh.frag.spv",
-			/*in_blend*/ true
+			/*in_blend*/ true,
+			&mesh_pipeline
 		);
 	}
 
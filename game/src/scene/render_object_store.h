@@ -0,0 +1,258 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+
+#include "ankerl/unordered_dense.h"
+#include "core/dynamic_array.h"
+#include "core/types.h"
+#include "render/cull_engine.h"
+
+// ---- Render object store ----
+// Persistent per-mesh render rows in structure-of-arrays form. Each mesh
+// object owns a stable slot (Object::render_object_index) from insertion to
+// removal. Writers mark a slot dirty when the object's transform changes.
+// Once per frame the dirty slots are re-packed, and only rows whose GPU
+// fields actually changed are copied into the persistent ObjectData buffer.
+// A static scene therefore packs and uploads nothing.
+//
+// Freed slots go on a free list and are reused; the slot count is a
+// high-water mark. World bounds and cull flags sit beside the GPU columns as
+// CullBounds columns; slots whose bounds or flags change, and slots that are
+// released, are queued for the cull engine's next sync.
+
+static constexpr i32 RENDER_OBJECT_STORE_UNWRITTEN_MATERIAL = INT32_MIN;	// forces a slot's next upload
+
+// Cumulative counters (benchmark JSON reports the measured-window delta)
+struct RenderObjectStoreCounters
+{
+	u64 frames = 0;				// flushes
+	u64 upload_frames = 0;		// flushes that copied at least one row
+	u64 rows_packed = 0;		// dirty slots re-read from their object
+	u64 rows_uploaded = 0;		// rows whose GPU fields changed
+	u64 upload_bytes = 0;
+	u64 copy_regions = 0;		// contiguous row runs copied
+	u64 full_uploads = 0;		// every live slot re-sent (buffer growth)
+	u64 rebuild_bytes = 0;		// what rebuilding every row each frame would have sent
+};
+
+// Run of consecutive slots uploaded with one copy
+struct RenderObjectStoreRange
+{
+	i32 first_slot = 0;
+	i32 slot_count = 0;
+};
+
+struct RenderObjectStore
+{
+	// Columns, indexed by slot
+	DynamicArray<HMM_Mat4> model_matrices;
+	DynamicArray<HMM_Mat4> rotation_matrices;
+	DynamicArray<i32> material_indices;
+	CullBounds bounds;
+	DynamicArray<u8> cull_flags;		// CullSlotFlags; 0 until first written
+	DynamicArray<i32> slot_object_ids;	// -1 = free
+
+	// Pending for cull_engine_sync
+	DynamicArray<i32> changed_cull_slots;
+	DynamicArray<i32> released_cull_slots;
+
+	DynamicArray<u64> dirty_bits;	// one bit per slot
+	i32 dirty_count = 0;
+
+	DynamicArray<i32> free_slots;
+	ankerl::unordered_dense::map<i32, i32> object_slots;	// unique id -> slot
+
+	RenderObjectStoreCounters counters;
+};
+
+inline i32 render_object_store_slot_count(const RenderObjectStore& in_store)
+{
+	return (i32) in_store.slot_object_ids.length();
+}
+
+inline i32 render_object_store_live_count(const RenderObjectStore& in_store)
+{
+	return (i32) in_store.object_slots.size();
+}
+
+inline bool render_object_store_is_dirty(const RenderObjectStore& in_store, i32 in_slot)
+{
+	return (in_store.dirty_bits[(size_t) in_slot >> 6] >> (in_slot & 63)) & 1ull;
+}
+
+inline void render_object_store_mark_dirty(RenderObjectStore& in_store, i32 in_slot)
+{
+	u64& word = in_store.dirty_bits[(size_t) in_slot >> 6];
+	const u64 bit = 1ull << (in_slot & 63);
+	if (!(word & bit))
+	{
+		word |= bit;
+		in_store.dirty_count += 1;
+	}
+}
+
+// Returns the object's slot, allocating one (dirty, never uploaded) if it
+// has none
+inline i32 render_object_store_acquire(RenderObjectStore& in_store, i32 in_unique_id)
+{
+	auto found = in_store.object_slots.find(in_unique_id);
+	if (found != in_store.object_slots.end())
+	{
+		render_object_store_mark_dirty(in_store, found->second);
+		return found->second;
+	}
+
+	i32 slot;
+	if (!in_store.free_slots.empty())
+	{
+		slot = in_store.free_slots.last();
+		in_store.free_slots.pop();
+	}
+	else
+	{
+		slot = render_object_store_slot_count(in_store);
+		in_store.model_matrices.add({});
+		in_store.rotation_matrices.add({});
+		in_store.material_indices.add(RENDER_OBJECT_STORE_UNWRITTEN_MATERIAL);
+		cull_bounds_add(in_store.bounds, {});
+		in_store.cull_flags.add(0);
+		in_store.slot_object_ids.add(-1);
+		if ((size_t) slot >> 6 >= in_store.dirty_bits.length())
+		{
+			in_store.dirty_bits.add(0);
+		}
+	}
+
+	in_store.slot_object_ids[slot] = in_unique_id;
+	in_store.material_indices[slot] = RENDER_OBJECT_STORE_UNWRITTEN_MATERIAL;
+	in_store.object_slots[in_unique_id] = slot;
+	render_object_store_mark_dirty(in_store, slot);
+	return slot;
+}
+
+inline void render_object_store_release(RenderObjectStore& in_store, i32 in_unique_id)
+{
+	auto found = in_store.object_slots.find(in_unique_id);
+	if (found == in_store.object_slots.end())
+	{
+		return;
+	}
+
+	const i32 slot = found->second;
+	in_store.object_slots.erase(found);
+	in_store.slot_object_ids[slot] = -1;
+	in_store.cull_flags[slot] = 0;
+	in_store.released_cull_slots.add(slot);
+	u64& word = in_store.dirty_bits[(size_t) slot >> 6];
+	const u64 bit = 1ull << (slot & 63);
+	if (word & bit)
+	{
+		word &= ~bit;
+		in_store.dirty_count -= 1;
+	}
+	in_store.free_slots.add(slot);
+}
+
+// Forgets every slot (scene reset); counters are kept
+inline void render_object_store_clear(RenderObjectStore& in_store)
+{
+	in_store.model_matrices.clear();
+	in_store.rotation_matrices.clear();
+	in_store.material_indices.clear();
+	cull_bounds_clear(in_store.bounds);
+	in_store.cull_flags.clear();
+	in_store.slot_object_ids.clear();
+	in_store.changed_cull_slots.clear();
+	in_store.released_cull_slots.clear();
+	in_store.dirty_bits.clear();
+	in_store.dirty_count = 0;
+	in_store.free_slots.clear();
+	in_store.object_slots.clear();
+}
+
+// Marks every live slot dirty and unwritten, so the next flush re-sends all
+// of them (e.g. into a freshly grown GPU buffer)
+inline void render_object_store_invalidate_all(RenderObjectStore& in_store)
+{
+	for (i32 slot = 0; slot < render_object_store_slot_count(in_store); ++slot)
+	{
+		if (in_store.slot_object_ids[slot] >= 0)
+		{
+			in_store.material_indices[slot] = RENDER_OBJECT_STORE_UNWRITTEN_MATERIAL;
+			render_object_store_mark_dirty(in_store, slot);
+		}
+	}
+}
+
+// Appends the dirty slots in ascending order and clears their bits
+inline void render_object_store_take_dirty(RenderObjectStore& in_store, DynamicArray<i32>& out_slots)
+{
+	for (size_t word_idx = 0; word_idx < in_store.dirty_bits.length() && in_store.dirty_count > 0; ++word_idx)
+	{
+		u64 word = in_store.dirty_bits[word_idx];
+		if (word == 0)
+		{
+			continue;
+		}
+		in_store.dirty_bits[word_idx] = 0;
+		while (word != 0)
+		{
+			const i32 bit = std::countr_zero(word);
+			word &= word - 1;
+			out_slots.add((i32) (word_idx << 6) + bit);
+			in_store.dirty_count -= 1;
+		}
+	}
+}
+
+// Writes a slot's columns. Returns true when the GPU-visible fields changed
+// (or the slot was never uploaded) and the row needs copying. Changed bounds
+// or flags queue the slot for the cull engine.
+inline bool render_object_store_write(
+	RenderObjectStore& in_store,
+	i32 in_slot,
+	const HMM_Mat4& in_model_matrix,
+	const HMM_Mat4& in_rotation_matrix,
+	i32 in_material_index,
+	const BoundingBox& in_world_bounds,
+	bool in_always_visible)
+{
+	const u8 cull_flags = CULL_SLOT_LIVE | (in_always_visible ? CULL_SLOT_ALWAYS_VISIBLE : 0);
+	if (in_store.cull_flags[in_slot] != cull_flags || !cull_bounds_equal(in_store.bounds, in_slot, in_world_bounds))
+	{
+		in_store.cull_flags[in_slot] = cull_flags;
+		cull_bounds_set(in_store.bounds, in_slot, in_world_bounds);
+		in_store.changed_cull_slots.add(in_slot);
+	}
+
+	const bool changed = in_store.material_indices[in_slot] != in_material_index
+		|| memcmp(&in_store.model_matrices[in_slot], &in_model_matrix, sizeof(HMM_Mat4)) != 0
+		|| memcmp(&in_store.rotation_matrices[in_slot], &in_rotation_matrix, sizeof(HMM_Mat4)) != 0;
+	if (changed)
+	{
+		in_store.model_matrices[in_slot] = in_model_matrix;
+		in_store.rotation_matrices[in_slot] = in_rotation_matrix;
+		in_store.material_indices[in_slot] = in_material_index;
+	}
+	return changed;
+}
+
+// Coalesces ascending slots into runs of consecutive slots
+inline void render_object_store_build_ranges(const DynamicArray<i32>& in_sorted_slots, DynamicArray<RenderObjectStoreRange>& out_ranges)
+{
+	out_ranges.clear();
+	for (i32 slot : in_sorted_slots)
+	{
+		if (!out_ranges.empty())
+		{
+			RenderObjectStoreRange& range = out_ranges.last();
+			if (range.first_slot + range.slot_count == slot)
+			{
+				range.slot_count += 1;
+				continue;
+			}
+		}
+		out_ranges.add({ .first_slot = slot, .slot_count = 1 });
+	}
+}
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ankerl/unordered_dense.h"
+#include "core/dynamic_array.h"
+#include "core/types.h"
+
+// ---- Scene indexes ----
+// Dense id lists of the objects each system iterates (meshes, lights,
+// armatures, ...), maintained in O(1) per inserted, replaced or removed
+// object instead of rescanning scene.objects. Every object has an entry
+// holding its position in each list (-1 when absent): removal swaps the
+// list's last id into the hole and patches that id's back-pointer, so list
+// order is arbitrary.
+//
+// Membership depends only on an object's own components, except for one
+// cross-object rule: an authored armature driving a skinned catalog Part is
+// itself catalog data and stays out of armature_object_ids. Entries record
+// which armature they pin, and pin counts per armature decide that rule, so
+// a Part arriving or leaving reclassifies just that armature.
+//
+// scene_indexes_rescan is the full-scan reference the incremental path must
+// match (GAME2_VALIDATE_SCENE_INDEXES cross-checks the two at runtime).
+
+enum class ESceneIndexList : i32
+{
+	Mesh = 0,
+	Light,
+	Armature,
+	SkinnedMesh,
+	Part,
+	AttachmentPoint,
+	Count,
+};
+
+static constexpr i32 SCENE_INDEX_LIST_COUNT = (i32) ESceneIndexList::Count;
+
+// The components of an Object that decide its index membership
+struct SceneIndexObjectInfo
+{
+	bool has_mesh = false;
+	bool has_skinned_vertices = false;
+	bool has_light = false;
+	bool has_armature = false;
+	bool has_part = false;
+	bool has_attachment_point = false;
+	bool runtime_instance = false;
+	i32 mesh_armature_id = -1;
+};
+
+struct SceneIndexEntry
+{
+	SceneIndexObjectInfo info;
+	i32 positions[SCENE_INDEX_LIST_COUNT] = { -1, -1, -1, -1, -1, -1 };
+	i32 pinned_armature_id = -1;
+};
+
+struct SceneIndexes
+{
+	DynamicArray<i32> mesh_object_ids;
+	DynamicArray<i32> light_object_ids;
+	DynamicArray<i32> armature_object_ids;
+	DynamicArray<i32> skinned_mesh_object_ids;
+	DynamicArray<i32> part_object_ids;
+	DynamicArray<i32> attachment_point_object_ids;
+
+	ankerl::unordered_dense::map<i32, SceneIndexEntry> entries;
+	ankerl::unordered_dense::map<i32, i32> armature_pin_counts;	// armature id -> skinned catalog Parts using it
+
+	u64 revision = 0;	// bumped by every change
+};
+
+inline DynamicArray<i32>& scene_index_list(SceneIndexes& in_indexes, ESceneIndexList in_list)
+{
+	switch (in_list)
+	{
+		case ESceneIndexList::Mesh: return in_indexes.mesh_object_ids;
+		case ESceneIndexList::Light: return in_indexes.light_object_ids;
+		case ESceneIndexList::Armature: return in_indexes.armature_object_ids;
+		case ESceneIndexList::SkinnedMesh: return in_indexes.skinned_mesh_object_ids;
+		case ESceneIndexList::Part: return in_indexes.part_object_ids;
+		case ESceneIndexList::AttachmentPoint:
+		default: return in_indexes.attachment_point_object_ids;
+	}
+}
+
+inline const char* scene_index_list_name(ESceneIndexList in_list)
+{
+	static const char* names[SCENE_INDEX_LIST_COUNT] = { "mesh", "light", "armature", "skinned mesh", "part", "attachment point" };
+	return names[(i32) in_list];
+}
+
+// Armature a skinned catalog Part pins, or -1
+inline i32 scene_index_pinned_armature(const SceneIndexObjectInfo& in_info)
+{
+	const bool catalog_skinned_part = in_info.has_part && !in_info.runtime_instance &&
+		in_info.has_mesh && in_info.has_skinned_vertices;
+	return catalog_skinned_part && in_info.mesh_armature_id >= 0 ? in_info.mesh_armature_id : -1;
+}
+
+// Bit per ESceneIndexList the object belongs to
+inline u32 scene_index_membership(const SceneIndexObjectInfo& in_info, bool in_pinned_armature)
+{
+	// Catalog Parts and sockets are immutable authoring templates. Runtime
+	// clones deliberately omit those components and enter normal render and
+	// skinning indexes.
+	const bool template_object = in_info.has_part || in_info.has_attachment_point;
+	u32 membership = 0;
+	if (in_info.has_mesh && !template_object)
+	{
+		membership |= 1u << (i32) ESceneIndexList::Mesh;
+		if (in_info.has_skinned_vertices)
+		{
+			membership |= 1u << (i32) ESceneIndexList::SkinnedMesh;
+		}
+	}
+	if (in_info.has_light && !template_object)
+	{
+		membership |= 1u << (i32) ESceneIndexList::Light;
+	}
+	if (in_info.has_armature && (in_info.runtime_instance || !in_pinned_armature))
+	{
+		membership |= 1u << (i32) ESceneIndexList::Armature;
+	}
+	if (in_info.has_part && !in_info.runtime_instance)
+	{
+		membership |= 1u << (i32) ESceneIndexList::Part;
+	}
+	if (in_info.has_attachment_point && !in_info.runtime_instance)
+	{
+		membership |= 1u << (i32) ESceneIndexList::AttachmentPoint;
+	}
+	return membership;
+}
+
+// Adds or swap-removes in_unique_id so its lists match in_membership
+inline void scene_index_apply_membership(SceneIndexes& in_indexes, i32 in_unique_id, SceneIndexEntry& in_entry, u32 in_membership)
+{
+	for (i32 list_idx = 0; list_idx < SCENE_INDEX_LIST_COUNT; ++list_idx)
+	{
+		const bool wanted = (in_membership >> list_idx) & 1u;
+		i32& position = in_entry.positions[list_idx];
+		if (wanted == (position >= 0))
+		{
+			continue;
+		}
+
+		DynamicArray<i32>& ids = scene_index_list(in_indexes, (ESceneIndexList) list_idx);
+		if (wanted)
+		{
+			position = (i32) ids.length();
+			ids.add(in_unique_id);
+			continue;
+		}
+
+		const i32 moved_id = ids.last();
+		ids[position] = moved_id;
+		ids.pop();
+		if (moved_id != in_unique_id)
+		{
+			in_indexes.entries[moved_id].positions[list_idx] = position;
+		}
+		position = -1;
+	}
+}
+
+inline bool scene_index_contains(const SceneIndexes& in_indexes, i32 in_unique_id, ESceneIndexList in_list)
+{
+	auto found = in_indexes.entries.find(in_unique_id);
+	return found != in_indexes.entries.end() && found->second.positions[(i32) in_list] >= 0;
+}
+
+inline bool scene_index_armature_pinned(const SceneIndexes& in_indexes, i32 in_armature_id)
+{
+	return in_indexes.armature_pin_counts.contains(in_armature_id);
+}
+
+// Re-evaluates an armature after its pin count crossed zero
+inline void scene_index_reclassify(SceneIndexes& in_indexes, i32 in_unique_id)
+{
+	auto found = in_indexes.entries.find(in_unique_id);
+	if (found == in_indexes.entries.end())
+	{
+		return;
+	}
+	const u32 membership = scene_index_membership(found->second.info, scene_index_armature_pinned(in_indexes, in_unique_id));
+	scene_index_apply_membership(in_indexes, in_unique_id, found->second, membership);
+}
+
+inline void scene_index_change_pin(SceneIndexes& in_indexes, i32 in_armature_id, i32 in_delta)
+{
+	if (in_armature_id < 0)
+	{
+		return;
+	}
+	i32& count = in_indexes.armature_pin_counts[in_armature_id];
+	count += in_delta;
+	const bool crossed_zero = (in_delta > 0 && count == in_delta) || count == 0;
+	if (count == 0)
+	{
+		in_indexes.armature_pin_counts.erase(in_armature_id);
+	}
+	if (crossed_zero)
+	{
+		scene_index_reclassify(in_indexes, in_armature_id);
+	}
+}
+
+// Inserts a new object or reclassifies a replaced one
+inline void scene_indexes_set(SceneIndexes& in_indexes, i32 in_unique_id, const SceneIndexObjectInfo& in_info)
+{
+	SceneIndexEntry& entry = in_indexes.entries[in_unique_id];
+	const i32 previous_pin = entry.pinned_armature_id;
+	entry.info = in_info;
+	entry.pinned_armature_id = scene_index_pinned_armature(in_info);
+	const u32 membership = scene_index_membership(in_info, scene_index_armature_pinned(in_indexes, in_unique_id));
+	scene_index_apply_membership(in_indexes, in_unique_id, entry, membership);
+
+	const i32 new_pin = entry.pinned_armature_id;
+	if (new_pin != previous_pin)
+	{
+		scene_index_change_pin(in_indexes, new_pin, 1);
+		scene_index_change_pin(in_indexes, previous_pin, -1);
+	}
+	in_indexes.revision += 1;
+}
+
+inline void scene_indexes_remove(SceneIndexes& in_indexes, i32 in_unique_id)
+{
+	auto found = in_indexes.entries.find(in_unique_id);
+	if (found == in_indexes.entries.end())
+	{
+		return;
+	}
+	scene_index_apply_membership(in_indexes, in_unique_id, found->second, 0);
+	const i32 pinned_armature_id = found->second.pinned_armature_id;
+	in_indexes.entries.erase(found);
+	scene_index_change_pin(in_indexes, pinned_armature_id, -1);
+	in_indexes.revision += 1;
+}
+
+inline void scene_indexes_clear(SceneIndexes& in_indexes)
+{
+	for (i32 list_idx = 0; list_idx < SCENE_INDEX_LIST_COUNT; ++list_idx)
+	{
+		scene_index_list(in_indexes, (ESceneIndexList) list_idx).clear();
+	}
+	in_indexes.entries.clear();
+	in_indexes.armature_pin_counts.clear();
+	in_indexes.revision += 1;
+}
+
+// Reference: rebuilds only the id lists of out_indexes from a full scan.
+// in_objects is any map of unique id -> object; in_info_of maps an object
+// to its SceneIndexObjectInfo.
+template <typename ObjectMap, typename InfoFunction>
+void scene_indexes_rescan(SceneIndexes& out_indexes, const ObjectMap& in_objects, InfoFunction in_info_of)
+{
+	for (i32 list_idx = 0; list_idx < SCENE_INDEX_LIST_COUNT; ++list_idx)
+	{
+		scene_index_list(out_indexes, (ESceneIndexList) list_idx).clear();
+	}
+
+	ankerl::unordered_dense::map<i32, bool> pinned_armature_ids;
+	for (const auto& [unique_id, object] : in_objects)
+	{
+		const i32 pinned_armature_id = scene_index_pinned_armature(in_info_of(object));
+		if (pinned_armature_id >= 0)
+		{
+			pinned_armature_ids[pinned_armature_id] = true;
+		}
+	}
+
+	for (const auto& [unique_id, object] : in_objects)
+	{
+		const u32 membership = scene_index_membership(in_info_of(object), pinned_armature_ids.contains(unique_id));
+		for (i32 list_idx = 0; list_idx < SCENE_INDEX_LIST_COUNT; ++list_idx)
+		{
+			if ((membership >> list_idx) & 1u)
+			{
+				scene_index_list(out_indexes, (ESceneIndexList) list_idx).add(unique_id);
+			}
+		}
+	}
+}
+
+// Cross-checks the incremental lists against a rescan: same ids per list
+// (order aside) and every back-pointer pointing at its own id. Logs each
+// mismatch; returns false if there was any.
+inline bool scene_indexes_match(SceneIndexes& in_indexes, SceneIndexes& in_rescanned)
+{
+	bool matches = true;
+	for (i32 list_idx = 0; list_idx < SCENE_INDEX_LIST_COUNT; ++list_idx)
+	{
+		const ESceneIndexList list = (ESceneIndexList) list_idx;
+		DynamicArray<i32> incremental_ids = scene_index_list(in_indexes, list);
+		DynamicArray<i32> rescanned_ids = scene_index_list(in_rescanned, list);
+		std::sort(incremental_ids.begin(), incremental_ids.end());
+		std::sort(rescanned_ids.begin(), rescanned_ids.end());
+		bool list_matches = incremental_ids.length() == rescanned_ids.length();
+		for (size_t id_idx = 0; list_matches && id_idx < incremental_ids.length(); ++id_idx)
+		{
+			list_matches = incremental_ids[id_idx] == rescanned_ids[id_idx];
+		}
+		if (!list_matches)
+		{
+			printf("scene indexes: %s list has %zu ids, a rescan finds %zu\n",
+				scene_index_list_name(list), incremental_ids.length(), rescanned_ids.length());
+			matches = false;
+		}
+
+		const DynamicArray<i32>& ids = scene_index_list(in_indexes, list);
+		for (size_t position = 0; position < ids.length(); ++position)
+		{
+			auto found = in_indexes.entries.find(ids[position]);
+			if (found == in_indexes.entries.end() || found->second.positions[list_idx] != (i32) position)
+			{
+				printf("scene indexes: %s list slot %zu (object %i) has a stale back-pointer\n",
+					scene_index_list_name(list), position, ids[position]);
+				matches = false;
+			}
+		}
+	}
+	return matches;
+}
@@ -1,24 +1,35 @@
 #pragma once
 
+#include <atomic>
 #include <optional>
 #include <string>
 #include <thread>
 
+#include "animation/skin_packing.h"
 #include "ankerl/unordered_dense.h"
+#include "core/runtime_config.h"
 #include "core/types.h"
-#include "network/channel.h"
+#include "core/worker_pool.h"
+#include "network/spsc_queue.h"
 #include "network/socket_wrapper.h"
 #include "game_object/camera.h"
 #include "game_object/game_object.h"
+#include "live_link/live_link_capture.h"
+#include "live_link/live_link_content_cache.h"
 #include "render/vulkan_context.h"
 #include "render/gpu_buffer.h"
 #include "render/render_pass.h"
+#include "render/texture_processing.h"
+#include "render/texture_streaming.h"
+#include "scene/render_object_store.h"
+#include "scene/scene_index.h"
 
 // ObjectData (shared with shaders)
 #include "shader_common.h"
 #include "tonemapping_shared.h"
 
 static constexpr i32 RENDER_OBJECT_SNAPSHOT_BUFFER_COUNT = 3;
+static constexpr size_t LIVE_LINK_SCENE_UPDATE_QUEUE_CAPACITY = 64;
 static constexpr i32 RENDER_OBJECT_SNAPSHOT_INITIAL_CAPACITY = 64;
 static constexpr i32 MAX_LIGHTS_PER_TYPE = 1024;
 
@@ -136,7 +147,7 @@ struct State
 {
 	struct RuntimeState
 	{
-		bool game_running = true;
+		std::atomic<bool> game_running = true;	// read by the live-link thread
 		bool blender_data_loaded = false;
 		bool is_simulating = true;
 		std::optional<std::string> init_file;
@@ -225,18 +236,10 @@ struct State
 		i32 invalid_sky_controller_count = 0;
 		i32 invalid_cloud_controller_count = 0;
 
-		// Per-kind object id lists are rebuilt lazily when dirty and cached
-		// until the next scene mutation.
-		struct IndexState
-		{
-			bool dirty = true;
-			DynamicArray<i32> mesh_object_ids;
-			DynamicArray<i32> light_object_ids;
-			DynamicArray<i32> armature_object_ids;
-			DynamicArray<i32> skinned_mesh_object_ids;
-			DynamicArray<i32> part_object_ids;
-			DynamicArray<i32> attachment_point_object_ids;
-		} indexes;
+		// Per-kind object id lists, kept current by
+		// scene_insert_or_replace_object / scene_remove_object
+		SceneIndexes indexes;
+		u64 validated_index_revision = ~0ull;
 	} scene;
 
 	struct MechState
@@ -254,16 +257,71 @@ struct State
 		std::string port = "65432";
 		std::thread thread;
 
-		SOCKET blender_socket = socket_invalid();
-		SOCKET connection_socket = socket_invalid();
+		// Parsed updates, live-link thread -> main thread. When the main
+		// thread falls this many updates behind, the live-link thread waits.
+		SpscQueue<SceneUpdate> scene_updates{ LIVE_LINK_SCENE_UPDATE_QUEUE_CAPACITY };
+		u64 reported_producer_wait_ns = 0;	// scene_updates wait already counted in FrameAccessStats
+
+		// Wire bytes of updates parsed but not drained yet. The server stops
+		// reading its senders while this exceeds queue_budget_bytes
+		// (--live-link-queue-mb).
+		std::atomic<u64> queued_update_bytes = 0;
+		u64 queue_budget_bytes = 512ull * 1024 * 1024;
+
+		// --record-live-link: capture every received Update to this file
+		std::optional<std::string> record_path;
+
+		// --replay-live-link: captured session fed to the main thread
+		// instead of the socket thread
+		LiveLinkReplay replay;
 
-		Channel<SceneUpdate> scene_updates;
+		// Mesh decode workers used by parse_flatbuffer_data (started lazily);
+		// texture processing shares them
+		WorkerPool decode_workers;
+
+		// Processed images by content and encoding (live-link thread)
+		TextureCache texture_cache;
+
+		// Content-addressed mesh streams shared across updates (main thread)
+		LiveLinkContentCache content_cache;
 	} live_link;
 
-	// Batched per-object GPU data, rebuilt each frame and triple-buffered so
-	// the CPU never writes a buffer that a frame in flight still reads.
-	// Each ring slot has an independent allocation.
-	ResizableGpuStreamRing<ObjectData> render_objects;
+	// Per-mesh GPU rows: a persistent SoA store on the CPU and one
+	// device-local buffer that only receives the rows that changed. Copies
+	// are recorded into the frame's command buffer, so frames in flight never
+	// see a half-written row.
+	struct RenderObjectState
+	{
+		RenderObjectStore store;
+		GpuBuffer<ObjectData> buffer;
+		i32 buffer_capacity = 0;
+		bool valid = false;	// at least one live row
+
+		// Per-frame scratch
+		DynamicArray<i32> dirty_slots;
+		DynamicArray<i32> upload_slots;
+		DynamicArray<RenderObjectStoreRange> upload_ranges;
+		DynamicArray<ObjectData> upload_rows;
+		DynamicArray<VulkanUploadRegion> upload_regions;
+		DynamicArray<BoundingBox> moved_bounds;	// old and new boxes of rows that moved (shadow cascade cache)
+	} render_objects;
+
+	// CPU culling over the render-object store's bounds columns. Synced once
+	// per flush; workers start once the scene is large enough to split views.
+	struct CullingState
+	{
+		CullEngine engine;
+		WorkerPool workers;
+		DynamicArray<i32> visible_slots;	// scratch
+	} culling;
+
+	// Skin-matrix packing (animation/skin_packing.h). Workers start once a
+	// frame packs SKIN_PACK_PARALLEL_MIN_MATRICES rows.
+	struct SkinPackState
+	{
+		SkinPackBatch batch;
+		WorkerPool workers;
+	} skin_pack;
 
 	// Registered materials. The GPU
 	// buffer is a fixed MAX_MATERIALS-slot stream buffer created at init and
@@ -278,11 +336,26 @@ struct State
 	} materials;
 
 	// Registered images backing the bindless texture array. Indices remain
-	// stable until a scene reset.
+	// stable until a scene reset. Images with identical pixels share one
+	// index through hash_to_index (content hash -> index).
 	struct ImageState
 	{
 		ankerl::unordered_dense::map<i32, i32> id_to_index;
+		ankerl::unordered_dense::map<u64, i32> hash_to_index;
 		DynamicArray<GpuImage> items;
+		DynamicArray<u64> upload_tickets;	// per item: sample only once vulkan_upload_ready
+		u64 vram_bytes = 0;			// whole mip chains as stored (streaming keeps part resident)
+		u64 vram_saved_bytes = 0;	// vs the same chains as RGBA8
+
+		// Texture streaming (render/texture_streaming_system.h). Each item is
+		// the chain from first_mips[i] down; a streamed replacement waits in
+		// replacements[i] until its upload is ready, then takes the slot.
+		DynamicArray<u8*> sources;			// per item: the whole processed chain (malloc'd)
+		DynamicArray<u8> first_mips;
+		DynamicArray<GpuImage> replacements;	// image == VK_NULL_HANDLE when none in flight
+		DynamicArray<u64> replacement_tickets;
+		DynamicArray<TextureStreamRequest> stream_requests;
+		TextureStreaming streaming;
 		bool enable_debug_fullscreen = false;
 		i32 debug_index = 0;
 	} images;
@@ -290,7 +363,7 @@ struct State
 	// Per-frame skin matrix arena: every skinned mesh's matrices are packed
 	// into one SSBO each frame (mesh.skin_matrix_arena_offset indexes it).
 	// The triple-buffered ring prevents mapped writes from racing a frame in
-	// flight, using the same lifetime scheme as the render-object snapshot.
+	// flight.
 	// Offsets are valid only for the current ring slot.
 	ResizableGpuStreamRing<HMM_Mat4> skin_matrices;
 
@@ -432,6 +505,11 @@ struct State
 		bool probe_occlusion = true;
 		i32 octree_depth = 4;
 		bool layout_dirty = true;
+		// Old and new bounds of GI geometry changed since the last layout
+		// update; the layout is patched around them unless a rebuild is due
+		DynamicArray<BoundingBox> layout_dirty_regions;
+		bool layout_rebuild_all = true;
+		f32 update_budget_ms = 2.0f;	// GPU time per frame for probe captures
 		EProbeOcclusionMode probe_occlusion_mode = EProbeOcclusionMode::Chebyshev;
 		EProbeRadianceMode probe_radiance_mode = EProbeRadianceMode::Octahedral;
 		bool render_sky_to_probes = true;
@@ -489,6 +567,10 @@ struct State
 		// sampling the stale map with its frozen matrices)
 		bool depth_freeze = false;
 		bool force_recapture = false;
+		// Distant cascades keep their slice while unchanged; a slice dirtied
+		// by moving casters re-renders at most every cache_dirty_interval frames
+		bool cache_enable = true;
+		i32 cache_dirty_interval = 4;
 		i32 num_cascades = 3;
 		f32 frustum_cascade_distance_scale = 1.0f;
 		f32 centered_square_cascade_distance_scale = 0.25f;
@@ -627,12 +709,18 @@ struct State
 			i32 armature_object_count = 0;
 			i32 skinned_mesh_object_count = 0;
 			i32 live_link_updated_objects = 0;
+			i32 live_link_transformed_objects = 0;
 			i32 live_link_deleted_objects = 0;
 			i32 live_link_reset_count = 0;
+			i32 live_link_queue_depth = 0;		// updates waiting when the drain started
+			i32 live_link_queue_wait_us = 0;	// longest time a drained update sat in the queue
+			i32 live_link_producer_wait_us = 0;	// live-link thread blocked on a full queue
 			i32 animation_armature_candidates = 0;
 			i32 animation_armatures_updated = 0;
 			i32 animation_skinned_mesh_candidates = 0;
 			i32 animation_skin_matrix_uploads = 0;
+			i32 animation_skinned_bounds_updates = 0;
+			i32 animation_skin_rows_shared = 0;	// meshes that reused another mesh's arena rows
 			i32 lighting_candidate_count = 0;
 			i32 lighting_processed_count = 0;
 			i32 object_update_scan_count = 0;
@@ -648,6 +736,15 @@ struct State
 			i32 cull_skinned_visible_count = 0;
 			i32 draw_calls = 0;
 			i32 draw_mesh_count = 0;
+			i32 indirect_draw_meshes = 0;	// of draw_mesh_count, drawn from the mesh pool
+			i32 indirect_draw_commands = 0;	// commands those meshes were drawn with
+			i32 indirect_pool_meshes = 0;
+			u64 indirect_pool_bytes = 0;	// pool stream capacity
+			i32 instance_groups = 0;		// pool entries shared by 2+ mesh objects
+			i32 instanced_meshes = 0;		// mesh objects in those groups
+			u64 instancing_bytes_saved = 0;	// stream bytes the extra objects would need
+			i32 shadow_cascades_rendered = 0;
+			i32 shadow_cascades_cached = 0;		// slices kept from an earlier frame
 			i32 gpu_skinning_candidate_count = 0;
 			i32 gpu_skinning_updated_count = 0;
 			i32 tessellation_candidate_count = 0;
@@ -686,141 +783,226 @@ RenderPass& get_render_target(RenderTargetId in_target)
 	return state.render_targets.get(in_target);
 }
 
-void scene_mark_indexes_dirty(State& in_state)
-{
-	in_state.scene.indexes.dirty = true;
-}
-
-void scene_reset_indexes(State& in_state)
+SceneIndexObjectInfo scene_index_object_info(const Object& in_object)
 {
-	in_state.scene.indexes.mesh_object_ids.clear();
-	in_state.scene.indexes.light_object_ids.clear();
-	in_state.scene.indexes.armature_object_ids.clear();
-	in_state.scene.indexes.skinned_mesh_object_ids.clear();
-	in_state.scene.indexes.part_object_ids.clear();
-	in_state.scene.indexes.attachment_point_object_ids.clear();
-	in_state.scene.indexes.dirty = true;
+	return {
+		.has_mesh = in_object.has_mesh,
+		.has_skinned_vertices = in_object.has_mesh && in_object.mesh.has_skinned_vertices,
+		.has_light = in_object.has_light,
+		.has_armature = in_object.has_armature,
+		.has_part = in_object.has_part,
+		.has_attachment_point = in_object.has_attachment_point,
+		.runtime_instance = object_is_runtime_instance(in_object),
+		.mesh_armature_id = in_object.has_mesh ? in_object.mesh.armature_id : -1,
+	};
 }
 
-void scene_rebuild_indexes(State& in_state)
+// GAME2_VALIDATE_SCENE_INDEXES: after every change, rescan scene.objects and
+// abort if the incrementally maintained lists disagree
+void scene_validate_indexes(State& in_state)
 {
-	State::SceneState::IndexState& indexes = in_state.scene.indexes;
-	indexes.mesh_object_ids.clear();
-	indexes.light_object_ids.clear();
-	indexes.armature_object_ids.clear();
-	indexes.skinned_mesh_object_ids.clear();
-	indexes.part_object_ids.clear();
-	indexes.attachment_point_object_ids.clear();
-
-	ankerl::unordered_dense::map<i32, bool> catalog_armature_ids;
-	for (auto& [unique_id, object] : in_state.scene.objects)
+	SceneIndexes& indexes = in_state.scene.indexes;
+	if (in_state.scene.validated_index_revision == indexes.revision)
 	{
-		if (object.has_part && !object_is_runtime_instance(object) && object.has_mesh &&
-			object.mesh.has_skinned_vertices && object.mesh.armature_id >= 0)
-		{
-			catalog_armature_ids[object.mesh.armature_id] = true;
-		}
+		return;
 	}
+	in_state.scene.validated_index_revision = indexes.revision;
 
-	for (auto& [unique_id, object] : in_state.scene.objects)
+	SceneIndexes rescanned;
+	scene_indexes_rescan(rescanned, in_state.scene.objects, scene_index_object_info);
+	if (!scene_indexes_match(indexes, rescanned) || indexes.entries.size() != in_state.scene.objects.size())
 	{
-		// Catalog Parts and sockets are immutable authoring templates. Runtime
-		// clones deliberately omit those components and enter normal render and
-		// skinning indexes below.
-		if (object.has_mesh && !object.has_part && !object.has_attachment_point)
-		{
-			indexes.mesh_object_ids.add(unique_id);
-
-			if (object.mesh.has_skinned_vertices)
-			{
-				indexes.skinned_mesh_object_ids.add(unique_id);
-			}
-		}
-		if (object.has_light && !object.has_part && !object.has_attachment_point)
-		{
-			indexes.light_object_ids.add(unique_id);
-		}
-		if (object.has_armature &&
-			(object_is_runtime_instance(object) || !catalog_armature_ids.contains(unique_id)))
-		{
-			indexes.armature_object_ids.add(unique_id);
-		}
-		if (object.has_part && !object_is_runtime_instance(object))
-		{
-			indexes.part_object_ids.add(unique_id);
-		}
-		if (object.has_attachment_point && !object_is_runtime_instance(object))
-		{
-			indexes.attachment_point_object_ids.add(unique_id);
-		}
+		printf("scene indexes: incremental indexes diverged from a rescan (%zu entries, %zu objects)\n",
+			indexes.entries.size(), in_state.scene.objects.size());
+		abort();
 	}
-
-	indexes.dirty = false;
 }
 
+// Indexes are always current; this records their sizes for the frame stats
+// and runs the validation mode
 void scene_ensure_indexes(State& in_state)
 {
-	if (in_state.scene.indexes.dirty)
+	if (RuntimeConfig::get().validate_scene_indexes)
 	{
-		scene_rebuild_indexes(in_state);
+		scene_validate_indexes(in_state);
 	}
 	scene_record_index_counts(in_state);
 }
 
-// Grows all snapshot buffers (doubling) when the mesh count exceeds capacity.
-// Old buffers go through the
-// deletion queue, so this is safe while frames are in flight.
-void render_object_snapshot_ensure_capacity(State& in_state, i32 in_required_capacity)
+// Grows the render-object buffer to at least in_required_capacity rows. The
+// old buffer goes through the deletion queue, so this is safe while frames
+// are in flight. Returns true when a new buffer was created: it starts
+// empty, so every live row must be sent again.
+bool render_object_snapshot_ensure_capacity(State& in_state, i32 in_required_capacity)
 {
-	in_state.render_objects.configure(
-		"State::render_objects",
-		RENDER_OBJECT_SNAPSHOT_INITIAL_CAPACITY
-	);
-	in_state.render_objects.ensure_capacity(in_required_capacity);
+	State::RenderObjectState& render_objects = in_state.render_objects;
+	if (in_required_capacity <= render_objects.buffer_capacity)
+	{
+		return false;
+	}
+
+	i32 new_capacity = MAX(RENDER_OBJECT_SNAPSHOT_INITIAL_CAPACITY, render_objects.buffer_capacity);
+	while (new_capacity < in_required_capacity)
+	{
+		new_capacity *= 2;
+	}
+
+	render_objects.buffer.destroy_gpu_buffer();
+	render_objects.buffer = GpuBuffer((GpuBufferDesc<ObjectData>) {
+		.data = nullptr,
+		.size = sizeof(ObjectData) * (u64) new_capacity,
+		.usage = { .storage_buffer = true, .prefer_device_local = true },
+		.label = "State::render_objects",
+	});
+	render_objects.buffer_capacity = new_capacity;
+	return true;
 }
 
-// Rebuilds the per-object GPU snapshot for this frame and advances the buffer
-// ring. Runs before begin_frame:
-// with a 3-buffer ring and 2 frames in flight, the buffer written here was
-// last consumed 3 frames ago.
-void build_render_object_snapshot(State& in_state)
+// Skinned meshes without evaluated pose bounds (no bone boxes) skip the cull
+bool mesh_is_always_visible(const Mesh& in_mesh)
 {
-	scene_ensure_indexes(in_state);
-
-	ResizableGpuStreamRing<ObjectData>& render_objects = in_state.render_objects;
+	return in_mesh.has_skinned_vertices && !in_mesh.animated_bounds_valid;
+}
 
-	for (auto& [unique_id, object] : in_state.scene.objects)
+// Main-thread half of the snapshot, once the slot count is final for the
+// frame. Growing the buffer retires the old one through the Vulkan context,
+// which is not thread-safe, and the cull workers start here for the same
+// reason, so build_render_object_snapshot never touches shared state.
+void prepare_render_object_snapshot(State& in_state)
+{
+	State::RenderObjectState& render_objects = in_state.render_objects;
+	RenderObjectStore& store = render_objects.store;
+	if (render_object_snapshot_ensure_capacity(in_state, render_object_store_slot_count(store)))
 	{
-		in_state.data_oriented.frame.object_update_scan_count += 1;
-		object.render_object_index = -1;
+		render_object_store_invalidate_all(store);
+		store.counters.full_uploads += 1;
 	}
 
-	render_objects.items.clear();
-	render_object_snapshot_ensure_capacity(in_state, (i32) in_state.scene.indexes.mesh_object_ids.length());
+	State::CullingState& culling = in_state.culling;
+	if (!culling.workers.is_started() && render_object_store_live_count(store) >= CULL_PARALLEL_MIN_ENTRIES)
+	{
+		culling.workers.start_shared();
+		culling.engine.workers = &culling.workers;
+	}
+}
 
-	for (i32 mesh_object_id : in_state.scene.indexes.mesh_object_ids)
+// Re-packs the dirty render-object slots and stages the rows whose GPU
+// fields changed; upload_render_object_snapshot records the copy. Runs as a
+// frame task beside pack_lights and pack_skin_matrices once transforms are
+// final and prepare_render_object_snapshot has sized the buffer, so it only
+// reads the scene and writes render-object and culling state.
+void build_render_object_snapshot(State& in_state)
+{
+	State::RenderObjectState& render_objects = in_state.render_objects;
+	RenderObjectStore& store = render_objects.store;
+	assert(render_object_store_slot_count(store) <= render_objects.buffer_capacity);
+
+	render_objects.dirty_slots.clear();
+	render_objects.upload_slots.clear();
+	render_objects.moved_bounds.clear();
+	render_object_store_take_dirty(store, render_objects.dirty_slots);
+	for (i32 slot : render_objects.dirty_slots)
 	{
-		auto found = in_state.scene.objects.find(mesh_object_id);
+		auto found = in_state.scene.objects.find(store.slot_object_ids[slot]);
 		if (found == in_state.scene.objects.end())
 		{
 			continue;
 		}
 
-		Object& object = found->second;
-		in_state.data_oriented.frame.object_update_storage_updates += 1;
-		if (object.has_mesh) in_state.data_oriented.frame.object_update_mesh_dirty_count += 1;
-		object.render_object_index = (i32) render_objects.items.length();
-		render_objects.items.add(object_make_render_data(object));
+		const Object& object = found->second;
+		const ObjectData row = object_make_render_data(object);
+		const BoundingBox bounds = object_get_bounding_box(object);
+		const bool had_bounds = store.cull_flags[slot] != 0;
+		const BoundingBox previous_bounds = cull_bounds_get(store.bounds, slot);
+		const size_t changed_cull_count = store.changed_cull_slots.length();
+		const bool row_changed = render_object_store_write(store, slot, row.model_matrix, row.rotation_matrix, row.material_index, bounds, mesh_is_always_visible(object.mesh));
+		if (row_changed)
+		{
+			render_objects.upload_slots.add(slot);
+		}
+		// Cached shadow cascades covering either box are stale
+		if (row_changed || store.changed_cull_slots.length() != changed_cull_count)
+		{
+			if (had_bounds)
+			{
+				render_objects.moved_bounds.add(previous_bounds);
+			}
+			render_objects.moved_bounds.add(bounds);
+		}
+	}
+
+	// Culling reads the same bounds; hand it this flush's changes
+	State::CullingState& culling = in_state.culling;
+	cull_engine_sync(culling.engine, store.bounds, store.cull_flags, store.released_cull_slots, store.changed_cull_slots);
+	store.released_cull_slots.clear();
+	store.changed_cull_slots.clear();
+
+	render_object_store_build_ranges(render_objects.upload_slots, render_objects.upload_ranges);
+	render_objects.upload_rows.clear();
+	render_objects.upload_regions.clear();
+	render_objects.upload_rows.reserve(render_objects.upload_slots.length());
+	for (const RenderObjectStoreRange& range : render_objects.upload_ranges)
+	{
+		for (i32 slot = range.first_slot; slot < range.first_slot + range.slot_count; ++slot)
+		{
+			render_objects.upload_rows.add((ObjectData) {
+				.model_matrix = store.model_matrices[slot],
+				.rotation_matrix = store.rotation_matrices[slot],
+				.material_index = store.material_indices[slot],
+			});
+		}
+	}
+	size_t row_offset = 0;
+	for (const RenderObjectStoreRange& range : render_objects.upload_ranges)
+	{
+		render_objects.upload_regions.add({
+			.data = render_objects.upload_rows.data() + row_offset,
+			.dst_offset = sizeof(ObjectData) * (u64) range.first_slot,
+			.size = sizeof(ObjectData) * (u64) range.slot_count,
+		});
+		row_offset += (size_t) range.slot_count;
+	}
+}
+
+// Records the copy of the rows build_render_object_snapshot staged. Runs on
+// the main thread after begin_frame, so the copy is recorded ahead of every
+// pass that reads the buffer this frame.
+void upload_render_object_snapshot(State& in_state)
+{
+	State::RenderObjectState& render_objects = in_state.render_objects;
+	RenderObjectStore& store = render_objects.store;
+	RenderObjectStoreCounters& counters = store.counters;
+	if (!render_objects.upload_regions.empty())
+	{
+		vulkan_upload_record_buffer_regions(
+			&in_state.vk,
+			render_objects.buffer.get_gpu_buffer(),
+			render_objects.upload_regions.data(),
+			(u32) render_objects.upload_regions.length(),
+			VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+			VK_ACCESS_2_SHADER_STORAGE_READ_BIT
+		);
+		counters.upload_frames += 1;
 	}
 
-	render_objects.upload();
+	const u64 uploaded_bytes = sizeof(ObjectData) * (u64) render_objects.upload_rows.length();
+	counters.frames += 1;
+	counters.rows_packed += render_objects.dirty_slots.length();
+	counters.rows_uploaded += render_objects.upload_rows.length();
+	counters.upload_bytes += uploaded_bytes;
+	counters.copy_regions += render_objects.upload_regions.length();
+	counters.rebuild_bytes += sizeof(ObjectData) * (u64) render_object_store_live_count(store);
+	in_state.data_oriented.frame.object_update_scan_count += (i32) render_objects.dirty_slots.length();
+	in_state.data_oriented.frame.object_update_storage_updates += (i32) render_objects.upload_rows.length();
+	in_state.data_oriented.frame.object_update_mesh_dirty_count += (i32) render_objects.dirty_slots.length();
+	render_objects.valid = render_object_store_live_count(store) > 0;
 }
 
 // The buffer descriptor writes bind every frame (always valid — capacity is
 // pre-created at init so empty scenes still have a buffer to bind)
 GpuBuffer<ObjectData>& get_render_object_snapshot_buffer(State& in_state)
 {
-	return in_state.render_objects.current();
+	return in_state.render_objects.buffer;
 }
 
 // Fixed-size materials SSBO, created once and kept valid across scene resets.
@@ -854,7 +1036,7 @@ void update_materials_buffer(State& in_state)
 	);
 }
 
-// Grows the skin matrix arena ring (clone of the snapshot grower)
+// Grows the skin matrix arena ring (doubling; old buffers are deferred-destroyed)
 void skin_matrix_arena_ensure_capacity(State& in_state, i32 in_required_capacity)
 {
 	in_state.skin_matrices.configure(
@@ -864,8 +1046,9 @@ void skin_matrix_arena_ensure_capacity(State& in_state, i32 in_required_capacity
 	in_state.skin_matrices.ensure_capacity(in_required_capacity);
 }
 
-// Advances the arena ring and uploads this frame's packed matrices. Runs
-// before begin_frame (same ring-depth safety argument as the snapshot).
+// Advances the arena ring and uploads this frame's packed matrices. With a
+// 3-buffer ring and 2 frames in flight, the buffer written here was last
+// consumed 3 frames ago.
 void skin_matrix_arena_upload(State& in_state)
 {
 	in_state.skin_matrices.upload();
@@ -876,6 +1059,16 @@ GpuBuffer<HMM_Mat4>& get_skin_matrix_arena_buffer(State& in_state)
 	return in_state.skin_matrices.current();
 }
 
+// Call after changing an object's transform outside
+// scene_insert_or_replace_object; its render row is re-packed next frame
+void scene_mark_render_object_dirty(State& in_state, const Object& in_object)
+{
+	if (in_object.render_object_index >= 0)
+	{
+		render_object_store_mark_dirty(in_state.render_objects.store, in_object.render_object_index);
+	}
+}
+
 void mark_lighting_dirty(State& in_state)
 {
 	in_state.lighting.needs_data_update = true;
@@ -912,18 +1105,26 @@ void scene_invalidate_cached_object_ids(State& in_state, i32 in_unique_id)
 	}
 }
 
+// Queues a GI layout patch around a contributing object's old or new box
+void scene_mark_gi_region_dirty(State& in_state, const BoundingBox& in_bounds)
+{
+	in_state.gi.layout_dirty = true;
+	in_state.gi.layout_dirty_regions.add(in_bounds);
+}
+
 void scene_insert_or_replace_object(State& in_state, Object&& in_object)
 {
 	const i32 unique_id = in_object.unique_id;
 	bool lighting_changed = in_object.has_light;
-	bool gi_scene_geometry_changed = object_contributes_to_gi_scene(in_object);
 
 	auto found = in_state.scene.objects.find(unique_id);
 	if (found != in_state.scene.objects.end())
 	{
 		lighting_changed = lighting_changed || found->second.has_light;
-		gi_scene_geometry_changed =
-			gi_scene_geometry_changed || object_contributes_to_gi_scene(found->second);
+		if (object_contributes_to_gi_scene(found->second))
+		{
+			scene_mark_gi_region_dirty(in_state, object_get_bounding_box(found->second));
+		}
 		scene_invalidate_cached_object_ids(in_state, unique_id);
 		object_cleanup(found->second);
 		found->second = std::move(in_object);
@@ -933,15 +1134,99 @@ void scene_insert_or_replace_object(State& in_state, Object&& in_object)
 		in_state.scene.objects[unique_id] = std::move(in_object);
 	}
 
-	scene_mark_indexes_dirty(in_state);
+	Object& object = in_state.scene.objects[unique_id];
+	scene_indexes_set(in_state.scene.indexes, unique_id, scene_index_object_info(object));
+	if (scene_index_contains(in_state.scene.indexes, unique_id, ESceneIndexList::Mesh))
+	{
+		object.render_object_index = render_object_store_acquire(in_state.render_objects.store, unique_id);
+	}
+	else
+	{
+		render_object_store_release(in_state.render_objects.store, unique_id);
+		object.render_object_index = -1;
+	}
 	if (lighting_changed)
 	{
 		mark_lighting_dirty(in_state);
 	}
-	if (gi_scene_geometry_changed)
+	if (object_contributes_to_gi_scene(object))
+	{
+		scene_mark_gi_region_dirty(in_state, object_get_bounding_box(object));
+	}
+}
+
+// Moves an existing object in place (live-link transform deltas). Rigid
+// bodies and characters are teleported; a scale change rebuilds the body
+// because Jolt bakes scale into the shape. Mesh data is untouched. A delta
+// for an object the scene doesn't have is logged and dropped.
+bool scene_set_object_transform(State& in_state, i32 in_unique_id, const Transform& in_transform)
+{
+	auto found = in_state.scene.objects.find(in_unique_id);
+	if (found == in_state.scene.objects.end())
+	{
+		printf("Dropping transform delta for unknown object. UID: %i\n", in_unique_id);
+		return false;
+	}
+
+	Object& object = found->second;
+	if (object_contributes_to_gi_scene(object))
+	{
+		scene_mark_gi_region_dirty(in_state, object_get_bounding_box(object));
+	}
+	const HMM_Vec3 previous_scale = object.current_transform.scale;
+	const bool scale_changed =
+		previous_scale.X != in_transform.scale.X ||
+		previous_scale.Y != in_transform.scale.Y ||
+		previous_scale.Z != in_transform.scale.Z;
+
+	object.initial_transform = in_transform;
+	object.current_transform = in_transform;
+	scene_mark_render_object_dirty(in_state, object);
+
+	const JPH::RVec3 jolt_location(in_transform.location.X, in_transform.location.Y, in_transform.location.Z);
+	const JPH::Quat jolt_rotation(in_transform.rotation.X, in_transform.rotation.Y, in_transform.rotation.Z, in_transform.rotation.W);
+	if (object.has_rigid_body && object.rigid_body.jolt_body != nullptr)
+	{
+		if (scale_changed)
+		{
+			object_reset_jolt_body(object);
+		}
+		else
+		{
+			// Same resting state a rebuilt body would start in
+			JPH::BodyInterface& body_interface = jolt_state.physics_system.GetBodyInterface();
+			const JPH::BodyID body_id = object.rigid_body.jolt_body->GetID();
+			const bool is_dynamic = object.rigid_body.is_dynamic;
+			body_interface.SetPositionAndRotation(
+				body_id,
+				jolt_location,
+				jolt_rotation,
+				is_dynamic ? JPH::EActivation::Activate : JPH::EActivation::DontActivate
+			);
+			if (is_dynamic)
+			{
+				body_interface.SetLinearAndAngularVelocity(body_id, JPH::Vec3::sZero(), JPH::Vec3::sZero());
+			}
+		}
+	}
+
+	if (object.has_character && object.character.jph_character)
+	{
+		object.character.settings.initial_location = in_transform.location;
+		object.character.settings.initial_rotation = in_transform.rotation;
+		object.character.jph_character->SetPositionAndRotation(jolt_location, jolt_rotation);
+		object.character.jph_character->SetLinearVelocity(JPH::Vec3::sZero());
+	}
+
+	if (object.has_light)
+	{
+		mark_lighting_dirty(in_state);
+	}
+	if (object_contributes_to_gi_scene(object))
 	{
-		in_state.gi.layout_dirty = true;
+		scene_mark_gi_region_dirty(in_state, object_get_bounding_box(object));
 	}
+	return true;
 }
 
 bool scene_remove_object(State& in_state, i32 in_unique_id)
@@ -953,20 +1238,20 @@ bool scene_remove_object(State& in_state, i32 in_unique_id)
 	}
 
 	const bool lighting_changed = found->second.has_light;
-	const bool gi_scene_geometry_changed = object_contributes_to_gi_scene(found->second);
+	if (object_contributes_to_gi_scene(found->second))
+	{
+		scene_mark_gi_region_dirty(in_state, object_get_bounding_box(found->second));
+	}
 	scene_invalidate_cached_object_ids(in_state, in_unique_id);
 	object_cleanup(found->second);
 	in_state.scene.objects.erase(found);
-	scene_mark_indexes_dirty(in_state);
+	scene_indexes_remove(in_state.scene.indexes, in_unique_id);
+	render_object_store_release(in_state.render_objects.store, in_unique_id);
 
 	if (lighting_changed)
 	{
 		mark_lighting_dirty(in_state);
 	}
-	if (gi_scene_geometry_changed)
-	{
-		in_state.gi.layout_dirty = true;
-	}
 	return true;
 }
 
@@ -990,9 +1275,13 @@ void scene_clear_objects(State& in_state)
 	in_state.fog.active_fog_controller_id.reset();
 	in_state.fog.active = false;
 	in_state.tonemapping.adaptation_reset_requested = true;
-	scene_reset_indexes(in_state);
+	scene_indexes_clear(in_state.scene.indexes);
+	render_object_store_clear(in_state.render_objects.store);
+	cull_engine_clear(in_state.culling.engine);
 	mark_lighting_dirty(in_state);
 	in_state.gi.layout_dirty = true;
+	in_state.gi.layout_rebuild_all = true;
+	in_state.gi.layout_dirty_regions.reset();
 }
 
 // Fixed-size light SSBO rings, created once at init (bindings must always
@@ -1022,8 +1311,8 @@ void init_lighting_buffers(State& in_state)
 	}
 }
 
-// Rebuilds the packed CPU light arrays from the scene when dirty.
-// The lighting pass uploads the packed arrays through per-type stream rings.
+// Rebuilds the packed CPU light arrays from the scene when dirty. A frame
+// task like build_render_object_snapshot; upload_lights sends the arrays.
 void pack_lights(State& in_state)
 {
 	if (!in_state.lighting.needs_data_update)
@@ -1038,7 +1327,6 @@ void pack_lights(State& in_state)
 	lighting.sun_lights.clear();
 	lighting.active_atmosphere_sun_index = -1;
 
-	scene_ensure_indexes(in_state);
 	in_state.data_oriented.frame.lighting_candidate_count += (i32) in_state.scene.indexes.light_object_ids.length();
 	for (i32 light_object_id : in_state.scene.indexes.light_object_ids)
 	{
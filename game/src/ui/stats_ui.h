@@ -120,6 +120,10 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_i32("Vertices", import.mesh_vertex_count);
 			stats_ui_cell_i32("Indices", import.mesh_index_count);
 
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Quantized Meshes", import.quantized_mesh_count);
+			stats_ui_cell_i32("Compact Meshes", import.compact_mesh_count);
+
 			ImGui::TableNextRow();
 			stats_ui_cell_i32("Lights", import.light_count);
 			stats_ui_cell_i32("Armatures", import.armature_count);
@@ -128,6 +132,14 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_i32("Animations", import.animation_count);
 			stats_ui_cell_i32("Matrices", import.animation_matrix_count);
 
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Compact Animations", import.compact_animation_count);
+			stats_ui_cell_i32("Compressed Animations", import.compressed_animation_count);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Animation Matrix Bytes", import.animation_matrix_bytes);
+			stats_ui_cell_u64("Animation Bytes", import.animation_stored_bytes);
+
 			ImGui::TableNextRow();
 			stats_ui_cell_i32("Materials", import.material_count);
 			stats_ui_cell_i32("Images", import.image_count);
@@ -135,6 +147,38 @@ static void draw_stats_ui(State& state)
 			ImGui::TableNextRow();
 			stats_ui_cell_u64("Image Bytes", import.image_byte_count);
 			stats_ui_cell_i32("Malformed", import.malformed_object_count);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_seconds("Mesh Decode", import.mesh_decode_seconds);
+			stats_ui_cell_i32("Decode Workers", import.mesh_decode_worker_count);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Decode Arena Bytes", import.mesh_decode_arena_bytes);
+			stats_ui_cell_i32("Transforms", import.transform_count);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Mesh References", import.mesh_reference_count);
+			stats_ui_cell_i32("Image References", import.image_reference_count);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Chunks", import.chunk_count);
+			stats_ui_cell_seconds("Chunk Transfer", import.chunk_transfer_seconds);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Mesh Cache Hits", import.mesh_cache_hits);
+			stats_ui_cell_i32("Mesh Cache Misses", import.mesh_cache_misses);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Image Cache Hits", import.image_cache_hits);
+			stats_ui_cell_i32("Image Cache Misses", import.image_cache_misses);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_seconds("Texture Processing", import.texture_process_seconds);
+			stats_ui_cell_i32("Texture Cache Hits", import.texture_cache_hits);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Texture Bytes", import.texture_byte_count);
+			stats_ui_cell_bool("BC Textures", state.vk.texture_compression_bc_enabled);
 			ImGui::EndTable();
 		}
 
@@ -152,6 +196,14 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_i32("Reset Events", previous.live_link_reset_count);
 			stats_ui_cell_i32("Object Scans", previous.object_update_scan_count);
 
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Queue Depth", previous.live_link_queue_depth);
+			stats_ui_cell_i32("Queue Wait (us)", previous.live_link_queue_wait_us);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Producer Wait (us)", previous.live_link_producer_wait_us);
+			stats_ui_cell_i32("Queue Capacity", (i32) state.live_link.scene_updates.capacity());
+
 			ImGui::TableNextRow();
 			stats_ui_cell_i32("Storage Updates", previous.object_update_storage_updates);
 			stats_ui_cell_i32("Mesh Dirty", previous.object_update_mesh_dirty_count);
@@ -164,6 +216,10 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_i32("Skin Candidates", previous.animation_skinned_mesh_candidates);
 			stats_ui_cell_i32("Skin Matrix Uploads", previous.animation_skin_matrix_uploads);
 
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Skinned Bounds Updates", previous.animation_skinned_bounds_updates);
+			stats_ui_cell_i32("Shared Skin Rows", previous.animation_skin_rows_shared);
+
 			ImGui::TableNextRow();
 			stats_ui_cell_i32("Lighting Processed", previous.lighting_processed_count);
 			stats_ui_cell_i32("Lighting Candidates", previous.lighting_candidate_count);
@@ -180,6 +236,20 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_i32("Draw Calls", previous.draw_calls);
 			stats_ui_cell_i32("Draw Meshes", previous.draw_mesh_count);
 
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Indirect Meshes", previous.indirect_draw_meshes);
+			stats_ui_cell_i32("Pooled Meshes", previous.indirect_pool_meshes);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Mesh Pool Bytes", previous.indirect_pool_bytes);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Shadow Cascades Drawn", previous.shadow_cascades_rendered);
+			stats_ui_cell_i32("Shadow Cascades Cached", previous.shadow_cascades_cached);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Transformed Objects", previous.live_link_transformed_objects);
+
 			ImGui::EndTable();
 		}
 	}
@@ -237,6 +307,27 @@ static void draw_stats_ui(State& state)
 		}
 	}
 
+	if (ImGui::CollapsingHeader("Instancing"))
+	{
+		if (ImGui::BeginTable("##InstancingStats", 4, stats_table_flags))
+		{
+			stats_ui_table_columns();
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Instance Groups", previous.instance_groups);
+			stats_ui_cell_i32("Instanced Meshes", previous.instanced_meshes);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_i32("Indirect Meshes", previous.indirect_draw_meshes);
+			stats_ui_cell_i32("Indirect Commands", previous.indirect_draw_commands);
+
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Bytes Saved", previous.instancing_bytes_saved);
+			stats_ui_cell_u64("Mesh Pool Bytes", previous.indirect_pool_bytes);
+			ImGui::EndTable();
+		}
+		ImGui::TextDisabled("Linked duplicates share one pool entry and draw as one instanced command per view");
+	}
+
 	if (ImGui::CollapsingHeader("Vulkan / VMA stats"))
 	{
 		const VulkanMemoryStats memory = vulkan_context_get_memory_stats(&state.vk);
@@ -257,12 +348,36 @@ static void draw_stats_ui(State& state)
 			stats_ui_cell_u64("Draw Calls", metrics.draw_calls);
 			stats_ui_cell_u64("Dispatch Calls", metrics.dispatch_calls);
 			ImGui::TableNextRow();
+			stats_ui_cell_u64("Indirect Commands", metrics.indirect_commands);
+			stats_ui_cell_u64("Instancing Bytes Saved", metrics.instancing_bytes_saved);
+			ImGui::TableNextRow();
 			stats_ui_cell_u64("Descriptor Updates", metrics.descriptor_update_calls);
 			stats_ui_cell_u64("Descriptors Written", metrics.descriptors_written);
 			ImGui::TableNextRow();
 			stats_ui_cell_u64("Uploaded Bytes", metrics.upload_bytes);
 			stats_ui_cell_u64("Immediate Submits", metrics.immediate_submit_count);
 			ImGui::TableNextRow();
+			stats_ui_cell_u64("Async Upload Bytes", metrics.upload_async_bytes);
+			stats_ui_cell_u64("Pending Async Uploads", metrics.upload_async_pending_jobs);
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Texture VRAM", state.images.vram_bytes);
+			stats_ui_cell_u64("Texture VRAM Saved", state.images.vram_saved_bytes);
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Streaming Budget", state.images.streaming.budget_bytes);
+			stats_ui_cell_u64("Streaming Resident", state.images.streaming.resident_bytes + state.images.streaming.pending_bytes);
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Stream-Ins", state.images.streaming.stats.stream_in_count);
+			stats_ui_cell_u64("Evictions", state.images.streaming.stats.eviction_count);
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Frames Over Budget", state.images.streaming.stats.over_budget_frames);
+			stats_ui_cell_u64("Stream-In p95 (frames)", (u64) texture_streaming_percentile(state.images.streaming.latency_frames, 0.95f));
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Barriers / Frame", metrics.frame_barriers);
+			stats_ui_cell_u64("Barrier Batches / Frame", metrics.frame_barrier_batches);
+			ImGui::TableNextRow();
+			stats_ui_cell_u64("Transient Target Heap", metrics.transient_heap_bytes);
+			stats_ui_cell_u64("Transient Bytes Saved", metrics.transient_target_bytes - metrics.transient_heap_bytes);
+			ImGui::TableNextRow();
 			stats_ui_cell_u64("Queue Idle Waits", metrics.queue_wait_idle_count);
 			stats_ui_cell_u64("Device Idle Waits", metrics.device_wait_idle_count);
 			ImGui::EndTable();
@@ -271,10 +386,11 @@ static void draw_stats_ui(State& state)
 			(unsigned long long)metrics.pipeline_count,
 			metrics.pipeline_creation_ms,
 			(unsigned long long)state.vk.shader_build_hash);
-		ImGui::TextDisabled("GPU: %s | queues G:%u P:%u | present: %s | screenshots: %s",
+		ImGui::TextDisabled("GPU: %s | queues G:%u P:%u T:%u | present: %s | screenshots: %s",
 			state.vk.physical_device_properties.deviceName,
 			state.vk.graphics_queue_family_index,
 			state.vk.present_queue_family_index,
+			state.vk.transfer_queue_family_index,
 			vulkan_present_mode_name(state.vk.present_mode),
 			state.vk.screenshot_supported ? "yes" : "no");
 		ImGui::TextDisabled("Formats: scene %i | depth %i | G-buffer %i | shadow %i | SSAO %i",
@@ -0,0 +1,534 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "core/dynamic_array.h"
+#include "live_link/live_link_animation_decode.h"
+#include "test_random.h"
+
+using namespace Blender::LiveLink;
+
+static HMM_Vec3 random_direction(Random& in_random)
+{
+	const HMM_Vec3 direction = HMM_V3(in_random.range(-1.0f, 1.0f), in_random.range(-1.0f, 1.0f), in_random.range(-1.0f, 1.0f));
+	return HMM_LenV3(direction) > 0.001f ? HMM_NormV3(direction) : HMM_V3(0.0f, 0.0f, 1.0f);
+}
+
+static HMM_Quat random_rotation(Random& in_random)
+{
+	return HMM_QFromAxisAngle_RH(random_direction(in_random), in_random.range(-3.14159f, 3.14159f));
+}
+
+// Frame-major clip matrices, laid out like AnimationClip::skin_matrices
+struct ClipFixture
+{
+	i32 frame_count = 0;
+	i32 bone_count = 0;
+	DynamicArray<HMM_Mat4> skin_matrices;
+
+	HMM_Mat4& at(i32 in_frame_idx, i32 in_bone_idx) { return skin_matrices[(size_t) in_frame_idx * bone_count + in_bone_idx]; }
+};
+
+// A branching rig: each bone swings about its own axis at its own rate, some
+// bones also translate (root motion) or pulse a uniform scale, and a few
+// unparented ones are held still. Skin matrices are global pose * inverse bind, as the exporter
+// writes them.
+static ClipFixture make_rig_clip(Random& in_random, i32 in_frame_count, i32 in_bone_count)
+{
+	ClipFixture clip;
+	clip.frame_count = in_frame_count;
+	clip.bone_count = in_bone_count;
+	clip.skin_matrices.resize((size_t) in_frame_count * in_bone_count);
+
+	struct BoneSpec
+	{
+		i32 parent;
+		HMM_Vec3 offset;
+		HMM_Quat rest;
+		HMM_Vec3 axis;
+		f32 amplitude;
+		f32 rate;
+		f32 phase;
+		HMM_Vec3 drift;
+		f32 scale_pulse;
+	};
+	DynamicArray<BoneSpec> bones;
+	for (i32 bone_idx = 0; bone_idx < in_bone_count; ++bone_idx)
+	{
+		const bool is_still = bone_idx % 7 == 3;
+		bones.add({
+			.parent = bone_idx == 0 || is_still ? -1 : (i32) (in_random.next() % bone_idx),
+			.offset = random_direction(in_random) * in_random.range(0.05f, 0.4f),
+			.rest = random_rotation(in_random),
+			.axis = random_direction(in_random),
+			.amplitude = is_still ? 0.0f : in_random.range(0.1f, 1.0f),
+			.rate = in_random.range(0.5f, 3.0f),
+			.phase = in_random.range(0.0f, 6.28f),
+			.drift = bone_idx == 0 ? HMM_V3(0.01f, 0.0f, 0.003f) : HMM_V3(0.0f, 0.0f, 0.0f),
+			.scale_pulse = bone_idx % 5 == 2 ? 0.2f : 0.0f,
+		});
+	}
+
+	DynamicArray<HMM_Mat4> bind_inverse;
+	DynamicArray<HMM_Mat4> global;
+	bind_inverse.resize(in_bone_count);
+	global.resize(in_bone_count);
+	for (i32 frame_idx = -1; frame_idx < in_frame_count; ++frame_idx)
+	{
+		// Frame -1 is the bind pose
+		const f32 time = (f32) MAX(frame_idx, 0) / 30.0f;
+		for (i32 bone_idx = 0; bone_idx < in_bone_count; ++bone_idx)
+		{
+			const BoneSpec& bone = bones[bone_idx];
+			HMM_Quat rotation = bone.rest;
+			HMM_Vec3 translation = bone.offset;
+			f32 scale = 1.0f;
+			if (frame_idx >= 0)
+			{
+				const f32 angle = bone.amplitude * sinf(time * bone.rate + bone.phase);
+				rotation = HMM_MulQ(bone.rest, HMM_QFromAxisAngle_RH(bone.axis, angle));
+				translation = translation + bone.drift * (f32) frame_idx;
+				scale = 1.0f + bone.scale_pulse * sinf(time * bone.rate);
+			}
+			const HMM_Mat4 local = animation_compose_trs(translation, rotation, HMM_V3(scale, scale, scale));
+			global[bone_idx] = bone.parent >= 0 ? HMM_MulM4(global[bone.parent], local) : local;
+			if (frame_idx < 0)
+			{
+				bind_inverse[bone_idx] = HMM_InvGeneralM4(global[bone_idx]);
+			}
+			else
+			{
+				clip.at(frame_idx, bone_idx) = HMM_MulM4(global[bone_idx], bind_inverse[bone_idx]);
+			}
+		}
+	}
+	return clip;
+}
+
+static f32 matrix_scale(const HMM_Mat4& in_matrix)
+{
+	return MAX(MAX(HMM_LenV3(in_matrix.Columns[0].XYZ), HMM_LenV3(in_matrix.Columns[1].XYZ)), HMM_LenV3(in_matrix.Columns[2].XYZ));
+}
+
+// Error bound from animation_compression.h for points within in_radius
+static f32 reconstruction_bound(f32 in_radius, f32 in_scale)
+{
+	return ANIMATION_TRANSLATION_TOLERANCE
+		+ in_radius * (ANIMATION_ROTATION_TOLERANCE * in_scale + ANIMATION_SCALE_TOLERANCE)
+		+ 1.7320508f * in_radius * ANIMATION_DECOMPOSE_TOLERANCE * in_scale;
+}
+
+// Largest error, relative to the bound, of points within in_radius moved by
+// the reconstructed matrix instead of the source one
+static f32 worst_relative_error(const HMM_Mat4& in_source, const HMM_Mat4& in_reconstructed, f32 in_radius)
+{
+	f32 worst = 0.0f;
+	const f32 bound = reconstruction_bound(in_radius, matrix_scale(in_source));
+	for (i32 corner = 0; corner < 8; ++corner)
+	{
+		const f32 edge = in_radius / 1.7320508f;
+		const HMM_Vec4 point = HMM_V4(corner & 1 ? edge : -edge, corner & 2 ? edge : -edge, corner & 4 ? edge : -edge, 1.0f);
+		const f32 error = HMM_LenV3((in_source * point).XYZ - (in_reconstructed * point).XYZ);
+		worst = MAX(worst, error / bound);
+	}
+	return worst;
+}
+
+void test_packed_quaternion()
+{
+	Random random;
+	f64 worst_error = 0.0;
+	for (i32 sample_idx = 0; sample_idx < 100000; ++sample_idx)
+	{
+		HMM_Quat quat = random_rotation(random);
+		if (sample_idx % 3 == 0)
+		{
+			quat = HMM_Q(-quat.X, -quat.Y, -quat.Z, -quat.W);
+		}
+		const PackedQuaternion packed = packed_quaternion_encode(quat);
+		worst_error = MAX(worst_error, animation_rotation_error(packed_quaternion_decode(packed), HMM_NormQ(quat)));
+	}
+	// 15 bits over [-1/sqrt(2), 1/sqrt(2)]
+	assert(worst_error < 0.0002);
+
+	// Each component can be the dropped one
+	const HMM_Quat axes[] = { HMM_Q(1, 0, 0, 0), HMM_Q(0, 1, 0, 0), HMM_Q(0, 0, -1, 0), HMM_Q(0, 0, 0, 1) };
+	for (const HMM_Quat& axis : axes)
+	{
+		assert(animation_rotation_error(packed_quaternion_decode(packed_quaternion_encode(axis)), axis) < 0.0001);
+	}
+}
+
+void test_decompose()
+{
+	Random random;
+	for (i32 sample_idx = 0; sample_idx < 1000; ++sample_idx)
+	{
+		const HMM_Vec3 translation = random_direction(random) * random.range(0.0f, 10.0f);
+		const HMM_Quat rotation = random_rotation(random);
+		HMM_Vec3 scale = HMM_V3(random.range(0.2f, 3.0f), random.range(0.2f, 3.0f), random.range(0.2f, 3.0f));
+		if (sample_idx % 4 == 0)
+		{
+			scale.X = -scale.X;
+		}
+		const HMM_Mat4 matrix = animation_compose_trs(translation, rotation, scale);
+
+		HMM_Vec3 out_translation, out_scale;
+		HMM_Quat out_rotation;
+		assert(animation_decompose_trs(matrix, out_translation, out_rotation, out_scale));
+		const HMM_Mat4 rebuilt = animation_compose_trs(out_translation, out_rotation, out_scale);
+		for (i32 column_idx = 0; column_idx < 4; ++column_idx)
+		{
+			assert(HMM_LenV4(rebuilt.Columns[column_idx] - matrix.Columns[column_idx]) < 0.0001f * 3.0f);
+		}
+	}
+
+	HMM_Vec3 translation, scale;
+	HMM_Quat rotation;
+
+	HMM_Mat4 shear = HMM_M4D(1.0f);
+	shear.Columns[1].X = 0.3f;
+	assert(!animation_decompose_trs(shear, translation, rotation, scale));
+
+	HMM_Mat4 collapsed = HMM_M4D(1.0f);
+	collapsed.Columns[2] = HMM_V4(0.0f, 0.0f, 0.0f, 0.0f);
+	assert(!animation_decompose_trs(collapsed, translation, rotation, scale));
+
+	HMM_Mat4 projective = HMM_M4D(1.0f);
+	projective.Columns[0].W = 0.5f;
+	assert(!animation_decompose_trs(projective, translation, rotation, scale));
+}
+
+void test_rig_reconstruction_error()
+{
+	Random random;
+	const i32 frame_count = 240;
+	const i32 bone_count = 40;
+	ClipFixture clip = make_rig_clip(random, frame_count, bone_count);
+
+	AnimationReductionScratch scratch;
+	CompressedAnimation compressed;
+	assert(animation_compress(clip.skin_matrices.data(), frame_count, bone_count, compressed, scratch));
+	assert(compressed_animation_is_valid(compressed));
+	assert(compressed_animation_byte_count(compressed) < sizeof(HMM_Mat4) * (u64) frame_count * bone_count / 2);
+
+	const f32 radii[] = { 0.1f, 1.0f, 2.0f };
+	f32 worst = 0.0f;
+	for (i32 frame_idx = 0; frame_idx < frame_count; ++frame_idx)
+	{
+		for (i32 bone_idx = 0; bone_idx < bone_count; ++bone_idx)
+		{
+			const HMM_Mat4 reconstructed = animation_sample_bone(compressed, bone_idx, (f32) frame_idx);
+			for (f32 radius : radii)
+			{
+				worst = MAX(worst, worst_relative_error(clip.at(frame_idx, bone_idx), reconstructed, radius));
+			}
+		}
+	}
+	printf("rig %i bones x %i frames: worst error %.2f of bound\n", bone_count, frame_count, worst);
+	assert(worst <= 1.0f);
+
+	// Still bones are one key per channel
+	for (i32 bone_idx = 3; bone_idx < bone_count; bone_idx += 7)
+	{
+		assert(compressed.tracks[bone_idx * ANIMATION_CHANNEL_COUNT + (i32) EAnimationChannel::Rotation].key_count == 1);
+	}
+
+	compressed_animation_free(compressed);
+}
+
+void test_track_reduction_and_fractional_sampling()
+{
+	// Bone 0 slides linearly and turns at constant speed; bone 1 is still
+	const i32 frame_count = 101;
+	ClipFixture clip;
+	clip.frame_count = frame_count;
+	clip.bone_count = 2;
+	clip.skin_matrices.resize(frame_count * 2);
+	const HMM_Vec3 axis = HMM_NormV3(HMM_V3(0.2f, 1.0f, 0.1f));
+	for (i32 frame_idx = 0; frame_idx < frame_count; ++frame_idx)
+	{
+		clip.at(frame_idx, 0) = animation_compose_trs(
+			HMM_V3(0.02f * frame_idx, 1.0f, -0.01f * frame_idx),
+			HMM_QFromAxisAngle_RH(axis, 0.001f * frame_idx),
+			HMM_V3(1.0f, 1.0f, 1.0f));
+		clip.at(frame_idx, 1) = animation_compose_trs(HMM_V3(0.0f, 2.0f, 0.0f), HMM_Q(0, 0, 0, 1), HMM_V3(2.0f, 2.0f, 2.0f));
+	}
+
+	AnimationClip animation = {
+		.frame_rate = 30.0f,
+		.frame_count = frame_count,
+		.bone_count = 2,
+	};
+	animation.skin_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * frame_count * 2);
+	memcpy(animation.skin_matrices, clip.skin_matrices.data(), sizeof(HMM_Mat4) * frame_count * 2);
+	AnimationReductionScratch scratch;
+	assert(animation_clip_compress(animation, scratch));
+	assert(animation_clip_is_compressed(animation) && !animation.skin_matrices);
+
+	const AnimationTrack* tracks = animation.compressed.tracks;
+	assert(tracks[(i32) EAnimationChannel::Translation].key_count == 2);
+	assert(tracks[(i32) EAnimationChannel::Rotation].key_count == 2);
+	assert(tracks[(i32) EAnimationChannel::Scale].key_count == 1);
+	for (i32 channel_idx = 0; channel_idx < ANIMATION_CHANNEL_COUNT; ++channel_idx)
+	{
+		assert(tracks[ANIMATION_CHANNEL_COUNT + channel_idx].key_count == 1);
+	}
+
+	// Between keys the sample follows the line, not the nearest frame
+	HMM_Mat4 pose[2];
+	animation_clip_sample_pose(animation, 37.25f, pose, 2);
+	assert(HMM_LenV3(pose[0].Columns[3].XYZ - HMM_V3(0.02f * 37.25f, 1.0f, -0.01f * 37.25f)) < 0.0001f);
+	assert(fabsf(pose[1].Columns[1].Y - 2.0f) < 0.0001f);
+
+	// Frames past the ends hold the end keys
+	animation_clip_sample_pose(animation, 500.0f, pose, 1);
+	assert(HMM_LenV3(pose[0].Columns[3].XYZ - clip.at(frame_count - 1, 0).Columns[3].XYZ) < 0.0001f);
+	assert(animation_clip_frame_at(animation, 100.0f) == (f32) (frame_count - 1));
+	assert(animation_clip_frame_at(animation, 0.5f) == 15.0f);
+
+	animation_clip_free(animation);
+}
+
+void test_matrix_clip_fallback()
+{
+	// Shear from a non-uniformly scaled parent keeps the matrices
+	const i32 frame_count = 4;
+	AnimationClip animation = {
+		.frame_rate = 24.0f,
+		.frame_count = frame_count,
+		.bone_count = 1,
+	};
+	animation.skin_matrices = (HMM_Mat4*) malloc(sizeof(HMM_Mat4) * frame_count);
+	for (i32 frame_idx = 0; frame_idx < frame_count; ++frame_idx)
+	{
+		HMM_Mat4 matrix = HMM_Translate(HMM_V3((f32) frame_idx, 0.0f, 0.0f));
+		matrix.Columns[1].X = 0.5f;
+		animation.skin_matrices[frame_idx] = matrix;
+	}
+	AnimationReductionScratch scratch;
+	assert(!animation_clip_compress(animation, scratch));
+	assert(!animation_clip_is_compressed(animation) && animation.skin_matrices);
+	assert(animation_clip_byte_count(animation) == sizeof(HMM_Mat4) * frame_count);
+
+	// Matrix clips blend neighbouring frames
+	HMM_Mat4 pose;
+	animation_clip_sample_pose(animation, 1.5f, &pose, 1);
+	assert(fabsf(pose.Columns[3].X - 1.5f) < 0.00001f && fabsf(pose.Columns[1].X - 0.5f) < 0.00001f);
+	animation_clip_sample_pose(animation, 2.0f, &pose, 1);
+	assert(pose.Columns[3].X == 2.0f);
+
+	animation_clip_free(animation);
+}
+
+void test_validation()
+{
+	Random random;
+	ClipFixture clip = make_rig_clip(random, 30, 3);
+	AnimationReductionScratch scratch;
+	CompressedAnimation compressed;
+	assert(animation_compress(clip.skin_matrices.data(), 30, 3, compressed, scratch));
+	assert(compressed_animation_is_valid(compressed));
+
+	AnimationTrack& track = compressed.tracks[2 * ANIMATION_CHANNEL_COUNT + (i32) EAnimationChannel::Rotation];
+	const AnimationTrack saved = track;
+	track.key_count = compressed.rotation_key_count + 1;
+	assert(!compressed_animation_is_valid(compressed));
+	track.first_key = 0xffffffffu;
+	track.key_count = 2;
+	assert(!compressed_animation_is_valid(compressed));
+	track = { .first_key = 0, .key_count = 0 };
+	assert(!compressed_animation_is_valid(compressed));
+	track = saved;
+
+	const u16 saved_frame = compressed.vector_key_frames[0];
+	compressed.vector_key_frames[0] = 30;
+	assert(!compressed_animation_is_valid(compressed));
+	compressed.vector_key_frames[0] = saved_frame;
+	assert(compressed_animation_is_valid(compressed));
+
+	compressed_animation_free(compressed);
+}
+
+// An Animation table carrying in_compressed the way the exporter writes it
+static const Animation* build_animation(flatbuffers::FlatBufferBuilder& in_builder, const ClipFixture& in_clip, const CompressedAnimation* in_compressed, bool in_with_matrices)
+{
+	std::vector<f32> matrices;
+	if (in_with_matrices)
+	{
+		matrices.resize(in_clip.skin_matrices.length() * 16);
+		memcpy(matrices.data(), in_clip.skin_matrices.data(), sizeof(f32) * matrices.size());
+	}
+
+	std::vector<u32> tracks;
+	std::vector<u16> vector_key_frames, rotation_key_frames, rotation_keys;
+	std::vector<f32> vector_keys;
+	if (in_compressed)
+	{
+		for (i32 track_idx = 0; track_idx < in_compressed->bone_count * ANIMATION_CHANNEL_COUNT; ++track_idx)
+		{
+			tracks.push_back(in_compressed->tracks[track_idx].first_key);
+			tracks.push_back(in_compressed->tracks[track_idx].key_count);
+		}
+		for (u32 key_idx = 0; key_idx < in_compressed->vector_key_count; ++key_idx)
+		{
+			vector_key_frames.push_back(in_compressed->vector_key_frames[key_idx]);
+			for (i32 axis_idx = 0; axis_idx < 3; ++axis_idx)
+			{
+				vector_keys.push_back(in_compressed->vector_keys[key_idx].Elements[axis_idx]);
+			}
+		}
+		for (u32 key_idx = 0; key_idx < in_compressed->rotation_key_count; ++key_idx)
+		{
+			rotation_key_frames.push_back(in_compressed->rotation_key_frames[key_idx]);
+			for (i32 component_idx = 0; component_idx < 3; ++component_idx)
+			{
+				rotation_keys.push_back(in_compressed->rotation_keys[key_idx].components[component_idx]);
+			}
+		}
+	}
+
+	in_builder.Finish(CreateAnimationDirect(
+		in_builder, "clip", 30.0f, (f32) in_clip.frame_count / 30.0f, in_clip.frame_count, in_clip.bone_count,
+		in_with_matrices ? &matrices : nullptr,
+		in_compressed ? &tracks : nullptr,
+		in_compressed ? &vector_key_frames : nullptr,
+		in_compressed ? &vector_keys : nullptr,
+		in_compressed ? &rotation_key_frames : nullptr,
+		in_compressed ? &rotation_keys : nullptr));
+	return flatbuffers::GetRoot<Animation>(in_builder.GetBufferPointer());
+}
+
+void test_live_link_decode()
+{
+	Random random;
+	ClipFixture clip = make_rig_clip(random, 60, 8);
+	AnimationReductionScratch scratch;
+	CompressedAnimation compressed;
+	assert(animation_compress(clip.skin_matrices.data(), clip.frame_count, clip.bone_count, compressed, scratch));
+
+	// Compact encoding arrives as is
+	{
+		flatbuffers::FlatBufferBuilder builder;
+		const Animation* animation = build_animation(builder, clip, &compressed, false);
+		AnimationClip decoded = {};
+		LiveLinkAnimationDecodeResult result;
+		live_link_decode_animation(animation, decoded, scratch, result);
+		assert(result.arrived_compact && result.compressed);
+		assert(result.matrix_count == 60 * 8 && result.stored_bytes == compressed_animation_byte_count(compressed));
+		assert(decoded.compressed.rotation_key_count == compressed.rotation_key_count);
+		for (i32 bone_idx = 0; bone_idx < clip.bone_count; ++bone_idx)
+		{
+			const HMM_Mat4 expected = animation_sample_bone(compressed, bone_idx, 17.5f);
+			const HMM_Mat4 actual = animation_sample_bone(decoded.compressed, bone_idx, 17.5f);
+			assert(memcmp(&expected, &actual, sizeof(HMM_Mat4)) == 0);
+		}
+		animation_clip_free(decoded);
+	}
+
+	// Matrices are compressed at import
+	{
+		flatbuffers::FlatBufferBuilder builder;
+		const Animation* animation = build_animation(builder, clip, nullptr, true);
+		AnimationClip decoded = {};
+		LiveLinkAnimationDecodeResult result;
+		live_link_decode_animation(animation, decoded, scratch, result);
+		assert(!result.arrived_compact && result.compressed && animation_clip_is_compressed(decoded));
+		assert(result.stored_bytes < result.matrix_bytes);
+		animation_clip_free(decoded);
+	}
+
+	// A malformed compact encoding falls back to the matrices
+	{
+		compressed.tracks[1].key_count = 1000;
+		flatbuffers::FlatBufferBuilder builder;
+		const Animation* animation = build_animation(builder, clip, &compressed, true);
+		AnimationClip decoded = {};
+		LiveLinkAnimationDecodeResult result;
+		live_link_decode_animation(animation, decoded, scratch, result);
+		assert(!result.arrived_compact && result.compressed);
+		HMM_Mat4 pose;
+		animation_clip_sample_pose(decoded, 5.0f, &pose, 1);
+		assert(worst_relative_error(clip.at(5, 0), pose, 1.0f) <= 1.0f);
+		animation_clip_free(decoded);
+	}
+
+	compressed_animation_free(compressed);
+}
+
+static f64 milliseconds_since(std::chrono::steady_clock::time_point in_start)
+{
+	return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - in_start).count();
+}
+
+void benchmark_clip_memory_and_sampling()
+{
+	Random random;
+	const i32 frame_count = 600;
+	const i32 bone_count = 64;
+	ClipFixture clip = make_rig_clip(random, frame_count, bone_count);
+
+	AnimationClip matrix_clip = {
+		.frame_rate = 30.0f,
+		.frame_count = frame_count,
+		.bone_count = bone_count,
+		.skin_matrices = clip.skin_matrices.data(),
+	};
+
+	AnimationReductionScratch scratch;
+	AnimationClip compact_clip = matrix_clip;
+	auto start = std::chrono::steady_clock::now();
+	assert(animation_compress(clip.skin_matrices.data(), frame_count, bone_count, compact_clip.compressed, scratch));
+	const f64 compress_ms = milliseconds_since(start);
+	compact_clip.skin_matrices = nullptr;
+
+	const i32 sample_count = 4000;
+	HMM_Mat4 pose[64];
+	f32 checksum = 0.0f;
+	start = std::chrono::steady_clock::now();
+	for (i32 sample_idx = 0; sample_idx < sample_count; ++sample_idx)
+	{
+		animation_clip_sample_pose(matrix_clip, (f32) (sample_idx % (frame_count * 4)) * 0.25f, pose, bone_count);
+		for (i32 bone_idx = 0; bone_idx < bone_count; ++bone_idx)
+		{
+			checksum += pose[bone_idx].Columns[3].X;
+		}
+	}
+	const f64 matrix_us = milliseconds_since(start) * 1000.0 / sample_count;
+	start = std::chrono::steady_clock::now();
+	for (i32 sample_idx = 0; sample_idx < sample_count; ++sample_idx)
+	{
+		animation_clip_sample_pose(compact_clip, (f32) (sample_idx % (frame_count * 4)) * 0.25f, pose, bone_count);
+		for (i32 bone_idx = 0; bone_idx < bone_count; ++bone_idx)
+		{
+			checksum -= pose[bone_idx].Columns[3].X;
+		}
+	}
+	const f64 compact_us = milliseconds_since(start) * 1000.0 / sample_count;
+
+	const u64 matrix_bytes = animation_clip_byte_count(matrix_clip);
+	const u64 compact_bytes = animation_clip_byte_count(compact_clip);
+	printf("clip %i bones x %i frames: matrices %llu bytes, compact %llu bytes (%.1fx smaller, %u vector + %u rotation keys), compress %.1f ms\n",
+		bone_count, frame_count, (unsigned long long) matrix_bytes, (unsigned long long) compact_bytes,
+		(f64) matrix_bytes / (f64) compact_bytes, compact_clip.compressed.vector_key_count, compact_clip.compressed.rotation_key_count, compress_ms);
+	printf("sample pose (fractional frames): matrices %.2f us, compact %.2f us (checksum %.3f)\n", matrix_us, compact_us, checksum);
+
+	compressed_animation_free(compact_clip.compressed);
+}
+
+int main()
+{
+	test_packed_quaternion();
+	test_decompose();
+	test_rig_reconstruction_error();
+	test_track_reduction_and_fractional_sampling();
+	test_matrix_clip_fallback();
+	test_validation();
+	test_live_link_decode();
+	benchmark_clip_memory_and_sampling();
+	printf("animation compression tests passed\n");
+	return 0;
+}
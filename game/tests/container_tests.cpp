@@ -1,5 +1,6 @@
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdint>
 #include <memory>
@@ -7,6 +8,7 @@
 
 #include "core/dynamic_array.h"
 #include "network/channel.h"
+#include "network/spsc_queue.h"
 
 struct TrackedValue
 {
@@ -162,6 +164,189 @@ void test_channel_concurrency()
 	assert(!channel.receive());
 }
 
+void test_spsc_fifo_wraparound_and_bounds()
+{
+	SpscQueue<std::unique_ptr<i32>> queue(5);
+	assert(queue.capacity() == 8);
+	assert(!queue.try_pop());
+
+	// Many laps around the ring, with the fill level varying each lap
+	i32 next_push = 0;
+	i32 next_pop = 0;
+	for (i32 lap = 0; lap < 50; ++lap)
+	{
+		const i32 push_count = 1 + lap % 8;
+		for (i32 index = 0; index < push_count; ++index)
+		{
+			assert(queue.try_push(std::make_unique<i32>(next_push++)));
+		}
+		assert(queue.size_approx() == (size_t) push_count);
+		for (i32 index = 0; index < push_count; ++index)
+		{
+			auto received = queue.try_pop();
+			assert(received && **received == next_pop++);
+		}
+	}
+
+	// A full ring refuses without consuming the value
+	for (i32 index = 0; index < 8; ++index)
+	{
+		assert(queue.try_push(std::make_unique<i32>(index)));
+	}
+	auto rejected = std::make_unique<i32>(99);
+	assert(!queue.try_push(std::move(rejected)));
+	assert(rejected && *rejected == 99);
+	std::atomic<bool> keep_waiting = false;
+	assert(!queue.push(std::move(rejected), keep_waiting));	// gives up at once
+	assert(rejected && *rejected == 99);
+	assert(queue.total_producer_wait_ns() > 0 || queue.size_approx() == 8);
+
+	// Blocking pop returns nullopt once told to stop
+	while (queue.try_pop()) {}
+	assert(!queue.pop(keep_waiting));
+}
+
+void test_spsc_moves_and_destroys_once()
+{
+	TrackedValue::live_count = 0;
+	TrackedValue::copy_count = 0;
+	{
+		SpscQueue<TrackedValue> queue(4);
+		for (i32 index = 0; index < 3; ++index)
+		{
+			assert(queue.try_push(TrackedValue(index)));
+		}
+		auto received = queue.try_pop();
+		assert(received && received->value == 0);
+		// Two values are still queued when the queue is destroyed
+	}
+	assert(TrackedValue::live_count == 0);
+	assert(TrackedValue::copy_count == 0);
+}
+
+// Payload shaped like a SceneUpdate: a heap buffer that must move, not copy
+struct QueuePayload
+{
+	u64 sequence = 0;
+	DynamicArray<u64> words;
+};
+
+QueuePayload make_queue_payload(u64 in_sequence, u32 in_word_count)
+{
+	QueuePayload payload;
+	payload.sequence = in_sequence;
+	payload.words.resize(in_word_count, in_sequence);
+	return payload;
+}
+
+void check_queue_payload(const QueuePayload& in_payload, u64 in_expected_sequence)
+{
+	assert(in_payload.sequence == in_expected_sequence);
+	assert(in_payload.words.empty() || in_payload.words.last() == in_expected_sequence);
+}
+
+void test_spsc_concurrency_stress()
+{
+	// A tiny ring forces both sides through their full and empty paths constantly
+	SpscQueue<QueuePayload> queue(4);
+	std::atomic<bool> running = true;
+	const u64 item_count = 200000;
+	std::thread producer([&]() {
+		for (u64 sequence = 0; sequence < item_count; ++sequence)
+		{
+			assert(queue.push(make_queue_payload(sequence, (u32) (sequence % 5)), running));
+		}
+	});
+
+	for (u64 expected = 0; expected < item_count; ++expected)
+	{
+		// Alternate the blocking and the polling API
+		std::optional<QueuePayload> received;
+		if (expected % 2 == 0)
+		{
+			received = queue.pop(running);
+		}
+		else
+		{
+			while (!(received = queue.try_pop()))
+			{
+				std::this_thread::yield();
+			}
+		}
+		assert(received);
+		check_queue_payload(*received, expected);
+	}
+	producer.join();
+	assert(!queue.try_pop());
+	assert(queue.size_approx() == 0);
+
+	// A producer blocked on a full ring is released by shutdown
+	SpscQueue<QueuePayload> full_queue(2);
+	assert(full_queue.try_push(make_queue_payload(0, 1)));
+	assert(full_queue.try_push(make_queue_payload(1, 1)));
+	std::atomic<bool> blocked_running = true;
+	std::atomic<bool> blocked_result = true;
+	std::thread blocked_producer([&]() {
+		blocked_result = full_queue.push(make_queue_payload(2, 1), blocked_running);
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	blocked_running = false;
+	blocked_producer.join();
+	assert(!blocked_result);
+	assert(full_queue.total_producer_wait_ns() >= 10 * 1000 * 1000);
+}
+
+// Producer/consumer throughput of the ring against the mutex Channel it
+// replaced, for small and SceneUpdate-sized payloads. Printed, not asserted:
+// timings on shared CI machines are too noisy to gate on.
+template <typename SendFunction, typename ReceiveFunction>
+f64 measure_queue_ns_per_item(u64 in_item_count, u32 in_word_count, SendFunction in_send, ReceiveFunction in_receive)
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::thread producer([&]() {
+		for (u64 sequence = 0; sequence < in_item_count; ++sequence)
+		{
+			in_send(make_queue_payload(sequence, in_word_count));
+		}
+	});
+	for (u64 expected = 0; expected < in_item_count;)
+	{
+		if (std::optional<QueuePayload> received = in_receive())
+		{
+			check_queue_payload(*received, expected);
+			++expected;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+	const f64 elapsed_ns = (f64) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	return elapsed_ns / (f64) in_item_count;
+}
+
+void benchmark_spsc_against_channel()
+{
+	const u64 item_count = 200000;
+	for (u32 word_count : { 0u, 64u })
+	{
+		Channel<QueuePayload> channel;
+		const f64 channel_ns = measure_queue_ns_per_item(item_count, word_count,
+			[&](QueuePayload&& in_payload) { channel.send(std::move(in_payload)); },
+			[&]() { return channel.receive(); });
+
+		SpscQueue<QueuePayload> queue(SPSC_QUEUE_DEFAULT_CAPACITY);
+		std::atomic<bool> running = true;
+		const f64 spsc_ns = measure_queue_ns_per_item(item_count, word_count,
+			[&](QueuePayload&& in_payload) { queue.push(std::move(in_payload), running); },
+			[&]() { return queue.pop(running); });
+
+		printf("queue throughput, %llu items of %u words: Channel %.1f ns/item, SpscQueue %.1f ns/item\n",
+			(unsigned long long) item_count, word_count, channel_ns, spsc_ns);
+	}
+}
+
 int main()
 {
 	test_trivial_storage();
@@ -169,5 +354,9 @@ int main()
 	test_aligned_storage();
 	test_channel_fifo_and_reuse();
 	test_channel_concurrency();
+	test_spsc_fifo_wraparound_and_bounds();
+	test_spsc_moves_and_destroys_once();
+	test_spsc_concurrency_stress();
+	benchmark_spsc_against_channel();
 	return 0;
 }
@@ -0,0 +1,71 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "core/content_hash.h"
+
+void test_reference_vectors()
+{
+	// Published XXH64 outputs (seed 0)
+	assert(content_hash_64("", 0) == 0xEF46DB3751D8E999ull);
+	assert(content_hash_64("a", 1) == 0xD24EC4F1A98C6E5Bull);
+	assert(content_hash_64("abc", 3) == 0x44BC2CF5AD770999ull);
+	const char* long_input = "Nobody inspects the spammish repetition";
+	assert(content_hash_64(long_input, strlen(long_input)) == 0xFBCEA83C8A378BF1ull);
+}
+
+void test_every_tail_length_is_sensitive()
+{
+	// Exercise the 32-byte stripes plus every 8/4/1-byte tail combination
+	std::vector<u8> bytes(200);
+	for (size_t index = 0; index < bytes.size(); ++index)
+	{
+		bytes[index] = (u8) (index * 131 + 7);
+	}
+	for (size_t length = 1; length <= bytes.size(); ++length)
+	{
+		const u64 hash = content_hash_64(bytes.data(), length);
+		assert(hash != content_hash_64(bytes.data(), length - 1));
+		bytes[length - 1] ^= 0x01;
+		assert(hash != content_hash_64(bytes.data(), length));
+		bytes[length - 1] ^= 0x01;
+		assert(hash == content_hash_64(bytes.data(), length));
+	}
+}
+
+void test_alignment_independent()
+{
+	std::vector<u8> source(4096 + 16);
+	for (size_t index = 0; index < source.size(); ++index)
+	{
+		source[index] = (u8) (index ^ (index >> 3));
+	}
+	const u64 expected = content_hash_64(source.data(), 4096);
+	for (size_t offset = 1; offset < 16; ++offset)
+	{
+		std::vector<u8> shifted(source.size() + offset);
+		memcpy(shifted.data() + offset, source.data(), 4096);
+		assert(content_hash_64(shifted.data() + offset, 4096) == expected);
+	}
+}
+
+void test_seed_chains_streams()
+{
+	const u32 indices[] = { 0, 1, 2, 2, 1, 3 };
+	const f32 positions[] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	const u64 chained = content_hash_64(indices, sizeof(indices), content_hash_64(positions, sizeof(positions)));
+	assert(chained == content_hash_64(indices, sizeof(indices), content_hash_64(positions, sizeof(positions))));
+	assert(chained != content_hash_64(positions, sizeof(positions), content_hash_64(indices, sizeof(indices))));
+	assert(content_hash_64(indices, sizeof(indices), 1) != content_hash_64(indices, sizeof(indices), 2));
+}
+
+int main()
+{
+	test_reference_vectors();
+	test_every_tail_length_is_sensitive();
+	test_alignment_independent();
+	test_seed_chains_streams();
+	printf("content hash tests passed\n");
+	return 0;
+}
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+
+#include "render/cull_engine.h"
+#include "test_random.h"
+
+// Stand-in for the render-object store's cull columns and queues
+struct SlotColumns
+{
+	CullBounds bounds;
+	DynamicArray<u8> flags;
+	DynamicArray<i32> changed;
+	DynamicArray<i32> released;
+
+	void write(i32 in_slot, const BoundingBox& in_box, bool in_always_visible)
+	{
+		while ((i32) cull_bounds_length(bounds) <= in_slot)
+		{
+			cull_bounds_add(bounds, {});
+			flags.add(0);
+		}
+		cull_bounds_set(bounds, in_slot, in_box);
+		flags[in_slot] = CULL_SLOT_LIVE | (in_always_visible ? CULL_SLOT_ALWAYS_VISIBLE : 0);
+		changed.add(in_slot);
+	}
+
+	void release(i32 in_slot)
+	{
+		flags[in_slot] = 0;
+		released.add(in_slot);
+	}
+
+	void sync(CullEngine& in_engine)
+	{
+		cull_engine_sync(in_engine, bounds, flags, released, changed);
+		changed.clear();
+		released.clear();
+	}
+};
+
+static BoundingBox random_box(Random& in_random, f32 in_extent)
+{
+	const HMM_Vec3 center = HMM_V3(in_random.range(-in_extent, in_extent), in_random.range(-20.0f, 20.0f), in_random.range(-in_extent, in_extent));
+	const HMM_Vec3 half = HMM_V3(in_random.range(0.1f, 4.0f), in_random.range(0.1f, 4.0f), in_random.range(0.1f, 4.0f));
+	return { .min = center - half, .max = center + half };
+}
+
+static HMM_Mat4 random_view_proj(Random& in_random, f32 in_extent)
+{
+	const HMM_Vec3 eye = HMM_V3(in_random.range(-in_extent, in_extent), in_random.range(1.0f, 40.0f), in_random.range(-in_extent, in_extent));
+	const HMM_Vec3 target = HMM_V3(in_random.range(-in_extent, in_extent), 0.0f, in_random.range(-in_extent, in_extent));
+	const HMM_Mat4 view = HMM_LookAt_RH(eye, target, HMM_V3(0.0f, 1.0f, 0.0f));
+	if (in_random.chance(30))
+	{
+		// Shadow-cascade style orthographic box
+		const f32 half_size = in_random.range(10.0f, in_extent);
+		return HMM_Orthographic_RH_ZO(-half_size, half_size, -half_size, half_size, in_extent * 4.0f, 0.1f) * view;
+	}
+	return HMM_Perspective_RH_ZO(in_random.range(30.0f, 100.0f) * HMM_DegToRad, in_random.range(0.5f, 2.5f), 0.1f, in_random.range(50.0f, in_extent * 4.0f)) * view;
+}
+
+static void reference_cull(const CullView& in_view, const SlotColumns& in_slots, DynamicArray<i32>& out_slots, i32& out_influence_count)
+{
+	for (i32 slot = 0; slot < (i32) in_slots.flags.length(); ++slot)
+	{
+		const u8 flags = in_slots.flags[slot];
+		if (!(flags & CULL_SLOT_LIVE))
+		{
+			continue;
+		}
+		const ECullBoxResult result = (flags & CULL_SLOT_ALWAYS_VISIBLE)
+			? ECullBoxResult::Visible
+			: cull_box_reference(in_view, cull_bounds_get(in_slots.bounds, slot));
+		out_influence_count += result == ECullBoxResult::InfluenceCulled;
+		if (result == ECullBoxResult::Visible)
+		{
+			out_slots.add(slot);
+		}
+	}
+}
+
+// A box whose verdict flips when it shrinks or grows by a hair sits on a
+// plane or the sphere; a rounding difference there is not a bug
+static bool is_borderline(const CullView& in_view, const BoundingBox& in_box)
+{
+	const HMM_Vec3 epsilon = HMM_V3(1e-3f, 1e-3f, 1e-3f);
+	const BoundingBox shrunk = { .min = in_box.min + epsilon, .max = in_box.max - epsilon };
+	const BoundingBox grown = { .min = in_box.min - epsilon, .max = in_box.max + epsilon };
+	return (cull_box_reference(in_view, shrunk) == ECullBoxResult::Visible)
+		!= (cull_box_reference(in_view, grown) == ECullBoxResult::Visible);
+}
+
+// Compares the engine against the reference for one view. Returns the
+// number of borderline disagreements; any other disagreement fails.
+static i32 check_view(CullEngine& in_engine, const SlotColumns& in_slots, const CullView& in_view)
+{
+	DynamicArray<i32> expected;
+	i32 expected_influence_count = 0;
+	reference_cull(in_view, in_slots, expected, expected_influence_count);
+
+	DynamicArray<i32> actual;
+	CullEngineCounts counts;
+	cull_engine_cull(in_engine, in_view, actual, counts);
+	std::sort(actual.begin(), actual.end());
+	for (size_t slot_idx = 1; slot_idx < actual.length(); ++slot_idx)
+	{
+		assert(actual[slot_idx - 1] != actual[slot_idx]);	// no slot twice
+	}
+
+	i32 borderline_count = 0;
+	size_t expected_idx = 0;
+	size_t actual_idx = 0;
+	while (expected_idx < expected.length() || actual_idx < actual.length())
+	{
+		const i32 expected_slot = expected_idx < expected.length() ? expected[expected_idx] : INT32_MAX;
+		const i32 actual_slot = actual_idx < actual.length() ? actual[actual_idx] : INT32_MAX;
+		if (expected_slot == actual_slot)
+		{
+			++expected_idx;
+			++actual_idx;
+			continue;
+		}
+		const i32 slot = MIN(expected_slot, actual_slot);
+		expected_idx += expected_slot == slot;
+		actual_idx += actual_slot == slot;
+		BoundingBox box = cull_bounds_get(in_slots.bounds, slot);
+		const f32 padding = MAX(in_view.bounds_padding, 0.0f);
+		box.min -= HMM_V3(padding, padding, padding);
+		box.max += HMM_V3(padding, padding, padding);
+		if (!is_borderline(in_view, box))
+		{
+			printf("slot %i: reference %s, engine %s\n", slot,
+				expected_slot == slot ? "visible" : "culled", actual_slot == slot ? "visible" : "culled");
+			assert(false);
+		}
+		borderline_count += 1;
+	}
+	assert(counts.tested_count + counts.accepted_count <= (i32) in_slots.flags.length());
+	return borderline_count;
+}
+
+static CullView random_view(Random& in_random, f32 in_extent, BoundingSphere& out_sphere)
+{
+	CullView view = {
+		.frustum = frustum_create(random_view_proj(in_random, in_extent)),
+		.bounds_padding = in_random.chance(30) ? in_random.range(0.0f, 3.0f) : 0.0f,
+	};
+	if (in_random.chance(25))
+	{
+		out_sphere = {
+			.center = HMM_V3(in_random.range(-in_extent, in_extent), 0.0f, in_random.range(-in_extent, in_extent)),
+			.radius = in_random.range(5.0f, in_extent),
+		};
+		view.influence_sphere = &out_sphere;
+	}
+	return view;
+}
+
+void test_block_tests_match_reference()
+{
+	Random random;
+	SlotColumns slots;
+	CullEngine engine;
+	const f32 extent = 200.0f;
+	for (i32 slot = 0; slot < 3001; ++slot)	// not a whole lane block
+	{
+		slots.write(slot, random_box(random, extent), random.chance(3));
+	}
+	slots.sync(engine);
+	assert(engine.bvh_nodes.empty() && engine.dynamic_count > 2800);
+
+	i32 borderline_count = 0;
+	for (i32 view_idx = 0; view_idx < 200; ++view_idx)
+	{
+		BoundingSphere sphere;
+		borderline_count += check_view(engine, slots, random_view(random, extent, sphere));
+	}
+	assert(borderline_count < 10);
+}
+
+// Slots appear, move, settle into the BVH, start moving again, flip to
+// always-visible and disappear, checked against the reference every sync
+void test_churn_matches_reference()
+{
+	Random random;
+	SlotColumns slots;
+	CullEngine engine;
+	const f32 extent = 300.0f;
+	const i32 slot_capacity = 6000;
+	DynamicArray<bool> live;
+	live.resize(slot_capacity, false);
+	for (i32 slot = 0; slot < 4000; ++slot)
+	{
+		slots.write(slot, random_box(random, extent), false);
+		live[slot] = true;
+	}
+
+	i32 borderline_count = 0;
+	bool saw_bvh = false;
+	for (i32 sync_idx = 0; sync_idx < 400; ++sync_idx)
+	{
+		// Phase 2 moves everything in the first block, forcing demotions
+		const i32 mover_count = sync_idx >= 200 && sync_idx < 230 ? 1000 : 20;
+		for (i32 mover = 0; mover < mover_count; ++mover)
+		{
+			const i32 slot = mover * 3;
+			if (live[slot])
+			{
+				const BoundingBox box = cull_bounds_get(slots.bounds, slot);
+				const HMM_Vec3 step = HMM_V3(random.range(-2.0f, 2.0f), 0.0f, random.range(-2.0f, 2.0f));
+				slots.write(slot, { .min = box.min + step, .max = box.max + step }, (slots.flags[slot] & CULL_SLOT_ALWAYS_VISIBLE) != 0);
+			}
+		}
+		for (i32 edit = 0; edit < 8; ++edit)
+		{
+			const i32 slot = (i32) (random.next() % (u32) slot_capacity);
+			if (live[slot] && random.chance(50))
+			{
+				slots.release(slot);
+				live[slot] = false;
+				if (random.chance(30))
+				{
+					// Released and reused before the next sync
+					slots.write(slot, random_box(random, extent), false);
+					live[slot] = true;
+				}
+			}
+			else
+			{
+				slots.write(slot, random_box(random, extent), random.chance(10));
+				live[slot] = true;
+			}
+		}
+		slots.sync(engine);
+		saw_bvh = saw_bvh || engine.bvh_live_count > 0;
+
+		BoundingSphere sphere;
+		borderline_count += check_view(engine, slots, random_view(random, extent, sphere));
+	}
+	assert(saw_bvh && engine.bvh_live_count > 2000);
+	assert(engine.rebuild_count >= 2 && engine.refit_count > 0);
+	assert(borderline_count < 10);
+
+	cull_engine_clear(engine);
+	DynamicArray<i32> visible;
+	CullEngineCounts counts;
+	BoundingSphere sphere;
+	cull_engine_cull(engine, random_view(random, extent, sphere), visible, counts);
+	assert(visible.empty());
+}
+
+static void settle(CullEngine& in_engine, SlotColumns& in_slots)
+{
+	for (u64 sync_idx = 0; sync_idx <= CULL_STATIC_AFTER_SYNCS; ++sync_idx)
+	{
+		in_slots.sync(in_engine);
+	}
+}
+
+void test_parallel_matches_serial()
+{
+	Random random;
+	SlotColumns slots;
+	const f32 extent = 1000.0f;
+	for (i32 slot = 0; slot < 100000; ++slot)
+	{
+		slots.write(slot, random_box(random, extent), false);
+	}
+
+	CullEngine serial;
+	slots.sync(serial);
+	settle(serial, slots);
+
+	WorkerPool workers;
+	workers.start(3);
+	CullEngine parallel;
+	parallel.workers = &workers;
+	for (i32 slot = 0; slot < 100000; ++slot)
+	{
+		slots.changed.add(slot);
+	}
+	slots.sync(parallel);
+	settle(parallel, slots);
+	assert(parallel.bvh_task_roots.length() >= 8);
+
+	// Some slots move after the build: refit on both sides
+	for (i32 slot = 0; slot < 100000; slot += 997)
+	{
+		slots.write(slot, random_box(random, extent), false);
+	}
+	cull_engine_sync(serial, slots.bounds, slots.flags, slots.released, slots.changed);
+	slots.sync(parallel);
+
+	for (i32 view_idx = 0; view_idx < 20; ++view_idx)
+	{
+		BoundingSphere sphere;
+		const CullView view = random_view(random, extent, sphere);
+		DynamicArray<i32> serial_slots;
+		DynamicArray<i32> parallel_slots;
+		CullEngineCounts serial_counts;
+		CullEngineCounts parallel_counts;
+		cull_engine_cull(serial, view, serial_slots, serial_counts);
+		cull_engine_cull(parallel, view, parallel_slots, parallel_counts);
+		std::sort(serial_slots.begin(), serial_slots.end());
+		std::sort(parallel_slots.begin(), parallel_slots.end());
+		assert(serial_slots.length() == parallel_slots.length());
+		for (size_t slot_idx = 0; slot_idx < serial_slots.length(); ++slot_idx)
+		{
+			assert(serial_slots[slot_idx] == parallel_slots[slot_idx]);
+		}
+		assert(serial_counts.influence_cull_count == parallel_counts.influence_cull_count);
+	}
+}
+
+static f64 milliseconds_since(std::chrono::steady_clock::time_point in_start)
+{
+	return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - in_start).count();
+}
+
+// One camera view and four cascade views per frame, like the geometry and
+// shadow passes. Compares the per-object scalar loop (over AoS boxes, as
+// cull_objects used to read them) with the flat block list, the BVH, and
+// the BVH split across workers.
+void benchmark_cull_throughput()
+{
+	const i32 object_counts[] = { 10000, 100000, 1000000 };
+	WorkerPool workers;
+	workers.start(MAX(WorkerPool::default_worker_count(), 1));
+	for (i32 object_count : object_counts)
+	{
+		Random random;
+		const f32 extent = 20.0f * sqrtf((f32) object_count);
+		SlotColumns slots;
+		DynamicArray<BoundingBox> boxes;
+		for (i32 slot = 0; slot < object_count; ++slot)
+		{
+			boxes.add(random_box(random, extent));
+			slots.write(slot, boxes.last(), false);
+		}
+
+		const i32 frame_count = object_count >= 1000000 ? 2 : 10;
+		DynamicArray<CullView> views;
+		for (i32 view_idx = 0; view_idx < frame_count * 5; ++view_idx)
+		{
+			BoundingSphere unused_sphere;
+			CullView view = random_view(random, extent, unused_sphere);
+			view.influence_sphere = nullptr;
+			views.add(view);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		i64 reference_visible = 0;
+		for (const CullView& view : views)
+		{
+			for (const BoundingBox& box : boxes)
+			{
+				reference_visible += cull_box_reference(view, box) == ECullBoxResult::Visible;
+			}
+		}
+		const f64 reference_ms = milliseconds_since(start);
+
+		CullEngine flat;
+		slots.sync(flat);
+		DynamicArray<i32> visible;
+		start = std::chrono::steady_clock::now();
+		i64 flat_visible = 0;
+		for (const CullView& view : views)
+		{
+			visible.clear();
+			CullEngineCounts counts;
+			cull_engine_cull(flat, view, visible, counts);
+			flat_visible += (i64) visible.length();
+		}
+		const f64 flat_ms = milliseconds_since(start);
+
+		CullEngine bvh;
+		for (i32 slot = 0; slot < object_count; ++slot)
+		{
+			slots.changed.add(slot);
+		}
+		slots.sync(bvh);
+		settle(bvh, slots);
+		start = std::chrono::steady_clock::now();
+		i64 bvh_visible = 0;
+		for (const CullView& view : views)
+		{
+			visible.clear();
+			CullEngineCounts counts;
+			cull_engine_cull(bvh, view, visible, counts);
+			bvh_visible += (i64) visible.length();
+		}
+		const f64 bvh_ms = milliseconds_since(start);
+
+		bvh.workers = &workers;
+		start = std::chrono::steady_clock::now();
+		cull_engine_rebuild(bvh, slots.bounds);	// also re-splits the frontier for the pool
+		const f64 build_ms = milliseconds_since(start);
+		start = std::chrono::steady_clock::now();
+		for (const CullView& view : views)
+		{
+			visible.clear();
+			CullEngineCounts counts;
+			cull_engine_cull(bvh, view, visible, counts);
+		}
+		const f64 parallel_ms = milliseconds_since(start);
+
+		// Borderline boxes may differ by a handful
+		assert(llabs(flat_visible - reference_visible) <= 16 && llabs(bvh_visible - reference_visible) <= 16);
+		const f64 frames = (f64) frame_count;
+		printf("cull %7i objects, 5 views/frame (%.1f%% visible): reference %.3f ms/frame, blocks %.3f, bvh %.3f, bvh+%i workers %.3f (rebuild %.1f ms)\n",
+			object_count, 100.0 * (f64) reference_visible / ((f64) object_count * (f64) views.length()),
+			reference_ms / frames, flat_ms / frames, bvh_ms / frames, workers.worker_count(), parallel_ms / frames, build_ms);
+	}
+}
+
+int main()
+{
+	test_block_tests_match_reference();
+	test_churn_matches_reference();
+	test_parallel_matches_serial();
+	benchmark_cull_throughput();
+	printf("cull engine tests passed\n");
+	return 0;
+}
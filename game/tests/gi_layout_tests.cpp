@@ -0,0 +1,329 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+
+#include "core/types.h"
+#include "render/gi_layout.h"
+#include "render/gi_probe_scheduler.h"
+#include "test_random.h"
+
+// Two small boxes at opposite corners pin the scene cube, so edits between
+// them never change the lattice
+static constexpr f32 SCENE_HALF_EXTENT = 20.0f;
+static constexpr i32 ANCHOR_COUNT = 2;
+
+static BoundingBox make_box(HMM_Vec3 in_center, HMM_Vec3 in_half_size)
+{
+	return (BoundingBox) { .min = in_center - in_half_size, .max = in_center + in_half_size };
+}
+
+static BoundingBox random_box(Random& io_random)
+{
+	const HMM_Vec3 half_size = HMM_V3(
+		0.2f + io_random.unit() * 1.5f,
+		0.2f + io_random.unit() * 1.5f,
+		0.2f + io_random.unit() * 1.5f);
+	const f32 range = SCENE_HALF_EXTENT - 2.0f;
+	return make_box(
+		HMM_V3(io_random.signed_unit() * range, io_random.signed_unit() * range, io_random.signed_unit() * range),
+		half_size);
+}
+
+static void make_scene(Random& io_random, const i32 in_object_count, DynamicArray<BoundingBox>& out_boxes)
+{
+	out_boxes.reset();
+	out_boxes.add(make_box(HMM_V3(-SCENE_HALF_EXTENT, -SCENE_HALF_EXTENT, -SCENE_HALF_EXTENT), HMM_V3(0.5f, 0.5f, 0.5f)));
+	out_boxes.add(make_box(HMM_V3(SCENE_HALF_EXTENT, SCENE_HALF_EXTENT, SCENE_HALF_EXTENT), HMM_V3(0.5f, 0.5f, 0.5f)));
+	for (i32 object_idx = 0; object_idx < in_object_count; ++object_idx)
+	{
+		out_boxes.add(random_box(io_random));
+	}
+}
+
+static bool probes_match(const GI_Probe& in_a, const GI_Probe& in_b)
+{
+	return in_a.position.X == in_b.position.X && in_a.position.Y == in_b.position.Y && in_a.position.Z == in_b.position.Z
+		&& in_a.max_radial_depth == in_b.max_radial_depth
+		&& in_a.octree_level == in_b.octree_level;
+}
+
+// Walks both trees in parallel; slot order may differ, structure may not
+static void assert_nodes_match(const GI_Layout& in_patched, const i32 in_patched_node, const GI_Layout& in_built, const i32 in_built_node)
+{
+	const GI_OctreeNode& patched = in_patched.octree_nodes[in_patched_node];
+	const GI_OctreeNode& built = in_built.octree_nodes[in_built_node];
+	assert(gi_layout_bounds_equal(gi_layout_node_bounds(patched), gi_layout_node_bounds(built)));
+	assert(patched.is_leaf == built.is_leaf);
+	assert(patched.payload_index >= 0 && built.payload_index >= 0);
+
+	const GI_Cell& patched_cell = in_patched.cells[patched.payload_index];
+	const GI_Cell& built_cell = in_built.cells[built.payload_index];
+	for (i32 corner_index = 0; corner_index < 8; ++corner_index)
+	{
+		const GI_Probe& patched_probe = in_patched.probes[patched_cell.probe_indices[corner_index]];
+		assert(gi_layout_probe_is_used(patched_probe));
+		assert(probes_match(patched_probe, in_built.probes[built_cell.probe_indices[corner_index]]));
+	}
+
+	for (i32 child_slot = 0; child_slot < 8; ++child_slot)
+	{
+		assert((patched.child_indices[child_slot] >= 0) == (built.child_indices[child_slot] >= 0));
+		if (built.child_indices[child_slot] >= 0)
+		{
+			assert_nodes_match(in_patched, patched.child_indices[child_slot], in_built, built.child_indices[child_slot]);
+		}
+	}
+}
+
+static void assert_layouts_match(const GI_Layout& in_patched, const GI_Layout& in_built)
+{
+	assert_nodes_match(in_patched, 0, in_built, 0);
+	assert(in_patched.payload_count == in_built.payload_count);
+	assert(in_patched.non_fallback_probe_count == in_built.non_fallback_probe_count);
+	assert(in_patched.min_occupied_cell_extent == in_built.min_occupied_cell_extent);
+	assert(in_patched.max_occupied_cell_extent == in_built.max_occupied_cell_extent);
+	assert(in_patched.max_radial_depth == in_built.max_radial_depth);
+	assert(probes_match(in_patched.probes[in_patched.fallback_probe_index], in_built.probes[in_built.fallback_probe_index]));
+
+	// Live slots plus free slots account for every array entry
+	assert(in_patched.octree_nodes.length() - in_patched.free_node_indices.length() == in_built.octree_nodes.length());
+	assert(in_patched.cells.length() - in_patched.free_cell_indices.length() == in_built.cells.length());
+	assert(in_patched.probe_indices_by_corner.size() == (size_t) in_patched.non_fallback_probe_count);
+	for (const auto& [corner_key, probe_index] : in_patched.probe_indices_by_corner)
+	{
+		assert(gi_layout_probe_is_used(in_patched.probes[probe_index]));
+		assert(probe_index != in_patched.fallback_probe_index);
+	}
+	for (const i32 probe_index : in_patched.free_probe_indices)
+	{
+		assert(!gi_layout_probe_is_used(in_patched.probes[probe_index]));
+	}
+}
+
+// Random moves, additions and removals patched in place always give the same
+// tree as a rebuild, and surviving probes keep their slots
+void test_patch_matches_rebuild()
+{
+	Random random;
+	for (i32 octree_depth = GI_Layout::min_octree_depth; octree_depth <= GI_Layout::max_octree_depth; ++octree_depth)
+	{
+		DynamicArray<BoundingBox> boxes;
+		make_scene(random, 40, boxes);
+		const BoundingBox scene_bounds = gi_layout_scene_bounds(boxes);
+
+		GI_Layout patched;
+		gi_layout_build(patched, boxes, scene_bounds, octree_depth);
+
+		i64 patch_nodes_tested = 0;
+		i64 rebuild_nodes = 0;
+		i32 probes_added = 0;
+		i32 probes_removed = 0;
+		for (i32 edit_idx = 0; edit_idx < 300; ++edit_idx)
+		{
+			DynamicArray<BoundingBox> dirty_regions;
+			const i32 edit_count = 1 + (i32) (random.next() % 3);
+			for (i32 change_idx = 0; change_idx < edit_count; ++change_idx)
+			{
+				const u32 kind = random.next() % 3;
+				if (kind == 0 || boxes.length() <= ANCHOR_COUNT + 1)
+				{
+					boxes.add(random_box(random));
+					dirty_regions.add(boxes[boxes.length() - 1]);
+				}
+				else
+				{
+					const size_t object_idx = ANCHOR_COUNT + random.next() % (boxes.length() - ANCHOR_COUNT);
+					dirty_regions.add(boxes[object_idx]);
+					if (kind == 1)
+					{
+						boxes[object_idx] = random_box(random);
+						dirty_regions.add(boxes[object_idx]);
+					}
+					else
+					{
+						boxes[object_idx] = boxes[boxes.length() - 1];
+						boxes.resize(boxes.length() - 1);
+					}
+				}
+			}
+
+			ankerl::unordered_dense::map<u64, i32> previous_probes = patched.probe_indices_by_corner;
+			GI_LayoutPatchStats stats = {};
+			assert(gi_layout_patch(patched, boxes, gi_layout_scene_bounds(boxes), octree_depth, dirty_regions, &stats));
+
+			GI_Layout built;
+			gi_layout_build(built, boxes, scene_bounds, octree_depth);
+			assert_layouts_match(patched, built);
+
+			for (const auto& [corner_key, probe_index] : patched.probe_indices_by_corner)
+			{
+				auto previous = previous_probes.find(corner_key);
+				assert(previous == previous_probes.end() || previous->second == probe_index);
+			}
+			patch_nodes_tested += stats.nodes_tested;
+			rebuild_nodes += (i64) built.octree_nodes.length();
+			probes_added += stats.probes_added;
+			probes_removed += stats.probes_removed;
+		}
+		printf(
+			"depth %d: patch tested %.1f nodes per edit, rebuild creates %.1f nodes; probes +%d -%d over 300 edits\n",
+			octree_depth,
+			(f64) patch_nodes_tested / 300.0,
+			(f64) rebuild_nodes / 300.0,
+			probes_added,
+			probes_removed);
+	}
+}
+
+// Edits that move the scene cube, change the depth, or empty the scene need a
+// rebuild and leave the layout alone
+void test_patch_rejects_lattice_changes()
+{
+	Random random;
+	DynamicArray<BoundingBox> boxes;
+	make_scene(random, 10, boxes);
+	const BoundingBox scene_bounds = gi_layout_scene_bounds(boxes);
+	GI_Layout layout;
+	gi_layout_build(layout, boxes, scene_bounds, 3);
+	const size_t node_count = layout.octree_nodes.length();
+
+	DynamicArray<BoundingBox> dirty_regions;
+	const BoundingBox outside = make_box(HMM_V3(SCENE_HALF_EXTENT * 2.0f, 0.0f, 0.0f), HMM_V3(1.0f, 1.0f, 1.0f));
+	boxes.add(outside);
+	dirty_regions.add(outside);
+	assert(!gi_layout_patch(layout, boxes, gi_layout_scene_bounds(boxes), 3, dirty_regions, nullptr));
+	boxes.resize(boxes.length() - 1);
+	assert(!gi_layout_patch(layout, boxes, scene_bounds, 2, dirty_regions, nullptr));
+
+	DynamicArray<BoundingBox> no_boxes;
+	assert(!gi_layout_patch(layout, no_boxes, scene_bounds, 3, dirty_regions, nullptr));
+	assert(layout.octree_nodes.length() == node_count);
+	assert(layout.free_node_indices.length() == 0);
+}
+
+static DynamicArray<GI_Probe> make_probe_row(const i32 in_count)
+{
+	DynamicArray<GI_Probe> probes;
+	for (i32 probe_idx = 0; probe_idx < in_count; ++probe_idx)
+	{
+		probes.add(gi_layout_make_probe(HMM_V3(0.0f, 10.0f * (f32) probe_idx, 0.0f), 2.0f, 1));
+	}
+	return probes;
+}
+
+// Camera at the origin looking along in_forward
+static HMM_Mat4 make_view_projection(HMM_Vec3 in_forward)
+{
+	const HMM_Mat4 view = HMM_LookAt_RH(HMM_V3(0.0f, 0.0f, 0.0f), in_forward, HMM_V3(0.0f, 0.0f, 1.0f));
+	const HMM_Mat4 projection = HMM_Perspective_RH_ZO(HMM_PI32 / 3.0f, 16.0f / 9.0f, 0.1f, 1000.0f);
+	return HMM_MulM4(projection, view);
+}
+
+// Close and on-screen probes go first; a nearby edit outranks both
+void test_scheduler_priority()
+{
+	DynamicArray<GI_Probe> probes = make_probe_row(8);
+	GI_ProbeScheduler scheduler;
+	gi_probe_scheduler_reset(scheduler, (i32) probes.length());
+	gi_probe_scheduler_mark_all(scheduler, probes, 0);
+	assert(scheduler.stale_count == 8);
+
+	DynamicArray<i32> selected;
+	const HMM_Mat4 looking_forward = make_view_projection(HMM_V3(0.0f, 1.0f, 0.0f));
+	gi_probe_scheduler_select(scheduler, probes, HMM_V3(0.0f, 0.0f, 0.0f), looking_forward, 1, 3, selected);
+	assert(selected.length() == 3);
+	assert(selected[0] == 0 && selected[1] == 1 && selected[2] == 2);
+	assert(scheduler.stale_count == 5);
+
+	// An edit next to the farthest probe puts it ahead of the closest one
+	gi_probe_scheduler_mark_all(scheduler, probes, 2);
+	DynamicArray<BoundingBox> regions;
+	regions.add(make_box(probes[7].position.XYZ + HMM_V3(1.0f, 0.0f, 0.0f), HMM_V3(0.25f, 0.25f, 0.25f)));
+	gi_probe_scheduler_mark_regions(scheduler, probes, regions, 2);
+	assert(scheduler.near_edit[7] == 1);
+	assert(scheduler.near_edit[6] == 0);
+	gi_probe_scheduler_select(scheduler, probes, HMM_V3(0.0f, 0.0f, 0.0f), looking_forward, 3, 2, selected);
+	assert(selected[0] == 7 && selected[1] == 0);
+
+	// Off-screen probes lose to on-screen ones at the same distance
+	DynamicArray<GI_Probe> pair;
+	pair.add(gi_layout_make_probe(HMM_V3(0.0f, -20.0f, 0.0f), 2.0f, 1));
+	pair.add(gi_layout_make_probe(HMM_V3(0.0f, 20.0f, 0.0f), 2.0f, 1));
+	GI_ProbeScheduler pair_scheduler;
+	gi_probe_scheduler_reset(pair_scheduler, 2);
+	gi_probe_scheduler_mark_all(pair_scheduler, pair, 0);
+	gi_probe_scheduler_select(pair_scheduler, pair, HMM_V3(0.0f, 0.0f, 0.0f), looking_forward, 0, 1, selected);
+	assert(selected.length() == 1 && selected[0] == 1);
+
+	// A probe that waits long enough overtakes fresher, closer ones
+	const f32 fresh = gi_probe_priority(probes[0], HMM_V3(0.0f, 0.0f, 0.0f), frustum_create(looking_forward), false, 0);
+	const f32 waited = gi_probe_priority(probes[7], HMM_V3(0.0f, 0.0f, 0.0f), frustum_create(looking_forward), false, 100000);
+	assert(waited > fresh);
+}
+
+// The budget buys whole captures at the measured cost, at least one
+void test_scheduler_budget()
+{
+	GI_ProbeScheduler scheduler;
+	assert(gi_probe_scheduler_budget_count(scheduler, 2.0f, 8) == 4);
+	assert(gi_probe_scheduler_budget_count(scheduler, 0.1f, 8) == 1);
+	assert(gi_probe_scheduler_budget_count(scheduler, 100.0f, 8) == 8);
+
+	for (i32 frame = 0; frame < 64; ++frame)
+	{
+		gi_probe_scheduler_record_gpu_time(scheduler, 1.0, 4);
+	}
+	assert(std::fabs(scheduler.gpu_ms_per_probe - 0.25f) < 1e-3f);
+	assert(gi_probe_scheduler_budget_count(scheduler, 1.9f, 8) == 7);
+	gi_probe_scheduler_record_gpu_time(scheduler, 0.0, 4);
+	gi_probe_scheduler_record_gpu_time(scheduler, 1.0, 0);
+	assert(std::fabs(scheduler.gpu_ms_per_probe - 0.25f) < 1e-3f);
+}
+
+// Edits mark probes whose influence reaches them plus never-captured probes;
+// probes released while waiting drop out of the queue
+void test_scheduler_marks_and_releases()
+{
+	DynamicArray<GI_Probe> probes = make_probe_row(4);
+	for (GI_Probe& probe : probes)
+	{
+		probe.atlas_idx = 0;
+	}
+	probes[3].atlas_idx = -1;
+
+	GI_ProbeScheduler scheduler;
+	gi_probe_scheduler_reset(scheduler, (i32) probes.length());
+	DynamicArray<BoundingBox> regions;
+	regions.add(make_box(HMM_V3(0.0f, 11.0f, 0.0f), HMM_V3(0.5f, 0.5f, 0.5f)));
+	gi_probe_scheduler_mark_regions(scheduler, probes, regions, 5);
+	assert(scheduler.stale_count == 2);
+	assert(scheduler.stale_frames[1] == 5 && scheduler.stale_frames[3] == 5);
+	assert(scheduler.stale_frames[0] == GI_PROBE_CURRENT && scheduler.stale_frames[2] == GI_PROBE_CURRENT);
+
+	// Marking again keeps the original stale frame
+	gi_probe_scheduler_mark_regions(scheduler, probes, regions, 9);
+	assert(scheduler.stale_count == 2 && scheduler.stale_frames[1] == 5);
+
+	probes[1].octree_level = GI_PROBE_LEVEL_UNUSED;
+	DynamicArray<i32> selected;
+	gi_probe_scheduler_select(scheduler, probes, HMM_V3(0.0f, 0.0f, 0.0f), make_view_projection(HMM_V3(0.0f, 1.0f, 0.0f)), 10, 4, selected);
+	assert(selected.length() == 1 && selected[0] == 3);
+	assert(scheduler.stale_count == 0);
+
+	// Shrinking drops stale entries past the end
+	gi_probe_scheduler_mark_all(scheduler, probes, 11);
+	assert(scheduler.stale_count == 3);
+	gi_probe_scheduler_resize(scheduler, 2);
+	assert(scheduler.stale_count == 1);
+}
+
+int main()
+{
+	test_patch_matches_rebuild();
+	test_patch_rejects_lattice_changes();
+	test_scheduler_priority();
+	test_scheduler_budget();
+	test_scheduler_marks_and_releases();
+	printf("gi_layout_tests passed\n");
+	return 0;
+}
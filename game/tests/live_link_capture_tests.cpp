@@ -0,0 +1,272 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "live_link/live_link_capture.h"
+#include "live_link/live_link_server.h"
+
+using namespace Blender::LiveLink;
+
+static const char* CAPTURE_PATH = "/tmp/live_link_capture_tests.bllc";
+
+DynamicArray<u8> build_transform_update(i32 in_unique_id, i32 in_transform_count)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	std::vector<ObjectTransform> transforms;
+	for (i32 transform_idx = 0; transform_idx < in_transform_count; ++transform_idx)
+	{
+		transforms.emplace_back(in_unique_id + transform_idx, Vec3(1.0f, 2.0f, 3.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), Vec3(1.0f, 1.0f, 1.0f));
+	}
+	auto transform_vector = builder.CreateVectorOfStructs(transforms);
+	UpdateBuilder update(builder);
+	update.add_transforms(transform_vector);
+	builder.FinishSizePrefixed(update.Finish());
+	DynamicArray<u8> bytes;
+	bytes.add_uninitialized(builder.GetSize());
+	memcpy(bytes.data(), builder.GetBufferPointer(), builder.GetSize());
+	return bytes;
+}
+
+// Raw bytes with a consistent size prefix; the capture never looks inside
+DynamicArray<u8> build_raw_frame(u32 in_payload_size, u8 in_fill)
+{
+	DynamicArray<u8> frame;
+	frame.resize(LIVE_LINK_FRAME_PREFIX_BYTES + in_payload_size, in_fill);
+	memcpy(frame.data(), &in_payload_size, sizeof(in_payload_size));
+	return frame;
+}
+
+u64 file_size(const char* in_path)
+{
+	FILE* file = fopen(in_path, "rb");
+	assert(file);
+	fseek(file, 0, SEEK_END);
+	const u64 size = (u64) ftell(file);
+	fclose(file);
+	return size;
+}
+
+void truncate_file(const char* in_path, u64 in_size)
+{
+	assert(truncate(in_path, (off_t) in_size) == 0);
+}
+
+void test_round_trip()
+{
+	std::vector<DynamicArray<u8>> frames;
+	for (u32 frame_idx = 0; frame_idx < 9; ++frame_idx)
+	{
+		frames.push_back(build_raw_frame(1 + frame_idx * 37, (u8) frame_idx));	// odd sizes exercise padding
+	}
+
+	LiveLinkCaptureWriter writer;
+	assert(live_link_capture_writer_open(writer, CAPTURE_PATH));
+	for (u32 frame_idx = 0; frame_idx < frames.size(); ++frame_idx)
+	{
+		assert(live_link_capture_writer_append(writer, 1 + frame_idx % 3, frames[frame_idx].data(), frames[frame_idx].length()));
+	}
+	assert(!live_link_capture_writer_append(writer, 1, frames[0].data(), 2));	// shorter than a prefix
+	live_link_capture_writer_close(writer);
+
+	LiveLinkCapture capture;
+	assert(live_link_capture_map(capture, CAPTURE_PATH));
+	assert(!capture.recovered);
+	assert(capture.frames.length() == frames.size());
+	u64 last_timestamp = 0;
+	for (u32 frame_idx = 0; frame_idx < frames.size(); ++frame_idx)
+	{
+		const LiveLinkCaptureIndexEntry& entry = capture.frames[frame_idx];
+		assert(entry.frame_size == frames[frame_idx].length());
+		assert(entry.connection_id == 1 + frame_idx % 3);
+		assert(entry.frame_offset % 8 == 0);
+		assert(entry.timestamp_ns >= last_timestamp);
+		last_timestamp = entry.timestamp_ns;
+		assert(memcmp(live_link_capture_frame_data(capture, entry), frames[frame_idx].data(), entry.frame_size) == 0);
+	}
+	live_link_capture_unmap(capture);
+	assert(capture.data == nullptr && capture.frames.empty());
+}
+
+// A recorder killed before close leaves no index; every complete record
+// must still replay and a torn last record must be ignored
+void test_interrupted_recording_is_recovered()
+{
+	LiveLinkCaptureWriter writer;
+	assert(live_link_capture_writer_open(writer, CAPTURE_PATH));
+	for (u32 frame_idx = 0; frame_idx < 4; ++frame_idx)
+	{
+		const DynamicArray<u8> frame = build_raw_frame(100 + frame_idx, (u8) frame_idx);
+		assert(live_link_capture_writer_append(writer, 7, frame.data(), frame.length()));
+	}
+	fclose(writer.file);	// crash: no index, header never finalized
+	writer.file = nullptr;
+	truncate_file(CAPTURE_PATH, file_size(CAPTURE_PATH) - 10);
+
+	LiveLinkCapture capture;
+	assert(live_link_capture_map(capture, CAPTURE_PATH));
+	assert(capture.recovered);
+	assert(capture.frames.length() == 3);
+	for (u32 frame_idx = 0; frame_idx < 3; ++frame_idx)
+	{
+		const LiveLinkCaptureIndexEntry& entry = capture.frames[frame_idx];
+		assert(entry.frame_size == LIVE_LINK_FRAME_PREFIX_BYTES + 100 + frame_idx);
+		assert(live_link_capture_frame_data(capture, entry)[LIVE_LINK_FRAME_PREFIX_BYTES] == (u8) frame_idx);
+	}
+	live_link_capture_unmap(capture);
+}
+
+void test_damaged_index_and_foreign_files()
+{
+	LiveLinkCaptureWriter writer;
+	assert(live_link_capture_writer_open(writer, CAPTURE_PATH));
+	const DynamicArray<u8> frame = build_raw_frame(64, 0xAB);
+	assert(live_link_capture_writer_append(writer, 1, frame.data(), frame.length()));
+	assert(live_link_capture_writer_append(writer, 1, frame.data(), frame.length()));
+	live_link_capture_writer_close(writer);
+
+	// Cutting into the index falls back to scanning the records
+	truncate_file(CAPTURE_PATH, file_size(CAPTURE_PATH) - 4);
+	LiveLinkCapture capture;
+	assert(live_link_capture_map(capture, CAPTURE_PATH));
+	assert(capture.recovered);
+	assert(capture.frames.length() == 2);
+	live_link_capture_unmap(capture);
+
+	FILE* foreign = fopen(CAPTURE_PATH, "wb");
+	const char text[] = "not a capture, just some bytes that are long enough";
+	fwrite(text, 1, sizeof(text), foreign);
+	fclose(foreign);
+	assert(!live_link_capture_map(capture, CAPTURE_PATH));
+	assert(!live_link_capture_map(capture, "/tmp/live_link_capture_tests_missing.bllc"));
+	assert(capture.data == nullptr);
+}
+
+void test_replay_pacing()
+{
+	LiveLinkReplay replay;
+	const u64 timestamps[] = { 5000, 5000, 6000, 9000 };
+	for (u64 timestamp : timestamps)
+	{
+		replay.capture.frames.add({ .timestamp_ns = timestamp });
+	}
+
+	// Recorded speed: relative to the first frame, ties released together
+	assert(live_link_replay_next_due(replay, 0) == &replay.capture.frames[0]);
+	assert(live_link_replay_next_due(replay, 0) == &replay.capture.frames[1]);
+	assert(live_link_replay_next_due(replay, 999) == nullptr);
+	assert(live_link_replay_next_due(replay, 1000) == &replay.capture.frames[2]);
+	assert(live_link_replay_next_due(replay, 3999) == nullptr);
+	assert(live_link_replay_next_due(replay, 4000) == &replay.capture.frames[3]);
+	assert(live_link_replay_next_due(replay, ~0ull) == nullptr);
+
+	// Maximum speed: everything is due at once
+	replay.next_frame_index = 0;
+	replay.max_speed = true;
+	for (u32 frame_idx = 0; frame_idx < 4; ++frame_idx)
+	{
+		assert(live_link_replay_next_due(replay, 0) == &replay.capture.frames[frame_idx]);
+	}
+	assert(live_link_replay_next_due(replay, 0) == nullptr);
+}
+
+// Records through the live-link server callback exactly as the live-link
+// thread does: plain frames byte for byte, chunked transfers once, assembled
+void test_recording_from_server()
+{
+	LiveLinkServer server;
+	server.config.poll_timeout_ms = 10;
+	assert(live_link_server_open(server, "127.0.0.1", "0"));
+	const i32 port = live_link_server_port(server);
+
+	const DynamicArray<u8> small_update = build_transform_update(1, 1);
+	const DynamicArray<u8> large_update = build_transform_update(100, 4000);
+	std::vector<DynamicArray<u8>> chunk_frames;
+	{
+		const size_t chunk_bytes = 16 * 1024;
+		const u32 chunk_count = (u32) ((large_update.length() + chunk_bytes - 1) / chunk_bytes);
+		for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+		{
+			const size_t offset = chunk_index * chunk_bytes;
+			const size_t size = MIN(chunk_bytes, large_update.length() - offset);
+			flatbuffers::FlatBufferBuilder builder;
+			auto data = builder.CreateVector(large_update.data() + offset, size);
+			auto chunk = CreatePayloadChunk(builder, 1, chunk_index, chunk_count, offset, large_update.length(), data);
+			UpdateBuilder update(builder);
+			update.add_chunk(chunk);
+			builder.FinishSizePrefixed(update.Finish());
+			DynamicArray<u8> frame;
+			frame.add_uninitialized(builder.GetSize());
+			memcpy(frame.data(), builder.GetBufferPointer(), builder.GetSize());
+			chunk_frames.push_back(std::move(frame));
+		}
+	}
+
+	std::thread client([&]() {
+		const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons((u16) port);
+		assert(connect(socket, (const sockaddr*) &address, sizeof(address)) == 0);
+		auto send_frame = [socket](const DynamicArray<u8>& in_frame) {
+			size_t sent_total = 0;
+			while (sent_total < in_frame.length())
+			{
+				const ssize_t sent = send(socket, in_frame.data() + sent_total, in_frame.length() - sent_total, MSG_NOSIGNAL);
+				assert(sent > 0);
+				sent_total += (size_t) sent;
+			}
+		};
+		send_frame(small_update);
+		for (const DynamicArray<u8>& frame : chunk_frames)
+		{
+			send_frame(frame);
+		}
+		send_frame(small_update);
+		close(socket);
+	});
+
+	LiveLinkCaptureWriter recorder;
+	assert(live_link_capture_writer_open(recorder, CAPTURE_PATH));
+	while (server.counters.update_count < 3)
+	{
+		live_link_server_poll(server, 0, [&recorder](const LiveLinkServerConnection& in_connection, const LiveLinkRoutedUpdate& in_update) {
+			live_link_capture_writer_append(recorder, in_connection.id, in_update.data, in_update.size);
+		});
+	}
+	client.join();
+	live_link_capture_writer_close(recorder);
+	live_link_server_close(server);
+
+	LiveLinkCapture capture;
+	assert(live_link_capture_map(capture, CAPTURE_PATH));
+	assert(capture.frames.length() == 3);
+	const DynamicArray<u8>* expected[] = { &small_update, &large_update, &small_update };
+	for (u32 frame_idx = 0; frame_idx < 3; ++frame_idx)
+	{
+		const LiveLinkCaptureIndexEntry& entry = capture.frames[frame_idx];
+		assert(entry.frame_size == expected[frame_idx]->length());
+		const u8* frame = live_link_capture_frame_data(capture, entry);
+		assert(memcmp(frame, expected[frame_idx]->data(), entry.frame_size) == 0);
+		const Update* update = GetSizePrefixedUpdate(frame);
+		assert(update->chunk() == nullptr && update->transforms() != nullptr);
+	}
+	assert(GetSizePrefixedUpdate(live_link_capture_frame_data(capture, capture.frames[1]))->transforms()->size() == 4000);
+	live_link_capture_unmap(capture);
+}
+
+int main()
+{
+	test_round_trip();
+	test_interrupted_recording_is_recovered();
+	test_damaged_index_and_foreign_files();
+	test_replay_pacing();
+	test_recording_from_server();
+	remove(CAPTURE_PATH);
+	printf("live link capture tests passed\n");
+	return 0;
+}
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""FlatBuffers round-trip coverage for chunked live-link transfers."""
+
+import pathlib
+import struct
+import sys
+import unittest
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parents[2]
+sys.path.insert(0, str(REPO_ROOT))
+
+from compiled_schemas.python import flatbuffers
+from compiled_schemas.python.Blender.LiveLink import PayloadChunk
+from compiled_schemas.python.Blender.LiveLink import Update
+
+from transform_delta_protocol_tests import build_mesh_update
+
+
+# Mirrors make_chunk_frames in extension_main.py
+def make_chunk_frames(payload, transfer_id, chunk_bytes):
+    payload_view = memoryview(payload)
+    total_size = len(payload_view)
+    chunk_count = max(1, (total_size + chunk_bytes - 1) // chunk_bytes)
+    for chunk_index in range(chunk_count):
+        offset = chunk_index * chunk_bytes
+        builder = flatbuffers.Builder(min(chunk_bytes, total_size - offset) + 128)
+        chunk_data = builder.CreateByteVector(bytes(payload_view[offset:offset + chunk_bytes]))
+        PayloadChunk.Start(builder)
+        PayloadChunk.AddTransferId(builder, transfer_id)
+        PayloadChunk.AddChunkIndex(builder, chunk_index)
+        PayloadChunk.AddChunkCount(builder, chunk_count)
+        PayloadChunk.AddOffset(builder, offset)
+        PayloadChunk.AddTotalSize(builder, total_size)
+        PayloadChunk.AddData(builder, chunk_data)
+        chunk = PayloadChunk.End(builder)
+        Update.Start(builder)
+        Update.AddChunk(builder, chunk)
+        builder.FinishSizePrefixed(Update.End(builder))
+        yield builder.Output()
+
+
+def read_chunk(frame):
+    (payload_size,) = struct.unpack_from("<I", frame, 0)
+    assert payload_size + 4 == len(frame)
+    update = Update.Update.GetRootAs(frame, 4)
+    return update, update.Chunk()
+
+
+def reassemble(frames):
+    assembled = None
+    for frame in frames:
+        _, chunk = read_chunk(frame)
+        if assembled is None:
+            assembled = bytearray(chunk.TotalSize())
+        data = bytes(chunk.Data(index) for index in range(chunk.DataLength()))
+        assembled[chunk.Offset():chunk.Offset() + len(data)] = data
+    return bytes(assembled)
+
+
+class ChunkProtocolTests(unittest.TestCase):
+    def test_chunks_rebuild_the_size_prefixed_update(self):
+        payload = bytes(build_mesh_update(5, 700))
+        frames = list(make_chunk_frames(payload, 3, 4096))
+        self.assertEqual(len(frames), (len(payload) + 4095) // 4096)
+        self.assertEqual(reassemble(frames), payload)
+
+        rebuilt = Update.Update.GetRootAs(reassemble(frames), 4)
+        self.assertEqual(rebuilt.ObjectsLength(), 1)
+        self.assertEqual(rebuilt.Objects(0).UniqueId(), 5)
+
+    def test_chunk_headers_number_and_tile_the_transfer(self):
+        payload = bytes(range(256)) * 40
+        frames = list(make_chunk_frames(payload, 0xFFFFFFFF, 1000))
+        next_offset = 0
+        for chunk_index, frame in enumerate(frames):
+            update, chunk = read_chunk(frame)
+            self.assertTrue(update.ObjectsIsNone())
+            self.assertTrue(update.TransformsIsNone())
+            self.assertEqual(chunk.TransferId(), 0xFFFFFFFF)
+            self.assertEqual(chunk.ChunkIndex(), chunk_index)
+            self.assertEqual(chunk.ChunkCount(), len(frames))
+            self.assertEqual(chunk.TotalSize(), len(payload))
+            self.assertEqual(chunk.Offset(), next_offset)
+            self.assertLessEqual(chunk.DataLength(), 1000)
+            self.assertLess(len(frame), 1000 + 128)
+            next_offset += chunk.DataLength()
+        self.assertEqual(next_offset, len(payload))
+
+    def test_exact_multiple_and_single_chunk(self):
+        for payload_size, chunk_bytes, chunk_count in ((4096, 1024, 4), (100, 1024, 1), (1025, 1024, 2)):
+            payload = bytes((index * 7) & 0xFF for index in range(payload_size))
+            frames = list(make_chunk_frames(payload, 1, chunk_bytes))
+            self.assertEqual(len(frames), chunk_count)
+            self.assertEqual(reassemble(frames), payload)
+
+    def test_plain_updates_have_no_chunk(self):
+        update = Update.Update.GetRootAs(build_mesh_update(1, 3), 4)
+        self.assertIsNone(update.Chunk())
+
+
+if __name__ == "__main__":
+    unittest.main()
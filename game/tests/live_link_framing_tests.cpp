@@ -0,0 +1,235 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include <sys/socket.h>
+
+#include "core/dynamic_array.h"
+#include "live_link/live_link_framing.h"
+
+// Builds a size-prefixed frame whose payload bytes encode (frame_index, offset)
+DynamicArray<u8> make_frame(u32 in_payload_size, u8 in_seed)
+{
+	DynamicArray<u8> frame;
+	frame.add_uninitialized(LIVE_LINK_FRAME_PREFIX_BYTES + in_payload_size);
+	frame[0] = (u8) (in_payload_size & 0xFF);
+	frame[1] = (u8) ((in_payload_size >> 8) & 0xFF);
+	frame[2] = (u8) ((in_payload_size >> 16) & 0xFF);
+	frame[3] = (u8) ((in_payload_size >> 24) & 0xFF);
+	for (u32 index = 0; index < in_payload_size; ++index)
+	{
+		frame[LIVE_LINK_FRAME_PREFIX_BYTES + index] = (u8) (in_seed + index * 31);
+	}
+	return frame;
+}
+
+bool frame_matches(const LiveLinkFrame& in_frame, const DynamicArray<u8>& in_expected)
+{
+	return in_frame.size == in_expected.length()
+		&& memcmp(in_frame.data, in_expected.data(), in_frame.size) == 0;
+}
+
+struct SocketPair
+{
+	int sender = -1;
+	int receiver = -1;
+
+	SocketPair()
+	{
+		int fds[2];
+		const int result = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+		assert(result == 0);
+		sender = fds[0];
+		receiver = fds[1];
+	}
+
+	~SocketPair()
+	{
+		close(sender);
+		close(receiver);
+	}
+
+	void send_all(const u8* in_data, size_t in_size)
+	{
+		while (in_size > 0)
+		{
+			const ssize_t sent = send(sender, in_data, in_size, 0);
+			assert(sent > 0);
+			in_data += sent;
+			in_size -= (size_t) sent;
+		}
+	}
+};
+
+// Receives until in_expected_count frames were produced, checking each
+void receive_frames(
+	SocketPair& in_pair, LiveLinkReceiveRing& in_ring,
+	const DynamicArray<u8>* in_expected, i32 in_expected_count)
+{
+	i32 received = 0;
+	while (received < in_expected_count)
+	{
+		const ELiveLinkReceiveStatus status = in_ring.receive(in_pair.receiver);
+		assert(status == ELiveLinkReceiveStatus::Data);
+		LiveLinkFrame frame;
+		while (in_ring.next_frame(frame))
+		{
+			assert(received < in_expected_count);
+			assert(frame_matches(frame, in_expected[received]));
+			++received;
+		}
+	}
+	assert(in_ring.buffered_byte_count() == 0);
+}
+
+void test_coalesced_frames()
+{
+	SocketPair pair;
+	LiveLinkReceiveRing ring;
+	ring.init(1024);
+
+	DynamicArray<u8> frames[5] = {
+		make_frame(17, 1), make_frame(0, 2), make_frame(200, 3), make_frame(1, 4), make_frame(64, 5),
+	};
+	DynamicArray<u8> stream;
+	for (const DynamicArray<u8>& frame : frames)
+	{
+		const size_t offset = stream.length();
+		stream.add_uninitialized(frame.length());
+		memcpy(stream.data() + offset, frame.data(), frame.length());
+	}
+	pair.send_all(stream.data(), stream.length());
+
+	// Everything fits the ring, so one recv yields all five frames
+	assert(ring.receive(pair.receiver) == ELiveLinkReceiveStatus::Data);
+	LiveLinkFrame frame;
+	for (const DynamicArray<u8>& expected : frames)
+	{
+		assert(ring.next_frame(frame));
+		assert(frame_matches(frame, expected));
+	}
+	assert(!ring.next_frame(frame));
+	assert(ring.recv_count == 1);
+	assert(ring.frame_count == 5);
+	assert(ring.grow_count == 1);
+}
+
+void test_split_frames()
+{
+	SocketPair pair;
+	LiveLinkReceiveRing ring;
+	ring.init(256);
+
+	DynamicArray<u8> frames[3] = { make_frame(100, 7), make_frame(90, 8), make_frame(3, 9) };
+	DynamicArray<u8> stream;
+	for (const DynamicArray<u8>& frame : frames)
+	{
+		const size_t offset = stream.length();
+		stream.add_uninitialized(frame.length());
+		memcpy(stream.data() + offset, frame.data(), frame.length());
+	}
+
+	// Dribble the stream so prefixes and payloads straddle recv boundaries
+	i32 received = 0;
+	size_t sent = 0;
+	const size_t chunk_sizes[] = { 1, 2, 5, 3, 64, 7, 1, 40 };
+	size_t chunk_index = 0;
+	while (received < 3)
+	{
+		if (sent < stream.length())
+		{
+			const size_t chunk = MIN(chunk_sizes[chunk_index++ % 8], stream.length() - sent);
+			pair.send_all(stream.data() + sent, chunk);
+			sent += chunk;
+		}
+		assert(ring.receive(pair.receiver) == ELiveLinkReceiveStatus::Data);
+		LiveLinkFrame frame;
+		while (ring.next_frame(frame))
+		{
+			assert(frame_matches(frame, frames[received]));
+			++received;
+		}
+	}
+	assert(sent == stream.length());
+	assert(ring.buffered_byte_count() == 0);
+	assert(ring.grow_count == 1);
+}
+
+void test_large_frame_received_in_place()
+{
+	SocketPair pair;
+	LiveLinkReceiveRing ring;
+	ring.init(4096);
+
+	// A frame far larger than the ring plus a small trailing one
+	DynamicArray<u8> frames[2] = { make_frame(3 * 1024 * 1024 + 13, 11), make_frame(33, 12) };
+	std::thread sender([&]() {
+		for (const DynamicArray<u8>& frame : frames)
+		{
+			pair.send_all(frame.data(), frame.length());
+		}
+	});
+	receive_frames(pair, ring, frames, 2);
+	sender.join();
+
+	// The ring grew once to hold the big frame contiguously and only moved
+	// partial-frame bytes, never whole payloads.
+	assert(ring.capacity() >= frames[0].length());
+	assert(ring.compacted_byte_count < frames[0].length());
+
+	// The grown allocation is reused for later frames without regrowing
+	const u64 grow_count = ring.grow_count;
+	const u8* storage = ring.storage.data();
+	std::thread second_sender([&]() {
+		for (const DynamicArray<u8>& frame : frames)
+		{
+			pair.send_all(frame.data(), frame.length());
+		}
+	});
+	receive_frames(pair, ring, frames, 2);
+	second_sender.join();
+	assert(ring.grow_count == grow_count);
+	assert(ring.storage.data() == storage);
+}
+
+void test_append_and_malformed_prefix()
+{
+	LiveLinkReceiveRing ring;
+	ring.init(16);
+
+	DynamicArray<u8> frame = make_frame(40, 21);
+	assert(ring.append(frame.data(), 10) == ELiveLinkReceiveStatus::Data);
+	LiveLinkFrame out_frame;
+	assert(!ring.next_frame(out_frame));
+	assert(ring.pending_frame_byte_count() == frame.length() - 10);
+	assert(ring.append(frame.data() + 10, frame.length() - 10) == ELiveLinkReceiveStatus::Data);
+	assert(ring.next_frame(out_frame));
+	assert(frame_matches(out_frame, frame));
+
+	const u8 bogus_prefix[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+	ring.append(bogus_prefix, 4);
+	assert(!ring.next_frame(out_frame));
+	assert(ring.append(bogus_prefix, 1) == ELiveLinkReceiveStatus::Malformed);
+}
+
+void test_closed_peer()
+{
+	SocketPair pair;
+	LiveLinkReceiveRing ring;
+	ring.init(64);
+	shutdown(pair.sender, SHUT_WR);
+	assert(ring.receive(pair.receiver) == ELiveLinkReceiveStatus::Closed);
+}
+
+int main()
+{
+	test_coalesced_frames();
+	test_split_frames();
+	test_large_frame_received_in_place();
+	test_append_and_malformed_prefix();
+	test_closed_peer();
+	printf("live link framing tests passed\n");
+	return 0;
+}
@@ -0,0 +1,632 @@
+#include <cassert>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "live_link/live_link_mesh_decode.h"
+
+using namespace Blender::LiveLink;
+
+struct MeshSpec
+{
+	u32 vertex_count = 0;
+	u32 index_count = 0;
+	u32 material_id_count = 0;
+	bool skinned = false;
+	bool break_skinning = false;
+	bool break_indices = false;
+	bool drop_normals = false;
+	i32 content_seed = -1;	// stream values derive from this (default: object index)
+	u64 wire_content_hash = 0;
+	bool reference_only = false;	// send only wire_content_hash, no streams
+	bool quantized = false;	// quantized vertex streams instead of float ones
+	bool indices16 = false;	// 16-bit index stream instead of 32-bit
+};
+
+// Builds a size-prefixed Update with one mesh object per spec. Values are
+// derived from (object, element) so every stream has distinct contents.
+void build_update(flatbuffers::FlatBufferBuilder& in_builder, const MeshSpec* in_specs, i32 in_spec_count)
+{
+	std::vector<flatbuffers::Offset<Object>> objects;
+	for (i32 spec_idx = 0; spec_idx < in_spec_count; ++spec_idx)
+	{
+		const MeshSpec& spec = in_specs[spec_idx];
+		const i32 seed = spec.content_seed >= 0 ? spec.content_seed : spec_idx;
+		std::vector<f32> positions, normals, texcoords, joint_weights;
+		std::vector<u32> indices;
+		std::vector<i32> joint_indices, material_ids;
+		for (u32 vertex_idx = 0; vertex_idx < spec.vertex_count; ++vertex_idx)
+		{
+			for (u32 axis = 0; axis < 3; ++axis)
+			{
+				positions.push_back((f32) seed * 100.0f + (f32) vertex_idx + 0.25f * (f32) axis);
+				normals.push_back(-0.5f * (f32) axis + 0.001f * (f32) vertex_idx);
+			}
+			texcoords.push_back(0.01f * (f32) vertex_idx);
+			texcoords.push_back(1.0f - 0.02f * (f32) vertex_idx);
+			for (u32 influence = 0; influence < 4; ++influence)
+			{
+				joint_indices.push_back((i32) ((vertex_idx * 7 + influence * 3 + seed) % 37));
+				joint_weights.push_back(0.25f + 0.01f * (f32) influence);
+			}
+		}
+		const u32 index_count = spec.break_indices ? spec.index_count + 1 : spec.index_count;
+		for (u32 index_idx = 0; index_idx < index_count; ++index_idx)
+		{
+			indices.push_back((index_idx * 5 + (u32) seed) % MAX(spec.vertex_count, 1u));
+		}
+		for (u32 material_idx = 0; material_idx < spec.material_id_count; ++material_idx)
+		{
+			material_ids.push_back((i32) (material_idx * 11 + 3));
+		}
+		if (spec.break_skinning)
+		{
+			joint_weights.pop_back();
+		}
+
+		// Quantized the way the exporter does it: AABB-relative unorm16
+		// positions, octahedral normals, half-float texcoords
+		std::vector<u16> quantized_positions, half_texcoords, indices16;
+		std::vector<i16> oct_normals;
+		VertexQuantization quantization = {};
+		if (spec.quantized)
+		{
+			HMM_Vec3 position_min = HMM_V3(FLT_MAX, FLT_MAX, FLT_MAX);
+			HMM_Vec3 position_max = HMM_V3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (u32 vertex_idx = 0; vertex_idx < spec.vertex_count; ++vertex_idx)
+			{
+				for (u32 axis = 0; axis < 3; ++axis)
+				{
+					position_min.Elements[axis] = MIN(position_min.Elements[axis], positions[vertex_idx * 3 + axis]);
+					position_max.Elements[axis] = MAX(position_max.Elements[axis], positions[vertex_idx * 3 + axis]);
+				}
+			}
+			quantization = vertex_quantization_from_bounds(position_min, position_max);
+			for (u32 vertex_idx = 0; vertex_idx < spec.vertex_count; ++vertex_idx)
+			{
+				const Vertex vertex = {
+					.position = HMM_V4(positions[vertex_idx * 3 + 0], positions[vertex_idx * 3 + 1], positions[vertex_idx * 3 + 2], 1.0f),
+					.normal = HMM_V4(normals[vertex_idx * 3 + 0], normals[vertex_idx * 3 + 1], normals[vertex_idx * 3 + 2], 0.0f),
+					.texcoord = HMM_V2(texcoords[vertex_idx * 2 + 0], texcoords[vertex_idx * 2 + 1]),
+				};
+				const CompactVertex compact = vertex_quantize(vertex, quantization);
+				quantized_positions.insert(quantized_positions.end(), compact.position, compact.position + 3);
+				oct_normals.insert(oct_normals.end(), compact.normal, compact.normal + 2);
+				half_texcoords.insert(half_texcoords.end(), compact.texcoord, compact.texcoord + 2);
+			}
+		}
+		for (u32 index : indices)
+		{
+			indices16.push_back((u16) index);
+		}
+
+		auto positions_offset = spec.quantized ? 0 : in_builder.CreateVector(positions);
+		auto normals_offset = spec.drop_normals || spec.quantized ? 0 : in_builder.CreateVector(normals);
+		auto texcoords_offset = spec.quantized ? 0 : in_builder.CreateVector(texcoords);
+		auto indices_offset = spec.indices16 ? 0 : in_builder.CreateVector(indices);
+		auto quantized_positions_offset = spec.quantized ? in_builder.CreateVector(quantized_positions) : 0;
+		auto oct_normals_offset = spec.quantized && !spec.drop_normals ? in_builder.CreateVector(oct_normals) : 0;
+		auto half_texcoords_offset = spec.quantized ? in_builder.CreateVector(half_texcoords) : 0;
+		auto indices16_offset = spec.indices16 ? in_builder.CreateVector(indices16) : 0;
+		const Vec3 position_min(quantization.position_min.X, quantization.position_min.Y, quantization.position_min.Z);
+		const Vec3 position_extent(quantization.position_extent.X, quantization.position_extent.Y, quantization.position_extent.Z);
+		auto joint_indices_offset = spec.skinned ? in_builder.CreateVector(joint_indices) : 0;
+		auto joint_weights_offset = spec.skinned ? in_builder.CreateVector(joint_weights) : 0;
+		auto material_ids_offset = spec.material_id_count > 0 ? in_builder.CreateVector(material_ids) : 0;
+
+		MeshBuilder mesh_builder(in_builder);
+		if (!spec.reference_only && !spec.quantized)
+		{
+			mesh_builder.add_positions(positions_offset);
+			if (!spec.drop_normals) { mesh_builder.add_normals(normals_offset); }
+			mesh_builder.add_texcoords(texcoords_offset);
+		}
+		if (!spec.reference_only && spec.quantized)
+		{
+			mesh_builder.add_quantized_positions(quantized_positions_offset);
+			mesh_builder.add_position_min(&position_min);
+			mesh_builder.add_position_extent(&position_extent);
+			if (!spec.drop_normals) { mesh_builder.add_oct_normals(oct_normals_offset); }
+			mesh_builder.add_half_texcoords(half_texcoords_offset);
+		}
+		if (!spec.reference_only && !spec.indices16) { mesh_builder.add_indices(indices_offset); }
+		if (!spec.reference_only && spec.indices16) { mesh_builder.add_indices16(indices16_offset); }
+		if (spec.wire_content_hash != 0) { mesh_builder.add_content_hash(spec.wire_content_hash); }
+		if (spec.skinned && !spec.reference_only)
+		{
+			mesh_builder.add_joint_indices(joint_indices_offset);
+			mesh_builder.add_joint_weights(joint_weights_offset);
+			mesh_builder.add_armature_id(7);
+		}
+		if (spec.material_id_count > 0) { mesh_builder.add_material_ids(material_ids_offset); }
+		auto mesh_offset = mesh_builder.Finish();
+
+		ObjectBuilder object_builder(in_builder);
+		object_builder.add_unique_id(spec_idx + 1);
+		object_builder.add_mesh(mesh_offset);
+		objects.push_back(object_builder.Finish());
+	}
+
+	auto objects_offset = in_builder.CreateVector(objects);
+	UpdateBuilder update_builder(in_builder);
+	update_builder.add_objects(objects_offset);
+	in_builder.FinishSizePrefixed(update_builder.Finish());
+}
+
+template<typename T>
+bool streams_match(const T* in_a, const T* in_b, u32 in_count)
+{
+	if (in_count == 0)
+	{
+		return true;
+	}
+	return in_a && in_b && memcmp(in_a, in_b, sizeof(T) * in_count) == 0;
+}
+
+// Original single-threaded decode: per-element accessors into separately
+// malloc'd arrays. The parallel decode must match it byte for byte.
+// Returns false when the mesh is dropped (nothing is left allocated).
+bool live_link_mesh_decode_reference(const Blender::LiveLink::Mesh* in_mesh, i32 in_unique_id, LiveLinkDecodedMesh& out_mesh)
+{
+	out_mesh = {};
+	u32 num_vertices = 0;
+	Vertex* vertices = nullptr;
+	CompactVertex* compact_vertices = nullptr;
+	VertexQuantization quantization = {};
+
+	auto flatbuffer_positions = in_mesh->positions();
+	auto flatbuffer_normals = in_mesh->normals();
+	auto flatbuffer_texcoords = in_mesh->texcoords();
+	const bool has_valid_vertex_streams =
+		flatbuffer_positions &&
+		flatbuffer_normals &&
+		flatbuffer_texcoords &&
+		(flatbuffer_positions->size() % 3) == 0 &&
+		flatbuffer_normals->size() >= flatbuffer_positions->size() &&
+		flatbuffer_texcoords->size() >= (flatbuffer_positions->size() / 3) * 2;
+	if (has_valid_vertex_streams)
+	{
+		num_vertices = flatbuffer_positions->size() / 3;
+		vertices = (Vertex*) malloc(sizeof(Vertex) * num_vertices);
+		for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+		{
+			vertices[vertex_idx] = {
+				.position = {
+					.X = flatbuffer_positions->Get(vertex_idx * 3 + 0),
+					.Y = flatbuffer_positions->Get(vertex_idx * 3 + 1),
+					.Z = flatbuffer_positions->Get(vertex_idx * 3 + 2),
+					.W = 1.0,
+				},
+				.normal = {
+					.X = flatbuffer_normals->Get(vertex_idx * 3 + 0),
+					.Y = flatbuffer_normals->Get(vertex_idx * 3 + 1),
+					.Z = flatbuffer_normals->Get(vertex_idx * 3 + 2),
+					.W = 0.0,
+				},
+				.texcoord = {
+					.X = flatbuffer_texcoords->Get(vertex_idx * 2 + 0),
+					.Y = flatbuffer_texcoords->Get(vertex_idx * 2 + 1),
+				},
+			};
+		}
+	}
+	else if (live_link_mesh_has_quantized_vertex_streams(in_mesh))
+	{
+		auto flatbuffer_quantized_positions = in_mesh->quantized_positions();
+		auto flatbuffer_oct_normals = in_mesh->oct_normals();
+		auto flatbuffer_half_texcoords = in_mesh->half_texcoords();
+		quantization = live_link_mesh_quantization(in_mesh);
+		num_vertices = flatbuffer_quantized_positions->size() / 3;
+		vertices = (Vertex*) malloc(sizeof(Vertex) * num_vertices);
+		compact_vertices = (CompactVertex*) malloc(sizeof(CompactVertex) * num_vertices);
+		for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+		{
+			compact_vertices[vertex_idx] = {
+				.position = {
+					flatbuffer_quantized_positions->Get(vertex_idx * 3 + 0),
+					flatbuffer_quantized_positions->Get(vertex_idx * 3 + 1),
+					flatbuffer_quantized_positions->Get(vertex_idx * 3 + 2),
+					0,
+				},
+				.normal = {
+					flatbuffer_oct_normals->Get(vertex_idx * 2 + 0),
+					flatbuffer_oct_normals->Get(vertex_idx * 2 + 1),
+				},
+				.texcoord = {
+					flatbuffer_half_texcoords->Get(vertex_idx * 2 + 0),
+					flatbuffer_half_texcoords->Get(vertex_idx * 2 + 1),
+				},
+			};
+			vertices[vertex_idx] = vertex_dequantize(compact_vertices[vertex_idx], quantization);
+		}
+	}
+	else
+	{
+		printf("\tDropping malformed mesh vertex streams on object UID: %i\n", in_unique_id);
+	}
+
+	SkinnedVertex* skinned_vertices = nullptr;
+	u32 skin_matrix_count = 0;
+	const i32 armature_id = in_mesh->armature_id();
+	auto flatbuffer_joint_indices = in_mesh->joint_indices();
+	auto flatbuffer_joint_weights = in_mesh->joint_weights();
+	if (armature_id > 0 && flatbuffer_joint_indices && flatbuffer_joint_weights)
+	{
+		const u32 num_joint_indices = flatbuffer_joint_indices->size();
+		const u32 num_joint_weights = flatbuffer_joint_weights->size();
+		const u32 num_skinned_vertices = num_joint_indices / 4;
+		if (num_vertices == 0 ||
+			num_joint_indices != num_joint_weights ||
+			(num_joint_indices % 4) != 0 ||
+			num_vertices != num_skinned_vertices)
+		{
+			printf("\tDropping malformed skinning data on object UID: %i\n", in_unique_id);
+		}
+		else
+		{
+			i32 max_joint_index = 0;
+			skinned_vertices = (SkinnedVertex*) malloc(sizeof(SkinnedVertex) * num_vertices);
+			for (u32 vertex_idx = 0; vertex_idx < num_vertices; ++vertex_idx)
+			{
+				for (u32 influence_idx = 0; influence_idx < 4; ++influence_idx)
+				{
+					max_joint_index = MAX(max_joint_index, flatbuffer_joint_indices->Get(vertex_idx * 4 + influence_idx));
+				}
+
+				skinned_vertices[vertex_idx] = {
+					.joint_indices = {
+						.X = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 0),
+						.Y = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 1),
+						.Z = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 2),
+						.W = (f32) flatbuffer_joint_indices->Get(vertex_idx * 4 + 3),
+					},
+					.joint_weights = {
+						.X = flatbuffer_joint_weights->Get(vertex_idx * 4 + 0),
+						.Y = flatbuffer_joint_weights->Get(vertex_idx * 4 + 1),
+						.Z = flatbuffer_joint_weights->Get(vertex_idx * 4 + 2),
+						.W = flatbuffer_joint_weights->Get(vertex_idx * 4 + 3),
+					},
+				};
+			}
+			skin_matrix_count = (u32) max_joint_index + 1;
+		}
+	}
+
+	u32 num_indices = 0;
+	u32* indices = nullptr;
+	if (auto flatbuffer_indices = in_mesh->indices())
+	{
+		if ((flatbuffer_indices->size() % 3) != 0)
+		{
+			printf("\tDropping malformed triangle index stream on object UID: %i\n", in_unique_id);
+		}
+		else
+		{
+			num_indices = flatbuffer_indices->size();
+			indices = (u32*) malloc(sizeof(u32) * num_indices);
+			for (u32 indices_idx = 0; indices_idx < num_indices; ++indices_idx)
+			{
+				indices[indices_idx] = flatbuffer_indices->Get(indices_idx);
+			}
+		}
+	}
+	else if (auto flatbuffer_indices16 = in_mesh->indices16())
+	{
+		if ((flatbuffer_indices16->size() % 3) != 0)
+		{
+			printf("\tDropping malformed triangle index stream on object UID: %i\n", in_unique_id);
+		}
+		else
+		{
+			num_indices = flatbuffer_indices16->size();
+			indices = (u32*) malloc(sizeof(u32) * num_indices);
+			for (u32 indices_idx = 0; indices_idx < num_indices; ++indices_idx)
+			{
+				indices[indices_idx] = flatbuffer_indices16->Get(indices_idx);
+			}
+		}
+	}
+
+	u32 num_material_indices = 0;
+	i32* material_indices = nullptr;
+	if (auto flatbuffer_material_ids = in_mesh->material_ids())
+	{
+		num_material_indices = flatbuffer_material_ids->size();
+		material_indices = (i32*) malloc(sizeof(i32) * num_material_indices);
+		for (u32 material_id_idx = 0; material_id_idx < num_material_indices; ++material_id_idx)
+		{
+			material_indices[material_id_idx] = flatbuffer_material_ids->Get(material_id_idx);
+		}
+	}
+
+	if (num_vertices == 0 || num_indices == 0)
+	{
+		free(indices);
+		free(vertices);
+		free(material_indices);
+		free(skinned_vertices);
+		free(compact_vertices);
+		return false;
+	}
+
+	u16* compact_indices = nullptr;
+	if (!live_link_mesh_keeps_compact_streams(compact_vertices != nullptr, skinned_vertices != nullptr))
+	{
+		free(compact_vertices);
+		compact_vertices = nullptr;
+		quantization = {};
+	}
+	else if (num_vertices <= COMPACT_INDEX_MAX_VERTEX_COUNT)
+	{
+		compact_indices = (u16*) malloc(sizeof(u16) * num_indices);
+		for (u32 indices_idx = 0; indices_idx < num_indices; ++indices_idx)
+		{
+			compact_indices[indices_idx] = (u16) indices[indices_idx];
+		}
+	}
+
+	out_mesh = {
+		.num_vertices = num_vertices,
+		.vertices = vertices,
+		.skinned_vertices = skinned_vertices,
+		.skin_matrix_count = skin_matrix_count,
+		.num_indices = num_indices,
+		.indices = indices,
+		.num_material_indices = num_material_indices,
+		.material_indices = material_indices,
+		.armature_id = armature_id,
+		.compact_vertices = compact_vertices,
+		.compact_indices = compact_indices,
+		.quantization = quantization,
+	};
+	out_mesh.content_hash = in_mesh->content_hash() != 0 ? in_mesh->content_hash() : live_link_mesh_content_hash(out_mesh);
+	return true;
+}
+
+void free_reference_mesh(const LiveLinkDecodedMesh& in_mesh)
+{
+	free(in_mesh.vertices);
+	free(in_mesh.skinned_vertices);
+	free(in_mesh.indices);
+	free(in_mesh.material_indices);
+	free(in_mesh.compact_vertices);
+	free(in_mesh.compact_indices);
+}
+
+void check_decode_matches_reference(i32 in_worker_count)
+{
+	const MeshSpec specs[] = {
+		{ .vertex_count = 3, .index_count = 3 },
+		{ .vertex_count = 500, .index_count = 1500, .material_id_count = 500, .skinned = true },
+		{ .vertex_count = 4, .index_count = 6, .drop_normals = true },
+		{ .vertex_count = 40, .index_count = 90, .skinned = true, .break_skinning = true },
+		{ .vertex_count = 8, .index_count = 12, .break_indices = true },
+		{ .vertex_count = 2049, .index_count = 6000, .material_id_count = 2000 },
+		{ .vertex_count = 17, .index_count = 48, .material_id_count = 16, .skinned = true },
+		{ .vertex_count = 300, .index_count = 900, .material_id_count = 300, .quantized = true, .indices16 = true },
+		{ .vertex_count = 200, .index_count = 600, .quantized = true },
+		{ .vertex_count = 50, .index_count = 150, .skinned = true, .quantized = true, .indices16 = true },
+		{ .vertex_count = 6, .index_count = 6, .drop_normals = true, .quantized = true },
+		{ .vertex_count = 70000, .index_count = 3000, .quantized = true },
+		{ .vertex_count = 30, .index_count = 60, .indices16 = true },
+	};
+	const i32 spec_count = (i32) (sizeof(specs) / sizeof(specs[0]));
+
+	flatbuffers::FlatBufferBuilder builder;
+	build_update(builder, specs, spec_count);
+	const Update* update = GetSizePrefixedUpdate(builder.GetBufferPointer());
+	auto objects = update->objects();
+	assert(objects && (i32) objects->size() == spec_count);
+
+	LiveLinkMeshDecodeStage stage;
+	LiveLinkDecodedMesh reference[16] = {};
+	bool reference_valid[16] = {};
+	for (u32 object_idx = 0; object_idx < objects->size(); ++object_idx)
+	{
+		const Object* object = objects->Get(object_idx);
+		const bool planned = live_link_mesh_decode_plan(stage, object->mesh(), object->unique_id(), object_idx);
+		reference_valid[object_idx] = live_link_mesh_decode_reference(object->mesh(), object->unique_id(), reference[object_idx]);
+		assert(planned == reference_valid[object_idx]);
+	}
+	assert(stage.jobs.length() == 10);
+
+	WorkerPool workers;
+	workers.start(in_worker_count);
+	LiveLinkDecodedMesh decoded[16] = {};
+	bool decoded_valid[16] = {};
+	SharedArena* arena = live_link_mesh_decode_run(stage, workers, [&](const LiveLinkMeshDecodeJob& in_job, const LiveLinkDecodedMesh& in_mesh) {
+		// Each consumer takes its own reference, as make_mesh does
+		shared_arena_retain(in_mesh.storage_arena);
+		decoded[in_job.output_index] = in_mesh;
+		decoded_valid[in_job.output_index] = true;
+	});
+	assert(arena != nullptr);
+	assert(arena->size == stage.arena_size);
+	assert(arena->ref_count.load() == 1 + (i32) stage.jobs.length());
+	shared_arena_release(arena);
+
+	for (i32 object_idx = 0; object_idx < spec_count; ++object_idx)
+	{
+		assert(decoded_valid[object_idx] == reference_valid[object_idx]);
+		if (!reference_valid[object_idx])
+		{
+			continue;
+		}
+
+		const LiveLinkDecodedMesh& a = decoded[object_idx];
+		const LiveLinkDecodedMesh& b = reference[object_idx];
+		assert(a.storage_arena == arena && b.storage_arena == nullptr);
+		assert(a.num_vertices == b.num_vertices);
+		assert(a.num_indices == b.num_indices);
+		assert(a.num_material_indices == b.num_material_indices);
+		assert(a.skin_matrix_count == b.skin_matrix_count);
+		assert(a.armature_id == b.armature_id);
+		assert(a.content_hash == b.content_hash && a.content_hash != 0);
+		assert((a.skinned_vertices == nullptr) == (b.skinned_vertices == nullptr));
+		assert(((uintptr_t) a.vertices % SHARED_ARENA_ALIGNMENT) == 0);
+
+		assert(streams_match(a.vertices, b.vertices, a.num_vertices));
+		assert(streams_match(a.indices, b.indices, a.num_indices));
+		assert(streams_match(a.material_indices, b.material_indices, a.num_material_indices));
+		if (a.skinned_vertices)
+		{
+			assert(streams_match(a.skinned_vertices, b.skinned_vertices, a.num_vertices));
+		}
+
+		// Compact GPU streams only for quantized, unskinned meshes; 16-bit
+		// indices only when every vertex is addressable
+		const MeshSpec& spec = specs[object_idx];
+		const bool expect_compact = spec.quantized && a.skinned_vertices == nullptr;
+		assert((a.compact_vertices != nullptr) == expect_compact);
+		assert((b.compact_vertices != nullptr) == expect_compact);
+		assert((a.compact_indices != nullptr) == (expect_compact && a.num_vertices <= COMPACT_INDEX_MAX_VERTEX_COUNT));
+		assert((b.compact_indices != nullptr) == (a.compact_indices != nullptr));
+		assert(memcmp(&a.quantization, &b.quantization, sizeof(VertexQuantization)) == 0);
+		if (a.compact_vertices)
+		{
+			assert(streams_match(a.compact_vertices, b.compact_vertices, a.num_vertices));
+			for (u32 vertex_idx = 0; vertex_idx < a.num_vertices; ++vertex_idx)
+			{
+				const Vertex dequantized = vertex_dequantize(a.compact_vertices[vertex_idx], a.quantization);
+				assert(memcmp(&dequantized, &a.vertices[vertex_idx], sizeof(Vertex)) == 0);
+			}
+		}
+		if (a.compact_indices)
+		{
+			assert(streams_match(a.compact_indices, b.compact_indices, a.num_indices));
+			for (u32 index_idx = 0; index_idx < a.num_indices; ++index_idx)
+			{
+				assert(a.compact_indices[index_idx] == a.indices[index_idx]);
+			}
+		}
+
+		free_reference_mesh(b);
+	}
+
+	// The arena lives until the last mesh lets go of it
+	for (i32 object_idx = 0; object_idx < spec_count; ++object_idx)
+	{
+		if (decoded_valid[object_idx])
+		{
+			shared_arena_release(decoded[object_idx].storage_arena);
+		}
+	}
+}
+
+// Identical streams hash alike whatever else differs; the exporter's hash
+// wins when sent; hash-only meshes are references and are never planned
+void test_content_hashes()
+{
+	const MeshSpec specs[] = {
+		{ .vertex_count = 64, .index_count = 96, .material_id_count = 4, .content_seed = 3 },
+		{ .vertex_count = 64, .index_count = 96, .material_id_count = 9, .content_seed = 3 },
+		{ .vertex_count = 64, .index_count = 96, .content_seed = 4 },
+		{ .vertex_count = 64, .index_count = 96, .skinned = true, .content_seed = 3 },
+		{ .vertex_count = 64, .index_count = 96, .content_seed = 3, .wire_content_hash = 0x1234 },
+		{ .material_id_count = 2, .wire_content_hash = 0x1234, .reference_only = true },
+	};
+	const i32 spec_count = (i32) (sizeof(specs) / sizeof(specs[0]));
+
+	flatbuffers::FlatBufferBuilder builder;
+	build_update(builder, specs, spec_count);
+	auto objects = GetSizePrefixedUpdate(builder.GetBufferPointer())->objects();
+
+	u64 hashes[8] = {};
+	LiveLinkMeshDecodeStage stage;
+	for (u32 object_idx = 0; object_idx < objects->size(); ++object_idx)
+	{
+		const Blender::LiveLink::Mesh* mesh = objects->Get(object_idx)->mesh();
+		const bool is_reference = live_link_mesh_is_content_reference(mesh);
+		assert(is_reference == specs[object_idx].reference_only);
+		if (is_reference)
+		{
+			assert(mesh->content_hash() == 0x1234);
+			continue;
+		}
+
+		LiveLinkDecodedMesh reference;
+		assert(live_link_mesh_decode_reference(mesh, (i32) object_idx, reference));
+		hashes[object_idx] = reference.content_hash;
+		assert(live_link_mesh_decode_plan(stage, mesh, (i32) object_idx, object_idx));
+		free_reference_mesh(reference);
+	}
+
+	assert(hashes[0] == hashes[1]);
+	assert(hashes[0] != hashes[2]);
+	assert(hashes[0] != hashes[3]);
+	assert(hashes[4] == 0x1234);
+
+	WorkerPool workers;
+	workers.start(2);
+	u64 decoded_hashes[8] = {};
+	SharedArena* arena = live_link_mesh_decode_run(stage, workers, [&](const LiveLinkMeshDecodeJob& in_job, const LiveLinkDecodedMesh& in_mesh) {
+		decoded_hashes[in_job.output_index] = in_mesh.content_hash;
+	});
+	shared_arena_release(arena);
+	for (i32 object_idx = 0; object_idx < spec_count - 1; ++object_idx)
+	{
+		assert(decoded_hashes[object_idx] == hashes[object_idx]);
+	}
+}
+
+// The same mesh as float streams vs quantized streams with 16-bit indices
+void test_quantized_wire_size()
+{
+	const MeshSpec float_spec = { .vertex_count = 4000, .index_count = 24000 };
+	const MeshSpec quantized_spec = { .vertex_count = 4000, .index_count = 24000, .quantized = true, .indices16 = true };
+	flatbuffers::FlatBufferBuilder float_builder;
+	flatbuffers::FlatBufferBuilder quantized_builder;
+	build_update(float_builder, &float_spec, 1);
+	build_update(quantized_builder, &quantized_spec, 1);
+
+	// 32 -> 14 bytes per vertex and 4 -> 2 per index
+	const u32 float_bytes = float_builder.GetSize();
+	const u32 quantized_bytes = quantized_builder.GetSize();
+	assert(quantized_bytes * 2 < float_bytes);
+	printf("quantized mesh payload: %u -> %u bytes (%.2fx)\n", float_bytes, quantized_bytes, (f64) float_bytes / (f64) quantized_bytes);
+}
+
+void test_empty_stage()
+{
+	LiveLinkMeshDecodeStage stage;
+	WorkerPool workers;
+	workers.start(2);
+	bool called = false;
+	SharedArena* arena = live_link_mesh_decode_run(stage, workers, [&](const LiveLinkMeshDecodeJob&, const LiveLinkDecodedMesh&) {
+		called = true;
+	});
+	assert(arena == nullptr);
+	assert(!called);
+}
+
+void test_worker_pool_covers_every_index()
+{
+	WorkerPool workers;
+	workers.start(4);
+	for (u32 batch_size : { 1u, 3u, 64u })
+	{
+		std::vector<i32> hits(1000, 0);
+		workers.parallel_for((u32) hits.size(), [&](u32 in_index) { hits[in_index] += 1; }, batch_size);
+		for (i32 hit : hits)
+		{
+			assert(hit == 1);
+		}
+	}
+	workers.stop();
+	assert(!workers.is_started());
+	assert(workers.worker_count() == 0);
+}
+
+int main()
+{
+	check_decode_matches_reference(0);
+	check_decode_matches_reference(1);
+	check_decode_matches_reference(4);
+	test_content_hashes();
+	test_quantized_wire_size();
+	test_empty_stage();
+	test_worker_pool_covers_every_index();
+	printf("live link mesh decode tests passed\n");
+	return 0;
+}
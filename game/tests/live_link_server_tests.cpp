@@ -0,0 +1,373 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "live_link/live_link_server.h"
+#include "network/channel.h"
+
+using namespace Blender::LiveLink;
+
+// unique_id encodes (client, session, sequence) so the receiver can check
+// per-connection order without any side channel
+static constexpr i32 SESSION_STRIDE = 10000;
+static constexpr i32 CLIENT_STRIDE = 1000000;
+
+DynamicArray<u8> finish_update(flatbuffers::FlatBufferBuilder& in_builder, flatbuffers::Offset<Update> in_update)
+{
+	in_builder.FinishSizePrefixed(in_update);
+	DynamicArray<u8> bytes;
+	bytes.add_uninitialized(in_builder.GetSize());
+	memcpy(bytes.data(), in_builder.GetBufferPointer(), in_builder.GetSize());
+	return bytes;
+}
+
+DynamicArray<u8> build_transform_update(i32 in_unique_id)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	const ObjectTransform transform(in_unique_id, Vec3(1.0f, 2.0f, 3.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), Vec3(1.0f, 1.0f, 1.0f));
+	auto transforms = builder.CreateVectorOfStructs(&transform, 1);
+	UpdateBuilder update(builder);
+	update.add_transforms(transforms);
+	return finish_update(builder, update.Finish());
+}
+
+// One object whose mesh carries in_vertex_count positions
+DynamicArray<u8> build_mesh_update(i32 in_unique_id, u32 in_vertex_count)
+{
+	flatbuffers::FlatBufferBuilder builder(in_vertex_count * 12 + 256);
+	std::vector<f32> positions(in_vertex_count * 3, (f32) in_unique_id);
+	auto mesh = CreateMesh(builder, builder.CreateVector(positions));
+	ObjectBuilder object(builder);
+	object.add_unique_id(in_unique_id);
+	object.add_mesh(mesh);
+	auto object_offset = object.Finish();
+	auto objects = builder.CreateVector(&object_offset, 1);
+	UpdateBuilder update(builder);
+	update.add_objects(objects);
+	return finish_update(builder, update.Finish());
+}
+
+// Chunk frames of one transfer (mirrors make_chunk_frames in extension_main.py)
+std::vector<DynamicArray<u8>> split_into_chunk_frames(const DynamicArray<u8>& in_update, u32 in_transfer_id, size_t in_chunk_bytes)
+{
+	const size_t total_size = in_update.length();
+	const u32 chunk_count = (u32) ((total_size + in_chunk_bytes - 1) / in_chunk_bytes);
+	std::vector<DynamicArray<u8>> frames;
+	for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		const size_t offset = (size_t) chunk_index * in_chunk_bytes;
+		const size_t size = MIN(in_chunk_bytes, total_size - offset);
+		flatbuffers::FlatBufferBuilder builder(size + 128);
+		auto data = builder.CreateVector(in_update.data() + offset, size);
+		auto chunk = CreatePayloadChunk(builder, in_transfer_id, chunk_index, chunk_count, offset, total_size, data);
+		UpdateBuilder update(builder);
+		update.add_chunk(chunk);
+		frames.push_back(finish_update(builder, update.Finish()));
+	}
+	return frames;
+}
+
+struct TestClient
+{
+	int socket = -1;
+
+	bool connect_to(i32 in_port)
+	{
+		socket = ::socket(AF_INET, SOCK_STREAM, 0);
+		assert(socket >= 0);
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons((u16) in_port);
+		return connect(socket, (const sockaddr*) &address, sizeof(address)) == 0;
+	}
+
+	// Sends in uneven slices so frames straddle recv calls
+	void send_all(const u8* in_data, size_t in_size, u32 in_seed)
+	{
+		u32 slice_seed = in_seed;
+		while (in_size > 0)
+		{
+			slice_seed = slice_seed * 1664525u + 1013904223u;
+			const size_t slice = MIN(in_size, (size_t) 1 + (slice_seed >> 12) % 40000);
+			const ssize_t sent = send(socket, in_data, slice, MSG_NOSIGNAL);
+			assert(sent > 0);
+			in_data += sent;
+			in_size -= (size_t) sent;
+		}
+	}
+
+	void close_socket()
+	{
+		close(socket);
+		socket = -1;
+	}
+};
+
+// Server thread plus a consumer that drains slowly, like a busy main thread
+struct ServerHarness
+{
+	LiveLinkServer server;
+	std::atomic<bool> running = true;
+	std::atomic<u64> queued_bytes = 0;
+	std::atomic<u64> peak_queued_bytes = 0;
+	std::atomic<u64> received_count = 0;
+	u64 largest_update_bytes = 0;
+	Channel<u64> drain_queue;
+	std::mutex received_mutex;
+	std::vector<std::vector<i32>> received_ids_by_connection;	// indexed by connection id
+	std::thread server_thread;
+	std::thread drain_thread;
+
+	void start(const LiveLinkServerConfig& in_config, i32 in_drain_delay_us)
+	{
+		server.config = in_config;
+		assert(live_link_server_open(server, "127.0.0.1", "0"));
+		server_thread = std::thread([this]() {
+			while (running.load())
+			{
+				live_link_server_poll(server, queued_bytes.load(), [this](const LiveLinkServerConnection& in_connection, const LiveLinkRoutedUpdate& in_update) {
+					const Update* update = GetSizePrefixedUpdate(in_update.data);
+					assert(update->chunk() == nullptr);
+					const i32 unique_id = update->transforms()
+						? update->transforms()->Get(0)->unique_id()
+						: update->objects()->Get(0)->unique_id();
+					if (auto objects = update->objects())
+					{
+						const u32 position_count = objects->Get(0)->mesh()->positions()->size();
+						assert(objects->Get(0)->mesh()->positions()->Get(position_count - 1) == (f32) unique_id);
+					}
+					{
+						std::lock_guard<std::mutex> lock(received_mutex);
+						if (received_ids_by_connection.size() <= in_connection.id)
+						{
+							received_ids_by_connection.resize(in_connection.id + 1);
+						}
+						received_ids_by_connection[in_connection.id].push_back(unique_id);
+						largest_update_bytes = MAX(largest_update_bytes, (u64) in_update.size);
+					}
+					const u64 queued = queued_bytes.fetch_add(in_update.size) + in_update.size;
+					u64 peak = peak_queued_bytes.load();
+					while (queued > peak && !peak_queued_bytes.compare_exchange_weak(peak, queued)) {}
+					drain_queue.send((u64) in_update.size);
+					received_count += 1;
+				});
+			}
+		});
+		drain_thread = std::thread([this, in_drain_delay_us]() {
+			while (running.load())
+			{
+				if (std::optional<u64> size = drain_queue.receive())
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(in_drain_delay_us));
+					queued_bytes -= *size;
+				}
+				else
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(200));
+				}
+			}
+		});
+	}
+
+	bool wait_for(u64 in_update_count, i32 in_timeout_seconds)
+	{
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(in_timeout_seconds);
+		while (received_count.load() < in_update_count && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return received_count.load() >= in_update_count;
+	}
+
+	void stop()
+	{
+		running = false;
+		server_thread.join();
+		drain_thread.join();
+		live_link_server_close(server);
+	}
+};
+
+void test_concurrent_clients_reconnects_and_backpressure()
+{
+	const i32 client_count = 8;
+	const i32 session_count = 3;
+	const i32 updates_per_session = 40;
+	const u64 queue_budget_bytes = 512 * 1024;
+	const u64 read_budget_bytes = 64 * 1024;
+
+	ServerHarness harness;
+	harness.start({
+		.read_budget_bytes = read_budget_bytes,
+		.queue_budget_bytes = queue_budget_bytes,
+		.max_connections = 4 * client_count,
+		.poll_timeout_ms = 10,
+		.backpressure_poll_ms = 1,
+	}, 300);
+	const i32 port = live_link_server_port(harness.server);
+	assert(port > 0);
+
+	// Well-behaved senders: sessions of transforms, every 8th update a mesh
+	// big enough to go out as a chunked transfer, then disconnect and
+	// reconnect like a Blender restart
+	std::vector<std::thread> clients;
+	for (i32 client_idx = 0; client_idx < client_count; ++client_idx)
+	{
+		clients.emplace_back([=]() {
+			for (i32 session_idx = 0; session_idx < session_count; ++session_idx)
+			{
+				TestClient client;
+				assert(client.connect_to(port));
+				u32 transfer_id = 1;
+				for (i32 sequence = 0; sequence < updates_per_session; ++sequence)
+				{
+					const i32 unique_id = (client_idx + 1) * CLIENT_STRIDE + session_idx * SESSION_STRIDE + sequence;
+					if (sequence % 8 == 7)
+					{
+						const DynamicArray<u8> mesh_update = build_mesh_update(unique_id, 20000 + client_idx * 100);
+						for (const DynamicArray<u8>& frame : split_into_chunk_frames(mesh_update, transfer_id++, 64 * 1024))
+						{
+							client.send_all(frame.data(), frame.length(), (u32) unique_id);
+						}
+					}
+					else
+					{
+						const DynamicArray<u8> transform_update = build_transform_update(unique_id);
+						client.send_all(transform_update.data(), transform_update.length(), (u32) unique_id);
+					}
+				}
+				client.close_socket();
+			}
+		});
+	}
+
+	// Misbehaving senders must only lose their own connection: an
+	// unframeable prefix, and a disconnect halfway through a frame and
+	// halfway through a chunked transfer
+	{
+		TestClient bogus;
+		assert(bogus.connect_to(port));
+		const u8 bogus_prefix[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 1, 2, 3, 4 };
+		bogus.send_all(bogus_prefix, sizeof(bogus_prefix), 1);
+
+		TestClient truncated;
+		assert(truncated.connect_to(port));
+		const DynamicArray<u8> update = build_transform_update(-1);
+		truncated.send_all(update.data(), update.length() / 2, 2);
+
+		TestClient abandoned_transfer;
+		assert(abandoned_transfer.connect_to(port));
+		const std::vector<DynamicArray<u8>> frames = split_into_chunk_frames(build_mesh_update(-2, 30000), 9, 64 * 1024);
+		abandoned_transfer.send_all(frames[0].data(), frames[0].length(), 3);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		truncated.close_socket();
+		abandoned_transfer.close_socket();
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		bogus.close_socket();
+	}
+
+	for (std::thread& client : clients)
+	{
+		client.join();
+	}
+	const u64 expected_count = (u64) client_count * session_count * updates_per_session;
+	assert(harness.wait_for(expected_count, 60));
+	// Let the server notice the last disconnects
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	harness.stop();
+
+	const LiveLinkServerCounters& counters = harness.server.counters;
+	printf("server: %llu accepted, %llu closed, %llu dropped, %llu updates, %llu budget yields, %llu backpressure pauses, peak queue %llu KB\n",
+		(unsigned long long) counters.accepted_count,
+		(unsigned long long) counters.closed_count,
+		(unsigned long long) counters.dropped_count,
+		(unsigned long long) counters.update_count,
+		(unsigned long long) counters.budget_yield_count,
+		(unsigned long long) counters.backpressure_count,
+		(unsigned long long) harness.peak_queued_bytes.load() / 1024);
+
+	// Every update of every session arrived once, in order, on its own connection
+	assert(harness.received_count.load() == expected_count);
+	assert(counters.update_count == expected_count);
+	assert(counters.accepted_count == (u64) client_count * session_count + 3);
+	assert(counters.dropped_count >= 1);
+	assert(counters.closed_count + counters.dropped_count == counters.accepted_count);
+	assert(harness.server.connections.empty());
+	i32 session_connection_count = 0;
+	for (const std::vector<i32>& ids : harness.received_ids_by_connection)
+	{
+		if (ids.empty())
+		{
+			continue;
+		}
+		session_connection_count += 1;
+		assert((i32) ids.size() == updates_per_session);
+		for (i32 sequence = 0; sequence < updates_per_session; ++sequence)
+		{
+			assert(ids[sequence] == ids[0] + sequence);
+		}
+		assert(ids[0] % SESSION_STRIDE == 0);
+	}
+	assert(session_connection_count == client_count * session_count);
+
+	// Reads paused while the consumer lagged, and resumed. The queue only
+	// overshoots its budget by the last connection read before the check:
+	// one read budget, plus a frame or transfer that was already mostly
+	// buffered, plus the update it completes
+	assert(counters.backpressure_count > 0);
+	assert(counters.budget_yield_count > 0);
+	assert(harness.peak_queued_bytes.load() <= queue_budget_bytes + read_budget_bytes + 2 * harness.largest_update_bytes);
+}
+
+void test_connection_limit_and_reopen()
+{
+	ServerHarness harness;
+	harness.start({ .max_connections = 2, .poll_timeout_ms = 10 }, 0);
+	const i32 port = live_link_server_port(harness.server);
+
+	TestClient first, second, third;
+	assert(first.connect_to(port));
+	assert(second.connect_to(port));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	assert(third.connect_to(port));	// completes in the backlog, then is closed
+
+	// The rejected sender sees an orderly close
+	u8 byte = 0;
+	assert(recv(third.socket, &byte, 1, 0) == 0);
+	third.close_socket();
+
+	const DynamicArray<u8> update = build_transform_update(CLIENT_STRIDE);
+	first.send_all(update.data(), update.length(), 5);
+	assert(harness.wait_for(1, 10));
+	first.close_socket();
+	second.close_socket();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	harness.stop();
+	assert(harness.server.counters.rejected_count == 1);
+	assert(harness.server.counters.accepted_count == 2);
+	assert(harness.server.listen_socket == INVALID_SOCKET);
+
+	// The port can be taken again right away, as after a runtime restart
+	LiveLinkServer reopened;
+	char port_string[16];
+	snprintf(port_string, sizeof(port_string), "%i", port);
+	assert(live_link_server_open(reopened, "127.0.0.1", port_string));
+	live_link_server_close(reopened);
+}
+
+int main()
+{
+	test_concurrent_clients_reconnects_and_backpressure();
+	test_connection_limit_and_reopen();
+	printf("live link server tests passed\n");
+	return 0;
+}
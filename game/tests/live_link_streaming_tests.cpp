@@ -0,0 +1,453 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "live_link/live_link_chunk_assembly.h"
+#include "live_link/live_link_framing.h"
+#include "live_link/live_link_mesh_decode.h"
+
+using namespace Blender::LiveLink;
+
+// Matches LIVE_LINK_CHUNK_BYTES in extension_main.py
+static constexpr size_t CHUNK_BYTES = 1024 * 1024;
+
+// Builds a size-prefixed Update with in_object_count float mesh objects.
+// Values derive from (unique_id, element) so every mesh hashes differently.
+DynamicArray<u8> build_mesh_update(i32 in_first_unique_id, i32 in_object_count, u32 in_vertex_count)
+{
+	flatbuffers::FlatBufferBuilder builder(in_object_count * in_vertex_count * 40 + 1024);
+	std::vector<flatbuffers::Offset<Object>> objects;
+	std::vector<f32> positions, normals, texcoords;
+	std::vector<u32> indices;
+	for (i32 object_idx = 0; object_idx < in_object_count; ++object_idx)
+	{
+		const i32 unique_id = in_first_unique_id + object_idx;
+		positions.clear();
+		normals.clear();
+		texcoords.clear();
+		indices.clear();
+		for (u32 vertex_idx = 0; vertex_idx < in_vertex_count; ++vertex_idx)
+		{
+			for (u32 axis = 0; axis < 3; ++axis)
+			{
+				positions.push_back((f32) unique_id * 10.0f + 0.001f * (f32) vertex_idx + (f32) axis);
+				normals.push_back(axis == 2 ? 1.0f : 0.0f);
+			}
+			texcoords.push_back(0.5f);
+			texcoords.push_back((f32) unique_id);
+		}
+		for (u32 index_idx = 0; index_idx < in_vertex_count / 2 * 3; ++index_idx)
+		{
+			indices.push_back((index_idx * 7 + (u32) unique_id) % in_vertex_count);
+		}
+
+		auto mesh = CreateMesh(
+			builder,
+			builder.CreateVector(positions),
+			builder.CreateVector(normals),
+			builder.CreateVector(texcoords),
+			builder.CreateVector(indices));
+		ObjectBuilder object(builder);
+		object.add_unique_id(unique_id);
+		const Vec3 location(0.0f, 0.0f, 0.0f);
+		const Vec3 scale(1.0f, 1.0f, 1.0f);
+		const Quat rotation(0.0f, 0.0f, 0.0f, 1.0f);
+		object.add_location(&location);
+		object.add_scale(&scale);
+		object.add_rotation(&rotation);
+		object.add_mesh(mesh);
+		objects.push_back(object.Finish());
+	}
+	auto objects_vector = builder.CreateVector(objects);
+	UpdateBuilder update(builder);
+	update.add_objects(objects_vector);
+	builder.FinishSizePrefixed(update.Finish());
+
+	DynamicArray<u8> bytes;
+	bytes.add_uninitialized(builder.GetSize());
+	memcpy(bytes.data(), builder.GetBufferPointer(), builder.GetSize());
+	return bytes;
+}
+
+DynamicArray<u8> build_transform_update(i32 in_unique_id)
+{
+	flatbuffers::FlatBufferBuilder builder;
+	const ObjectTransform transform(in_unique_id, Vec3(1.0f, 2.0f, 3.0f), Quat(0.0f, 0.0f, 0.0f, 1.0f), Vec3(1.0f, 1.0f, 1.0f));
+	auto transforms = builder.CreateVectorOfStructs(&transform, 1);
+	UpdateBuilder update(builder);
+	update.add_transforms(transforms);
+	builder.FinishSizePrefixed(update.Finish());
+
+	DynamicArray<u8> bytes;
+	bytes.add_uninitialized(builder.GetSize());
+	memcpy(bytes.data(), builder.GetBufferPointer(), builder.GetSize());
+	return bytes;
+}
+
+// One chunk frame of a transfer (mirrors make_chunk_frames in extension_main.py)
+DynamicArray<u8> build_chunk_frame(
+	u32 in_transfer_id, u32 in_chunk_index, u32 in_chunk_count,
+	u64 in_offset, u64 in_total_size, const u8* in_data, size_t in_size)
+{
+	flatbuffers::FlatBufferBuilder builder(in_size + 128);
+	auto data = builder.CreateVector(in_data, in_size);
+	PayloadChunkBuilder chunk(builder);
+	chunk.add_transfer_id(in_transfer_id);
+	chunk.add_chunk_index(in_chunk_index);
+	chunk.add_chunk_count(in_chunk_count);
+	chunk.add_offset(in_offset);
+	chunk.add_total_size(in_total_size);
+	chunk.add_data(data);
+	auto chunk_offset = chunk.Finish();
+	UpdateBuilder update(builder);
+	update.add_chunk(chunk_offset);
+	builder.FinishSizePrefixed(update.Finish());
+
+	DynamicArray<u8> bytes;
+	bytes.add_uninitialized(builder.GetSize());
+	memcpy(bytes.data(), builder.GetBufferPointer(), builder.GetSize());
+	return bytes;
+}
+
+// Splits a size-prefixed Update into in_chunk_bytes slices
+std::vector<DynamicArray<u8>> split_into_chunk_frames(const DynamicArray<u8>& in_update, u32 in_transfer_id, size_t in_chunk_bytes)
+{
+	const size_t total_size = in_update.length();
+	const u32 chunk_count = (u32) ((total_size + in_chunk_bytes - 1) / in_chunk_bytes);
+	std::vector<DynamicArray<u8>> frames;
+	for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		const size_t offset = (size_t) chunk_index * in_chunk_bytes;
+		const size_t size = MIN(in_chunk_bytes, total_size - offset);
+		frames.push_back(build_chunk_frame(in_transfer_id, chunk_index, chunk_count, offset, total_size, in_update.data() + offset, size));
+	}
+	return frames;
+}
+
+const PayloadChunk* chunk_of(const DynamicArray<u8>& in_frame)
+{
+	return GetSizePrefixedUpdate(in_frame.data())->chunk();
+}
+
+void test_out_of_order_round_trip()
+{
+	const DynamicArray<u8> update = build_mesh_update(1, 3, 5000);
+	std::vector<DynamicArray<u8>> frames = split_into_chunk_frames(update, 7, 4096);
+	assert(frames.size() > 8);
+
+	// Reverse order, with the original first chunk in the middle
+	std::swap(frames[0], frames[frames.size() / 2]);
+	LiveLinkChunkAssembler assembler;
+	LiveLinkRoutedUpdate routed;
+	for (size_t frame_idx = frames.size(); frame_idx-- > 1;)
+	{
+		assert(!live_link_route_frame(assembler, frames[frame_idx].data(), frames[frame_idx].length(), routed));
+		assert(assembler.buffered_byte_count == update.length());
+	}
+	assert(live_link_route_frame(assembler, frames[0].data(), frames[0].length(), routed));
+	assert(routed.size == update.length());
+	assert(routed.data == routed.assembled.data);
+	assert(routed.assembled.chunk_count == frames.size());
+	assert(memcmp(routed.data, update.data(), update.length()) == 0);
+	assert(GetSizePrefixedUpdate(routed.data)->objects()->size() == 3);
+	live_link_routed_update_release(routed);
+
+	assert(assembler.transfers.empty());
+	assert(assembler.buffered_byte_count == 0);
+	assert(assembler.peak_buffered_byte_count == update.length());
+	assert(assembler.completed_transfer_count == 1);
+}
+
+void test_plain_frames_pass_through_between_chunks()
+{
+	const DynamicArray<u8> first = build_mesh_update(10, 2, 3000);
+	const DynamicArray<u8> second = build_mesh_update(20, 1, 4000);
+	const DynamicArray<u8> transform = build_transform_update(10);
+	std::vector<DynamicArray<u8>> first_frames = split_into_chunk_frames(first, 1, 8192);
+	std::vector<DynamicArray<u8>> second_frames = split_into_chunk_frames(second, 2, 8192);
+
+	// Interleave both transfers with a plain transform update between them
+	LiveLinkChunkAssembler assembler;
+	LiveLinkRoutedUpdate routed;
+	i32 completed = 0;
+	const size_t frame_count = MAX(first_frames.size(), second_frames.size());
+	for (size_t frame_idx = 0; frame_idx < frame_count; ++frame_idx)
+	{
+		for (std::vector<DynamicArray<u8>>* frames : { &first_frames, &second_frames })
+		{
+			if (frame_idx >= frames->size())
+			{
+				continue;
+			}
+			const DynamicArray<u8>& frame = (*frames)[frame_idx];
+			if (live_link_route_frame(assembler, frame.data(), frame.length(), routed))
+			{
+				const DynamicArray<u8>& expected = frames == &first_frames ? first : second;
+				assert(routed.size == expected.length());
+				assert(memcmp(routed.data, expected.data(), expected.length()) == 0);
+				live_link_routed_update_release(routed);
+				++completed;
+			}
+		}
+		if (frame_idx == 1)
+		{
+			assert(assembler.transfers.size() == 2);
+			assert(live_link_route_frame(assembler, transform.data(), transform.length(), routed));
+			assert(routed.data == transform.data() && routed.assembled.data == nullptr);
+			assert(GetSizePrefixedUpdate(routed.data)->transforms()->size() == 1);
+			live_link_routed_update_release(routed);
+		}
+	}
+	assert(completed == 2);
+	assert(assembler.transfers.empty());
+	assert(assembler.peak_buffered_byte_count == first.length() + second.length());
+}
+
+void test_duplicate_and_malformed_chunks()
+{
+	const DynamicArray<u8> update = build_mesh_update(1, 1, 2000);
+	std::vector<DynamicArray<u8>> frames = split_into_chunk_frames(update, 3, 1000);
+	const u64 total_size = update.length();
+	LiveLinkChunkAssembler assembler;
+	LiveLinkAssembledUpdate assembled;
+
+	// A repeated chunk is ignored and does not count twice
+	assert(live_link_chunk_assembler_add(assembler, chunk_of(frames[0]), assembled) == ELiveLinkChunkStatus::Pending);
+	assert(live_link_chunk_assembler_add(assembler, chunk_of(frames[0]), assembled) == ELiveLinkChunkStatus::Duplicate);
+	assert(assembler.transfers.find(3)->second.received_chunk_count == 1);
+
+	// A chunk that disagrees with its transfer drops the transfer
+	const DynamicArray<u8> wrong_count = build_chunk_frame(3, 1, (u32) frames.size() + 1, 1000, total_size, update.data() + 1000, 1000);
+	assert(live_link_chunk_assembler_add(assembler, chunk_of(wrong_count), assembled) == ELiveLinkChunkStatus::Malformed);
+	assert(assembler.transfers.empty() && assembler.buffered_byte_count == 0);
+	assert(assembler.dropped_transfer_count == 1);
+
+	// Slices past the end, indices past the count and oversized transfers
+	const u8 bytes[16] = {};
+	const DynamicArray<u8> past_end = build_chunk_frame(4, 0, 2, total_size - 8, total_size, bytes, 16);
+	const DynamicArray<u8> bad_index = build_chunk_frame(4, 2, 2, 0, total_size, bytes, 16);
+	const DynamicArray<u8> oversized = build_chunk_frame(4, 0, 2, 0, 0x100000000ull, bytes, 16);
+	const DynamicArray<u8> empty_transfer = build_chunk_frame(4, 0, 1, 0, 0, bytes, 0);
+	for (const DynamicArray<u8>* frame : { &past_end, &bad_index, &oversized, &empty_transfer })
+	{
+		assert(live_link_chunk_assembler_add(assembler, chunk_of(*frame), assembled) == ELiveLinkChunkStatus::Malformed);
+		assert(assembler.transfers.empty());
+	}
+
+	// Every chunk index arrived but the slices overlap and leave a gap
+	std::vector<DynamicArray<u8>> overlapping;
+	const u32 chunk_count = (u32) frames.size();
+	for (u32 chunk_index = 0; chunk_index < chunk_count; ++chunk_index)
+	{
+		overlapping.push_back(build_chunk_frame(5, chunk_index, chunk_count, 0, total_size, update.data(), MIN((u64) 1000, total_size)));
+	}
+	for (u32 chunk_index = 0; chunk_index + 1 < chunk_count; ++chunk_index)
+	{
+		assert(live_link_chunk_assembler_add(assembler, chunk_of(overlapping[chunk_index]), assembled) == ELiveLinkChunkStatus::Pending);
+	}
+	assert(live_link_chunk_assembler_add(assembler, chunk_of(overlapping.back()), assembled) == ELiveLinkChunkStatus::Malformed);
+	assert(assembler.transfers.empty() && assembler.buffered_byte_count == 0);
+
+	// Reset frees transfers that never completed
+	assert(live_link_chunk_assembler_add(assembler, chunk_of(frames[1]), assembled) == ELiveLinkChunkStatus::Pending);
+	assert(assembler.buffered_byte_count == total_size);
+	live_link_chunk_assembler_reset(assembler);
+	assert(assembler.transfers.empty() && assembler.buffered_byte_count == 0);
+	assert(assembler.completed_transfer_count == 0);
+}
+
+// ---- Loopback harness ----
+// A sender thread writes a scene over a 127.0.0.1 TCP connection; the
+// receiver runs the live-link thread's loop (ring -> route -> decode) and
+// publishes each Update's meshes as soon as it completes. Peak receive
+// memory is the ring, incomplete transfers and the decode arena held at the
+// same time; decoded meshes themselves are excluded since the runtime keeps
+// them in both modes.
+
+struct LoopbackResult
+{
+	u64 sent_byte_count = 0;
+	u64 peak_receive_bytes = 0;
+	u64 bytes_before_first_object = 0;	// wire bytes consumed when the first object was published
+	f64 seconds_to_first_object = 0.0;
+	f64 seconds_to_last_object = 0.0;
+	i32 published_object_count = 0;
+	u64 ring_grow_count = 0;
+	std::vector<u64> content_hashes;	// by unique_id - 1
+};
+
+LoopbackResult run_loopback(const std::vector<DynamicArray<u8>>& in_frames, i32 in_object_count, WorkerPool& in_workers)
+{
+	const int listener = socket(AF_INET, SOCK_STREAM, 0);
+	assert(listener >= 0);
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	assert(bind(listener, (sockaddr*) &address, sizeof(address)) == 0);
+	assert(listen(listener, 1) == 0);
+	socklen_t address_size = sizeof(address);
+	assert(getsockname(listener, (sockaddr*) &address, &address_size) == 0);
+
+	LoopbackResult result;
+	result.content_hashes.resize(in_object_count, 0);
+	for (const DynamicArray<u8>& frame : in_frames)
+	{
+		result.sent_byte_count += frame.length();
+	}
+
+	const auto start_time = std::chrono::steady_clock::now();
+	std::thread sender([&]() {
+		const int sender_socket = socket(AF_INET, SOCK_STREAM, 0);
+		assert(connect(sender_socket, (const sockaddr*) &address, sizeof(address)) == 0);
+		for (const DynamicArray<u8>& frame : in_frames)
+		{
+			const u8* data = frame.data();
+			size_t remaining = frame.length();
+			while (remaining > 0)
+			{
+				const ssize_t sent = send(sender_socket, data, remaining, 0);
+				assert(sent > 0);
+				data += sent;
+				remaining -= (size_t) sent;
+			}
+		}
+		close(sender_socket);
+	});
+
+	const int receiver = accept(listener, nullptr, nullptr);
+	assert(receiver >= 0);
+
+	LiveLinkReceiveRing ring;
+	ring.init();
+	LiveLinkChunkAssembler assembler;
+	LiveLinkMeshDecodeStage stage;
+	u64 consumed_byte_count = 0;
+	bool closed = false;
+	while (!closed)
+	{
+		const ELiveLinkReceiveStatus status = ring.receive(receiver);
+		closed = status == ELiveLinkReceiveStatus::Closed;
+		assert(closed || status == ELiveLinkReceiveStatus::Data);
+
+		LiveLinkFrame frame;
+		while (ring.next_frame(frame))
+		{
+			consumed_byte_count += frame.size;
+			LiveLinkRoutedUpdate routed;
+			const bool has_update = live_link_route_frame(assembler, frame.data, frame.size, routed);
+			result.peak_receive_bytes = MAX(result.peak_receive_bytes, ring.capacity() + assembler.buffered_byte_count + routed.assembled.size);
+			if (!has_update)
+			{
+				continue;
+			}
+
+			auto objects = GetSizePrefixedUpdate(routed.data)->objects();
+			assert(objects);
+			stage.clear();
+			for (u32 object_idx = 0; object_idx < objects->size(); ++object_idx)
+			{
+				const Object* object = objects->Get(object_idx);
+				assert(live_link_mesh_decode_plan(stage, object->mesh(), object->unique_id(), (u32) object->unique_id() - 1));
+			}
+			result.peak_receive_bytes = MAX(result.peak_receive_bytes, ring.capacity() + assembler.buffered_byte_count + routed.assembled.size + stage.arena_size);
+			SharedArena* arena = live_link_mesh_decode_run(stage, in_workers, [&](const LiveLinkMeshDecodeJob& in_job, const LiveLinkDecodedMesh& in_mesh) {
+				result.content_hashes[in_job.output_index] = in_mesh.content_hash;
+			});
+			shared_arena_release(arena);
+
+			const f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start_time).count();
+			if (result.published_object_count == 0)
+			{
+				result.bytes_before_first_object = consumed_byte_count;
+				result.seconds_to_first_object = seconds;
+			}
+			result.seconds_to_last_object = seconds;
+			result.published_object_count += (i32) objects->size();
+			live_link_routed_update_release(routed);
+		}
+	}
+
+	sender.join();
+	close(receiver);
+	close(listener);
+	assert(consumed_byte_count == result.sent_byte_count);
+	assert(assembler.transfers.empty());
+	result.ring_grow_count = ring.grow_count;
+	return result;
+}
+
+void print_loopback_result(const char* in_label, const LoopbackResult& in_result)
+{
+	printf("%-11s sent %6.1f MB  peak receive %6.1f MB  first object after %6.1f MB / %7.3f s  last object %7.3f s\n",
+		in_label,
+		(f64) in_result.sent_byte_count / (1024.0 * 1024.0),
+		(f64) in_result.peak_receive_bytes / (1024.0 * 1024.0),
+		(f64) in_result.bytes_before_first_object / (1024.0 * 1024.0),
+		in_result.seconds_to_first_object,
+		in_result.seconds_to_last_object);
+}
+
+void test_loopback_streaming_lowers_peak_and_first_object_latency()
+{
+	const i32 object_count = 16;
+	const i32 objects_per_part = 2;
+	const u32 vertex_count = 48 * 1024;
+
+	// One monolithic Update vs. the add-on's streamed parts, each chunked
+	std::vector<DynamicArray<u8>> monolithic_frames;
+	monolithic_frames.push_back(build_mesh_update(1, object_count, vertex_count));
+	std::vector<DynamicArray<u8>> streamed_frames;
+	for (i32 part_idx = 0; part_idx < object_count / objects_per_part; ++part_idx)
+	{
+		const DynamicArray<u8> part = build_mesh_update(1 + part_idx * objects_per_part, objects_per_part, vertex_count);
+		for (DynamicArray<u8>& frame : split_into_chunk_frames(part, (u32) part_idx + 1, CHUNK_BYTES))
+		{
+			streamed_frames.push_back(std::move(frame));
+		}
+	}
+
+	WorkerPool workers;
+	workers.start(2);
+	const LoopbackResult monolithic = run_loopback(monolithic_frames, object_count, workers);
+	const LoopbackResult streamed = run_loopback(streamed_frames, object_count, workers);
+	print_loopback_result("monolithic", monolithic);
+	print_loopback_result("streamed", streamed);
+
+	// Same objects, same decoded content
+	assert(monolithic.published_object_count == object_count);
+	assert(streamed.published_object_count == object_count);
+	for (i32 object_idx = 0; object_idx < object_count; ++object_idx)
+	{
+		assert(monolithic.content_hashes[object_idx] != 0);
+		assert(streamed.content_hashes[object_idx] == monolithic.content_hashes[object_idx]);
+	}
+
+	// A monolithic Update publishes nothing before its last byte and holds
+	// the wire copy and the decoded copy of the whole scene together
+	assert(monolithic.bytes_before_first_object == monolithic.sent_byte_count);
+	assert(monolithic.peak_receive_bytes > monolithic.sent_byte_count * 3 / 2);
+
+	// Streamed: the first part is visible after ~1/8 of the bytes, the ring
+	// never outgrows its initial chunk-sized allocation, and peak receive
+	// memory is a fraction of the monolithic one
+	assert(streamed.bytes_before_first_object * 4 < streamed.sent_byte_count);
+	assert(streamed.ring_grow_count == 1);
+	assert(streamed.peak_receive_bytes * 3 < monolithic.peak_receive_bytes);
+}
+
+int main()
+{
+	test_out_of_order_round_trip();
+	test_plain_frames_pass_through_between_chunks();
+	test_duplicate_and_malformed_chunks();
+	test_loopback_streaming_lowers_peak_and_first_object_latency();
+	printf("live link streaming tests passed\n");
+	return 0;
+}
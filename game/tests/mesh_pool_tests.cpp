@@ -0,0 +1,377 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "render/mesh_pool.h"
+#include "test_random.h"
+
+// A mesh's source streams; the bytes are derived from the stream id so any
+// misplaced copy shows up as a mismatch
+struct MeshFixture
+{
+	u64 stream_id = 0;
+	MeshPoolBatch batch = MeshPoolBatch::Static;
+	DynamicArray<u8> vertex_bytes;
+	DynamicArray<u8> index_bytes;
+};
+
+static void fill_bytes(DynamicArray<u8>& out_bytes, u64 in_count, u64 in_seed)
+{
+	out_bytes.resize(in_count);
+	for (u64 byte_idx = 0; byte_idx < in_count; ++byte_idx)
+	{
+		out_bytes[byte_idx] = (u8) ((in_seed * 0x9E3779B1u + byte_idx * 31u) >> 3);
+	}
+}
+
+static MeshFixture make_mesh(Random& in_random, u64 in_stream_id, u32 in_max_vertices)
+{
+	MeshFixture out_mesh;
+	out_mesh.stream_id = in_stream_id;
+	out_mesh.batch = (MeshPoolBatch) (in_random.next() % MESH_POOL_BATCH_COUNT);
+	const u32 vertex_count = 3 + in_random.next() % in_max_vertices;
+	const u32 index_count = 3 * (1 + in_random.next() % (vertex_count * 2));
+	const u32 vertex_stride = MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_vertex_stream(out_mesh.batch)];
+	const u32 index_stride = MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_index_stream(out_mesh.batch)];
+	fill_bytes(out_mesh.vertex_bytes, (u64) vertex_count * vertex_stride, in_stream_id * 2);
+	fill_bytes(out_mesh.index_bytes, (u64) index_count * index_stride, in_stream_id * 2 + 1);
+	return out_mesh;
+}
+
+static u32 vertex_count(const MeshFixture& in_mesh)
+{
+	return (u32) (in_mesh.vertex_bytes.length() / MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_vertex_stream(in_mesh.batch)]);
+}
+
+static u32 index_count(const MeshFixture& in_mesh)
+{
+	return (u32) (in_mesh.index_bytes.length() / MESH_POOL_STREAM_STRIDES[(u32) mesh_pool_batch_index_stream(in_mesh.batch)]);
+}
+
+// Stands in for the four GPU pool buffers
+struct PoolBuffers
+{
+	DynamicArray<u8> streams[MESH_POOL_STREAM_COUNT];
+	u32 relocations = 0;
+};
+
+// What IndirectDraw::prepare does with a relocation: new buffer, live runs
+// copied from the old one
+static void apply_relocation(PoolBuffers& in_out_buffers, const MeshPoolRelocation& in_relocation)
+{
+	for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+	{
+		if (!in_relocation.relocated[stream_idx])
+		{
+			continue;
+		}
+		const u64 stride = MESH_POOL_STREAM_STRIDES[stream_idx];
+		DynamicArray<u8> new_stream;
+		new_stream.resize(in_relocation.new_capacity[stream_idx] * stride);
+		memset(new_stream.data(), 0xCD, new_stream.length());
+		for (const MeshPoolMove& move : in_relocation.moves[stream_idx])
+		{
+			assert((move.src_first + move.count) * stride <= in_out_buffers.streams[stream_idx].length());
+			memcpy(new_stream.data() + move.dst_first * stride, in_out_buffers.streams[stream_idx].data() + move.src_first * stride, move.count * stride);
+		}
+		in_out_buffers.streams[stream_idx] = std::move(new_stream);
+		in_out_buffers.relocations += 1;
+	}
+}
+
+// One frame: touch the drawn meshes, evict stale ones, reserve room for the
+// misses, add and "upload" them. Returns each drawn mesh's entry index.
+static void run_frame(
+	MeshPool& in_out_pool,
+	PoolBuffers& in_out_buffers,
+	const DynamicArray<MeshFixture>& in_meshes,
+	const DynamicArray<u32>& in_drawn,
+	u64 in_frame,
+	u64 in_unused_frames,
+	DynamicArray<u32>& out_entries)
+{
+	DynamicArray<u32> misses;
+	for (u32 mesh_idx : in_drawn)
+	{
+		if (mesh_pool_find(in_out_pool, in_meshes[mesh_idx].stream_id, in_frame) < 0)
+		{
+			misses.add(mesh_idx);
+		}
+	}
+	mesh_pool_evict(in_out_pool, in_frame, in_unused_frames);
+
+	u32 extra[MESH_POOL_STREAM_COUNT] = {};
+	for (u32 mesh_idx : misses)
+	{
+		mesh_pool_add_stream_counts(in_meshes[mesh_idx].batch, vertex_count(in_meshes[mesh_idx]), index_count(in_meshes[mesh_idx]), extra);
+	}
+	MeshPoolRelocation relocation;
+	if (mesh_pool_reserve(in_out_pool, extra, relocation))
+	{
+		apply_relocation(in_out_buffers, relocation);
+	}
+
+	for (u32 mesh_idx : misses)
+	{
+		const MeshFixture& mesh = in_meshes[mesh_idx];
+		const u32 entry_idx = mesh_pool_add(in_out_pool, mesh.stream_id, mesh.batch, vertex_count(mesh), index_count(mesh), in_frame);
+		const MeshPoolEntry& entry = in_out_pool.entries[entry_idx];
+		const u32 vertex_stream = (u32) mesh_pool_batch_vertex_stream(mesh.batch);
+		const u32 index_stream = (u32) mesh_pool_batch_index_stream(mesh.batch);
+		memcpy(in_out_buffers.streams[vertex_stream].data() + (u64) entry.vertex_first * MESH_POOL_STREAM_STRIDES[vertex_stream],
+			mesh.vertex_bytes.data(), mesh.vertex_bytes.length());
+		memcpy(in_out_buffers.streams[index_stream].data() + (u64) entry.index_first * MESH_POOL_STREAM_STRIDES[index_stream],
+			mesh.index_bytes.data(), mesh.index_bytes.length());
+	}
+
+	out_entries.clear();
+	for (u32 mesh_idx : in_drawn)
+	{
+		const i32 entry_idx = mesh_pool_find(in_out_pool, in_meshes[mesh_idx].stream_id, in_frame);
+		assert(entry_idx >= 0);
+		out_entries.add((u32) entry_idx);
+	}
+}
+
+// Every resident entry's ranges hold its mesh's bytes and fit the streams
+static void check_pool(const MeshPool& in_pool, const PoolBuffers& in_buffers, const DynamicArray<MeshFixture>& in_meshes)
+{
+	assert(in_pool.entries.length() == in_pool.entry_of_stream.size());
+	u64 live[MESH_POOL_STREAM_COUNT] = {};
+	for (u32 entry_idx = 0; entry_idx < in_pool.entries.length(); ++entry_idx)
+	{
+		const MeshPoolEntry& entry = in_pool.entries[entry_idx];
+		assert(in_pool.entry_of_stream.at(entry.stream_id) == entry_idx);
+		const MeshFixture& mesh = in_meshes[entry.stream_id - 1];
+		assert(entry.batch == mesh.batch);
+		assert(entry.vertex_count == vertex_count(mesh) && entry.index_count == index_count(mesh));
+
+		const u32 vertex_stream = (u32) mesh_pool_batch_vertex_stream(entry.batch);
+		const u32 index_stream = (u32) mesh_pool_batch_index_stream(entry.batch);
+		assert(entry.vertex_first + entry.vertex_count <= in_pool.streams[vertex_stream].used);
+		assert(entry.index_first + entry.index_count <= in_pool.streams[index_stream].used);
+		assert(memcmp(in_buffers.streams[vertex_stream].data() + (u64) entry.vertex_first * MESH_POOL_STREAM_STRIDES[vertex_stream],
+			mesh.vertex_bytes.data(), mesh.vertex_bytes.length()) == 0);
+		assert(memcmp(in_buffers.streams[index_stream].data() + (u64) entry.index_first * MESH_POOL_STREAM_STRIDES[index_stream],
+			mesh.index_bytes.data(), mesh.index_bytes.length()) == 0);
+		live[vertex_stream] += entry.vertex_count;
+		live[index_stream] += entry.index_count;
+	}
+	for (u32 stream_idx = 0; stream_idx < MESH_POOL_STREAM_COUNT; ++stream_idx)
+	{
+		const MeshPoolStreamState& stream = in_pool.streams[stream_idx];
+		assert(stream.live == live[stream_idx]);
+		assert(stream.live <= stream.used && stream.used <= stream.capacity);
+		assert((u64) stream.capacity * MESH_POOL_STREAM_STRIDES[stream_idx] == in_buffers.streams[stream_idx].length());
+	}
+}
+
+// Streaming workload: the drawn set drifts, so entries age out, ranges leak
+// until a stream fills, and relocation packs and grows the streams
+static void test_uploads_survive_eviction_and_relocation()
+{
+	Random random;
+	DynamicArray<MeshFixture> meshes;
+	for (u64 stream_id = 1; stream_id <= 600; ++stream_id)
+	{
+		meshes.add(make_mesh(random, stream_id, 1500));
+	}
+
+	MeshPool pool;
+	PoolBuffers buffers;
+	DynamicArray<u32> drawn;
+	DynamicArray<u32> entries;
+	u32 window_first = 0;
+	for (u64 frame = 1; frame <= 400; ++frame)
+	{
+		if (frame % 4 == 0)
+		{
+			window_first = (window_first + 7) % (u32) meshes.length();
+		}
+		drawn.clear();
+		for (u32 offset = 0; offset < 80; ++offset)
+		{
+			if (random.chance(85))
+			{
+				drawn.add((window_first + offset) % (u32) meshes.length());
+			}
+		}
+		run_frame(pool, buffers, meshes, drawn, frame, 3, entries);
+		check_pool(pool, buffers, meshes);
+		for (u32 drawn_idx = 0; drawn_idx < drawn.length(); ++drawn_idx)
+		{
+			assert(pool.entries[entries[drawn_idx]].stream_id == meshes[drawn[drawn_idx]].stream_id);
+		}
+	}
+	assert(pool.counters.entries_evicted > 0);
+	assert(buffers.relocations > MESH_POOL_STREAM_COUNT);
+	printf("mesh pool: %llu added, %llu evicted, %llu relocations, %llu elements moved\n",
+		(unsigned long long) pool.counters.entries_added,
+		(unsigned long long) pool.counters.entries_evicted,
+		(unsigned long long) pool.counters.relocations,
+		(unsigned long long) pool.counters.elements_moved);
+}
+
+static void test_reserve_packs_before_growing()
+{
+	MeshPool pool;
+	u32 extra[MESH_POOL_STREAM_COUNT] = {};
+	extra[(u32) MeshPoolStream::Vertices] = 40000;
+	extra[(u32) MeshPoolStream::Indices32] = 40000;
+	MeshPoolRelocation relocation;
+	assert(mesh_pool_reserve(pool, extra, relocation));
+	assert(relocation.new_capacity[(u32) MeshPoolStream::Vertices] == MESH_POOL_MIN_CAPACITY);
+	assert(!relocation.relocated[(u32) MeshPoolStream::Indices16]);
+	mesh_pool_add(pool, 1, MeshPoolBatch::Static, 20000, 20000, 1);
+	mesh_pool_add(pool, 2, MeshPoolBatch::Static, 20000, 20000, 5);
+
+	// Nothing to do while the bump cursor has room
+	extra[(u32) MeshPoolStream::Vertices] = 20000;
+	extra[(u32) MeshPoolStream::Indices32] = 0;
+	assert(!mesh_pool_reserve(pool, extra, relocation));
+
+	// Entry 1 ages out; packing alone makes room, so capacity stays put
+	assert(mesh_pool_evict(pool, 5, 3) == 1);
+	extra[(u32) MeshPoolStream::Vertices] = 40000;
+	assert(mesh_pool_reserve(pool, extra, relocation));
+	assert(relocation.relocated[(u32) MeshPoolStream::Vertices] && !relocation.relocated[(u32) MeshPoolStream::Indices32]);
+	assert(relocation.new_capacity[(u32) MeshPoolStream::Vertices] == MESH_POOL_MIN_CAPACITY);
+	assert(relocation.moves[(u32) MeshPoolStream::Vertices].length() == 1);
+	const MeshPoolMove move = relocation.moves[(u32) MeshPoolStream::Vertices][0];
+	assert(move.src_first == 20000 && move.dst_first == 0 && move.count == 20000);
+	assert(pool.entries[0].vertex_first == 0 && pool.entries[0].index_first == 20000);
+	assert(pool.streams[(u32) MeshPoolStream::Vertices].used == 20000);
+
+	// Past capacity even when packed: grows by half
+	extra[(u32) MeshPoolStream::Vertices] = 50000;
+	assert(mesh_pool_reserve(pool, extra, relocation));
+	assert(relocation.new_capacity[(u32) MeshPoolStream::Vertices] == MESH_POOL_MIN_CAPACITY + MESH_POOL_MIN_CAPACITY / 2);
+}
+
+static void test_commands_group_by_batch()
+{
+	MeshPool pool;
+	u32 extra[MESH_POOL_STREAM_COUNT] = { 1000, 1000, 1000, 1000 };
+	MeshPoolRelocation relocation;
+	mesh_pool_reserve(pool, extra, relocation);
+	const MeshPoolBatch batches[] = {
+		MeshPoolBatch::Compact16, MeshPoolBatch::Static, MeshPoolBatch::Compact,
+		MeshPoolBatch::Static, MeshPoolBatch::Compact16, MeshPoolBatch::Static,
+	};
+	DynamicArray<u32> record_entries;
+	for (u32 mesh_idx = 0; mesh_idx < 6; ++mesh_idx)
+	{
+		record_entries.add(mesh_pool_add(pool, mesh_idx + 1, batches[mesh_idx], 10 + mesh_idx, 30 + 3 * mesh_idx, 1));
+	}
+
+	const u32 records[] = { 5, 0, 1, 4, 2 };	// record 3 culled
+	MeshPoolCommandScratch scratch;
+	DynamicArray<DrawIndexedCommand> commands;
+	DynamicArray<u32> instances;
+	MeshPoolBatchRange ranges[MESH_POOL_BATCH_COUNT];
+	u32 slots[5];
+	mesh_pool_build_commands(pool, record_entries.data(), records, 5, false, 100, scratch, commands, instances, ranges, slots);
+
+	assert(commands.length() == 5 && instances.length() == 5);
+	assert(ranges[(u32) MeshPoolBatch::Static].first == 0 && ranges[(u32) MeshPoolBatch::Static].count == 2);
+	assert(ranges[(u32) MeshPoolBatch::Compact].first == 2 && ranges[(u32) MeshPoolBatch::Compact].count == 1);
+	assert(ranges[(u32) MeshPoolBatch::Compact16].first == 3 && ranges[(u32) MeshPoolBatch::Compact16].count == 2);
+
+	// Input order is kept within a batch
+	const u32 expected_records[] = { 5, 1, 2, 0, 4 };
+	for (u32 slot = 0; slot < 5; ++slot)
+	{
+		const DrawIndexedCommand& command = commands[slot];
+		assert(command.first_instance == 100 + slot);
+		const u32 record = instances[command.first_instance - 100];
+		const MeshPoolEntry& entry = pool.entries[record_entries[record]];
+		assert(record == expected_records[slot]);
+		assert(command.instance_count == 1);
+		assert(command.index_count == entry.index_count && command.first_index == entry.index_first);
+		assert(command.vertex_offset == (i32) entry.vertex_first);
+	}
+	for (u32 input_idx = 0; input_idx < 5; ++input_idx)
+	{
+		assert(instances[commands[slots[input_idx]].first_instance - 100] == records[input_idx]);
+	}
+
+	// Static entries share one vertex stream, so their ranges must not overlap
+	assert(pool.entries[record_entries[1]].vertex_first + pool.entries[record_entries[1]].vertex_count
+		<= pool.entries[record_entries[3]].vertex_first);
+}
+
+// Records whose entries match (linked duplicates) draw as one instanced
+// command; every record still appears exactly once among the instances
+static void test_commands_instance_shared_entries()
+{
+	MeshPool pool;
+	u32 extra[MESH_POOL_STREAM_COUNT] = { 1000, 1000, 1000, 1000 };
+	MeshPoolRelocation relocation;
+	mesh_pool_reserve(pool, extra, relocation);
+	const u32 rock = mesh_pool_add(pool, 1, MeshPoolBatch::Compact, 24, 36, 1);
+	const u32 tree = mesh_pool_add(pool, 2, MeshPoolBatch::Static, 100, 300, 1);
+	const u32 leaf = mesh_pool_add(pool, 3, MeshPoolBatch::Compact, 4, 6, 1);
+
+	// Records 0..9; record 7 is culled
+	const u32 record_entries[] = { rock, tree, rock, leaf, rock, tree, leaf, rock, leaf, leaf };
+	const u32 records[] = { 0, 1, 2, 3, 4, 5, 6, 8, 9 };
+	MeshPoolCommandScratch scratch;
+	DynamicArray<DrawIndexedCommand> commands;
+	DynamicArray<u32> instances;
+	MeshPoolBatchRange ranges[MESH_POOL_BATCH_COUNT];
+	u32 slots[9];
+	mesh_pool_build_commands(pool, record_entries, records, 9, true, 40, scratch, commands, instances, ranges, slots);
+
+	assert(commands.length() == 3 && instances.length() == 9);
+	assert(ranges[(u32) MeshPoolBatch::Static].first == 0 && ranges[(u32) MeshPoolBatch::Static].count == 1);
+	assert(ranges[(u32) MeshPoolBatch::Compact].first == 1 && ranges[(u32) MeshPoolBatch::Compact].count == 2);
+	assert(ranges[(u32) MeshPoolBatch::Compact16].count == 0);
+
+	// tree (2), then rock (3) and leaf (4) in first-seen order
+	const u32 expected_entries[] = { tree, rock, leaf };
+	const u32 expected_counts[] = { 2, 3, 4 };
+	u32 instance_first = 40;
+	for (u32 slot = 0; slot < 3; ++slot)
+	{
+		const DrawIndexedCommand& command = commands[slot];
+		const MeshPoolEntry& entry = pool.entries[expected_entries[slot]];
+		assert(command.first_instance == instance_first && command.instance_count == expected_counts[slot]);
+		assert(command.index_count == entry.index_count && command.first_index == entry.index_first);
+		assert(command.vertex_offset == (i32) entry.vertex_first);
+		for (u32 instance = 0; instance < command.instance_count; ++instance)
+		{
+			assert(record_entries[instances[command.first_instance - 40 + instance]] == expected_entries[slot]);
+		}
+		instance_first += command.instance_count;
+	}
+	const u32 expected_instances[] = { 1, 5, 0, 2, 4, 3, 6, 8, 9 };
+	for (u32 instance = 0; instance < 9; ++instance)
+	{
+		assert(instances[instance] == expected_instances[instance]);
+	}
+	for (u32 input_idx = 0; input_idx < 9; ++input_idx)
+	{
+		assert(record_entries[records[input_idx]] == expected_entries[slots[input_idx]]);
+	}
+
+	// The scratch is reset: a second build with instancing off is unaffected
+	mesh_pool_build_commands(pool, record_entries, records, 9, false, 0, scratch, commands, instances, ranges, slots);
+	assert(commands.length() == 9);
+	for (const DrawIndexedCommand& command : commands)
+	{
+		assert(command.instance_count == 1);
+	}
+	mesh_pool_build_commands(pool, record_entries, records, 3, true, 0, scratch, commands, instances, ranges);
+	assert(commands.length() == 2 && commands[0].instance_count == 1 && commands[1].instance_count == 2);
+}
+
+int main()
+{
+	test_reserve_packs_before_growing();
+	test_commands_group_by_batch();
+	test_commands_instance_shared_entries();
+	test_uploads_survive_eviction_and_relocation();
+
+	printf("mesh_pool_tests passed\n");
+	return 0;
+}
@@ -19,6 +19,129 @@ struct TestComputePushConstants
 
 static_assert(TypedComputeEffect<TestComputePushConstants>::PUSH_CONSTANT_SIZE == 8);
 
+static void test_render_graph_lifetimes()
+{
+	// 0: written then read twice; 1: written, read once; 2: read first
+	// (history); 3: never touched
+	const RenderGraphNodeDecl nodes[] = {
+		{ .label = "A", .writes = render_graph_bit(0) },
+		{ .label = "B", .reads = render_graph_bit(0), .writes = render_graph_bit(1) },
+		{ .label = "C", .reads = render_graph_bit(0) | render_graph_bit(1) | render_graph_bit(2) },
+		{ .label = "D", .writes = render_graph_bit(2) },
+	};
+	RenderGraphLifetime lifetimes[4];
+	render_graph_compute_lifetimes(nodes, 4, lifetimes, 4);
+	assert(lifetimes[0].first_node == 0 && lifetimes[0].last_node == 2);
+	assert(!lifetimes[0].read_before_write);
+	assert(lifetimes[1].first_node == 1 && lifetimes[1].last_node == 2);
+	assert(lifetimes[2].first_node == 2 && lifetimes[2].last_node == 3);
+	assert(lifetimes[2].read_before_write);
+	assert(!lifetimes[3].used());
+	assert(lifetimes[0].overlaps(lifetimes[1]));
+	assert(lifetimes[1].overlaps(lifetimes[2]));
+	assert(!lifetimes[0].overlaps(lifetimes[3]));
+
+	// A node that blends onto its own target reads it first
+	const RenderGraphNodeDecl blend = {
+		.reads = render_graph_bit(0), .writes = render_graph_bit(0) };
+	render_graph_compute_lifetimes(&blend, 1, lifetimes, 1);
+	assert(lifetimes[0].read_before_write);
+}
+
+static void test_render_graph_aliasing()
+{
+	// 0 lives over nodes 0-2, 1 over 1-3, 2 over 3-4: 2 can reuse 0's memory,
+	// 1 needs its own range next to both
+	const RenderGraphNodeDecl nodes[] = {
+		{ .writes = render_graph_bit(0) },
+		{ .reads = render_graph_bit(0), .writes = render_graph_bit(1) },
+		{ .reads = render_graph_bit(0) },
+		{ .reads = render_graph_bit(1), .writes = render_graph_bit(2) },
+		{ .reads = render_graph_bit(2) },
+	};
+	RenderGraphLifetime lifetimes[3];
+	render_graph_compute_lifetimes(nodes, 5, lifetimes, 3);
+	const RenderGraphMemoryRequest requests[] = {
+		{ .size = 100, .alignment = 16, .memory_type_bits = 0b11 },
+		{ .size = 50, .alignment = 16, .memory_type_bits = 0b10 },
+		{ .size = 80, .alignment = 16, .memory_type_bits = 0b11 },
+	};
+	RenderGraphAliasPlan plan;
+	render_graph_plan_aliasing(requests, lifetimes, 3, plan);
+	assert(plan.heaps.length() == 1);
+	assert(plan.heaps[0].memory_type_bits == 0b10);
+	assert(plan.placements[0].heap == 0 && plan.placements[0].offset == 0);
+	assert(plan.placements[2].heap == 0 && plan.placements[2].offset == 0);
+	assert(plan.placements[1].heap == 0 && plan.placements[1].offset == 112);
+	assert(plan.heaps[0].size == 162);
+	assert(plan.requested_bytes == 230 && plan.heap_bytes == 162);
+	assert(plan.saved_bytes() == 68);
+	assert(plan.aliases[0] == render_graph_bit(2));
+	assert(plan.aliases[2] == render_graph_bit(0));
+	assert(plan.aliases[1] == 0);
+
+	// Placed resources that share a heap never overlap in both time and memory
+	for (i32 a = 0; a < 3; ++a)
+	{
+		for (i32 b = a + 1; b < 3; ++b)
+		{
+			const bool memory_overlaps =
+				plan.placements[a].offset < plan.placements[b].offset + requests[b].size
+				&& plan.placements[b].offset < plan.placements[a].offset + requests[a].size;
+			assert(!(memory_overlaps && lifetimes[a].overlaps(lifetimes[b])));
+		}
+		assert(plan.placements[a].offset % requests[a].alignment == 0);
+	}
+}
+
+static void test_render_graph_aliasing_exclusions()
+{
+	// 0 and 1 are disjoint but need different memory types; 2 is read before it
+	// is written; 3 is persistent (no request); 4 is never scheduled
+	const RenderGraphNodeDecl nodes[] = {
+		{ .writes = render_graph_bit(0) | render_graph_bit(3) },
+		{ .reads = render_graph_bit(0) | render_graph_bit(2) },
+		{ .writes = render_graph_bit(1) | render_graph_bit(2) },
+		{ .reads = render_graph_bit(1) | render_graph_bit(3) },
+	};
+	RenderGraphLifetime lifetimes[5];
+	render_graph_compute_lifetimes(nodes, 4, lifetimes, 5);
+	const RenderGraphMemoryRequest requests[] = {
+		{ .size = 64, .alignment = 64, .memory_type_bits = 0b01 },
+		{ .size = 64, .alignment = 64, .memory_type_bits = 0b10 },
+		{ .size = 64, .alignment = 64, .memory_type_bits = 0b11 },
+		{},
+		{ .size = 64, .alignment = 64, .memory_type_bits = 0b11 },
+	};
+	RenderGraphAliasPlan plan;
+	render_graph_plan_aliasing(requests, lifetimes, 5, plan);
+	assert(plan.heaps.length() == 2);
+	assert(plan.placements[0].heap != plan.placements[1].heap);
+	assert(plan.placements[2].heap == -1);
+	assert(plan.placements[3].heap == -1);
+	assert(plan.placements[4].heap == -1);
+	assert(plan.aliases[0] == 0 && plan.aliases[1] == 0);
+	assert(plan.saved_bytes() == 0);
+
+	// A chain of same-sized, back-to-back transients collapses into one slot
+	RenderGraphNodeDecl chain[8];
+	RenderGraphMemoryRequest chain_requests[8];
+	for (i32 node = 0; node < 8; ++node)
+	{
+		chain[node] = {
+			.reads = node > 0 ? render_graph_bit(node - 1) : 0,
+			.writes = render_graph_bit(node),
+		};
+		chain_requests[node] = { .size = 4096, .alignment = 256 };
+	}
+	RenderGraphLifetime chain_lifetimes[8];
+	render_graph_compute_lifetimes(chain, 8, chain_lifetimes, 8);
+	render_graph_plan_aliasing(chain_requests, chain_lifetimes, 8, plan);
+	assert(plan.heaps.length() == 1);
+	assert(plan.heap_bytes == 2 * 4096);	// each node reads the previous one
+	assert(plan.saved_bytes() == 6 * 4096);
+}
+
 int main()
 {
 	const RenderTargetExtent fixed = render_target_extent_fixed(512, 256);
@@ -77,5 +200,9 @@ int main()
 	assert(writer.writes[1].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 	assert(writer.buffer_infos[0].range == 64);
 	assert(!writer.allow_cache);
+
+	test_render_graph_lifetimes();
+	test_render_graph_aliasing();
+	test_render_graph_aliasing_exclusions();
 	return 0;
 }
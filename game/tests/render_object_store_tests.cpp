@@ -0,0 +1,188 @@
+#include <cassert>
+#include <cstdio>
+
+#include "scene/render_object_store.h"
+
+static HMM_Mat4 translation(f32 in_x)
+{
+	return HMM_Translate(HMM_V3(in_x, 0.0f, 0.0f));
+}
+
+static BoundingBox bounds_at(f32 in_x)
+{
+	return { .min = HMM_V3(in_x - 1.0f, -1.0f, -1.0f), .max = HMM_V3(in_x + 1.0f, 1.0f, 1.0f) };
+}
+
+// Writes every dirty slot from in_positions (indexed by unique id) and
+// returns how many rows would be uploaded, like build_render_object_snapshot
+static i32 flush(RenderObjectStore& in_store, const DynamicArray<f32>& in_positions, DynamicArray<RenderObjectStoreRange>& out_ranges)
+{
+	DynamicArray<i32> dirty_slots;
+	DynamicArray<i32> upload_slots;
+	render_object_store_take_dirty(in_store, dirty_slots);
+	for (i32 slot : dirty_slots)
+	{
+		const f32 x = in_positions[in_store.slot_object_ids[slot]];
+		if (render_object_store_write(in_store, slot, translation(x), HMM_M4D(1.0f), 0, bounds_at(x), false))
+		{
+			upload_slots.add(slot);
+		}
+	}
+	render_object_store_build_ranges(upload_slots, out_ranges);
+	return (i32) upload_slots.length();
+}
+
+void test_slots_are_stable_and_reused()
+{
+	RenderObjectStore store;
+	const i32 slot_a = render_object_store_acquire(store, 10);
+	const i32 slot_b = render_object_store_acquire(store, 20);
+	const i32 slot_c = render_object_store_acquire(store, 30);
+	assert(slot_a == 0 && slot_b == 1 && slot_c == 2);
+	assert(render_object_store_acquire(store, 20) == slot_b);	// replace keeps the slot
+	assert(store.dirty_count == 3);
+
+	render_object_store_release(store, 20);
+	assert(store.dirty_count == 2 && !render_object_store_is_dirty(store, slot_b));
+	assert(store.slot_object_ids[slot_b] == -1);
+	render_object_store_release(store, 20);	// unknown ids are ignored
+	assert(render_object_store_live_count(store) == 2);
+
+	assert(render_object_store_acquire(store, 40) == slot_b);	// freed slot reused
+	assert(render_object_store_slot_count(store) == 3);
+
+	render_object_store_clear(store);
+	assert(render_object_store_slot_count(store) == 0 && store.dirty_count == 0 && store.free_slots.empty());
+	assert(render_object_store_acquire(store, 50) == 0);
+}
+
+void test_dirty_slots_and_ranges()
+{
+	RenderObjectStore store;
+	for (i32 unique_id = 0; unique_id < 200; ++unique_id)
+	{
+		render_object_store_acquire(store, unique_id);
+	}
+	DynamicArray<i32> dirty_slots;
+	render_object_store_take_dirty(store, dirty_slots);
+	assert(dirty_slots.length() == 200 && store.dirty_count == 0);
+
+	// Marks across word boundaries come back sorted, once each
+	const i32 marks[] = { 130, 3, 64, 63, 4, 5, 199, 3, 65 };
+	for (i32 slot : marks)
+	{
+		render_object_store_mark_dirty(store, slot);
+	}
+	assert(store.dirty_count == 8);
+	dirty_slots.clear();
+	render_object_store_take_dirty(store, dirty_slots);
+	const i32 expected[] = { 3, 4, 5, 63, 64, 65, 130, 199 };
+	assert(dirty_slots.length() == 8);
+	for (size_t slot_idx = 0; slot_idx < dirty_slots.length(); ++slot_idx)
+	{
+		assert(dirty_slots[slot_idx] == expected[slot_idx]);
+	}
+
+	DynamicArray<RenderObjectStoreRange> ranges;
+	render_object_store_build_ranges(dirty_slots, ranges);
+	assert(ranges.length() == 4);
+	assert(ranges[0].first_slot == 3 && ranges[0].slot_count == 3);
+	assert(ranges[1].first_slot == 63 && ranges[1].slot_count == 3);
+	assert(ranges[2].first_slot == 130 && ranges[2].slot_count == 1);
+	assert(ranges[3].first_slot == 199 && ranges[3].slot_count == 1);
+}
+
+void test_only_changed_rows_upload()
+{
+	const i32 object_count = 10000;
+	RenderObjectStore store;
+	DynamicArray<f32> positions;
+	DynamicArray<RenderObjectStoreRange> ranges;
+	for (i32 unique_id = 0; unique_id < object_count; ++unique_id)
+	{
+		positions.add((f32) unique_id);
+		render_object_store_acquire(store, unique_id);
+	}
+
+	// First frame sends everything as one run
+	assert(flush(store, positions, ranges) == object_count);
+	assert(ranges.length() == 1 && ranges[0].slot_count == object_count);
+
+	// A static scene sends nothing
+	for (i32 frame_idx = 0; frame_idx < 10; ++frame_idx)
+	{
+		assert(flush(store, positions, ranges) == 0);
+		assert(ranges.empty());
+	}
+
+	// Marked but unmoved rows are re-read, not re-sent
+	render_object_store_mark_dirty(store, 7);
+	assert(flush(store, positions, ranges) == 0);
+
+	// Two moving objects send two rows; bounds follow the move
+	positions[100] += 1.0f;
+	positions[5000] += 1.0f;
+	render_object_store_mark_dirty(store, store.object_slots[100]);
+	render_object_store_mark_dirty(store, store.object_slots[5000]);
+	assert(flush(store, positions, ranges) == 2);
+	assert(ranges.length() == 2);
+	assert(cull_bounds_get(store.bounds, store.object_slots[100]).min.X == 100.0f);
+
+	// A replaced object in a reused slot is always re-sent, even if its row
+	// happens to equal the previous occupant's
+	render_object_store_release(store, 42);
+	const i32 reused_slot = render_object_store_acquire(store, 42);
+	assert(flush(store, positions, ranges) == 1);
+	assert(ranges[0].first_slot == reused_slot);
+
+	// A new GPU buffer needs every live row again, freed slots excluded
+	render_object_store_release(store, 9);
+	render_object_store_invalidate_all(store);
+	assert(flush(store, positions, ranges) == object_count - 1);
+	assert(ranges.length() == 2);
+}
+
+void test_cull_queues()
+{
+	RenderObjectStore store;
+	DynamicArray<f32> positions;
+	DynamicArray<RenderObjectStoreRange> ranges;
+	for (i32 unique_id = 0; unique_id < 4; ++unique_id)
+	{
+		positions.add((f32) unique_id);
+		render_object_store_acquire(store, unique_id);
+	}
+	flush(store, positions, ranges);
+	assert(store.changed_cull_slots.length() == 4);
+	assert(store.cull_flags[0] == CULL_SLOT_LIVE);
+	store.changed_cull_slots.clear();
+
+	// Unmoved rows queue nothing; moved bounds queue their slot once
+	render_object_store_mark_dirty(store, 1);
+	flush(store, positions, ranges);
+	assert(store.changed_cull_slots.empty());
+	positions[2] += 1.0f;
+	render_object_store_mark_dirty(store, 2);
+	flush(store, positions, ranges);
+	assert(store.changed_cull_slots.length() == 1 && store.changed_cull_slots[0] == 2);
+
+	// Flags changing with identical bounds still queue the slot
+	store.changed_cull_slots.clear();
+	render_object_store_write(store, 3, translation(3.0f), HMM_M4D(1.0f), 0, bounds_at(3.0f), true);
+	assert(store.changed_cull_slots.length() == 1 && store.cull_flags[3] == (CULL_SLOT_LIVE | CULL_SLOT_ALWAYS_VISIBLE));
+
+	render_object_store_release(store, 0);
+	assert(store.released_cull_slots.length() == 1 && store.cull_flags[0] == 0);
+	render_object_store_clear(store);
+	assert(store.released_cull_slots.empty() && store.changed_cull_slots.empty() && cull_bounds_length(store.bounds) == 0);
+}
+
+int main()
+{
+	test_slots_are_stable_and_reused();
+	test_dirty_slots_and_ranges();
+	test_only_changed_rows_upload();
+	test_cull_queues();
+	printf("render object store tests passed\n");
+	return 0;
+}
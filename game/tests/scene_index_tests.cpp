@@ -0,0 +1,185 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+
+#include "scene/scene_index.h"
+#include "test_random.h"
+
+// Stand-in for scene.objects: the index only ever sees SceneIndexObjectInfo
+using ObjectMap = ankerl::unordered_dense::map<i32, SceneIndexObjectInfo>;
+
+static const SceneIndexObjectInfo& info_of(const SceneIndexObjectInfo& in_info)
+{
+	return in_info;
+}
+
+// Mixes every component the rules look at, with armature ids drawn from a
+// small range so skinned catalog Parts keep pinning and unpinning armatures
+SceneIndexObjectInfo random_info(Random& in_random, i32 in_id_range)
+{
+	SceneIndexObjectInfo info;
+	info.has_mesh = in_random.chance(60);
+	info.has_skinned_vertices = info.has_mesh && in_random.chance(40);
+	info.has_light = in_random.chance(15);
+	info.has_armature = in_random.chance(20);
+	info.has_part = in_random.chance(20);
+	info.has_attachment_point = in_random.chance(10);
+	info.runtime_instance = in_random.chance(25);
+	info.mesh_armature_id = in_random.chance(70) ? (i32) (in_random.next() % (u32) in_id_range) : -1;
+	return info;
+}
+
+void check_against_rescan(SceneIndexes& in_indexes, const ObjectMap& in_objects)
+{
+	SceneIndexes rescanned;
+	scene_indexes_rescan(rescanned, in_objects, info_of);
+	assert(scene_indexes_match(in_indexes, rescanned));
+	assert(in_indexes.entries.size() == in_objects.size());
+}
+
+void set_object(SceneIndexes& in_indexes, ObjectMap& in_objects, i32 in_unique_id, const SceneIndexObjectInfo& in_info)
+{
+	in_objects[in_unique_id] = in_info;
+	scene_indexes_set(in_indexes, in_unique_id, in_info);
+}
+
+void remove_object(SceneIndexes& in_indexes, ObjectMap& in_objects, i32 in_unique_id)
+{
+	in_objects.erase(in_unique_id);
+	scene_indexes_remove(in_indexes, in_unique_id);
+}
+
+void test_catalog_armature_pinning()
+{
+	SceneIndexes indexes;
+	ObjectMap objects;
+	const SceneIndexObjectInfo armature = { .has_armature = true };
+	const SceneIndexObjectInfo catalog_skinned_part = {
+		.has_mesh = true, .has_skinned_vertices = true, .has_part = true, .mesh_armature_id = 1,
+	};
+
+	set_object(indexes, objects, 1, armature);
+	assert(indexes.armature_object_ids.length() == 1);
+
+	// Two Parts pin armature 1; it leaves the list once and returns only
+	// when the last of them is gone
+	set_object(indexes, objects, 2, catalog_skinned_part);
+	assert(indexes.armature_object_ids.empty());
+	assert(indexes.part_object_ids.length() == 1);
+	assert(indexes.mesh_object_ids.empty());
+	set_object(indexes, objects, 3, catalog_skinned_part);
+	remove_object(indexes, objects, 2);
+	assert(indexes.armature_object_ids.empty());
+	check_against_rescan(indexes, objects);
+
+	// Replacing the Part with an unskinned one releases the pin
+	set_object(indexes, objects, 3, { .has_mesh = true, .has_part = true, .mesh_armature_id = 1 });
+	assert(indexes.armature_object_ids.length() == 1);
+	check_against_rescan(indexes, objects);
+
+	// A pin that arrives before its armature applies once the armature does
+	remove_object(indexes, objects, 1);
+	set_object(indexes, objects, 4, catalog_skinned_part);
+	set_object(indexes, objects, 1, armature);
+	assert(indexes.armature_object_ids.empty());
+	check_against_rescan(indexes, objects);
+
+	// Runtime armature instances are indexed even when pinned
+	set_object(indexes, objects, 1, { .has_armature = true, .runtime_instance = true });
+	assert(indexes.armature_object_ids.length() == 1);
+	check_against_rescan(indexes, objects);
+
+	scene_indexes_clear(indexes);
+	objects.clear();
+	assert(indexes.entries.empty() && indexes.armature_pin_counts.empty() && indexes.mesh_object_ids.empty());
+	check_against_rescan(indexes, objects);
+}
+
+void test_random_operations_match_rescan()
+{
+	Random random;
+	SceneIndexes indexes;
+	ObjectMap objects;
+	const i32 id_range = 400;
+	for (i32 step = 0; step < 20000; ++step)
+	{
+		const i32 unique_id = (i32) (random.next() % (u32) id_range);
+		if (random.chance(30))
+		{
+			remove_object(indexes, objects, unique_id);
+		}
+		else
+		{
+			set_object(indexes, objects, unique_id, random_info(random, id_range));
+		}
+		if (step % 97 == 0)
+		{
+			check_against_rescan(indexes, objects);
+		}
+	}
+	check_against_rescan(indexes, objects);
+}
+
+// A live-link batch replaces a few hundred objects in a large scene. The
+// old path marked the indexes dirty and rescanned everything; the new one
+// touches only the replaced entries.
+void benchmark_incremental_against_rescan()
+{
+	const i32 object_count = 50000;
+	const i32 batch_size = 200;
+	const i32 batch_count = 50;
+
+	Random random;
+	SceneIndexes indexes;
+	ObjectMap objects;
+	objects.reserve(object_count);
+	for (i32 unique_id = 0; unique_id < object_count; ++unique_id)
+	{
+		set_object(indexes, objects, unique_id, random_info(random, object_count));
+	}
+
+	DynamicArray<i32> batch_ids;
+	DynamicArray<SceneIndexObjectInfo> batch_infos;
+	for (i32 batch_idx = 0; batch_idx < batch_count * batch_size; ++batch_idx)
+	{
+		batch_ids.add((i32) (random.next() % (u32) object_count));
+		batch_infos.add(random_info(random, object_count));
+	}
+
+	SceneIndexes rescanned;
+	const auto rescan_start = std::chrono::steady_clock::now();
+	for (i32 batch_idx = 0; batch_idx < batch_count; ++batch_idx)
+	{
+		for (i32 item_idx = batch_idx * batch_size; item_idx < (batch_idx + 1) * batch_size; ++item_idx)
+		{
+			objects[batch_ids[item_idx]] = batch_infos[item_idx];
+		}
+		scene_indexes_rescan(rescanned, objects, info_of);
+	}
+	const f64 rescan_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - rescan_start).count();
+
+	const auto incremental_start = std::chrono::steady_clock::now();
+	for (i32 batch_idx = 0; batch_idx < batch_count; ++batch_idx)
+	{
+		for (i32 item_idx = batch_idx * batch_size; item_idx < (batch_idx + 1) * batch_size; ++item_idx)
+		{
+			scene_indexes_set(indexes, batch_ids[item_idx], batch_infos[item_idx]);
+		}
+	}
+	const f64 incremental_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - incremental_start).count();
+
+	check_against_rescan(indexes, objects);
+	printf("scene indexes, %i objects, %i batches of %i replacements: rescan %.3f ms/batch, incremental %.3f ms/batch (%.0fx)\n",
+		object_count, batch_count, batch_size,
+		rescan_ms / batch_count, incremental_ms / batch_count, rescan_ms / MAX(incremental_ms, 1e-6));
+	assert(incremental_ms < rescan_ms);
+}
+
+int main()
+{
+	test_catalog_armature_pinning();
+	test_random_operations_match_rescan();
+	benchmark_incremental_against_rescan();
+	printf("scene index tests passed\n");
+	return 0;
+}
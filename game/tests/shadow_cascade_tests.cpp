@@ -0,0 +1,280 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+#include "render/shadow_cascade_cache.h"
+#include "test_random.h"
+
+static constexpr i32 RESOLUTION = 2048;
+static constexpr f32 FOV = HMM_PI32 / 3.0f;
+static constexpr f32 ASPECT = 16.0f / 9.0f;
+
+struct Slice
+{
+	f32 near_distance;
+	f32 far_distance;
+	i32 snap_texels;
+};
+
+static HMM_Vec3 sun_direction()
+{
+	return HMM_NormV3(HMM_V3(0.3f, 0.45f, -0.84f));
+}
+
+static f32 slice_half_extent(const Slice& in_slice)
+{
+	const f32 radius = shadow_cascade_slice_radius(in_slice.near_distance, in_slice.far_distance, FOV, ASPECT);
+	return shadow_cascade_half_extent(radius, RESOLUTION, in_slice.snap_texels);
+}
+
+static f32 slice_step(const Slice& in_slice)
+{
+	return shadow_cascade_snap_step(slice_half_extent(in_slice), RESOLUTION, in_slice.snap_texels);
+}
+
+static HMM_Vec3 slice_center(const Slice& in_slice, HMM_Vec3 in_location, HMM_Vec3 in_forward)
+{
+	return in_location + in_forward * ((in_slice.near_distance + in_slice.far_distance) * 0.5f);
+}
+
+// Same fit as ShadowDepthPass::compute_cascade_matrices' frustum mode
+static HMM_Mat4 fit(const Slice& in_slice, HMM_Vec3 in_location, HMM_Vec3 in_forward)
+{
+	const f32 radius = shadow_cascade_slice_radius(in_slice.near_distance, in_slice.far_distance, FOV, ASPECT);
+	const f32 depth_margin = fmaxf(10.0f, radius * 0.25f);
+	return shadow_cascade_snapped_view_projection(
+		shadow_cascade_light_rotation(sun_direction()),
+		slice_center(in_slice, in_location, in_forward),
+		slice_half_extent(in_slice),
+		radius + depth_margin,
+		RESOLUTION,
+		in_slice.snap_texels
+	);
+}
+
+static HMM_Vec2 texel_position(const HMM_Mat4& in_view_projection, HMM_Vec3 in_point)
+{
+	const HMM_Vec4 clip = HMM_MulM4V4(in_view_projection, HMM_V4V(in_point, 1.0f));
+	return HMM_V2((clip.X * 0.5f + 0.5f) * (f32) RESOLUTION, (clip.Y * 0.5f + 0.5f) * (f32) RESOLUTION);
+}
+
+static f32 distance_to_integer(f32 in_value)
+{
+	return fabsf(in_value - roundf(in_value));
+}
+
+static bool matrices_equal(const HMM_Mat4& in_a, const HMM_Mat4& in_b)
+{
+	return memcmp(&in_a, &in_b, sizeof(HMM_Mat4)) == 0;
+}
+
+static const Slice slices[] = {
+	{ 0.01f, 50.0f, 1 },
+	{ 50.0f, 100.0f, 8 },
+	{ 100.0f, 200.0f, 8 },
+	{ 200.0f, 400.0f, 8 },
+};
+
+// A camera that stays inside one snap cell reproduces the matrix exactly
+void test_sub_step_motion_keeps_matrix()
+{
+	Random random;
+	const HMM_Vec3 forward = HMM_NormV3(HMM_V3(0.2f, 1.0f, -0.3f));
+	const HMM_Mat4 light_rotation = shadow_cascade_light_rotation(sun_direction());
+	for (const Slice& slice : slices)
+	{
+		// Place the slice centre in the middle of a cell
+		const f32 step = slice_step(slice);
+		const HMM_Vec3 rough_center = slice_center(slice, HMM_V3(130.0f, -42.0f, 7.0f), forward);
+		const HMM_Vec4 light_center = HMM_MulM4V4(light_rotation, HMM_V4V(rough_center, 1.0f));
+		const HMM_Vec4 cell_center = HMM_V4(
+			roundf(light_center.X / step) * step,
+			roundf(light_center.Y / step) * step,
+			roundf(light_center.Z / step) * step,
+			1.0f);
+		const HMM_Vec4 world_center = HMM_MulM4V4(HMM_TransposeM4(light_rotation), cell_center);
+		const HMM_Vec3 location = world_center.XYZ - forward * ((slice.near_distance + slice.far_distance) * 0.5f);
+
+		const HMM_Mat4 reference = fit(slice, location, forward);
+		for (i32 frame = 0; frame < 200; ++frame)
+		{
+			const HMM_Vec3 offset = HMM_V3(random.signed_unit(), random.signed_unit(), random.signed_unit()) * (step * 0.2f);
+			assert(matrices_equal(fit(slice, location + offset, forward), reference));
+		}
+	}
+}
+
+// Any camera motion shifts the map by whole texels, and the extent never
+// changes, so a fixed world point always lands on the same sub-texel offset
+void test_motion_moves_whole_texels()
+{
+	Random random;
+	const HMM_Vec3 forward = HMM_NormV3(HMM_V3(-0.4f, 1.0f, -0.2f));
+	for (const Slice& slice : slices)
+	{
+		HMM_Vec3 location = HMM_V3(10.0f, 20.0f, 5.0f);
+		const HMM_Mat4 first = fit(slice, location, forward);
+		HMM_Vec3 points[16];
+		HMM_Vec2 first_texels[16];
+		for (i32 point_idx = 0; point_idx < 16; ++point_idx)
+		{
+			points[point_idx] = slice_center(slice, location, forward)
+				+ HMM_V3(random.signed_unit(), random.signed_unit(), random.signed_unit()) * (slice.far_distance * 0.3f);
+			first_texels[point_idx] = texel_position(first, points[point_idx]);
+		}
+
+		i32 changes = 0;
+		HMM_Mat4 previous = first;
+		for (i32 frame = 0; frame < 500; ++frame)
+		{
+			location += HMM_V3(random.signed_unit(), random.signed_unit(), random.signed_unit() * 0.25f) * 0.3f;
+			const HMM_Mat4 current = fit(slice, location, forward);
+			changes += matrices_equal(current, previous) ? 0 : 1;
+			previous = current;
+
+			// Rotation and scale are shared by every frame's matrix
+			for (i32 column = 0; column < 3; ++column)
+			{
+				for (i32 row = 0; row < 3; ++row)
+				{
+					assert(current.Elements[column][row] == first.Elements[column][row]);
+				}
+			}
+			for (i32 point_idx = 0; point_idx < 16; ++point_idx)
+			{
+				const HMM_Vec2 texel = texel_position(current, points[point_idx]);
+				assert(distance_to_integer(texel.X - first_texels[point_idx].X) < 0.02f);
+				assert(distance_to_integer(texel.Y - first_texels[point_idx].Y) < 0.02f);
+			}
+		}
+		assert(changes > 0);	// the walk did cross cells
+	}
+}
+
+// Turning the camera keeps the extent, and the fit always covers the slice
+void test_rotation_keeps_extent_and_covers_slice()
+{
+	Random random;
+	const HMM_Vec3 location = HMM_V3(-250.0f, 75.0f, 12.0f);
+	for (const Slice& slice : slices)
+	{
+		const HMM_Mat4 reference = fit(slice, location, HMM_V3(0.0f, 1.0f, 0.0f));
+		for (i32 view_idx = 0; view_idx < 200; ++view_idx)
+		{
+			const HMM_Vec3 forward = HMM_NormV3(HMM_V3(random.signed_unit(), random.signed_unit(), random.signed_unit() * 0.5f));
+			if (HMM_LenV3(HMM_Cross(forward, HMM_V3(0.0f, 0.0f, 1.0f))) < 0.1f)
+			{
+				continue;
+			}
+			const HMM_Mat4 current = fit(slice, location, forward);
+			for (i32 column = 0; column < 3; ++column)
+			{
+				for (i32 row = 0; row < 3; ++row)
+				{
+					assert(current.Elements[column][row] == reference.Elements[column][row]);
+				}
+			}
+
+			// Slice corners, like get_frustum_slice_corners
+			const HMM_Vec3 right = HMM_NormV3(HMM_Cross(forward, HMM_V3(0.0f, 0.0f, 1.0f)));
+			const HMM_Vec3 up = HMM_NormV3(HMM_Cross(right, forward));
+			const f32 tan_half_fov = tanf(FOV * 0.5f);
+			for (f32 distance : { slice.near_distance, slice.far_distance })
+			{
+				const f32 half_height = tan_half_fov * distance;
+				const f32 half_width = half_height * ASPECT;
+				for (i32 corner = 0; corner < 4; ++corner)
+				{
+					const HMM_Vec3 point = location + forward * distance
+						+ right * ((corner & 1) ? half_width : -half_width)
+						+ up * ((corner & 2) ? half_height : -half_height);
+					const HMM_Vec4 clip = HMM_MulM4V4(current, HMM_V4V(point, 1.0f));
+					assert(fabsf(clip.X) <= 1.0f && fabsf(clip.Y) <= 1.0f);
+					assert(clip.Z >= 0.0f && clip.Z <= 1.0f);
+				}
+			}
+		}
+	}
+}
+
+void test_cache_policy()
+{
+	const Slice& slice = slices[2];
+	const HMM_Vec3 forward = HMM_V3(0.0f, 1.0f, 0.0f);
+	const HMM_Mat4 view_projection = fit(slice, HMM_V3(0.0f, 0.0f, 0.0f), forward);
+	const HMM_Mat4 moved_view_projection = fit(slice, HMM_V3(40.0f, 0.0f, 0.0f), forward);
+	assert(!matrices_equal(view_projection, moved_view_projection));
+
+	ShadowCascadeCache cache;
+	ShadowCascadeCacheSlot& slot = cache.slots[0];
+	assert(shadow_cascade_cache_update_slot(slot, view_projection, 1, 4, false));	// never rendered
+	assert(!shadow_cascade_cache_update_slot(slot, view_projection, 2, 4, false));
+	assert(shadow_cascade_cache_update_slot(slot, view_projection, 3, 4, true));		// always
+	assert(shadow_cascade_cache_update_slot(slot, moved_view_projection, 4, 4, false));
+	assert(!shadow_cascade_cache_update_slot(slot, moved_view_projection, 5, 4, false));
+
+	// A caster far outside the slice does not dirty it
+	const BoundingBox outside = { .min = HMM_V3(5000.0f, 5000.0f, 0.0f), .max = HMM_V3(5001.0f, 5001.0f, 1.0f) };
+	shadow_cascade_cache_mark_moved(cache, &outside, 1);
+	assert(!slot.contents_dirty);
+	assert(!shadow_cascade_cache_update_slot(slot, moved_view_projection, 99, 4, false));
+	assert(shadow_cascade_cache_update_slot(slot, moved_view_projection, 100, 4, true));
+
+	// One inside does; the slice re-renders once the interval has passed
+	const BoundingBox inside = { .min = HMM_V3(40.0f, 150.0f, 0.0f), .max = HMM_V3(42.0f, 152.0f, 2.0f) };
+	shadow_cascade_cache_mark_moved(cache, &inside, 1);
+	assert(slot.contents_dirty);
+	assert(!cache.slots[1].contents_dirty);	// invalid slots are left alone
+	assert(!shadow_cascade_cache_update_slot(slot, moved_view_projection, 101, 4, false));
+	assert(!shadow_cascade_cache_update_slot(slot, moved_view_projection, 103, 4, false));
+	assert(shadow_cascade_cache_update_slot(slot, moved_view_projection, 104, 4, false));
+	assert(!slot.contents_dirty);
+	assert(!shadow_cascade_cache_update_slot(slot, moved_view_projection, 105, 4, false));
+
+	shadow_cascade_cache_invalidate(cache);
+	assert(shadow_cascade_cache_update_slot(slot, moved_view_projection, 106, 4, false));
+}
+
+// Re-render counts for a camera walking at 1.5 m/s (60 fps) and one standing still
+void report_walk()
+{
+	const HMM_Vec3 forward = HMM_NormV3(HMM_V3(0.3f, 1.0f, -0.1f));
+	const i32 frame_count = 600;
+	for (f32 speed : { 0.0f, 1.5f })
+	{
+		printf("camera %.1f m/s, %d frames:", speed, frame_count);
+		for (i32 slice_idx = 0; slice_idx < 4; ++slice_idx)
+		{
+			for (i32 snap_texels : { 1, 8 })
+			{
+				const Slice slice = { slices[slice_idx].near_distance, slices[slice_idx].far_distance, snap_texels };
+				ShadowCascadeCacheSlot slot;
+				i32 renders = 0;
+				for (i32 frame = 0; frame < frame_count; ++frame)
+				{
+					const HMM_Vec3 location = HMM_V3(3.0f, 4.0f, 2.0f) + forward * (speed * (f32) frame / 60.0f);
+					renders += shadow_cascade_cache_update_slot(slot, fit(slice, location, forward), (u64) frame + 1, 4, false) ? 1 : 0;
+				}
+				if (speed == 0.0f)
+				{
+					assert(renders == 1);
+				}
+				printf(" c%d/%dtx=%d", slice_idx, snap_texels, renders);
+			}
+		}
+		printf("\n");
+	}
+}
+
+int main()
+{
+	test_sub_step_motion_keeps_matrix();
+	test_motion_moves_whole_texels();
+	test_rotation_keeps_extent_and_covers_slice();
+	test_cache_policy();
+	report_walk();
+	printf("shadow cascade tests passed\n");
+	return 0;
+}
@@ -0,0 +1,275 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "animation/skin_packing.h"
+#include "core/dynamic_array.h"
+#include "test_random.h"
+
+static HMM_Mat4 random_affine(Random& in_random)
+{
+	const HMM_Vec3 translation = HMM_V3(in_random.range(-2.0f, 2.0f), in_random.range(-2.0f, 2.0f), in_random.range(-2.0f, 2.0f));
+	const HMM_Vec3 axis = HMM_NormV3(HMM_V3(in_random.range(0.1f, 1.0f), in_random.range(-1.0f, 1.0f), in_random.range(-1.0f, 1.0f)));
+	const f32 scale = in_random.range(0.5f, 1.5f);
+	return HMM_Translate(translation) * HMM_Rotate_RH(in_random.range(-3.14159f, 3.14159f), axis) * HMM_Scale(HMM_V3(scale, scale, scale));
+}
+
+// One armature's sampled pose; the address stands in for its clip
+struct PoseFixture
+{
+	DynamicArray<HMM_Mat4> matrices;
+	f32 frame = 0.0f;
+};
+
+struct MeshFixture
+{
+	SkinPackKey key;
+	const HMM_Mat4* pose = nullptr;
+	DynamicArray<HMM_Mat4> staged;	// mesh.skin_matrices for the reference
+	u32 reference_offset = 0;
+	u32 batch_offset = 0;
+};
+
+static void make_poses(Random& in_random, DynamicArray<PoseFixture>& out_poses, u32 in_pose_count, u32 in_bone_count)
+{
+	out_poses.resize(in_pose_count);
+	for (u32 pose_idx = 0; pose_idx < in_pose_count; ++pose_idx)
+	{
+		out_poses[pose_idx].matrices.resize(in_bone_count);
+		for (HMM_Mat4& matrix : out_poses[pose_idx].matrices)
+		{
+			matrix = random_affine(in_random);
+		}
+		out_poses[pose_idx].frame = (f32) pose_idx * 0.5f;
+	}
+}
+
+// Meshes on random poses with random bind matrices. in_share_percent of
+// meshes copy an earlier mesh's key; a few use the bind pose.
+static void make_meshes(
+	Random& in_random,
+	const DynamicArray<PoseFixture>& in_poses,
+	DynamicArray<MeshFixture>& out_meshes,
+	u32 in_mesh_count,
+	u32 in_matrix_count,
+	u32 in_share_percent)
+{
+	out_meshes.resize(in_mesh_count);
+	for (u32 mesh_idx = 0; mesh_idx < in_mesh_count; ++mesh_idx)
+	{
+		MeshFixture& mesh = out_meshes[mesh_idx];
+		if (mesh_idx > 0 && in_random.chance(in_share_percent))
+		{
+			const MeshFixture& source = out_meshes[in_random.next() % mesh_idx];
+			mesh.key = source.key;
+			mesh.pose = source.pose;
+		}
+		else
+		{
+			const u32 matrix_count = in_matrix_count > 0 ? in_matrix_count : 1 + in_random.next() % 96;
+			mesh.key = {
+				.mesh_to_armature = random_affine(in_random),
+				.armature_to_mesh = random_affine(in_random),
+				.matrix_count = matrix_count,
+			};
+			if (!in_random.chance(5))
+			{
+				const PoseFixture& pose = in_poses[in_random.next() % in_poses.length()];
+				mesh.pose = pose.matrices.data();
+				mesh.key.pose_source = &pose;
+				mesh.key.pose_frame = pose.frame;
+				mesh.key.pose_bone_count = MIN((u32) pose.matrices.length(), matrix_count);
+			}
+		}
+		mesh.staged.resize(mesh.key.matrix_count);
+	}
+}
+
+static void pack_reference(DynamicArray<MeshFixture>& in_out_meshes, DynamicArray<HMM_Mat4>& out_arena)
+{
+	out_arena.clear();
+	for (MeshFixture& mesh : in_out_meshes)
+	{
+		mesh.reference_offset = skin_pack_reference_mesh(
+			mesh.pose,
+			mesh.key.pose_bone_count,
+			mesh.key.mesh_to_armature,
+			mesh.key.armature_to_mesh,
+			mesh.staged.data(),
+			mesh.key.matrix_count,
+			out_arena
+		);
+	}
+}
+
+static void pack_batch(DynamicArray<MeshFixture>& in_out_meshes, SkinPackBatch& in_out_batch, WorkerPool* in_workers, DynamicArray<HMM_Mat4>& out_arena)
+{
+	skin_pack_clear(in_out_batch);
+	for (MeshFixture& mesh : in_out_meshes)
+	{
+		mesh.batch_offset = skin_pack_add(in_out_batch, mesh.key, mesh.pose);
+	}
+	out_arena.clear();
+	out_arena.add_uninitialized(in_out_batch.matrix_count);
+	skin_pack_run(in_out_batch, out_arena.data(), in_workers);
+}
+
+static void check_rows_match(
+	const DynamicArray<MeshFixture>& in_meshes,
+	const DynamicArray<HMM_Mat4>& in_reference_arena,
+	const DynamicArray<HMM_Mat4>& in_batch_arena)
+{
+	for (const MeshFixture& mesh : in_meshes)
+	{
+		assert(mesh.batch_offset + mesh.key.matrix_count <= in_batch_arena.length());
+		assert(memcmp(
+			in_reference_arena.data() + mesh.reference_offset,
+			in_batch_arena.data() + mesh.batch_offset,
+			sizeof(HMM_Mat4) * mesh.key.matrix_count) == 0);
+	}
+}
+
+static void test_rows_match_reference(WorkerPool& in_workers)
+{
+	Random random;
+	DynamicArray<PoseFixture> poses;
+	make_poses(random, poses, 12, 64);
+
+	// Matrix counts from 1 to 96 against 64-bone poses cover both short
+	// poses (identity tail) and poses longer than the mesh
+	for (u32 share_percent : {0u, 40u})
+	{
+		DynamicArray<MeshFixture> meshes;
+		make_meshes(random, poses, meshes, 600, 0, share_percent);
+
+		DynamicArray<HMM_Mat4> reference_arena;
+		pack_reference(meshes, reference_arena);
+
+		SkinPackBatch batch;
+		for (WorkerPool* workers : {(WorkerPool*) nullptr, &in_workers})
+		{
+			DynamicArray<HMM_Mat4> batch_arena;
+			pack_batch(meshes, batch, workers, batch_arena);
+			assert(batch.matrix_count >= SKIN_PACK_PARALLEL_MIN_MATRICES);
+			assert(batch.mesh_count == meshes.length());
+			check_rows_match(meshes, reference_arena, batch_arena);
+
+			if (share_percent == 0)
+			{
+				// Nothing to share: the arenas are the same bytes
+				assert(batch.shared_mesh_count == 0);
+				assert(batch_arena.length() == reference_arena.length());
+				assert(memcmp(batch_arena.data(), reference_arena.data(), sizeof(HMM_Mat4) * batch_arena.length()) == 0);
+			}
+			else
+			{
+				assert(batch.shared_mesh_count > 0);
+				assert(batch.matrix_count < reference_arena.length());
+				assert(batch.jobs.length() + batch.shared_mesh_count == meshes.length());
+			}
+		}
+	}
+}
+
+static void test_keys_share_only_when_equal()
+{
+	const HMM_Mat4 pose[2] = { HMM_Translate(HMM_V3(1.0f, 0.0f, 0.0f)), HMM_Translate(HMM_V3(0.0f, 2.0f, 0.0f)) };
+	const SkinPackKey key = {
+		.mesh_to_armature = HMM_M4D(1.0f),
+		.armature_to_mesh = HMM_Translate(HMM_V3(0.0f, 0.0f, 3.0f)),
+		.pose_source = pose,
+		.pose_frame = 4.0f,
+		.pose_bone_count = 2,
+		.matrix_count = 3,
+	};
+
+	SkinPackBatch batch;
+	const u32 first = skin_pack_add(batch, key, pose);
+	assert(first == 0 && skin_pack_add(batch, key, pose) == first);
+
+	SkinPackKey other_frame = key;
+	other_frame.pose_frame = 4.5f;
+	assert(skin_pack_add(batch, other_frame, pose) == 3);
+
+	SkinPackKey other_bind = key;
+	other_bind.mesh_to_armature = HMM_Scale(HMM_V3(2.0f, 2.0f, 2.0f));
+	assert(skin_pack_add(batch, other_bind, pose) == 6);
+
+	SkinPackKey bind_pose = key;
+	bind_pose.pose_source = nullptr;
+	bind_pose.pose_frame = 0.0f;
+	bind_pose.pose_bone_count = 0;
+	assert(skin_pack_add(batch, bind_pose, nullptr) == 9);
+	assert(batch.mesh_count == 5 && batch.shared_mesh_count == 1 && batch.matrix_count == 12);
+
+	DynamicArray<HMM_Mat4> arena;
+	arena.add_uninitialized(batch.matrix_count);
+	skin_pack_run(batch, arena.data(), nullptr);
+	const HMM_Mat4 expected = HMM_MulM4(key.armature_to_mesh, HMM_MulM4(pose[1], key.mesh_to_armature));
+	assert(memcmp(&arena[1], &expected, sizeof(HMM_Mat4)) == 0);
+	const HMM_Mat4 identity = HMM_M4D(1.0f);
+	assert(memcmp(&arena[2], &identity, sizeof(HMM_Mat4)) == 0);
+	for (u32 row = 9; row < 12; ++row)
+	{
+		assert(memcmp(&arena[row], &identity, sizeof(HMM_Mat4)) == 0);
+	}
+}
+
+template <typename Function>
+static f64 best_microseconds(Function&& in_function)
+{
+	f64 best = 1e30;
+	for (i32 run = 0; run < 9; ++run)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		in_function();
+		const auto end = std::chrono::steady_clock::now();
+		const f64 elapsed = std::chrono::duration<f64, std::micro>(end - start).count();
+		best = MIN(best, elapsed);
+	}
+	return best;
+}
+
+static void benchmark_packing(WorkerPool& in_workers)
+{
+	Random random;
+	DynamicArray<PoseFixture> poses;
+	make_poses(random, poses, 64, 64);
+
+	printf("skin packing (64 bones per mesh, %d workers):\n", in_workers.worker_count());
+	printf("  %-14s %12s %12s %12s\n", "meshes", "reference", "batch", "batch+pool");
+	for (u32 share_percent : {0u, 90u})
+	{
+		for (u32 mesh_count : {10u, 100u, 1000u, 5000u})
+		{
+			DynamicArray<MeshFixture> meshes;
+			make_meshes(random, poses, meshes, mesh_count, 64, share_percent);
+
+			DynamicArray<HMM_Mat4> reference_arena;
+			DynamicArray<HMM_Mat4> batch_arena;
+			SkinPackBatch batch;
+			const f64 reference_us = best_microseconds([&]() { pack_reference(meshes, reference_arena); });
+			const f64 serial_us = best_microseconds([&]() { pack_batch(meshes, batch, nullptr, batch_arena); });
+			const f64 parallel_us = best_microseconds([&]() { pack_batch(meshes, batch, &in_workers, batch_arena); });
+			check_rows_match(meshes, reference_arena, batch_arena);
+
+			char label[32];
+			snprintf(label, sizeof(label), "%u%s", mesh_count, share_percent > 0 ? " crowd" : "");
+			printf("  %-14s %10.1fus %10.1fus %10.1fus\n", label, reference_us, serial_us, parallel_us);
+		}
+	}
+}
+
+int main()
+{
+	WorkerPool workers;
+	workers.start(4);
+
+	test_keys_share_only_when_equal();
+	test_rows_match_reference(workers);
+	benchmark_packing(workers);
+
+	printf("skin_packing_tests passed\n");
+	return 0;
+}
@@ -0,0 +1,310 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+
+#include "core/dynamic_array.h"
+#include "animation/skinned_bounds.h"
+#include "test_random.h"
+
+// A mesh as make_mesh sees it plus the matrices an import would carry
+struct SkinnedMeshFixture
+{
+	DynamicArray<Vertex> vertices;
+	DynamicArray<SkinnedVertex> skinned_vertices;
+	u32 skin_matrix_count = 0;
+	HMM_Mat4 mesh_to_armature = HMM_M4D(1.0f);
+	HMM_Mat4 armature_to_mesh = HMM_M4D(1.0f);
+	DynamicArray<BoundingBox> bone_bounds;
+};
+
+// Frame-major clip matrices, laid out like AnimationClip::skin_matrices
+struct ClipFixture
+{
+	i32 frame_count = 0;
+	i32 bone_count = 0;
+	DynamicArray<HMM_Mat4> skin_matrices;
+
+	const HMM_Mat4* frame(i32 in_frame_idx) const { return skin_matrices.data() + in_frame_idx * bone_count; }
+};
+
+static HMM_Vec3 random_direction(Random& in_random)
+{
+	const HMM_Vec3 direction = HMM_V3(in_random.range(-1.0f, 1.0f), in_random.range(-1.0f, 1.0f), in_random.range(-1.0f, 1.0f));
+	return HMM_LenSqrV3(direction) > 0.0001f ? HMM_NormV3(direction) : HMM_V3(0.0f, 1.0f, 0.0f);
+}
+
+static HMM_Mat4 random_affine(Random& in_random, f32 in_translation, f32 in_min_scale, f32 in_max_scale)
+{
+	const HMM_Vec3 translation = HMM_V3(in_random.range(-in_translation, in_translation), in_random.range(-in_translation, in_translation), in_random.range(-in_translation, in_translation));
+	const HMM_Vec3 scale = HMM_V3(in_random.range(in_min_scale, in_max_scale), in_random.range(in_min_scale, in_max_scale), in_random.range(in_min_scale, in_max_scale));
+	return HMM_Translate(translation) * HMM_Rotate_RH(in_random.range(-3.14159f, 3.14159f), random_direction(in_random)) * HMM_Scale(scale);
+}
+
+// Weights shaped like the exporter's: up to four influences normalized to
+// one, or all zero. Unused influence slots keep weight 0 and may point at
+// any joint, including ones past the mesh's bones.
+static SkinnedMeshFixture make_random_mesh(Random& in_random, u32 in_vertex_count, u32 in_bone_count)
+{
+	SkinnedMeshFixture out_mesh;
+	out_mesh.skin_matrix_count = in_bone_count;
+	out_mesh.mesh_to_armature = random_affine(in_random, 2.0f, 0.5f, 2.0f);
+	out_mesh.armature_to_mesh = HMM_InvGeneralM4(out_mesh.mesh_to_armature);
+
+	for (u32 vertex_idx = 0; vertex_idx < in_vertex_count; ++vertex_idx)
+	{
+		out_mesh.vertices.add({
+			.position = HMM_V4(in_random.range(-3.0f, 3.0f), in_random.range(0.0f, 6.0f), in_random.range(-1.0f, 1.0f), 1.0f),
+			.normal = HMM_V4(0.0f, 1.0f, 0.0f, 0.0f),
+		});
+
+		SkinnedVertex skinned_vertex = {};
+		if (!in_random.chance(5))
+		{
+			const u32 influence_count = 1 + in_random.next() % 4;
+			f32 total_weight = 0.0f;
+			for (u32 influence_idx = 0; influence_idx < influence_count; ++influence_idx)
+			{
+				skinned_vertex.joint_indices.Elements[influence_idx] = (f32) (in_random.next() % in_bone_count);
+				skinned_vertex.joint_weights.Elements[influence_idx] = in_random.range(0.05f, 1.0f);
+				total_weight += skinned_vertex.joint_weights.Elements[influence_idx];
+			}
+			for (u32 influence_idx = 0; influence_idx < 4; ++influence_idx)
+			{
+				skinned_vertex.joint_weights.Elements[influence_idx] /= total_weight;
+			}
+			for (u32 influence_idx = influence_count; influence_idx < 4; ++influence_idx)
+			{
+				skinned_vertex.joint_indices.Elements[influence_idx] = (f32) (in_random.next() % (in_bone_count * 2));
+			}
+		}
+		out_mesh.skinned_vertices.add(skinned_vertex);
+	}
+
+	out_mesh.bone_bounds.resize(skinned_bounds_bone_box_count(in_bone_count));
+	skinned_bounds_compute_bone_boxes(
+		out_mesh.vertices.data(),
+		out_mesh.skinned_vertices.data(),
+		in_vertex_count,
+		in_bone_count,
+		out_mesh.bone_bounds.data()
+	);
+	return out_mesh;
+}
+
+static ClipFixture make_random_clip(Random& in_random, i32 in_frame_count, i32 in_bone_count)
+{
+	ClipFixture out_clip = { .frame_count = in_frame_count, .bone_count = in_bone_count };
+	for (i32 matrix_idx = 0; matrix_idx < in_frame_count * in_bone_count; ++matrix_idx)
+	{
+		out_clip.skin_matrices.add(random_affine(in_random, 4.0f, 0.25f, 3.0f));
+	}
+	return out_clip;
+}
+
+// The skin matrices AnimationSystem::pack_skin_matrices would upload
+static void pack_skin_matrices(const SkinnedMeshFixture& in_mesh, const ClipFixture* in_clip, i32 in_frame_idx, DynamicArray<HMM_Mat4>& out_matrices)
+{
+	out_matrices.clear();
+	for (u32 bone_idx = 0; bone_idx < in_mesh.skin_matrix_count; ++bone_idx)
+	{
+		out_matrices.add(HMM_M4D(1.0f));
+	}
+	if (!in_clip)
+	{
+		return;
+	}
+
+	const i32 bone_count = MIN(in_clip->bone_count, (i32) in_mesh.skin_matrix_count);
+	for (i32 bone_idx = 0; bone_idx < bone_count; ++bone_idx)
+	{
+		out_matrices[bone_idx] = in_mesh.armature_to_mesh * in_clip->frame(in_frame_idx)[bone_idx] * in_mesh.mesh_to_armature;
+	}
+}
+
+// geometry_skinned.vert: get_skin_matrix(...) * position
+static HMM_Vec3 skin_vertex(const Vertex& in_vertex, const SkinnedVertex& in_skinned_vertex, const DynamicArray<HMM_Mat4>& in_matrices)
+{
+	const HMM_Vec4& weights = in_skinned_vertex.joint_weights;
+	if (weights.X + weights.Y + weights.Z + weights.W <= 0.00001f)
+	{
+		return in_vertex.position.XYZ;
+	}
+
+	HMM_Vec4 out_position = HMM_V4(0.0f, 0.0f, 0.0f, 0.0f);
+	for (i32 influence_idx = 0; influence_idx < 4; ++influence_idx)
+	{
+		const f32 weight = weights.Elements[influence_idx];
+		if (weight > 0.0f)
+		{
+			out_position = out_position + (in_matrices[(i32) in_skinned_vertex.joint_indices.Elements[influence_idx]] * in_vertex.position) * weight;
+		}
+	}
+	return out_position.XYZ;
+}
+
+static bool box_contains(const BoundingBox& in_box, const HMM_Vec3 in_point)
+{
+	return in_point.X >= in_box.min.X && in_point.X <= in_box.max.X
+		&& in_point.Y >= in_box.min.Y && in_point.Y <= in_box.max.Y
+		&& in_point.Z >= in_box.min.Z && in_point.Z <= in_box.max.Z;
+}
+
+// Skins every vertex on the CPU and returns the box of the results
+static BoundingBox check_pose_contains_vertices(const SkinnedMeshFixture& in_mesh, const ClipFixture* in_clip, i32 in_frame_idx, DynamicArray<HMM_Mat4>& in_out_matrices)
+{
+	pack_skin_matrices(in_mesh, in_clip, in_frame_idx, in_out_matrices);
+	const BoundingBox pose_bounds = skinned_bounds_evaluate(
+		in_mesh.bone_bounds.data(),
+		in_mesh.skin_matrix_count,
+		in_clip ? in_clip->frame(in_frame_idx) : nullptr,
+		in_clip ? in_clip->bone_count : 0,
+		in_mesh.mesh_to_armature,
+		in_mesh.armature_to_mesh
+	);
+
+	BoundingBox out_skinned_bounds = bounding_box_init();
+	for (size_t vertex_idx = 0; vertex_idx < in_mesh.vertices.length(); ++vertex_idx)
+	{
+		const HMM_Vec3 position = skin_vertex(in_mesh.vertices[vertex_idx], in_mesh.skinned_vertices[vertex_idx], in_out_matrices);
+		assert(box_contains(pose_bounds, position));
+		bounding_box_expand(out_skinned_bounds, position);
+	}
+	return out_skinned_bounds;
+}
+
+void test_bone_boxes()
+{
+	SkinnedMeshFixture mesh;
+	mesh.skin_matrix_count = 3;
+	mesh.vertices.add({ .position = HMM_V4(1.0f, 0.0f, 0.0f, 1.0f) });
+	mesh.vertices.add({ .position = HMM_V4(0.0f, 2.0f, 0.0f, 1.0f) });
+	mesh.vertices.add({ .position = HMM_V4(0.0f, 0.0f, 3.0f, 1.0f) });
+	mesh.vertices.add({ .position = HMM_V4(-4.0f, 0.0f, 0.0f, 1.0f) });
+	mesh.skinned_vertices.add({ .joint_indices = HMM_V4(0, 1, 7, 0), .joint_weights = HMM_V4(0.5f, 0.5f, 0.0f, 0.0f) });
+	mesh.skinned_vertices.add({ .joint_indices = HMM_V4(1, 0, 0, 0), .joint_weights = HMM_V4(1.0f, 0.0f, 0.0f, 0.0f) });
+	mesh.skinned_vertices.add({ .joint_indices = HMM_V4(0, 0, 0, 0), .joint_weights = HMM_V4(0.0f, 0.0f, 0.0f, 0.0f) });
+	mesh.skinned_vertices.add({ .joint_indices = HMM_V4(1, 0, 0, 0), .joint_weights = HMM_V4(1.0f, 0.0f, 0.0f, 0.0f) });
+	mesh.bone_bounds.resize(skinned_bounds_bone_box_count(mesh.skin_matrix_count));
+	skinned_bounds_compute_bone_boxes(mesh.vertices.data(), mesh.skinned_vertices.data(), 4, 3, mesh.bone_bounds.data());
+
+	// Zero-weight and out-of-range joints contribute nothing; unreferenced
+	// bones stay empty; unweighted vertices land in the extra box
+	assert(mesh.bone_bounds[0].min.X == 1.0f && mesh.bone_bounds[0].max.X == 1.0f);
+	assert(mesh.bone_bounds[1].min.X == -4.0f && mesh.bone_bounds[1].max.Y == 2.0f);
+	assert(skinned_bounds_box_is_empty(mesh.bone_bounds[2]));
+	assert(mesh.bone_bounds[3].min.Z == 3.0f && mesh.bone_bounds[3].max.Z == 3.0f);
+
+	// A clip that only moves bone 1 moves only bone 1's box; the unweighted
+	// vertex stays put even though the clip has a matrix at its index
+	ClipFixture clip = { .frame_count = 1, .bone_count = 4 };
+	clip.skin_matrices.add(HMM_M4D(1.0f));
+	clip.skin_matrices.add(HMM_Translate(HMM_V3(0.0f, 10.0f, 0.0f)));
+	clip.skin_matrices.add(HMM_M4D(1.0f));
+	clip.skin_matrices.add(HMM_Translate(HMM_V3(0.0f, 0.0f, 100.0f)));
+	DynamicArray<HMM_Mat4> matrices;
+	const BoundingBox skinned_bounds = check_pose_contains_vertices(mesh, &clip, 0, matrices);
+	const BoundingBox pose_bounds = skinned_bounds_evaluate(mesh.bone_bounds.data(), 3, clip.frame(0), 4, mesh.mesh_to_armature, mesh.armature_to_mesh);
+	assert(pose_bounds.max.Y >= 12.0f && pose_bounds.max.Y < 12.01f);
+	assert(pose_bounds.max.Z >= 3.0f && pose_bounds.max.Z < 3.01f);
+	assert(skinned_bounds.max.Y == 12.0f);
+}
+
+void test_sampled_frames_contain_skinned_vertices()
+{
+	Random random;
+	DynamicArray<HMM_Mat4> matrices;
+	for (i32 mesh_idx = 0; mesh_idx < 40; ++mesh_idx)
+	{
+		const u32 bone_count = 1 + random.next() % 48;
+		const SkinnedMeshFixture mesh = make_random_mesh(random, 200 + random.next() % 800, bone_count);
+
+		// The bind pose (no armature or clip) is the mesh as imported
+		check_pose_contains_vertices(mesh, nullptr, 0, matrices);
+
+		// Clips shorter than, equal to and longer than the mesh's bone list
+		const i32 clip_bone_counts[] = { (i32) MAX(bone_count / 2, 1u), (i32) bone_count, (i32) bone_count + 3 };
+		for (i32 clip_bone_count : clip_bone_counts)
+		{
+			const ClipFixture clip = make_random_clip(random, 30, clip_bone_count);
+			for (i32 frame_idx = 0; frame_idx < clip.frame_count; frame_idx += 7)
+			{
+				check_pose_contains_vertices(mesh, &clip, frame_idx, matrices);
+			}
+		}
+	}
+}
+
+void test_rigid_single_bone_is_tight()
+{
+	Random random;
+	SkinnedMeshFixture mesh = make_random_mesh(random, 500, 1);
+	for (SkinnedVertex& skinned_vertex : mesh.skinned_vertices)
+	{
+		skinned_vertex = { .joint_indices = HMM_V4(0, 0, 0, 0), .joint_weights = HMM_V4(1.0f, 0.0f, 0.0f, 0.0f) };
+	}
+	mesh.mesh_to_armature = HMM_M4D(1.0f);
+	mesh.armature_to_mesh = HMM_M4D(1.0f);
+	skinned_bounds_compute_bone_boxes(mesh.vertices.data(), mesh.skinned_vertices.data(), 500, 1, mesh.bone_bounds.data());
+
+	// Translation and axis scale keep the box exact up to the padding
+	ClipFixture clip = { .frame_count = 1, .bone_count = 1 };
+	clip.skin_matrices.add(HMM_Translate(HMM_V3(5.0f, -2.0f, 1.0f)) * HMM_Scale(HMM_V3(2.0f, 1.0f, 0.5f)));
+	DynamicArray<HMM_Mat4> matrices;
+	const BoundingBox skinned_bounds = check_pose_contains_vertices(mesh, &clip, 0, matrices);
+	const BoundingBox pose_bounds = skinned_bounds_evaluate(mesh.bone_bounds.data(), 1, clip.frame(0), 1, mesh.mesh_to_armature, mesh.armature_to_mesh);
+	const HMM_Vec3 slack_min = skinned_bounds.min - pose_bounds.min;
+	const HMM_Vec3 slack_max = pose_bounds.max - skinned_bounds.max;
+	assert(MAX(MAX(slack_min.X, slack_min.Y), slack_min.Z) < 0.01f);
+	assert(MAX(MAX(slack_max.X, slack_max.Y), slack_max.Z) < 0.01f);
+}
+
+static f64 milliseconds_since(std::chrono::steady_clock::time_point in_start)
+{
+	return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - in_start).count();
+}
+
+// Per-frame cost of the bone-box bounds against skinning every vertex on
+// the CPU, for a character-sized mesh
+void benchmark_pose_bounds()
+{
+	Random random;
+	const u32 bone_count = 64;
+	const SkinnedMeshFixture mesh = make_random_mesh(random, 20000, bone_count);
+	const ClipFixture clip = make_random_clip(random, 60, bone_count);
+	DynamicArray<HMM_Mat4> matrices;
+
+	f32 checksum = 0.0f;
+	auto start = std::chrono::steady_clock::now();
+	for (i32 frame_idx = 0; frame_idx < clip.frame_count; ++frame_idx)
+	{
+		const BoundingBox pose_bounds = skinned_bounds_evaluate(mesh.bone_bounds.data(), bone_count, clip.frame(frame_idx), bone_count, mesh.mesh_to_armature, mesh.armature_to_mesh);
+		checksum += pose_bounds.max.X;
+	}
+	const f64 bone_box_ms = milliseconds_since(start) / clip.frame_count;
+
+	start = std::chrono::steady_clock::now();
+	for (i32 frame_idx = 0; frame_idx < clip.frame_count; ++frame_idx)
+	{
+		pack_skin_matrices(mesh, &clip, frame_idx, matrices);
+		BoundingBox vertex_bounds = bounding_box_init();
+		for (size_t vertex_idx = 0; vertex_idx < mesh.vertices.length(); ++vertex_idx)
+		{
+			bounding_box_expand(vertex_bounds, skin_vertex(mesh.vertices[vertex_idx], mesh.skinned_vertices[vertex_idx], matrices));
+		}
+		checksum += vertex_bounds.max.X;
+	}
+	const f64 vertex_ms = milliseconds_since(start) / clip.frame_count;
+
+	printf("pose bounds, %u bones / %u vertices: bone boxes %.4f ms, per-vertex skinning %.3f ms (checksum %.1f)\n",
+		bone_count, (u32) mesh.vertices.length(), bone_box_ms, vertex_ms, checksum);
+}
+
+int main()
+{
+	test_bone_boxes();
+	test_sampled_frames_contain_skinned_vertices();
+	test_rigid_single_bone_is_tight();
+	benchmark_pose_bounds();
+	printf("skinned bounds tests passed\n");
+	return 0;
+}
@@ -0,0 +1,292 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <thread>
+
+#include "core/task_graph.h"
+#include "core/worker_pool.h"
+#include "test_random.h"
+
+// Stands in for Jolt's JobSystemThreadPool: a FIFO drained by N threads
+struct TestJobQueue
+{
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<TaskGraphFunction> jobs;
+	DynamicArray<std::thread> threads;
+	bool stopping = false;
+
+	explicit TestJobQueue(i32 in_thread_count)
+	{
+		for (i32 thread_idx = 0; thread_idx < in_thread_count; ++thread_idx)
+		{
+			threads.emplace([this]()
+			{
+				while (true)
+				{
+					TaskGraphFunction job;
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						wake.wait(lock, [&]() { return stopping || !jobs.empty(); });
+						if (jobs.empty())
+						{
+							return;
+						}
+						job = std::move(jobs.front());
+						jobs.pop_front();
+					}
+					job();
+				}
+			});
+		}
+	}
+
+	~TestJobQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	TaskGraphDispatch dispatch()
+	{
+		return [this](const char*, const TaskGraphFunction& in_function)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				jobs.push_back(in_function);
+			}
+			wake.notify_one();
+		};
+	}
+};
+
+// Random DAG: each task checks that its dependencies finished before it
+// started and that main-thread tasks stay on the calling thread
+struct RandomGraphFixture
+{
+	DynamicArray<DynamicArray<u32>> dependencies;
+	DynamicArray<TaskAffinity> affinities;
+	DynamicArray<u32> done;	// atomic_ref
+	DynamicArray<u32> run_counts;
+	std::thread::id main_thread;
+
+	void build(Random& in_random, TaskGraph& in_graph, u32 in_task_count)
+	{
+		dependencies.resize(in_task_count);
+		affinities.resize(in_task_count);
+		done.resize(in_task_count);
+		run_counts.resize(in_task_count);
+		main_thread = std::this_thread::get_id();
+
+		task_graph_clear(in_graph);
+		for (u32 task_idx = 0; task_idx < in_task_count; ++task_idx)
+		{
+			done[task_idx] = 0;
+			run_counts[task_idx] = 0;
+			dependencies[task_idx].clear();
+			for (u32 earlier = 0; earlier < task_idx; ++earlier)
+			{
+				if (in_random.chance(task_idx < 8 ? 30 : 4))
+				{
+					dependencies[task_idx].add(earlier);
+				}
+			}
+			affinities[task_idx] = in_random.chance(20) ? TaskAffinity::MainThread : TaskAffinity::AnyThread;
+
+			const u32 task_id = task_graph_add(in_graph, "random", affinities[task_idx], [this, task_idx]()
+			{
+				for (u32 dependency : dependencies[task_idx])
+				{
+					assert(std::atomic_ref<u32>(done[dependency]).load(std::memory_order_acquire) == 1);
+				}
+				if (affinities[task_idx] == TaskAffinity::MainThread)
+				{
+					assert(std::this_thread::get_id() == main_thread);
+				}
+				run_counts[task_idx] += 1;
+				std::atomic_ref<u32>(done[task_idx]).store(1, std::memory_order_release);
+			});
+			assert(task_id == task_idx);
+			for (u32 dependency : dependencies[task_idx])
+			{
+				task_graph_add_dependency(in_graph, task_id, dependency);
+			}
+		}
+	}
+
+	void check_all_ran_once(const TaskGraph& in_graph)
+	{
+		for (u32 task_idx = 0; task_idx < run_counts.length(); ++task_idx)
+		{
+			assert(run_counts[task_idx] == 1);
+			const TaskGraphTask& task = in_graph.tasks[task_idx];
+			assert(task.start_ticks > 0 && task.end_ticks >= task.start_ticks);
+			for (u32 dependency : dependencies[task_idx])
+			{
+				assert(in_graph.tasks[dependency].end_ticks <= task.start_ticks);
+			}
+		}
+	}
+};
+
+static void test_serial_runs_in_dependency_order()
+{
+	TaskGraph graph;
+	DynamicArray<u32> order;
+	const u32 a = task_graph_add(graph, "a", TaskAffinity::AnyThread, [&]() { order.add(0); });
+	const u32 b = task_graph_add(graph, "b", TaskAffinity::MainThread, [&]() { order.add(1); }, { a });
+	const u32 c = task_graph_add(graph, "c", TaskAffinity::AnyThread, [&]() { order.add(2); }, { a });
+	task_graph_add(graph, "d", TaskAffinity::MainThread, [&]() { order.add(3); }, { b, c });
+
+	for (i32 run = 0; run < 2; ++run)
+	{
+		order.clear();
+		task_graph_run(graph, nullptr);
+		assert(order.length() == 4);
+		assert(order[0] == 0 && order[3] == 3);
+	}
+
+	// An empty graph returns straight away
+	task_graph_clear(graph);
+	task_graph_run(graph, nullptr);
+}
+
+static void test_random_graphs(TestJobQueue& in_queue)
+{
+	Random random;
+	TaskGraph graph;
+	RandomGraphFixture fixture;
+	const TaskGraphDispatch dispatch = in_queue.dispatch();
+	for (i32 run = 0; run < 300; ++run)
+	{
+		fixture.build(random, graph, 1 + random.next() % 64);
+		task_graph_run(graph, run % 5 == 0 ? nullptr : dispatch);
+		fixture.check_all_ran_once(graph);
+	}
+}
+
+// Independent tasks overlap: four 20 ms waits on four threads take well
+// under the 80 ms they would take in a row
+static void test_independent_tasks_overlap(TestJobQueue& in_queue)
+{
+	TaskGraph graph;
+	const u32 start = task_graph_add(graph, "start", TaskAffinity::MainThread, []() {});
+	u32 waits[4];
+	for (u32& wait : waits)
+	{
+		wait = task_graph_add(graph, "wait", TaskAffinity::AnyThread, []()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}, { start });
+	}
+	task_graph_add(graph, "join", TaskAffinity::MainThread, []() {}, { waits[0], waits[1], waits[2], waits[3] });
+
+	const TaskGraphDispatch dispatch = in_queue.dispatch();
+	const auto begin = std::chrono::steady_clock::now();
+	task_graph_run(graph, dispatch);
+	const f64 elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	printf("four 20 ms tasks on four threads: %.1f ms\n", elapsed_ms);
+	assert(elapsed_ms < 60.0);
+}
+
+// Per-run overhead for a frame-sized graph of empty tasks
+static void benchmark_frame_graph(TestJobQueue& in_queue)
+{
+	TaskGraph graph;
+	const TaskGraphDispatch dispatch = in_queue.dispatch();
+	for (const TaskGraphDispatch* run_dispatch : { (const TaskGraphDispatch*) nullptr, &dispatch })
+	{
+		const i32 runs = 2000;
+		const auto begin = std::chrono::steady_clock::now();
+		for (i32 run = 0; run < runs; ++run)
+		{
+			task_graph_clear(graph);
+			const u32 live_link = task_graph_add(graph, "Live Link", TaskAffinity::MainThread, []() {});
+			const u32 controls = task_graph_add(graph, "Controls", TaskAffinity::MainThread, []() {}, { live_link });
+			const u32 physics = task_graph_add(graph, "Physics", TaskAffinity::MainThread, []() {}, { controls });
+			const u32 animation = task_graph_add(graph, "Animation", TaskAffinity::AnyThread, []() {}, { controls });
+			const u32 transforms = task_graph_add(graph, "Transforms", TaskAffinity::MainThread, []() {}, { physics, animation });
+			const u32 snapshot = task_graph_add(graph, "Snapshot", TaskAffinity::AnyThread, []() {}, { transforms });
+			const u32 lights = task_graph_add(graph, "Lights", TaskAffinity::AnyThread, []() {}, { transforms });
+			const u32 skin = task_graph_add(graph, "Skin", TaskAffinity::AnyThread, []() {}, { transforms });
+			const u32 upload = task_graph_add(graph, "Upload", TaskAffinity::MainThread, []() {}, { snapshot, lights, skin });
+			task_graph_add(graph, "Render", TaskAffinity::MainThread, []() {}, { upload });
+			task_graph_run(graph, run_dispatch ? *run_dispatch : TaskGraphDispatch());
+		}
+		const f64 elapsed_us = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - begin).count();
+		printf("10-task frame graph (%s): %.2f us per run\n", run_dispatch ? "dispatched" : "serial", elapsed_us / runs);
+	}
+}
+
+// WorkerPool loops shared onto the queue run every index once, also when
+// each queue thread is itself inside a loop and no queued helper can start
+static void test_shared_worker_pool(TestJobQueue& in_queue)
+{
+	worker_pool_share(in_queue.dispatch(), 4);
+	WorkerPool pools[5];
+	for (WorkerPool& pool : pools)
+	{
+		pool.start_shared();
+	}
+	assert(pools[0].worker_count() == 4);
+
+	DynamicArray<u32> hits;
+	hits.resize(10000);
+	for (i32 run = 0; run < 50; ++run)
+	{
+		for (u32& hit : hits)
+		{
+			hit = 0;
+		}
+		pools[0].parallel_for((u32) hits.length(), [&](u32 in_index)
+		{
+			std::atomic_ref<u32>(hits[in_index]).fetch_add(1, std::memory_order_relaxed);
+		}, 16);
+		for (u32 hit : hits)
+		{
+			assert(hit == 1);
+		}
+	}
+
+	std::atomic<u32> inner_total = 0;
+	for (i32 run = 0; run < 50; ++run)
+	{
+		inner_total = 0;
+		pools[0].parallel_for(4, [&](u32 in_outer)
+		{
+			pools[1 + in_outer].parallel_for(1000, [&](u32)
+			{
+				inner_total.fetch_add(1, std::memory_order_relaxed);
+			}, 8);
+		});
+		assert(inner_total.load() == 4000);
+	}
+
+	for (WorkerPool& pool : pools)
+	{
+		pool.stop();
+	}
+	worker_pool_share({}, 0);
+}
+
+int main()
+{
+	TestJobQueue queue(4);
+
+	test_serial_runs_in_dependency_order();
+	test_random_graphs(queue);
+	test_independent_tasks_overlap(queue);
+	test_shared_worker_pool(queue);
+	benchmark_frame_graph(queue);
+
+	printf("task_graph_tests passed\n");
+	return 0;
+}
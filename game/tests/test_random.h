@@ -0,0 +1,23 @@
+#pragma once
+
+#include "core/types.h"
+
+// Deterministic xorshift generator shared by the randomized tests, so every
+// run checks the same cases
+struct Random
+{
+	u64 state = 0x9E3779B97F4A7C15ull;
+
+	u32 next()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (u32) (state >> 32);
+	}
+
+	f32 unit() { return (f32) (next() >> 8) * (1.0f / 16777216.0f); }
+	f32 signed_unit() { return unit() * 2.0f - 1.0f; }
+	f32 range(f32 in_min, f32 in_max) { return in_min + (in_max - in_min) * unit(); }
+	bool chance(u32 in_percent) { return next() % 100 < in_percent; }
+};
@@ -0,0 +1,450 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "core/types.h"
+#include "render/texture_processing.h"
+#include "test_random.h"
+
+// ---- Reference decoders (straight from the format descriptions) ----
+
+static void decode_bc4_block(const u8 in_block[8], u8 out_values[16])
+{
+	const u32 red0 = in_block[0];
+	const u32 red1 = in_block[1];
+	u32 palette[8] = { red0, red1 };
+	for (u32 entry = 2; entry < 8; ++entry)
+	{
+		palette[entry] = red0 > red1
+			? ((8 - entry) * red0 + (entry - 1) * red1) / 7
+			: (entry < 6 ? ((6 - entry) * red0 + (entry - 1) * red1) / 5 : (entry == 6 ? 0 : 255));
+	}
+	u64 index_bits = 0;
+	for (u32 byte = 0; byte < 6; ++byte)
+	{
+		index_bits |= (u64) in_block[2 + byte] << (8 * byte);
+	}
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		out_values[texel] = (u8) palette[(index_bits >> (3 * texel)) & 7];
+	}
+}
+
+static void decode_bc7_mode6_block(const u8 in_block[16], u8 out_texels[16][4])
+{
+	u32 bit = 0;
+	auto read_bits = [&](u32 in_count)
+	{
+		u32 value = 0;
+		for (u32 bit_index = 0; bit_index < in_count; ++bit_index, ++bit)
+		{
+			value |= ((in_block[bit / 8] >> (bit % 8)) & 1u) << bit_index;
+		}
+		return value;
+	};
+	assert(read_bits(7) == (1u << 6));
+	u32 endpoints[2][4];
+	for (u32 channel = 0; channel < 4; ++channel)
+	{
+		endpoints[0][channel] = read_bits(7);
+		endpoints[1][channel] = read_bits(7);
+	}
+	const u32 p_bits[2] = { read_bits(1), read_bits(1) };
+	for (u32 endpoint = 0; endpoint < 2; ++endpoint)
+	{
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			endpoints[endpoint][channel] = (endpoints[endpoint][channel] << 1) | p_bits[endpoint];
+		}
+	}
+	for (u32 texel = 0; texel < 16; ++texel)
+	{
+		const u32 weight = TEXTURE_BC7_WEIGHTS_4[read_bits(texel == 0 ? 3 : 4)];
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			out_texels[texel][channel] = (u8) (((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6);
+		}
+	}
+	assert(bit == 128);
+}
+
+// Decodes level 0 of a BC7 texture back to RGBA8
+static DynamicArray<u8> decode_bc7_level(const u8* in_data, const u32 in_width, const u32 in_height)
+{
+	DynamicArray<u8> rgba;
+	rgba.resize((size_t) in_width * in_height * 4);
+	const u32 blocks_x = (in_width + 3) / 4;
+	for (u32 block_y = 0; block_y < (in_height + 3) / 4; ++block_y)
+	{
+		for (u32 block_x = 0; block_x < blocks_x; ++block_x)
+		{
+			u8 texels[16][4];
+			decode_bc7_mode6_block(in_data + ((size_t) block_y * blocks_x + block_x) * 16, texels);
+			for (u32 texel = 0; texel < 16; ++texel)
+			{
+				const u32 x = block_x * 4 + texel % 4;
+				const u32 y = block_y * 4 + texel / 4;
+				if (x < in_width && y < in_height)
+				{
+					memcpy(&rgba[((size_t) y * in_width + x) * 4], texels[texel], 4);
+				}
+			}
+		}
+	}
+	return rgba;
+}
+
+static f64 psnr(const u8* in_a, const u8* in_b, const size_t in_count)
+{
+	f64 squared_error = 0.0;
+	for (size_t value = 0; value < in_count; ++value)
+	{
+		const f64 delta = (f64) in_a[value] - (f64) in_b[value];
+		squared_error += delta * delta;
+	}
+	if (squared_error == 0.0)
+	{
+		return 99.0;
+	}
+	return 10.0 * log10(255.0 * 255.0 / (squared_error / (f64) in_count));
+}
+
+static DynamicArray<u8> make_image(const u32 in_width, const u32 in_height, u8 (*in_texel)(u32, u32, u32))
+{
+	DynamicArray<u8> rgba;
+	rgba.resize((size_t) in_width * in_height * 4);
+	for (u32 y = 0; y < in_height; ++y)
+	{
+		for (u32 x = 0; x < in_width; ++x)
+		{
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				rgba[((size_t) y * in_width + x) * 4 + channel] = in_texel(x, y, channel);
+			}
+		}
+	}
+	return rgba;
+}
+
+static void test_layout()
+{
+	assert(texture_mip_count(1, 1) == 1);
+	assert(texture_mip_count(256, 256) == 9);
+	assert(texture_mip_count(300, 17) == 9);
+	assert(texture_mip_extent(300, 3) == 37 && texture_mip_extent(17, 5) == 1 && texture_mip_extent(17, 8) == 1);
+
+	assert(texture_level_bytes(TextureEncoding::RGBA8, 5, 3) == 60);
+	assert(texture_level_bytes(TextureEncoding::R8, 5, 3) == 15);
+	assert(texture_level_bytes(TextureEncoding::BC7_SRGB, 5, 3) == 2 * 16);
+	assert(texture_level_bytes(TextureEncoding::BC4, 1, 1) == 8);
+	assert(texture_chain_bytes(TextureEncoding::RGBA8, 4, 4, 3) == 64 + 16 + 4);
+	assert(texture_chain_bytes(TextureEncoding::BC7, 8, 8, 4) == 4 * 16 + 16 + 16 + 16);
+
+	assert(texture_choose_encoding(TEXTURE_USAGE_COLOR, false) == TextureEncoding::RGBA8_SRGB);
+	assert(texture_choose_encoding(TEXTURE_USAGE_COLOR, true) == TextureEncoding::BC7_SRGB);
+	assert(texture_choose_encoding(TEXTURE_USAGE_DATA, false) == TextureEncoding::R8);
+	assert(texture_choose_encoding(TEXTURE_USAGE_DATA, true) == TextureEncoding::BC4);
+	assert(texture_choose_encoding(TEXTURE_USAGE_COLOR | TEXTURE_USAGE_DATA, true) == TextureEncoding::BC7);
+	assert(texture_choose_encoding(0, false) == TextureEncoding::RGBA8);
+	assert(texture_cache_key(7, TextureEncoding::RGBA8) != texture_cache_key(7, TextureEncoding::BC7));
+
+	for (u32 value = 0; value < 256; ++value)
+	{
+		const f32 linear = (f32) value / 255.0f;
+		assert(fabsf(texture_srgb_to_linear(texture_linear_to_srgb(linear)) - linear) < 1e-4f);
+	}
+}
+
+// Weights of every destination texel sum to one and every source texel
+// contributes the same total, so a level keeps the mean of the one above
+static void test_filter_taps()
+{
+	for (u32 src_size = 1; src_size < 40; ++src_size)
+	{
+		const u32 dst_size = MAX(src_size / 2, 1u);
+		DynamicArray<f32> coverage;
+		coverage.resize(src_size, 0.0f);
+		for (u32 index = 0; index < dst_size; ++index)
+		{
+			const TextureFilterTaps taps = texture_filter_taps(src_size, index);
+			f32 total = 0.0f;
+			for (u32 tap = 0; tap < taps.count; ++tap)
+			{
+				assert(taps.first + tap < src_size);
+				total += taps.weights[tap];
+				coverage[taps.first + tap] += taps.weights[tap];
+			}
+			assert(fabsf(total - 1.0f) < 1e-5f);
+		}
+		for (u32 texel = 0; texel < src_size; ++texel)
+		{
+			assert(fabsf(coverage[texel] - (f32) dst_size / (f32) src_size) < 1e-5f);
+		}
+	}
+}
+
+static void test_mips_keep_the_mean()
+{
+	const u32 sizes[][2] = { { 64, 64 }, { 37, 21 }, { 5, 1 } };
+	for (const auto& size : sizes)
+	{
+		DynamicArray<u8> image = make_image(size[0], size[1], [](u32 in_x, u32 in_y, u32 in_channel)
+		{
+			return (u8) ((in_x * 37 + in_y * 11 + in_channel * 64) & 255);
+		});
+		ProcessedTexture texture;
+		texture_process(image.data(), size[0], size[1], TextureEncoding::RGBA8, texture, nullptr);
+		assert(texture.mip_count == texture_mip_count(size[0], size[1]));
+		assert(texture.data.length() == texture_chain_bytes(TextureEncoding::RGBA8, size[0], size[1], texture.mip_count));
+		assert(memcmp(texture.data.data(), image.data(), image.length()) == 0);
+
+		f64 source_mean[4] = {};
+		for (size_t texel = 0; texel < (size_t) size[0] * size[1]; ++texel)
+		{
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				source_mean[channel] += image[texel * 4 + channel] / (f64) (size[0] * size[1]);
+			}
+		}
+		const u8* last = texture.data.data() + texture.data.length() - 4;
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			assert(fabs((f64) last[channel] - source_mean[channel]) <= 1.0);
+		}
+	}
+}
+
+static void test_srgb_mips_filter_in_linear()
+{
+	// Linear black/white checker: the 1x1 mip is linear 0.5, which sRGB stores as 188
+	DynamicArray<u8> image = make_image(2, 2, [](u32 in_x, u32 in_y, u32 in_channel)
+	{
+		return in_channel == 3 ? (u8) 255 : (u8) (((in_x + in_y) & 1) * 255);
+	});
+	ProcessedTexture texture;
+	texture_process(image.data(), 2, 2, TextureEncoding::RGBA8_SRGB, texture, nullptr);
+	assert(texture.mip_count == 2 && texture.data.length() == 20);
+	assert(texture.data[0] == 0 && texture.data[4] == 255 && texture.data[7] == 255);
+	const u8* mip = texture.data.data() + 16;
+	assert(mip[0] == 188 && mip[1] == 188 && mip[2] == 188 && mip[3] == 255);
+
+	// Level 0 of a color image round-trips through sRGB within half an sRGB
+	// step, which is at most ~1.14 linear steps (at white)
+	DynamicArray<u8> ramp = make_image(16, 16, [](u32 in_x, u32 in_y, u32)
+	{
+		return (u8) (in_y * 16 + in_x);
+	});
+	texture_process(ramp.data(), 16, 16, TextureEncoding::RGBA8_SRGB, texture, nullptr);
+	for (size_t value = 0; value < 16 * 16 * 4; ++value)
+	{
+		if (value % 4 == 3)
+		{
+			assert(texture.data[value] == ramp[value]);
+			continue;
+		}
+		const f32 decoded = texture_srgb_to_linear((f32) texture.data[value] / 255.0f) * 255.0f;
+		assert(fabsf(decoded - (f32) ramp[value]) <= 1.15f);
+	}
+}
+
+static void test_red_only()
+{
+	DynamicArray<u8> image = make_image(8, 4, [](u32 in_x, u32 in_y, u32 in_channel)
+	{
+		return in_channel == 0 ? (u8) (in_x * 30 + in_y) : (u8) 200;
+	});
+	ProcessedTexture texture;
+	texture_process(image.data(), 8, 4, TextureEncoding::R8, texture, nullptr);
+	assert(texture.mip_count == 4 && texture.data.length() == 32 + 8 + 2 + 1);
+	for (u32 texel = 0; texel < 32; ++texel)
+	{
+		assert(texture.data[texel] == image[texel * 4]);
+	}
+
+	// BC4 error is bounded by half a palette step
+	Random random;
+	for (u32 trial = 0; trial < 2000; ++trial)
+	{
+		u8 values[16];
+		const u32 low = random.next() % 256;
+		const u32 range = trial % 4 == 0 ? 0 : random.next() % (256 - low);
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			values[texel] = (u8) (low + (range ? random.next() % (range + 1) : 0));
+		}
+		u8 block[8];
+		u8 decoded[16];
+		texture_encode_bc4_block(values, block);
+		decode_bc4_block(block, decoded);
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			assert((f32) abs((i32) decoded[texel] - (i32) values[texel]) <= (f32) range / 14.0f + 1.0f);
+		}
+	}
+}
+
+static void test_bc7_blocks()
+{
+	Random random;
+	for (u32 trial = 0; trial < 500; ++trial)
+	{
+		// A flat block, and one with two colors
+		u8 colors[2][4];
+		for (u32 channel = 0; channel < 4; ++channel)
+		{
+			colors[0][channel] = (u8) random.next();
+			colors[1][channel] = (u8) random.next();
+		}
+		for (u32 color_count = 1; color_count <= 2; ++color_count)
+		{
+			u8 texels[16][4];
+			for (u32 texel = 0; texel < 16; ++texel)
+			{
+				memcpy(texels[texel], colors[color_count == 2 ? random.next() % 2 : 0], 4);
+			}
+			u8 block[16];
+			u8 decoded[16][4];
+			texture_encode_bc7_block(texels, block);
+			decode_bc7_mode6_block(block, decoded);
+			for (u32 texel = 0; texel < 16; ++texel)
+			{
+				for (u32 channel = 0; channel < 4; ++channel)
+				{
+					assert(abs((i32) decoded[texel][channel] - (i32) texels[texel][channel]) <= 1);
+				}
+			}
+		}
+
+		// Noise: never worse than the block's average color
+		u8 texels[16][4];
+		f64 mean[4] = {};
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				texels[texel][channel] = (u8) random.next();
+				mean[channel] += texels[texel][channel] / 16.0;
+			}
+		}
+		f64 flat_error = 0.0;
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				const f64 delta = texels[texel][channel] - mean[channel];
+				flat_error += delta * delta;
+			}
+		}
+		u8 block[16];
+		u8 decoded[16][4];
+		texture_encode_bc7_block(texels, block);
+		decode_bc7_mode6_block(block, decoded);
+		f64 error = 0.0;
+		for (u32 texel = 0; texel < 16; ++texel)
+		{
+			for (u32 channel = 0; channel < 4; ++channel)
+			{
+				const f64 delta = (f64) decoded[texel][channel] - texels[texel][channel];
+				error += delta * delta;
+			}
+		}
+		// Endpoint quantization can cost up to a step per channel
+		assert(error <= flat_error + 16.0 * 4.0);
+	}
+}
+
+static void test_bc7_image_quality()
+{
+	const u32 width = 256;
+	const u32 height = 256;
+	DynamicArray<u8> image = make_image(width, height, [](u32 in_x, u32 in_y, u32 in_channel)
+	{
+		const f32 u = (f32) in_x / 255.0f;
+		const f32 v = (f32) in_y / 255.0f;
+		switch (in_channel)
+		{
+			case 0: return (u8) (127.5f + 127.5f * sinf(u * 9.0f + v * 3.0f));
+			case 1: return (u8) (255.0f * u * v);
+			case 2: return (u8) (127.5f + 127.5f * cosf(v * 7.0f));
+			default: return (u8) (255.0f - 128.0f * u);
+		}
+	});
+
+	WorkerPool workers;
+	workers.start(WorkerPool::default_worker_count());
+	ProcessedTexture texture;
+	const auto start = std::chrono::steady_clock::now();
+	texture_process(image.data(), width, height, TextureEncoding::BC7, texture, &workers);
+	const f64 seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+	assert(texture.mip_count == 9);
+	assert(texture.data.length() == texture_chain_bytes(TextureEncoding::BC7, width, height, 9));
+
+	DynamicArray<u8> decoded = decode_bc7_level(texture.data.data(), width, height);
+	const f64 quality = psnr(decoded.data(), image.data(), image.length());
+	assert(quality >= 40.0);
+
+	// Same result with and without workers
+	ProcessedTexture serial;
+	texture_process(image.data(), width, height, TextureEncoding::BC7, serial, nullptr);
+	assert(serial.data.length() == texture.data.length());
+	assert(memcmp(serial.data.data(), texture.data.data(), serial.data.length()) == 0);
+
+	// Odd sizes: partial edge blocks and 1x1 tail mips
+	DynamicArray<u8> odd = make_image(13, 7, [](u32 in_x, u32 in_y, u32 in_channel)
+	{
+		return (u8) (in_x * 19 + in_y * 5 + in_channel * 40);
+	});
+	texture_process(odd.data(), 13, 7, TextureEncoding::BC7_SRGB, texture, &workers);
+	assert(texture.mip_count == 4);
+	assert(texture.data.length() == (u64) (4 * 2 + 2 + 1 + 1) * 16);
+	workers.stop();
+
+	printf("bc7 256x256 chain: %.1f dB, %.2f ms (%.1f Mtexel/s)\n",
+		quality, seconds * 1000.0, (f64) width * height * 4.0 / 3.0 / seconds / 1e6);
+}
+
+static void test_cache()
+{
+	auto make_texture = [](u32 in_bytes)
+	{
+		ProcessedTexture texture;
+		texture.data.resize(in_bytes);
+		return texture;
+	};
+
+	TextureCache cache;
+	cache.budget_bytes = 100;
+	assert(texture_cache_find(cache, 1) == nullptr && cache.misses == 1);
+	texture_cache_insert(cache, 1, make_texture(40));
+	texture_cache_insert(cache, 2, make_texture(40));
+	assert(cache.byte_count == 80);
+
+	// Touching 1 makes 2 the oldest
+	assert(texture_cache_find(cache, 1) != nullptr && cache.hits == 1);
+	texture_cache_insert(cache, 3, make_texture(40));
+	assert(cache.byte_count == 80);
+	assert(texture_cache_find(cache, 2) == nullptr);
+	assert(texture_cache_find(cache, 1) && texture_cache_find(cache, 3));
+
+	// Replacing an entry frees its old size; an oversized one stays alone
+	texture_cache_insert(cache, 3, make_texture(10));
+	assert(cache.byte_count == 50);
+	const ProcessedTexture& large = texture_cache_insert(cache, 4, make_texture(500));
+	assert(large.data.length() == 500);
+	assert(cache.entries.size() == 1 && cache.byte_count == 500);
+}
+
+int main()
+{
+	test_layout();
+	test_filter_taps();
+	test_mips_keep_the_mean();
+	test_srgb_mips_filter_in_linear();
+	test_red_only();
+	test_bc7_blocks();
+	test_bc7_image_quality();
+	test_cache();
+	printf("texture_processing_tests passed\n");
+	return 0;
+}
@@ -0,0 +1,301 @@
+#include <cassert>
+#include <cstdio>
+
+#include "core/types.h"
+#include "render/texture_streaming.h"
+
+// A stand-in for the GPU side: uploads take a fixed number of frames, the
+// shader reports a fixed lod per texture, and the allocation total is checked
+// against the budget every frame.
+struct SimulatedDevice
+{
+	struct Upload
+	{
+		u32 texture_index;
+		u64 ready_frame;
+	};
+
+	DynamicArray<Upload> uploads;
+	DynamicArray<TextureStreamRequest> requests;
+	u64 upload_frames = 3;
+	u64 frame = 0;
+};
+
+static void simulate_frame(
+	TextureStreaming& io_streaming,
+	SimulatedDevice& io_device,
+	const u32* in_feedback,
+	const u64 in_budget_bytes,
+	const u64 in_frame_byte_limit)
+{
+	const u64 frame = io_device.frame;
+	DynamicArray<u8> bound_mips;
+	for (const TextureResidency& texture : io_streaming.textures)
+	{
+		bound_mips.add((u8) texture.resident_mip);
+	}
+
+	DynamicArray<SimulatedDevice::Upload> still_running;
+	for (const SimulatedDevice::Upload& upload : io_device.uploads)
+	{
+		if (upload.ready_frame <= frame)
+		{
+			texture_streaming_complete(io_streaming, upload.texture_index, frame, (f64) frame / 60.0);
+		}
+		else
+		{
+			still_running.add(upload);
+		}
+	}
+	io_device.uploads = still_running;
+
+	if (in_feedback)
+	{
+		texture_streaming_record_feedback(io_streaming, in_feedback, bound_mips.data(),
+			(u32) io_streaming.textures.length(), frame, (f64) frame / 60.0);
+	}
+	texture_streaming_plan(io_streaming, in_budget_bytes, in_frame_byte_limit, io_device.requests);
+	for (const TextureStreamRequest& request : io_device.requests)
+	{
+		assert(request.byte_count == texture_residency_bytes(io_streaming.textures[request.texture_index], request.first_mip));
+		io_device.uploads.add((SimulatedDevice::Upload) {
+			.texture_index = request.texture_index,
+			.ready_frame = frame + io_device.upload_frames,
+		});
+	}
+	texture_streaming_end_frame(io_streaming, frame);
+	io_device.frame += 1;
+}
+
+// Feedback value for a screen-space lod relative to the bound image
+static u32 feedback_for(const TextureResidency& in_texture, const i32 in_full_chain_level)
+{
+	return (u32) (in_full_chain_level - (i32) in_texture.resident_mip + (i32) TEXTURE_FEEDBACK_LOD_BIAS);
+}
+
+static void test_add_starts_at_tail()
+{
+	TextureStreaming streaming;
+	const u32 first = texture_streaming_add(streaming, 1024, 512, texture_mip_count(1024, 512), TextureEncoding::BC7, true);
+	assert(first == 4);	// 64 x 32
+	assert(streaming.textures[0].tail_mip == 4);
+	assert(streaming.resident_bytes == texture_residency_bytes(streaming.textures[0], 4));
+
+	const u32 small = texture_streaming_add(streaming, 32, 32, texture_mip_count(32, 32), TextureEncoding::RGBA8, true);
+	assert(small == 0);
+
+	const u32 full = texture_streaming_add(streaming, 1024, 1024, texture_mip_count(1024, 1024), TextureEncoding::RGBA8, false);
+	assert(full == 0);
+
+	// Offsets and sizes tile the packed chain
+	const TextureResidency& texture = streaming.textures[0];
+	const u64 chain = texture_chain_bytes(texture.encoding, texture.width, texture.height, texture.mip_count);
+	for (u32 mip = 0; mip < texture.mip_count; ++mip)
+	{
+		assert(texture_residency_offset(texture, mip) + texture_residency_bytes(texture, mip) == chain);
+	}
+	printf("add starts at tail: ok\n");
+}
+
+static void test_feedback_levels()
+{
+	TextureStreaming streaming;
+	texture_streaming_add(streaming, 1024, 1024, texture_mip_count(1024, 1024), TextureEncoding::RGBA8, true);
+	TextureResidency& texture = streaming.textures[0];
+	assert(texture.tail_mip == 4);
+
+	// lod -2 against the mip-4 image: full-chain level 2
+	u32 feedback = TEXTURE_FEEDBACK_LOD_BIAS - 2;
+	u8 bound = 4;
+	texture_streaming_record_feedback(streaming, &feedback, &bound, 1, 10, 0.0);
+	assert(texture.demand_mip == 2);
+	assert(texture.last_sampled_frame == 10);
+	assert(texture.demand_frame == 10);
+
+	// Magnified past level 0 clamps to 0; coarser than the tail clamps to the tail
+	feedback = 0;
+	texture_streaming_record_feedback(streaming, &feedback, &bound, 1, 11, 0.0);
+	assert(texture.demand_mip == 0);
+	assert(texture.demand_frame == 10);
+
+	// Unsampled slots and slots showing the placeholder are ignored
+	feedback = TEXTURE_FEEDBACK_UNSAMPLED;
+	texture_streaming_record_feedback(streaming, &feedback, &bound, 1, 12, 0.0);
+	assert(texture.last_sampled_frame == 11);
+	feedback = TEXTURE_FEEDBACK_LOD_BIAS;
+	bound = TEXTURE_FEEDBACK_NOT_BOUND;
+	texture_streaming_record_feedback(streaming, &feedback, &bound, 1, 13, 0.0);
+	assert(texture.last_sampled_frame == 11);
+	printf("feedback levels: ok\n");
+}
+
+static void test_stream_in_and_latency()
+{
+	TextureStreaming streaming;
+	for (u32 index = 0; index < 4; ++index)
+	{
+		texture_streaming_add(streaming, 512, 512, texture_mip_count(512, 512), TextureEncoding::RGBA8, true);
+	}
+
+	SimulatedDevice device;
+	const u64 budget = 64ull << 20;
+	u32 feedback[4];
+	for (u32 frame = 0; frame < 20; ++frame)
+	{
+		for (u32 index = 0; index < 4; ++index)
+		{
+			feedback[index] = feedback_for(streaming.textures[index], 0);
+		}
+		simulate_frame(streaming, device, feedback, budget, ~0ull);
+	}
+
+	for (const TextureResidency& texture : streaming.textures)
+	{
+		assert(texture.resident_mip == 0);
+		assert(texture.target_mip == 0);
+	}
+	assert(streaming.pending_bytes == 0);
+	assert(streaming.stats.stream_in_count == 4);
+	assert(streaming.stats.eviction_count == 0);
+	assert(streaming.latency_frames.length() == 4);
+	// Demand seen on frame 0, requested the same frame, bound three frames later
+	assert(texture_streaming_percentile(streaming.latency_frames, 0.5f) == 3.0f);
+	assert(std::fabs(texture_streaming_percentile(streaming.latency_ms, 0.95f) - 50.0f) < 0.01f);
+	printf("stream in and latency: ok\n");
+}
+
+static void test_budget_is_respected()
+{
+	TextureStreaming streaming;
+	const u32 texture_count = 16;
+	for (u32 index = 0; index < texture_count; ++index)
+	{
+		texture_streaming_add(streaming, 1024, 1024, texture_mip_count(1024, 1024), TextureEncoding::RGBA8, true);
+	}
+
+	// Room for about three full chains
+	const u64 full_chain = texture_residency_bytes(streaming.textures[0], 0);
+	const u64 budget = full_chain * 3;
+	SimulatedDevice device;
+	DynamicArray<u32> feedback;
+	feedback.resize(texture_count);
+
+	// Everything wants level 0 on and off: the camera sweeps across groups
+	for (u32 frame = 0; frame < 600; ++frame)
+	{
+		const u32 group = (frame / 90) % 4;
+		for (u32 index = 0; index < texture_count; ++index)
+		{
+			const bool visible = index / 4 == group || index == 0;
+			feedback[index] = visible ? feedback_for(streaming.textures[index], 0) : TEXTURE_FEEDBACK_UNSAMPLED;
+		}
+		simulate_frame(streaming, device, feedback.data(), budget, full_chain);
+
+		assert(streaming.resident_bytes + streaming.pending_bytes <= budget);
+	}
+
+	assert(streaming.stats.peak_bytes <= budget);
+	assert(streaming.stats.over_budget_frames == 0);
+	assert(streaming.stats.stream_in_count > texture_count);
+	assert(streaming.stats.eviction_count > 0);
+	// Texture 0 is always visible, so it is never the one to give way
+	assert(streaming.textures[0].resident_mip <= 1);
+	printf("budget respected: peak %.1f / %.1f MiB, %llu stream-ins, %llu evictions, p95 latency %.0f frames\n",
+		(f64) streaming.stats.peak_bytes / (1024.0 * 1024.0), (f64) budget / (1024.0 * 1024.0),
+		(unsigned long long) streaming.stats.stream_in_count, (unsigned long long) streaming.stats.eviction_count,
+		texture_streaming_percentile(streaming.latency_frames, 0.95f));
+}
+
+static void test_least_recent_gives_way()
+{
+	TextureStreaming streaming;
+	texture_streaming_add(streaming, 1024, 1024, texture_mip_count(1024, 1024), TextureEncoding::RGBA8, true);
+	texture_streaming_add(streaming, 1024, 1024, texture_mip_count(1024, 1024), TextureEncoding::RGBA8, true);
+	const u64 full_chain = texture_residency_bytes(streaming.textures[0], 0);
+	const u64 half_chain = texture_residency_bytes(streaming.textures[0], 1);
+
+	// Both sampled at level 0, texture 1 more recently
+	streaming.textures[0].demand_mip = 0;
+	streaming.textures[0].last_sampled_frame = 5;
+	streaming.textures[1].demand_mip = 0;
+	streaming.textures[1].last_sampled_frame = 6;
+
+	DynamicArray<TextureStreamRequest> requests;
+	texture_streaming_plan(streaming, full_chain + half_chain, ~0ull, requests);
+	// Only one stream-in fits next to the other's tail; it goes to texture 1
+	assert(requests.length() == 1);
+	assert(requests[0].texture_index == 1);
+	assert(requests[0].first_mip == 0);
+	assert(streaming.wanted_mips[0] == 1);
+
+	// Shrinking the budget after the fact evicts, even past the budget when
+	// nothing else is in flight
+	texture_streaming_complete(streaming, 1, 7, 0.0);
+	texture_streaming_plan(streaming, half_chain, ~0ull, requests);
+	assert(requests.length() == 1);
+	assert(requests[0].texture_index == 1);
+	assert(requests[0].first_mip > 0);
+	texture_streaming_complete(streaming, 1, 8, 0.0);
+	assert(streaming.stats.eviction_count == 1);
+	printf("least recent gives way: ok\n");
+}
+
+static void test_window_hysteresis()
+{
+	TextureStreaming streaming;
+	texture_streaming_add(streaming, 256, 256, texture_mip_count(256, 256), TextureEncoding::RGBA8, true);
+	SimulatedDevice device;
+	device.upload_frames = 1;
+	u32 feedback = 0;
+
+	for (u32 frame = 0; frame < 10; ++frame)
+	{
+		feedback = feedback_for(streaming.textures[0], 0);
+		simulate_frame(streaming, device, &feedback, ~0ull, ~0ull);
+	}
+	assert(streaming.textures[0].resident_mip == 0);
+
+	// Seen no more: kept through the current and the next window, then evicted
+	u64 evicted_frame = 0;
+	for (u32 frame = 0; frame < 3 * TextureStreaming::window_frames && evicted_frame == 0; ++frame)
+	{
+		feedback = TEXTURE_FEEDBACK_UNSAMPLED;
+		simulate_frame(streaming, device, &feedback, ~0ull, ~0ull);
+		if (streaming.textures[0].resident_mip == streaming.textures[0].tail_mip)
+		{
+			evicted_frame = device.frame;
+		}
+	}
+	assert(evicted_frame > TextureStreaming::window_frames);
+	printf("window hysteresis: ok\n");
+}
+
+static void test_effective_budget()
+{
+	TextureStreaming streaming;
+	texture_streaming_add(streaming, 256, 256, texture_mip_count(256, 256), TextureEncoding::RGBA8, true);
+	const u64 tail = streaming.resident_bytes;
+
+	// No heap information: the configured budget
+	assert(texture_streaming_effective_budget(streaming, 100 << 20, 0, 0) == 100 << 20);
+	// Heap has 1000 MiB, 600 MiB used of which the textures are a sliver
+	const u64 mib = 1 << 20;
+	const u64 capped = texture_streaming_effective_budget(streaming, 1000 * mib, 1000 * mib, 600 * mib);
+	assert(capped == (1000 * mib - (600 * mib - tail)) / 10 * 9);
+	// Never below the tails
+	assert(texture_streaming_effective_budget(streaming, 1, 1000 * mib, 2000 * mib) == tail);
+	printf("effective budget: ok\n");
+}
+
+int main()
+{
+	test_add_starts_at_tail();
+	test_feedback_levels();
+	test_stream_in_and_latency();
+	test_budget_is_respected();
+	test_least_recent_gives_way();
+	test_window_hysteresis();
+	test_effective_budget();
+	printf("all texture streaming tests passed\n");
+	return 0;
+}
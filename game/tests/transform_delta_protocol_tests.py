@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""FlatBuffers round-trip coverage for transform-only live-link updates."""
+
+import pathlib
+import sys
+import unittest
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parents[2]
+sys.path.insert(0, str(REPO_ROOT))
+
+from compiled_schemas.python import flatbuffers
+from compiled_schemas.python.Blender.LiveLink import Mesh
+from compiled_schemas.python.Blender.LiveLink import Object
+from compiled_schemas.python.Blender.LiveLink import ObjectTransform
+from compiled_schemas.python.Blender.LiveLink import Quat
+from compiled_schemas.python.Blender.LiveLink import Update
+from compiled_schemas.python.Blender.LiveLink import Vec3
+
+
+TRANSFORMS = [
+    (11, (1.0, 2.0, 3.0), (0.0, 0.0, 0.0, 1.0), (1.0, 1.0, 1.0)),
+    (-7, (-4.5, 0.25, 9.0), (0.5, 0.5, 0.5, 0.5), (2.0, 0.5, 3.0)),
+    (2**31 - 1, (0.0, 0.0, -1.0e4), (0.0, 1.0, 0.0, 0.0), (0.125, 0.125, 0.125)),
+]
+
+
+# Mirrors LiveLinkConnection.make_transform_update in extension_main.py
+def build_transform_update(transforms):
+    builder = flatbuffers.Builder(64 + 48 * len(transforms))
+    Update.UpdateStartTransformsVector(builder, len(transforms))
+    for unique_id, location, rotation, scale in reversed(transforms):
+        ObjectTransform.CreateObjectTransform(builder, unique_id, *location, *rotation, *scale)
+    update_transforms = builder.EndVector()
+    Update.Start(builder)
+    Update.AddTransforms(builder, update_transforms)
+    Update.AddGenerationSeconds(builder, 0.001)
+    builder.FinishSizePrefixed(Update.End(builder))
+    return builder.Output()
+
+
+def build_mesh_update(unique_id, vertex_count):
+    builder = flatbuffers.Builder(0)
+    Mesh.MeshStartPositionsVector(builder, vertex_count * 3)
+    for _ in range(vertex_count * 3):
+        builder.PrependFloat32(0.0)
+    positions = builder.EndVector()
+    Mesh.Start(builder)
+    Mesh.AddPositions(builder, positions)
+    mesh = Mesh.End(builder)
+    Object.Start(builder)
+    Object.AddUniqueId(builder, unique_id)
+    Object.AddLocation(builder, Vec3.CreateVec3(builder, 0.0, 0.0, 0.0))
+    Object.AddScale(builder, Vec3.CreateVec3(builder, 1.0, 1.0, 1.0))
+    Object.AddRotation(builder, Quat.CreateQuat(builder, 0.0, 0.0, 0.0, 1.0))
+    Object.AddMesh(builder, mesh)
+    obj = Object.End(builder)
+    Update.UpdateStartObjectsVector(builder, 1)
+    builder.PrependUOffsetTRelative(obj)
+    objects = builder.EndVector()
+    Update.Start(builder)
+    Update.AddObjects(builder, objects)
+    builder.FinishSizePrefixed(Update.End(builder))
+    return builder.Output()
+
+
+def read_update(output):
+    return Update.Update.GetRootAs(output, 4)
+
+
+class TransformDeltaProtocolTests(unittest.TestCase):
+    def test_transforms_round_trip_in_order(self):
+        update = read_update(build_transform_update(TRANSFORMS))
+        self.assertTrue(update.ObjectsIsNone())
+        self.assertEqual(update.TransformsLength(), len(TRANSFORMS))
+        for index, (unique_id, location, rotation, scale) in enumerate(TRANSFORMS):
+            transform = update.Transforms(index)
+            self.assertEqual(transform.UniqueId(), unique_id)
+            loc = transform.Location(Vec3.Vec3())
+            rot = transform.Rotation(Quat.Quat())
+            scl = transform.Scale(Vec3.Vec3())
+            self.assertEqual((loc.X(), loc.Y(), loc.Z()), location)
+            self.assertEqual((rot.X(), rot.Y(), rot.Z(), rot.W()), rotation)
+            self.assertEqual((scl.X(), scl.Y(), scl.Z()), scale)
+
+    def test_transform_update_is_bytes_not_megabytes(self):
+        transform_bytes = len(build_transform_update(TRANSFORMS[:1]))
+        mesh_bytes = len(build_mesh_update(TRANSFORMS[0][0], 100000))
+        self.assertLess(transform_bytes, 128)
+        self.assertGreater(mesh_bytes, 1000 * transform_bytes)
+
+    def test_full_updates_have_no_transforms(self):
+        update = read_update(build_mesh_update(1, 3))
+        self.assertTrue(update.TransformsIsNone())
+        self.assertEqual(update.TransformsLength(), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,172 @@
+#include <cassert>
+#include <cstdio>
+
+#include "core/types.h"
+#include "render/upload_queue.h"
+#include "test_random.h"
+
+static void test_budget_batches()
+{
+	UploadQueue queue;
+	for (u32 job_idx = 0; job_idx < 5; ++job_idx)
+	{
+		assert(upload_queue_push(queue, 10, job_idx) == job_idx + 1);
+	}
+	assert(queue.pending_bytes == 50);
+
+	// A prefix that fits, never reordered or split
+	UploadQueueBatch* batch = upload_queue_take_batch(queue, 25);
+	assert(batch && batch->jobs.length() == 2 && batch->byte_count == 20);
+	assert(batch->jobs[0].ticket == 1 && batch->jobs[1].ticket == 2);
+	assert(batch->timeline_value == 1);
+	assert(queue.pending_bytes == 30 && queue.in_flight_bytes == 20);
+
+	batch = upload_queue_take_batch(queue, 1000);
+	assert(batch && batch->jobs.length() == 3 && batch->timeline_value == 2);
+	assert(batch->slot != queue.in_flight[0].slot);
+	assert(upload_queue_take_batch(queue, 1000) == nullptr);
+
+	// Nothing is ready before the semaphore moves
+	DynamicArray<UploadQueueBatch> completed;
+	upload_queue_complete(queue, 0, completed);
+	assert(completed.empty() && !upload_queue_ready(queue, 1));
+	assert(upload_queue_ready(queue, 0));
+
+	upload_queue_complete(queue, 1, completed);
+	assert(completed.length() == 1 && completed[0].jobs.length() == 2);
+	assert(upload_queue_ready(queue, 2) && !upload_queue_ready(queue, 3));
+	assert(queue.in_flight_bytes == 30);
+
+	upload_queue_complete(queue, 2, completed);
+	assert(completed.length() == 1 && upload_queue_ready(queue, 5));
+	assert(upload_queue_idle(queue) && queue.busy_slots == 0);
+}
+
+static void test_oversized_job_goes_alone()
+{
+	UploadQueue queue;
+	upload_queue_push(queue, 100, 0);
+	upload_queue_push(queue, 1, 1);
+
+	UploadQueueBatch* batch = upload_queue_take_batch(queue, 16);
+	assert(batch && batch->jobs.length() == 1 && batch->byte_count == 100);
+	batch = upload_queue_take_batch(queue, 16);
+	assert(batch && batch->jobs.length() == 1 && batch->jobs[0].payload == 1);
+}
+
+static void test_slots_and_cancel()
+{
+	UploadQueue queue;
+	for (u32 job_idx = 0; job_idx < UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT + 2; ++job_idx)
+	{
+		upload_queue_push(queue, 8, job_idx);
+	}
+
+	u32 slots_seen = 0;
+	for (u32 batch_idx = 0; batch_idx < UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT; ++batch_idx)
+	{
+		UploadQueueBatch* batch = upload_queue_take_batch(queue, 8);
+		assert(batch && batch->slot < UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT);
+		assert(!(slots_seen & (1u << batch->slot)));
+		slots_seen |= 1u << batch->slot;
+	}
+	assert(upload_queue_take_batch(queue, 8) == nullptr);
+	assert(upload_queue_pending_count(queue) == 2);
+
+	// A job whose target goes away before submission is dropped
+	const u64 cancelled_ticket = UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT + 1;
+	assert(upload_queue_cancel(queue, cancelled_ticket));
+	assert(!upload_queue_cancel(queue, cancelled_ticket));
+	assert(!upload_queue_cancel(queue, 1));
+	assert(upload_queue_pending_count(queue) == 1 && queue.pending_bytes == 8);
+
+	// Completing the first batch frees its slot for the next one
+	DynamicArray<UploadQueueBatch> completed;
+	upload_queue_complete(queue, 1, completed);
+	const u32 freed_slot = completed[0].slot;
+	UploadQueueBatch* batch = upload_queue_take_batch(queue, 8);
+	assert(batch && batch->slot == freed_slot);
+	assert(batch->jobs[0].ticket == UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT + 2);
+}
+
+// Random pushes, budgets and semaphore progress: every job lands exactly
+// once, in ticket order, and is ready exactly when its batch has completed
+static void test_random_schedule()
+{
+	Random random;
+	UploadQueue queue;
+	DynamicArray<u64> job_batch_values;	// per ticket: timeline value of its batch, 0 while pending
+	job_batch_values.add(0);
+	DynamicArray<UploadQueueBatch> completed;
+	u64 observed_value = 0;
+	u64 delivered_ticket = 0;
+	u64 delivered_bytes = 0;
+	u64 pushed_bytes = 0;
+
+	for (u32 frame = 0; frame < 5000; ++frame)
+	{
+		const u32 push_count = random.next() % 4;
+		for (u32 push_idx = 0; push_idx < push_count; ++push_idx)
+		{
+			const u64 byte_count = 1 + random.next() % 200;
+			const u64 ticket = upload_queue_push(queue, byte_count, 0);
+			assert(ticket == job_batch_values.length());
+			job_batch_values.add(0);
+			pushed_bytes += byte_count;
+		}
+
+		if (UploadQueueBatch* batch = upload_queue_take_batch(queue, 64 + random.next() % 256))
+		{
+			assert(batch->timeline_value == queue.last_timeline_value);
+			for (const UploadQueueJob& job : batch->jobs)
+			{
+				job_batch_values[job.ticket] = batch->timeline_value;
+			}
+		}
+
+		// The GPU gets through some prefix of what was submitted
+		if (observed_value < queue.last_timeline_value && random.next() % 3 == 0)
+		{
+			observed_value += 1 + random.next() % (queue.last_timeline_value - observed_value);
+		}
+		upload_queue_complete(queue, observed_value, completed);
+		for (const UploadQueueBatch& batch : completed)
+		{
+			for (const UploadQueueJob& job : batch.jobs)
+			{
+				assert(job.ticket == delivered_ticket + 1);
+				delivered_ticket = job.ticket;
+				delivered_bytes += job.byte_count;
+			}
+		}
+
+		for (u64 ticket = 1; ticket < job_batch_values.length(); ++ticket)
+		{
+			const bool landed = job_batch_values[ticket] != 0 && job_batch_values[ticket] <= observed_value;
+			assert(upload_queue_ready(queue, ticket) == landed);
+		}
+		assert(pushed_bytes == delivered_bytes + queue.in_flight_bytes + queue.pending_bytes);
+		assert(queue.in_flight.length() <= UPLOAD_QUEUE_MAX_BATCHES_IN_FLIGHT);
+	}
+
+	// Drain
+	while (!upload_queue_idle(queue))
+	{
+		upload_queue_take_batch(queue, 256);
+		upload_queue_complete(queue, queue.last_timeline_value, completed);
+	}
+	assert(upload_queue_ready(queue, job_batch_values.length() - 1));
+	assert(queue.pending_bytes == 0 && queue.in_flight_bytes == 0);
+	printf("random schedule: %llu jobs in %llu batches\n",
+		(unsigned long long) (job_batch_values.length() - 1), (unsigned long long) queue.last_timeline_value);
+}
+
+int main()
+{
+	test_budget_batches();
+	test_oversized_job_goes_alone();
+	test_slots_and_cancel();
+	test_random_schedule();
+	printf("upload_queue_tests passed\n");
+	return 0;
+}
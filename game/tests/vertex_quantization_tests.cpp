@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "handmade_math/HandmadeMath.h"
+#include "render/vertex_quantization.h"
+
+// Deterministic LCG so failures reproduce
+static u32 random_state = 0x12345678u;
+f32 random_unit()
+{
+	random_state = random_state * 1664525u + 1013904223u;
+	return (f32) (random_state >> 8) / (f32) (1u << 24);
+}
+
+f32 random_range(f32 in_min, f32 in_max)
+{
+	return in_min + (in_max - in_min) * random_unit();
+}
+
+HMM_Vec3 random_unit_vector()
+{
+	for (;;)
+	{
+		const HMM_Vec3 candidate = HMM_V3(random_range(-1.0f, 1.0f), random_range(-1.0f, 1.0f), random_range(-1.0f, 1.0f));
+		const f32 length = HMM_LenV3(candidate);
+		if (length > 0.05f && length <= 1.0f)
+		{
+			return candidate / length;
+		}
+	}
+}
+
+// atan2 form in doubles; acosf cannot resolve angles this small
+f32 angle_between(HMM_Vec3 in_a, HMM_Vec3 in_b)
+{
+	const f64 cross_x = (f64) in_a.Y * in_b.Z - (f64) in_a.Z * in_b.Y;
+	const f64 cross_y = (f64) in_a.Z * in_b.X - (f64) in_a.X * in_b.Z;
+	const f64 cross_z = (f64) in_a.X * in_b.Y - (f64) in_a.Y * in_b.X;
+	const f64 dot = (f64) in_a.X * in_b.X + (f64) in_a.Y * in_b.Y + (f64) in_a.Z * in_b.Z;
+	return (f32) atan2(sqrt(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z), dot);
+}
+
+void test_half_float_reference_values()
+{
+	assert(f32_to_half(0.0f) == 0x0000);
+	assert(f32_to_half(-0.0f) == 0x8000);
+	assert(f32_to_half(1.0f) == 0x3C00);
+	assert(f32_to_half(-2.0f) == 0xC000);
+	assert(f32_to_half(0.5f) == 0x3800);
+	assert(f32_to_half(65504.0f) == 0x7BFF);
+	assert(f32_to_half(65536.0f) == 0x7C00);
+	assert(f32_to_half(INFINITY) == 0x7C00);
+	assert((f32_to_half(NAN) & 0x7C00) == 0x7C00 && (f32_to_half(NAN) & 0x03FF) != 0);
+	assert(f32_to_half(ldexpf(1.0f, -24)) == 0x0001);
+	assert(f32_to_half(ldexpf(1.0f, -14)) == 0x0400);
+	assert(f32_to_half(ldexpf(1.0f, -26)) == 0x0000);
+	// Ties round to even: 1 + 2^-11 sits halfway between 0x3C00 and 0x3C01
+	assert(f32_to_half(1.0f + ldexpf(1.0f, -11)) == 0x3C00);
+	assert(f32_to_half(1.0f + 3.0f * ldexpf(1.0f, -11)) == 0x3C02);
+
+	// Every finite half survives half -> f32 -> half
+	for (u32 half = 0; half < 0x10000u; ++half)
+	{
+		if ((half & 0x7C00u) == 0x7C00u)
+		{
+			continue;
+		}
+		assert(f32_to_half(half_to_f32((u16) half)) == half);
+	}
+}
+
+void test_position_error_bound()
+{
+	const HMM_Vec3 min = HMM_V3(-12.5f, 0.25f, -3.0f);
+	const HMM_Vec3 max = HMM_V3(40.0f, 0.75f, 61.0f);
+	const VertexQuantization quantization = vertex_quantization_from_bounds(min, max);
+	const HMM_Vec3 extent = quantization.position_extent;
+
+	for (i32 sample = 0; sample < 100000; ++sample)
+	{
+		Vertex vertex = {
+			.position = HMM_V4(random_range(min.X, max.X), random_range(min.Y, max.Y), random_range(min.Z, max.Z), 1.0f),
+			.normal = HMM_V4(0.0f, 0.0f, 1.0f, 0.0f),
+		};
+		const Vertex decoded = vertex_dequantize(vertex_quantize(vertex, quantization), quantization);
+		for (i32 axis = 0; axis < 3; ++axis)
+		{
+			// Half a quantization step, plus f32 rounding of min + t * extent
+			const f32 bound = extent.Elements[axis] * (0.5f / 65535.0f) + 4.0f * ldexpf(fabsf(max.Elements[axis]) + fabsf(min.Elements[axis]), -24);
+			assert(fabsf(decoded.position.Elements[axis] - vertex.position.Elements[axis]) <= bound);
+		}
+		assert(decoded.position.W == 1.0f);
+	}
+
+	// The AABB corners are exact
+	const Vertex corner = { .position = HMM_V4V(max, 1.0f) };
+	const Vertex decoded_corner = vertex_dequantize(vertex_quantize(corner, quantization), quantization);
+	assert(decoded_corner.position.X == max.X && decoded_corner.position.Z == max.Z);
+}
+
+void test_flat_axis_decodes_to_min()
+{
+	const VertexQuantization quantization = vertex_quantization_from_bounds(HMM_V3(0.0f, 2.0f, 0.0f), HMM_V3(1.0f, 2.0f, 1.0f));
+	const Vertex vertex = { .position = HMM_V4(0.5f, 2.0f, 0.25f, 1.0f) };
+	const Vertex decoded = vertex_dequantize(vertex_quantize(vertex, quantization), quantization);
+	assert(decoded.position.Y == 2.0f);
+}
+
+void test_normal_angular_error_bound()
+{
+	// snorm16 octahedral: worst case is well under 0.01 degrees
+	const f32 max_angle_radians = 1.0e-4f;
+	const VertexQuantization quantization = {};
+	f32 worst_angle = 0.0f;
+	for (i32 sample = 0; sample < 100000; ++sample)
+	{
+		const HMM_Vec3 normal = random_unit_vector();
+		const Vertex vertex = { .normal = HMM_V4V(normal, 0.0f) };
+		const Vertex decoded = vertex_dequantize(vertex_quantize(vertex, quantization), quantization);
+		assert(fabsf(HMM_LenV3(decoded.normal.XYZ) - 1.0f) < 1.0e-5f);
+		assert(decoded.normal.W == 0.0f);
+		worst_angle = MAX(worst_angle, angle_between(normal, decoded.normal.XYZ));
+	}
+	assert(worst_angle <= max_angle_radians);
+
+	// Axes and the octahedron's folded edges round-trip
+	const HMM_Vec3 axes[] = {
+		HMM_V3(1, 0, 0), HMM_V3(-1, 0, 0), HMM_V3(0, 1, 0),
+		HMM_V3(0, -1, 0), HMM_V3(0, 0, 1), HMM_V3(0, 0, -1),
+	};
+	for (const HMM_Vec3& axis : axes)
+	{
+		const Vertex decoded = vertex_dequantize(vertex_quantize((Vertex) { .normal = HMM_V4V(axis, 0.0f) }, quantization), quantization);
+		assert(HMM_DotV3(axis, decoded.normal.XYZ) > 0.99999f);
+	}
+
+	// Degenerate normals decode to +Z rather than NaN
+	const Vertex zero_normal = vertex_dequantize(vertex_quantize((Vertex) {}, quantization), quantization);
+	assert(zero_normal.normal.Z == 1.0f);
+}
+
+void test_texcoord_error_bound()
+{
+	const VertexQuantization quantization = {};
+	for (i32 sample = 0; sample < 100000; ++sample)
+	{
+		const HMM_Vec2 texcoord = HMM_V2(random_range(-4.0f, 4.0f), random_range(0.0f, 1.0f));
+		const Vertex vertex = { .normal = HMM_V4(0, 0, 1, 0), .texcoord = texcoord };
+		const Vertex decoded = vertex_dequantize(vertex_quantize(vertex, quantization), quantization);
+		for (i32 axis = 0; axis < 2; ++axis)
+		{
+			// binary16 keeps 11 significant bits: relative error <= 2^-11,
+			// absolute 2^-25 near zero (subnormals)
+			const f32 value = texcoord.Elements[axis];
+			const f32 bound = MAX(fabsf(value) * ldexpf(1.0f, -11), ldexpf(1.0f, -25));
+			assert(fabsf(decoded.texcoord.Elements[axis] - value) <= bound);
+		}
+	}
+}
+
+void test_compact_vertex_is_a_third_of_vertex()
+{
+	static_assert(sizeof(CompactVertex) * 3 == sizeof(Vertex));
+	assert(COMPACT_INDEX_MAX_VERTEX_COUNT == 65536);
+}
+
+int main()
+{
+	test_half_float_reference_values();
+	test_position_error_bound();
+	test_flat_axis_decodes_to_min();
+	test_normal_angular_error_bound();
+	test_texcoord_error_bound();
+	test_compact_vertex_is_a_third_of_vertex();
+	printf("vertex quantization tests passed\n");
+	return 0;
+}
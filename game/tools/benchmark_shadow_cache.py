@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Benchmark shadow-pass GPU time on a static scene with and without cascade caching.
+
+Renders the procedural cube scene from validate_indirect_draw.py (a
+shadow-casting sun over a grid of casters, fixed camera) through the offline
+benchmark once with GAME2_SHADOW_CACHE=0, where every cascade re-renders and
+re-blurs each frame, and once with the cache on, where only the near cascade
+does. Prints the median/p95 GPU time of the shadow depth and blur passes and
+the rendered/cached cascade counts, and writes them to summary.json. Pass
+--lavapipe to run on Mesa's software rasterizer.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+from pathlib import Path
+import platform
+import shutil
+import subprocess
+import sys
+
+from validate_indirect_draw import ROOT, build_scene, find_lavapipe_icd
+
+
+# (run name, GAME2_SHADOW_CACHE); the first is the baseline
+RUNS = (
+    ("uncached", "0"),
+    ("cached", "1"),
+)
+SHADOW_PASSES = ("Shadow Depth", "Shadow Blur Horizontal", "Shadow Blur Vertical")
+
+
+def run_benchmark(game: Path, scene: Path, name: str, shadow_cache: str, output_dir: Path,
+                  warmup_frames: int, frames: int, lavapipe_icd: str | None) -> dict:
+    output = output_dir / f"{name}.json"
+    environment = os.environ.copy()
+    environment.update({
+        "GAME2_SHADOW_CACHE": shadow_cache,
+        "GAME2_RENDER_SCALE": "100",
+        "GAME2_HIDE_UI": "1",
+    })
+    if lavapipe_icd:
+        environment["VK_ICD_FILENAMES"] = lavapipe_icd
+    command = [str(game), "--no-live-link", "--file", str(scene),
+               "--warmup-frames", str(warmup_frames), "--benchmark-frames", str(frames),
+               "--benchmark-output", str(output)]
+    if platform.system() == "Linux" and not environment.get("DISPLAY") and not environment.get("WAYLAND_DISPLAY"):
+        if not shutil.which("xvfb-run"):
+            raise RuntimeError("no display and no xvfb-run")
+        command = ["xvfb-run", "-a"] + command
+
+    log_path = output_dir / f"{name}.log"
+    with log_path.open("w") as log:
+        result = subprocess.run(command, cwd=ROOT, env=environment, stdout=log,
+                                stderr=subprocess.STDOUT)
+    if result.returncode != 0:
+        raise RuntimeError(f"{name}: game exited with {result.returncode} (see {log_path})")
+    report = json.loads(output.read_text())
+    passes = report.get("gpu_passes", {})
+    return {
+        "name": name,
+        "device": report.get("device"),
+        "gpu_frame": report["timings"]["gpu_frame"],
+        "passes": {pass_name: passes[pass_name] for pass_name in SHADOW_PASSES if pass_name in passes},
+        "shadow_cascades": report.get("shadow_cascades", {}),
+    }
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--output", type=Path, default=ROOT / "build/shadow_cache_benchmark",
+                        help="directory for the scene, benchmark JSON, logs and summary.json")
+    parser.add_argument("--grid", type=int, default=24, help="cubes per side of the scene grid")
+    parser.add_argument("--warmup-frames", type=int, default=120)
+    parser.add_argument("--frames", type=int, default=600, help="measured frames per run")
+    parser.add_argument("--lavapipe", action="store_true",
+                        help="force Mesa's lavapipe ICD (VK_ICD_FILENAMES)")
+    args = parser.parse_args()
+
+    game = ROOT / ("bin/game.exe" if platform.system() == "Windows" else "bin/game")
+    if not game.is_file():
+        print("game binary is missing; run build.sh first", file=sys.stderr)
+        return 1
+    lavapipe_icd = None
+    if args.lavapipe:
+        lavapipe_icd = find_lavapipe_icd()
+        if not lavapipe_icd:
+            print("lavapipe ICD not found", file=sys.stderr)
+            return 1
+
+    args.output.mkdir(parents=True, exist_ok=True)
+    scene = args.output / "scene.bin"
+    scene.write_bytes(build_scene(args.grid))
+
+    try:
+        runs = [run_benchmark(game, scene, name, shadow_cache, args.output,
+                              args.warmup_frames, args.frames, lavapipe_icd)
+                for name, shadow_cache in RUNS]
+    except (RuntimeError, OSError, KeyError, ValueError) as error:
+        print(f"shadow cache benchmark failed: {error}", file=sys.stderr)
+        return 1
+
+    summary = {
+        "grid": args.grid,
+        "frames": args.frames,
+        "icd": lavapipe_icd or os.environ.get("VK_ICD_FILENAMES", "default"),
+        "runs": runs,
+    }
+    (args.output / "summary.json").write_text(json.dumps(summary, indent=2) + "\n")
+    for run in runs:
+        shadow_median = sum(timing["median_ms"] for timing in run["passes"].values())
+        pass_medians = ", ".join(f"{name} {timing['median_ms']:.3f}" for name, timing in run["passes"].items())
+        cascades = run["shadow_cascades"]
+        print(f"{run['name']}: shadow passes {shadow_median:.3f} ms median ({pass_medians}), "
+              f"gpu frame {run['gpu_frame']['median_ms']:.3f} ms, "
+              f"cascades rendered {cascades.get('rendered', 0)} cached {cascades.get('cached', 0)}")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""Measure texture streaming budget adherence and stream-in latency.
+
+Builds a scene of textured cubes receding from a fixed camera, each with its
+own large checker texture, so near cubes need their finest mips and far ones
+only coarse levels. Renders it through the offline benchmark once with
+streaming off (every chain fully resident) and once with streaming on under a
+GAME2_TEXTURE_BUDGET_MB smaller than the full set. Checks that the streamed
+run's peak resident bytes never passed the budget, prints the stream-in
+latency (demand seen to replacement bound, median/p95 in frames and ms) and
+writes everything to summary.json. Pass --lavapipe to run headless on Mesa's
+software rasterizer.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import math
+import os
+from pathlib import Path
+import platform
+import shutil
+import subprocess
+import sys
+
+from validate_indirect_draw import ROOT, cube_streams, find_lavapipe_icd
+
+
+SUN_ID = 7401
+FIRST_MESH_ID = 7500
+FIRST_MATERIAL_ID = 7600
+FIRST_IMAGE_ID = 7700
+CHECKER_CELL = 32
+
+
+def checker_pixels(size: int, index: int) -> bytes:
+    """size x size RGBA8 checker, a different pair of colors per texture."""
+    light = bytes((200, 80 + (index * 37) % 150, 60 + (index * 71) % 180, 255))
+    dark = bytes((30 + (index * 53) % 120, 40, 90 + (index * 29) % 140, 255))
+    cells = size // CHECKER_CELL
+    row_a = (light * CHECKER_CELL + dark * CHECKER_CELL) * (cells // 2)
+    row_b = (dark * CHECKER_CELL + light * CHECKER_CELL) * (cells // 2)
+    block_a = row_a * CHECKER_CELL
+    block_b = row_b * CHECKER_CELL
+    return (block_a + block_b) * (cells // 2)
+
+
+def build_scene(texture_count: int, texture_size: int) -> bytes:
+    from compiled_schemas.python import flatbuffers
+    from compiled_schemas.python.Blender.LiveLink import EditorCamera
+    from compiled_schemas.python.Blender.LiveLink import Image
+    from compiled_schemas.python.Blender.LiveLink import Light
+    from compiled_schemas.python.Blender.LiveLink import LightType
+    from compiled_schemas.python.Blender.LiveLink import Material
+    from compiled_schemas.python.Blender.LiveLink import Mesh
+    from compiled_schemas.python.Blender.LiveLink import Object
+    from compiled_schemas.python.Blender.LiveLink import Quat
+    from compiled_schemas.python.Blender.LiveLink import SunLight
+    from compiled_schemas.python.Blender.LiveLink import Update
+    from compiled_schemas.python.Blender.LiveLink import Vec3
+    from compiled_schemas.python.Blender.LiveLink import Vec4
+
+    builder = flatbuffers.Builder(texture_count * texture_size * texture_size * 4 + (1 << 20))
+
+    def vector(start_vector, prepend, values):
+        start_vector(builder, len(values))
+        for value in reversed(values):
+            prepend(value)
+        return builder.EndVector()
+
+    def offsets(start_vector, values):
+        start_vector(builder, len(values))
+        for value in reversed(values):
+            builder.PrependUOffsetTRelative(value)
+        return builder.EndVector()
+
+    images = []
+    for index in range(texture_count):
+        data = builder.CreateByteVector(checker_pixels(texture_size, index))
+        Image.Start(builder)
+        Image.AddUniqueId(builder, FIRST_IMAGE_ID + index)
+        Image.AddWidth(builder, texture_size)
+        Image.AddHeight(builder, texture_size)
+        Image.AddData(builder, data)
+        images.append(Image.End(builder))
+
+    materials = []
+    for index in range(texture_count):
+        name_value = builder.CreateString(f"Streaming Material {index}")
+        Material.Start(builder)
+        Material.AddUniqueId(builder, FIRST_MATERIAL_ID + index)
+        Material.AddName(builder, name_value)
+        Material.AddBaseColor(builder, Vec4.CreateVec4(builder, 1.0, 1.0, 1.0, 1.0))
+        Material.AddBaseColorImageId(builder, FIRST_IMAGE_ID + index)
+        Material.AddMetallic(builder, 0.0)
+        Material.AddMetallicImageId(builder, -1)
+        Material.AddRoughness(builder, 0.6)
+        Material.AddRoughnessImageId(builder, -1)
+        Material.AddEmissionColor(builder, Vec4.CreateVec4(builder, 0.0, 0.0, 0.0, 1.0))
+        Material.AddEmissionColorImageId(builder, -1)
+        materials.append(Material.End(builder))
+
+    def scene_object(unique_id, name, location, rotation, mesh_value=None, light_value=None):
+        name_value = builder.CreateString(name)
+        Object.Start(builder)
+        Object.AddName(builder, name_value)
+        Object.AddUniqueId(builder, unique_id)
+        Object.AddVisibility(builder, True)
+        Object.AddLocation(builder, Vec3.CreateVec3(builder, *location))
+        Object.AddScale(builder, Vec3.CreateVec3(builder, 1.0, 1.0, 1.0))
+        Object.AddRotation(builder, Quat.CreateQuat(builder, *rotation))
+        if mesh_value is not None:
+            Object.AddMesh(builder, mesh_value)
+        if light_value is not None:
+            Object.AddLight(builder, light_value)
+        return Object.End(builder)
+
+    objects = []
+    Light.Start(builder)
+    Light.AddType(builder, LightType.LightType.Sun)
+    Light.AddColor(builder, Vec3.CreateVec3(builder, 1.0, 1.0, 1.0))
+    Light.AddUseShadow(builder, False)
+    Light.AddSunLight(builder, SunLight.CreateSunLight(builder, 1361.0, True))
+    sun_light = Light.End(builder)
+    objects.append(scene_object(SUN_ID, "Streaming Sun", (0.0, 0.0, 50.0),
+                                (0.2588, 0.1, 0.0, 0.9607), light_value=sun_light))
+
+    # Two rows of cubes along +Y, spacing growing with distance so the far
+    # ones shrink to a few pixels
+    positions, normals, texcoords, indices = cube_streams(3.0)
+    for index in range(texture_count):
+        material_ids = vector(Mesh.StartMaterialIdsVector, builder.PrependInt32, [FIRST_MATERIAL_ID + index])
+        position_vector = vector(Mesh.StartPositionsVector, builder.PrependFloat32, positions)
+        normal_vector = vector(Mesh.StartNormalsVector, builder.PrependFloat32, normals)
+        texcoord_vector = vector(Mesh.StartTexcoordsVector, builder.PrependFloat32, texcoords)
+        index_vector = vector(Mesh.StartIndicesVector, builder.PrependUint32, indices)
+        Mesh.Start(builder)
+        Mesh.AddPositions(builder, position_vector)
+        Mesh.AddNormals(builder, normal_vector)
+        Mesh.AddTexcoords(builder, texcoord_vector)
+        Mesh.AddIndices(builder, index_vector)
+        Mesh.AddMaterialIds(builder, material_ids)
+        Mesh.AddArmatureId(builder, -1)
+        cube = Mesh.End(builder)
+        distance = 4.0 * (1.35 ** (index // 2))
+        location = (-2.5 if index % 2 == 0 else 2.5, distance, 1.5)
+        angle = 0.3 * index
+        rotation = (0.0, 0.0, math.sin(angle * 0.5), math.cos(angle * 0.5))
+        objects.append(scene_object(FIRST_MESH_ID + index, f"Streaming Cube {index}",
+                                    location, rotation, mesh_value=cube))
+
+    object_vector = offsets(Update.StartObjectsVector, objects)
+    material_vector = offsets(Update.StartMaterialsVector, materials)
+    image_vector = offsets(Update.StartImagesVector, images)
+
+    EditorCamera.Start(builder)
+    EditorCamera.AddLocation(builder, Vec3.CreateVec3(builder, 0.0, -3.0, 2.5))
+    EditorCamera.AddForward(builder, Vec3.CreateVec3(builder, 0.0, 0.9950, -0.0998))
+    EditorCamera.AddUp(builder, Vec3.CreateVec3(builder, 0.0, 0.0998, 0.9950))
+    camera = EditorCamera.End(builder)
+
+    Update.Start(builder)
+    Update.AddObjects(builder, object_vector)
+    Update.AddMaterials(builder, material_vector)
+    Update.AddImages(builder, image_vector)
+    Update.AddEditorCamera(builder, camera)
+    builder.FinishSizePrefixed(Update.End(builder))
+    return bytes(builder.Output())
+
+
+def run_benchmark(game: Path, scene: Path, name: str, streaming: str, budget_mb: int, output_dir: Path,
+                  warmup_frames: int, frames: int, lavapipe_icd: str | None) -> dict:
+    output = output_dir / f"{name}.json"
+    environment = os.environ.copy()
+    environment.update({
+        "GAME2_TEXTURE_STREAMING": streaming,
+        "GAME2_TEXTURE_BUDGET_MB": str(budget_mb),
+        "GAME2_RENDER_SCALE": "100",
+        "GAME2_HIDE_UI": "1",
+    })
+    if lavapipe_icd:
+        environment["VK_ICD_FILENAMES"] = lavapipe_icd
+    command = [str(game), "--no-live-link", "--file", str(scene),
+               "--warmup-frames", str(warmup_frames), "--benchmark-frames", str(frames),
+               "--benchmark-output", str(output)]
+    if platform.system() == "Linux" and not environment.get("DISPLAY") and not environment.get("WAYLAND_DISPLAY"):
+        if not shutil.which("xvfb-run"):
+            raise RuntimeError("no display and no xvfb-run")
+        command = ["xvfb-run", "-a"] + command
+
+    log_path = output_dir / f"{name}.log"
+    with log_path.open("w") as log:
+        result = subprocess.run(command, cwd=ROOT, env=environment, stdout=log,
+                                stderr=subprocess.STDOUT)
+    if result.returncode != 0:
+        raise RuntimeError(f"{name}: game exited with {result.returncode} (see {log_path})")
+    report = json.loads(output.read_text())
+    return {
+        "name": name,
+        "device": report.get("device"),
+        "gpu_frame": report["timings"]["gpu_frame"],
+        "texture_streaming": report["texture_streaming"],
+        "vma": report.get("vma", {}),
+    }
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--output", type=Path, default=ROOT / "build/texture_streaming_benchmark",
+                        help="directory for the scene, benchmark JSON, logs and summary.json")
+    parser.add_argument("--textures", type=int, default=24, help="textured cubes in the scene")
+    parser.add_argument("--texture-size", type=int, default=1024, help="texture width and height (power of two)")
+    parser.add_argument("--budget-mb", type=int, default=24, help="GAME2_TEXTURE_BUDGET_MB of the streamed run")
+    parser.add_argument("--warmup-frames", type=int, default=60)
+    parser.add_argument("--frames", type=int, default=240, help="measured frames per run")
+    parser.add_argument("--lavapipe", action="store_true",
+                        help="force Mesa's lavapipe ICD (VK_ICD_FILENAMES)")
+    args = parser.parse_args()
+
+    game = ROOT / ("bin/game.exe" if platform.system() == "Windows" else "bin/game")
+    if not game.is_file():
+        print("game binary is missing; run build.sh first", file=sys.stderr)
+        return 1
+    lavapipe_icd = None
+    if args.lavapipe:
+        lavapipe_icd = find_lavapipe_icd()
+        if not lavapipe_icd:
+            print("lavapipe ICD not found", file=sys.stderr)
+            return 1
+
+    args.output.mkdir(parents=True, exist_ok=True)
+    scene = args.output / "scene.bin"
+    scene.write_bytes(build_scene(args.textures, args.texture_size))
+
+    try:
+        resident = run_benchmark(game, scene, "resident", "0", args.budget_mb, args.output,
+                                 args.warmup_frames, args.frames, lavapipe_icd)
+        streamed = run_benchmark(game, scene, "streamed", "1", args.budget_mb, args.output,
+                                 args.warmup_frames, args.frames, lavapipe_icd)
+    except (RuntimeError, OSError, KeyError, ValueError) as error:
+        print(f"texture streaming benchmark failed: {error}", file=sys.stderr)
+        return 1
+
+    streaming = streamed["texture_streaming"]
+    within_budget = streaming["peak_bytes"] <= args.budget_mb << 20 and streaming["over_budget_frames"] == 0
+    summary = {
+        "textures": args.textures,
+        "texture_size": args.texture_size,
+        "budget_mb": args.budget_mb,
+        "frames": args.frames,
+        "icd": lavapipe_icd or os.environ.get("VK_ICD_FILENAMES", "default"),
+        "within_budget": within_budget,
+        "runs": [resident, streamed],
+    }
+    (args.output / "summary.json").write_text(json.dumps(summary, indent=2) + "\n")
+    mib = 1024.0 * 1024.0
+    print(f"resident: {resident['texture_streaming']['resident_bytes'] / mib:.1f} MB of textures, "
+          f"gpu frame {resident['gpu_frame']['median_ms']:.3f} ms median")
+    print(f"streamed: peak {streaming['peak_bytes'] / mib:.1f} MB of {args.budget_mb} MB budget, "
+          f"{streaming['over_budget_frames']} frames over, {streaming['stream_ins']} stream-ins, "
+          f"{streaming['evictions']} evictions, gpu frame {streamed['gpu_frame']['median_ms']:.3f} ms median")
+    print(f"stream-in latency: median {streaming['latency_median_frames']:.0f} frames "
+          f"({streaming['latency_median_ms']:.1f} ms), p95 {streaming['latency_p95_frames']:.0f} frames "
+          f"({streaming['latency_p95_ms']:.1f} ms) over {streaming['latency_samples']} samples")
+    if not within_budget:
+        print("texture streaming exceeded its budget", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""Compare G-buffer captures from the direct, indirect and GPU-culled draw paths.
+
+Builds a procedural scene (float, quantized and quantized + 16-bit index
+meshes under a shadow-casting sun; repeated cubes share streams, so the
+indirect paths draw them instanced), renders it once per GAME2_DRAW_PATH and
+once without instancing with GAME2_GBUFFER_CAPTURE, and requires every
+G-buffer output to match the direct path byte for byte. Pass --lavapipe to
+run on Mesa's software rasterizer.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import math
+import os
+from pathlib import Path
+import platform
+import shutil
+import struct
+import subprocess
+import sys
+
+
+ROOT = Path(__file__).resolve().parents[1]
+REPO_ROOT = ROOT.parent
+sys.path.insert(0, str(REPO_ROOT))
+
+# (capture name, GAME2_DRAW_PATH, GAME2_INSTANCING); the first is the reference
+RUNS = (
+    ("direct", "direct", None),
+    ("indirect", "indirect", None),
+    ("gpu_cull", "gpu_cull", None),
+    ("indirect_uninstanced", "indirect", "0"),
+)
+GBUFFER_OUTPUT_COUNT = 4
+LAVAPIPE_ICD_DIRECTORIES = ("/usr/share/vulkan/icd.d", "/etc/vulkan/icd.d")
+
+SUN_ID = 7001
+GROUND_ID = 7002
+FIRST_MESH_ID = 7100
+MATERIAL_IDS = (7201, 7202, 7203)
+
+
+def cube_streams(size: float) -> tuple[list[float], list[float], list[float], list[int]]:
+    """24-vertex cube centered on the origin with per-face normals."""
+    faces = (
+        ((1, 0, 0), (0, 1, 0), (0, 0, 1)),
+        ((-1, 0, 0), (0, -1, 0), (0, 0, 1)),
+        ((0, 1, 0), (-1, 0, 0), (0, 0, 1)),
+        ((0, -1, 0), (1, 0, 0), (0, 0, 1)),
+        ((0, 0, 1), (1, 0, 0), (0, 1, 0)),
+        ((0, 0, -1), (-1, 0, 0), (0, 1, 0)),
+    )
+    half = size * 0.5
+    positions, normals, texcoords, indices = [], [], [], []
+    for normal, tangent, bitangent in faces:
+        base = len(positions) // 3
+        for u, v in ((-1, -1), (1, -1), (1, 1), (-1, 1)):
+            for axis in range(3):
+                positions.append(half * (normal[axis] + u * tangent[axis] + v * bitangent[axis]))
+            normals.extend(normal)
+            texcoords.extend(((u + 1) * 0.5, (v + 1) * 0.5))
+        indices.extend((base, base + 1, base + 2, base, base + 2, base + 3))
+    return positions, normals, texcoords, indices
+
+
+def float_to_half_bits(value: float) -> int:
+    return struct.unpack("<H", struct.pack("<e", value))[0]
+
+
+def oct_encode(normal: tuple[float, float, float]) -> tuple[int, int]:
+    x, y, z = normal
+    length = abs(x) + abs(y) + abs(z)
+    x, y, z = x / length, y / length, z / length
+    if z < 0.0:
+        x, y = ((1.0 - abs(y)) * math.copysign(1.0, x), (1.0 - abs(x)) * math.copysign(1.0, y))
+    return (round(max(-1.0, min(1.0, x)) * 32767), round(max(-1.0, min(1.0, y)) * 32767))
+
+
+def build_scene(grid: int) -> bytes:
+    from compiled_schemas.python import flatbuffers
+    from compiled_schemas.python.Blender.LiveLink import EditorCamera
+    from compiled_schemas.python.Blender.LiveLink import Light
+    from compiled_schemas.python.Blender.LiveLink import LightType
+    from compiled_schemas.python.Blender.LiveLink import Material
+    from compiled_schemas.python.Blender.LiveLink import Mesh
+    from compiled_schemas.python.Blender.LiveLink import Object
+    from compiled_schemas.python.Blender.LiveLink import Quat
+    from compiled_schemas.python.Blender.LiveLink import SunLight
+    from compiled_schemas.python.Blender.LiveLink import Update
+    from compiled_schemas.python.Blender.LiveLink import Vec3
+    from compiled_schemas.python.Blender.LiveLink import Vec4
+
+    builder = flatbuffers.Builder(1 << 20)
+
+    def vector(start_vector, prepend, values):
+        start_vector(builder, len(values))
+        for value in reversed(values):
+            prepend(value)
+        return builder.EndVector()
+
+    def mesh(positions, normals, texcoords, indices, material_id, variant):
+        """variant 0: float + u32, 1: quantized + u32, 2: quantized + u16"""
+        material_ids = vector(Mesh.StartMaterialIdsVector, builder.PrependInt32, [material_id])
+        if variant == 0:
+            position_vector = vector(Mesh.StartPositionsVector, builder.PrependFloat32, positions)
+            normal_vector = vector(Mesh.StartNormalsVector, builder.PrependFloat32, normals)
+            texcoord_vector = vector(Mesh.StartTexcoordsVector, builder.PrependFloat32, texcoords)
+        else:
+            minimum = [min(positions[axis::3]) for axis in range(3)]
+            extent = [max(positions[axis::3]) - minimum[axis] for axis in range(3)]
+            quantized = [round((value - minimum[index % 3]) / extent[index % 3] * 65535)
+                         for index, value in enumerate(positions)]
+            octahedral = []
+            for vertex in range(len(normals) // 3):
+                octahedral.extend(oct_encode(tuple(normals[vertex * 3:vertex * 3 + 3])))
+            quantized_vector = vector(Mesh.StartQuantizedPositionsVector, builder.PrependUint16, quantized)
+            oct_vector = vector(Mesh.StartOctNormalsVector, builder.PrependInt16, octahedral)
+            half_vector = vector(Mesh.StartHalfTexcoordsVector, builder.PrependUint16,
+                                 [float_to_half_bits(value) for value in texcoords])
+        if variant == 2:
+            index_vector = vector(Mesh.StartIndices16Vector, builder.PrependUint16, indices)
+        else:
+            index_vector = vector(Mesh.StartIndicesVector, builder.PrependUint32, indices)
+
+        Mesh.Start(builder)
+        if variant == 0:
+            Mesh.AddPositions(builder, position_vector)
+            Mesh.AddNormals(builder, normal_vector)
+            Mesh.AddTexcoords(builder, texcoord_vector)
+        else:
+            Mesh.AddQuantizedPositions(builder, quantized_vector)
+            Mesh.AddPositionMin(builder, Vec3.CreateVec3(builder, *minimum))
+            Mesh.AddPositionExtent(builder, Vec3.CreateVec3(builder, *extent))
+            Mesh.AddOctNormals(builder, oct_vector)
+            Mesh.AddHalfTexcoords(builder, half_vector)
+        if variant == 2:
+            Mesh.AddIndices16(builder, index_vector)
+        else:
+            Mesh.AddIndices(builder, index_vector)
+        Mesh.AddMaterialIds(builder, material_ids)
+        Mesh.AddArmatureId(builder, -1)
+        return Mesh.End(builder)
+
+    def scene_object(unique_id, name, location, rotation, mesh_value=None, light_value=None):
+        name_value = builder.CreateString(name)
+        Object.Start(builder)
+        Object.AddName(builder, name_value)
+        Object.AddUniqueId(builder, unique_id)
+        Object.AddVisibility(builder, True)
+        Object.AddLocation(builder, Vec3.CreateVec3(builder, *location))
+        Object.AddScale(builder, Vec3.CreateVec3(builder, 1.0, 1.0, 1.0))
+        Object.AddRotation(builder, Quat.CreateQuat(builder, *rotation))
+        if mesh_value is not None:
+            Object.AddMesh(builder, mesh_value)
+        if light_value is not None:
+            Object.AddLight(builder, light_value)
+        return Object.End(builder)
+
+    objects = []
+    Light.Start(builder)
+    Light.AddType(builder, LightType.LightType.Sun)
+    Light.AddColor(builder, Vec3.CreateVec3(builder, 1.0, 1.0, 1.0))
+    Light.AddUseShadow(builder, True)
+    Light.AddSunLight(builder, SunLight.CreateSunLight(builder, 1361.0, True))
+    sun_light = Light.End(builder)
+    # Tilted so casters throw shadows across their neighbours
+    objects.append(scene_object(SUN_ID, "Indirect Validation Sun", (0.0, 0.0, 50.0),
+                                (0.2588, 0.1, 0.0, 0.9607), light_value=sun_light))
+
+    ground_half = grid * 2.0 + 4.0
+    ground = mesh(
+        [-ground_half, -ground_half, 0.0, ground_half, -ground_half, 0.0,
+         ground_half, ground_half, 0.0, -ground_half, ground_half, 0.0],
+        [0.0, 0.0, 1.0] * 4,
+        [0.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0],
+        [0, 1, 2, 0, 2, 3], MATERIAL_IDS[0], 0)
+    objects.append(scene_object(GROUND_ID, "Indirect Validation Ground", (0.0, 0.0, 0.0),
+                                (0.0, 0.0, 0.0, 1.0), mesh_value=ground))
+
+    # Cubes of three sizes and three stream variants, spaced so no two
+    # surfaces are coplanar (draw order must not matter)
+    streams = [cube_streams(size) for size in (1.0, 1.3, 0.7)]
+    for row in range(grid):
+        for column in range(grid):
+            index = row * grid + column
+            positions, normals, texcoords, indices = streams[index % 3]
+            cube = mesh(positions, normals, texcoords, indices,
+                        MATERIAL_IDS[(index // 3) % 3], (index // 2) % 3)
+            location = ((column - grid * 0.5) * 4.0, (row - grid * 0.5) * 4.0, 1.0 + 0.05 * (index % 7))
+            angle = 0.1 * index
+            rotation = (0.0, 0.0, math.sin(angle * 0.5), math.cos(angle * 0.5))
+            objects.append(scene_object(FIRST_MESH_ID + index, f"Indirect Validation Cube {index}",
+                                        location, rotation, mesh_value=cube))
+
+    materials = []
+    for material_id, color in zip(MATERIAL_IDS, ((0.6, 0.6, 0.55), (0.7, 0.2, 0.1), (0.1, 0.3, 0.8))):
+        name_value = builder.CreateString(f"Indirect Validation Material {material_id}")
+        Material.Start(builder)
+        Material.AddUniqueId(builder, material_id)
+        Material.AddName(builder, name_value)
+        Material.AddBaseColor(builder, Vec4.CreateVec4(builder, *color, 1.0))
+        Material.AddMetallic(builder, 0.0)
+        Material.AddRoughness(builder, 0.6)
+        Material.AddEmissionColor(builder, Vec4.CreateVec4(builder, 0.0, 0.0, 0.0, 1.0))
+        materials.append(Material.End(builder))
+
+    Update.StartObjectsVector(builder, len(objects))
+    for value in reversed(objects):
+        builder.PrependUOffsetTRelative(value)
+    object_vector = builder.EndVector()
+    Update.StartMaterialsVector(builder, len(materials))
+    for value in reversed(materials):
+        builder.PrependUOffsetTRelative(value)
+    material_vector = builder.EndVector()
+
+    # Looking down the grid from one corner: some cubes sit outside the
+    # frustum so culling has work to do
+    EditorCamera.Start(builder)
+    EditorCamera.AddLocation(builder, Vec3.CreateVec3(builder, -grid * 1.5, -grid * 2.5, grid * 1.2))
+    EditorCamera.AddForward(builder, Vec3.CreateVec3(builder, 0.4364, 0.7274, -0.5298))
+    EditorCamera.AddUp(builder, Vec3.CreateVec3(builder, 0.2725, 0.4541, 0.8485))
+    camera = EditorCamera.End(builder)
+
+    Update.Start(builder)
+    Update.AddObjects(builder, object_vector)
+    Update.AddMaterials(builder, material_vector)
+    Update.AddEditorCamera(builder, camera)
+    builder.FinishSizePrefixed(Update.End(builder))
+    return bytes(builder.Output())
+
+
+def find_lavapipe_icd() -> str | None:
+    for directory in LAVAPIPE_ICD_DIRECTORIES:
+        for candidate in sorted(Path(directory).glob("lvp_icd*.json")):
+            return str(candidate)
+    return None
+
+
+def read_raw(path: Path) -> tuple[str, bytes]:
+    data = path.read_bytes()
+    header_end = data.index(b"\n") + 1
+    header = data[:header_end].decode("ascii").strip()
+    if not header.startswith("RAW "):
+        raise RuntimeError(f"{path}: not a raw validation capture")
+    return header, data[header_end:]
+
+
+def run_draw_path(game: Path, scene: Path, name: str, draw_path: str, instancing: str | None,
+                  capture_dir: Path, frame: int, lavapipe_icd: str | None) -> dict:
+    prefix = capture_dir / name
+    environment = os.environ.copy()
+    environment.update({
+        "GAME2_DRAW_PATH": draw_path,
+        "GAME2_GBUFFER_CAPTURE": str(prefix),
+        "GAME2_SCREENSHOT_FRAME": str(frame),
+        "GAME2_RENDER_SCALE": "100",
+        "GAME2_HIDE_UI": "1",
+        "GAME2_BLOOM": "0", "GAME2_TAA": "0", "GAME2_FXAA": "0",
+        "GAME2_SSAO": "0", "GAME2_DOF": "0",
+    })
+    if instancing is not None:
+        environment["GAME2_INSTANCING"] = instancing
+    if lavapipe_icd:
+        environment["VK_ICD_FILENAMES"] = lavapipe_icd
+    command = [str(game), "--no-live-link", "-f", str(scene)]
+    if platform.system() == "Linux" and not environment.get("DISPLAY") and not environment.get("WAYLAND_DISPLAY"):
+        if not shutil.which("xvfb-run"):
+            raise RuntimeError("no display and no xvfb-run")
+        command = ["xvfb-run", "-a"] + command
+
+    log_path = capture_dir / f"{name}.log"
+    with log_path.open("w") as log:
+        result = subprocess.run(command, cwd=ROOT, env=environment, stdout=log,
+                                stderr=subprocess.STDOUT)
+    log_text = log_path.read_text(errors="replace")
+    if result.returncode != 0:
+        raise RuntimeError(f"{name}: game exited with {result.returncode} (see {log_path})")
+    if f"Geometry draw path: {draw_path}" not in log_text:
+        raise RuntimeError(f"{name}: the game did not select draw path {draw_path} (see {log_path})")
+    return {
+        "name": name,
+        "log": str(log_path),
+        "outputs": [prefix.with_name(f"{prefix.name}.gbuffer{index}.raw")
+                    for index in range(GBUFFER_OUTPUT_COUNT)],
+        "device_log": [line for line in log_text.splitlines() if line.startswith("Indirect draws:")],
+    }
+
+
+def compare(reference: dict, candidate: dict) -> dict:
+    mismatched_outputs = []
+    for index, (reference_path, candidate_path) in enumerate(zip(reference["outputs"], candidate["outputs"])):
+        reference_header, reference_texels = read_raw(reference_path)
+        candidate_header, candidate_texels = read_raw(candidate_path)
+        if reference_header != candidate_header:
+            raise RuntimeError(f"{candidate['name']}: gbuffer{index} header {candidate_header} "
+                               f"differs from {reference_header}")
+        if reference_texels != candidate_texels:
+            differing = sum(1 for a, b in zip(reference_texels, candidate_texels) if a != b)
+            mismatched_outputs.append({"output": index, "differing_bytes": differing})
+    return {
+        "name": candidate["name"],
+        "identical": not mismatched_outputs,
+        "mismatched_outputs": mismatched_outputs,
+    }
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--output", type=Path, default=ROOT / "build/indirect_draw_validation",
+                        help="directory for the scene, captures, logs and summary.json")
+    parser.add_argument("--grid", type=int, default=12, help="cubes per side of the scene grid")
+    parser.add_argument("--frame", type=int, default=30, help="frame to capture")
+    parser.add_argument("--lavapipe", action="store_true",
+                        help="force Mesa's lavapipe ICD (VK_ICD_FILENAMES)")
+    args = parser.parse_args()
+
+    game = ROOT / ("bin/game.exe" if platform.system() == "Windows" else "bin/game")
+    if not game.is_file():
+        print("game binary is missing; run build.sh first", file=sys.stderr)
+        return 1
+    lavapipe_icd = None
+    if args.lavapipe:
+        lavapipe_icd = find_lavapipe_icd()
+        if not lavapipe_icd:
+            print("lavapipe ICD not found", file=sys.stderr)
+            return 1
+
+    args.output.mkdir(parents=True, exist_ok=True)
+    scene = args.output / "scene.bin"
+    scene.write_bytes(build_scene(args.grid))
+
+    try:
+        runs = [run_draw_path(game, scene, name, draw_path, instancing, args.output, args.frame, lavapipe_icd)
+                for name, draw_path, instancing in RUNS]
+        comparisons = [compare(runs[0], run) for run in runs[1:]]
+    except (RuntimeError, OSError) as error:
+        print(f"indirect draw validation failed: {error}", file=sys.stderr)
+        return 1
+
+    summary = {
+        "grid": args.grid,
+        "frame": args.frame,
+        "icd": lavapipe_icd or os.environ.get("VK_ICD_FILENAMES", "default"),
+        "device": runs[0]["device_log"],
+        "comparisons": comparisons,
+    }
+    (args.output / "summary.json").write_text(json.dumps(summary, indent=2) + "\n")
+    for comparison in comparisons:
+        status = "identical" if comparison["identical"] else f"DIFFERS {comparison['mismatched_outputs']}"
+        print(f"{comparison['name']}: {status}")
+    return 0 if all(comparison["identical"] for comparison in comparisons) else 1
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())